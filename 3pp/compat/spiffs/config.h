@@ -125,13 +125,19 @@
 // SPIFFS_LOCK and SPIFFS_UNLOCK protects spiffs from reentrancy on api level
 // These should be defined on a multithreaded system
 
+// Simba runs spiffs calls from several threads, including the
+// background garbage collection thread.
+struct spiffs_t;
+void spiffs_lock(struct spiffs_t *fs_p);
+void spiffs_unlock(struct spiffs_t *fs_p);
+
 // define this to enter a mutex if you're running on a multithreaded system
 #ifndef SPIFFS_LOCK
-#define SPIFFS_LOCK(fs)
+#define SPIFFS_LOCK(fs) spiffs_lock(fs)
 #endif
 // define this to exit a mutex if you're running on a multithreaded system
 #ifndef SPIFFS_UNLOCK
-#define SPIFFS_UNLOCK(fs)
+#define SPIFFS_UNLOCK(fs) spiffs_unlock(fs)
 #endif
 
 // Enable if only one spiffs instance with constant configuration will exist
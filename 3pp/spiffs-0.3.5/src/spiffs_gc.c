@@ -29,7 +29,7 @@ static s32_t spiffs_gc_erase_block(
 // Searches for blocks where all entries are deleted - if one is found,
 // the block is erased. Compared to the non-quick gc, the quick one ensures
 // that no updates are needed on existing objects on pages that are erased.
-s32_t spiffs_gc_quick(
+s32_t _spiffs_gc_quick(
     spiffs *fs, u16_t max_free_pages) {
   s32_t res = SPIFFS_OK;
   u32_t blocks = fs->block_count;
@@ -195,6 +195,55 @@ s32_t spiffs_gc_check(
   return res;
 }
 
+// Reclaims at most one block. A fully deleted block is erased if
+// there is one, otherwise the best candidate block is cleaned and
+// erased, but only if there are fewer than free_blocks_min free
+// blocks. Returns 1 if a block was reclaimed, or 0 if there was
+// nothing to do.
+s32_t _spiffs_gc_step(
+    spiffs *fs,
+    u32_t free_blocks_min) {
+  s32_t res;
+  spiffs_block_ix *cands;
+  int count;
+  spiffs_block_ix cand;
+
+  res = _spiffs_gc_quick(fs, 0);
+
+  if (res == SPIFFS_OK) {
+    return 1;
+  } else if (res != SPIFFS_ERR_NO_DELETED_BLOCKS) {
+    return res;
+  }
+
+  if (fs->free_blocks >= free_blocks_min) {
+    return 0;
+  }
+
+  res = spiffs_gc_find_candidate(fs, &cands, &count, 0);
+  SPIFFS_CHECK_RES(res);
+  if (count == 0) {
+    return 0;
+  }
+#if SPIFFS_GC_STATS
+  fs->stats_gc_runs++;
+#endif
+  cand = cands[0];
+  SPIFFS_GC_DBG("gc_step: cleaning block %i\n", cand);
+  fs->cleaning = 1;
+  res = spiffs_gc_clean(fs, cand);
+  fs->cleaning = 0;
+  SPIFFS_CHECK_RES(res);
+
+  res = spiffs_gc_erase_page_stats(fs, cand);
+  SPIFFS_CHECK_RES(res);
+
+  res = spiffs_gc_erase_block(fs, cand);
+  SPIFFS_CHECK_RES(res);
+
+  return 1;
+}
+
 // Updates page statistics for a block that is about to be erased
 s32_t spiffs_gc_erase_page_stats(
     spiffs *fs,
@@ -454,7 +454,7 @@ s32_t spiffs_obj_lu_find_free(
     int *lu_entry) {
   s32_t res;
   if (!fs->cleaning && fs->free_blocks < 2) {
-    res = spiffs_gc_quick(fs, 0);
+    res = _spiffs_gc_quick(fs, 0);
     if (res == SPIFFS_ERR_NO_DELETED_BLOCKS) {
       res = SPIFFS_OK;
     }
@@ -697,9 +697,17 @@ s32_t spiffs_gc_clean(
     spiffs *fs,
     spiffs_block_ix bix);
 
-s32_t spiffs_gc_quick(
+s32_t _spiffs_gc_quick(
     spiffs *fs, u16_t max_free_pages);
 
+s32_t _spiffs_gc_step(
+    spiffs *fs,
+    u32_t free_blocks_min);
+
+s32_t _spiffs_read(spiffs *fs, spiffs_file fh, void *buf, s32_t len);
+
+s32_t _spiffs_write(spiffs *fs, spiffs_file fh, void *buf, s32_t len);
+
 // ---------------
 
 s32_t spiffs_fd_find_new(
@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+
+"""Format log entries written by log_binary_dump(). Format strings and
+%S arguments are read from the application image, for example
+
+$ log_binary.py app.out < log.bin
+
+"""
+
+import sys
+import re
+import struct
+import subprocess
+
+
+LEVELS = ['fatal', 'error', 'warning', 'info', 'debug']
+
+RE_SECTION = re.compile(r'^\s*\[\s*\d+\]\s+(\S+)\s+(\S+)\s+'
+                        r'([0-9a-f]+)\s+([0-9a-f]+)\s+([0-9a-f]+)')
+
+RE_SPECIFIER = re.compile(r'%([0-]?)(\d*)(l?)([a-zA-Z%])')
+
+
+class Image(object):
+
+    def __init__(self, program_name, cross_compile):
+        command = [cross_compile + 'readelf', '-S', '-W', program_name]
+        output = subprocess.check_output(command).decode('ascii')
+        self.sections = []
+
+        for line in output.splitlines():
+            mo = RE_SECTION.match(line)
+
+            if not mo:
+                continue
+
+            if mo.group(2) != 'PROGBITS':
+                continue
+
+            address = int(mo.group(3), 16)
+
+            if address == 0:
+                continue
+
+            self.sections.append((address,
+                                  int(mo.group(4), 16),
+                                  int(mo.group(5), 16)))
+
+        with open(program_name, 'rb') as fin:
+            self.data = fin.read()
+
+    def read_string(self, address):
+        for section_address, offset, size in self.sections:
+            if section_address <= address < section_address + size:
+                offset += (address - section_address)
+                end = self.data.index(b'\0', offset)
+
+                return self.data[offset:end].decode('utf-8', 'replace')
+
+        return '<0x{:x}>'.format(address)
+
+
+class Reader(object):
+
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+
+    def at_end(self):
+        return self.offset >= len(self.data)
+
+    def unpack(self, fmt):
+        values = struct.unpack_from(fmt, self.data, self.offset)
+        self.offset += struct.calcsize(fmt)
+
+        return values[0]
+
+    def string(self):
+        end = self.data.index(b'\0', self.offset)
+        value = self.data[self.offset:end].decode('utf-8', 'replace')
+        self.offset = end + 1
+
+        return value
+
+
+def format_entry(fmt, values):
+    """Format given format string the way std_sprintf() does.
+
+    """
+
+    values = iter(values)
+
+    def replace(mo):
+        flags, width, _, specifier = mo.groups()
+
+        if specifier == '%':
+            return '%'
+
+        try:
+            value = next(values)
+        except StopIteration:
+            return mo.group(0)
+
+        if specifier == 'c':
+            value = chr(value & 0xff)
+            specifier = 's'
+        elif specifier in 'id':
+            specifier = 'd'
+        elif specifier in 'uxf':
+            pass
+        else:
+            specifier = 's'
+
+        if flags == '0' and specifier == 's':
+            flags = ''
+
+        return ('%' + flags + width + specifier) % value
+
+    return RE_SPECIFIER.sub(replace, fmt)
+
+
+def decode_entry(reader, image):
+    level, number_of_args = struct.unpack_from('BB',
+                                               reader.data,
+                                               reader.offset)
+    reader.offset += 2
+    seconds = reader.unpack('<I')
+    nanoseconds = reader.unpack('<I')
+    fmt = image.read_string(reader.unpack('<Q'))
+    thread_name = reader.string()
+    name = reader.string()
+    values = []
+
+    for mo in RE_SPECIFIER.finditer(fmt):
+        if len(values) == number_of_args:
+            break
+
+        length, specifier = mo.group(3, 4)
+
+        if specifier == 's':
+            value = reader.string()
+        elif specifier == 'S':
+            value = image.read_string(reader.unpack('<Q'))
+        elif specifier == 'f':
+            value = reader.unpack('<f')
+        elif specifier in 'cidux':
+            value_format = '<I'
+
+            if length == 'l':
+                value_format = '<Q'
+
+            if specifier in 'id':
+                value_format = value_format.lower()
+
+            value = reader.unpack(value_format)
+        else:
+            continue
+
+        values.append(value)
+
+    if level < len(LEVELS):
+        level = LEVELS[level]
+
+    header = '{}.{:03}:{}:{}:{}: '.format(seconds,
+                                         nanoseconds // 1000000,
+                                         level,
+                                         thread_name,
+                                         name)
+
+    return header + format_entry(fmt, values)
+
+
+def main():
+    program_name = sys.argv[1]
+
+    if len(sys.argv) > 2:
+        cross_compile = sys.argv[2]
+    else:
+        cross_compile = ''
+
+    image = Image(program_name, cross_compile)
+    reader = Reader(sys.stdin.buffer.read())
+
+    while not reader.at_end():
+        sys.stdout.write(decode_entry(reader, image))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+
+"""Symbolize folded stacks written by /debug/profiler/dump. The output
+is input to flame graph tools, for example
+
+$ profiler.py app.out < dump.txt | flamegraph.pl > profile.svg
+
+"""
+
+import sys
+import re
+import subprocess
+import io
+from collections import OrderedDict
+
+
+RE_FOLDED_STACK = re.compile(r'^([^;\s]+)((?:;0x[0-9a-f]+)*) (\d+)\s*$')
+
+
+def symbolize(program_name, cross_compile, addresses):
+    command = [
+        cross_compile + 'addr2line',
+        '-f',
+        '-e', program_name
+    ]
+    command += addresses
+    output = subprocess.check_output(command).decode('utf-8')
+    functions = output.splitlines()[0::2]
+    symbols = {}
+
+    for address, function in zip(addresses, functions):
+        if function == '??':
+            function = address
+
+        symbols[address] = function
+
+    return symbols
+
+
+def main():
+    program_name = sys.argv[1]
+
+    if len(sys.argv) > 2:
+        cross_compile = sys.argv[2]
+    else:
+        cross_compile = ''
+
+    stacks = []
+    addresses = set()
+    stdin = io.TextIOWrapper(sys.stdin.buffer,
+                             encoding='utf-8',
+                             errors='ignore')
+
+    for line in stdin:
+        mo = RE_FOLDED_STACK.match(line)
+
+        if not mo:
+            continue
+
+        frames = mo.group(2).split(';')[1:]
+        stacks.append((mo.group(1), frames, int(mo.group(3))))
+        addresses.update(frames)
+
+    symbols = symbolize(program_name, cross_compile, sorted(addresses))
+    counts = OrderedDict()
+
+    for thrd_name, frames, count in stacks:
+        folded = ';'.join([thrd_name] + [symbols[frame] for frame in frames])
+        counts[folded] = counts.get(folded, 0) + count
+
+    for folded, count in counts.items():
+        print('{} {}'.format(folded, count))
+
+
+if __name__ == '__main__':
+    main()
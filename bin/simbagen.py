@@ -145,6 +145,14 @@ const FAR struct setting_t settings[] = {{
     {{ NULL, 0, 0, 0 }}
 }};
 
+static const FAR int16_t settings_hash_table[] = {{ {hash_table} }};
+
+const FAR struct settings_hash_t settings_hash = {{
+    .seed = {hash_seed},
+    .mask = {hash_mask},
+    .table_p = &settings_hash_table[0]
+}};
+
 const FAR uint8_t settings_default[CONFIG_SETTINGS_AREA_SIZE] = {{{default_data}}};
 """
 
@@ -248,6 +256,50 @@ __attribute__ ((section (".eeprom"))) = {{{data}}};
 """
 
 
+def settings_hash(name, seed):
+    """FNV-1a hash of given setting name, with the offset basis
+    perturbed by given seed. Must match hash_name() in settings.c.
+
+    """
+
+    value = (2166136261 ^ seed) & 0xffffffff
+
+    for byte in bytearray(name.encode('ascii')):
+        value ^= byte
+        value = (value * 16777619) & 0xffffffff
+
+    return value
+
+
+def create_settings_hash_table(names):
+    """Find a seed that maps all given names to unique slots in a
+    power of two sized table. Returns the seed, the mask and the
+    table, where each slot is an index into the settings array or -1.
+
+    """
+
+    size = 1
+
+    while size < 2 * len(names):
+        size *= 2
+
+    while True:
+        for seed in range(4096):
+            table = [-1] * size
+
+            for index, name in enumerate(names):
+                slot = settings_hash(name, seed) & (size - 1)
+
+                if table[slot] != -1:
+                    break
+
+                table[slot] = index
+            else:
+                return seed, size - 1, table
+
+        size *= 2
+
+
 class Settings(object):
 
     def __init__(self, filename, endianess):
@@ -468,9 +520,16 @@ class Settings(object):
         default_data = ', '.join([str(byte)
                                   for byte in bytearray(self.as_binary())])
 
+        seed, mask, table = create_settings_hash_table(
+            list(self.settings.keys()))
+        hash_table = ', '.join([str(index) for index in table])
+
         return SETTINGS_FMT.format(names='\n'.join(names),
                                    functions='\n'.join(functions),
                                    array='\n'.join(array),
+                                   hash_table=hash_table,
+                                   hash_seed=seed,
+                                   hash_mask=mask,
                                    default_data=default_data)
 
 
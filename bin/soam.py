@@ -56,11 +56,13 @@ SOAM_TYPE_DATABASE_ID_REQUEST          = 8
 SOAM_TYPE_DATABASE_ID_RESPONSE         = 9
 SOAM_TYPE_DATABASE_REQUEST             = 10
 SOAM_TYPE_DATABASE_RESPONSE            = 11
+SOAM_TYPE_BATCH                        = 12
 SOAM_TYPE_INVALID_TYPE                 = 15
 
 SOAM_SEGMENT_SIZE_MIN = 7
 SOAM_SEGMENT_SIZE_MAX = 1024
 
+SOAM_SEGMENT_FLAGS_COMPRESSED  = (1 << 2)
 SOAM_SEGMENT_FLAGS_CONSECUTIVE = (1 << 1)
 SOAM_SEGMENT_FLAGS_LAST        = (1 << 0)
 
@@ -109,6 +111,81 @@ def crc_ccitt(data):
     return (msb << 8) + lsb
 
 
+def lz4_decompress(data, size):
+    """Decompress given LZ4 block with given uncompressed size.
+
+    """
+
+    data = bytearray(data)
+    output = bytearray()
+    pos = 0
+
+    while pos < len(data):
+        token = data[pos]
+        pos += 1
+
+        # Literals.
+        length = (token >> 4)
+
+        if length == 15:
+            while True:
+                length += data[pos]
+                pos += 1
+
+                if data[pos - 1] != 255:
+                    break
+
+        output += data[pos:pos + length]
+        pos += length
+
+        if pos == len(data):
+            break
+
+        # Match.
+        offset = (data[pos] | (data[pos + 1] << 8))
+        pos += 2
+        length = (token & 0xf)
+
+        if length == 15:
+            while True:
+                length += data[pos]
+                pos += 1
+
+                if data[pos - 1] != 255:
+                    break
+
+        length += 4
+
+        for _ in range(length):
+            output.append(output[-offset])
+
+    if len(output) != size:
+        raise ValueError('bad decompressed size {}, expected {}'.format(
+            len(output),
+            size))
+
+    return bytes(output)
+
+
+def unpack_batch(packet, flags):
+    """Unpack given batch packet into a list of (type, packet) records.
+
+    """
+
+    if flags & SOAM_SEGMENT_FLAGS_COMPRESSED:
+        size = struct.unpack('>H', packet[0:2])[0]
+        packet = lz4_decompress(packet[2:], size)
+
+    records = []
+
+    while packet:
+        record_type, size = struct.unpack('>BH', packet[0:3])
+        records.append((record_type >> 4, packet[3:3 + size]))
+        packet = packet[3 + size:]
+
+    return records
+
+
 def format_printf(database, packet):
     """Format given printf packet.
 
@@ -202,6 +279,7 @@ class ReaderThread(threading.Thread):
         self.running = True
         self.response_packet_cond = threading.Condition()
         self.response_packet = None
+        self.response_data = []
 
     def read_soam_segment(self):
         """Read a packet from the SOAM server.
@@ -229,13 +307,48 @@ class ReaderThread(threading.Thread):
 
         return packet
 
+    def handle_packet(self, packet_type, transaction_id, packet):
+        """Handle given reassembled packet.
+
+        """
+
+        # Decode the reassembled packet.
+        if packet_type == SOAM_TYPE_STDOUT_PRINTF:
+            formatted_string = format_printf(self.client.database, packet)
+            print(formatted_string, end='', file=self.ostream)
+        elif packet_type == SOAM_TYPE_STDOUT_BINARY:
+            print(packet, end='', file=self.ostream)
+        elif packet_type == SOAM_TYPE_LOG_POINT:
+            formatted_string = format_log_point(self.client.database, packet)
+            print(formatted_string, end='', file=self.ostream)
+        elif packet_type in [SOAM_TYPE_COMMAND_RESPONSE_DATA_PRINTF,
+                             SOAM_TYPE_COMMAND_RESPONSE_DATA_BINARY]:
+            self.response_data.append((packet_type, transaction_id, packet))
+        elif packet_type == SOAM_TYPE_COMMAND_RESPONSE:
+            code = struct.unpack('>i', packet)[0]
+
+            with self.response_packet_cond:
+                self.response_packet = (transaction_id,
+                                        code,
+                                        self.response_data)
+                self.response_data = []
+                self.response_packet_cond.notify_all()
+        elif packet_type in [SOAM_TYPE_DATABASE_ID_RESPONSE,
+                             SOAM_TYPE_DATABASE_RESPONSE]:
+            with self.response_packet_cond:
+                self.response_packet = packet
+                self.response_packet_cond.notify_all()
+        elif packet_type == SOAM_TYPE_INVALID_TYPE:
+            print('warning: "invalid type" packet received', file=self.ostream)
+        else:
+            print('warning: {}: bad packet type', packet_type, file=self.ostream)
+
     def _run(self):
         """Read packets from the soam server.
 
         """
 
         segments = None
-        response_data = []
         segment_index = None
 
         while self.running:
@@ -278,10 +391,10 @@ class ReaderThread(threading.Thread):
 
                 segments = None
 
-                if response_data:
+                if self.response_data:
                     print('warning: {}: discarding command response data'.format(
-                        response_data))
-                    response_data = []
+                        self.response_data))
+                    self.response_data = []
 
             # Receive all segments.
             if segments == None:
@@ -299,37 +412,20 @@ class ReaderThread(threading.Thread):
             if (flags & SOAM_SEGMENT_FLAGS_LAST) == 0:
                 continue
 
-            packet_type = segment_type
             packet = b''.join(segments)
 
-            # Decode the reassembled packet.
-            if packet_type == SOAM_TYPE_STDOUT_PRINTF:
-                formatted_string = format_printf(self.client.database, packet)
-                print(formatted_string, end='', file=self.ostream)
-            elif packet_type == SOAM_TYPE_STDOUT_BINARY:
-                print(packet, end='', file=self.ostream)
-            elif packet_type == SOAM_TYPE_LOG_POINT:
-                formatted_string = format_log_point(self.client.database, packet)
-                print(formatted_string, end='', file=self.ostream)
-            elif packet_type in [SOAM_TYPE_COMMAND_RESPONSE_DATA_PRINTF,
-                                 SOAM_TYPE_COMMAND_RESPONSE_DATA_BINARY]:
-                response_data.append((packet_type, transaction_id, packet))
-            elif packet_type == SOAM_TYPE_COMMAND_RESPONSE:
-                code = struct.unpack('>i', packet)[0]
-
-                with self.response_packet_cond:
-                    self.response_packet = transaction_id, code, response_data
-                    response_data = []
-                    self.response_packet_cond.notify_all()
-            elif packet_type in [SOAM_TYPE_DATABASE_ID_RESPONSE,
-                                 SOAM_TYPE_DATABASE_RESPONSE]:
-                with self.response_packet_cond:
-                    self.response_packet = packet
-                    self.response_packet_cond.notify_all()
-            elif packet_type == SOAM_TYPE_INVALID_TYPE:
-                print('warning: "invalid type" packet received', file=self.ostream)
+            if segment_type == SOAM_TYPE_BATCH:
+                try:
+                    records = unpack_batch(packet, flags)
+                except (ValueError, IndexError, struct.error):
+                    print('warning: {}: bad batch packet'.format(packet),
+                          file=self.ostream)
+                    records = []
+
+                for packet_type, packet in records:
+                    self.handle_packet(packet_type, transaction_id, packet)
             else:
-                print('warning: {}: bad packet type', packet_type, file=self.ostream)
+                self.handle_packet(segment_type, transaction_id, packet)
 
             segments = None
 
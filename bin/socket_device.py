@@ -24,6 +24,19 @@ TYPE_CAN_DEVICE_REQUEST                =  7
 TYPE_CAN_DEVICE_RESPONSE               =  8
 TYPE_I2C_DEVICE_REQUEST                =  9
 TYPE_I2C_DEVICE_RESPONSE               = 10
+TYPE_VERSION_REQUEST                   = 13
+TYPE_VERSION_RESPONSE                  = 14
+
+
+# Protocol versions. Version 2 transfers UART and CAN data in length
+# prefixed binary batches.
+PROTOCOL_VERSION_TEXT                  = 1
+PROTOCOL_VERSION_BINARY                = 2
+
+
+# Binary CAN frame flags.
+CAN_FLAGS_EXTENDED_FRAME               = 0x01
+CAN_FLAGS_RTR                          = 0x02
 
 
 # Maps device type strings to request types.
@@ -53,11 +66,52 @@ class DeviceAlreadyInUseError(Exception):
     pass
 
 
+def pack_can_frame(frame_id, extended_frame, data, rtr=False):
+    """Pack given CAN frame into its binary protocol format.
+
+    """
+
+    flags = 0
+
+    if extended_frame:
+        flags |= CAN_FLAGS_EXTENDED_FRAME
+
+    if rtr:
+        flags |= CAN_FLAGS_RTR
+
+    return struct.pack('>IBBH8s', frame_id, flags, len(data), 0, data)
+
+
+def unpack_can_frames(batch):
+    """Unpack given binary batch into a list of (id, extended_frame,
+    data) tuples.
+
+    """
+
+    frames = []
+
+    for offset in range(0, len(batch), 16):
+        frame_id, flags, size, _, data = struct.unpack_from('>IBBH8s',
+                                                            batch,
+                                                            offset)
+        frames.append((frame_id,
+                       (flags & CAN_FLAGS_EXTENDED_FRAME) != 0,
+                       data[:size]))
+
+    return frames
+
+
 class SocketDevice(object):
 
-    def __init__(self, device_type, device_name, address=None, port=None):
+    def __init__(self,
+                 device_type,
+                 device_name,
+                 address=None,
+                 port=None,
+                 version=PROTOCOL_VERSION_TEXT):
         self.device_type = device_type
         self.device_name = device_name
+        self.version = version
 
         if address is None:
             address = 'localhost'
@@ -76,6 +130,17 @@ class SocketDevice(object):
         """
 
         self.connect()
+
+        if self.version > PROTOCOL_VERSION_TEXT:
+            try:
+                self.request_version()
+            except UnsupportedTypeError:
+                # Old applications only support the text protocol.
+                self.socket.close()
+                self.socket = socket.socket()
+                self.version = PROTOCOL_VERSION_TEXT
+                self.connect()
+
         self.request_device()
 
     def stop(self):
@@ -100,6 +165,34 @@ class SocketDevice(object):
             print('failed.', flush=True)
             raise
 
+    def request_version(self):
+        """Negotiate the protocol version.
+
+        """
+
+        self.write(struct.pack('>III',
+                               TYPE_VERSION_REQUEST,
+                               4,
+                               self.version))
+        response = self.read(12)
+
+        if len(response) >= 8:
+            response_type = struct.unpack('>I', response[0:4])[0]
+
+            if response_type == TYPE_UNSUPPORTED_TYPE:
+                raise UnsupportedTypeError()
+
+        if len(response) != 12:
+            raise RuntimeError('error: bad version response length {}'.format(
+                len(response)))
+
+        response_type, size, version = struct.unpack('>III', response)
+
+        if response_type != TYPE_VERSION_RESPONSE or size != 4:
+            raise RuntimeError('error: bad version response')
+
+        self.version = version
+
     def request_device(self):
         """Request the device.
 
@@ -178,6 +271,46 @@ class SocketDevice(object):
 
         return buf
 
+    def write_batch(self, buf):
+        """Write given data as a binary batch.
+
+        """
+
+        self.write(struct.pack('>I', len(buf)) + buf)
+
+    def read_batch(self):
+        """Read a binary batch. Returns an empty bytes object if the
+        connection was closed.
+
+        """
+
+        header = self.read(4)
+
+        if len(header) != 4:
+            return b''
+
+        return self.read(struct.unpack('>I', header)[0])
+
+    def write_data(self, buf):
+        """Write data using the negotiated protocol version.
+
+        """
+
+        if self.version == PROTOCOL_VERSION_BINARY:
+            self.write_batch(buf)
+        else:
+            self.write(buf)
+
+    def read_data(self):
+        """Read data using the negotiated protocol version.
+
+        """
+
+        if self.version == PROTOCOL_VERSION_BINARY:
+            return self.read_batch()
+        else:
+            return self.read(1)
+
     def readline(self):
         """Read a line.
 
@@ -205,9 +338,9 @@ def reader_main(device):
     """
 
     while True:
-        byte = device.read(1)
+        data = device.read_data()
 
-        if not byte:
+        if not data:
             print('Connection closed.')
             break
 
@@ -215,7 +348,7 @@ def reader_main(device):
         prefix = '{} {}({}) RX:'.format(timestamp,
                                         device.device_type,
                                         device.device_name)
-        print(prefix, byte)
+        print(prefix, data)
 
 
 def reader_hex_line_main(device):
@@ -224,9 +357,9 @@ def reader_hex_line_main(device):
     """
 
     while True:
-        byte = device.read(1)
+        data = device.read_data()
 
-        if not byte:
+        if not data:
             print('Connection closed.')
             break
 
@@ -235,7 +368,7 @@ def reader_hex_line_main(device):
                                         device.device_type,
                                         device.device_name)
 
-        print(prefix, binascii.hexlify(byte))
+        print(prefix, binascii.hexlify(data))
 
 
 def reader_line_main(device):
@@ -263,27 +396,53 @@ def reader_line_main(device):
             print(prefix, line)
 
 
-def monitor(device_type, device_name, address, port):
+def reader_can_binary_main(device):
+    """Reads binary CAN frame batches from the application and prints
+    them in the text protocol format.
+
+    """
+
+    while True:
+        batch = device.read_batch()
+
+        if not batch:
+            print('Connection closed.')
+            break
+
+        timestamp = datetime.datetime.now().strftime("%H:%M:%S.%f")
+        prefix = '{} {}({}) RX:'.format(timestamp,
+                                        device.device_type,
+                                        device.device_name)
+
+        for frame_id, extended_frame, data in unpack_can_frames(batch):
+            print(prefix, 'id={:08x},extended={},size={},data={}'.format(
+                frame_id,
+                int(extended_frame),
+                len(data),
+                binascii.hexlify(data).decode('ascii')))
+
+
+def monitor(device_type, device_name, address, port, version):
     """Monitor given device.
 
     """
 
-    device = SocketDevice(device_type, device_name, address, port)
+    device = SocketDevice(device_type, device_name, address, port, version)
     device.start()
     reader = threading.Thread(target=reader_main, args=(device, ))
     reader.setDaemon(True)
     reader.start()
 
     while True:
-        device.write(sys.stdin.read(1).encode('utf-8'))
+        device.write_data(sys.stdin.read(1).encode('utf-8'))
 
 
-def monitor_escaped_line(device_type, device_name, address, port):
+def monitor_escaped_line(device_type, device_name, address, port, version):
     """Monitor given device.
 
     """
 
-    device = SocketDevice(device_type, device_name, address, port)
+    device = SocketDevice(device_type, device_name, address, port, version)
     device.start()
     reader = threading.Thread(target=reader_line_main, args=(device, ))
     reader.setDaemon(True)
@@ -296,15 +455,15 @@ def monitor_escaped_line(device_type, device_name, address, port):
         prefix = '{} {}({}) TX:'.format(timestamp, device_type, device_name)
         print(prefix, line)
         line = line.encode().decode('unicode_escape')
-        device.write(line.encode('utf-8'))
+        device.write_data(line.encode('utf-8'))
 
 
-def monitor_hex_line(device_type, device_name, address, port):
+def monitor_hex_line(device_type, device_name, address, port, version):
     """Monitor given device.
 
     """
 
-    device = SocketDevice(device_type, device_name, address, port)
+    device = SocketDevice(device_type, device_name, address, port, version)
     device.start()
     reader = threading.Thread(target=reader_hex_line_main, args=(device, ))
     reader.setDaemon(True)
@@ -317,7 +476,7 @@ def monitor_hex_line(device_type, device_name, address, port):
         prefix = '{} {}({}) TX:'.format(timestamp, device_type, device_name)
         line = binascii.unhexlify(line)
         print(prefix, line)
-        device.write(line)
+        device.write_data(line)
 
 
 def monitor_line(device_type, device_name, address, port):
@@ -341,6 +500,41 @@ def monitor_line(device_type, device_name, address, port):
         device.write(line.encode('utf-8'))
 
 
+def monitor_can_binary(device_name, address, port):
+    """Monitor given CAN device using the binary protocol. Frames are
+    entered and printed in the text protocol format.
+
+    """
+
+    device = SocketDevice('can',
+                          device_name,
+                          address,
+                          port,
+                          PROTOCOL_VERSION_BINARY)
+    device.start()
+
+    if device.version != PROTOCOL_VERSION_BINARY:
+        device.stop()
+        monitor_line('can', device_name, address, port)
+
+        return
+
+    reader = threading.Thread(target=reader_can_binary_main, args=(device, ))
+    reader.setDaemon(True)
+    reader.start()
+
+    while True:
+        line = input('$ ')
+        line = line.strip('\r\n')
+        timestamp = datetime.datetime.now().strftime("%H:%M:%S.%f")
+        prefix = '{} can({}) TX:'.format(timestamp, device_name)
+        print(prefix, line)
+        fields = dict(field.split('=') for field in line.split(','))
+        device.write_batch(pack_can_frame(int(fields['id'], 16),
+                                          fields['extended'] == '1',
+                                          binascii.unhexlify(fields['data'])))
+
+
 def request_all_devices(device_type, address, port):
     """Request all devices of given type.
 
@@ -398,19 +592,31 @@ def do_pin(args):
 
 
 def do_uart(args):
+    if args.binary:
+        version = PROTOCOL_VERSION_BINARY
+    else:
+        version = PROTOCOL_VERSION_TEXT
+
     if args.mode == 'escaped':
-        monitor_escaped_line('uart', args.device, args.address, args.port)
+        monitor_escaped_line('uart',
+                             args.device,
+                             args.address,
+                             args.port,
+                             version)
     elif args.mode == 'hex':
-        monitor_hex_line('uart', args.device, args.address, args.port)
+        monitor_hex_line('uart', args.device, args.address, args.port, version)
     else:
-        monitor('uart', args.device, args.address, args.port)
+        monitor('uart', args.device, args.address, args.port, version)
 
 def do_pwm(args):
     monitor_line('pwm', args.device, args.address, args.port)
 
 
 def do_can(args):
-    monitor_line('can', args.device, args.address, args.port)
+    if args.binary:
+        monitor_can_binary(args.device, args.address, args.port)
+    else:
+        monitor_line('can', args.device, args.address, args.port)
 
 
 def do_i2c(args):
@@ -458,6 +664,9 @@ def main():
     uart_parser.add_argument('-m', '--mode',
                              choices=['escaped', 'hex'],
                              help='Input and output mode.')
+    uart_parser.add_argument('-b', '--binary',
+                             action='store_true',
+                             help='Use the binary batch protocol.')
     uart_parser.add_argument('device', help='Uart device to request.')
     uart_parser.set_defaults(func=do_uart)
 
@@ -470,6 +679,9 @@ def main():
     pwm_parser.set_defaults(func=do_pwm)
 
     can_parser = subparsers.add_parser('can')
+    can_parser.add_argument('-b', '--binary',
+                            action='store_true',
+                            help='Use the binary batch protocol.')
     can_parser.add_argument('device', help='Can device to request.')
     can_parser.set_defaults(func=do_can)
 
@@ -9,30 +9,35 @@ import struct
 import zlib
 
 
-def create_header(binary, description):
+def create_header(binary, description, version=1):
     """Create the upgrade binary header for given binary data.
 
    SIZE       TYPE  DESCRIPTION
-      4   uint32_t  header version (1)
+      4   uint32_t  header version (1 or 2)
       4   uint32_t  header size in bytes
       4   uint32_t  data size in bytes
-     20  uint8_t[]  SHA1 of the data
+  20/32  uint8_t[]  SHA1 (version 1) or SHA256 (version 2) of the data
      1+   c-string  data description
       4   uint32_t  CRC32 of the header (not including this field)
      0+  uint8_t[]  data
 
     """
 
+    if version == 1:
+        digest = hashlib.sha1(binary).digest()
+    else:
+        digest = hashlib.sha256(binary).digest()
+
     description += '\0'
 
     if len(description) % 4 != 0:
         description += (4 - (len(description) % 4)) * '\0'
 
     header = struct.pack('>III',
-                         1,
-                         36 + len(description),
+                         version,
+                         16 + len(digest) + len(description),
                          len(binary))
-    header += hashlib.sha1(binary).digest()
+    header += digest
     header += description
     header += struct.pack('>I', zlib.crc32(header) & 0xffffffff)
 
@@ -42,13 +47,18 @@ def main():
     parser = argparse.ArgumentParser()
     parser.add_argument('-o', '--output')
     parser.add_argument('-d', '--description', default="")
+    parser.add_argument('--sha256',
+                        action='store_true',
+                        help='Create a version 2 header with a SHA256 digest.')
     parser.add_argument('binary')
     args = parser.parse_args()
 
     with open(args.binary) as fin:
         binary = fin.read()
 
-    header = create_header(binary, args.description)
+    header = create_header(binary,
+                           args.description,
+                           2 if args.sha256 else 1)
 
     with open(args.output, 'wb') as fout:
         fout.write(header)
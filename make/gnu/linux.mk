@@ -30,6 +30,8 @@
 
 CROSS_COMPILE =
 CFLAGS += -Werror -Wno-error=unused-variable -DCONFIG_PROFILE_STACK=0
+# For example recvmmsg() and sendmmsg() in the SocketCAN port.
+CFLAGS += -D_GNU_SOURCE
 CXXFLAGS += -Werror -Wno-error=unused-variable -DCONFIG_PROFILE_STACK=0
 
 CFLAGS += \
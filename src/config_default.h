@@ -317,6 +317,16 @@
 #    define CONFIG_LINUX_SOCKET_DEVICE                      0
 #endif
 
+/**
+ * Sample file replayed by ADC streams on Linux, with ``%d`` replaced
+ * by the ADC device index. The file contains samples as decimal
+ * integers separated by whitespace, and is replayed from the
+ * beginning at end of file.
+ */
+#ifndef CONFIG_LINUX_ADC_REPLAY_FILE
+#    define CONFIG_LINUX_ADC_REPLAY_FILE          "adc%d.txt"
+#endif
+
 /**
  * Enable the adc driver.
  */
@@ -379,6 +389,32 @@
 #    define CONFIG_CAN_FRAME_TIMESTAMP                      1
 #endif
 
+/**
+ * Use Linux SocketCAN instead of the socket device for the CAN driver
+ * on Linux. CAN device N is bound to the network interface given by
+ * ``CONFIG_CAN_SOCKETCAN_INTERFACE``, for example a virtual CAN
+ * interface created with ``ip link add dev vcan0 type vcan``.
+ */
+#ifndef CONFIG_CAN_SOCKETCAN
+#    define CONFIG_CAN_SOCKETCAN                            0
+#endif
+
+/**
+ * SocketCAN network interface name format string, formatted with the
+ * CAN device index.
+ */
+#ifndef CONFIG_CAN_SOCKETCAN_INTERFACE
+#    define CONFIG_CAN_SOCKETCAN_INTERFACE "vcan%d"
+#endif
+
+/**
+ * Maximum number of frames received and transmitted by a single
+ * system call by the SocketCAN driver on Linux.
+ */
+#ifndef CONFIG_CAN_SOCKETCAN_BATCH_SIZE
+#    define CONFIG_CAN_SOCKETCAN_BATCH_SIZE                32
+#endif
+
 /**
  * Enable the chipid driver.
  */
@@ -986,6 +1022,22 @@
 #    endif
 #endif
 
+/**
+ * Initialize the contention module at system startup. Only used if
+ * ``CONFIG_SYNC_CONTENTION`` is enabled.
+ */
+#ifndef CONFIG_MODULE_INIT_CONTENTION
+#    define CONFIG_MODULE_INIT_CONTENTION                   1
+#endif
+
+/**
+ * Initialize the profiler module at system startup. Only used if
+ * ``CONFIG_PROFILER`` is enabled.
+ */
+#ifndef CONFIG_MODULE_INIT_PROFILER
+#    define CONFIG_MODULE_INIT_PROFILER                     1
+#endif
+
 /**
  * Initialize the timer module at system startup.
  */
@@ -1510,6 +1562,36 @@
 #    endif
 #endif
 
+/**
+ * Binary logging; save log entries unformatted in a ring and format
+ * them later. See `log_binary_enable()`.
+ */
+#ifndef CONFIG_LOG_BINARY
+#    define CONFIG_LOG_BINARY                               0
+#endif
+
+/**
+ * Number of log entries in the binary log ring.
+ */
+#ifndef CONFIG_LOG_BINARY_RECORDS_MAX
+#    define CONFIG_LOG_BINARY_RECORDS_MAX                   16
+#endif
+
+/**
+ * Maximum number of arguments saved per binary log entry.
+ */
+#ifndef CONFIG_LOG_BINARY_ARGS_MAX
+#    define CONFIG_LOG_BINARY_ARGS_MAX                      6
+#endif
+
+/**
+ * Size in bytes of the string buffer of a binary log entry. All
+ * ``%s`` arguments of an entry are copied to it.
+ */
+#ifndef CONFIG_LOG_BINARY_STRINGS_MAX
+#    define CONFIG_LOG_BINARY_STRINGS_MAX                   32
+#endif
+
 /**
  * Debug file system command to list all network interfaces.
  */
@@ -1632,6 +1714,57 @@
 #    endif
 #endif
 
+/**
+ * Contention module debug file system commands.
+ */
+#ifndef CONFIG_SYNC_CONTENTION_FS_COMMANDS
+#    if defined(BOARD_ARDUINO_NANO) || defined(BOARD_ARDUINO_UNO) || defined(BOARD_ARDUINO_PRO_MICRO) || defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_SYNC_CONTENTION_FS_COMMANDS          0
+#    else
+#        define CONFIG_SYNC_CONTENTION_FS_COMMANDS          1
+#    endif
+#endif
+
+/**
+ * Profiler module debug file system commands.
+ */
+#ifndef CONFIG_PROFILER_FS_COMMANDS
+#    if defined(BOARD_ARDUINO_NANO) || defined(BOARD_ARDUINO_UNO) || defined(BOARD_ARDUINO_PRO_MICRO) || defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_PROFILER_FS_COMMANDS                 0
+#    else
+#        define CONFIG_PROFILER_FS_COMMANDS                 1
+#    endif
+#endif
+
+/**
+ * Size in bytes of the blocks an upgrade is written to the
+ * application area in. A checkpoint is saved after each written
+ * block.
+ */
+#ifndef CONFIG_UPGRADE_BUFFER_SIZE
+#    define CONFIG_UPGRADE_BUFFER_SIZE                    256
+#endif
+
+/**
+ * Write upgrade blocks to the application area in a separate thread,
+ * in parallel with receiving the next block. Uses one more block
+ * buffer.
+ */
+#ifndef CONFIG_UPGRADE_PIPELINE
+#    define CONFIG_UPGRADE_PIPELINE                         0
+#endif
+
+/**
+ * Stack size of the upgrade pipeline writer thread.
+ */
+#ifndef CONFIG_UPGRADE_PIPELINE_STACK_SIZE
+#    if defined(ARCH_LINUX)
+#        define CONFIG_UPGRADE_PIPELINE_STACK_SIZE       8192
+#    else
+#        define CONFIG_UPGRADE_PIPELINE_STACK_SIZE       1024
+#    endif
+#endif
+
 /**
  * Debug file system command to enter the application.
  */
@@ -1667,6 +1800,18 @@
 #    define CONFIG_FS_PATH_MAX                             64
 #endif
 
+/**
+ * Number of entries in the file system path lookup cache, which
+ * caches the results of `fs_stat()`, including lookups of paths that
+ * do not exist. Zero(0) disables the cache. Only enable it if
+ * registered file systems are not modified directly, for example
+ * using the FAT16 or SPIFFS API, or if `fs_dentry_cache_invalidate()`
+ * is called after such modifications.
+ */
+#ifndef CONFIG_FS_DENTRY_CACHE_SIZE
+#    define CONFIG_FS_DENTRY_CACHE_SIZE                     0
+#endif
+
 /**
  * Maximum number of command arguments, including the command name.
  */
@@ -1836,6 +1981,25 @@
 #    define CONFIG_SETTINGS_BLOB                            1
 #endif
 
+/**
+ * Maximum number of writes in a settings transaction.
+ */
+#ifndef CONFIG_SETTINGS_TRANSACTION_WRITES_MAX
+#    define CONFIG_SETTINGS_TRANSACTION_WRITES_MAX          8
+#endif
+
+/**
+ * Size in bytes of the data buffer in a settings transaction. All
+ * data written in a transaction must fit in this buffer.
+ */
+#ifndef CONFIG_SETTINGS_TRANSACTION_BUFFER_SIZE
+#    if defined(ARCH_AVR)
+#        define CONFIG_SETTINGS_TRANSACTION_BUFFER_SIZE    32
+#    else
+#        define CONFIG_SETTINGS_TRANSACTION_BUFFER_SIZE   128
+#    endif
+#endif
+
 /**
  * Maximum number of characters in a shell command.
  */
@@ -1890,6 +2054,33 @@
 #    endif
 #endif
 
+/**
+ * Record read, write and garbage collection latency histograms in
+ * each SPIFFS file system. See `spiffs_histograms_print()`.
+ */
+#ifndef CONFIG_SPIFFS_HISTOGRAMS
+#    define CONFIG_SPIFFS_HISTOGRAMS                        0
+#endif
+
+/**
+ * Background SPIFFS garbage collection. The garbage collection thread
+ * reclaims a block when the file system has been idle for this many
+ * milliseconds.
+ */
+#ifndef CONFIG_SPIFFS_GC_THRD_IDLE_MS
+#    define CONFIG_SPIFFS_GC_THRD_IDLE_MS                 100
+#endif
+
+/**
+ * The background SPIFFS garbage collection thread moves pages to
+ * reclaim blocks as long as there are fewer free blocks than this. It
+ * always erases blocks with only deleted pages. Writes garbage
+ * collect inline when three or fewer blocks are free.
+ */
+#ifndef CONFIG_SPIFFS_GC_THRD_FREE_BLOCKS_MIN
+#    define CONFIG_SPIFFS_GC_THRD_FREE_BLOCKS_MIN           5
+#endif
+
 /**
  * FAT16 is a file system.
  */
@@ -2029,6 +2220,13 @@
 #    endif
 #endif
 
+/**
+ * Number of pages in the SPIFFS cache of the default file system.
+ */
+#ifndef CONFIG_START_FILESYSTEM_SPIFFS_CACHE_PAGES
+#    define CONFIG_START_FILESYSTEM_SPIFFS_CACHE_PAGES      5
+#endif
+
 /**
  * Configure a default file system start address.
  */
@@ -2117,7 +2315,7 @@
  * Non-volatile software EEPROM chunk size. Must be a power of two.
  */
 #ifndef CONFIG_NVM_EEPROM_SOFT_CHUNK_SIZE
-#    define CONFIG_NVM_EEPROM_SOFT_CHUNK_SIZE (CONFIG_NVM_SIZE + 8)
+#    define CONFIG_NVM_EEPROM_SOFT_CHUNK_SIZE (CONFIG_NVM_SIZE + 8 + CONFIG_EEPROM_SOFT_JOURNAL_SIZE)
 #endif
 
 /**
@@ -2323,6 +2521,66 @@
 #    endif
 #endif
 
+/**
+ * Per thread histograms of scheduling latency and run length, and
+ * counters of voluntary and involuntary switches. Only supported by
+ * the Linux port.
+ */
+#ifndef CONFIG_THRD_SCHEDULING_STATISTICS
+#    define CONFIG_THRD_SCHEDULING_STATISTICS               0
+#endif
+
+/**
+ * Sampling profiler. Periodically samples the stack of the running
+ * thread and counts the samples per unique stack. The stacks are
+ * written as folded stacks by ``/debug/profiler/dump``. Sampling is
+ * only supported by the Linux port.
+ */
+#ifndef CONFIG_PROFILER
+#    define CONFIG_PROFILER                                 0
+#endif
+
+/**
+ * Number of unique stacks in the profiler stack table. Samples of
+ * new stacks are dropped when the table is full.
+ */
+#ifndef CONFIG_PROFILER_STACKS_MAX
+#    define CONFIG_PROFILER_STACKS_MAX                      64
+#endif
+
+/**
+ * Maximum number of return addresses per sampled stack. Deeper
+ * stacks are truncated at the outermost frames.
+ */
+#ifndef CONFIG_PROFILER_DEPTH_MAX
+#    define CONFIG_PROFILER_DEPTH_MAX                       16
+#endif
+
+/**
+ * Sampling frequency in Hertz used by ``/debug/profiler/start`` when
+ * no frequency is given.
+ */
+#ifndef CONFIG_PROFILER_DEFAULT_FREQUENCY
+#    define CONFIG_PROFILER_DEFAULT_FREQUENCY               100
+#endif
+
+/**
+ * Count acquisitions, contended acquisitions and wait times of
+ * mutexes, semaphores and reader-writer locks, and keep track of the
+ * threads waiting most often. Named primitives are listed by the
+ * ``/sync/contention`` file system command.
+ */
+#ifndef CONFIG_SYNC_CONTENTION
+#    define CONFIG_SYNC_CONTENTION                          0
+#endif
+
+/**
+ * Number of top waiting threads stored per primitive.
+ */
+#ifndef CONFIG_SYNC_CONTENTION_WAITERS_MAX
+#    define CONFIG_SYNC_CONTENTION_WAITERS_MAX              3
+#endif
+
 /**
  * Default thread log mask.
  */
@@ -2337,6 +2595,23 @@
 #    define CONFIG_RE_DEBUG_LOG_MASK                       -1
 #endif
 
+/**
+ * Lower compiled regular expressions without groups and anchors to a
+ * non-deterministic automaton matched in linear time. Other patterns
+ * use the recursive backtracker.
+ */
+#ifndef CONFIG_RE_AUTOMATON
+#    define CONFIG_RE_AUTOMATON                             1
+#endif
+
+/**
+ * Maximum automaton program size in bytes. The matcher uses about
+ * 2.1 times this size of stack. At most 255.
+ */
+#ifndef CONFIG_RE_AUTOMATON_SIZE_MAX
+#    define CONFIG_RE_AUTOMATON_SIZE_MAX                    128
+#endif
+
 /**
  * Each thread has a list of environment variables associated with
  * it. A typical example of an environment variable is "CWD" - Current
@@ -2552,6 +2827,27 @@
 #    define CONFIG_HTTP_SERVER_REQUEST_BUFFER_SIZE        128
 #endif
 
+/**
+ * Number of hash buckets used by the ISO-TP session manager to look
+ * up sessions by received CAN id. Must be a power of two.
+ */
+#ifndef CONFIG_ISOTP_MANAGER_BUCKETS
+#    if defined(BOARD_ARDUINO_NANO) || defined(BOARD_ARDUINO_UNO) || defined(BOARD_ARDUINO_PRO_MICRO)
+#        define CONFIG_ISOTP_MANAGER_BUCKETS                4
+#    else
+#        define CONFIG_ISOTP_MANAGER_BUCKETS               32
+#    endif
+#endif
+
+/**
+ * ISO-TP session manager N_Bs and N_Cr timeout in milliseconds, that
+ * is, the maximum time to wait for a flow control frame or the next
+ * consecutive frame.
+ */
+#ifndef CONFIG_ISOTP_MANAGER_TIMEOUT_MS
+#    define CONFIG_ISOTP_MANAGER_TIMEOUT_MS              1000
+#endif
+
 /**
  * Use lookup tables for CRC calculations. It is faster, but uses more
  * memory.
@@ -2560,6 +2856,84 @@
 #    define CONFIG_CRC_TABLE_LOOKUP                         1
 #endif
 
+/**
+ * Number of bytes the table driven CRC-32 calculation processes per
+ * iteration (slicing-by-N). One(1) uses a single 1 kB table. Four(4),
+ * eight(8) and sixteen(16) use 4 kB, 8 kB and 16 kB tables, generated
+ * in RAM on first use. No other values are supported. Requires
+ * ``CONFIG_CRC_TABLE_LOOKUP``.
+ */
+#ifndef CONFIG_CRC_32_SLICES
+#    if defined(ARCH_LINUX) || defined(ARCH_ARM64) || defined(ARCH_ESP32)
+#        define CONFIG_CRC_32_SLICES                        8
+#    else
+#        define CONFIG_CRC_32_SLICES                        1
+#    endif
+#endif
+
+/**
+ * Number of bytes the table driven CRC-CCITT calculation processes
+ * per iteration (slicing-by-N). One(1) uses a single 512 bytes
+ * table. Larger values use N tables of 512 bytes, generated in RAM
+ * on first use. Requires ``CONFIG_CRC_TABLE_LOOKUP``.
+ */
+#ifndef CONFIG_CRC_CCITT_SLICES
+#    if defined(ARCH_LINUX) || defined(ARCH_ARM64) || defined(ARCH_ESP32)
+#        define CONFIG_CRC_CCITT_SLICES                     4
+#    else
+#        define CONFIG_CRC_CCITT_SLICES                     1
+#    endif
+#endif
+
+/**
+ * Calculate CRC-32 using CPU instructions when available; carry-less
+ * multiplication on x86 Linux and the CRC32 instructions on ARMv8,
+ * detected at runtime on Linux.
+ */
+#ifndef CONFIG_CRC_32_HARDWARE
+#    define CONFIG_CRC_32_HARDWARE                          1
+#endif
+
+/**
+ * Calculate SHA1 and SHA256 using CPU instructions when available;
+ * the x86 SHA extensions on Linux and the ARMv8 SHA instructions,
+ * detected at runtime on Linux.
+ */
+#ifndef CONFIG_SHA_HARDWARE
+#    define CONFIG_SHA_HARDWARE                             1
+#endif
+
+/**
+ * Vectorize the base64 and hex codecs using SSSE3 on Linux x86,
+ * detected at runtime, and NEON on AArch64.
+ */
+#ifndef CONFIG_ENCODE_SIMD
+#    define CONFIG_ENCODE_SIMD                              1
+#endif
+
+/**
+ * Maximum nesting depth of documents parsed by the streaming JSON
+ * parser.
+ */
+#ifndef CONFIG_JSON_STREAM_DEPTH_MAX
+#    define CONFIG_JSON_STREAM_DEPTH_MAX                    8
+#endif
+
+/**
+ * Size of the path buffer of the streaming JSON parser, including
+ * null termination.
+ */
+#ifndef CONFIG_JSON_STREAM_PATH_MAX
+#    define CONFIG_JSON_STREAM_PATH_MAX                     64
+#endif
+
+/**
+ * Size of the key and value buffer of the streaming JSON parser.
+ */
+#ifndef CONFIG_JSON_STREAM_VALUE_MAX
+#    define CONFIG_JSON_STREAM_VALUE_MAX                    64
+#endif
+
 /**
  */
 #ifndef CONFIG_SPC5_BOOT_ENTRY_RCHW
@@ -2591,6 +2965,15 @@
 #    define CONFIG_TIME_UNIX_TIME_TO_DATE                   1
 #endif
 
+/**
+ * Support for batch packets in the SOAM module. Log points and
+ * standard output writes are coalesced into packets of up to a given
+ * size, optionally compressed. See `soam_set_batching()`.
+ */
+#ifndef CONFIG_SOAM_BATCH
+#    define CONFIG_SOAM_BATCH                               0
+#endif
+
 /**
  * Embed the SOAM database in the application.
  */
@@ -2669,6 +3052,15 @@
 #    define CONFIG_EEPROM_SOFT_OVERWRITE_IDENTICAL_DATA     0
 #endif
 
+/**
+ * Size in bytes of the journal in each software eeprom chunk, or zero
+ * to disable the journal. Small writes are appended to the journal
+ * instead of copying the whole chunk. Must be a multiple of eight.
+ */
+#ifndef CONFIG_EEPROM_SOFT_JOURNAL_SIZE
+#    define CONFIG_EEPROM_SOFT_JOURNAL_SIZE                 0
+#endif
+
 /**
  * Configuration validation.
  */
@@ -29,11 +29,48 @@
 #include "simba.h"
 #include <stdarg.h>
 
+#if CONFIG_LOG_BINARY == 1
+
+#if defined(ARCH_LINUX)
+#    include <link.h>
+#endif
+
+/* A log entry saved in binary mode, formatted later. */
+struct binary_record_t {
+    int8_t committed;
+    int8_t level;
+    int8_t number_of_args;
+    char specifiers[CONFIG_LOG_BINARY_ARGS_MAX];
+    char lengths[CONFIG_LOG_BINARY_ARGS_MAX];
+    struct time_t timestamp;
+    const char *name_p;
+    const char *thread_name_p;
+    far_string_t fmt_p;
+    union std_arg_t args[CONFIG_LOG_BINARY_ARGS_MAX];
+    char strings[CONFIG_LOG_BINARY_STRINGS_MAX];
+};
+
+#endif
+
 struct module_t {
     int8_t initialized;
     struct log_handler_t handler;
     struct log_object_t object;
     struct mutex_t mutex;
+    struct {
+        struct std_format_t format;
+        struct std_format_item_t items[10];
+    } header;
+#if CONFIG_LOG_BINARY == 1
+    struct {
+        int enabled;
+        int head;
+        int tail;
+        int length;
+        uint32_t dropped;
+        struct binary_record_t records[CONFIG_LOG_BINARY_RECORDS_MAX];
+    } binary;
+#endif
 #if CONFIG_LOG_FS_COMMANDS == 1
     struct fs_command_t cmd_print;
     struct fs_command_t cmd_list;
@@ -179,6 +216,385 @@ static int cmd_set_log_mask_cb(int argc,
 
 #endif
 
+#if CONFIG_LOG_BINARY == 1
+
+/**
+ * Save the arguments of given format string in given record. Strings
+ * are copied to the record as they may not outlive the call, and are
+ * truncated if they do not fit.
+ */
+static void binary_save_args(struct binary_record_t *record_p,
+                             far_string_t fmt_p,
+                             va_list *ap_p)
+{
+    union std_arg_t *arg_p;
+    const char *s_p;
+    char *string_p;
+    char *strings_end_p;
+    char c;
+    int length;
+    int i;
+
+    string_p = &record_p->strings[0];
+    strings_end_p = &record_p->strings[sizeof(record_p->strings)];
+    i = 0;
+
+    while (i < CONFIG_LOG_BINARY_ARGS_MAX) {
+        /* Find the next conversion specification. */
+        c = *fmt_p++;
+
+        if (c == '\0') {
+            break;
+        }
+
+        if (c != '%') {
+            continue;
+        }
+
+        /* Prototype: %[flags][width][length]specifier  */
+        c = *fmt_p++;
+
+        if ((c == '0') || (c == '-')) {
+            c = *fmt_p++;
+        }
+
+        while ((c >= '0') && (c <= '9')) {
+            c = *fmt_p++;
+        }
+
+        length = 0;
+
+        if (c == 'l') {
+            length = 1;
+            c = *fmt_p++;
+        }
+
+        arg_p = &record_p->args[i];
+
+        switch (c) {
+
+        case 'c':
+        case 'i':
+        case 'd':
+        case 'u':
+        case 'x':
+            if (length == 1) {
+                arg_p->integer = va_arg(*ap_p, long);
+            } else {
+                arg_p->integer = va_arg(*ap_p, int);
+            }
+
+            break;
+
+#if CONFIG_FLOAT == 1
+        case 'f':
+            arg_p->floating = va_arg(*ap_p, double);
+            break;
+#endif
+
+        case 's':
+            s_p = va_arg(*ap_p, const char *);
+            arg_p->string_p = s_p;
+
+            if ((s_p != NULL) && (string_p < strings_end_p)) {
+                arg_p->string_p = string_p;
+
+                while ((*s_p != '\0') && (string_p < strings_end_p - 1)) {
+                    *string_p++ = *s_p++;
+                }
+
+                *string_p++ = '\0';
+            } else if (s_p != NULL) {
+                arg_p->string_p = "";
+            }
+
+            break;
+
+        case 'S':
+            arg_p->far_string_p = va_arg(*ap_p, far_string_t);
+            break;
+
+        case '\0':
+            fmt_p--;
+            continue;
+
+        default:
+            /* No argument, for example "%%". */
+            continue;
+        }
+
+        record_p->specifiers[i] = c;
+        record_p->lengths[i] = length;
+        i++;
+    }
+
+    record_p->number_of_args = i;
+}
+
+/**
+ * Save given log entry in the binary log ring. The system lock is
+ * only held while a record is reserved and committed, never while
+ * the record is filled in.
+ *
+ * @return One(1) if the entry was saved, or zero(0) if the ring is
+ *         full.
+ */
+static int binary_write(const char *name_p,
+                        int level,
+                        far_string_t fmt_p,
+                        va_list *ap_p)
+{
+    struct binary_record_t *record_p;
+
+    sys_lock();
+
+    if (module.binary.length == CONFIG_LOG_BINARY_RECORDS_MAX) {
+        module.binary.dropped++;
+        sys_unlock();
+
+        return (0);
+    }
+
+    record_p = &module.binary.records[module.binary.head];
+    module.binary.head++;
+
+    if (module.binary.head == CONFIG_LOG_BINARY_RECORDS_MAX) {
+        module.binary.head = 0;
+    }
+
+    module.binary.length++;
+
+    sys_unlock();
+
+    time_get(&record_p->timestamp);
+    record_p->level = level;
+    record_p->name_p = name_p;
+    record_p->thread_name_p = thrd_get_name();
+    record_p->fmt_p = fmt_p;
+    binary_save_args(record_p, fmt_p, ap_p);
+
+    sys_lock();
+    record_p->committed = 1;
+    sys_unlock();
+
+    return (1);
+}
+
+/**
+ * Get the oldest record in the ring, or NULL if it is empty or the
+ * oldest record is not yet committed.
+ */
+static struct binary_record_t *binary_peek(void)
+{
+    struct binary_record_t *record_p;
+
+    record_p = NULL;
+
+    sys_lock();
+
+    if (module.binary.length > 0) {
+        if (module.binary.records[module.binary.tail].committed == 1) {
+            record_p = &module.binary.records[module.binary.tail];
+        }
+    }
+
+    sys_unlock();
+
+    return (record_p);
+}
+
+/**
+ * Release the oldest record in the ring.
+ */
+static void binary_release(struct binary_record_t *record_p)
+{
+    sys_lock();
+
+    record_p->committed = 0;
+    module.binary.tail++;
+
+    if (module.binary.tail == CONFIG_LOG_BINARY_RECORDS_MAX) {
+        module.binary.tail = 0;
+    }
+
+    module.binary.length--;
+
+    sys_unlock();
+}
+
+/**
+ * Format given record and write it to all handlers.
+ */
+static void binary_print(struct binary_record_t *record_p)
+{
+    struct log_handler_t *handler_p;
+    void *chout_p;
+
+    handler_p = &module.handler;
+
+    while (handler_p != NULL) {
+        chout_p = handler_p->chout_p;
+
+        if (chout_p != NULL) {
+            chan_control(chout_p, CHAN_CONTROL_LOG_BEGIN);
+            std_fprintf_format(chout_p,
+                               &module.header.format,
+                               record_p->timestamp.seconds,
+                               record_p->timestamp.nanoseconds / 1000000ul,
+                               level_as_string[(int)record_p->level],
+                               record_p->thread_name_p,
+                               record_p->name_p);
+            std_fprintf_args(chout_p,
+                             record_p->fmt_p,
+                             &record_p->args[0],
+                             record_p->number_of_args);
+            chan_control(chout_p, CHAN_CONTROL_LOG_END);
+        }
+
+        handler_p = handler_p->next_p;
+    }
+}
+
+/**
+ * Write given 32 bits value in little endian byte order.
+ */
+static ssize_t binary_dump_uint32(void *chout_p, uint32_t value)
+{
+    uint8_t buf[4];
+
+    buf[0] = value;
+    buf[1] = (value >> 8);
+    buf[2] = (value >> 16);
+    buf[3] = (value >> 24);
+
+    return (chan_write(chout_p, &buf[0], sizeof(buf)));
+}
+
+/**
+ * Write given 64 bits value in little endian byte order.
+ */
+static ssize_t binary_dump_uint64(void *chout_p, uint64_t value)
+{
+    ssize_t size;
+
+    size = binary_dump_uint32(chout_p, value);
+    size += binary_dump_uint32(chout_p, value >> 32);
+
+    return (size);
+}
+
+#if defined(ARCH_LINUX)
+
+/* ELF header of the executable, provided by the linker. */
+extern const ElfW(Ehdr) __ehdr_start;
+
+/**
+ * Get the address the executable was loaded at. A position
+ * independent executable is linked at address zero.
+ */
+static uintptr_t binary_get_load_address(void)
+{
+    if (__ehdr_start.e_type == ET_DYN) {
+        return ((uintptr_t)&__ehdr_start);
+    }
+
+    return (0);
+}
+
+#else
+
+static uintptr_t binary_get_load_address(void)
+{
+    return (0);
+}
+
+#endif
+
+/**
+ * Write given string address relative to the load address, as
+ * written in the application image.
+ */
+static ssize_t binary_dump_address(void *chout_p, far_string_t str_p)
+{
+    return (binary_dump_uint64(chout_p,
+                               (uintptr_t)str_p - binary_get_load_address()));
+}
+
+/**
+ * Write given null terminated string, including the null
+ * termination.
+ */
+static ssize_t binary_dump_string(void *chout_p, const char *str_p)
+{
+    if (str_p == NULL) {
+        str_p = "(null)";
+    }
+
+    return (chan_write(chout_p, str_p, strlen(str_p) + 1));
+}
+
+/**
+ * Write given record in the binary log format.
+ */
+static ssize_t binary_dump(void *chout_p,
+                           struct binary_record_t *record_p)
+{
+    ssize_t size;
+    uint8_t buf[2];
+#if CONFIG_FLOAT == 1
+    union {
+        float value;
+        uint32_t raw;
+    } floating;
+#endif
+    int i;
+
+    buf[0] = record_p->level;
+    buf[1] = record_p->number_of_args;
+    size = chan_write(chout_p, &buf[0], sizeof(buf));
+    size += binary_dump_uint32(chout_p, record_p->timestamp.seconds);
+    size += binary_dump_uint32(chout_p, record_p->timestamp.nanoseconds);
+    size += binary_dump_address(chout_p, record_p->fmt_p);
+    size += binary_dump_string(chout_p, record_p->thread_name_p);
+    size += binary_dump_string(chout_p, record_p->name_p);
+
+    for (i = 0; i < record_p->number_of_args; i++) {
+        switch (record_p->specifiers[i]) {
+
+#if CONFIG_FLOAT == 1
+        case 'f':
+            floating.value = record_p->args[i].floating;
+            size += binary_dump_uint32(chout_p, floating.raw);
+            break;
+#endif
+
+        case 's':
+            size += binary_dump_string(chout_p, record_p->args[i].string_p);
+            break;
+
+        case 'S':
+            size += binary_dump_address(chout_p,
+                                        record_p->args[i].far_string_p);
+            break;
+
+        default:
+            if (record_p->lengths[i] == 1) {
+                size += binary_dump_uint64(chout_p,
+                                           record_p->args[i].integer);
+            } else {
+                size += binary_dump_uint32(chout_p,
+                                           record_p->args[i].integer);
+            }
+
+            break;
+        }
+    }
+
+    return (size);
+}
+
+#endif
+
 int log_module_init()
 {
     /* Return immediately if the module is already initialized. */
@@ -197,6 +613,12 @@ int log_module_init()
     module.object.mask = LOG_UPTO(INFO);
     module.object.next_p = NULL;
 
+    /* The header is printed for every log entry. */
+    std_format_init(&module.header.format,
+                    FSTR("%lu.%03lu:%S:%s:%s: "),
+                    &module.header.items[0],
+                    membersof(module.header.items));
+
 #if CONFIG_LOG_FS_COMMANDS == 1
     fs_command_init(&module.cmd_print,
                     CSTR("/debug/log/print"),
@@ -392,6 +814,17 @@ int log_object_print(struct log_object_t *self_p,
         name_p = self_p->name_p;
     }
 
+#if CONFIG_LOG_BINARY == 1
+    /* Defer formatting to log_binary_process(). */
+    if (module.binary.enabled == 1) {
+        va_start(ap, fmt_p);
+        count = binary_write(name_p, level, fmt_p, &ap);
+        va_end(ap);
+
+        return (count);
+    }
+#endif
+
     /* Print the formatted log entry to all handlers. */
     count = 0;
     handler_p = &module.handler;
@@ -407,13 +840,13 @@ int log_object_print(struct log_object_t *self_p,
             chan_control(chout_p, CHAN_CONTROL_LOG_BEGIN);
 
             /* Write the header. */
-            std_fprintf(chout_p,
-                        FSTR("%lu.%03lu:%S:%s:%s: "),
-                        now.seconds,
-                        now.nanoseconds / 1000000ul,
-                        level_as_string[level],
-                        thrd_get_name(),
-                        name_p);
+            std_fprintf_format(chout_p,
+                               &module.header.format,
+                               now.seconds,
+                               now.nanoseconds / 1000000ul,
+                               level_as_string[level],
+                               thrd_get_name(),
+                               name_p);
 
             /* Write the custom message. */
             va_start(ap, fmt_p);
@@ -432,3 +865,60 @@ int log_object_print(struct log_object_t *self_p,
 
     return (count);
 }
+
+#if CONFIG_LOG_BINARY == 1
+
+int log_binary_enable(int enabled)
+{
+    module.binary.enabled = (enabled != 0);
+
+    return (0);
+}
+
+int log_binary_process(void)
+{
+    struct binary_record_t *record_p;
+    int count;
+
+    count = 0;
+
+    mutex_lock(&module.mutex);
+
+    while ((record_p = binary_peek()) != NULL) {
+        binary_print(record_p);
+        binary_release(record_p);
+        count++;
+    }
+
+    mutex_unlock(&module.mutex);
+
+    return (count);
+}
+
+ssize_t log_binary_dump(void *chout_p)
+{
+    ASSERTN(chout_p != NULL, EINVAL);
+
+    struct binary_record_t *record_p;
+    ssize_t size;
+
+    size = 0;
+
+    mutex_lock(&module.mutex);
+
+    while ((record_p = binary_peek()) != NULL) {
+        size += binary_dump(chout_p, record_p);
+        binary_release(record_p);
+    }
+
+    mutex_unlock(&module.mutex);
+
+    return (size);
+}
+
+uint32_t log_binary_get_dropped(void)
+{
+    return (module.binary.dropped);
+}
+
+#endif
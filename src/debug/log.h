@@ -204,4 +204,69 @@ int log_remove_object(struct log_object_t *object_p);
  */
 int log_set_default_handler_output_channel(void *chout_p);
 
+#if CONFIG_LOG_BINARY == 1
+
+/**
+ * Enable or disable binary logging. In binary mode
+ * `log_object_print()` does not format the log entry. Instead the
+ * timestamp, log level, format string pointer and the arguments are
+ * saved in a ring of ``CONFIG_LOG_BINARY_RECORDS_MAX`` records, and
+ * formatted later by `log_binary_process()`, or written in a compact
+ * binary format by `log_binary_dump()`.
+ *
+ * Entries are dropped when the ring is full. Formatting stops after
+ * ``CONFIG_LOG_BINARY_ARGS_MAX`` arguments, and ``%s`` strings are
+ * copied to a buffer of ``CONFIG_LOG_BINARY_STRINGS_MAX`` bytes per
+ * entry and truncated if they do not fit.
+ *
+ * @param[in] enabled true(1) to enable binary logging, false(0) to
+ *                    format log entries immediately.
+ *
+ * @return zero(0) or negative error code.
+ */
+int log_binary_enable(int enabled);
+
+/**
+ * Format all saved log entries and write them to all log
+ * handlers. Typically called periodically by a low priority thread.
+ *
+ * @return Number of formatted log entries, or negative error code.
+ */
+int log_binary_process(void);
+
+/**
+ * Write all saved log entries to given channel without formatting
+ * them. Format strings are not written; they are identified by their
+ * address relative to the load address of the application, which is
+ * resolved on the host using the application image by
+ * ``bin/log_binary.py``.
+ *
+ * Each entry is written as, with integers in little endian byte
+ * order:
+ *
+ * - level (uint8_t)
+ * - number of arguments (uint8_t)
+ * - seconds and nanoseconds of the timestamp (uint32_t each)
+ * - format string address (uint64_t)
+ * - thread name and log object name (null terminated strings)
+ * - the arguments; ``%s`` as null terminated strings, ``%S`` as
+ *   uint64_t addresses, ``%f`` as float, ``%l`` integers as uint64_t
+ *   and everything else as uint32_t.
+ *
+ * @param[in] chout_p Output channel.
+ *
+ * @return Number of bytes written, or negative error code.
+ */
+ssize_t log_binary_dump(void *chout_p);
+
+/**
+ * Get the number of log entries dropped since startup because the
+ * ring was full.
+ *
+ * @return Number of dropped log entries.
+ */
+uint32_t log_binary_get_dropped(void);
+
+#endif
+
 #endif
@@ -0,0 +1,423 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#if CONFIG_PROFILER == 1
+
+struct stack_t {
+    uint32_t count;
+    const char *thrd_name_p;
+    int depth;
+    void *frames[CONFIG_PROFILER_DEPTH_MAX];
+};
+
+struct module_t {
+    int8_t initialized;
+    int8_t running;
+    /* Set while the stack table is read or written. Samples taken
+       while set are dropped. */
+    volatile int8_t busy;
+    uint32_t samples;
+    uint32_t dropped;
+    int number_of_stacks;
+    struct stack_t stacks[CONFIG_PROFILER_STACKS_MAX];
+#if CONFIG_PROFILER_FS_COMMANDS == 1
+    struct fs_command_t cmd_start;
+    struct fs_command_t cmd_stop;
+    struct fs_command_t cmd_reset;
+    struct fs_command_t cmd_dump;
+    struct fs_command_t cmd_status;
+#endif
+};
+
+static struct module_t module;
+
+#if defined(ARCH_LINUX)
+#    include "profiler_port.i"
+#else
+
+static int profiler_port_module_init(void)
+{
+    return (0);
+}
+
+static int profiler_port_start(int frequency)
+{
+    return (-ENOSYS);
+}
+
+static int profiler_port_stop(void)
+{
+    return (-ENOSYS);
+}
+
+static uintptr_t profiler_port_get_load_address(void)
+{
+    return (0);
+}
+
+#endif
+
+#if CONFIG_PROFILER_FS_COMMANDS == 1
+
+static int cmd_start_cb(int argc,
+                        const char *argv[],
+                        void *chout_p,
+                        void *chin_p,
+                        void *arg_p,
+                        void *call_arg_p)
+{
+    long frequency;
+
+    frequency = CONFIG_PROFILER_DEFAULT_FREQUENCY;
+
+    if (argc == 2) {
+        if ((std_strtol(argv[1], &frequency) == NULL)
+            || (frequency <= 0)) {
+            std_fprintf(chout_p, OSTR("Bad frequency %s.\r\n"), argv[1]);
+
+            return (-EINVAL);
+        }
+    } else if (argc != 1) {
+        std_fprintf(chout_p, OSTR("Usage: start [<frequency>]\r\n"));
+
+        return (-EINVAL);
+    }
+
+    return (profiler_start(frequency));
+}
+
+static int cmd_stop_cb(int argc,
+                       const char *argv[],
+                       void *chout_p,
+                       void *chin_p,
+                       void *arg_p,
+                       void *call_arg_p)
+{
+    return (profiler_stop());
+}
+
+static int cmd_reset_cb(int argc,
+                        const char *argv[],
+                        void *chout_p,
+                        void *chin_p,
+                        void *arg_p,
+                        void *call_arg_p)
+{
+    return (profiler_reset());
+}
+
+static int cmd_dump_cb(int argc,
+                       const char *argv[],
+                       void *chout_p,
+                       void *chin_p,
+                       void *arg_p,
+                       void *call_arg_p)
+{
+    int res;
+
+    res = profiler_dump(chout_p);
+
+    if (res > 0) {
+        res = 0;
+    }
+
+    return (res);
+}
+
+static int cmd_status_cb(int argc,
+                         const char *argv[],
+                         void *chout_p,
+                         void *chin_p,
+                         void *arg_p,
+                         void *call_arg_p)
+{
+    struct profiler_statistics_t statistics;
+
+    profiler_get_statistics(&statistics);
+
+    std_fprintf(chout_p,
+                OSTR("running: %s\r\n"
+                     "samples: %lu\r\n"
+                     "dropped: %lu\r\n"
+                     "stacks: %d/%d\r\n"),
+                module.running == 1 ? "yes" : "no",
+                (unsigned long)statistics.samples,
+                (unsigned long)statistics.dropped,
+                statistics.stacks,
+                CONFIG_PROFILER_STACKS_MAX);
+
+    return (0);
+}
+
+#endif
+
+static uint32_t hash_stack(const char *thrd_name_p,
+                           void **frames_pp,
+                           int depth)
+{
+    uint32_t hash;
+    int i;
+
+    hash = (2166136261ul ^ (uint32_t)(uintptr_t)thrd_name_p);
+
+    for (i = 0; i < depth; i++) {
+        hash = ((hash ^ (uint32_t)(uintptr_t)frames_pp[i]) * 16777619ul);
+    }
+
+    return (hash);
+}
+
+/**
+ * Find given stack in the stack table, or an empty entry to store it
+ * in. Linear probing.
+ */
+static struct stack_t *find_stack(const char *thrd_name_p,
+                                  void **frames_pp,
+                                  int depth)
+{
+    struct stack_t *stack_p;
+    int index;
+    int i;
+
+    index = (hash_stack(thrd_name_p, frames_pp, depth)
+             % CONFIG_PROFILER_STACKS_MAX);
+
+    for (i = 0; i < CONFIG_PROFILER_STACKS_MAX; i++) {
+        stack_p = &module.stacks[index];
+
+        if (stack_p->count == 0) {
+            return (stack_p);
+        }
+
+        if ((stack_p->thrd_name_p == thrd_name_p)
+            && (stack_p->depth == depth)
+            && (memcmp(&stack_p->frames[0],
+                       frames_pp,
+                       depth * sizeof(*frames_pp)) == 0)) {
+            return (stack_p);
+        }
+
+        index++;
+
+        if (index == CONFIG_PROFILER_STACKS_MAX) {
+            index = 0;
+        }
+    }
+
+    return (NULL);
+}
+
+int profiler_module_init(void)
+{
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+
+#if CONFIG_PROFILER_FS_COMMANDS == 1
+    fs_command_init(&module.cmd_start,
+                    CSTR("/debug/profiler/start"),
+                    cmd_start_cb,
+                    NULL);
+    fs_command_register(&module.cmd_start);
+
+    fs_command_init(&module.cmd_stop,
+                    CSTR("/debug/profiler/stop"),
+                    cmd_stop_cb,
+                    NULL);
+    fs_command_register(&module.cmd_stop);
+
+    fs_command_init(&module.cmd_reset,
+                    CSTR("/debug/profiler/reset"),
+                    cmd_reset_cb,
+                    NULL);
+    fs_command_register(&module.cmd_reset);
+
+    fs_command_init(&module.cmd_dump,
+                    CSTR("/debug/profiler/dump"),
+                    cmd_dump_cb,
+                    NULL);
+    fs_command_register(&module.cmd_dump);
+
+    fs_command_init(&module.cmd_status,
+                    CSTR("/debug/profiler/status"),
+                    cmd_status_cb,
+                    NULL);
+    fs_command_register(&module.cmd_status);
+#endif
+
+    return (profiler_port_module_init());
+}
+
+int profiler_start(int frequency)
+{
+    ASSERTN(frequency > 0, EINVAL);
+
+    int res;
+
+    if (module.running == 1) {
+        return (-EBUSY);
+    }
+
+    res = profiler_port_start(frequency);
+
+    if (res == 0) {
+        module.running = 1;
+    }
+
+    return (res);
+}
+
+int profiler_stop(void)
+{
+    int res;
+
+    if (module.running == 0) {
+        return (0);
+    }
+
+    res = profiler_port_stop();
+
+    if (res == 0) {
+        module.running = 0;
+    }
+
+    return (res);
+}
+
+int profiler_reset(void)
+{
+    module.busy = 1;
+    memset(&module.stacks[0], 0, sizeof(module.stacks));
+    module.number_of_stacks = 0;
+    module.samples = 0;
+    module.dropped = 0;
+    module.busy = 0;
+
+    return (0);
+}
+
+int profiler_dump(void *chout_p)
+{
+    ASSERTN(chout_p != NULL, EINVAL);
+
+    struct stack_t *stack_p;
+    uintptr_t load_address;
+    int number_of_stacks;
+    const char *name_p;
+    int i;
+    int j;
+
+    load_address = profiler_port_get_load_address();
+    number_of_stacks = 0;
+    module.busy = 1;
+
+    for (i = 0; i < CONFIG_PROFILER_STACKS_MAX; i++) {
+        stack_p = &module.stacks[i];
+
+        if (stack_p->count == 0) {
+            continue;
+        }
+
+        name_p = stack_p->thrd_name_p;
+
+        if ((name_p == NULL) || (name_p[0] == '\0')) {
+            name_p = "unknown";
+        }
+
+        std_fprintf(chout_p, OSTR("%s"), name_p);
+
+        for (j = stack_p->depth - 1; j >= 0; j--) {
+            std_fprintf(chout_p,
+                        OSTR(";0x%lx"),
+                        (unsigned long)((uintptr_t)stack_p->frames[j]
+                                        - load_address));
+        }
+
+        std_fprintf(chout_p, OSTR(" %lu\r\n"), (unsigned long)stack_p->count);
+        number_of_stacks++;
+    }
+
+    module.busy = 0;
+
+    return (number_of_stacks);
+}
+
+int profiler_get_statistics(struct profiler_statistics_t *statistics_p)
+{
+    ASSERTN(statistics_p != NULL, EINVAL);
+
+    statistics_p->samples = module.samples;
+    statistics_p->dropped = module.dropped;
+    statistics_p->stacks = module.number_of_stacks;
+
+    return (0);
+}
+
+void profiler_sample_isr(void **frames_pp, int depth)
+{
+    struct stack_t *stack_p;
+    const char *thrd_name_p;
+
+    if (module.busy == 1) {
+        module.dropped++;
+
+        return;
+    }
+
+    module.busy = 1;
+
+    if (depth > CONFIG_PROFILER_DEPTH_MAX) {
+        depth = CONFIG_PROFILER_DEPTH_MAX;
+    }
+
+    thrd_name_p = thrd_get_name();
+    stack_p = find_stack(thrd_name_p, frames_pp, depth);
+
+    if (stack_p != NULL) {
+        if (stack_p->count == 0) {
+            stack_p->thrd_name_p = thrd_name_p;
+            stack_p->depth = depth;
+            memcpy(&stack_p->frames[0], frames_pp, depth * sizeof(*frames_pp));
+            module.number_of_stacks++;
+        }
+
+        stack_p->count++;
+        module.samples++;
+    } else {
+        module.dropped++;
+    }
+
+    module.busy = 0;
+}
+
+#endif
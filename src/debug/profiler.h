@@ -0,0 +1,119 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __DEBUG_PROFILER_H__
+#define __DEBUG_PROFILER_H__
+
+#include "simba.h"
+
+struct profiler_statistics_t {
+    /** Number of recorded samples. */
+    uint32_t samples;
+    /** Number of samples dropped because the stack table was full
+        or busy. */
+    uint32_t dropped;
+    /** Number of unique stacks in the stack table. */
+    int stacks;
+};
+
+/**
+ * Initialize the profiler module. This function must be called before
+ * calling any other function in this module.
+ *
+ * The module will only be initialized once even if this function is
+ * called multiple times.
+ *
+ * @return zero(0) or negative error code.
+ */
+int profiler_module_init(void);
+
+/**
+ * Start sampling the stack of the running thread with given
+ * frequency. Samples are aggregated per unique stack and thread in a
+ * fixed size table.
+ *
+ * Only the Linux port has a sampling timer, driven by consumed
+ * process CPU time. Other ports may call `profiler_sample_isr()`
+ * from a periodic interrupt.
+ *
+ * @param[in] frequency Sampling frequency in Hertz.
+ *
+ * @return zero(0) or negative error code.
+ */
+int profiler_start(int frequency);
+
+/**
+ * Stop sampling.
+ *
+ * @return zero(0) or negative error code.
+ */
+int profiler_stop(void);
+
+/**
+ * Clear the stack table and the statistics.
+ *
+ * @return zero(0) or negative error code.
+ */
+int profiler_reset(void);
+
+/**
+ * Write all sampled stacks as folded stacks, one stack per line,
+ * starting with the thread name followed by the return addresses,
+ * outermost first, and ending with the number of samples. For
+ * example ``main;0x1f3c;0x20a4;0x2110 37``.
+ *
+ * Addresses are relative to the load address of the executable and
+ * can be symbolized offline with ``bin/profiler.py``, which produces
+ * input for flame graph tools.
+ *
+ * @param[in] chout_p Output channel.
+ *
+ * @return Number of written stacks, or negative error code.
+ */
+int profiler_dump(void *chout_p);
+
+/**
+ * Get the profiler statistics.
+ *
+ * @param[out] statistics_p Current statistics.
+ *
+ * @return zero(0) or negative error code.
+ */
+int profiler_get_statistics(struct profiler_statistics_t *statistics_p);
+
+/**
+ * Add a sample of given stack to the stack table, attributed to the
+ * running thread. Called by the sampling interrupt or signal handler,
+ * and must not take the system lock.
+ *
+ * @param[in] frames_pp Return addresses, innermost first.
+ * @param[in] depth Number of return addresses.
+ */
+void profiler_sample_isr(void **frames_pp, int depth);
+
+#endif
@@ -112,4 +112,133 @@ int adc_is_valid_device(struct adc_device_t *dev_p)
             && (dev_p < &adc_device[ADC_DEVICE_MAX]));
 }
 
+int adc_stream_init(struct adc_stream_t *self_p,
+                    struct adc_driver_t *drv_p,
+                    uint16_t *samples_p,
+                    size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(drv_p != NULL, EINVAL);
+    ASSERTN(samples_p != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+
+    self_p->drv_p = drv_p;
+    self_p->samples_p = samples_p;
+    self_p->length = length;
+    self_p->filling = -1;
+    self_p->next = 0;
+    self_p->owned[0] = 0;
+    self_p->owned[1] = 0;
+    self_p->sequence = 0;
+    self_p->overruns = 0;
+
+    return (queue_init(&self_p->chout,
+                       &self_p->chout_buf[0],
+                       sizeof(self_p->chout_buf)));
+}
+
+int adc_stream_start(struct adc_stream_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->filling = -1;
+    self_p->next = 0;
+    self_p->owned[0] = 0;
+    self_p->owned[1] = 0;
+    self_p->sequence = 0;
+    self_p->overruns = 0;
+    queue_init(&self_p->chout,
+               &self_p->chout_buf[0],
+               sizeof(self_p->chout_buf));
+
+    return (adc_port_stream_start(self_p->drv_p, self_p));
+}
+
+int adc_stream_stop(struct adc_stream_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (adc_port_stream_stop(self_p->drv_p));
+}
+
+int adc_stream_read(struct adc_stream_t *self_p,
+                    struct adc_stream_buffer_t *buffer_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buffer_p != NULL, EINVAL);
+
+    if (queue_read(&self_p->chout,
+                   buffer_p,
+                   sizeof(*buffer_p)) != sizeof(*buffer_p)) {
+        return (-EIO);
+    }
+
+    return (0);
+}
+
+int adc_stream_release(struct adc_stream_t *self_p,
+                       const struct adc_stream_buffer_t *buffer_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buffer_p != NULL, EINVAL);
+
+    int index;
+
+    if (buffer_p->samples_p == &self_p->samples_p[0]) {
+        index = 0;
+    } else if (buffer_p->samples_p == &self_p->samples_p[self_p->length]) {
+        index = 1;
+    } else {
+        return (-EINVAL);
+    }
+
+    sys_lock();
+    self_p->owned[index] = 0;
+    sys_unlock();
+
+    return (0);
+}
+
+RAM_CODE uint16_t *adc_stream_get_buffer_isr(struct adc_stream_t *self_p)
+{
+    ASSERTNRN(self_p != NULL, EINVAL);
+
+    if (self_p->filling == -1) {
+        if (self_p->owned[self_p->next] == 0) {
+            self_p->filling = self_p->next;
+        } else {
+            return (NULL);
+        }
+    }
+
+    return (&self_p->samples_p[self_p->filling * self_p->length]);
+}
+
+RAM_CODE int adc_stream_buffer_done_isr(struct adc_stream_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    struct adc_stream_buffer_t buffer;
+
+    if (self_p->filling == -1) {
+        self_p->overruns++;
+
+        return (0);
+    }
+
+    buffer.samples_p = &self_p->samples_p[self_p->filling * self_p->length];
+    buffer.length = self_p->length;
+    buffer.sequence = self_p->sequence++;
+    buffer.overruns = self_p->overruns;
+    sys_uptime_isr(&buffer.timestamp);
+
+    self_p->owned[self_p->filling] = 1;
+    self_p->next = (1 - self_p->filling);
+    self_p->filling = -1;
+
+    queue_write_isr(&self_p->chout, &buffer, sizeof(buffer));
+
+    return (0);
+}
+
 #endif
@@ -37,6 +37,43 @@
  */
 #define ADC_REFERENCE_VCC ADC_PORT_REFERENCE_VCC
 
+/**
+ * A buffer of samples delivered by a stream.
+ */
+struct adc_stream_buffer_t {
+    /** The samples. */
+    uint16_t *samples_p;
+    /** Number of samples. */
+    size_t length;
+    /** Sequence number of the buffer, starting at zero when the
+        stream is started. */
+    uint32_t sequence;
+    /** Total number of buffers dropped by the stream when this
+        buffer was completed. */
+    uint32_t overruns;
+    /** System uptime when the last sample was converted. */
+    struct time_t timestamp;
+};
+
+/**
+ * Continuous sampling into two buffers. One buffer is filled while
+ * the application processes the other.
+ */
+struct adc_stream_t {
+    struct adc_driver_t *drv_p;
+    uint16_t *samples_p;
+    size_t length;
+    int filling;
+    int next;
+    int owned[2];
+    uint32_t sequence;
+    uint32_t overruns;
+    /** Completed buffers are written to this channel, which can be
+        polled with `chan_list_poll()`. */
+    struct queue_t chout;
+    char chout_buf[2 * sizeof(struct adc_stream_buffer_t) + 1];
+};
+
 extern struct adc_device_t adc_device[ADC_DEVICE_MAX];
 
 /**
@@ -135,4 +172,93 @@ int adc_convert_isr(struct adc_driver_t *self_p,
  */
 int adc_is_valid_device(struct adc_device_t *dev_p);
 
+/**
+ * Initialize given stream. Samples are written to two buffers of
+ * given length, alternately.
+ *
+ * @param[out] self_p Stream to initialize.
+ * @param[in] drv_p Initialized driver object. Its sampling rate is
+ *                  used by the stream.
+ * @param[in] samples_p Sample memory of `2 * length` samples.
+ * @param[in] length Number of samples per buffer.
+ *
+ * @return zero(0) or negative error code.
+ */
+int adc_stream_init(struct adc_stream_t *self_p,
+                    struct adc_driver_t *drv_p,
+                    uint16_t *samples_p,
+                    size_t length);
+
+/**
+ * Start free-running sampling. Completed buffers are written to the
+ * stream channel, and are owned by the application until released
+ * with `adc_stream_release()`. If both buffers are owned by the
+ * application when the next buffer should be filled, its samples are
+ * dropped and the overrun counter is incremented.
+ *
+ * Not all ports support streams.
+ *
+ * @param[in] self_p Initialized stream.
+ *
+ * @return zero(0) or negative error code.
+ */
+int adc_stream_start(struct adc_stream_t *self_p);
+
+/**
+ * Stop sampling.
+ *
+ * @param[in] self_p Started stream.
+ *
+ * @return zero(0) or negative error code.
+ */
+int adc_stream_stop(struct adc_stream_t *self_p);
+
+/**
+ * Wait for the next completed buffer.
+ *
+ * @param[in] self_p Started stream.
+ * @param[out] buffer_p Completed buffer.
+ *
+ * @return zero(0) or negative error code.
+ */
+int adc_stream_read(struct adc_stream_t *self_p,
+                    struct adc_stream_buffer_t *buffer_p);
+
+/**
+ * Give given buffer back to the stream, once its samples have been
+ * processed.
+ *
+ * @param[in] self_p Started stream.
+ * @param[in] buffer_p Buffer read with `adc_stream_read()`.
+ *
+ * @return zero(0) or negative error code.
+ */
+int adc_stream_release(struct adc_stream_t *self_p,
+                       const struct adc_stream_buffer_t *buffer_p);
+
+/**
+ * Get the buffer to fill with the next `length` samples, or NULL if
+ * both buffers are owned by the application. Called by the port, or
+ * by an application sampling with `adc_convert_isr()`, from isr or
+ * with the system lock taken.
+ *
+ * @param[in] self_p Started stream.
+ *
+ * @return Buffer to fill or NULL.
+ */
+uint16_t *adc_stream_get_buffer_isr(struct adc_stream_t *self_p);
+
+/**
+ * Signal that `length` samples have been converted since the last
+ * call to `adc_stream_get_buffer_isr()`. The filled buffer is written
+ * to the stream channel, or the overrun counter is incremented if no
+ * buffer was available. Called from isr or with the system lock
+ * taken.
+ *
+ * @param[in] self_p Started stream.
+ *
+ * @return zero(0) or negative error code.
+ */
+int adc_stream_buffer_done_isr(struct adc_stream_t *self_p);
+
 #endif
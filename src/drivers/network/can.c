@@ -77,6 +77,12 @@ int can_init(struct can_driver_t *self_p,
 
     mutex_init(&self_p->mutex);
 
+    self_p->filters.table_p = NULL;
+    self_p->filters.length = 0;
+    self_p->filters.bitmap_p = NULL;
+    self_p->filters.bitmap_counter = 0;
+    self_p->filters.rejected = 0;
+
     return (can_port_init(self_p, dev_p, speed));
 }
 
@@ -105,6 +111,42 @@ ssize_t can_read(struct can_driver_t *self_p,
     return (queue_read(&self_p->chin, frame_p, size));
 }
 
+ssize_t can_read_frames(struct can_driver_t *self_p,
+                        struct can_frame_t *frames_p,
+                        size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(frames_p != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+
+    ssize_t res;
+    size_t available;
+
+    /* Wait for the first frame. */
+    res = queue_read(&self_p->chin, &frames_p[0], sizeof(frames_p[0]));
+
+    if (res != sizeof(frames_p[0])) {
+        return (res);
+    }
+
+    /* Then read all frames already in the queue, without
+       blocking. This thread is the only reader. */
+    available = (queue_size(&self_p->chin) / sizeof(frames_p[0]));
+    available = MIN(available, length - 1);
+
+    if (available > 0) {
+        res = queue_read(&self_p->chin,
+                         &frames_p[1],
+                         available * sizeof(frames_p[0]));
+
+        if (res != available * sizeof(frames_p[0])) {
+            return (res);
+        }
+    }
+
+    return (available + 1);
+}
+
 ssize_t can_write(struct can_driver_t *self_p,
                   const struct can_frame_t *frame_p,
                   size_t size)
@@ -116,4 +158,92 @@ ssize_t can_write(struct can_driver_t *self_p,
     return (chan_write(&self_p->base, frame_p, size));
 }
 
+ssize_t can_write_frames(struct can_driver_t *self_p,
+                         const struct can_frame_t *frames_p,
+                         size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(frames_p != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+
+    ssize_t res;
+
+    res = chan_write(&self_p->base, frames_p, length * sizeof(frames_p[0]));
+
+    if (res != length * sizeof(frames_p[0])) {
+        return (res < 0 ? res : -EIO);
+    }
+
+    return (length);
+}
+
+int can_set_filters(struct can_driver_t *self_p,
+                    struct can_filter_t *table_p,
+                    size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((table_p != NULL) || (length == 0), EINVAL);
+
+    sys_lock();
+    self_p->filters.table_p = table_p;
+    self_p->filters.length = length;
+    sys_unlock();
+
+    return (0);
+}
+
+int can_set_filter_bitmap(struct can_driver_t *self_p,
+                          const uint8_t *bitmap_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    sys_lock();
+    self_p->filters.bitmap_p = bitmap_p;
+    sys_unlock();
+
+    return (0);
+}
+
+int can_filter_isr(struct can_driver_t *self_p,
+                   const struct can_frame_t *frame_p)
+{
+    struct can_filters_t *filters_p;
+    struct can_filter_t *filter_p;
+    uint32_t id;
+    size_t i;
+
+    filters_p = &self_p->filters;
+
+    if ((filters_p->table_p == NULL) && (filters_p->bitmap_p == NULL)) {
+        return (1);
+    }
+
+    id = frame_p->id;
+
+    if ((filters_p->bitmap_p != NULL)
+        && (frame_p->extended_frame == 0)
+        && (id < 8 * CAN_FILTER_BITMAP_SIZE)) {
+        if (filters_p->bitmap_p[id / 8] & (1 << (id % 8))) {
+            filters_p->bitmap_counter++;
+
+            return (1);
+        }
+    }
+
+    for (i = 0; i < filters_p->length; i++) {
+        filter_p = &filters_p->table_p[i];
+
+        if ((filter_p->extended_frame == frame_p->extended_frame)
+            && (((filter_p->id ^ id) & filter_p->mask) == 0)) {
+            filter_p->counter++;
+
+            return (1);
+        }
+    }
+
+    filters_p->rejected++;
+
+    return (0);
+}
+
 #endif
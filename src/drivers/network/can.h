@@ -30,6 +30,41 @@
 #define __DRIVERS_CAN_H__
 
 #include "simba.h"
+
+/**
+ * Size of the standard id acceptance filter bitmap in bytes, one bit
+ * per 11 bits id.
+ */
+#define CAN_FILTER_BITMAP_SIZE                            256
+
+/**
+ * An acceptance filter. A received frame matches the filter if the
+ * frame type is the same and all id bits set in `mask` are equal.
+ */
+struct can_filter_t {
+    uint32_t id;                    /* Id to match. */
+    uint32_t mask;                  /* Id bits to compare. */
+    int extended_frame;             /* Match extended frames if one(1),
+                                       otherwise standard frames. */
+    uint32_t counter;               /* Number of frames accepted by
+                                       this filter. */
+};
+
+/**
+ * Acceptance filters of a driver. A frame is accepted if its id is
+ * set in the standard id bitmap, or if it matches a filter in the
+ * filter table. All frames are accepted if neither a bitmap nor a
+ * table is set.
+ */
+struct can_filters_t {
+    struct can_filter_t *table_p;
+    size_t length;
+    const uint8_t *bitmap_p;
+    uint32_t bitmap_counter;        /* Number of frames accepted by the
+                                       bitmap. */
+    uint32_t rejected;              /* Number of rejected frames. */
+};
+
 #include "can_port.h"
 
 #define CAN_SPEED_1000KBPS CAN_PORT_SPEED_1000KBPS
@@ -118,6 +153,21 @@ ssize_t can_read(struct can_driver_t *self_p,
                  struct can_frame_t *frame_p,
                  size_t size);
 
+/**
+ * Read up to given number of CAN frames from the CAN bus. Blocks
+ * until at least one frame is received, then returns all frames
+ * available in the input queue, but not more than `length`.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[out] frames_p Array of read frames.
+ * @param[in] length Maximum number of frames to read.
+ *
+ * @return Number of read frames or negative error code.
+ */
+ssize_t can_read_frames(struct can_driver_t *self_p,
+                        struct can_frame_t *frames_p,
+                        size_t length);
+
 /**
  * Write one or more CAN frames to the CAN bus. Blocks until the
  * frame(s) have been transmitted.
@@ -133,4 +183,65 @@ ssize_t can_write(struct can_driver_t *self_p,
                   const struct can_frame_t *frame_p,
                   size_t size);
 
+/**
+ * Write given number of CAN frames to the CAN bus in a single call
+ * to the port. Blocks until all frames have been transmitted.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] frames_p Array of frames to write.
+ * @param[in] length Number of frames to write.
+ *
+ * @return Number of written frames or negative error code.
+ */
+ssize_t can_write_frames(struct can_driver_t *self_p,
+                         const struct can_frame_t *frames_p,
+                         size_t length);
+
+/**
+ * Set the acceptance filter table of given driver. Received frames
+ * not accepted by any filter are dropped in the receive interrupt
+ * before they are written to the input queue, and thus never wake up
+ * the reader. The table is used by the driver until replaced, and
+ * the counter of each filter is incremented for every frame it
+ * accepts.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] table_p Filter table, or NULL to remove the table.
+ * @param[in] length Number of filters in the table.
+ *
+ * @return zero(0) or negative error code.
+ */
+int can_set_filters(struct can_driver_t *self_p,
+                    struct can_filter_t *table_p,
+                    size_t length);
+
+/**
+ * Set the standard id acceptance bitmap of given driver. Standard
+ * frames with id `id` are accepted if bit `id % 8` in byte `id / 8`
+ * is set. Checking the bitmap takes constant time, independent of
+ * the number of accepted ids.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] bitmap_p Bitmap of ``CAN_FILTER_BITMAP_SIZE`` bytes, or
+ *                     NULL to remove the bitmap.
+ *
+ * @return zero(0) or negative error code.
+ */
+int can_set_filter_bitmap(struct can_driver_t *self_p,
+                          const uint8_t *bitmap_p);
+
+/**
+ * Check if given received frame is accepted by the acceptance filters
+ * of given driver, and update the filter counters. Called by the port
+ * in the receive path, from interrupt context or with the system lock
+ * taken (see `sys_lock()`).
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] frame_p Received frame.
+ *
+ * @return true(1) if the frame is accepted, otherwise false(0).
+ */
+int can_filter_isr(struct can_driver_t *self_p,
+                   const struct can_frame_t *frame_p);
+
 #endif
@@ -318,4 +318,188 @@ ssize_t i2c_slave_write(struct i2c_driver_t *self_p,
     return (i2c_port_slave_write(self_p, buf_p, size));
 }
 
+/**
+ * Transfer all descriptors in given request.
+ */
+static ssize_t request_execute(struct i2c_request_t *request_p)
+{
+    struct i2c_descriptor_t *descriptor_p;
+    ssize_t res;
+    ssize_t size;
+    size_t i;
+
+    size = 0;
+
+    for (i = 0; i < request_p->length; i++) {
+        descriptor_p = &request_p->descriptors_p[i];
+
+        if (descriptor_p->rxbuf_p != NULL) {
+            res = i2c_read(request_p->drv_p,
+                           descriptor_p->address,
+                           descriptor_p->rxbuf_p,
+                           descriptor_p->size);
+        } else {
+            res = i2c_write(request_p->drv_p,
+                            descriptor_p->address,
+                            descriptor_p->txbuf_p,
+                            descriptor_p->size);
+        }
+
+        if (res != descriptor_p->size) {
+            return (res < 0 ? res : -EIO);
+        }
+
+        size += res;
+    }
+
+    return (size);
+}
+
+static void *queue_main(void *arg_p)
+{
+    struct i2c_queue_t *self_p;
+    struct i2c_request_t *request_p;
+
+    self_p = arg_p;
+
+    thrd_set_name("i2c_queue");
+
+    while (1) {
+        sys_lock();
+
+        request_p = self_p->head_p;
+
+        if (request_p == NULL) {
+            self_p->idle = 1;
+            thrd_suspend_isr(NULL);
+            request_p = self_p->head_p;
+        }
+
+        self_p->head_p = request_p->next_p;
+
+        if (self_p->head_p == NULL) {
+            self_p->tail_p = NULL;
+        }
+
+        sys_unlock();
+
+        request_p->res = request_execute(request_p);
+
+        if (request_p->completion.callback != NULL) {
+            request_p->completion.callback(request_p,
+                                           request_p->completion.arg_p);
+        }
+
+        if (request_p->completion.event_p != NULL) {
+            event_write(request_p->completion.event_p,
+                        &request_p->completion.mask,
+                        sizeof(request_p->completion.mask));
+        }
+    }
+
+    return (NULL);
+}
+
+int i2c_request_init(struct i2c_request_t *self_p,
+                     struct i2c_driver_t *drv_p,
+                     struct i2c_descriptor_t *descriptors_p,
+                     size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(drv_p != NULL, EINVAL);
+    ASSERTN((descriptors_p != NULL) || (length == 0), EINVAL);
+
+    self_p->drv_p = drv_p;
+    self_p->descriptors_p = descriptors_p;
+    self_p->length = length;
+    self_p->res = -EINPROGRESS;
+    self_p->completion.event_p = NULL;
+    self_p->completion.mask = 0;
+    self_p->completion.callback = NULL;
+    self_p->completion.arg_p = NULL;
+    self_p->next_p = NULL;
+
+    return (0);
+}
+
+int i2c_request_set_event(struct i2c_request_t *self_p,
+                          struct event_t *event_p,
+                          uint32_t mask)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->completion.event_p = event_p;
+    self_p->completion.mask = mask;
+
+    return (0);
+}
+
+int i2c_request_set_callback(struct i2c_request_t *self_p,
+                             i2c_request_complete_t callback,
+                             void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->completion.callback = callback;
+    self_p->completion.arg_p = arg_p;
+
+    return (0);
+}
+
+ssize_t i2c_request_get_result(struct i2c_request_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (self_p->res);
+}
+
+int i2c_queue_init(struct i2c_queue_t *self_p, int prio)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->head_p = NULL;
+    self_p->tail_p = NULL;
+    self_p->idle = 0;
+    self_p->thrd_p = thrd_spawn(queue_main,
+                                self_p,
+                                prio,
+                                self_p->stack,
+                                sizeof(self_p->stack));
+
+    if (self_p->thrd_p == NULL) {
+        return (-ENOMEM);
+    }
+
+    return (0);
+}
+
+int i2c_queue_submit(struct i2c_queue_t *self_p,
+                     struct i2c_request_t *request_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(request_p != NULL, EINVAL);
+
+    request_p->res = -EINPROGRESS;
+    request_p->next_p = NULL;
+
+    sys_lock();
+
+    if (self_p->tail_p == NULL) {
+        self_p->head_p = request_p;
+    } else {
+        self_p->tail_p->next_p = request_p;
+    }
+
+    self_p->tail_p = request_p;
+
+    if (self_p->idle == 1) {
+        self_p->idle = 0;
+        thrd_resume_isr(self_p->thrd_p, 0);
+    }
+
+    sys_unlock();
+
+    return (0);
+}
+
 #endif
@@ -43,6 +43,55 @@
 #define I2C_BAUDRATE_400KBPS     I2C_PORT_BAUDRATE_400KBPS
 #define I2C_BAUDRATE_100KBPS     I2C_PORT_BAUDRATE_100KBPS
 
+/**
+ * An asynchronous transfer descriptor. Data is read from the slave
+ * into `rxbuf_p` if it is not NULL, otherwise `txbuf_p` is written to
+ * the slave.
+ */
+struct i2c_descriptor_t {
+    int address;
+    void *rxbuf_p;
+    const void *txbuf_p;
+    size_t size;
+};
+
+struct i2c_request_t;
+
+/**
+ * Request completion callback, called from the queue thread.
+ */
+typedef void (*i2c_request_complete_t)(struct i2c_request_t *request_p,
+                                       void *arg_p);
+
+/**
+ * A list of descriptors transferred back to back by a queue.
+ */
+struct i2c_request_t {
+    struct i2c_driver_t *drv_p;
+    struct i2c_descriptor_t *descriptors_p;
+    size_t length;
+    ssize_t res;
+    struct {
+        struct event_t *event_p;
+        uint32_t mask;
+        i2c_request_complete_t callback;
+        void *arg_p;
+    } completion;
+    struct i2c_request_t *next_p;
+};
+
+/**
+ * An asynchronous transfer queue. Its thread executes the submitted
+ * requests in order, on behalf of the submitting threads.
+ */
+struct i2c_queue_t {
+    struct i2c_request_t *head_p;
+    struct i2c_request_t *tail_p;
+    struct thrd_t *thrd_p;
+    int idle;
+    THRD_STACK(stack, 1024);
+};
+
 extern struct i2c_device_t i2c_device[I2C_DEVICE_MAX];
 
 /**
@@ -187,4 +236,86 @@ ssize_t i2c_slave_write(struct i2c_driver_t *self_p,
                         const void *buf_p,
                         size_t size);
 
+/**
+ * Initialize given request. A request can be submitted again once
+ * completed.
+ *
+ * @param[out] self_p Request to initialize.
+ * @param[in] drv_p Driver to transfer with.
+ * @param[in] descriptors_p Descriptors to transfer, in order.
+ * @param[in] length Number of descriptors.
+ *
+ * @return zero(0) or negative error code.
+ */
+int i2c_request_init(struct i2c_request_t *self_p,
+                     struct i2c_driver_t *drv_p,
+                     struct i2c_descriptor_t *descriptors_p,
+                     size_t length);
+
+/**
+ * Write given mask to given event channel when the request is
+ * completed.
+ *
+ * @param[in] self_p Initialized request.
+ * @param[in] event_p Event channel to write to.
+ * @param[in] mask Event mask to write.
+ *
+ * @return zero(0) or negative error code.
+ */
+int i2c_request_set_event(struct i2c_request_t *self_p,
+                          struct event_t *event_p,
+                          uint32_t mask);
+
+/**
+ * Call given function when the request is completed. The callback is
+ * called from the queue thread, before any event is written.
+ *
+ * @param[in] self_p Initialized request.
+ * @param[in] callback Function to call.
+ * @param[in] arg_p Callback argument.
+ *
+ * @return zero(0) or negative error code.
+ */
+int i2c_request_set_callback(struct i2c_request_t *self_p,
+                             i2c_request_complete_t callback,
+                             void *arg_p);
+
+/**
+ * Get the result of a completed request.
+ *
+ * @param[in] self_p Completed request.
+ *
+ * @return Number of transferred bytes or negative error code.
+ */
+ssize_t i2c_request_get_result(struct i2c_request_t *self_p);
+
+/**
+ * Initialize given transfer queue and spawn its thread. Typically one
+ * queue is used per I2C device, shared by all slaves on the bus.
+ *
+ * @param[out] self_p Queue to initialize.
+ * @param[in] prio Queue thread priority.
+ *
+ * @return zero(0) or negative error code.
+ */
+int i2c_queue_init(struct i2c_queue_t *self_p, int prio);
+
+/**
+ * Submit given request to given queue and return immediately. The
+ * queue thread transfers all descriptors in the request back to back
+ * and then signals completion. Requests are executed in submission
+ * order. The descriptors and buffers must be kept valid until the
+ * request is completed.
+ *
+ * If a transfer fails, the remaining descriptors are skipped and the
+ * request result is set to the error code.
+ *
+ * @param[in] self_p Initialized queue.
+ * @param[in] request_p Request to submit.
+ *
+ * @return zero(0) or negative error code.
+ */
+int i2c_queue_submit(struct i2c_queue_t *self_p,
+                     struct i2c_request_t *request_p);
+
 #endif
@@ -189,4 +189,206 @@ ssize_t spi_put(struct spi_driver_t *self_p,
     return (spi_write(self_p, &data, 1));
 }
 
+/**
+ * Transfer all descriptors in given request with the bus taken once.
+ */
+static ssize_t request_execute(struct spi_request_t *request_p)
+{
+    struct spi_driver_t *drv_p;
+    struct spi_descriptor_t *descriptor_p;
+    ssize_t res;
+    ssize_t size;
+    size_t i;
+    int selected;
+
+    drv_p = request_p->drv_p;
+    size = 0;
+    selected = 0;
+
+    spi_take_bus(drv_p);
+
+    for (i = 0; i < request_p->length; i++) {
+        descriptor_p = &request_p->descriptors_p[i];
+
+        if (descriptor_p->flags & SPI_DESCRIPTOR_SELECT) {
+            spi_select(drv_p);
+            selected = 1;
+        }
+
+        if (descriptor_p->size > 0) {
+            res = spi_transfer(drv_p,
+                               descriptor_p->rxbuf_p,
+                               descriptor_p->txbuf_p,
+                               descriptor_p->size);
+
+            if (res != descriptor_p->size) {
+                if (selected == 1) {
+                    spi_deselect(drv_p);
+                }
+
+                size = (res < 0 ? res : -EIO);
+                break;
+            }
+
+            size += res;
+        }
+
+        if (descriptor_p->flags & SPI_DESCRIPTOR_DESELECT) {
+            spi_deselect(drv_p);
+            selected = 0;
+        }
+    }
+
+    spi_give_bus(drv_p);
+
+    return (size);
+}
+
+static void *queue_main(void *arg_p)
+{
+    struct spi_queue_t *self_p;
+    struct spi_request_t *request_p;
+
+    self_p = arg_p;
+
+    thrd_set_name("spi_queue");
+
+    while (1) {
+        sys_lock();
+
+        request_p = self_p->head_p;
+
+        if (request_p == NULL) {
+            self_p->idle = 1;
+            thrd_suspend_isr(NULL);
+            request_p = self_p->head_p;
+        }
+
+        self_p->head_p = request_p->next_p;
+
+        if (self_p->head_p == NULL) {
+            self_p->tail_p = NULL;
+        }
+
+        sys_unlock();
+
+        request_p->res = request_execute(request_p);
+
+        if (request_p->completion.callback != NULL) {
+            request_p->completion.callback(request_p,
+                                           request_p->completion.arg_p);
+        }
+
+        if (request_p->completion.event_p != NULL) {
+            event_write(request_p->completion.event_p,
+                        &request_p->completion.mask,
+                        sizeof(request_p->completion.mask));
+        }
+    }
+
+    return (NULL);
+}
+
+int spi_request_init(struct spi_request_t *self_p,
+                     struct spi_driver_t *drv_p,
+                     struct spi_descriptor_t *descriptors_p,
+                     size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(drv_p != NULL, EINVAL);
+    ASSERTN((descriptors_p != NULL) || (length == 0), EINVAL);
+
+    self_p->drv_p = drv_p;
+    self_p->descriptors_p = descriptors_p;
+    self_p->length = length;
+    self_p->res = -EINPROGRESS;
+    self_p->completion.event_p = NULL;
+    self_p->completion.mask = 0;
+    self_p->completion.callback = NULL;
+    self_p->completion.arg_p = NULL;
+    self_p->next_p = NULL;
+
+    return (0);
+}
+
+int spi_request_set_event(struct spi_request_t *self_p,
+                          struct event_t *event_p,
+                          uint32_t mask)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->completion.event_p = event_p;
+    self_p->completion.mask = mask;
+
+    return (0);
+}
+
+int spi_request_set_callback(struct spi_request_t *self_p,
+                             spi_request_complete_t callback,
+                             void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->completion.callback = callback;
+    self_p->completion.arg_p = arg_p;
+
+    return (0);
+}
+
+ssize_t spi_request_get_result(struct spi_request_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (self_p->res);
+}
+
+int spi_queue_init(struct spi_queue_t *self_p, int prio)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->head_p = NULL;
+    self_p->tail_p = NULL;
+    self_p->idle = 0;
+    self_p->thrd_p = thrd_spawn(queue_main,
+                                self_p,
+                                prio,
+                                self_p->stack,
+                                sizeof(self_p->stack));
+
+    if (self_p->thrd_p == NULL) {
+        return (-ENOMEM);
+    }
+
+    return (0);
+}
+
+int spi_queue_submit(struct spi_queue_t *self_p,
+                     struct spi_request_t *request_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(request_p != NULL, EINVAL);
+
+    request_p->res = -EINPROGRESS;
+    request_p->next_p = NULL;
+
+    sys_lock();
+
+    if (self_p->tail_p == NULL) {
+        self_p->head_p = request_p;
+    } else {
+        self_p->tail_p->next_p = request_p;
+    }
+
+    self_p->tail_p = request_p;
+
+    if (self_p->idle == 1) {
+        self_p->idle = 0;
+        thrd_resume_isr(self_p->thrd_p, 0);
+    }
+
+    sys_unlock();
+
+    return (0);
+}
+
 #endif
@@ -45,6 +45,60 @@
 #define SPI_SPEED_250KBPS SPI_PORT_SPEED_250KBPS
 #define SPI_SPEED_125KBPS SPI_PORT_SPEED_125KBPS
 
+/* Descriptor flags. */
+#define SPI_DESCRIPTOR_SELECT                          (1 << 0)
+#define SPI_DESCRIPTOR_DESELECT                        (1 << 1)
+
+/**
+ * An asynchronous transfer descriptor. The slave is selected before
+ * the transfer if `SPI_DESCRIPTOR_SELECT` is set in `flags`, and
+ * deselected after it if `SPI_DESCRIPTOR_DESELECT` is set. `size` may
+ * be zero to only change the slave select pin.
+ */
+struct spi_descriptor_t {
+    void *rxbuf_p;
+    const void *txbuf_p;
+    size_t size;
+    int flags;
+};
+
+struct spi_request_t;
+
+/**
+ * Request completion callback, called from the queue thread.
+ */
+typedef void (*spi_request_complete_t)(struct spi_request_t *request_p,
+                                       void *arg_p);
+
+/**
+ * A list of descriptors transferred back to back by a queue.
+ */
+struct spi_request_t {
+    struct spi_driver_t *drv_p;
+    struct spi_descriptor_t *descriptors_p;
+    size_t length;
+    ssize_t res;
+    struct {
+        struct event_t *event_p;
+        uint32_t mask;
+        spi_request_complete_t callback;
+        void *arg_p;
+    } completion;
+    struct spi_request_t *next_p;
+};
+
+/**
+ * An asynchronous transfer queue. Its thread executes the submitted
+ * requests in order, on behalf of the submitting threads.
+ */
+struct spi_queue_t {
+    struct spi_request_t *head_p;
+    struct spi_request_t *tail_p;
+    struct thrd_t *thrd_p;
+    int idle;
+    THRD_STACK(stack, 1024);
+};
+
 extern struct spi_device_t spi_device[SPI_DEVICE_MAX];
 
 /**
@@ -198,4 +252,88 @@ ssize_t spi_get(struct spi_driver_t *self_p, uint8_t *data_p);
  */
 ssize_t spi_put(struct spi_driver_t *self_p, uint8_t data);
 
+/**
+ * Initialize given request. A request can be submitted again once
+ * completed.
+ *
+ * @param[out] self_p Request to initialize.
+ * @param[in] drv_p Driver to transfer with.
+ * @param[in] descriptors_p Descriptors to transfer, in order.
+ * @param[in] length Number of descriptors.
+ *
+ * @return zero(0) or negative error code.
+ */
+int spi_request_init(struct spi_request_t *self_p,
+                     struct spi_driver_t *drv_p,
+                     struct spi_descriptor_t *descriptors_p,
+                     size_t length);
+
+/**
+ * Write given mask to given event channel when the request is
+ * completed.
+ *
+ * @param[in] self_p Initialized request.
+ * @param[in] event_p Event channel to write to.
+ * @param[in] mask Event mask to write.
+ *
+ * @return zero(0) or negative error code.
+ */
+int spi_request_set_event(struct spi_request_t *self_p,
+                          struct event_t *event_p,
+                          uint32_t mask);
+
+/**
+ * Call given function when the request is completed. The callback is
+ * called from the queue thread, before any event is written.
+ *
+ * @param[in] self_p Initialized request.
+ * @param[in] callback Function to call.
+ * @param[in] arg_p Callback argument.
+ *
+ * @return zero(0) or negative error code.
+ */
+int spi_request_set_callback(struct spi_request_t *self_p,
+                             spi_request_complete_t callback,
+                             void *arg_p);
+
+/**
+ * Get the result of a completed request.
+ *
+ * @param[in] self_p Completed request.
+ *
+ * @return Number of transferred bytes or negative error code.
+ */
+ssize_t spi_request_get_result(struct spi_request_t *self_p);
+
+/**
+ * Initialize given transfer queue and spawn its thread. Typically one
+ * queue is used per SPI device, shared by all drivers on the bus.
+ *
+ * @param[out] self_p Queue to initialize.
+ * @param[in] prio Queue thread priority.
+ *
+ * @return zero(0) or negative error code.
+ */
+int spi_queue_init(struct spi_queue_t *self_p, int prio);
+
+/**
+ * Submit given request to given queue and return immediately. The
+ * queue thread takes the bus, transfers all descriptors in the
+ * request back to back, gives the bus and then signals completion.
+ * Requests are executed in submission order, without idling between
+ * them. The descriptors and buffers must be kept valid until the
+ * request is completed.
+ *
+ * If a transfer fails, the slave is deselected, the remaining
+ * descriptors are skipped and the request result is set to the error
+ * code.
+ *
+ * @param[in] self_p Initialized queue.
+ * @param[in] request_p Request to submit.
+ *
+ * @return zero(0) or negative error code.
+ */
+int spi_queue_submit(struct spi_queue_t *self_p,
+                     struct spi_request_t *request_p);
+
 #endif
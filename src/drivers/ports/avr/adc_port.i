@@ -200,3 +200,14 @@ int adc_port_convert_isr(struct adc_driver_t *self_p,
 
     return (0);
 }
+
+static int adc_port_stream_start(struct adc_driver_t *self_p,
+                                 struct adc_stream_t *stream_p)
+{
+    return (-ENOSYS);
+}
+
+static int adc_port_stream_stop(struct adc_driver_t *self_p)
+{
+    return (-ENOSYS);
+}
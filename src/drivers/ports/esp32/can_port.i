@@ -153,6 +153,11 @@ static void read_frame_from_hw(struct can_driver_t *self_p,
     /* Let the hardware know the frame has been read. */
     regs_p->COMMAND = ESP32_CAN_COMMAND_RELEASE_RECV_BUF;
 
+    /* Drop frames rejected by the acceptance filters. */
+    if (can_filter_isr(self_p, &frame) == 0) {
+        return;
+    }
+
     /* Write the received frame to the application input channel. */
     if (queue_unused_size_isr(&self_p->chin) >= sizeof(frame)) {
         queue_write_isr(&self_p->chin,
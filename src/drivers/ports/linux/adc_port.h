@@ -29,15 +29,26 @@
 #ifndef __DRIVERS_ADC_PORT_H__
 #define __DRIVERS_ADC_PORT_H__
 
+#include <stdio.h>
+#include <pthread.h>
 
 #define ADC_PORT_REFERENCE_VCC 0
 
+struct adc_stream_t;
+
 struct adc_device_t {
     struct adc_driver_t *drv_p;
 };
 
 struct adc_driver_t {
     struct adc_device_t *dev_p;
+    long sampling_rate;
+    struct {
+        struct adc_stream_t *stream_p;
+        FILE *file_p;
+        volatile int running;
+        pthread_t thrd;
+    } replay;
 };
 
 #endif
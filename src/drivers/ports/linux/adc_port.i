@@ -26,6 +26,75 @@
  * This file is part of the Simba project.
  */
 
+#include <time.h>
+
+/**
+ * Read the next sample from the replay file, starting over from the
+ * beginning at end of file.
+ */
+static uint16_t replay_read_sample(FILE *file_p)
+{
+    unsigned int value;
+
+    if (fscanf(file_p, "%u", &value) != 1) {
+        rewind(file_p);
+
+        if (fscanf(file_p, "%u", &value) != 1) {
+            value = 0;
+        }
+    }
+
+    return (value);
+}
+
+/**
+ * Replay samples from a file into the stream at the sampling rate of
+ * the driver, one buffer at a time.
+ */
+static void *replay_main(void *arg_p)
+{
+    struct adc_driver_t *self_p;
+    struct adc_stream_t *stream_p;
+    struct timespec deadline;
+    long long period;
+    uint16_t *samples_p;
+    size_t i;
+
+    self_p = arg_p;
+    stream_p = self_p->replay.stream_p;
+    period = (1000000000ll * stream_p->length / self_p->sampling_rate);
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    while (self_p->replay.running == 1) {
+        deadline.tv_sec += ((deadline.tv_nsec + period) / 1000000000ll);
+        deadline.tv_nsec = ((deadline.tv_nsec + period) % 1000000000ll);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+
+        /* A buffer is claimed when the period's samples are written,
+           not when the period starts, giving the application a full
+           period to release the previous buffer. */
+        sys_lock();
+        samples_p = adc_stream_get_buffer_isr(stream_p);
+        sys_unlock();
+
+        /* Samples are consumed from the file even if dropped, to
+           keep the replayed signal continuous in time. */
+        for (i = 0; i < stream_p->length; i++) {
+            if (samples_p != NULL) {
+                samples_p[i] = replay_read_sample(self_p->replay.file_p);
+            } else {
+                replay_read_sample(self_p->replay.file_p);
+            }
+        }
+
+        sys_lock();
+        adc_stream_buffer_done_isr(stream_p);
+        sys_unlock();
+    }
+
+    return (NULL);
+}
+
 static int adc_port_module_init(void)
 {
     return (0);
@@ -37,6 +106,10 @@ static int adc_port_init(struct adc_driver_t *self_p,
                          int reference,
                          int sampling_rate)
 {
+    self_p->dev_p = dev_p;
+    self_p->sampling_rate = sampling_rate;
+    self_p->replay.running = 0;
+
     return (0);
 }
 
@@ -57,3 +130,52 @@ int adc_port_convert_isr(struct adc_driver_t *self_p,
 {
     return (-1);
 }
+
+static int adc_port_stream_start(struct adc_driver_t *self_p,
+                                 struct adc_stream_t *stream_p)
+{
+    char path[128];
+
+    if (self_p->replay.running == 1) {
+        return (-EBUSY);
+    }
+
+    snprintf(&path[0],
+             sizeof(path),
+             CONFIG_LINUX_ADC_REPLAY_FILE,
+             (int)(self_p->dev_p - &adc_device[0]));
+
+    self_p->replay.file_p = fopen(&path[0], "r");
+
+    if (self_p->replay.file_p == NULL) {
+        return (-ENOENT);
+    }
+
+    self_p->replay.stream_p = stream_p;
+    self_p->replay.running = 1;
+
+    if (pthread_create(&self_p->replay.thrd,
+                       NULL,
+                       replay_main,
+                       self_p) != 0) {
+        self_p->replay.running = 0;
+        fclose(self_p->replay.file_p);
+
+        return (-ENOMEM);
+    }
+
+    return (0);
+}
+
+static int adc_port_stream_stop(struct adc_driver_t *self_p)
+{
+    if (self_p->replay.running == 0) {
+        return (0);
+    }
+
+    self_p->replay.running = 0;
+    pthread_join(self_p->replay.thrd, NULL);
+    fclose(self_p->replay.file_p);
+
+    return (0);
+}
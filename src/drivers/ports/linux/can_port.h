@@ -42,6 +42,11 @@ struct can_driver_t {
     struct can_device_t *dev_p;
     struct queue_t chin;
     struct mutex_t mutex;
+    struct can_filters_t filters;
+#if CONFIG_CAN_SOCKETCAN == 1
+    int socket;
+    pthread_t thrd;
+#endif
 };
 
 #endif
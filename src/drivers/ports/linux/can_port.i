@@ -26,6 +26,263 @@
  * This file is part of the Simba project.
  */
 
+#if CONFIG_CAN_SOCKETCAN == 1
+
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+#define CAN_INDEX(dev_p) (dev_p - &can_device[0])
+
+/**
+ * Convert given SocketCAN frame to a Simba frame.
+ */
+static void frame_from_socketcan(struct can_frame_t *frame_p,
+                                 const struct can_frame *socketcan_frame_p)
+{
+    canid_t id;
+
+    id = socketcan_frame_p->can_id;
+
+    if (id & CAN_EFF_FLAG) {
+        frame_p->id = (id & CAN_EFF_MASK);
+        frame_p->extended_frame = 1;
+    } else {
+        frame_p->id = (id & CAN_SFF_MASK);
+        frame_p->extended_frame = 0;
+    }
+
+    frame_p->rtr = ((id & CAN_RTR_FLAG) != 0);
+    frame_p->size = MIN(socketcan_frame_p->can_dlc, 8);
+#if CONFIG_CAN_FRAME_TIMESTAMP == 1
+    frame_p->timestamp = 0;
+#endif
+    memcpy(&frame_p->data.u8[0], &socketcan_frame_p->data[0], 8);
+}
+
+/**
+ * Convert given Simba frame to a SocketCAN frame.
+ */
+static void frame_to_socketcan(struct can_frame *socketcan_frame_p,
+                               const struct can_frame_t *frame_p)
+{
+    memset(socketcan_frame_p, 0, sizeof(*socketcan_frame_p));
+
+    if (frame_p->extended_frame == 1) {
+        socketcan_frame_p->can_id = ((frame_p->id & CAN_EFF_MASK)
+                                     | CAN_EFF_FLAG);
+    } else {
+        socketcan_frame_p->can_id = (frame_p->id & CAN_SFF_MASK);
+    }
+
+    if (frame_p->rtr == 1) {
+        socketcan_frame_p->can_id |= CAN_RTR_FLAG;
+    }
+
+    socketcan_frame_p->can_dlc = MIN(frame_p->size, 8);
+    memcpy(&socketcan_frame_p->data[0], &frame_p->data.u8[0], 8);
+}
+
+/**
+ * Receive frames from the SocketCAN socket, several per system call,
+ * and write accepted frames to the input queue with the system lock
+ * taken once per batch.
+ */
+static void *reader_main(void *arg_p)
+{
+    struct can_driver_t *self_p;
+    struct can_frame socketcan_frames[CONFIG_CAN_SOCKETCAN_BATCH_SIZE];
+    struct mmsghdr messages[CONFIG_CAN_SOCKETCAN_BATCH_SIZE];
+    struct iovec iovecs[CONFIG_CAN_SOCKETCAN_BATCH_SIZE];
+    struct can_frame_t frame;
+    int res;
+    int i;
+
+    self_p = arg_p;
+    memset(&messages[0], 0, sizeof(messages));
+
+    for (i = 0; i < membersof(messages); i++) {
+        iovecs[i].iov_base = &socketcan_frames[i];
+        iovecs[i].iov_len = sizeof(socketcan_frames[i]);
+        messages[i].msg_hdr.msg_iov = &iovecs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    while (1) {
+        res = recvmmsg(self_p->socket,
+                       &messages[0],
+                       membersof(messages),
+                       MSG_WAITFORONE,
+                       NULL);
+
+        if (res <= 0) {
+            break;
+        }
+
+        sys_lock();
+
+        for (i = 0; i < res; i++) {
+            if (messages[i].msg_len != sizeof(socketcan_frames[i])) {
+                continue;
+            }
+
+            frame_from_socketcan(&frame, &socketcan_frames[i]);
+
+            if (can_filter_isr(self_p, &frame) == 0) {
+                continue;
+            }
+
+            if (queue_unused_size_isr(&self_p->chin) >= sizeof(frame)) {
+                queue_write_isr(&self_p->chin, &frame, sizeof(frame));
+            }
+        }
+
+        sys_unlock();
+    }
+
+    return (NULL);
+}
+
+static ssize_t write_cb(void *arg_p,
+                        const void *buf_p,
+                        size_t size)
+{
+    struct can_driver_t *self_p;
+    const struct can_frame_t *frames_p;
+    struct can_frame socketcan_frames[CONFIG_CAN_SOCKETCAN_BATCH_SIZE];
+    struct mmsghdr messages[CONFIG_CAN_SOCKETCAN_BATCH_SIZE];
+    struct iovec iovecs[CONFIG_CAN_SOCKETCAN_BATCH_SIZE];
+    size_t length;
+    size_t offset;
+    int count;
+    int res;
+    int i;
+
+    self_p = arg_p;
+    frames_p = buf_p;
+    length = (size / sizeof(*frames_p));
+    offset = 0;
+
+    mutex_lock(&self_p->mutex);
+
+    /* Transmit up to a batch of frames per system call. */
+    while (offset < length) {
+        count = MIN(length - offset, membersof(messages));
+        memset(&messages[0], 0, count * sizeof(messages[0]));
+
+        for (i = 0; i < count; i++) {
+            frame_to_socketcan(&socketcan_frames[i], &frames_p[offset + i]);
+            iovecs[i].iov_base = &socketcan_frames[i];
+            iovecs[i].iov_len = sizeof(socketcan_frames[i]);
+            messages[i].msg_hdr.msg_iov = &iovecs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        res = sendmmsg(self_p->socket, &messages[0], count, 0);
+
+        if (res < 0) {
+            /* The interface transmit queue is full. */
+            if (errno == ENOBUFS) {
+                usleep(100);
+                continue;
+            }
+
+            size = -EIO;
+            break;
+        }
+
+        offset += res;
+    }
+
+    mutex_unlock(&self_p->mutex);
+
+    return (size);
+}
+
+static int can_port_module_init()
+{
+    return (0);
+}
+
+static int can_port_init(struct can_driver_t *self_p,
+                         struct can_device_t *dev_p,
+                         uint32_t speed)
+{
+    self_p->socket = -1;
+
+    return (0);
+}
+
+static int can_port_start(struct can_driver_t *self_p)
+{
+    struct sockaddr_can addr;
+    struct ifreq ifr;
+    int socket_fd;
+
+    socket_fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+
+    if (socket_fd < 0) {
+        return (-EIO);
+    }
+
+    memset(&ifr, 0, sizeof(ifr));
+    snprintf(&ifr.ifr_name[0],
+             sizeof(ifr.ifr_name),
+             CONFIG_CAN_SOCKETCAN_INTERFACE,
+             (int)CAN_INDEX(self_p->dev_p));
+
+    if (ioctl(socket_fd, SIOCGIFINDEX, &ifr) != 0) {
+        close(socket_fd);
+
+        return (-ENODEV);
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+
+    if (bind(socket_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(socket_fd);
+
+        return (-EIO);
+    }
+
+    self_p->socket = socket_fd;
+    self_p->dev_p->drv_p = self_p;
+
+    if (pthread_create(&self_p->thrd, NULL, reader_main, self_p) != 0) {
+        close(socket_fd);
+        self_p->socket = -1;
+        self_p->dev_p->drv_p = NULL;
+
+        return (-ENOMEM);
+    }
+
+    return (0);
+}
+
+static int can_port_stop(struct can_driver_t *self_p)
+{
+    if (self_p->socket == -1) {
+        return (0);
+    }
+
+    pthread_cancel(self_p->thrd);
+    pthread_join(self_p->thrd, NULL);
+    close(self_p->socket);
+    self_p->socket = -1;
+    self_p->dev_p->drv_p = NULL;
+
+    return (0);
+}
+
+#else
+
 #include "socket_device.h"
 
 static ssize_t write_cb(void *arg_p,
@@ -77,3 +334,5 @@ static int can_port_stop(struct can_driver_t *self_p)
 
     return (0);
 }
+
+#endif
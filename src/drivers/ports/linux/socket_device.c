@@ -32,6 +32,7 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netdb.h>
 
 /**
@@ -48,6 +49,31 @@
 #define TYPE_CAN_DEVICE_RESPONSE                          (8)
 #define TYPE_I2C_DEVICE_REQUEST                           (9)
 #define TYPE_I2C_DEVICE_RESPONSE                         (10)
+/* Types 11 and 12 are reserved for the SPI device. */
+#define TYPE_VERSION_REQUEST                             (13)
+#define TYPE_VERSION_RESPONSE                            (14)
+
+/**
+ * Protocol versions. Version 1 is the original text protocol, and
+ * version 2 transfers UART and CAN data in length prefixed binary
+ * batches.
+ */
+#define PROTOCOL_VERSION_TEXT                             (1)
+#define PROTOCOL_VERSION_BINARY                           (2)
+#define PROTOCOL_VERSION_MAX          PROTOCOL_VERSION_BINARY
+
+/**
+ * Binary CAN frame flags.
+ */
+#define CAN_FLAGS_EXTENDED_FRAME                       (0x01)
+#define CAN_FLAGS_RTR                                  (0x02)
+
+/**
+ * Size of the binary batch receive buffer, and the time to wait for
+ * the application to make room in a full input queue.
+ */
+#define BATCH_BUFFER_SIZE                              (4096)
+#define QUEUE_FULL_BACKOFF_US                           (100)
 
 /**
  * Convert given device pointer to its index.
@@ -81,11 +107,29 @@ struct device_response_t {
     int32_t result;
 };
 
+struct version_response_t {
+    struct header_t header;
+    uint32_t version;
+};
+
+/**
+ * A CAN frame in the binary protocol. All fields are in network byte
+ * order.
+ */
+struct can_wire_frame_t {
+    uint32_t id;
+    uint8_t flags;
+    uint8_t size;
+    uint16_t reserved;
+    uint8_t data[8];
+};
+
 /**
  * The client types.
  */
 struct uart_client_t {
     int socket;
+    int version;
     struct uart_device_t *dev_p;
     char name[64];
     pthread_t thrd;
@@ -107,6 +151,7 @@ struct pwm_client_t {
 
 struct can_client_t {
     int socket;
+    int version;
     struct can_device_t *dev_p;
     char name[64];
     pthread_t thrd;
@@ -127,19 +172,96 @@ static struct i2c_client_t i2c_clients[I2C_DEVICE_MAX];
 static struct module_t module;
 
 /**
- * Handle a UART client connection.
+ * Read exactly given number of bytes from given socket.
+ *
+ * @return Number of read bytes, zero(0) if the connection was closed
+ *         or negative error code.
  */
-static void *uart_client_main(void *arg_p)
+static ssize_t read_all(int socket, void *buf_p, size_t size)
 {
-    struct uart_client_t *client_p;
-    ssize_t size;
-    uint8_t byte;
+    ssize_t res;
+    size_t left;
+    uint8_t *b_p;
 
-    client_p = arg_p;
+    b_p = buf_p;
+    left = size;
 
-    printf("socket_device: uart device %s connected\n",
-           &client_p->name[0]);
-    fflush(stdout);
+    while (left > 0) {
+        res = read(socket, b_p, left);
+
+        if (res <= 0) {
+            return (res);
+        }
+
+        b_p += res;
+        left -= res;
+    }
+
+    return (size);
+}
+
+/**
+ * Read the header of a binary batch.
+ *
+ * @return Batch size in bytes, zero(0) if the connection was closed
+ *         or negative error code.
+ */
+static ssize_t read_batch_header(int socket)
+{
+    ssize_t res;
+    uint32_t size;
+
+    res = read_all(socket, &size, sizeof(size));
+
+    if (res != sizeof(size)) {
+        return (res);
+    }
+
+    return (ntohl(size));
+}
+
+/**
+ * Write given buffer to given queue. Instead of dropping data when
+ * the queue is full, the system lock is released while waiting for
+ * the application to read from the queue. Must be called with the
+ * system lock taken.
+ */
+static int queue_write_all_isr(struct queue_t *queue_p,
+                               const void *buf_p,
+                               size_t size)
+{
+    ssize_t res;
+    const uint8_t *b_p;
+
+    b_p = buf_p;
+
+    while (size > 0) {
+        res = queue_write_isr(queue_p, b_p, size);
+
+        if (res < 0) {
+            return (-1);
+        }
+
+        b_p += res;
+        size -= res;
+
+        if (size > 0) {
+            sys_unlock();
+            usleep(QUEUE_FULL_BACKOFF_US);
+            sys_lock();
+        }
+    }
+
+    return (0);
+}
+
+/**
+ * Read UART data from the client, one byte at a time.
+ */
+static void uart_client_read_text(struct uart_client_t *client_p)
+{
+    ssize_t size;
+    uint8_t byte;
 
     while (1) {
         size = read(client_p->socket, &byte, sizeof(byte));
@@ -158,6 +280,69 @@ static void *uart_client_main(void *arg_p)
 
         sys_unlock();
     }
+}
+
+/**
+ * Read UART data batches from the client. Each chunk of a batch is
+ * read with a single read() and written to the input queue with the
+ * system lock taken once.
+ */
+static void uart_client_read_binary(struct uart_client_t *client_p)
+{
+    uint8_t buf[BATCH_BUFFER_SIZE];
+    ssize_t batch_size;
+    ssize_t size;
+
+    while (1) {
+        batch_size = read_batch_header(client_p->socket);
+
+        if (batch_size <= 0) {
+            break;
+        }
+
+        while (batch_size > 0) {
+            size = read(client_p->socket,
+                        &buf[0],
+                        MIN(batch_size, sizeof(buf)));
+
+            if (size <= 0) {
+                return;
+            }
+
+            batch_size -= size;
+
+            sys_lock();
+
+            if (client_p->dev_p->drv_p != NULL) {
+                queue_write_all_isr(&client_p->dev_p->drv_p->base,
+                                    &buf[0],
+                                    size);
+            }
+
+            sys_unlock();
+        }
+    }
+}
+
+/**
+ * Handle a UART client connection.
+ */
+static void *uart_client_main(void *arg_p)
+{
+    struct uart_client_t *client_p;
+
+    client_p = arg_p;
+
+    printf("socket_device: uart device %s connected (protocol version %d)\n",
+           &client_p->name[0],
+           client_p->version);
+    fflush(stdout);
+
+    if (client_p->version == PROTOCOL_VERSION_BINARY) {
+        uart_client_read_binary(client_p);
+    } else {
+        uart_client_read_text(client_p);
+    }
 
     close(client_p->socket);
     client_p->socket = -2;
@@ -170,7 +355,8 @@ static void *uart_client_main(void *arg_p)
 }
 
 static int handle_uart_device_request(struct device_request_t *request_p,
-                                      int client)
+                                      int client,
+                                      int version)
 {
     struct device_response_t response;
     int res;
@@ -214,6 +400,7 @@ static int handle_uart_device_request(struct device_request_t *request_p,
     /* Start the client thread if everything went well so far. */
     if (res == sizeof(response)) {
         uart_clients[index].socket = client;
+        uart_clients[index].version = version;
         uart_clients[index].dev_p = &uart_device[index];
         strcpy(&uart_clients[index].name[0], device_p);
         res = pthread_create(&uart_clients[index].thrd,
@@ -441,11 +628,10 @@ static int handle_pwm_device_request(struct device_request_t *request_p,
 #endif
 
 /**
- * Handle a can client connection.
+ * Read CAN frames from the client as text lines.
  */
-static void *can_client_main(void *arg_p)
+static void can_client_read_text(struct can_client_t *client_p)
 {
-    struct can_client_t *client_p;
     ssize_t size;
     char buf[64];
     struct can_frame_t frame;
@@ -454,12 +640,6 @@ static void *can_client_main(void *arg_p)
     size_t i;
     int extended_frame;
 
-    client_p = arg_p;
-
-    printf("socket_device: can device %s connected\n",
-           &client_p->name[0]);
-    fflush(stdout);
-
     while (1) {
         size = read(client_p->socket, &buf[0], 35);
 
@@ -537,13 +717,102 @@ static void *can_client_main(void *arg_p)
         sys_lock();
 
         if (client_p->dev_p->drv_p != NULL) {
-            queue_write_isr(&client_p->dev_p->drv_p->chin,
-                            &frame,
-                            sizeof(frame));
+            if (can_filter_isr(client_p->dev_p->drv_p, &frame) == 1) {
+                queue_write_isr(&client_p->dev_p->drv_p->chin,
+                                &frame,
+                                sizeof(frame));
+            }
         }
 
         sys_unlock();
     }
+}
+
+/**
+ * Read binary CAN frame batches from the client. The system lock is
+ * taken once per chunk of frames.
+ */
+static void can_client_read_binary(struct can_client_t *client_p)
+{
+    struct can_wire_frame_t wire_frames[BATCH_BUFFER_SIZE
+                                        / sizeof(struct can_wire_frame_t)];
+    struct can_wire_frame_t *wire_frame_p;
+    struct can_frame_t frame;
+    ssize_t batch_size;
+    ssize_t size;
+    int i;
+
+    while (1) {
+        batch_size = read_batch_header(client_p->socket);
+
+        if (batch_size <= 0) {
+            break;
+        }
+
+        if ((batch_size % sizeof(wire_frames[0])) != 0) {
+            printf("warning: bad can batch size %d\n", (int)batch_size);
+            fflush(stdout);
+            break;
+        }
+
+        while (batch_size > 0) {
+            size = read_all(client_p->socket,
+                            &wire_frames[0],
+                            MIN(batch_size, sizeof(wire_frames)));
+
+            if (size <= 0) {
+                return;
+            }
+
+            batch_size -= size;
+
+            sys_lock();
+
+            for (i = 0; i < size / sizeof(wire_frames[0]); i++) {
+                wire_frame_p = &wire_frames[i];
+                memset(&frame, 0, sizeof(frame));
+                frame.id = ntohl(wire_frame_p->id);
+                frame.extended_frame =
+                    ((wire_frame_p->flags & CAN_FLAGS_EXTENDED_FRAME) != 0);
+                frame.rtr = ((wire_frame_p->flags & CAN_FLAGS_RTR) != 0);
+                frame.size = MIN(wire_frame_p->size, 8);
+                memcpy(&frame.data.u8[0], &wire_frame_p->data[0], frame.size);
+
+                if (client_p->dev_p->drv_p == NULL) {
+                    break;
+                }
+
+                if (can_filter_isr(client_p->dev_p->drv_p, &frame) == 1) {
+                    queue_write_all_isr(&client_p->dev_p->drv_p->chin,
+                                        &frame,
+                                        sizeof(frame));
+                }
+            }
+
+            sys_unlock();
+        }
+    }
+}
+
+/**
+ * Handle a can client connection.
+ */
+static void *can_client_main(void *arg_p)
+{
+    struct can_client_t *client_p;
+
+    client_p = arg_p;
+
+    printf("socket_device: can device %s connected (protocol version %d)\n",
+           &client_p->name[0],
+           client_p->version);
+    fflush(stdout);
+
+    if (client_p->version == PROTOCOL_VERSION_BINARY) {
+        can_client_read_binary(client_p);
+    } else {
+        can_client_read_text(client_p);
+    }
 
     close(client_p->socket);
     client_p->socket = -2;
@@ -556,7 +825,8 @@ static void *can_client_main(void *arg_p)
 }
 
 static int handle_can_device_request(struct device_request_t *request_p,
-                                      int client)
+                                      int client,
+                                      int version)
 {
     struct device_response_t response;
     int res;
@@ -600,6 +870,7 @@ static int handle_can_device_request(struct device_request_t *request_p,
     /* Start the client thread if everything went well so far. */
     if (res == sizeof(response)) {
         can_clients[index].socket = client;
+        can_clients[index].version = version;
         can_clients[index].dev_p = &can_device[index];
         strcpy(&can_clients[index].name[0], device_p);
         res = pthread_create(&can_clients[index].thrd,
@@ -783,6 +1054,85 @@ static int setup_listener(void)
     return (res);
 }
 
+/**
+ * Read a request header and its payload.
+ */
+static int read_request(int client, struct device_request_t *request_p)
+{
+    ssize_t size;
+
+    /* Read the request header. */
+    size = read_all(client, &request_p->header, sizeof(request_p->header));
+
+    if (size != sizeof(request_p->header)) {
+        perror("socket_device: read request");
+
+        return (-1);
+    }
+
+    /* Host byte order. */
+    request_p->header.type = ntohl(request_p->header.type);
+    request_p->header.size = ntohl(request_p->header.size);
+
+    /* Validate the size. */
+    if (request_p->header.size >= sizeof(request_p->device)) {
+        perror("socket_device: read request size");
+
+        return (-1);
+    }
+
+    /* Read the device name. */
+    size = read_all(client, &request_p->device[0], request_p->header.size);
+
+    if (size != request_p->header.size) {
+        perror("socket_device: read request device name size");
+
+        return (-1);
+    }
+
+    request_p->device[request_p->header.size] = '\0';
+
+    return (0);
+}
+
+/**
+ * Negotiate the protocol version. The client proposes the highest
+ * version it supports and the lowest of the two is used.
+ *
+ * @return Negotiated version or negative error code.
+ */
+static int handle_version_request(struct device_request_t *request_p,
+                                  int client)
+{
+    struct version_response_t response;
+    uint32_t version;
+    ssize_t size;
+
+    if (request_p->header.size != sizeof(version)) {
+        return (-1);
+    }
+
+    memcpy(&version, &request_p->device[0], sizeof(version));
+    version = ntohl(version);
+
+    if (version < PROTOCOL_VERSION_TEXT) {
+        return (-1);
+    }
+
+    version = MIN(version, PROTOCOL_VERSION_MAX);
+
+    response.header.type = htonl(TYPE_VERSION_RESPONSE);
+    response.header.size = htonl(sizeof(response.version));
+    response.version = htonl(version);
+    size = write(client, &response, sizeof(response));
+
+    if (size != sizeof(response)) {
+        return (-1);
+    }
+
+    return (version);
+}
+
 /**
  * Entry function of the socket device listener thread.
  */
@@ -790,9 +1140,9 @@ static void *listener_main(void *arg_p)
 {
     int listener;
     int client;
-    ssize_t size;
     struct device_request_t request;
     struct header_t response;
+    int version;
     int res;
 
     listener = setup_listener();
@@ -815,40 +1165,27 @@ static void *listener_main(void *arg_p)
             continue;
         }
 
-        /* Read the request header. */
-        size = read(client, &request.header, sizeof(request.header));
-
-        if (size != sizeof(request.header)) {
-            perror("socket_device: read request");
+        if (read_request(client, &request) != 0) {
             close(client);
             continue;
         }
 
-        /* Host byte order. */
-        request.header.type = ntohl(request.header.type);
-        request.header.size = ntohl(request.header.size);
-
-        /* Validate the size. */
-        if (request.header.size >= sizeof(request.device)) {
-            perror("socket_device: read request size");
-            close(client);
-            continue;
-        }
+        /* An optional version negotiation precedes the device
+           request. Clients not sending it use the text protocol. */
+        version = PROTOCOL_VERSION_TEXT;
 
-        /* Read the device name. */
-        size = read(client, &request.device[0], request.header.size);
+        if (request.header.type == TYPE_VERSION_REQUEST) {
+            version = handle_version_request(&request, client);
 
-        if (size != request.header.size) {
-            perror("socket_device: read request device name size");
-            close(client);
-            continue;
+            if ((version < 0) || (read_request(client, &request) != 0)) {
+                close(client);
+                continue;
+            }
         }
 
-        request.device[request.header.size] = '\0';
-
         /* Handle the request type. */
         if (request.header.type == TYPE_UART_DEVICE_REQUEST) {
-            res = handle_uart_device_request(&request, client);
+            res = handle_uart_device_request(&request, client, version);
         } else if (request.header.type == TYPE_PIN_DEVICE_REQUEST) {
             res = handle_pin_device_request(&request, client);
 #if CONFIG_PWM == 1
@@ -856,7 +1193,7 @@ static void *listener_main(void *arg_p)
             res = handle_pwm_device_request(&request, client);
 #endif
         } else if (request.header.type == TYPE_CAN_DEVICE_REQUEST) {
-            res = handle_can_device_request(&request, client);
+            res = handle_can_device_request(&request, client, version);
         } else if (request.header.type == TYPE_I2C_DEVICE_REQUEST) {
             res = handle_i2c_device_request(&request, client);
         } else {
@@ -934,12 +1271,44 @@ int socket_device_is_uart_device_connected_isr(
     return (client >= 0);
 }
 
+/**
+ * Write a length prefixed binary batch to given socket.
+ */
+static ssize_t write_batch(int socket, const void *buf_p, size_t size)
+{
+    struct iovec iov[2];
+    uint32_t header;
+    ssize_t res;
+
+    header = htonl(size);
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = (void *)buf_p;
+    iov[1].iov_len = size;
+
+    res = writev(socket, &iov[0], membersof(iov));
+
+    if (res != sizeof(header) + size) {
+        return (-1);
+    }
+
+    return (size);
+}
+
 ssize_t socket_device_uart_device_write_isr(
     const struct uart_device_t *dev_p,
     const void *buf_p,
     size_t size)
 {
-    return (write(uart_clients[UART_INDEX(dev_p)].socket, buf_p, size));
+    struct uart_client_t *client_p;
+
+    client_p = &uart_clients[UART_INDEX(dev_p)];
+
+    if (client_p->version == PROTOCOL_VERSION_BINARY) {
+        return (write_batch(client_p->socket, buf_p, size));
+    }
+
+    return (write(client_p->socket, buf_p, size));
 }
 
 int socket_device_is_pin_device_connected_isr(
@@ -986,6 +1355,53 @@ int socket_device_is_can_device_connected_isr(
     return (client >= 0);
 }
 
+/**
+ * Write given CAN frames as binary batches.
+ */
+static ssize_t can_write_binary(int socket,
+                                const struct can_frame_t *frames_p,
+                                size_t length)
+{
+    struct can_wire_frame_t wire_frames[BATCH_BUFFER_SIZE
+                                        / sizeof(struct can_wire_frame_t)];
+    size_t i;
+    size_t n;
+    ssize_t res;
+
+    while (length > 0) {
+        n = MIN(length, membersof(wire_frames));
+        memset(&wire_frames[0], 0, n * sizeof(wire_frames[0]));
+
+        for (i = 0; i < n; i++) {
+            wire_frames[i].id = htonl(frames_p[i].id);
+
+            if (frames_p[i].extended_frame == 1) {
+                wire_frames[i].flags |= CAN_FLAGS_EXTENDED_FRAME;
+            }
+
+            if (frames_p[i].rtr == 1) {
+                wire_frames[i].flags |= CAN_FLAGS_RTR;
+            }
+
+            wire_frames[i].size = MIN(frames_p[i].size, 8);
+            memcpy(&wire_frames[i].data[0],
+                   &frames_p[i].data.u8[0],
+                   wire_frames[i].size);
+        }
+
+        res = write_batch(socket, &wire_frames[0], n * sizeof(wire_frames[0]));
+
+        if (res < 0) {
+            return (res);
+        }
+
+        frames_p += n;
+        length -= n;
+    }
+
+    return (0);
+}
+
 ssize_t socket_device_can_device_write_isr(const struct can_device_t *dev_p,
                                            const void *buf_p,
                                            size_t size)
@@ -995,41 +1411,47 @@ ssize_t socket_device_can_device_write_isr(const struct can_device_t *dev_p,
     ssize_t res;
     int socket;
     size_t i;
+    size_t length;
 
     socket = can_clients[CAN_INDEX(dev_p)].socket;
 
-    frame_p = (struct can_frame_t *)buf_p;
-
-    /* Format the line to send to the client. */
-    sprintf(&buf[0],
-            "id=%08x,extended=%d,size=%d,data=",
-            frame_p->id,
-            (int)frame_p->extended_frame,
-            (int)frame_p->size);
+    if (can_clients[CAN_INDEX(dev_p)].version == PROTOCOL_VERSION_BINARY) {
+        res = can_write_binary(socket,
+                               buf_p,
+                               size / sizeof(struct can_frame_t));
 
-    res = write(socket, &buf[0], strlen(&buf[0]));
+        if (res != 0) {
+            return (res);
+        }
 
-    if (res != strlen(&buf[0])) {
-        return (-1);
+        return (size);
     }
 
-    /* Write the data, one byte at a time. */
-    for (i = 0; i < frame_p->size; i++) {
-        sprintf(&buf[0], "%02x", frame_p->data.u8[i]);
+    for (frame_p = buf_p;
+         frame_p < (const struct can_frame_t *)((const char *)buf_p + size);
+         frame_p++) {
+        /* Format the line to send to the client. */
+        length = sprintf(&buf[0],
+                         "id=%08x,extended=%d,size=%d,data=",
+                         frame_p->id,
+                         (int)frame_p->extended_frame,
+                         (int)frame_p->size);
+
+        for (i = 0; i < MIN(frame_p->size, 8); i++) {
+            length += sprintf(&buf[length], "%02x", frame_p->data.u8[i]);
+        }
 
-        res = write(socket, &buf[0], 2);
+        buf[length++] = '\r';
+        buf[length++] = '\n';
 
-        if (res != 2) {
+        /* Write the whole line at once. */
+        res = write(socket, &buf[0], length);
+
+        if (res != length) {
             return (-1);
         }
     }
 
-    res = write(socket, "\r\n", 2);
-
-    if (res != 2) {
-        return (-1);
-    }
-
     return (size);
 }
 
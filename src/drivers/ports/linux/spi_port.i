@@ -59,5 +59,15 @@ static ssize_t spi_port_transfer(struct spi_driver_t *self_p,
                                  const void *txbuf_p,
                                  size_t n)
 {
+    /* Emulate a loopback bus, with MISO connected to MOSI. An idle
+       MOSI reads as ones. */
+    if (rxbuf_p != NULL) {
+        if (txbuf_p != NULL) {
+            memmove(rxbuf_p, txbuf_p, n);
+        } else {
+            memset(rxbuf_p, 0xff, n);
+        }
+    }
+
     return (n);
 }
@@ -72,6 +72,7 @@ struct can_driver_t {
     size_t txsize;
     struct queue_t chin;
     struct mutex_t mutex;
+    struct can_filters_t filters;
 };
 
 #endif
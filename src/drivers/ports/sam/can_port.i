@@ -57,6 +57,11 @@ static void read_frame_from_hw(struct can_driver_t *self_p,
     /* Allow reception of the next message. */
     mailbox_p->MCR = CAN_MCR_MTCR;
 
+    /* Drop frames rejected by the acceptance filters. */
+    if (can_filter_isr(self_p, &frame) == 0) {
+        return;
+    }
+
     /* Write the received frame to the application input channel. */
     if (queue_unused_size_isr(&self_p->chin) >= sizeof(frame)) {
         queue_write_isr(&self_p->chin,
@@ -39,6 +39,18 @@
 
 #define BUFFER_SIZE                                         8
 
+#define JOURNAL_SIZE               CONFIG_EEPROM_SOFT_JOURNAL_SIZE
+
+#define RECORD_HEADER_SIZE     sizeof(struct record_header_t)
+
+#if CONFIG_EEPROM_SOFT_CRC == CONFIG_EEPROM_SOFT_CRC_32
+#    define CRC_INITIAL_VALUE                               0
+#    define crc_update(crc, buf_p, size) crc_32(crc, buf_p, size)
+#elif CONFIG_EEPROM_SOFT_CRC == CONFIG_EEPROM_SOFT_CRC_CCITT
+#    define CRC_INITIAL_VALUE                          0xffff
+#    define crc_update(crc, buf_p, size) crc_ccitt(crc, buf_p, size)
+#endif
+
 struct chunk_header_t {
     uint32_t crc;
     uint16_t revision;
@@ -46,7 +58,19 @@ struct chunk_header_t {
 } PACKED;
 
 /**
- * Calculate the crc of the chunk at given address.
+ * A journal record header. The record data follows the header,
+ * padded to a multiple of the buffer size. The CRC covers the offset
+ * and size fields and the data.
+ */
+struct record_header_t {
+    uint16_t offset;
+    uint16_t size;
+    uint32_t crc;
+} PACKED;
+
+/**
+ * Calculate the crc of the chunk at given address. The journal, if
+ * any, is not part of the chunk crc.
  */
 static uint32_t calculate_chunk_crc(struct eeprom_soft_driver_t *self_p,
                                     uint32_t *crc_p,
@@ -55,15 +79,12 @@ static uint32_t calculate_chunk_crc(struct eeprom_soft_driver_t *self_p,
     ssize_t size;
     uint8_t buf[BUFFER_SIZE];
     size_t offset;
-#if CONFIG_EEPROM_SOFT_CRC == CONFIG_EEPROM_SOFT_CRC_32
-    uint32_t crc = 0;
-#elif CONFIG_EEPROM_SOFT_CRC == CONFIG_EEPROM_SOFT_CRC_CCITT
-    uint16_t crc = 0xffff;
-#endif
+    uint32_t crc;
 
+    crc = CRC_INITIAL_VALUE;
     offset = CHUNK_HEADER_SIZE;
 
-    while (offset < self_p->chunk_size) {
+    while (offset < CHUNK_HEADER_SIZE + self_p->eeprom_size) {
         size = flash_read(self_p->flash_p,
                           &buf[0],
                           address + offset,
@@ -73,12 +94,7 @@ static uint32_t calculate_chunk_crc(struct eeprom_soft_driver_t *self_p,
             return (-1);
         }
 
-#if CONFIG_EEPROM_SOFT_CRC == CONFIG_EEPROM_SOFT_CRC_32
-        crc = crc_32(crc, &buf[0], sizeof(buf));
-#elif CONFIG_EEPROM_SOFT_CRC == CONFIG_EEPROM_SOFT_CRC_CCITT
-        crc = crc_ccitt(crc, &buf[0], sizeof(buf));
-#endif
-
+        crc = crc_update(crc, &buf[0], sizeof(buf));
         offset += sizeof(buf);
 
 #if CONFIG_PREEMPTIVE_SCHEDULER == 0
@@ -140,16 +156,69 @@ static int is_later_revision(uint16_t revision_1, uint16_t revision_2)
 }
 
 /**
- * Check if given chunk is blank.
+ * Find the last chunk with a valid header in given block. Chunks in a
+ * block are always written in order, from the lowest address to the
+ * highest, so the chunks with a valid header form a prefix of the
+ * block. That makes a binary search possible, which only reads
+ * log2(number of chunks) headers instead of all of them.
+ *
+ * @return one(1) if a chunk was found, otherwise zero(0).
  */
-static int is_blank_chunk(struct eeprom_soft_driver_t *self_p,
-                          uintptr_t address)
+static int find_last_valid_chunk(struct eeprom_soft_driver_t *self_p,
+                                 const struct eeprom_soft_block_t *block_p,
+                                 uintptr_t *chunk_address_p,
+                                 uint16_t *revision_p)
 {
+    struct chunk_header_t header;
     ssize_t size;
-    int i;
+    int low;
+    int high;
+    int middle;
+    int found;
+    uintptr_t chunk_address;
+
+    low = 0;
+    high = (block_p->size / self_p->chunk_size);
+    found = 0;
+
+    /* All chunks below low have a valid header, and all chunks at or
+       above high have not. */
+    while (low < high) {
+        middle = (low + (high - low) / 2);
+        chunk_address = (block_p->address + middle * self_p->chunk_size);
+
+        /* Read the header. */
+        size = flash_read(self_p->flash_p,
+                          &header,
+                          chunk_address,
+                          sizeof(header));
+
+        /* Check the valid flag. */
+        if ((size == sizeof(header)) && (header.valid == VALID_PATTERN)) {
+            *chunk_address_p = chunk_address;
+            *revision_p = header.revision;
+            found = 1;
+            low = (middle + 1);
+        } else {
+            high = middle;
+        }
+    }
+
+    return (found);
+}
+
+/**
+ * Check if given flash area is blank.
+ */
+static int is_blank(struct eeprom_soft_driver_t *self_p,
+                    uintptr_t address,
+                    size_t area_size)
+{
+    ssize_t size;
+    size_t i;
     uint8_t byte;
 
-    for (i = 0; i < self_p->chunk_size; i++) {
+    for (i = 0; i < area_size; i++) {
         size = flash_read(self_p->flash_p,
                           &byte,
                           address + i,
@@ -171,6 +240,15 @@ static int is_blank_chunk(struct eeprom_soft_driver_t *self_p,
     return (1);
 }
 
+/**
+ * Check if given chunk is blank.
+ */
+static int is_blank_chunk(struct eeprom_soft_driver_t *self_p,
+                          uintptr_t address)
+{
+    return (is_blank(self_p, address, self_p->chunk_size));
+}
+
 /**
  * Get a blank chunk.
  */
@@ -202,6 +280,7 @@ static int get_blank_chunk(struct eeprom_soft_driver_t *self_p,
         if (flash_erase(self_p->flash_p,
                         block_p->address,
                         block_p->size) == 0) {
+            self_p->statistics.block_erases++;
             chunk_address = block_p->address;
             res = 0;
         }
@@ -218,15 +297,13 @@ static int get_blank_chunk(struct eeprom_soft_driver_t *self_p,
  */
 static int write_header(struct eeprom_soft_driver_t *self_p,
                         uintptr_t chunk_address,
-                        uint16_t revision)
+                        uint16_t revision,
+                        uint32_t crc)
 {
     ssize_t size;
     struct chunk_header_t header;
 
-    if (calculate_chunk_crc(self_p, &header.crc, chunk_address) != 0) {
-        return (-1);
-    }
-
+    header.crc = crc;
     header.revision = revision;
     header.valid = VALID_PATTERN;
 
@@ -269,6 +346,300 @@ static void calc_overlapping_range(struct iov_uintptr_t *iov_p,
     *size_p -= *index_p;
 }
 
+#if JOURNAL_SIZE > 0
+
+/**
+ * Size of a record with given data size in the journal.
+ */
+static size_t record_total_size(size_t size)
+{
+    return (RECORD_HEADER_SIZE + DIV_CEIL(size, BUFFER_SIZE) * BUFFER_SIZE);
+}
+
+/**
+ * Get the journal address of the chunk at given address.
+ */
+static uintptr_t journal_address(struct eeprom_soft_driver_t *self_p,
+                                 uintptr_t chunk_address)
+{
+    return (chunk_address + CHUNK_HEADER_SIZE + self_p->eeprom_size);
+}
+
+/**
+ * Overwrite given buffer, read from the current chunk, with journal
+ * records overlapping it. Records are applied oldest first.
+ */
+static int apply_journal(struct eeprom_soft_driver_t *self_p,
+                         uint8_t *dst_p,
+                         uintptr_t src,
+                         size_t size)
+{
+    struct record_header_t header;
+    uintptr_t address;
+    size_t offset;
+    uintptr_t begin;
+    uintptr_t end;
+    ssize_t res;
+
+    address = journal_address(self_p, self_p->current.chunk_address);
+    offset = 0;
+
+    while (offset < self_p->current.journal_offset) {
+        res = flash_read(self_p->flash_p,
+                         &header,
+                         address + offset,
+                         sizeof(header));
+
+        if (res != sizeof(header)) {
+            return (-1);
+        }
+
+        begin = MAX(header.offset, src);
+        end = MIN(header.offset + header.size, src + size);
+
+        if (begin < end) {
+            res = flash_read(self_p->flash_p,
+                             &dst_p[begin - src],
+                             (address
+                              + offset
+                              + RECORD_HEADER_SIZE
+                              + begin
+                              - header.offset),
+                             end - begin);
+
+            if (res != end - begin) {
+                return (-1);
+            }
+        }
+
+        offset += record_total_size(header.size);
+    }
+
+    return (0);
+}
+
+/**
+ * Check if the record at given offset in given journal is valid.
+ */
+static int is_valid_record(struct eeprom_soft_driver_t *self_p,
+                           uintptr_t address,
+                           size_t offset,
+                           struct record_header_t *header_p)
+{
+    uint8_t buf[BUFFER_SIZE];
+    size_t data_offset;
+    size_t size;
+    uint32_t crc;
+
+    if ((header_p->size == 0)
+        || (header_p->offset + header_p->size > self_p->eeprom_size)
+        || (offset + record_total_size(header_p->size) > JOURNAL_SIZE)) {
+        return (0);
+    }
+
+    address += (offset + RECORD_HEADER_SIZE);
+    crc = crc_update(CRC_INITIAL_VALUE, header_p, 2 * sizeof(uint16_t));
+
+    for (data_offset = 0;
+         data_offset < header_p->size;
+         data_offset += BUFFER_SIZE) {
+        size = MIN(BUFFER_SIZE, header_p->size - data_offset);
+
+        if (flash_read(self_p->flash_p,
+                       &buf[0],
+                       address + data_offset,
+                       size) != size) {
+            return (-1);
+        }
+
+        crc = crc_update(crc, &buf[0], size);
+    }
+
+    return (crc == header_p->crc);
+}
+
+/**
+ * Find the end of the journal in the chunk at given address. An
+ * invalid record, most likely written during a power failure, ends
+ * the journal. It is not blank, so the next write goes to a new
+ * chunk.
+ */
+static int mount_journal(struct eeprom_soft_driver_t *self_p,
+                         uintptr_t chunk_address,
+                         size_t *journal_offset_p)
+{
+    struct record_header_t header;
+    uintptr_t address;
+    size_t offset;
+    int res;
+
+    address = journal_address(self_p, chunk_address);
+    offset = 0;
+
+    while (offset + RECORD_HEADER_SIZE <= JOURNAL_SIZE) {
+        if (flash_read(self_p->flash_p,
+                       &header,
+                       address + offset,
+                       sizeof(header)) != sizeof(header)) {
+            return (-1);
+        }
+
+        /* A blank header ends the journal. */
+        if (header.size == 0xffff) {
+            break;
+        }
+
+        res = is_valid_record(self_p, address, offset, &header);
+
+        if (res < 0) {
+            return (res);
+        } else if (res == 0) {
+            break;
+        }
+
+        offset += record_total_size(header.size);
+    }
+
+    *journal_offset_p = offset;
+
+    return (0);
+}
+
+#endif
+
+/**
+ * Read from the current chunk, including journal records, if any.
+ */
+static ssize_t read_inner(struct eeprom_soft_driver_t *self_p,
+                          void *dst_p,
+                          uintptr_t src,
+                          size_t size)
+{
+    ssize_t res;
+
+    res = flash_read(self_p->flash_p,
+                     dst_p,
+                     self_p->current.chunk_address + CHUNK_HEADER_SIZE + src,
+                     size);
+
+#if JOURNAL_SIZE > 0
+    if (res == size) {
+        if (apply_journal(self_p, dst_p, src, size) != 0) {
+            res = -1;
+        }
+    }
+#endif
+
+    return (res);
+}
+
+#if JOURNAL_SIZE > 0
+
+/**
+ * Append a record with given data regions to the journal of the
+ * current chunk. All regions are written in a single record, filling
+ * holes between them with current data, so the write is atomic.
+ *
+ * @return one(1) if the record was appended, zero(0) if the journal
+ *         is full, or negative error code.
+ */
+static int append_to_journal(struct eeprom_soft_driver_t *self_p,
+                             struct iov_uintptr_t *dst_p,
+                             struct iov_t *src_p,
+                             size_t length)
+{
+    struct record_header_t header;
+    uint8_t buf[BUFFER_SIZE];
+    uintptr_t address;
+    uintptr_t begin;
+    uintptr_t end;
+    size_t offset;
+    size_t size;
+    uint8_t *u8_src_p;
+    int overwrite_index;
+    size_t overwrite_size;
+    uint32_t crc;
+    int res;
+    size_t i;
+
+    begin = dst_p[0].address;
+    end = (dst_p[0].address + dst_p[0].size);
+
+    for (i = 1; i < length; i++) {
+        begin = MIN(begin, dst_p[i].address);
+        end = MAX(end, dst_p[i].address + dst_p[i].size);
+    }
+
+    if ((end == begin)
+        || (self_p->current.journal_offset + record_total_size(end - begin)
+            > JOURNAL_SIZE)) {
+        return (0);
+    }
+
+    address = (journal_address(self_p, self_p->current.chunk_address)
+               + self_p->current.journal_offset);
+
+    /* Data written just before a power failure may be left after the
+       last valid record. */
+    res = is_blank(self_p, address, record_total_size(end - begin));
+
+    if (res != 1) {
+        return (res);
+    }
+
+    header.offset = begin;
+    header.size = (end - begin);
+    crc = crc_update(CRC_INITIAL_VALUE, &header, 2 * sizeof(uint16_t));
+
+    /* Write the data before the header, which commits the record. */
+    for (offset = begin; offset < end; offset += BUFFER_SIZE) {
+        size = MIN(BUFFER_SIZE, end - offset);
+        memset(&buf[0], -1, sizeof(buf));
+
+        if (read_inner(self_p, &buf[0], offset, size) != size) {
+            return (-1);
+        }
+
+        for (i = 0; i < length; i++) {
+            u8_src_p = src_p[i].buf_p;
+
+            if (are_overlapping(&dst_p[i], offset)) {
+                calc_overlapping_range(&dst_p[i],
+                                       offset,
+                                       &overwrite_index,
+                                       &overwrite_size);
+                memcpy(&buf[overwrite_index], u8_src_p, overwrite_size);
+                src_p[i].buf_p = (u8_src_p + overwrite_size);
+            }
+        }
+
+        crc = crc_update(crc, &buf[0], size);
+
+        if (flash_write(self_p->flash_p,
+                        address + RECORD_HEADER_SIZE + offset - begin,
+                        &buf[0],
+                        sizeof(buf)) != sizeof(buf)) {
+            return (-1);
+        }
+    }
+
+    header.crc = crc;
+
+    if (flash_write(self_p->flash_p,
+                    address,
+                    &header,
+                    sizeof(header)) != sizeof(header)) {
+        return (-1);
+    }
+
+    self_p->current.journal_offset += record_total_size(header.size);
+    self_p->statistics.journal_writes++;
+
+    return (1);
+}
+
+#endif
+
 #if CONFIG_EEPROM_SOFT_OVERWRITE_IDENTICAL_DATA == 0
 
 static int check_identical(struct eeprom_soft_driver_t *self_p,
@@ -276,33 +647,29 @@ static int check_identical(struct eeprom_soft_driver_t *self_p,
                            struct iov_t *src_p,
                            size_t length)
 {
-    uint8_t byte;
+    uint8_t buf[BUFFER_SIZE];
     uint8_t *u8_src_p;
     ssize_t res;
     size_t i;
     size_t j;
-    uintptr_t address;
+    size_t size;
 
-    /* Compare given data regions to current EEPROM content. */
+    /* Compare given data regions to current EEPROM content, one
+       buffer at a time to replay the journal once per buffer. */
     for (i = 0; i < length; i++) {
         u8_src_p = src_p[i].buf_p;
 
-        for (j = 0; j < dst_p[i].size; j++) {
+        for (j = 0; j < dst_p[i].size; j += size) {
+            size = MIN(sizeof(buf), dst_p[i].size - j);
+
             /* Read from current chunk. */
-            address = (self_p->current.chunk_address
-                       + CHUNK_HEADER_SIZE
-                       + dst_p[i].address
-                       + j);
-            res = flash_read(self_p->flash_p,
-                             &byte,
-                             address,
-                             sizeof(byte));
+            res = read_inner(self_p, &buf[0], dst_p[i].address + j, size);
 
-            if (res != sizeof(byte)) {
+            if (res != size) {
                 return (-1);
             }
 
-            if (u8_src_p[j] != byte) {
+            if (memcmp(&u8_src_p[j], &buf[0], size) != 0) {
                 return (0);
             }
 
@@ -334,6 +701,7 @@ static ssize_t vwrite_inner(struct eeprom_soft_driver_t *self_p,
     size_t i;
     uintptr_t dst;
     size_t size;
+    uint32_t crc;
 
     if (self_p->current.block_p == NULL) {
         return (-ENOTMOUNTED);
@@ -363,19 +731,31 @@ static ssize_t vwrite_inner(struct eeprom_soft_driver_t *self_p,
         return (iov_uintptr_size(dst_p, length));
     }
 
+#endif
+
+#if JOURNAL_SIZE > 0
+
+    /* Append to the journal if there is room for the data. */
+    res = append_to_journal(self_p, dst_p, src_p, length);
+
+    if (res < 0) {
+        return (res);
+    } else if (res == 1) {
+        return (iov_uintptr_size(dst_p, length));
+    }
+
 #endif
 
     if (get_blank_chunk(self_p, &block_p, &chunk_address) != 0) {
         return (-1);
     }
 
+    crc = CRC_INITIAL_VALUE;
+
     /* Write to new chunk. */
     for (offset = 0; offset < self_p->eeprom_size; offset += sizeof(buf)) {
         /* Read from old chunk. */
-        res = flash_read(self_p->flash_p,
-                         &buf[0],
-                         self_p->current.chunk_address + CHUNK_HEADER_SIZE + offset,
-                         sizeof(buf));
+        res = read_inner(self_p, &buf[0], offset, sizeof(buf));
 
         if (res != sizeof(buf)) {
             return (-1);
@@ -395,6 +775,8 @@ static ssize_t vwrite_inner(struct eeprom_soft_driver_t *self_p,
             }
         }
 
+        crc = crc_update(crc, &buf[0], sizeof(buf));
+
         /* Write to new chunk. */
         res = flash_write(self_p->flash_p,
                           chunk_address + CHUNK_HEADER_SIZE + offset,
@@ -412,14 +794,19 @@ static ssize_t vwrite_inner(struct eeprom_soft_driver_t *self_p,
 
     revision = (self_p->current.revision + 1);
 
-    if (write_header(self_p, chunk_address, revision) != 0) {
+    if (write_header(self_p, chunk_address, revision, crc) != 0) {
         return (-1);
     }
 
+    self_p->statistics.chunk_writes++;
+
     /* Update the object with new chunk information. */
     self_p->current.block_p = block_p;
     self_p->current.chunk_address = chunk_address;
     self_p->current.revision = revision;
+#if JOURNAL_SIZE > 0
+    self_p->current.journal_offset = 0;
+#endif
 
     return (iov_uintptr_size(dst_p, length));
 }
@@ -439,14 +826,22 @@ int eeprom_soft_init(struct eeprom_soft_driver_t *self_p,
     ASSERTN(flash_p != NULL, EINVAL);
     ASSERTN(blocks_p != NULL, EINVAL);
     ASSERTN(number_of_blocks >= 2, EINVAL);
+    ASSERTN(chunk_size > CHUNK_HEADER_SIZE + JOURNAL_SIZE, EINVAL);
+#if JOURNAL_SIZE > 0
+    /* Journal record offsets and sizes are 16 bits. */
+    ASSERTN(chunk_size - CHUNK_HEADER_SIZE - JOURNAL_SIZE <= 0xffff, EINVAL);
+#endif
 
     self_p->flash_p = flash_p;
     self_p->blocks_p = blocks_p;
     self_p->number_of_blocks = number_of_blocks;
     self_p->chunk_size = chunk_size;
-    self_p->eeprom_size = (chunk_size - CHUNK_HEADER_SIZE);
+    self_p->eeprom_size = (chunk_size - CHUNK_HEADER_SIZE - JOURNAL_SIZE);
     self_p->current.block_p = NULL;
     self_p->current.chunk_address = 0xffffffff;
+    self_p->statistics.chunk_writes = 0;
+    self_p->statistics.block_erases = 0;
+    self_p->statistics.journal_writes = 0;
 
 #if CONFIG_EEPROM_SOFT_SEMAPHORE == 1
     mutex_init(&self_p->mutex);
@@ -460,6 +855,7 @@ int eeprom_soft_format(struct eeprom_soft_driver_t *self_p)
     ASSERTN(self_p != NULL, EINVAL);
 
     int i;
+    uint32_t crc;
 
     for (i = 0; i < self_p->number_of_blocks; i++) {
         if (flash_erase(self_p->flash_p,
@@ -467,9 +863,21 @@ int eeprom_soft_format(struct eeprom_soft_driver_t *self_p)
                         self_p->blocks_p[i].size) != 0) {
             return (-1);
         }
+
+        self_p->statistics.block_erases++;
+    }
+
+    if (calculate_chunk_crc(self_p, &crc, self_p->blocks_p[0].address) != 0) {
+        return (-1);
     }
 
-    return (write_header(self_p, self_p->blocks_p[0].address, 0));
+    if (write_header(self_p, self_p->blocks_p[0].address, 0, crc) != 0) {
+        return (-1);
+    }
+
+    self_p->statistics.chunk_writes++;
+
+    return (0);
 }
 
 int eeprom_soft_mount(struct eeprom_soft_driver_t *self_p)
@@ -478,12 +886,9 @@ int eeprom_soft_mount(struct eeprom_soft_driver_t *self_p)
 
     int res;
     int i;
-    int j;
+    uint16_t revision;
     uintptr_t chunk_address;
     const struct eeprom_soft_block_t *block_p;
-    int number_of_chunks;
-    struct chunk_header_t header;
-    ssize_t size;
     uint16_t latest_revision;
     const struct eeprom_soft_block_t *latest_block_p;
     uintptr_t latest_chunk_address;
@@ -492,42 +897,38 @@ int eeprom_soft_mount(struct eeprom_soft_driver_t *self_p)
     latest_block_p = NULL;
 
     /* Find the most recently written chunk, as given by the
-       revision. */
+       revision. Only the last valid chunk in each block can be the
+       latest one. */
     for (i = 0; i < self_p->number_of_blocks; i++) {
         block_p = &self_p->blocks_p[i];
-        number_of_chunks = (block_p->size / self_p->chunk_size);
-
-        for (j = 0; j < number_of_chunks; j++) {
-            chunk_address = (block_p->address + j * self_p->chunk_size);
-
-            /* Read the header. */
-            size = flash_read(self_p->flash_p,
-                              &header,
-                              chunk_address,
-                              sizeof(header));
-
-            if (size != sizeof(header)) {
-                continue;
-            }
 
-            /* Check the valid flag. */
-            if (header.valid != VALID_PATTERN) {
-                continue;
-            }
+        if (find_last_valid_chunk(self_p,
+                                  block_p,
+                                  &chunk_address,
+                                  &revision) != 1) {
+            continue;
+        }
 
-            /* Keep track of the latest revision chunk. */
-            if ((latest_block_p == NULL)
-                || (is_later_revision(header.revision, latest_revision) == 1)) {
-                latest_revision = header.revision;
-                latest_block_p = block_p;
-                latest_chunk_address = chunk_address;
-            }
+        /* Keep track of the latest revision chunk. */
+        if ((latest_block_p == NULL)
+            || (is_later_revision(revision, latest_revision) == 1)) {
+            latest_revision = revision;
+            latest_block_p = block_p;
+            latest_chunk_address = chunk_address;
         }
     }
 
     /* Make sure the chunk is valid. */
     if (latest_block_p != NULL) {
         if (is_valid_chunk(self_p, latest_chunk_address) == 1) {
+#if JOURNAL_SIZE > 0
+            if (mount_journal(self_p,
+                              latest_chunk_address,
+                              &self_p->current.journal_offset) != 0) {
+                return (-1);
+            }
+#endif
+
             self_p->current.block_p = latest_block_p;
             self_p->current.chunk_address = latest_chunk_address;
             self_p->current.revision = latest_revision;
@@ -564,8 +965,7 @@ ssize_t eeprom_soft_read(struct eeprom_soft_driver_t *self_p,
     mutex_lock(&self_p->mutex);
 #endif
 
-    src += (self_p->current.chunk_address + CHUNK_HEADER_SIZE);
-    res = flash_read(self_p->flash_p, dst_p, src, size);
+    res = read_inner(self_p, dst_p, src, size);
 
 #if CONFIG_EEPROM_SOFT_SEMAPHORE == 1
     mutex_unlock(&self_p->mutex);
@@ -46,7 +46,18 @@ struct eeprom_soft_driver_t {
         const struct eeprom_soft_block_t *block_p;
         uintptr_t chunk_address;
         uint16_t revision;
+#if CONFIG_EEPROM_SOFT_JOURNAL_SIZE > 0
+        size_t journal_offset;
+#endif
     } current;
+    /* Wear statistics since the driver was initialized. Chunks are
+       written round-robin over all blocks, so each block has been
+       erased roughly block_erases / number_of_blocks times. */
+    struct {
+        uint32_t chunk_writes;
+        uint32_t block_erases;
+        uint32_t journal_writes;
+    } statistics;
 #if CONFIG_EEPROM_SOFT_SEMAPHORE == 1
     struct mutex_t mutex;
 #endif
@@ -72,8 +83,12 @@ int eeprom_soft_module_init(void);
  * @param[in] number_of_blocks Number of blocks.
  * @param[in] chunk_size Chunk size in bytes. This is the size of the
  *                       EEPROM. Eight bytes of the chunk will be used
- *                       to store metadata, so only `chunk_size - 8`
- *                       bytes are available to the user.
+ *                       to store metadata, and
+ *                       ``CONFIG_EEPROM_SOFT_JOURNAL_SIZE`` bytes for
+ *                       the journal, so only `chunk_size - 8 -
+ *                       CONFIG_EEPROM_SOFT_JOURNAL_SIZE` bytes are
+ *                       available to the user. The user size is at
+ *                       most 65535 bytes if the journal is enabled.
  *
  * @return zero(0) or negative error code.
  */
@@ -84,7 +99,9 @@ int eeprom_soft_init(struct eeprom_soft_driver_t *self_p,
                      size_t chunk_size);
 
 /**
- * Mount given software EEPROM.
+ * Mount given software EEPROM. The most recently written chunk is
+ * found with a binary search in each block, so only a logarithmic
+ * number of chunk headers are read.
  *
  * @param[in] self_p Driver object to mount.
  *
@@ -120,6 +137,10 @@ ssize_t eeprom_soft_read(struct eeprom_soft_driver_t *self_p,
 /**
  * Write given buffer to given address.
  *
+ * If ``CONFIG_EEPROM_SOFT_JOURNAL_SIZE`` is non-zero, small writes are
+ * appended as records to the journal of the current chunk, and the
+ * whole chunk is only copied to a new chunk when the journal is full.
+ *
  * @param[in] self_p Initialized driver object.
  * @param[in] dst Software EEPROM address to write to. Addressing
  *                starts at zero(0).
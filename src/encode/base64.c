@@ -28,43 +28,613 @@
 
 #include "simba.h"
 
+#if CONFIG_ENCODE_SIMD == 1
+#    if defined(ARCH_LINUX) && (defined(__x86_64__) || defined(__i386__))
+#        define BASE64_SSSE3
+#        include <immintrin.h>
+#    elif defined(__aarch64__) && defined(__ARM_NEON)
+#        define BASE64_NEON
+#        include <arm_neon.h>
+#    endif
+#endif
+
+/* Maximum number of encoded characters written to the output channel
+   at a time by the streaming encoder and decoder. */
+#define CHUNK_SIZE                                        128
+
+/* Invalid character in the decode table. */
+#define INVALID                                          0xff
+
+static FAR const char encode_table[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* Character to 6 bits index. The pad character '=' decodes to zero. */
+static FAR const uint8_t decode_table[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff,
+    0xff, 0x00, 0xff, 0xff, 0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12,
+    0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24,
+    0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30,
+    0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff
+};
+
+/* Implementation used by the codec, or -1 if not yet selected. */
+static int8_t implementation = -1;
+
+#if defined(BASE64_SSSE3)
+
 /**
- * Index must be a number 0-64.
+ * Encode 12 bytes into 16 characters at a time. Reads 16 bytes per
+ * iteration.
+ *
+ * @return Number of encoded input bytes, always a multiple of 3.
  */
-static char index_to_encoded(int index)
-{
-    if ((index >= 0) && (index <= 25)) {
-        return ('A' + index - 0);
-    } else if ((index >= 26) && (index <= 51)) {
-        return ('a' + index - 26);
-    } else if ((index >= 52) && (index <= 61)) {
-        return ('0' + index - 52);
-    } else if (index == 62) {
-        return ('+');
-    } else if (index == 63) {
-        return ('/');
-    } else {
-        return ('=');
+__attribute__((target("ssse3")))
+static size_t encode_simd(char *dst_p, const uint8_t *src_p, size_t size)
+{
+    __m128i in, t0, t1, t2, t3, indices, result, less;
+    size_t i;
+
+    const __m128i mask_hi = _mm_set1_epi32(0x0fc0fc00);
+    const __m128i mul_hi = _mm_set1_epi32(0x04000040);
+    const __m128i mask_lo = _mm_set1_epi32(0x003f03f0);
+    const __m128i mul_lo = _mm_set1_epi32(0x01000010);
+    const __m128i fifty_one = _mm_set1_epi8(51);
+    const __m128i twenty_six = _mm_set1_epi8(26);
+    const __m128i thirteen = _mm_set1_epi8(13);
+    const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7,
+                                         4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i shift_lut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52,
+                                            '0' - 52, '0' - 52, '0' - 52,
+                                            '0' - 52, '0' - 52, '0' - 52,
+                                            '0' - 52, '0' - 52, '+' - 62,
+                                            '/' - 63, 'A', 0, 0);
+
+    for (i = 0; i + 16 <= size; i += 12) {
+        in = _mm_loadu_si128((const __m128i *)&src_p[i]);
+
+        /* Spread the 6 bit indices to one byte each. */
+        in = _mm_shuffle_epi8(in, shuffle);
+        t0 = _mm_and_si128(in, mask_hi);
+        t1 = _mm_mulhi_epu16(t0, mul_hi);
+        t2 = _mm_and_si128(in, mask_lo);
+        t3 = _mm_mullo_epi16(t2, mul_lo);
+        indices = _mm_or_si128(t1, t3);
+
+        /* Add the offset of the character range of each index. */
+        result = _mm_subs_epu8(indices, fifty_one);
+        less = _mm_cmpgt_epi8(twenty_six, indices);
+        result = _mm_or_si128(result, _mm_and_si128(less, thirteen));
+        result = _mm_shuffle_epi8(shift_lut, result);
+        result = _mm_add_epi8(result, indices);
+
+        _mm_storeu_si128((__m128i *)&dst_p[4 * (i / 3)], result);
+    }
+
+    return (i);
+}
+
+/**
+ * Decode 16 characters into 12 bytes at a time. Writes 16 bytes per
+ * iteration. Stops at the first group containing a character not in
+ * the base64 alphabet, including the pad character.
+ *
+ * @return Number of decoded input characters, always a multiple of 4.
+ */
+__attribute__((target("ssse3")))
+static size_t decode_simd(uint8_t *dst_p, const char *src_p, size_t size)
+{
+    __m128i in, hi_nibbles, lo_nibbles, hi, lo, roll, merged, out;
+    size_t i;
+
+    const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11,
+                                         0x11, 0x11, 0x11, 0x11,
+                                         0x11, 0x11, 0x13, 0x1a,
+                                         0x1b, 0x1b, 0x1b, 0x1a);
+    const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02,
+                                         0x04, 0x08, 0x04, 0x08,
+                                         0x10, 0x10, 0x10, 0x10,
+                                         0x10, 0x10, 0x10, 0x10);
+    const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                           0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask_2f = _mm_set1_epi8(0x2f);
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9,
+                                       8, 14, 13, 12, -1, -1, -1, -1);
+    const __m128i merge_ab = _mm_set1_epi32(0x01400140);
+    const __m128i merge_abc = _mm_set1_epi32(0x00011000);
+    const __m128i zero = _mm_setzero_si128();
+
+    /* Leave room for the four extra bytes written per iteration. */
+    for (i = 0; i + 24 <= size; i += 16) {
+        in = _mm_loadu_si128((const __m128i *)&src_p[i]);
+
+        /* Validate and translate characters to 6 bit indices. */
+        hi_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask_2f);
+        lo_nibbles = _mm_and_si128(in, mask_2f);
+        hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+        lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), zero))
+            != 0xffff) {
+            break;
+        }
+
+        roll = _mm_shuffle_epi8(lut_roll,
+                                _mm_add_epi8(_mm_cmpeq_epi8(in, mask_2f),
+                                             hi_nibbles));
+        in = _mm_add_epi8(in, roll);
+
+        /* Pack four 6 bit indices into three bytes. */
+        merged = _mm_maddubs_epi16(in, merge_ab);
+        out = _mm_madd_epi16(merged, merge_abc);
+        out = _mm_shuffle_epi8(out, pack);
+
+        _mm_storeu_si128((__m128i *)&dst_p[3 * (i / 4)], out);
+    }
+
+    return (i);
+}
+
+static int simd_available(void)
+{
+    __builtin_cpu_init();
+
+    return (__builtin_cpu_supports("ssse3"));
+}
+
+#elif defined(BASE64_NEON)
+
+/**
+ * Encode 48 bytes into 64 characters at a time.
+ *
+ * @return Number of encoded input bytes, always a multiple of 3.
+ */
+static size_t encode_simd(char *dst_p, const uint8_t *src_p, size_t size)
+{
+    uint8x16x4_t table;
+    uint8x16x3_t in;
+    uint8x16x4_t out;
+    uint8x16_t mask;
+    size_t i;
+
+    table.val[0] = vld1q_u8((const uint8_t *)&encode_table[0]);
+    table.val[1] = vld1q_u8((const uint8_t *)&encode_table[16]);
+    table.val[2] = vld1q_u8((const uint8_t *)&encode_table[32]);
+    table.val[3] = vld1q_u8((const uint8_t *)&encode_table[48]);
+    mask = vdupq_n_u8(0x3f);
+
+    for (i = 0; i + 48 <= size; i += 48) {
+        in = vld3q_u8(&src_p[i]);
+        out.val[0] = vshrq_n_u8(in.val[0], 2);
+        out.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4),
+                                       vshrq_n_u8(in.val[1], 4)),
+                              mask);
+        out.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2),
+                                       vshrq_n_u8(in.val[2], 6)),
+                              mask);
+        out.val[3] = vandq_u8(in.val[2], mask);
+        out.val[0] = vqtbl4q_u8(table, out.val[0]);
+        out.val[1] = vqtbl4q_u8(table, out.val[1]);
+        out.val[2] = vqtbl4q_u8(table, out.val[2]);
+        out.val[3] = vqtbl4q_u8(table, out.val[3]);
+        vst4q_u8((uint8_t *)&dst_p[4 * (i / 3)], out);
     }
+
+    return (i);
 }
 
-static int encoded_to_index(char encoded)
+/**
+ * Decode 64 characters into 48 bytes at a time. Stops at the first
+ * group containing a character not in the base64 alphabet.
+ *
+ * @return Number of decoded input characters, always a multiple of 4.
+ */
+static size_t decode_simd(uint8_t *dst_p, const char *src_p, size_t size)
 {
-    if ((encoded >= 'A') && (encoded <= 'Z')) {
-        return (0 + encoded - 'A');
-    } else if ((encoded >= 'a') && (encoded <= 'z')) {
-        return (26 + encoded - 'a');
-    } else if ((encoded >= '0') && (encoded <= '9')) {
-        return (52 + encoded - '0');
-    } else if (encoded == '+') {
-        return (62);
-    } else if (encoded == '/') {
-        return (63);
-    } else if (encoded == '=') {
+    uint8x16x4_t table_lo;
+    uint8x16x4_t table_hi;
+    uint8x16x4_t in;
+    uint8x16x3_t out;
+    uint8x16_t error;
+    uint8x16_t offset;
+    size_t i;
+    int j;
+
+    for (j = 0; j < 4; j++) {
+        table_lo.val[j] = vld1q_u8(&decode_table[16 * j]);
+        table_hi.val[j] = vld1q_u8(&decode_table[64 + 16 * j]);
+    }
+
+    offset = vdupq_n_u8(64);
+
+    for (i = 0; i + 64 <= size; i += 64) {
+        in = vld4q_u8((const uint8_t *)&src_p[i]);
+        error = vdupq_n_u8(0);
+
+        for (j = 0; j < 4; j++) {
+            error = vorrq_u8(error, in.val[j]);
+            in.val[j] = vqtbx4q_u8(vqtbl4q_u8(table_lo, in.val[j]),
+                                   table_hi,
+                                   vsubq_u8(in.val[j], offset));
+            error = vorrq_u8(error, in.val[j]);
+        }
+
+        /* Non-ASCII characters and invalid characters have the most
+           significant bit set. */
+        if ((vmaxvq_u8(error) & 0x80) != 0) {
+            break;
+        }
+
+        out.val[0] = vorrq_u8(vshlq_n_u8(in.val[0], 2),
+                              vshrq_n_u8(in.val[1], 4));
+        out.val[1] = vorrq_u8(vshlq_n_u8(in.val[1], 4),
+                              vshrq_n_u8(in.val[2], 2));
+        out.val[2] = vorrq_u8(vshlq_n_u8(in.val[2], 6), in.val[3]);
+        vst3q_u8(&dst_p[3 * (i / 4)], out);
+    }
+
+    return (i);
+}
+
+static int simd_available(void)
+{
+    return (1);
+}
+
+#endif
+
+static int implementation_available(int value)
+{
+    switch (value) {
+
+    case BASE64_IMPLEMENTATION_TABLE:
+        return (1);
+
+#if defined(BASE64_SSSE3) || defined(BASE64_NEON)
+    case BASE64_IMPLEMENTATION_SIMD:
+        return (simd_available());
+#endif
+
+    default:
         return (0);
     }
+}
+
+static void implementation_init(void)
+{
+    if (implementation_available(BASE64_IMPLEMENTATION_SIMD)) {
+        implementation = BASE64_IMPLEMENTATION_SIMD;
+    } else {
+        implementation = BASE64_IMPLEMENTATION_TABLE;
+    }
+}
+
+/**
+ * Encode given number of bytes, which must be a multiple of 3.
+ */
+static void encode_groups(char *dst_p, const uint8_t *src_p, size_t size)
+{
+    uint32_t value;
+#if defined(BASE64_SSSE3) || defined(BASE64_NEON)
+    size_t encoded;
+#endif
+
+    if (implementation < 0) {
+        implementation_init();
+    }
+
+#if defined(BASE64_SSSE3) || defined(BASE64_NEON)
+    if (implementation == BASE64_IMPLEMENTATION_SIMD) {
+        encoded = encode_simd(dst_p, src_p, size);
+        dst_p += (4 * (encoded / 3));
+        src_p += encoded;
+        size -= encoded;
+    }
+#endif
+
+    while (size > 0) {
+        value = (((uint32_t)src_p[0] << 16)
+                 | ((uint32_t)src_p[1] << 8)
+                 | src_p[2]);
+        dst_p[0] = encode_table[value >> 18];
+        dst_p[1] = encode_table[(value >> 12) & 0x3f];
+        dst_p[2] = encode_table[(value >> 6) & 0x3f];
+        dst_p[3] = encode_table[value & 0x3f];
+        dst_p += 4;
+        src_p += 3;
+        size -= 3;
+    }
+}
+
+/**
+ * Encode the last one or two bytes of the input, with padding.
+ */
+static void encode_tail(char *dst_p, const uint8_t *src_p, size_t size)
+{
+    uint32_t value;
+
+    value = ((uint32_t)src_p[0] << 16);
+
+    if (size == 2) {
+        value |= ((uint32_t)src_p[1] << 8);
+    }
+
+    dst_p[0] = encode_table[value >> 18];
+    dst_p[1] = encode_table[(value >> 12) & 0x3f];
+
+    if (size == 2) {
+        dst_p[2] = encode_table[(value >> 6) & 0x3f];
+    } else {
+        dst_p[2] = '=';
+    }
+
+    dst_p[3] = '=';
+}
+
+/**
+ * Decode given number of characters, which must be a multiple of 4.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int decode_groups(uint8_t *dst_p, const char *src_p, size_t size)
+{
+    uint32_t value;
+    uint8_t index[4];
+#if defined(BASE64_SSSE3) || defined(BASE64_NEON)
+    size_t decoded;
+#endif
+
+    if (implementation < 0) {
+        implementation_init();
+    }
+
+#if defined(BASE64_SSSE3) || defined(BASE64_NEON)
+    if (implementation == BASE64_IMPLEMENTATION_SIMD) {
+        decoded = decode_simd(dst_p, src_p, size);
+        dst_p += (3 * (decoded / 4));
+        src_p += decoded;
+        size -= decoded;
+    }
+#endif
+
+    while (size > 0) {
+        index[0] = decode_table[(uint8_t)src_p[0]];
+        index[1] = decode_table[(uint8_t)src_p[1]];
+        index[2] = decode_table[(uint8_t)src_p[2]];
+        index[3] = decode_table[(uint8_t)src_p[3]];
+
+        if ((index[0] | index[1] | index[2] | index[3]) == INVALID) {
+            return (-1);
+        }
+
+        value = (((uint32_t)index[0] << 18)
+                 | ((uint32_t)index[1] << 12)
+                 | ((uint32_t)index[2] << 6)
+                 | index[3]);
+        dst_p[0] = (value >> 16);
+        dst_p[1] = (value >> 8);
+        dst_p[2] = value;
+        dst_p += 3;
+        src_p += 4;
+        size -= 4;
+    }
+
+    return (0);
+}
+
+static ssize_t encoder_write(void *self_p, const void *buf_p, size_t size)
+{
+    struct base64_encoder_t *encoder_p;
+    const uint8_t *b_p;
+    char encoded[CHUNK_SIZE];
+    size_t left;
+    size_t n;
+
+    encoder_p = self_p;
+    b_p = buf_p;
+    left = size;
+
+    /* Complete the pending group. */
+    if (encoder_p->size > 0) {
+        n = MIN(3 - encoder_p->size, left);
+        memcpy(&encoder_p->buf[encoder_p->size], b_p, n);
+        encoder_p->size += n;
+        b_p += n;
+        left -= n;
+
+        if (encoder_p->size < 3) {
+            return (size);
+        }
+
+        encode_groups(&encoded[0], &encoder_p->buf[0], 3);
+        encoder_p->size = 0;
+
+        if (chan_write(encoder_p->chout_p, &encoded[0], 4) != 4) {
+            return (-EIO);
+        }
+    }
+
+    /* Encode whole groups straight from the input buffer. */
+    while (left >= 3) {
+        n = MIN(left, 3 * (CHUNK_SIZE / 4));
+        n -= (n % 3);
+        encode_groups(&encoded[0], b_p, n);
+
+        if (chan_write(encoder_p->chout_p, &encoded[0], 4 * (n / 3))
+            != 4 * (n / 3)) {
+            return (-EIO);
+        }
+
+        b_p += n;
+        left -= n;
+    }
+
+    memcpy(&encoder_p->buf[0], b_p, left);
+    encoder_p->size = left;
+
+    return (size);
+}
+
+/**
+ * Decode and write the final, padded, group.
+ */
+static int decoder_write_padded(struct base64_decoder_t *self_p,
+                                const char *src_p)
+{
+    uint8_t decoded[3];
+    size_t size;
+
+    if (src_p[3] != '=') {
+        return (-EINVAL);
+    }
+
+    if (src_p[2] == '=') {
+        size = 1;
+    } else {
+        size = 2;
+    }
+
+    if ((src_p[0] == '=') || (src_p[1] == '=')) {
+        return (-EINVAL);
+    }
+
+    if (decode_groups(&decoded[0], src_p, 4) != 0) {
+        return (-EINVAL);
+    }
+
+    self_p->done = 1;
+
+    if (chan_write(self_p->chout_p, &decoded[0], size) != size) {
+        return (-EIO);
+    }
+
+    return (0);
+}
+
+/**
+ * Decode and write given number of characters, which must be a
+ * multiple of 4. Only the last group may contain padding.
+ */
+static int decoder_write_groups(struct base64_decoder_t *self_p,
+                                const char *src_p,
+                                size_t size)
+{
+    uint8_t decoded[3 * (CHUNK_SIZE / 4)];
+    const char *pad_p;
+    size_t n;
+
+    if (self_p->done == 1) {
+        return (-EINVAL);
+    }
+
+    pad_p = memchr(src_p, '=', size);
+
+    if (pad_p != NULL) {
+        n = ((pad_p - src_p) & ~(size_t)3);
+
+        /* The padded group must be the last group. */
+        if (n + 4 != size) {
+            return (-EINVAL);
+        }
+
+        size = n;
+    }
+
+    while (size > 0) {
+        n = MIN(size, CHUNK_SIZE);
+
+        if (decode_groups(&decoded[0], src_p, n) != 0) {
+            return (-EINVAL);
+        }
+
+        if (chan_write(self_p->chout_p, &decoded[0], 3 * (n / 4))
+            != 3 * (n / 4)) {
+            return (-EIO);
+        }
+
+        src_p += n;
+        size -= n;
+    }
+
+    if (pad_p != NULL) {
+        return (decoder_write_padded(self_p, src_p));
+    }
 
-    return (-1);
+    return (0);
+}
+
+static ssize_t decoder_write(void *self_p, const void *buf_p, size_t size)
+{
+    struct base64_decoder_t *decoder_p;
+    const char *b_p;
+    size_t left;
+    size_t n;
+    int res;
+
+    decoder_p = self_p;
+    b_p = buf_p;
+    left = size;
+
+    /* Complete the pending group. */
+    if (decoder_p->size > 0) {
+        n = MIN(4 - decoder_p->size, left);
+        memcpy(&decoder_p->buf[decoder_p->size], b_p, n);
+        decoder_p->size += n;
+        b_p += n;
+        left -= n;
+
+        if (decoder_p->size < 4) {
+            return (size);
+        }
+
+        decoder_p->size = 0;
+        res = decoder_write_groups(decoder_p, &decoder_p->buf[0], 4);
+
+        if (res != 0) {
+            return (res);
+        }
+    }
+
+    /* Decode whole groups straight from the input buffer. */
+    n = (left & ~(size_t)3);
+
+    if (n > 0) {
+        res = decoder_write_groups(decoder_p, b_p, n);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        b_p += n;
+        left -= n;
+    }
+
+    if (left > 0) {
+        if (decoder_p->done == 1) {
+            return (-EINVAL);
+        }
+
+        memcpy(&decoder_p->buf[0], b_p, left);
+        decoder_p->size = left;
+    }
+
+    return (size);
 }
 
 int base64_encode(char *dst_p, const void *src_p, size_t size)
@@ -72,35 +642,16 @@ int base64_encode(char *dst_p, const void *src_p, size_t size)
     ASSERTN(dst_p != NULL, EINVAL);
     ASSERTN(src_p != NULL, EINVAL);
 
-    int i;
-    int j;
-    int index;
+    size_t groups_size;
     const uint8_t *s_p = src_p;
 
-    for (i = 0, j = 0; i < size; i += 3, j += 4) {
-        index = ((s_p[i + 0] & 0xfc) >> 2);
-        dst_p[j + 0] = index_to_encoded(index);
-        index = ((s_p[i + 0] & 0x03) << 4);
-
-        if (i + 1 < size) {
-            index |= ((s_p[i + 1] & 0xf0) >> 4);
-            dst_p[j + 1] = index_to_encoded(index);
-            index = (s_p[i + 1] & 0x0f) << 2;
-            
-            if (i + 2 < size) {
-                index |= ((s_p[i + 2] & 0xc0) >> 6);
-                dst_p[j + 2] = index_to_encoded(index);
-                index = (s_p[i + 2] & 0x3f);
-                dst_p[j + 3] = index_to_encoded(index);
-            } else {
-                dst_p[j + 2] = index_to_encoded(index);
-                dst_p[j + 3] = index_to_encoded(64);
-            }
-        } else {
-            dst_p[j + 1] = index_to_encoded(index);
-            dst_p[j + 2] = index_to_encoded(64);
-            dst_p[j + 3] = index_to_encoded(64);
-        }
+    groups_size = (size - (size % 3));
+    encode_groups(dst_p, s_p, groups_size);
+
+    if (groups_size < size) {
+        encode_tail(&dst_p[4 * (groups_size / 3)],
+                    &s_p[groups_size],
+                    size - groups_size);
     }
 
     return (0);
@@ -111,32 +662,102 @@ int base64_decode(void *dst_p, const char *src_p, size_t size)
     ASSERTN(dst_p != NULL, EINVAL);
     ASSERTN(src_p != NULL, EINVAL);
 
-    int i;
-    int j;
-    int index[4];
-    uint8_t *d_p = dst_p;
-    
     if ((size % 4) != 0) {
         return (-EINVAL);
     }
 
-    for (i = 0, j = 0; i < size; i += 4, j += 3) {
-        index[0] = encoded_to_index(src_p[i + 0]);
-        index[1] = encoded_to_index(src_p[i + 1]);
-        index[2] = encoded_to_index(src_p[i + 2]);
-        index[3] = encoded_to_index(src_p[i + 3]);
+    return (decode_groups(dst_p, src_p, size));
+}
 
-        if ((index[0] == -1)
-            || (index[1] == -1)
-            || (index[2] == -1)
-            || (index[3] == -1)) {
-            return (-1);
-        }
+int base64_encoder_init(struct base64_encoder_t *self_p, void *chout_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chout_p != NULL, EINVAL);
+
+    chan_init(&self_p->base,
+              chan_read_null,
+              encoder_write,
+              chan_size_null);
+    self_p->chout_p = chout_p;
+    self_p->size = 0;
+
+    return (0);
+}
+
+int base64_encoder_flush(struct base64_encoder_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
 
-        d_p[j] = ((index[0] << 2) | (index[1] >> 4));
-        d_p[j + 1] = ((index[1] << 4) | (index[2] >> 2));
-        d_p[j + 2] = ((index[2] << 6) | index[3]);
+    char encoded[4];
+
+    if (self_p->size == 0) {
+        return (0);
     }
-    
+
+    encode_tail(&encoded[0], &self_p->buf[0], self_p->size);
+    self_p->size = 0;
+
+    if (chan_write(self_p->chout_p, &encoded[0], 4) != 4) {
+        return (-EIO);
+    }
+
+    return (0);
+}
+
+int base64_decoder_init(struct base64_decoder_t *self_p, void *chout_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chout_p != NULL, EINVAL);
+
+    chan_init(&self_p->base,
+              chan_read_null,
+              decoder_write,
+              chan_size_null);
+    self_p->chout_p = chout_p;
+    self_p->size = 0;
+    self_p->done = 0;
+
     return (0);
 }
+
+int base64_decoder_flush(struct base64_decoder_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    res = 0;
+
+    if (self_p->size != 0) {
+        res = -EINVAL;
+    }
+
+    self_p->size = 0;
+    self_p->done = 0;
+
+    return (res);
+}
+
+int base64_set_implementation(int value)
+{
+    if (implementation < 0) {
+        implementation_init();
+    }
+
+    if (!implementation_available(value)) {
+        return (-ENOSYS);
+    }
+
+    implementation = value;
+
+    return (0);
+}
+
+int base64_get_implementation(void)
+{
+    if (implementation < 0) {
+        implementation_init();
+    }
+
+    return (implementation);
+}
@@ -31,6 +31,35 @@
 
 #include "simba.h"
 
+/** Table driven implementation. */
+#define BASE64_IMPLEMENTATION_TABLE                         0
+
+/** SSSE3 or NEON vectorized implementation. */
+#define BASE64_IMPLEMENTATION_SIMD                          1
+
+/**
+ * Streaming encoder. Binary data written to the encoder channel is
+ * base64 encoded and written to the output channel.
+ */
+struct base64_encoder_t {
+    struct chan_t base;
+    void *chout_p;
+    uint8_t buf[3];
+    uint8_t size;
+};
+
+/**
+ * Streaming decoder. Base64 encoded data written to the decoder
+ * channel is decoded and written to the output channel.
+ */
+struct base64_decoder_t {
+    struct chan_t base;
+    void *chout_p;
+    char buf[4];
+    uint8_t size;
+    uint8_t done;
+};
+
 /**
  * Encode given buffer. The encoded data will be ~33.3% larger than
  * the source data. Choose the destination buffer size accordingly.
@@ -56,4 +85,68 @@ int base64_encode(char *dst_p, const void *src_p, size_t size);
  */
 int base64_decode(void *dst_p, const char *src_p, size_t size);
 
+/**
+ * Initialize given streaming encoder. Write data to encode to the
+ * encoder with chan_write(), and call base64_encoder_flush() at the
+ * end of the data.
+ *
+ * @param[out] self_p Encoder to initialize.
+ * @param[in] chout_p Output channel of the encoded data.
+ *
+ * @return zero(0) or negative error code.
+ */
+int base64_encoder_init(struct base64_encoder_t *self_p, void *chout_p);
+
+/**
+ * Encode and write the last, padded, group of the data written to
+ * given encoder. The encoder is ready to encode new data afterwards.
+ *
+ * @param[in] self_p Initialized encoder.
+ *
+ * @return zero(0) or negative error code.
+ */
+int base64_encoder_flush(struct base64_encoder_t *self_p);
+
+/**
+ * Initialize given streaming decoder. Write encoded data to the
+ * decoder with chan_write(), and call base64_decoder_flush() at the
+ * end of the data. A write returns -EINVAL if the encoded data is
+ * invalid.
+ *
+ * @param[out] self_p Decoder to initialize.
+ * @param[in] chout_p Output channel of the decoded data.
+ *
+ * @return zero(0) or negative error code.
+ */
+int base64_decoder_init(struct base64_decoder_t *self_p, void *chout_p);
+
+/**
+ * End the data written to given decoder. The decoder is ready to
+ * decode new data afterwards.
+ *
+ * @param[in] self_p Initialized decoder.
+ *
+ * @return zero(0) or -EINVAL if the length of the encoded data is
+ *         not a multiple of four.
+ */
+int base64_decoder_flush(struct base64_decoder_t *self_p);
+
+/**
+ * Select the codec implementation. The fastest available
+ * implementation is used by default.
+ *
+ * @param[in] implementation One of ``BASE64_IMPLEMENTATION_*``.
+ *
+ * @return zero(0) or -ENOSYS if given implementation is not available
+ *         on this CPU or in this configuration.
+ */
+int base64_set_implementation(int implementation);
+
+/**
+ * Get the codec implementation.
+ *
+ * @return One of ``BASE64_IMPLEMENTATION_*``.
+ */
+int base64_get_implementation(void);
+
 #endif
@@ -28,77 +28,502 @@
 
 #include "simba.h"
 
-static int to_nibble(int ch)
+#if CONFIG_ENCODE_SIMD == 1
+#    if defined(ARCH_LINUX) && (defined(__x86_64__) || defined(__i386__))
+#        define HEX_SSSE3
+#        include <immintrin.h>
+#    elif defined(__aarch64__) && defined(__ARM_NEON)
+#        define HEX_NEON
+#        include <arm_neon.h>
+#    endif
+#endif
+
+/* Maximum number of hex characters written to the output channel at
+   a time by the streaming encoder. */
+#define CHUNK_SIZE                                        128
+
+/* Invalid character in the nibble table. */
+#define INVALID                                          0xff
+
+static FAR const char to_char_table[] = "0123456789abcdef";
+
+/* Hex character to nibble, both upper and lower case. */
+static FAR const uint8_t to_nibble_table[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff
+};
+
+/* Implementation used by the codec, or -1 if not yet selected. */
+static int8_t implementation = -1;
+
+#if defined(HEX_SSSE3)
+
+/**
+ * Convert 16 bytes into 32 hex characters at a time.
+ *
+ * @return Number of converted input bytes.
+ */
+__attribute__((target("ssse3")))
+static size_t from_bin_simd(char *dst_p, const uint8_t *src_p, size_t size)
 {
-    ch = tolower(ch);
+    __m128i in, hi, lo;
+    size_t i;
 
-    if ((ch >= '0') && (ch <= '9')) {
-        return (ch - '0');
-    } else if ((ch >= 'a') && (ch <= 'f')) {
-        return (ch - 'a' + 10);
-    } else {
-        return (-EINVAL);
+    const __m128i lut = _mm_loadu_si128((const __m128i *)&to_char_table[0]);
+    const __m128i mask = _mm_set1_epi8(0x0f);
+
+    for (i = 0; i + 16 <= size; i += 16) {
+        in = _mm_loadu_si128((const __m128i *)&src_p[i]);
+        hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(in, 4), mask));
+        lo = _mm_shuffle_epi8(lut, _mm_and_si128(in, mask));
+        _mm_storeu_si128((__m128i *)&dst_p[2 * i], _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i *)&dst_p[2 * i + 16],
+                         _mm_unpackhi_epi8(hi, lo));
     }
+
+    return (i);
 }
 
-static int from_nibble(uint8_t nibble)
+/**
+ * Convert 32 hex characters into 16 bytes at a time. Stops at the
+ * first block with a non-hex character.
+ *
+ * @return Number of converted input characters.
+ */
+__attribute__((target("ssse3")))
+static size_t to_bin_simd(uint8_t *dst_p, const char *src_p, size_t size)
 {
-    if (nibble < 10) {
-        return (nibble + '0');
-    } else {
-        return (nibble + 'a' - 10);
+    __m128i in[2];
+    __m128i digit, digit_ok, alpha, alpha_ok, valid;
+    size_t i;
+    int j;
+
+    const __m128i ones = _mm_set1_epi8(-1);
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i lower = _mm_set1_epi8(0x20);
+    const __m128i a = _mm_set1_epi8('a');
+    const __m128i five = _mm_set1_epi8(5);
+    const __m128i ten = _mm_set1_epi8(10);
+    const __m128i weights = _mm_set1_epi16(0x0110);
+
+    for (i = 0; i + 32 <= size; i += 32) {
+        valid = ones;
+
+        for (j = 0; j < 2; j++) {
+            in[j] = _mm_loadu_si128((const __m128i *)&src_p[i + 16 * j]);
+            digit = _mm_sub_epi8(in[j], zero);
+            digit_ok = _mm_cmpeq_epi8(_mm_min_epu8(digit, nine), digit);
+            alpha = _mm_sub_epi8(_mm_or_si128(in[j], lower), a);
+            alpha_ok = _mm_cmpeq_epi8(_mm_min_epu8(alpha, five), alpha);
+            valid = _mm_and_si128(valid, _mm_or_si128(digit_ok, alpha_ok));
+            alpha = _mm_add_epi8(alpha, ten);
+            in[j] = _mm_or_si128(_mm_and_si128(digit_ok, digit),
+                                 _mm_andnot_si128(digit_ok, alpha));
+
+            /* Merge nibble pairs into 16 bit words. */
+            in[j] = _mm_maddubs_epi16(in[j], weights);
+        }
+
+        if (_mm_movemask_epi8(valid) != 0xffff) {
+            break;
+        }
+
+        _mm_storeu_si128((__m128i *)&dst_p[i / 2],
+                         _mm_packus_epi16(in[0], in[1]));
     }
+
+    return (i);
 }
 
-int hex_to_bin(void *dst_p, const char *src_p, size_t size)
+static int simd_available(void)
 {
+    __builtin_cpu_init();
+
+    return (__builtin_cpu_supports("ssse3"));
+}
+
+#elif defined(HEX_NEON)
+
+/**
+ * Convert 16 bytes into 32 hex characters at a time.
+ *
+ * @return Number of converted input bytes.
+ */
+static size_t from_bin_simd(char *dst_p, const uint8_t *src_p, size_t size)
+{
+    uint8x16_t lut;
+    uint8x16_t in;
+    uint8x16x2_t out;
     size_t i;
-    uint8_t *u8_dst_p;
-    int ch;
 
-    if ((size % 2) != 0) {
-        return (-EINVAL);
+    lut = vld1q_u8((const uint8_t *)&to_char_table[0]);
+
+    for (i = 0; i + 16 <= size; i += 16) {
+        in = vld1q_u8(&src_p[i]);
+        out.val[0] = vqtbl1q_u8(lut, vshrq_n_u8(in, 4));
+        out.val[1] = vqtbl1q_u8(lut, vandq_u8(in, vdupq_n_u8(0x0f)));
+        vst2q_u8((uint8_t *)&dst_p[2 * i], out);
+    }
+
+    return (i);
+}
+
+/**
+ * Convert 16 hex characters to nibbles.
+ *
+ * @return true(1) if all characters are valid hex characters,
+ *         otherwise false(0).
+ */
+static int to_nibbles_simd(uint8x16_t *nibbles_p, uint8x16_t in)
+{
+    uint8x16_t digit;
+    uint8x16_t digit_ok;
+    uint8x16_t alpha;
+    uint8x16_t alpha_ok;
+
+    digit = vsubq_u8(in, vdupq_n_u8('0'));
+    digit_ok = vcleq_u8(digit, vdupq_n_u8(9));
+    alpha = vsubq_u8(vorrq_u8(in, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+    alpha_ok = vcleq_u8(alpha, vdupq_n_u8(5));
+
+    if (vminvq_u8(vorrq_u8(digit_ok, alpha_ok)) != 0xff) {
+        return (0);
     }
 
-    u8_dst_p = (uint8_t *)dst_p;
-    size /= 2;
+    *nibbles_p = vbslq_u8(digit_ok,
+                          digit,
+                          vaddq_u8(alpha, vdupq_n_u8(10)));
 
-    for (i = 0; i < size; i++) {
-        /* First nibble. */
-        ch = to_nibble(src_p[2 * i]);
+    return (1);
+}
+
+/**
+ * Convert 32 hex characters into 16 bytes at a time. Stops at the
+ * first block with a non-hex character.
+ *
+ * @return Number of converted input characters.
+ */
+static size_t to_bin_simd(uint8_t *dst_p, const char *src_p, size_t size)
+{
+    uint8x16x2_t in;
+    uint8x16_t hi;
+    uint8x16_t lo;
+    size_t i;
 
-        if (ch < 0) {
-            return (ch);
+    for (i = 0; i + 32 <= size; i += 32) {
+        in = vld2q_u8((const uint8_t *)&src_p[i]);
+
+        if (!to_nibbles_simd(&hi, in.val[0])) {
+            break;
+        }
+
+        if (!to_nibbles_simd(&lo, in.val[1])) {
+            break;
         }
 
-        u8_dst_p[i] = ((uint8_t)ch << 4);
+        vst1q_u8(&dst_p[i / 2], vorrq_u8(vshlq_n_u8(hi, 4), lo));
+    }
+
+    return (i);
+}
+
+static int simd_available(void)
+{
+    return (1);
+}
+
+#endif
 
-        /* Second nibble. */
-        ch = to_nibble(src_p[2 * i + 1]);
+static int implementation_available(int value)
+{
+    switch (value) {
+
+    case HEX_IMPLEMENTATION_TABLE:
+        return (1);
+
+#if defined(HEX_SSSE3) || defined(HEX_NEON)
+    case HEX_IMPLEMENTATION_SIMD:
+        return (simd_available());
+#endif
+
+    default:
+        return (0);
+    }
+}
+
+static void implementation_init(void)
+{
+    if (implementation_available(HEX_IMPLEMENTATION_SIMD)) {
+        implementation = HEX_IMPLEMENTATION_SIMD;
+    } else {
+        implementation = HEX_IMPLEMENTATION_TABLE;
+    }
+}
 
-        if (ch < 0) {
-            return (ch);
+/**
+ * Convert given number of hex characters, which must be even, to
+ * binary data.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int to_bin(uint8_t *dst_p, const char *src_p, size_t size)
+{
+    uint8_t hi;
+    uint8_t lo;
+#if defined(HEX_SSSE3) || defined(HEX_NEON)
+    size_t converted;
+#endif
+
+    if (implementation < 0) {
+        implementation_init();
+    }
+
+#if defined(HEX_SSSE3) || defined(HEX_NEON)
+    if (implementation == HEX_IMPLEMENTATION_SIMD) {
+        converted = to_bin_simd(dst_p, src_p, size);
+        dst_p += (converted / 2);
+        src_p += converted;
+        size -= converted;
+    }
+#endif
+
+    while (size > 0) {
+        hi = to_nibble_table[(uint8_t)src_p[0]];
+        lo = to_nibble_table[(uint8_t)src_p[1]];
+
+        if ((hi | lo) == INVALID) {
+            return (-EINVAL);
         }
 
-        u8_dst_p[i] |= (uint8_t)ch;
+        *dst_p++ = ((hi << 4) | lo);
+        src_p += 2;
+        size -= 2;
+    }
+
+    return (0);
+}
+
+/**
+ * Convert given binary data to hex characters, without
+ * null-termination.
+ */
+static void from_bin(char *dst_p, const uint8_t *src_p, size_t size)
+{
+#if defined(HEX_SSSE3) || defined(HEX_NEON)
+    size_t converted;
+#endif
+
+    if (implementation < 0) {
+        implementation_init();
+    }
+
+#if defined(HEX_SSSE3) || defined(HEX_NEON)
+    if (implementation == HEX_IMPLEMENTATION_SIMD) {
+        converted = from_bin_simd(dst_p, src_p, size);
+        dst_p += (2 * converted);
+        src_p += converted;
+        size -= converted;
+    }
+#endif
+
+    while (size > 0) {
+        *dst_p++ = to_char_table[*src_p >> 4];
+        *dst_p++ = to_char_table[*src_p & 0x0f];
+        src_p++;
+        size--;
+    }
+}
+
+static ssize_t encoder_write(void *self_p, const void *buf_p, size_t size)
+{
+    struct hex_encoder_t *encoder_p;
+    const uint8_t *b_p;
+    char encoded[CHUNK_SIZE];
+    size_t left;
+    size_t n;
+
+    encoder_p = self_p;
+    b_p = buf_p;
+    left = size;
+
+    while (left > 0) {
+        n = MIN(left, CHUNK_SIZE / 2);
+        from_bin(&encoded[0], b_p, n);
+
+        if (chan_write(encoder_p->chout_p, &encoded[0], 2 * n) != 2 * n) {
+            return (-EIO);
+        }
+
+        b_p += n;
+        left -= n;
     }
 
     return (size);
 }
 
-int hex_from_bin(char *dst_p, const void *src_p, size_t size)
+static ssize_t decoder_write(void *self_p, const void *buf_p, size_t size)
 {
-    size_t i;
-    const uint8_t *u8_src_p;
+    struct hex_decoder_t *decoder_p;
+    const char *b_p;
+    uint8_t decoded[CHUNK_SIZE / 2];
+    size_t left;
+    size_t n;
 
-    u8_src_p = (const uint8_t *)src_p;
+    decoder_p = self_p;
+    b_p = buf_p;
+    left = size;
 
-    for (i = 0; i < size; i++) {
-        dst_p[2 * i] = from_nibble((u8_src_p[i] >> 4) & 0x0f);
-        dst_p[2 * i + 1] = from_nibble(u8_src_p[i] & 0x0f);
+    /* Complete the pending byte. */
+    if ((decoder_p->size > 0) && (left > 0)) {
+        decoder_p->buf[1] = *b_p++;
+        left--;
+        decoder_p->size = 0;
+
+        if (to_bin(&decoded[0], &decoder_p->buf[0], 2) != 0) {
+            return (-EINVAL);
+        }
+
+        if (chan_write(decoder_p->chout_p, &decoded[0], 1) != 1) {
+            return (-EIO);
+        }
+    }
+
+    while (left >= 2) {
+        n = MIN(left, CHUNK_SIZE);
+        n &= ~(size_t)1;
+
+        if (to_bin(&decoded[0], b_p, n) != 0) {
+            return (-EINVAL);
+        }
+
+        if (chan_write(decoder_p->chout_p, &decoded[0], n / 2) != n / 2) {
+            return (-EIO);
+        }
+
+        b_p += n;
+        left -= n;
     }
 
+    if (left > 0) {
+        decoder_p->buf[0] = *b_p;
+        decoder_p->size = 1;
+    }
+
+    return (size);
+}
+
+int hex_to_bin(void *dst_p, const char *src_p, size_t size)
+{
+    int res;
+
+    if ((size % 2) != 0) {
+        return (-EINVAL);
+    }
+
+    res = to_bin(dst_p, src_p, size);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (size / 2);
+}
+
+int hex_from_bin(char *dst_p, const void *src_p, size_t size)
+{
+    from_bin(dst_p, src_p, size);
     dst_p[2 * size] = '\0';
 
     return (2 * size);
 }
+
+int hex_encoder_init(struct hex_encoder_t *self_p, void *chout_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chout_p != NULL, EINVAL);
+
+    chan_init(&self_p->base,
+              chan_read_null,
+              encoder_write,
+              chan_size_null);
+    self_p->chout_p = chout_p;
+
+    return (0);
+}
+
+int hex_decoder_init(struct hex_decoder_t *self_p, void *chout_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chout_p != NULL, EINVAL);
+
+    chan_init(&self_p->base,
+              chan_read_null,
+              decoder_write,
+              chan_size_null);
+    self_p->chout_p = chout_p;
+    self_p->size = 0;
+
+    return (0);
+}
+
+int hex_decoder_flush(struct hex_decoder_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    res = 0;
+
+    if (self_p->size != 0) {
+        res = -EINVAL;
+    }
+
+    self_p->size = 0;
+
+    return (res);
+}
+
+int hex_set_implementation(int value)
+{
+    if (implementation < 0) {
+        implementation_init();
+    }
+
+    if (!implementation_available(value)) {
+        return (-ENOSYS);
+    }
+
+    implementation = value;
+
+    return (0);
+}
+
+int hex_get_implementation(void)
+{
+    if (implementation < 0) {
+        implementation_init();
+    }
+
+    return (implementation);
+}
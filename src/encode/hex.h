@@ -31,6 +31,33 @@
 
 #include "simba.h"
 
+/** Table driven implementation. */
+#define HEX_IMPLEMENTATION_TABLE                            0
+
+/** SSSE3 or NEON vectorized implementation. */
+#define HEX_IMPLEMENTATION_SIMD                             1
+
+/**
+ * Streaming encoder. Binary data written to the encoder channel is
+ * converted to lower case hex characters and written to the output
+ * channel.
+ */
+struct hex_encoder_t {
+    struct chan_t base;
+    void *chout_p;
+};
+
+/**
+ * Streaming decoder. Hex characters written to the decoder channel
+ * are converted to binary data and written to the output channel.
+ */
+struct hex_decoder_t {
+    struct chan_t base;
+    void *chout_p;
+    char buf[2];
+    uint8_t size;
+};
+
 /**
  * Convert given hex string to binary data.
  *
@@ -56,4 +83,56 @@ int hex_to_bin(void *dst_p, const char *src_p, size_t size);
  */
 int hex_from_bin(char *dst_p, const void *src_p, size_t size);
 
+/**
+ * Initialize given streaming encoder. Write binary data to the
+ * encoder with chan_write().
+ *
+ * @param[out] self_p Encoder to initialize.
+ * @param[in] chout_p Output channel of the hex characters.
+ *
+ * @return zero(0) or negative error code.
+ */
+int hex_encoder_init(struct hex_encoder_t *self_p, void *chout_p);
+
+/**
+ * Initialize given streaming decoder. Write hex characters to the
+ * decoder with chan_write(), and call hex_decoder_flush() at the end
+ * of the data. A write returns -EINVAL on non-hex characters.
+ *
+ * @param[out] self_p Decoder to initialize.
+ * @param[in] chout_p Output channel of the binary data.
+ *
+ * @return zero(0) or negative error code.
+ */
+int hex_decoder_init(struct hex_decoder_t *self_p, void *chout_p);
+
+/**
+ * End the data written to given decoder. The decoder is ready to
+ * decode new data afterwards.
+ *
+ * @param[in] self_p Initialized decoder.
+ *
+ * @return zero(0) or -EINVAL if an odd number of hex characters were
+ *         written.
+ */
+int hex_decoder_flush(struct hex_decoder_t *self_p);
+
+/**
+ * Select the codec implementation. The fastest available
+ * implementation is used by default.
+ *
+ * @param[in] implementation One of ``HEX_IMPLEMENTATION_*``.
+ *
+ * @return zero(0) or -ENOSYS if given implementation is not available
+ *         on this CPU or in this configuration.
+ */
+int hex_set_implementation(int implementation);
+
+/**
+ * Get the codec implementation.
+ *
+ * @return One of ``HEX_IMPLEMENTATION_*``.
+ */
+int hex_get_implementation(void);
+
 #endif
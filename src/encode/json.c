@@ -56,34 +56,33 @@
 
 #include "simba.h"
 
-struct dump_t {
-    struct json_t *self_p;
+/**
+ * State of the serializers. The output is written to a channel, a
+ * buffer or a vector. The output size is only counted if all of them
+ * are NULL.
+ */
+struct serialize_t {
     struct json_tok_t *tokens_p;
     int num_tokens;
-    void *out_p;
-};
-
-struct string_t {
-    struct chan_t base;
-    ssize_t pos;
+    void *chan_p;
     char *buf_p;
+    size_t size;
+    size_t pos;
+    struct iov_t *iov_p;
+    int iov_length;
+    int iov_pos;
 };
 
-static ssize_t dump(struct dump_t *state_p);
-
-/**
- * Copy given buffer to the output buffer. It is not null terminated.
- */
-static ssize_t string_write(void *chan_p, const void *buf_p, size_t size)
-{
-    struct string_t *string_p;
-
-    string_p = chan_p;
-    memcpy(&string_p->buf_p[string_p->pos], buf_p, size);
-    string_p->pos += size;
+/* Single character fragments referenced by the vector serializer. */
+static const char punctuation[] = "{}[],:\"";
 
-    return (size);
-}
+#define PUNCT_OBJECT_BEGIN                   (&punctuation[0])
+#define PUNCT_OBJECT_END                     (&punctuation[1])
+#define PUNCT_ARRAY_BEGIN                    (&punctuation[2])
+#define PUNCT_ARRAY_END                      (&punctuation[3])
+#define PUNCT_COMMA                          (&punctuation[4])
+#define PUNCT_COLON                          (&punctuation[5])
+#define PUNCT_QUOTE                          (&punctuation[6])
 
 /**
  * Allocates a fresh unused token from the token pull.
@@ -122,140 +121,175 @@ static void fill_token(struct json_tok_t *token_p,
 }
 
 /**
- * Recursively dump given object token and its children.
+ * Returns true if all characters in given buffer are printable. Four
+ * characters are checked at a time.
  */
-static ssize_t dump_object(struct dump_t *state_p,
-                           struct json_tok_t *token_p)
+static int is_printable(const char *buf_p, size_t size)
 {
-    ssize_t size, res, i;
-    const char *delim_p;
-
-    std_fprintf(state_p->out_p, FSTR("{"));
-    size = 2;
-    delim_p = FSTR("");
+    uint32_t word;
+    size_t i;
 
-    for (i = 0; i < token_p->num_tokens; i++) {
-        /* Delimiter. */
-        res = std_fprintf(state_p->out_p, delim_p);
-        size += res;
-
-        /* Key. */
+    for (i = 0; i + 4 <= size; i += 4) {
+        memcpy(&word, &buf_p[i], sizeof(word));
 
-        /* The key must be a string or primitive type. */
-        if (!((state_p->tokens_p->type == JSON_STRING)
-              || (state_p->tokens_p->type == JSON_PRIMITIVE))) {
-            return (-1);
+        /* Any byte below 0x20 or above 0x7e. */
+        if ((((word - 0x20202020u) & ~word)
+             | ((word + 0x01010101u) | word)) & 0x80808080u) {
+            return (0);
         }
+    }
 
-        res = dump(state_p);
-
-        if (res < 0) {
-            return (res);
+    for (; i < size; i++) {
+        if (!isprint((int)(uint8_t)buf_p[i])) {
+            return (0);
         }
+    }
 
-        size += res;
-
-        /* Key-value pair colon. */
-        std_fprintf(state_p->out_p, FSTR(":"));
-        size++;
+    return (1);
+}
 
-        /* Value. */
-        res = dump(state_p);
+/**
+ * Append given fragment to the output buffer or vector, or just count
+ * its size.
+ */
+static int serialize_write(struct serialize_t *state_p,
+                           const char *buf_p,
+                           size_t size)
+{
+    if (state_p->chan_p != NULL) {
+        if (size > 0) {
+            if (chan_write(state_p->chan_p, buf_p, size) != (ssize_t)size) {
+                return (-EIO);
+            }
+        }
+    } else if (state_p->iov_p != NULL) {
+        if (state_p->iov_pos == state_p->iov_length) {
+            return (JSON_ERROR_NOMEM);
+        }
 
-        if (res < 0) {
-            return (-1);
+        state_p->iov_p[state_p->iov_pos].buf_p = (void *)buf_p;
+        state_p->iov_p[state_p->iov_pos].size = size;
+        state_p->iov_pos++;
+    } else if (state_p->buf_p != NULL) {
+        if (size > state_p->size - state_p->pos) {
+            return (JSON_ERROR_NOMEM);
         }
 
-        size += res;
-        delim_p = FSTR(",");
+        memcpy(&state_p->buf_p[state_p->pos], buf_p, size);
     }
 
-    std_fprintf(state_p->out_p, FSTR("}"));
+    state_p->pos += size;
 
-    return (size);
+    return (0);
 }
 
 /**
- * Recursively dump given array token and its children.
+ * Append given string fragment within quotes.
  */
-static ssize_t dump_array(struct dump_t *state_p,
-                          struct json_tok_t *token_p)
+static int serialize_string(struct serialize_t *state_p,
+                            const char *buf_p,
+                            size_t size)
 {
-    ssize_t size, res, i;
-    const char *delim_p;
-
-    std_fprintf(state_p->out_p, FSTR("["));
-    size = 2;
-    delim_p = FSTR("");
-
-    for (i = 0; i < token_p->num_tokens; i++) {
-        /* Delimiter. */
-        res = std_fprintf(state_p->out_p, delim_p);
-        size += res;
+    int res;
 
-        res = dump(state_p);
+    if (!is_printable(buf_p, size)) {
+        return (JSON_ERROR_INVAL);
+    }
 
-        if (res < 0) {
-            return (-1);
-        }
+    res = serialize_write(state_p, PUNCT_QUOTE, 1);
 
-        size += res;
-        delim_p = FSTR(",");
+    if ((res == 0) && (size > 0)) {
+        res = serialize_write(state_p, buf_p, size);
     }
 
-    std_fprintf(state_p->out_p, FSTR("]"));
+    if (res == 0) {
+        res = serialize_write(state_p, PUNCT_QUOTE, 1);
+    }
 
-    return (size);
+    return (res);
 }
 
 /**
- * Dump given string token.
+ * Append given C string fragment within quotes. Quotes, backslashes
+ * and control characters are escaped. Runs of characters that need
+ * no escaping are written as single fragments.
  */
-static ssize_t dump_string(struct dump_t *state_p,
-                           struct json_tok_t *token_p)
+static int serialize_escaped_string(struct serialize_t *state_p,
+                                    const char *buf_p,
+                                    size_t size)
 {
-    int i;
+    static const char hexadecimal_digits[] = "0123456789abcdef";
+    size_t begin;
+    size_t i;
+    uint8_t c;
+    int res;
 
-    std_fprintf(state_p->out_p, FSTR("\""));
+    res = serialize_write(state_p, PUNCT_QUOTE, 1);
+    begin = 0;
 
-    for (i = 0; i < token_p->size; i++) {
-        if (!isprint((int)token_p->buf_p[i])) {
-            return (-1);
+    for (i = 0; (i < size) && (res == 0); i++) {
+        c = (uint8_t)buf_p[i];
+
+        if ((c >= 0x20) && (c != '"') && (c != '\\')) {
+            continue;
         }
 
-        std_fprintf(state_p->out_p, FSTR("%c"), token_p->buf_p[i]);
-    }
+        if (i > begin) {
+            res = serialize_write(state_p, &buf_p[begin], i - begin);
 
-    std_fprintf(state_p->out_p, FSTR("\""));
+            if (res != 0) {
+                break;
+            }
+        }
 
-    return (token_p->size + 2);
-}
+        if (c >= 0x20) {
+            res = serialize_write(state_p, "\\", 1);
 
-/**
- * Dump given primitive token.
- */
-static ssize_t dump_primitive(struct dump_t *state_p,
-                              struct json_tok_t *token_p)
-{
-    int i;
+            if (res == 0) {
+                res = serialize_write(state_p, &buf_p[i], 1);
+            }
+        } else {
+            res = serialize_write(state_p, "\\u00", 4);
+
+            if (res == 0) {
+                res = serialize_write(state_p,
+                                      &hexadecimal_digits[c >> 4],
+                                      1);
+            }
+
+            if (res == 0) {
+                res = serialize_write(state_p,
+                                      &hexadecimal_digits[c & 0xf],
+                                      1);
+            }
+        }
+
+        begin = (i + 1);
+    }
 
-    for (i = 0; i < token_p->size; i++) {
-        std_fprintf(state_p->out_p, FSTR("%c"), token_p->buf_p[i]);
+    if ((res == 0) && (size > begin)) {
+        res = serialize_write(state_p, &buf_p[begin], size - begin);
     }
 
-    return (token_p->size);
+    if (res == 0) {
+        res = serialize_write(state_p, PUNCT_QUOTE, 1);
+    }
+
+    return (res);
 }
 
 /**
- * Recursively dumps one token and it's children.
+ * Recursively serialize one token and its children.
  */
-static ssize_t dump(struct dump_t *state_p)
+static int serialize(struct serialize_t *state_p)
 {
-    ssize_t size;
     struct json_tok_t *token_p;
+    const char *end_p;
+    int res;
+    int i;
 
     if (state_p->num_tokens == 0) {
-        return (-1);
+        return (JSON_ERROR_INVAL);
     }
 
     token_p = state_p->tokens_p;
@@ -265,29 +299,294 @@ static ssize_t dump(struct dump_t *state_p)
     switch (token_p->type) {
 
     case JSON_OBJECT:
-        size = dump_object(state_p, token_p);
-        break;
-
     case JSON_ARRAY:
-        size = dump_array(state_p, token_p);
+        if (token_p->type == JSON_OBJECT) {
+            res = serialize_write(state_p, PUNCT_OBJECT_BEGIN, 1);
+            end_p = PUNCT_OBJECT_END;
+        } else {
+            res = serialize_write(state_p, PUNCT_ARRAY_BEGIN, 1);
+            end_p = PUNCT_ARRAY_END;
+        }
+
+        for (i = 0; (i < token_p->num_tokens) && (res == 0); i++) {
+            if (i > 0) {
+                res = serialize_write(state_p, PUNCT_COMMA, 1);
+
+                if (res != 0) {
+                    break;
+                }
+            }
+
+            if (token_p->type == JSON_OBJECT) {
+                /* The key must be a string or primitive type. */
+                if ((state_p->num_tokens == 0)
+                    || !((state_p->tokens_p->type == JSON_STRING)
+                         || (state_p->tokens_p->type == JSON_PRIMITIVE))) {
+                    return (JSON_ERROR_INVAL);
+                }
+
+                res = serialize(state_p);
+
+                if (res == 0) {
+                    res = serialize_write(state_p, PUNCT_COLON, 1);
+                }
+
+                if (res != 0) {
+                    break;
+                }
+            }
+
+            res = serialize(state_p);
+        }
+
+        if (res == 0) {
+            res = serialize_write(state_p, end_p, 1);
+        }
+
         break;
 
     case JSON_STRING:
-        size = dump_string(state_p, token_p);
+        res = serialize_string(state_p, token_p->buf_p, token_p->size);
         break;
 
     case JSON_PRIMITIVE:
-        size = dump_primitive(state_p, token_p);
+        res = serialize_write(state_p, token_p->buf_p, token_p->size);
         break;
 
     default:
-        size = -1;
+        res = JSON_ERROR_INVAL;
         break;
     }
 
+    return (res);
+}
+
+/**
+ * Initialize the serializer state for given root token.
+ */
+static int serialize_init(struct serialize_t *state_p,
+                          struct json_t *self_p,
+                          struct json_tok_t *tokens_p)
+{
+    if (tokens_p == NULL) {
+        tokens_p = self_p->tokens_p;
+    }
+
+    /* The first token must be an object or an array. */
+    if ((self_p->num_tokens == 0)
+        || !((tokens_p->type == JSON_OBJECT)
+             || (tokens_p->type == JSON_ARRAY))) {
+        return (JSON_ERROR_INVAL);
+    }
+
+    state_p->tokens_p = tokens_p;
+    state_p->num_tokens = self_p->num_tokens;
+    state_p->chan_p = NULL;
+    state_p->buf_p = NULL;
+    state_p->size = 0;
+    state_p->pos = 0;
+    state_p->iov_p = NULL;
+    state_p->iov_length = 0;
+    state_p->iov_pos = 0;
+
+    return (0);
+}
+
+/**
+ * Format given unsigned integer as decimal digits. Returns the number
+ * of digits.
+ */
+static size_t format_uint32(char *buf_p, uint32_t value)
+{
+    static const char digits[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+    size_t size;
+    size_t pos;
+    uint32_t rest;
+
+    size = 1;
+
+    for (rest = value; rest >= 10; rest /= 10) {
+        size++;
+    }
+
+    /* Two digits at a time from the end. */
+    pos = size;
+
+    while (value >= 100) {
+        pos -= 2;
+        memcpy(&buf_p[pos], &digits[2 * (value % 100)], 2);
+        value /= 100;
+    }
+
+    if (value >= 10) {
+        memcpy(&buf_p[pos - 2], &digits[2 * value], 2);
+    } else {
+        buf_p[pos - 1] = ('0' + value);
+    }
+
     return (size);
 }
 
+#if CONFIG_FLOAT == 1
+
+/**
+ * Format given float with six decimals, always with at least one
+ * whole digit. Returns the number of characters, or a negative error
+ * code if the value is not finite or its whole part does not fit in
+ * 32 bits.
+ */
+static int format_float(char *buf_p, float value)
+{
+    double absolute;
+    uint32_t whole_number;
+    uint32_t fraction_number;
+    size_t size;
+    int i;
+
+    absolute = value;
+    size = 0;
+
+    if (absolute < 0.0) {
+        absolute = -absolute;
+        buf_p[size++] = '-';
+    }
+
+    /* Also false for NaN. */
+    if (!(absolute < 4294967296.0)) {
+        return (JSON_ERROR_INVAL);
+    }
+
+    whole_number = (uint32_t)absolute;
+    fraction_number = (uint32_t)((absolute - whole_number) * 1000000.0);
+
+    size += format_uint32(&buf_p[size], whole_number);
+    buf_p[size++] = '.';
+
+    for (i = 5; i >= 0; i--) {
+        buf_p[size + i] = ('0' + (fraction_number % 10));
+        fraction_number /= 10;
+    }
+
+    return (size + 6);
+}
+
+#endif
+
+/**
+ * Serialize given C struct as an object using given schema.
+ */
+static int serialize_schema(struct serialize_t *state_p,
+                            const struct json_field_t *fields_p,
+                            int length,
+                            const void *value_p)
+{
+    const struct json_field_t *field_p;
+    const uint8_t *member_p;
+    const char *string_p;
+    char buf[20];
+    size_t size;
+    int32_t value;
+    int res;
+    int i;
+
+    res = serialize_write(state_p, PUNCT_OBJECT_BEGIN, 1);
+
+    for (i = 0; (i < length) && (res == 0); i++) {
+        field_p = &fields_p[i];
+        member_p = &((const uint8_t *)value_p)[field_p->offset];
+
+        if (i > 0) {
+            res = serialize_write(state_p, PUNCT_COMMA, 1);
+
+            if (res != 0) {
+                break;
+            }
+        }
+
+        /* The quoted key and colon are a single fragment. */
+        res = serialize_write(state_p, field_p->key_p, field_p->key_size);
+
+        if (res != 0) {
+            break;
+        }
+
+        switch (field_p->type) {
+
+        case JSON_FIELD_TYPE_INT32:
+            memcpy(&value, member_p, sizeof(value));
+
+            if (value < 0) {
+                buf[0] = '-';
+                size = (1 + format_uint32(&buf[1], -(uint32_t)value));
+            } else {
+                size = format_uint32(&buf[0], value);
+            }
+
+            res = serialize_write(state_p, &buf[0], size);
+            break;
+
+        case JSON_FIELD_TYPE_UINT32:
+            size = format_uint32(&buf[0], *(const uint32_t *)member_p);
+            res = serialize_write(state_p, &buf[0], size);
+            break;
+
+        case JSON_FIELD_TYPE_BOOL:
+            if (*(const int *)member_p) {
+                res = serialize_write(state_p, "true", 4);
+            } else {
+                res = serialize_write(state_p, "false", 5);
+            }
+
+            break;
+
+        case JSON_FIELD_TYPE_STRING:
+            string_p = *(const char * const *)member_p;
+
+            if (string_p == NULL) {
+                res = serialize_write(state_p, "null", 4);
+            } else {
+                res = serialize_escaped_string(state_p,
+                                               string_p,
+                                               strlen(string_p));
+            }
+
+            break;
+
+#if CONFIG_FLOAT == 1
+        case JSON_FIELD_TYPE_FLOAT:
+            res = format_float(&buf[0], *(const float *)member_p);
+
+            if (res < 0) {
+                break;
+            }
+
+            res = serialize_write(state_p, &buf[0], res);
+            break;
+#endif
+
+        default:
+            res = JSON_ERROR_INVAL;
+            break;
+        }
+    }
+
+    if (res == 0) {
+        res = serialize_write(state_p, PUNCT_OBJECT_END, 1);
+    }
+
+    return (res);
+}
+
 /**
  * Fills next available token with JSON primitive.
  */
@@ -446,89 +745,790 @@ static int parse_string(struct json_t *self_p,
                     self_p->pos++;
                 }
 
-                self_p->pos--;
-                break;
+                self_p->pos--;
+                break;
+
+                /* Unexpected symbol */
+            default:
+                self_p->pos = start;
+
+                return (JSON_ERROR_INVAL);
+            }
+        }
+    }
+
+    self_p->pos = start;
+
+    return (JSON_ERROR_PART);
+}
+
+/**
+ * Recursively get the number of child tokens of given token.
+ */
+static int get_number_of_children(struct json_tok_t *token_p)
+{
+    int i;
+    int number_of_children;
+    struct json_tok_t *child_p;
+
+    number_of_children = 0;
+
+    for (i = 0; i < token_p->num_tokens; i++) {
+        child_p = &token_p[number_of_children + 1 + i];
+
+        if (child_p->num_tokens > 0) {
+            number_of_children += get_number_of_children(child_p);
+        }
+    }
+
+    number_of_children += token_p->num_tokens;
+
+    return (number_of_children);
+}
+
+/**
+ * Returns true if given token is covered by the index.
+ */
+static int is_indexed(struct json_t *self_p, struct json_tok_t *token_p)
+{
+    return ((self_p->index.sizes_p != NULL)
+            && (token_p >= self_p->tokens_p)
+            && (token_p < &self_p->tokens_p[self_p->toknext]));
+}
+
+/**
+ * FNV-1a hash of given key in given object.
+ */
+static uint32_t index_hash(int object, const char *key_p, size_t size)
+{
+    uint32_t hash;
+    size_t i;
+
+    hash = (2166136261u ^ (uint32_t)object);
+
+    for (i = 0; i < size; i++) {
+        hash ^= (uint8_t)key_p[i];
+        hash *= 16777619u;
+    }
+
+    return (hash);
+}
+
+/**
+ * Find given key in given object using the index.
+ */
+static struct json_tok_t *index_object_get(struct json_t *self_p,
+                                           const char *key_p,
+                                           struct json_tok_t *object_p,
+                                           int type)
+{
+    struct json_tok_t *token_p;
+    int object;
+    int bucket;
+    int key;
+    size_t key_length;
+
+    object = (object_p - self_p->tokens_p);
+    key_length = strlen(key_p);
+    bucket = (index_hash(object, key_p, key_length)
+              % self_p->index.num_buckets);
+
+    /* Linear probing until an empty bucket is found. */
+    while (self_p->index.buckets_p[bucket] != 0) {
+        key = (self_p->index.buckets_p[bucket] - 1);
+        token_p = &self_p->tokens_p[key];
+
+        if ((self_p->index.slots_p[key] == object)
+            && (token_p->type == type)
+            && (token_p->size == key_length)
+            && (memcmp(token_p->buf_p, key_p, key_length) == 0)) {
+            return (token_p + 1);
+        }
+
+        bucket++;
+
+        if (bucket == self_p->index.num_buckets) {
+            bucket = 0;
+        }
+    }
+
+    return (NULL);
+}
+
+static struct json_tok_t *object_get(struct json_t *self_p,
+                                     const char *key_p,
+                                     struct json_tok_t *object_p,
+                                     int type)
+{
+    ASSERTNRN(self_p != NULL, EINVAL);
+    ASSERTNRN(key_p != NULL, EINVAL);
+
+    int i;
+    int key_length;
+    int number_of_children;
+    struct json_tok_t *token_p;
+
+    /* Return immediatly if no object is found. */
+    if (object_p == NULL) {
+        return (NULL);
+    }
+
+    /* Check that the token is an object. */
+    if (object_p->type != JSON_OBJECT) {
+        return (NULL);
+    }
+
+    if (is_indexed(self_p, object_p)) {
+        return (index_object_get(self_p, key_p, object_p, type));
+    }
+
+    key_length = strlen(key_p);
+
+    /* The first child token. */
+    token_p = (object_p + 1);
+
+    /* Find given key in the object. */
+    for (i = 0; i < object_p->num_tokens; i++) {
+        if (token_p->type == type) {
+            if (strncmp(key_p, token_p->buf_p, key_length) == 0) {
+                return (token_p + 1);
+            }
+        }
+
+        /* Get the next child token. */
+        number_of_children = get_number_of_children(token_p);
+        token_p += (number_of_children + 1);
+    }
+
+    return (NULL);
+}
+
+/**
+ * Streaming parser states.
+ */
+enum stream_state_t {
+    /* Expecting a value. */
+    STREAM_STATE_VALUE = 0,
+    /* After '[', expecting a value or ']'. */
+    STREAM_STATE_VALUE_OR_END,
+    /* After '{', expecting a key or '}'. */
+    STREAM_STATE_KEY_OR_END,
+    /* After ',' in an object, expecting a key. */
+    STREAM_STATE_KEY,
+    STREAM_STATE_COLON,
+    STREAM_STATE_COMMA_OR_END,
+    STREAM_STATE_STRING,
+    STREAM_STATE_STRING_ESCAPE,
+    STREAM_STATE_STRING_UNICODE,
+    STREAM_STATE_PRIMITIVE,
+    /* The root value is complete. */
+    STREAM_STATE_DONE,
+    STREAM_STATE_ERROR
+};
+
+/* The character was not consumed and must be processed again. */
+#define STREAM_RETRY                                        1
+
+/* Bytes read from the input channel at a time. */
+#define STREAM_READ_CHUNK_SIZE                             64
+
+static int stream_emit(struct json_stream_t *self_p,
+                       enum json_stream_event_t event,
+                       const char *buf_p,
+                       size_t size)
+{
+    return (self_p->callback(self_p->arg_p,
+                             event,
+                             &self_p->path.buf[0],
+                             buf_p,
+                             size));
+}
+
+static void stream_path_truncate(struct json_stream_t *self_p,
+                                 size_t length)
+{
+    self_p->path.length = length;
+    self_p->path.buf[length] = '\0';
+}
+
+static int stream_path_append(struct json_stream_t *self_p,
+                              const char *buf_p,
+                              size_t size)
+{
+    size_t length;
+
+    length = self_p->path.length;
+
+    if (length + 1 + size >= sizeof(self_p->path.buf)) {
+        return (JSON_ERROR_NOMEM);
+    }
+
+    self_p->path.buf[length] = '/';
+    memcpy(&self_p->path.buf[length + 1], buf_p, size);
+    stream_path_truncate(self_p, length + 1 + size);
+
+    return (0);
+}
+
+static int stream_value_append(struct json_stream_t *self_p,
+                               const char *buf_p,
+                               size_t size)
+{
+    if (self_p->value.size + size > sizeof(self_p->value.buf)) {
+        return (JSON_ERROR_NOMEM);
+    }
+
+    memcpy(&self_p->value.buf[self_p->value.size], buf_p, size);
+    self_p->value.size += size;
+
+    return (0);
+}
+
+/**
+ * Returns true(1) if the value at the current path shall be reported
+ * to the user.
+ */
+static int stream_is_selected(struct json_stream_t *self_p)
+{
+    const char **selector_pp;
+
+    if ((self_p->depth > 0)
+        && self_p->levels[self_p->depth - 1].selected) {
+        return (1);
+    }
+
+    selector_pp = self_p->selectors_pp;
+
+    if (selector_pp == NULL) {
+        return (1);
+    }
+
+    while (*selector_pp != NULL) {
+        if (strcmp(*selector_pp, &self_p->path.buf[0]) == 0) {
+            return (1);
+        }
+
+        selector_pp++;
+    }
+
+    return (0);
+}
+
+/**
+ * Called at the beginning of each value to update the path and the
+ * selection.
+ */
+static int stream_value_begin(struct json_stream_t *self_p)
+{
+    struct json_stream_level_t *level_p;
+    char index[12];
+    int res;
+
+    if (self_p->depth > 0) {
+        level_p = &self_p->levels[self_p->depth - 1];
+
+        if (level_p->type == JSON_ARRAY) {
+            stream_path_truncate(self_p, level_p->path_length);
+            res = stream_path_append(self_p,
+                                     &index[0],
+                                     std_sprintf(&index[0],
+                                                 FSTR("%d"),
+                                                 level_p->index));
+
+            if (res != 0) {
+                return (res);
+            }
+
+            level_p->index++;
+        }
+    }
+
+    self_p->value.selected = stream_is_selected(self_p);
+    self_p->value.size = 0;
+
+    return (0);
+}
+
+static void stream_value_end(struct json_stream_t *self_p)
+{
+    if (self_p->depth == 0) {
+        self_p->state = STREAM_STATE_DONE;
+    } else {
+        self_p->state = STREAM_STATE_COMMA_OR_END;
+    }
+}
+
+static int stream_container_begin(struct json_stream_t *self_p,
+                                  enum json_type_t type)
+{
+    struct json_stream_level_t *level_p;
+    int res;
+
+    res = stream_value_begin(self_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    if (self_p->depth == membersof(self_p->levels)) {
+        return (JSON_ERROR_NOMEM);
+    }
+
+    level_p = &self_p->levels[self_p->depth];
+    level_p->type = type;
+    level_p->selected = self_p->value.selected;
+    level_p->path_length = self_p->path.length;
+    level_p->index = 0;
+
+    if (level_p->selected) {
+        res = stream_emit(self_p,
+                          (type == JSON_OBJECT
+                           ? JSON_STREAM_EVENT_OBJECT_BEGIN
+                           : JSON_STREAM_EVENT_ARRAY_BEGIN),
+                          NULL,
+                          0);
+
+        if (res != 0) {
+            return (res);
+        }
+    }
+
+    self_p->depth++;
+
+    if (type == JSON_OBJECT) {
+        self_p->state = STREAM_STATE_KEY_OR_END;
+    } else {
+        self_p->state = STREAM_STATE_VALUE_OR_END;
+    }
+
+    return (0);
+}
+
+static int stream_container_end(struct json_stream_t *self_p,
+                                enum json_type_t type)
+{
+    struct json_stream_level_t *level_p;
+    int res;
+
+    level_p = &self_p->levels[self_p->depth - 1];
+
+    if (level_p->type != type) {
+        return (JSON_ERROR_INVAL);
+    }
+
+    stream_path_truncate(self_p, level_p->path_length);
+    self_p->depth--;
+
+    if (level_p->selected) {
+        res = stream_emit(self_p,
+                          (type == JSON_OBJECT
+                           ? JSON_STREAM_EVENT_OBJECT_END
+                           : JSON_STREAM_EVENT_ARRAY_END),
+                          NULL,
+                          0);
+
+        if (res != 0) {
+            return (res);
+        }
+    }
+
+    stream_value_end(self_p);
+
+    return (0);
+}
+
+static int stream_string_begin(struct json_stream_t *self_p, int is_key)
+{
+    int res;
+
+    self_p->is_key = is_key;
+    self_p->state = STREAM_STATE_STRING;
+
+    if (is_key) {
+        self_p->value.size = 0;
+        res = 0;
+    } else {
+        res = stream_value_begin(self_p);
+    }
+
+    /* Keys are always buffered as they are part of the path. */
+    self_p->buffered = (is_key || self_p->value.selected);
+
+    return (res);
+}
+
+static int stream_string_end(struct json_stream_t *self_p)
+{
+    int res;
+
+    res = 0;
+
+    if (self_p->is_key) {
+        stream_path_truncate(self_p,
+                             self_p->levels[self_p->depth - 1].path_length);
+        res = stream_path_append(self_p,
+                                 &self_p->value.buf[0],
+                                 self_p->value.size);
+        self_p->state = STREAM_STATE_COLON;
+    } else {
+        if (self_p->value.selected) {
+            res = stream_emit(self_p,
+                              JSON_STREAM_EVENT_STRING,
+                              &self_p->value.buf[0],
+                              self_p->value.size);
+        }
+
+        stream_value_end(self_p);
+    }
+
+    return (res);
+}
+
+/**
+ * Append given unicode code point as UTF-8.
+ */
+static int stream_string_append_unicode(struct json_stream_t *self_p,
+                                        uint16_t code)
+{
+    char buf[3];
+    size_t size;
+
+    if (code < 0x80) {
+        buf[0] = code;
+        size = 1;
+    } else if (code < 0x800) {
+        buf[0] = (0xc0 | (code >> 6));
+        buf[1] = (0x80 | (code & 0x3f));
+        size = 2;
+    } else {
+        buf[0] = (0xe0 | (code >> 12));
+        buf[1] = (0x80 | ((code >> 6) & 0x3f));
+        buf[2] = (0x80 | (code & 0x3f));
+        size = 3;
+    }
+
+    return (stream_value_append(self_p, &buf[0], size));
+}
+
+static int stream_string_escape(struct json_stream_t *self_p, char c)
+{
+    self_p->state = STREAM_STATE_STRING;
+
+    switch (c) {
+
+    case '\"':
+    case '/':
+    case '\\':
+        break;
+
+    case 'b':
+        c = '\b';
+        break;
+
+    case 'f':
+        c = '\f';
+        break;
+
+    case 'r':
+        c = '\r';
+        break;
+
+    case 'n':
+        c = '\n';
+        break;
+
+    case 't':
+        c = '\t';
+        break;
+
+    case 'u':
+        self_p->state = STREAM_STATE_STRING_UNICODE;
+        self_p->unicode.code = 0;
+        self_p->unicode.digits = 0;
+
+        return (0);
+
+    default:
+        return (JSON_ERROR_INVAL);
+    }
+
+    if (!self_p->buffered) {
+        return (0);
+    }
+
+    return (stream_value_append(self_p, &c, 1));
+}
+
+static int stream_string_unicode(struct json_stream_t *self_p, char c)
+{
+    int digit;
+
+    if ((c >= '0') && (c <= '9')) {
+        digit = (c - '0');
+    } else if ((c >= 'a') && (c <= 'f')) {
+        digit = (c - 'a' + 10);
+    } else if ((c >= 'A') && (c <= 'F')) {
+        digit = (c - 'A' + 10);
+    } else {
+        return (JSON_ERROR_INVAL);
+    }
+
+    self_p->unicode.code = ((self_p->unicode.code << 4) | digit);
+    self_p->unicode.digits++;
+
+    if (self_p->unicode.digits < 4) {
+        return (0);
+    }
+
+    self_p->state = STREAM_STATE_STRING;
+
+    if (!self_p->buffered) {
+        return (0);
+    }
+
+    return (stream_string_append_unicode(self_p, self_p->unicode.code));
+}
+
+/**
+ * Consume a run of plain string characters at once.
+ *
+ * @return Number of consumed characters or negative error code.
+ */
+static ssize_t stream_string_run(struct json_stream_t *self_p,
+                                 const char *buf_p,
+                                 size_t size)
+{
+    size_t i;
+    int res;
+
+    for (i = 0; i < size; i++) {
+        if ((buf_p[i] == '\"')
+            || (buf_p[i] == '\\')
+            || ((uint8_t)buf_p[i] < 0x20)) {
+            break;
+        }
+    }
+
+    if ((i > 0) && self_p->buffered) {
+        res = stream_value_append(self_p, buf_p, i);
+
+        if (res != 0) {
+            return (res);
+        }
+    }
+
+    return (i);
+}
+
+static int stream_primitive_begin(struct json_stream_t *self_p, char c)
+{
+    int res;
+
+    if (!(isdigit((int)c) || (c == '-') || (c == 't')
+          || (c == 'f') || (c == 'n'))) {
+        return (JSON_ERROR_INVAL);
+    }
+
+    res = stream_value_begin(self_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    self_p->state = STREAM_STATE_PRIMITIVE;
+
+    return (STREAM_RETRY);
+}
+
+static int stream_primitive(struct json_stream_t *self_p, char c)
+{
+    int res;
+
+    switch (c) {
+
+    case '\t':
+    case '\r':
+    case '\n':
+    case ' ':
+    case ',':
+    case ']':
+    case '}':
+        res = 0;
+
+        if (self_p->value.selected) {
+            res = stream_emit(self_p,
+                              JSON_STREAM_EVENT_PRIMITIVE,
+                              &self_p->value.buf[0],
+                              self_p->value.size);
+        }
+
+        if (res != 0) {
+            return (res);
+        }
+
+        stream_value_end(self_p);
+
+        return (STREAM_RETRY);
+
+    default:
+        break;
+    }
+
+    if (!(isalnum((int)c) || (c == '-') || (c == '+') || (c == '.'))) {
+        return (JSON_ERROR_INVAL);
+    }
+
+    if (!self_p->value.selected) {
+        return (0);
+    }
+
+    return (stream_value_append(self_p, &c, 1));
+}
+
+/**
+ * Process one character outside strings and primitives.
+ *
+ * @return zero(0) if the character was consumed, STREAM_RETRY if it
+ *         shall be processed again in the new state, or negative
+ *         error code.
+ */
+static int stream_structure(struct json_stream_t *self_p, char c)
+{
+    if ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n')) {
+        return (0);
+    }
+
+    switch (self_p->state) {
+
+    case STREAM_STATE_VALUE_OR_END:
+        if (c == ']') {
+            return (stream_container_end(self_p, JSON_ARRAY));
+        }
+
+        /* Fall through. */
+
+    case STREAM_STATE_VALUE:
+        switch (c) {
+
+        case '{':
+            return (stream_container_begin(self_p, JSON_OBJECT));
+
+        case '[':
+            return (stream_container_begin(self_p, JSON_ARRAY));
+
+        case '\"':
+            return (stream_string_begin(self_p, 0));
+
+        default:
+            return (stream_primitive_begin(self_p, c));
+        }
+
+    case STREAM_STATE_KEY_OR_END:
+        if (c == '}') {
+            return (stream_container_end(self_p, JSON_OBJECT));
+        }
+
+        /* Fall through. */
+
+    case STREAM_STATE_KEY:
+        if (c == '\"') {
+            return (stream_string_begin(self_p, 1));
+        }
+
+        break;
 
-                /* Unexpected symbol */
-            default:
-                self_p->pos = start;
+    case STREAM_STATE_COLON:
+        if (c == ':') {
+            self_p->state = STREAM_STATE_VALUE;
 
-                return (JSON_ERROR_INVAL);
-            }
+            return (0);
         }
-    }
 
-    self_p->pos = start;
+        break;
 
-    return (JSON_ERROR_PART);
-}
+    case STREAM_STATE_COMMA_OR_END:
+        switch (c) {
 
-/**
- * Recursively get the number of child tokens of given token.
- */
-static int get_number_of_children(struct json_tok_t *token_p)
-{
-    int i;
-    int number_of_children;
-    struct json_tok_t *child_p;
+        case ',':
+            if (self_p->levels[self_p->depth - 1].type == JSON_OBJECT) {
+                self_p->state = STREAM_STATE_KEY;
+            } else {
+                self_p->state = STREAM_STATE_VALUE;
+            }
 
-    number_of_children = 0;
+            return (0);
 
-    for (i = 0; i < token_p->num_tokens; i++) {
-        child_p = &token_p[number_of_children + 1 + i];
+        case '}':
+            return (stream_container_end(self_p, JSON_OBJECT));
 
-        if (child_p->num_tokens > 0) {
-            number_of_children += get_number_of_children(child_p);
+        case ']':
+            return (stream_container_end(self_p, JSON_ARRAY));
+
+        default:
+            break;
         }
-    }
 
-    number_of_children += token_p->num_tokens;
+        break;
 
-    return (number_of_children);
+    default:
+        break;
+    }
+
+    return (JSON_ERROR_INVAL);
 }
 
-static struct json_tok_t *object_get(struct json_t *self_p,
-                                     const char *key_p,
-                                     struct json_tok_t *object_p,
-                                     int type)
+/**
+ * Process one character.
+ */
+static int stream_char(struct json_stream_t *self_p, char c)
 {
-    ASSERTNRN(self_p != NULL, EINVAL);
-    ASSERTNRN(key_p != NULL, EINVAL);
+    switch (self_p->state) {
 
-    int i;
-    int key_length;
-    int number_of_children;
-    struct json_tok_t *token_p;
+    case STREAM_STATE_STRING:
+        if (c == '\"') {
+            return (stream_string_end(self_p));
+        } else if (c == '\\') {
+            self_p->state = STREAM_STATE_STRING_ESCAPE;
 
-    /* Return immediatly if no object is found. */
-    if (object_p == NULL) {
-        return (NULL);
-    }
+            return (0);
+        }
 
-    /* Check that the token is an object. */
-    if (object_p->type != JSON_OBJECT) {
-        return (NULL);
-    }
+        /* Control characters are not allowed in strings. */
+        return (JSON_ERROR_INVAL);
 
-    key_length = strlen(key_p);
+    case STREAM_STATE_STRING_ESCAPE:
+        return (stream_string_escape(self_p, c));
 
-    /* The first child token. */
-    token_p = (object_p + 1);
+    case STREAM_STATE_STRING_UNICODE:
+        return (stream_string_unicode(self_p, c));
 
-    /* Find given key in the object. */
-    for (i = 0; i < object_p->num_tokens; i++) {
-        if (token_p->type == type) {
-            if (strncmp(key_p, token_p->buf_p, key_length) == 0) {
-                return (token_p + 1);
-            }
+    case STREAM_STATE_PRIMITIVE:
+        return (stream_primitive(self_p, c));
+
+    case STREAM_STATE_DONE:
+        if ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n')) {
+            return (0);
         }
 
-        /* Get the next child token. */
-        number_of_children = get_number_of_children(token_p);
-        token_p += (number_of_children + 1);
+        return (JSON_ERROR_INVAL);
+
+    default:
+        return (stream_structure(self_p, c));
     }
+}
 
-    return (NULL);
+static ssize_t stream_write(void *self_p, const void *buf_p, size_t size)
+{
+    return (json_stream_feed(self_p, buf_p, size));
+}
+
+static void stream_reset(struct json_stream_t *self_p)
+{
+    self_p->state = STREAM_STATE_VALUE;
+    self_p->res = 0;
+    self_p->depth = 0;
+    self_p->value.size = 0;
+    stream_path_truncate(self_p, 0);
 }
 
 int json_init(struct json_t *self_p,
@@ -544,6 +1544,7 @@ int json_init(struct json_t *self_p,
     self_p->toksuper = -1;
     self_p->tokens_p = tokens_p;
     self_p->num_tokens = num_tokens;
+    self_p->index.sizes_p = NULL;
 
     return (0);
 }
@@ -561,6 +1562,8 @@ int json_parse(struct json_t *self_p,
     struct json_tok_t *token_p;
     int count;
 
+    /* The index is invalidated by new tokens. */
+    self_p->index.sizes_p = NULL;
     count = self_p->toknext;
 
     for (; ((self_p->pos < len)
@@ -783,19 +1786,10 @@ ssize_t json_dumps(struct json_t *self_p,
     ASSERTN(js_p != NULL, EINVAL);
 
     ssize_t res;
-    struct string_t string;
-
-    chan_init(&string.base, chan_read_null, string_write, chan_size_null);
-    string.buf_p = js_p;
-    string.pos = 0;
 
-    res = json_dump(self_p, tokens_p, &string);
-
-    if (res < 0) {
-        return (res);
-    }
+    res = json_dumpb(self_p, tokens_p, js_p, SIZE_MAX);
 
-    return (chan_write(&string, "\0", 1) == 1 ? res : -1);
+    return (res < 0 ? -1 : res);
 }
 
 ssize_t json_dump(struct json_t *self_p,
@@ -805,23 +1799,216 @@ ssize_t json_dump(struct json_t *self_p,
     ASSERTN(self_p != NULL, EINVAL);
     ASSERTN(out_p != NULL, EINVAL);
 
-    struct dump_t state;
+    struct serialize_t state;
+    int res;
 
-    if (tokens_p == NULL) {
-        tokens_p = self_p->tokens_p;
+    res = serialize_init(&state, self_p, tokens_p);
+
+    if (res == 0) {
+        state.chan_p = out_p;
+        res = serialize(&state);
     }
 
-    /* The first token must be an object or an array. */
-    if (!((tokens_p->type == JSON_OBJECT)
-          || (tokens_p->type == JSON_ARRAY))) {
-        return (-1);
+    return (res == 0 ? (ssize_t)state.pos : -1);
+}
+
+ssize_t json_dump_size(struct json_t *self_p,
+                       struct json_tok_t *tokens_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    struct serialize_t state;
+    int res;
+
+    res = serialize_init(&state, self_p, tokens_p);
+
+    if (res == 0) {
+        res = serialize(&state);
+    }
+
+    return (res == 0 ? (ssize_t)state.pos : res);
+}
+
+ssize_t json_dumpb(struct json_t *self_p,
+                   struct json_tok_t *tokens_p,
+                   char *buf_p,
+                   size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    struct serialize_t state;
+    int res;
+
+    res = serialize_init(&state, self_p, tokens_p);
+
+    if (res == 0) {
+        state.buf_p = buf_p;
+        state.size = size;
+        res = serialize(&state);
+    }
+
+    if (res == 0) {
+        res = serialize_write(&state, "", 1);
+    }
+
+    return (res == 0 ? (ssize_t)(state.pos - 1) : res);
+}
+
+int json_dumpv(struct json_t *self_p,
+               struct json_tok_t *tokens_p,
+               struct iov_t *iov_p,
+               int length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(iov_p != NULL, EINVAL);
+    ASSERTN(length >= 0, EINVAL);
+
+    struct serialize_t state;
+    int res;
+
+    res = serialize_init(&state, self_p, tokens_p);
+
+    if (res == 0) {
+        state.iov_p = iov_p;
+        state.iov_length = length;
+        res = serialize(&state);
+    }
+
+    return (res == 0 ? state.iov_pos : res);
+}
+
+ssize_t json_schema_dump_size(const struct json_field_t *fields_p,
+                              int length,
+                              const void *value_p)
+{
+    ASSERTN((fields_p != NULL) || (length == 0), EINVAL);
+    ASSERTN(value_p != NULL, EINVAL);
+
+    struct serialize_t state;
+    int res;
+
+    memset(&state, 0, sizeof(state));
+    res = serialize_schema(&state, fields_p, length, value_p);
+
+    return (res == 0 ? (ssize_t)state.pos : res);
+}
+
+ssize_t json_schema_dumpb(const struct json_field_t *fields_p,
+                          int length,
+                          const void *value_p,
+                          char *buf_p,
+                          size_t size)
+{
+    ASSERTN((fields_p != NULL) || (length == 0), EINVAL);
+    ASSERTN(value_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    struct serialize_t state;
+    int res;
+
+    memset(&state, 0, sizeof(state));
+    state.buf_p = buf_p;
+    state.size = size;
+    res = serialize_schema(&state, fields_p, length, value_p);
+
+    if (res == 0) {
+        res = serialize_write(&state, "", 1);
+    }
+
+    return (res == 0 ? (ssize_t)(state.pos - 1) : res);
+}
+
+int json_index(struct json_t *self_p, void *buf_p, size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((buf_p != NULL) || (size == 0), EINVAL);
+
+    struct json_tok_t *token_p;
+    int *sizes_p;
+    int *slots_p;
+    int num_tokens;
+    int num_children;
+    int children;
+    int bucket;
+    int i;
+    int j;
+    int k;
+
+    num_tokens = self_p->toknext;
+    self_p->index.sizes_p = NULL;
+
+    if (size < JSON_INDEX_BUFFER_SIZE(num_tokens)) {
+        return (JSON_ERROR_NOMEM);
+    }
+
+    sizes_p = buf_p;
+    slots_p = &sizes_p[num_tokens];
+    self_p->index.slots_p = slots_p;
+    self_p->index.children_p = &slots_p[num_tokens];
+    self_p->index.buckets_p = &slots_p[2 * num_tokens];
+    self_p->index.num_buckets = MAX(2 * num_tokens, 1);
+    memset(self_p->index.buckets_p,
+           0,
+           self_p->index.num_buckets * sizeof(int));
+
+    /* Subtree sizes. Children follow their parent, so a backwards
+       pass sees all children before the parent. */
+    for (i = num_tokens - 1; i >= 0; i--) {
+        sizes_p[i] = 1;
+        j = (i + 1);
+
+        for (k = 0; k < self_p->tokens_p[i].num_tokens; k++) {
+            if (j >= num_tokens) {
+                return (JSON_ERROR_INVAL);
+            }
+
+            sizes_p[i] += sizes_p[j];
+            j += sizes_p[j];
+        }
+    }
+
+    /* Array children tables and object key hash tables. */
+    children = 0;
+
+    for (i = 0; i < num_tokens; i++) {
+        token_p = &self_p->tokens_p[i];
+        num_children = MAX(token_p->num_tokens, 0);
+
+        if (token_p->type == JSON_ARRAY) {
+            slots_p[i] = children;
+        }
+
+        j = (i + 1);
+
+        for (k = 0; k < num_children; k++) {
+            if (token_p->type == JSON_ARRAY) {
+                self_p->index.children_p[children++] = j;
+            } else if (token_p->type == JSON_OBJECT) {
+                slots_p[j] = i;
+                bucket = (index_hash(i,
+                                     self_p->tokens_p[j].buf_p,
+                                     self_p->tokens_p[j].size)
+                          % self_p->index.num_buckets);
+
+                while (self_p->index.buckets_p[bucket] != 0) {
+                    bucket++;
+
+                    if (bucket == self_p->index.num_buckets) {
+                        bucket = 0;
+                    }
+                }
+
+                self_p->index.buckets_p[bucket] = (j + 1);
+            }
+
+            j += sizes_p[j];
+        }
     }
 
-    state.tokens_p = tokens_p;
-    state.num_tokens = self_p->num_tokens;
-    state.out_p = out_p;
+    self_p->index.sizes_p = sizes_p;
 
-    return (dump(&state));
+    return (0);
 }
 
 struct json_tok_t *json_root(struct json_t *self_p)
@@ -864,6 +2051,16 @@ struct json_tok_t *json_array_get(struct json_t *self_p,
         return (NULL);
     }
 
+    if (is_indexed(self_p, array_p)) {
+        if (index >= array_p->num_tokens) {
+            return (NULL);
+        }
+
+        i = self_p->index.slots_p[array_p - self_p->tokens_p];
+
+        return (&self_p->tokens_p[self_p->index.children_p[i + index]]);
+    }
+
     /* The first child token. */
     token_p = (array_p + 1);
 
@@ -942,3 +2139,139 @@ void json_token_string(struct json_tok_t *token_p,
     token_p->size = size;
     token_p->num_tokens = -1;
 }
+
+int json_stream_init(struct json_stream_t *self_p,
+                     const char **selectors_pp,
+                     json_stream_callback_t callback,
+                     void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(callback != NULL, EINVAL);
+
+    chan_init(&self_p->base,
+              chan_read_null,
+              stream_write,
+              chan_size_null);
+    self_p->selectors_pp = selectors_pp;
+    self_p->callback = callback;
+    self_p->arg_p = arg_p;
+    stream_reset(self_p);
+
+    return (0);
+}
+
+ssize_t json_stream_feed(struct json_stream_t *self_p,
+                         const void *buf_p,
+                         size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    const char *b_p;
+    ssize_t res;
+    size_t i;
+
+    if (self_p->state == STREAM_STATE_ERROR) {
+        return (self_p->res);
+    }
+
+    b_p = buf_p;
+    i = 0;
+    res = 0;
+
+    while (i < size) {
+        if (self_p->state == STREAM_STATE_STRING) {
+            res = stream_string_run(self_p, &b_p[i], size - i);
+
+            if (res < 0) {
+                break;
+            }
+
+            i += res;
+
+            if (i == size) {
+                break;
+            }
+        }
+
+        res = stream_char(self_p, b_p[i]);
+
+        if (res < 0) {
+            break;
+        }
+
+        if (res != STREAM_RETRY) {
+            i++;
+        }
+    }
+
+    if (res < 0) {
+        self_p->state = STREAM_STATE_ERROR;
+        self_p->res = res;
+
+        return (res);
+    }
+
+    return (size);
+}
+
+int json_stream_read(struct json_stream_t *self_p,
+                     void *chin_p,
+                     size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chin_p != NULL, EINVAL);
+
+    char buf[STREAM_READ_CHUNK_SIZE];
+    size_t n;
+    ssize_t res;
+
+    while (size > 0) {
+        n = MIN(size, sizeof(buf));
+
+        if (chan_read(chin_p, &buf[0], n) != n) {
+            return (-EIO);
+        }
+
+        res = json_stream_feed(self_p, &buf[0], n);
+
+        if (res < 0) {
+            return (res);
+        }
+
+        size -= n;
+    }
+
+    return (0);
+}
+
+int json_stream_finish(struct json_stream_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    /* A root primitive is terminated by the end of the input. */
+    if ((self_p->state == STREAM_STATE_PRIMITIVE) && (self_p->depth == 0)) {
+        (void)json_stream_feed(self_p, " ", 1);
+    }
+
+    switch (self_p->state) {
+
+    case STREAM_STATE_DONE:
+        res = 0;
+        break;
+
+    case STREAM_STATE_ERROR:
+        res = self_p->res;
+        break;
+
+    default:
+        res = JSON_ERROR_PART;
+        break;
+    }
+
+    stream_reset(self_p);
+
+    return (res);
+}
@@ -90,6 +90,115 @@ enum json_err_t {
     JSON_ERROR_PART = -3
 };
 
+/**
+ * C struct member type in a serializer schema.
+ */
+enum json_field_type_t {
+    /** ``int32_t``. */
+    JSON_FIELD_TYPE_INT32 = 0,
+
+    /** ``uint32_t``. */
+    JSON_FIELD_TYPE_UINT32,
+
+    /** ``int``, dumped as ``true`` or ``false``. */
+    JSON_FIELD_TYPE_BOOL,
+
+    /** ``const char *``, dumped as a string or ``null``. Quotes,
+        backslashes and control characters are escaped. */
+    JSON_FIELD_TYPE_STRING,
+
+    /** ``float`` with six decimals, only available if
+        ``CONFIG_FLOAT`` is one. Non-finite values and values with a
+        magnitude of 2^32 or more are rejected. */
+    JSON_FIELD_TYPE_FLOAT
+};
+
+/**
+ * Serializer schema entry, one per C struct member. Create entries
+ * with the ``JSON_FIELD_*()`` macros.
+ */
+struct json_field_t {
+    /** Quoted key followed by a colon. */
+    const char *key_p;
+    uint8_t key_size;
+    uint8_t type;
+    uint16_t offset;
+};
+
+/**
+ * Schema entry of given type for given struct member. The quoted key
+ * is created at compile time.
+ */
+#define JSON_FIELD(type_, struct_, member)                              \
+    {                                                                   \
+        .key_p = "\"" #member "\":",                                    \
+        .key_size = (sizeof("\"" #member "\":") - 1),                   \
+        .type = (type_),                                                \
+        .offset = offsetof(struct_, member)                             \
+    }
+
+#define JSON_FIELD_INT32(struct_, member)                       \
+    JSON_FIELD(JSON_FIELD_TYPE_INT32, struct_, member)
+#define JSON_FIELD_UINT32(struct_, member)                      \
+    JSON_FIELD(JSON_FIELD_TYPE_UINT32, struct_, member)
+#define JSON_FIELD_BOOL(struct_, member)                        \
+    JSON_FIELD(JSON_FIELD_TYPE_BOOL, struct_, member)
+#define JSON_FIELD_STRING(struct_, member)                      \
+    JSON_FIELD(JSON_FIELD_TYPE_STRING, struct_, member)
+#define JSON_FIELD_FLOAT(struct_, member)                       \
+    JSON_FIELD(JSON_FIELD_TYPE_FLOAT, struct_, member)
+
+/**
+ * Size in bytes of the buffer needed by `json_index()` for given
+ * number of tokens.
+ */
+#define JSON_INDEX_BUFFER_SIZE(num_tokens)      \
+    (5 * sizeof(int) * MAX((num_tokens), 1))
+
+/**
+ * Streaming parser event.
+ */
+enum json_stream_event_t {
+    /** Beginning of an object, ``{``. */
+    JSON_STREAM_EVENT_OBJECT_BEGIN = 0,
+
+    /** End of an object, ``}``. */
+    JSON_STREAM_EVENT_OBJECT_END,
+
+    /** Beginning of an array, ``[``. */
+    JSON_STREAM_EVENT_ARRAY_BEGIN,
+
+    /** End of an array, ``]``. */
+    JSON_STREAM_EVENT_ARRAY_END,
+
+    /** String value, with escape sequences decoded. */
+    JSON_STREAM_EVENT_STRING,
+
+    /** Primitive value; number, boolean (true/false) or null. */
+    JSON_STREAM_EVENT_PRIMITIVE
+};
+
+/**
+ * Streaming parser event callback.
+ *
+ * @param[in] arg_p Argument given to `json_stream_init()`.
+ * @param[in] event Event type.
+ * @param[in] path_p Null terminated path of the value, for example
+ *                   ``/sensors/2/name``. The root value has the empty
+ *                   path.
+ * @param[in] buf_p Value of string and primitive events, not null
+ *                  terminated. NULL for other events.
+ * @param[in] size Value size in bytes.
+ *
+ * @return zero(0) to continue parsing, or negative error code to
+ *         stop parsing with given error.
+ */
+typedef int (*json_stream_callback_t)(void *arg_p,
+                                      enum json_stream_event_t event,
+                                      const char *path_p,
+                                      const char *buf_p,
+                                      size_t size);
+
 /*
  * JSON token description.
  */
@@ -123,6 +232,51 @@ struct json_t {
     struct json_tok_t *tokens_p;
     /** Number of tokens in the tokens array. */
     int num_tokens;
+    /** Optional lookup index built by `json_index()`. */
+    struct {
+        int *sizes_p;
+        int *slots_p;
+        int *children_p;
+        int *buckets_p;
+        int num_buckets;
+    } index;
+};
+
+struct json_stream_level_t {
+    uint8_t type;
+    uint8_t selected;
+    uint16_t path_length;
+    int index;
+};
+
+/**
+ * Streaming JSON parser. Uses constant memory independent of the
+ * document size.
+ */
+struct json_stream_t {
+    struct chan_t base;
+    const char **selectors_pp;
+    json_stream_callback_t callback;
+    void *arg_p;
+    int8_t state;
+    int res;
+    uint8_t is_key;
+    uint8_t buffered;
+    uint8_t depth;
+    struct json_stream_level_t levels[CONFIG_JSON_STREAM_DEPTH_MAX];
+    struct {
+        char buf[CONFIG_JSON_STREAM_PATH_MAX];
+        size_t length;
+    } path;
+    struct {
+        char buf[CONFIG_JSON_STREAM_VALUE_MAX];
+        size_t size;
+        uint8_t selected;
+    } value;
+    struct {
+        uint16_t code;
+        uint8_t digits;
+    } unicode;
 };
 
  /**
@@ -158,6 +312,22 @@ int json_parse(struct json_t *self_p,
                const char *js_p,
                size_t len);
 
+/**
+ * Build a lookup index of the parsed tokens in given buffer. The
+ * index makes `json_object_get()`, `json_object_get_primitive()` and
+ * `json_array_get()` constant time operations, instead of linear in
+ * the size of the object or array. Keys are compared exactly in
+ * indexed lookups. The index is invalidated by `json_parse()`.
+ *
+ * @param[in] self_p JSON object with parsed tokens.
+ * @param[in] buf_p Index buffer.
+ * @param[in] size Index buffer size. At least
+ *                 ``JSON_INDEX_BUFFER_SIZE(number of tokens)`` bytes.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_index(struct json_t *self_p, void *buf_p, size_t size);
+
 /**
  * Format and write given JSON tokens into a string.
  *
@@ -188,6 +358,92 @@ ssize_t json_dump(struct json_t *self_p,
                   struct json_tok_t *tokens_p,
                   void *out_p);
 
+/**
+ * Calculate the exact length of the dumped JSON string of given
+ * tokens, not including termination. Use it to size the buffer given
+ * to `json_dumpb()`.
+ *
+ * @param[in] self_p JSON object.
+ * @param[in] tokens_p Root token. Set to NULL to use the whole
+ *                     object.
+ *
+ * @return Dumped string length or negative error code.
+ */
+ssize_t json_dump_size(struct json_t *self_p,
+                       struct json_tok_t *tokens_p);
+
+/**
+ * Format and write given JSON tokens into given buffer. Tokens are
+ * copied in bulk, one copy per token.
+ *
+ * @param[in] self_p JSON object.
+ * @param[in] tokens_p Root token to dump. Set to NULL to dump the
+ *                     whole object.
+ * @param[out] buf_p Dumped null terminated JSON string.
+ * @param[in] size Buffer size, including termination.
+ *
+ * @return Dumped string length (not including termination) or
+ *         negative error code. JSON_ERROR_NOMEM if the buffer is too
+ *         small.
+ */
+ssize_t json_dumpb(struct json_t *self_p,
+                   struct json_tok_t *tokens_p,
+                   char *buf_p,
+                   size_t size);
+
+/**
+ * Format given JSON tokens as a scatter/gather vector without copying
+ * any data. The vector entries refer to the token buffers and
+ * static punctuation strings. The string is not null terminated.
+ *
+ * @param[in] self_p JSON object.
+ * @param[in] tokens_p Root token to dump. Set to NULL to dump the
+ *                     whole object.
+ * @param[out] iov_p Vector to fill.
+ * @param[in] length Vector length.
+ *
+ * @return Number of used vector entries or negative error
+ *         code. JSON_ERROR_NOMEM if the vector is too short.
+ */
+int json_dumpv(struct json_t *self_p,
+               struct json_tok_t *tokens_p,
+               struct iov_t *iov_p,
+               int length);
+
+/**
+ * Calculate the exact length of given C struct dumped as a JSON
+ * object using given schema, not including termination.
+ *
+ * @param[in] fields_p Schema, one entry per struct member to dump.
+ * @param[in] length Number of schema entries.
+ * @param[in] value_p Struct to dump.
+ *
+ * @return Dumped string length or negative error code.
+ */
+ssize_t json_schema_dump_size(const struct json_field_t *fields_p,
+                              int length,
+                              const void *value_p);
+
+/**
+ * Dump given C struct as a JSON object into given buffer using given
+ * schema. No tokens are needed.
+ *
+ * @param[in] fields_p Schema, one entry per struct member to dump.
+ * @param[in] length Number of schema entries.
+ * @param[in] value_p Struct to dump.
+ * @param[out] buf_p Dumped null terminated JSON string.
+ * @param[in] size Buffer size, including termination.
+ *
+ * @return Dumped string length (not including termination) or
+ *         negative error code. JSON_ERROR_NOMEM if the buffer is too
+ *         small.
+ */
+ssize_t json_schema_dumpb(const struct json_field_t *fields_p,
+                          int length,
+                          const void *value_p,
+                          char *buf_p,
+                          size_t size);
+
 /**
  * Get the root token.
  *
@@ -297,4 +553,71 @@ void json_token_string(struct json_tok_t *token_p,
                        const char *buf_p,
                        size_t size);
 
+/**
+ * Initialize given streaming parser. The parser calls given callback
+ * for each value in the document, as soon as the value has been
+ * parsed. Only values in the selected subtrees are reported, and
+ * only their strings and primitives are buffered.
+ *
+ * The parser is also a channel; data written to it with
+ * `chan_write()` is parsed.
+ *
+ * @param[out] self_p Parser to initialize.
+ * @param[in] selectors_pp NULL terminated array of paths to report,
+ *                         for example ``{ "/name", "/sensors", NULL
+ *                         }``. A selected object or array is reported
+ *                         including all its children. Give NULL to
+ *                         report the whole document.
+ * @param[in] callback Event callback.
+ * @param[in] arg_p Callback argument.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_stream_init(struct json_stream_t *self_p,
+                     const char **selectors_pp,
+                     json_stream_callback_t callback,
+                     void *arg_p);
+
+/**
+ * Parse given chunk of the document. The document may be split at
+ * any position.
+ *
+ * @param[in] self_p Initialized parser.
+ * @param[in] buf_p Document chunk.
+ * @param[in] size Chunk size in bytes.
+ *
+ * @return Number of consumed bytes or negative error code. The
+ *         error is JSON_ERROR_NOMEM if the document is nested deeper
+ *         than ``CONFIG_JSON_STREAM_DEPTH_MAX``, or if a path or a
+ *         selected value does not fit in the parser buffers.
+ */
+ssize_t json_stream_feed(struct json_stream_t *self_p,
+                         const void *buf_p,
+                         size_t size);
+
+/**
+ * Read given number of bytes from given channel and parse them, a
+ * small chunk at a time.
+ *
+ * @param[in] self_p Initialized parser.
+ * @param[in] chin_p Input channel.
+ * @param[in] size Number of bytes to read.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_stream_read(struct json_stream_t *self_p,
+                     void *chin_p,
+                     size_t size);
+
+/**
+ * End the document. The parser is ready to parse a new document
+ * afterwards.
+ *
+ * @param[in] self_p Initialized parser.
+ *
+ * @return zero(0) if a complete document was parsed, JSON_ERROR_PART
+ *         if the document is incomplete, or the parse error.
+ */
+int json_stream_finish(struct json_stream_t *self_p);
+
 #endif
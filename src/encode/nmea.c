@@ -28,20 +28,176 @@
 
 #include "simba.h"
 
-static uint8_t calculate_crc(char *buf_p, size_t size)
+/* True if any byte in given word is zero. */
+#define HAS_ZERO_BYTE(word)                             \
+    (((word) - 0x01010101u) & ~(word) & 0x80808080u)
+
+/**
+ * XOR all bytes in given buffer, four bytes at a time.
+ */
+static uint8_t calculate_crc(const char *buf_p, size_t size)
 {
     size_t i;
+    uint32_t word;
+    uint32_t words;
     uint8_t crc;
 
-    crc = 0;
+    words = 0;
+
+    for (i = 0; i + sizeof(word) <= size; i += sizeof(word)) {
+        memcpy(&word, &buf_p[i], sizeof(word));
+        words ^= word;
+    }
+
+    crc = (words ^ (words >> 8) ^ (words >> 16) ^ (words >> 24));
 
-    for (i = 0; i < size; i++) {
+    for (; i < size; i++) {
         crc ^= buf_p[i];
     }
 
     return (crc);
 }
 
+/**
+ * Find the first occurrence of any of given two characters, four
+ * bytes at a time.
+ *
+ * @return Offset of the found character, or size if not found.
+ */
+static size_t find_either(const char *buf_p,
+                          size_t size,
+                          char c0,
+                          char c1)
+{
+    size_t i;
+    uint32_t word;
+    uint32_t pattern0;
+    uint32_t pattern1;
+
+    pattern0 = (0x01010101u * (uint8_t)c0);
+    pattern1 = (0x01010101u * (uint8_t)c1);
+
+    for (i = 0; i + sizeof(word) <= size; i += sizeof(word)) {
+        memcpy(&word, &buf_p[i], sizeof(word));
+
+        if (HAS_ZERO_BYTE(word ^ pattern0) | HAS_ZERO_BYTE(word ^ pattern1)) {
+            break;
+        }
+    }
+
+    for (; i < size; i++) {
+        if ((buf_p[i] == c0) || (buf_p[i] == c1)) {
+            break;
+        }
+    }
+
+    return (i);
+}
+
+/**
+ * @return Value of given hexadecimal digit, or -1 if invalid.
+ */
+static int hex_digit_value(char c)
+{
+    if ((c >= '0') && (c <= '9')) {
+        return (c - '0');
+    } else if ((c >= 'A') && (c <= 'F')) {
+        return (c - 'A' + 10);
+    } else if ((c >= 'a') && (c <= 'f')) {
+        return (c - 'a' + 10);
+    }
+
+    return (-1);
+}
+
+/**
+ * Validate given complete sentence and find its fields. The sentence
+ * is not modified.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int frame_sentence(struct nmea_frame_t *frame_p,
+                          const char *buf_p,
+                          size_t size)
+{
+    int high;
+    int low;
+    size_t pos;
+    size_t end;
+    size_t j;
+    uint32_t word;
+    uint32_t words;
+    uint8_t crc;
+    int i;
+
+    /* Shortest sentence is "$A*00\r\n". */
+    if ((size < 7)
+        || (size > NMEA_SENTENCE_SIZE_MAX)
+        || (buf_p[0] != '$')
+        || (buf_p[size - 5] != '*')
+        || (buf_p[size - 2] != '\r')
+        || (buf_p[size - 1] != '\n')) {
+        return (-EPROTO);
+    }
+
+    high = hex_digit_value(buf_p[size - 4]);
+    low = hex_digit_value(buf_p[size - 3]);
+
+    if ((high < 0) || (low < 0)) {
+        return (-EPROTO);
+    }
+
+    /* Checksum the sentence and find the field separators in one
+       pass, four bytes at a time. Field i spans from offsets[i] to
+       the separator before offsets[i + 1]. */
+    end = (size - 5);
+    frame_p->offsets[0] = 1;
+    i = 1;
+    words = 0;
+
+    for (pos = 1; pos + sizeof(word) <= end; pos += sizeof(word)) {
+        memcpy(&word, &buf_p[pos], sizeof(word));
+        words ^= word;
+
+        if (HAS_ZERO_BYTE(word ^ 0x2c2c2c2cu)) {
+            for (j = pos; j < pos + sizeof(word); j++) {
+                if (buf_p[j] == ',') {
+                    if (i == NMEA_FIELDS_MAX) {
+                        return (-EPROTO);
+                    }
+
+                    frame_p->offsets[i++] = (j + 1);
+                }
+            }
+        }
+    }
+
+    crc = (words ^ (words >> 8) ^ (words >> 16) ^ (words >> 24));
+
+    for (; pos < end; pos++) {
+        crc ^= buf_p[pos];
+
+        if (buf_p[pos] == ',') {
+            if (i == NMEA_FIELDS_MAX) {
+                return (-EPROTO);
+            }
+
+            frame_p->offsets[i++] = (pos + 1);
+        }
+    }
+
+    if (crc != ((high << 4) | low)) {
+        return (-EPROTO);
+    }
+
+    frame_p->offsets[i] = (end + 1);
+    frame_p->number_of_fields = i;
+    frame_p->buf_p = buf_p;
+    frame_p->size = size;
+
+    return (0);
+}
+
 static int decode_triple(char *src_p,
                          int *v0_p,
                          int *v1_p,
@@ -672,3 +828,178 @@ int nmea_decode_position(struct nmea_position_t *src_p,
 
     return (0);
 }
+
+int nmea_framer_init(struct nmea_framer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->size = 0;
+    self_p->number_of_errors = 0;
+
+    return (0);
+}
+
+ssize_t nmea_framer_input(struct nmea_framer_t *self_p,
+                          const char *buf_p,
+                          size_t size,
+                          struct nmea_frame_t *frame_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((buf_p != NULL) || (size == 0), EINVAL);
+    ASSERTN(frame_p != NULL, EINVAL);
+
+    size_t begin;
+    size_t end;
+    size_t left;
+
+    frame_p->buf_p = NULL;
+    frame_p->size = 0;
+
+    if (self_p->size == 0) {
+        /* Find the start of a sentence. */
+        begin = find_either(buf_p, size, '$', '$');
+
+        if (begin == size) {
+            return (size);
+        }
+
+        /* Find its end, or the start of the next sentence. */
+        left = MIN(size - begin - 1, NMEA_SENTENCE_SIZE_MAX - 1);
+        end = (begin + 1 + find_either(&buf_p[begin + 1], left, '\n', '$'));
+
+        if ((end < size) && (buf_p[end] == '\n')) {
+            /* A complete sentence in the input; no copy needed. */
+            if (frame_sentence(frame_p, &buf_p[begin], end - begin + 1) != 0) {
+                self_p->number_of_errors++;
+            }
+
+            return (end + 1);
+        } else if ((end < size) || (left == NMEA_SENTENCE_SIZE_MAX - 1)) {
+            /* Restarted or too long sentence. */
+            self_p->number_of_errors++;
+
+            return (end);
+        }
+
+        /* Save the beginning of the sentence for the next call. */
+        self_p->size = (size - begin);
+        memcpy(&self_p->buf[0], &buf_p[begin], self_p->size);
+
+        return (size);
+    }
+
+    /* Continue a sentence started in an earlier call. */
+    left = MIN(size, NMEA_SENTENCE_SIZE_MAX - self_p->size);
+    end = find_either(buf_p, left, '\n', '$');
+
+    if ((end < left) && (buf_p[end] == '\n')) {
+        memcpy(&self_p->buf[self_p->size], buf_p, end + 1);
+
+        if (frame_sentence(frame_p,
+                           &self_p->buf[0],
+                           self_p->size + end + 1) != 0) {
+            self_p->number_of_errors++;
+        }
+
+        self_p->size = 0;
+
+        return (end + 1);
+    } else if ((end < left) || (left < size)) {
+        /* Restarted or too long sentence. */
+        self_p->number_of_errors++;
+        self_p->size = 0;
+
+        return (end);
+    }
+
+    memcpy(&self_p->buf[self_p->size], buf_p, size);
+    self_p->size += size;
+
+    return (size);
+}
+
+int nmea_decode_frames(struct nmea_frame_t *frames_p,
+                       int length,
+                       const char *src_p,
+                       size_t size)
+{
+    ASSERTN(frames_p != NULL, EINVAL);
+    ASSERTN((src_p != NULL) || (size == 0), EINVAL);
+
+    struct nmea_framer_t framer;
+    ssize_t res;
+    int number_of_frames;
+
+    framer.size = 0;
+    framer.number_of_errors = 0;
+    number_of_frames = 0;
+
+    /* Sentences are complete in the input, so the framer never
+       copies one to its own buffer. */
+    while ((size > 0) && (number_of_frames < length)) {
+        res = nmea_framer_input(&framer,
+                                src_p,
+                                size,
+                                &frames_p[number_of_frames]);
+
+        if (res < 0) {
+            return (res);
+        }
+
+        if (frames_p[number_of_frames].size > 0) {
+            number_of_frames++;
+        }
+
+        src_p += res;
+        size -= res;
+    }
+
+    return (number_of_frames);
+}
+
+int nmea_frame_get_field(struct nmea_frame_t *self_p,
+                         int index,
+                         struct nmea_field_t *field_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(field_p != NULL, EINVAL);
+
+    if ((index < 0) || (index >= self_p->number_of_fields)) {
+        return (-EINVAL);
+    }
+
+    field_p->buf_p = &self_p->buf_p[self_p->offsets[index]];
+    field_p->size = (self_p->offsets[index + 1] - self_p->offsets[index] - 1);
+
+    return (0);
+}
+
+enum nmea_sentence_type_t nmea_frame_get_type(struct nmea_frame_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    const char *address_p;
+
+    /* The address field is a talker id and a sentence formatter. */
+    if (self_p->offsets[1] - self_p->offsets[0] != 6) {
+        return (nmea_sentence_type_raw_t);
+    }
+
+    address_p = &self_p->buf_p[self_p->offsets[0] + 2];
+
+    if (memcmp(address_p, "GGA", 3) == 0) {
+        return (nmea_sentence_type_gga_t);
+    } else if (memcmp(address_p, "GLL", 3) == 0) {
+        return (nmea_sentence_type_gll_t);
+    } else if (memcmp(address_p, "GSA", 3) == 0) {
+        return (nmea_sentence_type_gsa_t);
+    } else if (memcmp(address_p, "GSV", 3) == 0) {
+        return (nmea_sentence_type_gsv_t);
+    } else if (memcmp(address_p, "RMC", 3) == 0) {
+        return (nmea_sentence_type_rmc_t);
+    } else if (memcmp(address_p, "VTG", 3) == 0) {
+        return (nmea_sentence_type_vtg_t);
+    }
+
+    return (nmea_sentence_type_raw_t);
+}
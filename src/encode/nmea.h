@@ -33,6 +33,10 @@
 
 #define NMEA_SENTENCE_SIZE_MAX                       (80 + 3)
 
+/** Maximum number of fields in a framed sentence, including the
+    address field. */
+#define NMEA_FIELDS_MAX                              40
+
 #define NMEA_KNOTS_TO_METERS_PER_SECOND(knots) \
     DIV_ROUND((51444L * knots), 100000L)
 
@@ -163,6 +167,37 @@ struct nmea_sentence_t {
     };
 };
 
+/**
+ * A field in a framed sentence. It is not null-terminated.
+ */
+struct nmea_field_t {
+    const char *buf_p;
+    size_t size;
+};
+
+/**
+ * A validated sentence found by the framer. The sentence is not
+ * modified, its fields are found with `nmea_frame_get_field()`.
+ */
+struct nmea_frame_t {
+    /* The sentence, starting with a dollar sign and ending with
+       <CR><LF>. NULL if no sentence was found. */
+    const char *buf_p;
+    size_t size;
+    int number_of_fields;
+    uint8_t offsets[NMEA_FIELDS_MAX + 1];
+};
+
+/**
+ * Finds sentences in a stream of data, for example read from an UART
+ * or a TCP socket.
+ */
+struct nmea_framer_t {
+    size_t size;
+    char buf[NMEA_SENTENCE_SIZE_MAX];
+    uint32_t number_of_errors;
+};
+
 /**
  * Encode given NMEA sentence into given buffer.
  *
@@ -242,4 +277,79 @@ int nmea_decode_date(char *src_p,
 int nmea_decode_position(struct nmea_position_t *src_p,
                          long *degrees_p);
 
+/**
+ * Initialize given framer.
+ *
+ * @param[out] self_p Framer to initialize.
+ *
+ * @return zero(0) or negative error code.
+ */
+int nmea_framer_init(struct nmea_framer_t *self_p);
+
+/**
+ * Find the next sentence in given input data. Call repeatedly with
+ * the rest of the input until all data has been consumed.
+ *
+ * Sentences completely within given input are not copied and the
+ * frame refers to the input. Sentences split over several calls are
+ * assembled in the framer, and the frame refers to the framer's
+ * buffer, which is valid until the next call.
+ *
+ * Data outside sentences is discarded. Sentences with a bad checksum
+ * or format are discarded and counted in ``number_of_errors``.
+ *
+ * @param[in] self_p Framer.
+ * @param[in] buf_p Input data.
+ * @param[in] size Number of bytes in the input data.
+ * @param[out] frame_p Found sentence. ``buf_p`` is NULL if no
+ *                     sentence was found.
+ *
+ * @return Number of consumed input bytes or negative error code.
+ */
+ssize_t nmea_framer_input(struct nmea_framer_t *self_p,
+                          const char *buf_p,
+                          size_t size,
+                          struct nmea_frame_t *frame_p);
+
+/**
+ * Find all sentences in given buffer in one call. Sentences with a
+ * bad checksum or format, and an incomplete last sentence, are
+ * skipped. The frames refer to given buffer, which is not modified.
+ *
+ * @param[out] frames_p Found sentences.
+ * @param[in] length Number of frames in the frames array.
+ * @param[in] src_p Sentences to decode.
+ * @param[in] size Number of bytes to decode.
+ *
+ * @return Number of found sentences or negative error code.
+ */
+int nmea_decode_frames(struct nmea_frame_t *frames_p,
+                       int length,
+                       const char *src_p,
+                       size_t size);
+
+/**
+ * Get given field in given frame. Field 0 is the address field, for
+ * example ``GPGGA``.
+ *
+ * @param[in] self_p Frame.
+ * @param[in] index Field index.
+ * @param[out] field_p Field.
+ *
+ * @return zero(0) or negative error code.
+ */
+int nmea_frame_get_field(struct nmea_frame_t *self_p,
+                         int index,
+                         struct nmea_field_t *field_p);
+
+/**
+ * Get the type of given frame from its address field.
+ *
+ * @param[in] self_p Frame.
+ *
+ * @return Sentence type. ``nmea_sentence_type_raw_t`` for unknown
+ *         sentences.
+ */
+enum nmea_sentence_type_t nmea_frame_get_type(struct nmea_frame_t *self_p);
+
 #endif
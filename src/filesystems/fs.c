@@ -31,6 +31,23 @@
 
 #define FS_NAME_MAX                                          64
 
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+
+/**
+ * A cached path lookup. A negative entry records that given path does
+ * not exist.
+ */
+struct dentry_t {
+    uint32_t hash;
+    uint32_t last_used;
+    struct fs_filesystem_t *filesystem_p;
+    int exists;
+    struct fs_stat_t stat;
+    char path[CONFIG_FS_PATH_MAX];
+};
+
+#endif
+
 struct module_t {
     int8_t initialized;
     struct fs_command_t *commands_p;
@@ -67,6 +84,15 @@ struct module_t {
 #if CONFIG_FS_FS_COMMAND_PARAMETERS_LIST == 1
     struct fs_command_t cmd_parameters_list;
 #endif
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+    struct {
+        struct mutex_t mutex;
+        uint32_t tick;
+        struct dentry_t entries[CONFIG_FS_DENTRY_CACHE_SIZE];
+        struct fs_counter_t hits;
+        struct fs_counter_t misses;
+    } dentry_cache;
+#endif
 };
 
 static struct module_t module;
@@ -647,6 +673,24 @@ int fs_module_init()
     fs_command_register(&module.cmd_parameters_list);
 #endif
 
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+    mutex_init(&module.dentry_cache.mutex);
+    module.dentry_cache.tick = 0;
+    memset(&module.dentry_cache.entries[0],
+           0,
+           sizeof(module.dentry_cache.entries));
+
+    fs_counter_init(&module.dentry_cache.hits,
+                    FSTR("/filesystems/fs/dentry_cache/hits"),
+                    0);
+    fs_counter_register(&module.dentry_cache.hits);
+
+    fs_counter_init(&module.dentry_cache.misses,
+                    FSTR("/filesystems/fs/dentry_cache/misses"),
+                    0);
+    fs_counter_register(&module.dentry_cache.misses);
+#endif
+
     return (0);
 }
 
@@ -690,52 +734,237 @@ int fs_call(char *command_p,
 }
 
 /**
- * Find the file system for given path.
+ * Get the path within given file system of given absolute path.
+ *
+ * @return zero(0) if the path is in given file system, otherwise
+ *         -1.
  */
-static int get_filesystem_path_from_path(struct fs_filesystem_t **filesystem_pp,
-                                         const char **path_pp,
-                                         const char *path_p)
+static int get_path_in_filesystem(struct fs_filesystem_t *filesystem_p,
+                                  const char **path_pp,
+                                  const char *path_p)
 {
-    struct fs_filesystem_t *filesystem_p;
     const char *name_p;
     int name_length;
 
-    /* Skip leading slash. */
+    /* Skip leading slashes. */
     if (path_p[0] == '/') {
         path_p++;
     }
 
+    name_p = filesystem_p->name_p;
+
+    if (name_p[0] == '/') {
+        name_p++;
+    }
+
+    name_length = strlen(name_p);
+
+    if (strncmp(name_p, path_p, name_length) != 0) {
+        return (-1);
+    }
+
+    if (path_p[name_length] != '\0') {
+        *path_pp = (path_p + name_length + 1);
+    } else {
+        *path_pp = "";
+    }
+
+    return (0);
+}
+
+/**
+ * Find the file system for given path.
+ */
+static int get_filesystem_path_from_path(struct fs_filesystem_t **filesystem_pp,
+                                         const char **path_pp,
+                                         const char *path_p)
+{
+    struct fs_filesystem_t *filesystem_p;
+
     filesystem_p = module.filesystems_p;
 
     /* Find the file system registered on given path. */
     while (filesystem_p != NULL) {
-        name_p = filesystem_p->name_p;
+        if (get_path_in_filesystem(filesystem_p, path_pp, path_p) == 0) {
+            *filesystem_pp = filesystem_p;
+
+            return (0);
+        }
 
-        /* Skip leading slash. */
-        if (name_p[0] == '/') {
-            name_p++;
+        filesystem_p = filesystem_p->next_p;
+    }
+
+    return (-1);
+}
+
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+
+static uint32_t dentry_hash(const char *path_p)
+{
+    uint32_t hash;
+
+    hash = 2166136261UL;
+
+    while (*path_p != '\0') {
+        hash ^= (uint8_t)*path_p++;
+        hash *= 16777619UL;
+    }
+
+    return (hash);
+}
+
+/**
+ * Find given absolute path in the dentry cache.
+ *
+ * @return Found entry or NULL. The cache mutex must be held by the
+ *         caller.
+ */
+static struct dentry_t *dentry_cache_find(const char *path_p,
+                                          uint32_t hash)
+{
+    struct dentry_t *dentry_p;
+    int i;
+
+    for (i = 0; i < membersof(module.dentry_cache.entries); i++) {
+        dentry_p = &module.dentry_cache.entries[i];
+
+        if ((dentry_p->path[0] != '\0')
+            && (dentry_p->hash == hash)
+            && (strcmp(&dentry_p->path[0], path_p) == 0)) {
+            return (dentry_p);
         }
+    }
 
-        name_length = strlen(name_p);
+    return (NULL);
+}
 
-        if (strncmp(name_p, path_p, name_length) == 0) {
-            if (path_p[name_length] != '\0') {
-                *path_pp = (path_p + name_length + 1);
-            } else {
-                *path_pp = "";
+/**
+ * Look up given absolute path in the dentry cache. The file system of
+ * an existing path is saved in `filesystem_pp`.
+ *
+ * @return true(1) if found, otherwise false(0).
+ */
+static int dentry_cache_get(const char *path_p,
+                            struct fs_filesystem_t **filesystem_pp,
+                            int *exists_p,
+                            struct fs_stat_t *stat_p)
+{
+    struct dentry_t *dentry_p;
+
+    mutex_lock(&module.dentry_cache.mutex);
+
+    dentry_p = dentry_cache_find(path_p, dentry_hash(path_p));
+
+    if (dentry_p != NULL) {
+        dentry_p->last_used = ++module.dentry_cache.tick;
+        *filesystem_pp = dentry_p->filesystem_p;
+        *exists_p = dentry_p->exists;
+
+        if (stat_p != NULL) {
+            *stat_p = dentry_p->stat;
+        }
+
+        fs_counter_increment(&module.dentry_cache.hits, 1);
+    } else {
+        fs_counter_increment(&module.dentry_cache.misses, 1);
+    }
+
+    mutex_unlock(&module.dentry_cache.mutex);
+
+    return (dentry_p != NULL);
+}
+
+/**
+ * Add given absolute path to the dentry cache, replacing the least
+ * recently used entry if the cache is full.
+ */
+static void dentry_cache_put(const char *path_p,
+                             struct fs_filesystem_t *filesystem_p,
+                             int exists,
+                             struct fs_stat_t *stat_p)
+{
+    struct dentry_t *dentry_p;
+    uint32_t hash;
+    int i;
+
+    if (strlen(path_p) >= CONFIG_FS_PATH_MAX) {
+        return;
+    }
+
+    hash = dentry_hash(path_p);
+
+    mutex_lock(&module.dentry_cache.mutex);
+
+    dentry_p = dentry_cache_find(path_p, hash);
+
+    if (dentry_p == NULL) {
+        dentry_p = &module.dentry_cache.entries[0];
+
+        for (i = 1; i < membersof(module.dentry_cache.entries); i++) {
+            if (dentry_p->path[0] == '\0') {
+                break;
             }
 
-            *filesystem_pp = filesystem_p;
+            if ((module.dentry_cache.entries[i].path[0] == '\0')
+                || (module.dentry_cache.entries[i].last_used
+                    < dentry_p->last_used)) {
+                dentry_p = &module.dentry_cache.entries[i];
+            }
+        }
 
-            return (0);
+        strcpy(&dentry_p->path[0], path_p);
+        dentry_p->hash = hash;
+    }
+
+    dentry_p->last_used = ++module.dentry_cache.tick;
+    dentry_p->filesystem_p = filesystem_p;
+    dentry_p->exists = exists;
+
+    if (stat_p != NULL) {
+        dentry_p->stat = *stat_p;
+    }
+
+    mutex_unlock(&module.dentry_cache.mutex);
+}
+
+/**
+ * Remove all entries in given file system from the dentry cache, or
+ * all entries if `filesystem_p` is NULL. Only existing files are
+ * removed if `files_only` is true(1).
+ *
+ * Single paths are never invalidated as some file systems, for
+ * example FAT16, have case insensitive paths.
+ */
+static void dentry_cache_invalidate_filesystem(
+    struct fs_filesystem_t *filesystem_p,
+    int files_only)
+{
+    struct dentry_t *dentry_p;
+    int i;
+
+    mutex_lock(&module.dentry_cache.mutex);
+
+    for (i = 0; i < membersof(module.dentry_cache.entries); i++) {
+        dentry_p = &module.dentry_cache.entries[i];
+
+        if ((filesystem_p != NULL)
+            && (dentry_p->filesystem_p != filesystem_p)) {
+            continue;
         }
 
-        filesystem_p = filesystem_p->next_p;
+        if (files_only
+            && !(dentry_p->exists && (dentry_p->stat.type == FS_TYPE_FILE))) {
+            continue;
+        }
+
+        dentry_p->path[0] = '\0';
     }
 
-    return (-1);
+    mutex_unlock(&module.dentry_cache.mutex);
 }
 
+#endif
+
 #if CONFIG_FAT16 == 1
 
 static int format_entry_fat16(void *chout_p,
@@ -905,14 +1134,45 @@ int fs_open(struct fs_file_t *self_p, const char *path_p, int flags)
 
     struct fs_filesystem_t *filesystem_p;
     char path[CONFIG_FS_PATH_MAX];
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+    int exists;
+#endif
 
     if (create_absolute_path(path, path_p) != 0) {
         return (-1);
     }
 
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+    filesystem_p = NULL;
+
+    if (!(flags & (FS_CREAT | FS_WRITE | FS_TRUNC | FS_APPEND))) {
+        if (dentry_cache_get(&path[0], &filesystem_p, &exists, NULL) == 1) {
+            if (!exists) {
+                return (-1);
+            }
+        }
+    }
+
+    /* Use the file system of a cached existing path, if any. */
+    if ((filesystem_p == NULL)
+        || (get_path_in_filesystem(filesystem_p, &path_p, &path[0]) != 0)) {
+        if (get_filesystem_path_from_path(&filesystem_p,
+                                          &path_p,
+                                          &path[0]) != 0) {
+            return (-1);
+        }
+    }
+#else
     if (get_filesystem_path_from_path(&filesystem_p, &path_p, &path[0]) != 0) {
         return (-1);
     }
+#endif
+
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+    if (flags & (FS_CREAT | FS_WRITE | FS_TRUNC | FS_APPEND)) {
+        dentry_cache_invalidate_filesystem(filesystem_p, 0);
+    }
+#endif
 
     self_p->filesystem_p = filesystem_p;
 
@@ -1069,6 +1329,12 @@ ssize_t fs_write(struct fs_file_t *self_p, const void *src_p, size_t size)
     ASSERTN(self_p != NULL, EINVAL);
     ASSERTN((src_p != NULL) || (size == 0), EINVAL);
 
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+    /* The file path is not known, so drop all cached files in the
+       file system as the file size changes. */
+    dentry_cache_invalidate_filesystem(self_p->filesystem_p, 1);
+#endif
+
     switch (self_p->filesystem_p->type) {
 
 #if CONFIG_FAT16 == 1
@@ -1184,6 +1450,10 @@ int fs_mkdir(const char *path_p)
         return (-1);
     }
 
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+    dentry_cache_invalidate_filesystem(filesystem_p, 0);
+#endif
+
     switch (filesystem_p->type) {
 
 #if CONFIG_FAT16 == 1
@@ -1219,11 +1489,22 @@ int fs_dir_open(struct fs_dir_t *dir_p,
 
     struct fs_filesystem_t *filesystem_p;
     char path[CONFIG_FS_PATH_MAX];
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+    int exists;
+#endif
 
     if (create_absolute_path(path, path_p) != 0) {
         return (-1);
     }
 
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+    if (dentry_cache_get(&path[0], &filesystem_p, &exists, NULL) == 1) {
+        if (!exists) {
+            return (-1);
+        }
+    }
+#endif
+
     if (get_filesystem_path_from_path(&filesystem_p, &path_p, &path[0]) != 0) {
         return (-1);
     }
@@ -1360,6 +1641,10 @@ int fs_remove(const char *path_p)
         return (-1);
     }
 
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+    dentry_cache_invalidate_filesystem(filesystem_p, 0);
+#endif
+
     switch (filesystem_p->type) {
 
 #if CONFIG_SPIFFS == 1
@@ -1381,12 +1666,26 @@ int fs_stat(const char *path_p, struct fs_stat_t *stat_p)
 
     struct fs_filesystem_t *filesystem_p;
     char path[CONFIG_FS_PATH_MAX];
+    int res;
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+    int exists;
+#endif
 
     if (create_absolute_path(path, path_p) != 0) {
         return (-1);
     }
 
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+    if (dentry_cache_get(&path[0], &filesystem_p, &exists, stat_p) == 1) {
+        return (exists ? 0 : -1);
+    }
+#endif
+
     if (get_filesystem_path_from_path(&filesystem_p, &path_p, &path[0]) != 0) {
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+        dentry_cache_put(&path[0], NULL, 0, NULL);
+#endif
+
         return (-1);
     }
 
@@ -1398,15 +1697,14 @@ int fs_stat(const char *path_p, struct fs_stat_t *stat_p)
         {
             struct fat16_stat_t stat;
 
-            if (fat16_stat(filesystem_p->fs.fat16_p, path_p, &stat) != 0) {
-                return (-1);
-            }
-
-            stat_p->size = stat.size;
-            stat_p->type = (stat.is_dir == 1 ? FS_TYPE_DIR : FS_TYPE_FILE);
+            res = fat16_stat(filesystem_p->fs.fat16_p, path_p, &stat);
 
-            return (0);
+            if (res == 0) {
+                stat_p->size = stat.size;
+                stat_p->type = (stat.is_dir == 1 ? FS_TYPE_DIR : FS_TYPE_FILE);
+            }
         }
+        break;
 
 #endif
 
@@ -1416,20 +1714,41 @@ int fs_stat(const char *path_p, struct fs_stat_t *stat_p)
         {
             struct spiffs_stat_t stat;
 
-            if (spiffs_stat(filesystem_p->fs.spiffs_p, path_p, &stat) != 0) {
-                return (-1);
-            }
+            res = spiffs_stat(filesystem_p->fs.spiffs_p, path_p, &stat);
 
-            stat_p->size = stat.size;
-            stat_p->type = stat.type;
-
-            return (0);
+            if (res == 0) {
+                stat_p->size = stat.size;
+                stat_p->type = stat.type;
+            }
         }
+        break;
+
 #endif
 
     default:
+        /* Do not cache the result as stat is not supported by this
+           file system. */
         return (-1);
     }
+
+    if (res != 0) {
+        res = -1;
+    }
+
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+    dentry_cache_put(&path[0], filesystem_p, res == 0, stat_p);
+#endif
+
+    return (res);
+}
+
+int fs_dentry_cache_invalidate(void)
+{
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+    dentry_cache_invalidate_filesystem(NULL, 0);
+#endif
+
+    return (0);
 }
 
 int fs_format(const char *path_p)
@@ -1453,6 +1772,10 @@ int fs_format(const char *path_p)
         return (-1);
     }
 
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+    dentry_cache_invalidate_filesystem(filesystem_p, 0);
+#endif
+
     switch (filesystem_p->type) {
 
 #if CONFIG_SPIFFS == 1
@@ -1813,6 +2136,11 @@ int fs_filesystem_register(struct fs_filesystem_t *filesystem_p)
     filesystem_p->next_p = module.filesystems_p;
     module.filesystems_p = filesystem_p;
 
+#if CONFIG_FS_DENTRY_CACHE_SIZE > 0
+    /* Paths may now resolve to the new file system. */
+    dentry_cache_invalidate_filesystem(NULL, 0);
+#endif
+
     return (0);
 }
 
@@ -448,6 +448,20 @@ int fs_remove(const char *path_p);
  */
 int fs_stat(const char *path_p, struct fs_stat_t *stat_p);
 
+/**
+ * Remove all entries from the path lookup cache. The cache is kept
+ * up to date by the functions in this module, but must be invalidated
+ * by the application after modifying a registered file system
+ * directly, for example using the FAT16 or SPIFFS API.
+ *
+ * Hits and misses are counted by the counters
+ * ``/filesystems/fs/dentry_cache/hits`` and
+ * ``/filesystems/fs/dentry_cache/misses``.
+ *
+ * @return zero(0) or negative error code.
+ */
+int fs_dentry_cache_invalidate(void);
+
 /**
  * Craete a directory with given path.
  *
@@ -25,3 +25,267 @@
  *
  * This file is part of the Simba project.
  */
+
+#include "simba.h"
+
+/* Low priority so that the garbage collection thread only runs when
+   no other thread is ready. */
+#define GC_THRD_PRIO                                      100
+
+struct module_t {
+    int initialized;
+    /* One lock for all file systems, as spiffs_mount() takes it
+       before the file system struct is initialized. */
+    struct mutex_t lock;
+};
+
+static struct module_t module;
+
+/* Implemented in the spiffs sources in 3pp. */
+extern int32_t _spiffs_read(struct spiffs_t *self_p,
+                            spiffs_file_t fh,
+                            void *buf_p,
+                            int32_t len);
+extern int32_t _spiffs_write(struct spiffs_t *self_p,
+                             spiffs_file_t fh,
+                             void *buf_p,
+                             int32_t len);
+extern int32_t _spiffs_gc_step(struct spiffs_t *self_p,
+                               uint32_t free_blocks_min);
+
+void spiffs_lock(struct spiffs_t *fs_p)
+{
+    mutex_lock(&module.lock);
+    fs_p->accesses++;
+}
+
+void spiffs_unlock(struct spiffs_t *fs_p)
+{
+    mutex_unlock(&module.lock);
+}
+
+#if CONFIG_SPIFFS_HISTOGRAMS == 1
+
+/**
+ * Add the time elapsed since given time_micros() timestamp to given
+ * histogram.
+ */
+static void histogram_record(struct spiffs_histogram_t *self_p, int start)
+{
+    uint32_t elapsed;
+    int i;
+
+    elapsed = MAX(time_micros_elapsed(start, time_micros()), 0);
+
+    if (elapsed > self_p->max) {
+        self_p->max = elapsed;
+    }
+
+    i = 0;
+
+    while ((elapsed > 1) && (i < SPIFFS_HISTOGRAM_BUCKETS - 1)) {
+        elapsed >>= 1;
+        i++;
+    }
+
+    self_p->buckets[i]++;
+}
+
+static void histogram_print(struct spiffs_histogram_t *self_p,
+                            const char *name_p,
+                            void *chout_p)
+{
+    int i;
+
+    std_fprintf(chout_p,
+                OSTR("%s: max %lu us\r\n"),
+                name_p,
+                (unsigned long)self_p->max);
+
+    for (i = 0; i < SPIFFS_HISTOGRAM_BUCKETS; i++) {
+        if (self_p->buckets[i] == 0) {
+            continue;
+        }
+
+        if (i == SPIFFS_HISTOGRAM_BUCKETS - 1) {
+            std_fprintf(chout_p,
+                        OSTR("  >= %lu us: %lu\r\n"),
+                        (1ul << i),
+                        (unsigned long)self_p->buckets[i]);
+        } else {
+            std_fprintf(chout_p,
+                        OSTR("  < %lu us: %lu\r\n"),
+                        (2ul << i),
+                        (unsigned long)self_p->buckets[i]);
+        }
+    }
+}
+
+int spiffs_histograms_print(struct spiffs_t *self_p, void *chout_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chout_p != NULL, EINVAL);
+
+    histogram_print(&self_p->histograms.read, "read", chout_p);
+    histogram_print(&self_p->histograms.write, "write", chout_p);
+    histogram_print(&self_p->histograms.gc, "gc", chout_p);
+
+    return (0);
+}
+
+int spiffs_histograms_reset(struct spiffs_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    memset(&self_p->histograms, 0, sizeof(self_p->histograms));
+
+    return (0);
+}
+
+#endif
+
+int spiffs_module_init(void)
+{
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+
+    return (mutex_init(&module.lock));
+}
+
+int32_t spiffs_read(struct spiffs_t *self_p,
+                    spiffs_file_t fh,
+                    void *buf_p,
+                    int32_t len)
+{
+#if CONFIG_SPIFFS_HISTOGRAMS == 1
+    int32_t res;
+    int start;
+
+    start = time_micros();
+    res = _spiffs_read(self_p, fh, buf_p, len);
+    histogram_record(&self_p->histograms.read, start);
+
+    return (res);
+#else
+    return (_spiffs_read(self_p, fh, buf_p, len));
+#endif
+}
+
+int32_t spiffs_write(struct spiffs_t *self_p,
+                     spiffs_file_t fh,
+                     void *buf_p,
+                     int32_t len)
+{
+#if CONFIG_SPIFFS_HISTOGRAMS == 1
+    int32_t res;
+    int start;
+
+    start = time_micros();
+    res = _spiffs_write(self_p, fh, buf_p, len);
+    histogram_record(&self_p->histograms.write, start);
+
+    return (res);
+#else
+    return (_spiffs_write(self_p, fh, buf_p, len));
+#endif
+}
+
+int32_t spiffs_gc_step(struct spiffs_t *self_p,
+                       uint32_t free_blocks_min)
+{
+    int32_t res;
+#if CONFIG_SPIFFS_HISTOGRAMS == 1
+    int start;
+#endif
+
+    if (!spiffs_mounted(self_p)) {
+        self_p->err_code = SPIFFS_ERR_NOT_MOUNTED;
+
+        return (SPIFFS_ERR_NOT_MOUNTED);
+    }
+
+    spiffs_lock(self_p);
+
+#if CONFIG_SPIFFS_HISTOGRAMS == 1
+    start = time_micros();
+#endif
+
+    res = _spiffs_gc_step(self_p, free_blocks_min);
+
+    if (res < 0) {
+        self_p->err_code = res;
+    }
+
+#if CONFIG_SPIFFS_HISTOGRAMS == 1
+    if (res == 1) {
+        histogram_record(&self_p->histograms.gc, start);
+    }
+#endif
+
+    spiffs_unlock(self_p);
+
+    return (res);
+}
+
+static void *gc_thrd_main(void *arg_p)
+{
+    struct spiffs_gc_thrd_t *self_p;
+    uint32_t accesses;
+
+    self_p = arg_p;
+
+    thrd_set_name("spiffs_gc");
+
+    accesses = self_p->fs_p->accesses;
+
+    while (1) {
+        thrd_sleep_ms(CONFIG_SPIFFS_GC_THRD_IDLE_MS);
+
+        /* Only reclaim a block if no other thread has used the file
+           system during the last period. A single block per period
+           keeps the time the lock is held short. */
+        if (spiffs_mounted(self_p->fs_p)
+            && (self_p->fs_p->accesses == accesses)) {
+            (void)spiffs_gc_step(self_p->fs_p,
+                                 CONFIG_SPIFFS_GC_THRD_FREE_BLOCKS_MIN);
+        }
+
+        accesses = self_p->fs_p->accesses;
+    }
+
+    return (NULL);
+}
+
+int spiffs_gc_thrd_init(struct spiffs_gc_thrd_t *self_p,
+                        struct spiffs_t *fs_p,
+                        void *stack_p,
+                        size_t stack_size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(fs_p != NULL, EINVAL);
+    ASSERTN(stack_p != NULL, EINVAL);
+
+    self_p->fs_p = fs_p;
+    self_p->stack_p = stack_p;
+    self_p->stack_size = stack_size;
+    self_p->thrd_p = NULL;
+
+    return (0);
+}
+
+int spiffs_gc_thrd_start(struct spiffs_gc_thrd_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->thrd_p = thrd_spawn(gc_thrd_main,
+                                self_p,
+                                GC_THRD_PRIO,
+                                self_p->stack_p,
+                                self_p->stack_size);
+
+    return (self_p->thrd_p != NULL ? 0 : -1);
+}
@@ -230,6 +230,16 @@ typedef void (*spiffs_file_callback_t)(struct spiffs_t *fs_p,
 #define SPIFFS_TYPE_HARD_LINK           (3)
 #define SPIFFS_TYPE_SOFT_LINK           (4)
 
+/** Number of buckets in a latency histogram. */
+#define SPIFFS_HISTOGRAM_BUCKETS       16
+
+/**
+ * Size in bytes of a cache buffer with given number of pages of given
+ * size, to be given to `spiffs_mount()`. At most 32 pages are used.
+ */
+#define SPIFFS_CACHE_BUFFER_SIZE(page_size, pages)      \
+    (32 + (pages) * (24 + (page_size)))
+
 #ifndef SPIFFS_LOCK
 #define SPIFFS_LOCK(fs)
 #endif
@@ -238,6 +248,18 @@ typedef void (*spiffs_file_callback_t)(struct spiffs_t *fs_p,
 #define SPIFFS_UNLOCK(fs)
 #endif
 
+/**
+ * Latency histogram. Bucket `i` counts operations that took at least
+ * 2^i and less than 2^(i+1) microseconds, except the first bucket
+ * that also counts operations faster than one microsecond, and the
+ * last bucket that counts all slower operations.
+ */
+struct spiffs_histogram_t {
+    uint32_t buckets[SPIFFS_HISTOGRAM_BUCKETS];
+    /** Slowest operation in microseconds. */
+    uint32_t max;
+};
+
 /** Spiffs spi configuration struct. */
 struct spiffs_config_t {
     /** Physical read function. */
@@ -332,6 +354,23 @@ struct spiffs_t {
     void *user_data;
     /** Config magic. */
     uint32_t config_magic;
+    /** Number of locked operations, used to detect idle periods. */
+    uint32_t accesses;
+#if CONFIG_SPIFFS_HISTOGRAMS == 1
+    struct {
+        struct spiffs_histogram_t read;
+        struct spiffs_histogram_t write;
+        struct spiffs_histogram_t gc;
+    } histograms;
+#endif
+};
+
+/** Background garbage collection thread. */
+struct spiffs_gc_thrd_t {
+    struct spiffs_t *fs_p;
+    void *stack_p;
+    size_t stack_size;
+    struct thrd_t *thrd_p;
 };
 
 /** Spiffs file status struct. */
@@ -357,6 +396,17 @@ struct spiffs_dir_t {
     int entry;
 };
 
+/**
+ * Initialize the spiffs module. This function should be called
+ * before calling any other function in this module.
+ *
+ * The module will only be initialized once even if this function is
+ * called multiple times.
+ *
+ * @return zero(0) or negative error code.
+ */
+int spiffs_module_init(void);
+
 #if SPIFFS_USE_MAGIC && SPIFFS_USE_MAGIC_LENGTH && SPIFFS_SINGLETON == 0
 
 /**
@@ -808,6 +858,77 @@ int32_t spiffs_gc_quick(struct spiffs_t *self_p,
 int32_t spiffs_gc(struct spiffs_t *self_p,
                   uint32_t size);
 
+/**
+ * Reclaim at most one block by erasing a block with only deleted
+ * pages, or, if there are fewer than given number of free blocks,
+ * moving the used pages out of the best garbage collection candidate
+ * block and erasing it. The time spent is bounded by the time it
+ * takes to garbage collect one block.
+ *
+ * @param[in] self_p The file system struct.
+ * @param[in] free_blocks_min Move pages to reclaim a block only if
+ *                            there are fewer free blocks than this.
+ *
+ * @return One(1) if a block was reclaimed, zero(0) if there is
+ *         nothing to reclaim, otherwise negative error code.
+ */
+int32_t spiffs_gc_step(struct spiffs_t *self_p,
+                       uint32_t free_blocks_min);
+
+/**
+ * Initialize given background garbage collection thread. The thread
+ * calls `spiffs_gc_step()` when the file system has been idle for
+ * ``CONFIG_SPIFFS_GC_THRD_IDLE_MS`` milliseconds, so that writes
+ * seldom have to garbage collect inline.
+ *
+ * @param[out] self_p Garbage collection thread to initialize.
+ * @param[in] fs_p File system to garbage collect.
+ * @param[in] stack_p Thread stack.
+ * @param[in] stack_size Thread stack size.
+ *
+ * @return zero(0) or negative error code.
+ */
+int spiffs_gc_thrd_init(struct spiffs_gc_thrd_t *self_p,
+                        struct spiffs_t *fs_p,
+                        void *stack_p,
+                        size_t stack_size);
+
+/**
+ * Start given background garbage collection thread. The thread does
+ * nothing while the file system is unmounted.
+ *
+ * @param[in] self_p Garbage collection thread to start.
+ *
+ * @return zero(0) or negative error code.
+ */
+int spiffs_gc_thrd_start(struct spiffs_gc_thrd_t *self_p);
+
+#if CONFIG_SPIFFS_HISTOGRAMS == 1
+
+/**
+ * Print the read, write and garbage collection latency histograms of
+ * given file system. The garbage collection histogram contains the
+ * `spiffs_gc_step()` calls that reclaimed a block. Garbage collection
+ * inline in writes is part of the write latency.
+ *
+ * @param[in] self_p The file system struct.
+ * @param[in] chout_p Output channel.
+ *
+ * @return zero(0) or negative error code.
+ */
+int spiffs_histograms_print(struct spiffs_t *self_p, void *chout_p);
+
+/**
+ * Clear the latency histograms of given file system.
+ *
+ * @param[in] self_p The file system struct.
+ *
+ * @return zero(0) or negative error code.
+ */
+int spiffs_histograms_reset(struct spiffs_t *self_p);
+
+#endif
+
 /**
  * Check if EOF reached.
  *
@@ -28,6 +28,27 @@
 
 #include "simba.h"
 
+#if CONFIG_CRC_32_HARDWARE == 1
+#    if defined(ARCH_LINUX) && (defined(__x86_64__) || defined(__i386__))
+#        define CRC_32_PCLMUL
+#        include <immintrin.h>
+#    elif defined(ARCH_LINUX) && defined(__aarch64__)
+#        define CRC_32_ARMV8
+#        include <arm_acle.h>
+#        include <sys/auxv.h>
+#        include <asm/hwcap.h>
+#    elif defined(__ARM_FEATURE_CRC32)
+#        define CRC_32_ARMV8
+#        include <arm_acle.h>
+#    endif
+#endif
+
+/* Reflected CRC-32 polynomial. */
+#define CRC_32_POLYNOMIAL                              0xedb88320
+
+/* Implementation used by crc_32(), or -1 if not yet selected. */
+static int8_t crc_32_implementation = -1;
+
 #if CONFIG_CRC_TABLE_LOOKUP == 1
 
 static FAR const uint32_t crc32_tab[] = {
@@ -111,33 +132,79 @@ static FAR const uint16_t ccitt_tab[256] = {
     0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0
 };
 
-uint32_t crc_32(uint32_t crc, const void *buf_p, size_t size)
+static uint32_t crc_32_byte(uint32_t crc, const uint8_t *b_p, size_t size)
 {
-    ASSERTN(buf_p != NULL, EINVAL);
+    while (size--) {
+        crc = crc32_tab[(crc ^ *b_p++) & 0xff] ^ (crc >> 8);
+    }
 
-    const uint8_t *b_p;
+    return (crc);
+}
 
-    b_p = buf_p;
-    crc ^= 0xfffffffful;
+#if CONFIG_CRC_CCITT_SLICES > 1
 
-    while (size--) {
-        crc = crc32_tab[(crc ^ *b_p++) & 0xff] ^ (crc >> 8);
+/* Table k gives the crc of a byte followed by k zero bytes. Table 0
+   is ccitt_tab. Generated on first use. */
+static uint16_t ccitt_slices_tab[CONFIG_CRC_CCITT_SLICES][256];
+static int8_t ccitt_slices_initialized = 0;
+
+static void crc_ccitt_slices_init(void)
+{
+    int i;
+    int k;
+    uint16_t crc;
+
+    for (i = 0; i < 256; i++) {
+        crc = ccitt_tab[i];
+        ccitt_slices_tab[0][i] = crc;
+
+        for (k = 1; k < CONFIG_CRC_CCITT_SLICES; k++) {
+            crc = ((crc << 8) ^ ccitt_tab[crc >> 8]);
+            ccitt_slices_tab[k][i] = crc;
+        }
     }
 
-    return (~crc);
+    ccitt_slices_initialized = 1;
 }
 
+#endif
+
 uint16_t crc_ccitt(uint16_t crc, const void *buf_p, size_t size)
 {
     ASSERTN(buf_p != NULL, EINVAL);
 
-    size_t i;
     const uint8_t *b_p;
+#if CONFIG_CRC_CCITT_SLICES > 1
+    uint16_t value;
+    int i;
+#endif
 
     b_p = buf_p;
 
-    for (i = 0; i < size; i++) {
+#if CONFIG_CRC_CCITT_SLICES > 1
+    if (ccitt_slices_initialized == 0) {
+        crc_ccitt_slices_init();
+    }
+
+    /* Slicing-by-N. The 16 bits crc is xored into the first two
+       bytes, and all N bytes are looked up in independent tables. */
+    while (size >= CONFIG_CRC_CCITT_SLICES) {
+        value = (ccitt_slices_tab[CONFIG_CRC_CCITT_SLICES - 1][b_p[0] ^ (crc >> 8)]
+                 ^ ccitt_slices_tab[CONFIG_CRC_CCITT_SLICES - 2][b_p[1] ^ (crc & 0xff)]);
+
+        for (i = 2; i < CONFIG_CRC_CCITT_SLICES; i++) {
+            value ^= ccitt_slices_tab[CONFIG_CRC_CCITT_SLICES - 1 - i][b_p[i]];
+        }
+
+        crc = value;
+        b_p += CONFIG_CRC_CCITT_SLICES;
+        size -= CONFIG_CRC_CCITT_SLICES;
+    }
+#endif
+
+    while (size > 0) {
         crc = (crc << 8) ^ ccitt_tab[(crc >> 8) ^ *b_p++];
+        size--;
     }
 
     return (crc);
@@ -145,27 +212,21 @@ uint16_t crc_ccitt(uint16_t crc, const void *buf_p, size_t size)
 
 #else
 
-uint32_t crc_32(uint32_t crc, const void *buf_p, size_t size)
+static uint32_t crc_32_byte(uint32_t crc, const uint8_t *b_p, size_t size)
 {
-    ASSERTN(buf_p != NULL, EINVAL);
-
-    const uint8_t *b_p;
     size_t i;
 
-    b_p = buf_p;
-    crc ^= 0xfffffffful;
-
     while (size > 0) {
         crc = (crc ^ *b_p++);
 
         for (i = 0; i < 8; i++) {
-            crc = (crc >> 1) ^ (0xedb88320 & (-(crc & 1)));
+            crc = (crc >> 1) ^ (CRC_32_POLYNOMIAL & (-(crc & 1)));
         }
 
         size--;
     }
 
-    return (~crc);
+    return (crc);
 }
 
 uint16_t crc_ccitt(uint16_t crc, const void *buf_p, size_t size)
@@ -194,6 +255,392 @@ uint16_t crc_ccitt(uint16_t crc, const void *buf_p, size_t size)
 
 #endif
 
+#if (CONFIG_CRC_32_SLICES != 1)         \
+    && (CONFIG_CRC_32_SLICES != 4)      \
+    && (CONFIG_CRC_32_SLICES != 8)      \
+    && (CONFIG_CRC_32_SLICES != 16)
+#    error "CONFIG_CRC_32_SLICES must be 1, 4, 8 or 16."
+#endif
+
+#if (CONFIG_CRC_TABLE_LOOKUP == 1) && (CONFIG_CRC_32_SLICES > 1)
+
+/* Table k gives the crc of a byte followed by k zero bytes. Table 0
+   is crc32_tab. Generated on first use. */
+static uint32_t crc32_slices_tab[CONFIG_CRC_32_SLICES][256];
+
+static void crc_32_slices_init(void)
+{
+    int i;
+    int k;
+    uint32_t crc;
+
+    for (i = 0; i < 256; i++) {
+        crc = crc32_tab[i];
+        crc32_slices_tab[0][i] = crc;
+
+        for (k = 1; k < CONFIG_CRC_32_SLICES; k++) {
+            crc = (crc >> 8) ^ crc32_tab[crc & 0xff];
+            crc32_slices_tab[k][i] = crc;
+        }
+    }
+}
+
+/**
+ * Slicing-by-N. Each iteration looks up all N bytes in independent
+ * tables, instead of one byte after the other.
+ */
+static uint32_t crc_32_slices(uint32_t crc, const uint8_t *b_p, size_t size)
+{
+    uint32_t value;
+    int i;
+
+    while (size >= CONFIG_CRC_32_SLICES) {
+        crc ^= ((uint32_t)b_p[0]
+                | ((uint32_t)b_p[1] << 8)
+                | ((uint32_t)b_p[2] << 16)
+                | ((uint32_t)b_p[3] << 24));
+        value = (crc32_slices_tab[CONFIG_CRC_32_SLICES - 1][crc & 0xff]
+                 ^ crc32_slices_tab[CONFIG_CRC_32_SLICES - 2][(crc >> 8) & 0xff]
+                 ^ crc32_slices_tab[CONFIG_CRC_32_SLICES - 3][(crc >> 16) & 0xff]
+                 ^ crc32_slices_tab[CONFIG_CRC_32_SLICES - 4][crc >> 24]);
+
+        for (i = 4; i < CONFIG_CRC_32_SLICES; i++) {
+            value ^= crc32_slices_tab[CONFIG_CRC_32_SLICES - 1 - i][b_p[i]];
+        }
+
+        crc = value;
+        b_p += CONFIG_CRC_32_SLICES;
+        size -= CONFIG_CRC_32_SLICES;
+    }
+
+    return (crc_32_byte(crc, b_p, size));
+}
+
+#endif
+
+#if defined(CRC_32_PCLMUL)
+
+/**
+ * Fold 64 bytes at a time using carry-less multiplication, as
+ * described in Intel's "Fast CRC Computation for Generic Polynomials
+ * Using PCLMULQDQ Instruction". At least 64 bytes must be given. Only
+ * whole 16 bytes blocks are processed.
+ *
+ * @return Number of processed bytes.
+ */
+__attribute__((target("pclmul,sse4.1")))
+static size_t crc_32_hardware(uint32_t *crc_p,
+                              const uint8_t *b_p,
+                              size_t size)
+{
+    static const uint64_t k1k2[2] __attribute__((aligned(16))) = {
+        0x0154442bd4, 0x01c6e41596
+    };
+    static const uint64_t k3k4[2] __attribute__((aligned(16))) = {
+        0x01751997d0, 0x00ccaa009e
+    };
+    static const uint64_t k5k0[2] __attribute__((aligned(16))) = {
+        0x0163cd6124, 0x0000000000
+    };
+    static const uint64_t poly[2] __attribute__((aligned(16))) = {
+        0x01db710641, 0x01f7011641
+    };
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+    size_t left;
+
+    left = size;
+
+    x1 = _mm_loadu_si128((__m128i *)(b_p + 0x00));
+    x2 = _mm_loadu_si128((__m128i *)(b_p + 0x10));
+    x3 = _mm_loadu_si128((__m128i *)(b_p + 0x20));
+    x4 = _mm_loadu_si128((__m128i *)(b_p + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(*crc_p));
+    x0 = _mm_load_si128((__m128i *)k1k2);
+    b_p += 64;
+    left -= 64;
+
+    /* Fold four 128 bits lanes in parallel. */
+    while (left >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        y5 = _mm_loadu_si128((__m128i *)(b_p + 0x00));
+        y6 = _mm_loadu_si128((__m128i *)(b_p + 0x10));
+        y7 = _mm_loadu_si128((__m128i *)(b_p + 0x20));
+        y8 = _mm_loadu_si128((__m128i *)(b_p + 0x30));
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+        b_p += 64;
+        left -= 64;
+    }
+
+    /* Fold the four lanes into one. */
+    x0 = _mm_load_si128((__m128i *)k3k4);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    /* Fold remaining 16 bytes blocks. */
+    while (left >= 16) {
+        x2 = _mm_loadu_si128((__m128i *)b_p);
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+        b_p += 16;
+        left -= 16;
+    }
+
+    /* Fold 128 bits to 64 bits. */
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = _mm_loadl_epi64((__m128i *)k5k0);
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    /* Barrett reduction to 32 bits. */
+    x0 = _mm_load_si128((__m128i *)poly);
+
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    *crc_p = _mm_extract_epi32(x1, 1);
+
+    return (size - left);
+}
+
+static int crc_32_hardware_available(void)
+{
+    __builtin_cpu_init();
+
+    return (__builtin_cpu_supports("pclmul")
+            && __builtin_cpu_supports("sse4.1"));
+}
+
+#elif defined(CRC_32_ARMV8)
+
+/**
+ * Use the ARMv8 CRC32 instructions, eight bytes at a time.
+ *
+ * @return Number of processed bytes.
+ */
+#if defined(ARCH_LINUX)
+__attribute__((target("+crc")))
+#endif
+static size_t crc_32_hardware(uint32_t *crc_p,
+                              const uint8_t *b_p,
+                              size_t size)
+{
+    uint32_t crc;
+    uint64_t value;
+    size_t left;
+
+    crc = *crc_p;
+    left = size;
+
+    while (left >= 8) {
+        memcpy(&value, b_p, sizeof(value));
+        crc = __crc32d(crc, value);
+        b_p += 8;
+        left -= 8;
+    }
+
+    *crc_p = crc;
+
+    return (size - left);
+}
+
+static int crc_32_hardware_available(void)
+{
+#if defined(ARCH_LINUX)
+    return ((getauxval(AT_HWCAP) & HWCAP_CRC32) != 0);
+#else
+    return (1);
+#endif
+}
+
+#endif
+
+static int crc_32_implementation_available(int implementation)
+{
+    switch (implementation) {
+
+    case CRC_32_IMPLEMENTATION_BYTE:
+        return (1);
+
+#if (CONFIG_CRC_TABLE_LOOKUP == 1) && (CONFIG_CRC_32_SLICES > 1)
+    case CRC_32_IMPLEMENTATION_SLICES:
+        return (1);
+#endif
+
+#if defined(CRC_32_PCLMUL) || defined(CRC_32_ARMV8)
+    case CRC_32_IMPLEMENTATION_HARDWARE:
+        return (crc_32_hardware_available());
+#endif
+
+    default:
+        return (0);
+    }
+}
+
+static void crc_32_implementation_init(void)
+{
+    int implementation;
+
+#if (CONFIG_CRC_TABLE_LOOKUP == 1) && (CONFIG_CRC_32_SLICES > 1)
+    crc_32_slices_init();
+#endif
+
+    /* Select the fastest available implementation. */
+    implementation = CRC_32_IMPLEMENTATION_HARDWARE;
+
+    while (!crc_32_implementation_available(implementation)) {
+        implementation--;
+    }
+
+    crc_32_implementation = implementation;
+}
+
+uint32_t crc_32(uint32_t crc, const void *buf_p, size_t size)
+{
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    const uint8_t *b_p;
+#if defined(CRC_32_PCLMUL) || defined(CRC_32_ARMV8)
+    size_t processed;
+#endif
+
+    b_p = buf_p;
+    crc ^= 0xfffffffful;
+
+    if (crc_32_implementation < 0) {
+        crc_32_implementation_init();
+    }
+
+    switch (crc_32_implementation) {
+
+#if defined(CRC_32_PCLMUL) || defined(CRC_32_ARMV8)
+    case CRC_32_IMPLEMENTATION_HARDWARE:
+        if (size >= 64) {
+            processed = crc_32_hardware(&crc, b_p, size);
+            b_p += processed;
+            size -= processed;
+        }
+
+        /* Fall through for the remaining bytes. */
+#endif
+
+#if (CONFIG_CRC_TABLE_LOOKUP == 1) && (CONFIG_CRC_32_SLICES > 1)
+    case CRC_32_IMPLEMENTATION_SLICES:
+        crc = crc_32_slices(crc, b_p, size);
+        break;
+#endif
+
+    default:
+        crc = crc_32_byte(crc, b_p, size);
+        break;
+    }
+
+    return (~crc);
+}
+
+int crc_32_set_implementation(int implementation)
+{
+    if (crc_32_implementation < 0) {
+        crc_32_implementation_init();
+    }
+
+    if (!crc_32_implementation_available(implementation)) {
+        return (-ENOSYS);
+    }
+
+    crc_32_implementation = implementation;
+
+    return (0);
+}
+
+int crc_32_get_implementation(void)
+{
+    if (crc_32_implementation < 0) {
+        crc_32_implementation_init();
+    }
+
+    return (crc_32_implementation);
+}
+
+/**
+ * Multiply given polynomials modulo the CRC-32 polynomial, all in
+ * reflected bit order.
+ */
+static uint32_t crc_32_multiply(uint32_t a, uint32_t b)
+{
+    uint32_t mask;
+    uint32_t product;
+
+    mask = (1ul << 31);
+    product = 0;
+
+    while (1) {
+        if (a & mask) {
+            product ^= b;
+
+            if ((a & (mask - 1)) == 0) {
+                break;
+            }
+        }
+
+        mask >>= 1;
+        b = ((b & 1) ? ((b >> 1) ^ CRC_32_POLYNOMIAL) : (b >> 1));
+    }
+
+    return (product);
+}
+
+uint32_t crc_32_combine(uint32_t crc1, uint32_t crc2, size_t size2)
+{
+    uint32_t power;
+    uint32_t square;
+
+    /* x^(8 * size2) by repeated squaring, starting at x^8. */
+    power = (1ul << 31);
+    square = (1ul << 23);
+
+    while (size2 > 0) {
+        if (size2 & 1) {
+            power = crc_32_multiply(square, power);
+        }
+
+        square = crc_32_multiply(square, square);
+        size2 >>= 1;
+    }
+
+    return (crc_32_multiply(power, crc1) ^ crc2);
+}
+
 uint16_t crc_xmodem(uint16_t crc, const void *buf_p, size_t size)
 {
     return (crc_ccitt(crc, buf_p, size));
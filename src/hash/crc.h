@@ -36,6 +36,23 @@
  */
 #define CRC_8_POLYNOMIAL_8_5_4_0                         0x8c
 
+/**
+ * Calculate the CRC-32 one byte at a time, using a table if
+ * ``CONFIG_CRC_TABLE_LOOKUP`` is set.
+ */
+#define CRC_32_IMPLEMENTATION_BYTE                          0
+
+/**
+ * Calculate the CRC-32 ``CONFIG_CRC_32_SLICES`` bytes at a time.
+ */
+#define CRC_32_IMPLEMENTATION_SLICES                        1
+
+/**
+ * Calculate the CRC-32 using CPU instructions; carry-less
+ * multiplication on x86 or the ARMv8 CRC32 instructions.
+ */
+#define CRC_32_IMPLEMENTATION_HARDWARE                      2
+
 /**
  * Calculate a 32 bits crc using the polynomial
  * ``x^32+x^26+x^23+x^22+x^16+x^12+x^11+x^10+x^8+x^7+x^5+x^4+x^2+x^1+x^0``.
@@ -48,6 +65,39 @@
  */
 uint32_t crc_32(uint32_t crc, const void *buf_p, size_t size);
 
+/**
+ * Combine the crcs of two consecutive buffers into the crc of both
+ * buffers. Use it to calculate the crc of a large buffer in parts, in
+ * any order or in parallel.
+ *
+ * @param[in] crc1 Crc of the first buffer, calculated with initial
+ *                 crc 0x00000000.
+ * @param[in] crc2 Crc of the second buffer, calculated with initial
+ *                 crc 0x00000000.
+ * @param[in] size2 Size of the second buffer.
+ *
+ * @return Crc of the first buffer followed by the second buffer.
+ */
+uint32_t crc_32_combine(uint32_t crc1, uint32_t crc2, size_t size2);
+
+/**
+ * Select the implementation used by `crc_32()`. The fastest
+ * available implementation is used by default.
+ *
+ * @param[in] implementation One of ``CRC_32_IMPLEMENTATION_*``.
+ *
+ * @return zero(0) or -ENOSYS if given implementation is not available
+ *         on this CPU or in this configuration.
+ */
+int crc_32_set_implementation(int implementation);
+
+/**
+ * Get the implementation used by `crc_32()`.
+ *
+ * @return One of ``CRC_32_IMPLEMENTATION_*``.
+ */
+int crc_32_get_implementation(void);
+
 /**
  * Calculate a 16 bits crc using the CCITT algorithm (polynomial
  * ``x^16+x^12+x^5+x^1``).
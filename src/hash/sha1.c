@@ -28,30 +28,64 @@
 
 #include "simba.h"
 
+#if CONFIG_SHA_HARDWARE == 1
+#    if defined(ARCH_LINUX) && (defined(__x86_64__) || defined(__i386__))
+#        define SHA1_SHANI
+#        include <immintrin.h>
+#    elif defined(ARCH_LINUX) && defined(__aarch64__)
+#        define SHA1_ARMV8
+#        include <arm_neon.h>
+#        include <sys/auxv.h>
+#        include <asm/hwcap.h>
+#    elif defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2)
+#        define SHA1_ARMV8
+#        include <arm_neon.h>
+#    endif
+#endif
+
+/* Lanes in the multi-buffer implementation. */
+#define MULTI_LANES                                         4
+
+typedef void (*blocks_update_t)(uint32_t *h_p,
+                                const uint8_t *b_p,
+                                size_t blocks);
+
+typedef uint32_t lanes_t __attribute__((vector_size(4 * MULTI_LANES)));
+
+static int8_t implementation = -1;
+static blocks_update_t blocks_update;
+
 static inline uint32_t rotateleft(uint32_t value, int positions)
 {
     return ((value << positions) | (value >> (32 - positions)));
 }
 
-static void block_update(struct sha1_t *self_p,
-                         uint8_t *block_p)
+static inline uint32_t load_be32(const uint8_t *b_p)
+{
+    return (((uint32_t)b_p[0] << 24)
+            | ((uint32_t)b_p[1] << 16)
+            | ((uint32_t)b_p[2] << 8)
+            | ((uint32_t)b_p[3]));
+}
+
+static void block_update(uint32_t *h_p,
+                         const uint8_t *block_p)
 {
     uint32_t a ,b ,c ,d ,e, f, i ,t ,w[80];
-    uint32_t *b_p = (uint32_t *)block_p;
 
     for (i = 0; i < 16; i++) {
-        w[i] = ntohl(b_p[i]);
+        w[i] = load_be32(&block_p[4 * i]);
     }
 
     for (i = 16; i < 80; i++) {
         w[i] = rotateleft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
     }
 
-    a = self_p->h[0];
-    b = self_p->h[1];
-    c = self_p->h[2];
-    d = self_p->h[3];
-    e = self_p->h[4];
+    a = h_p[0];
+    b = h_p[1];
+    c = h_p[2];
+    d = h_p[3];
+    e = h_p[4];
 
     for (i = 0; i < 20; i++) {
         f = ((b & c) ^ (~b & d));
@@ -93,17 +127,475 @@ static void block_update(struct sha1_t *self_p,
         a = t;
     }
 
-    self_p->h[0] += a;
-    self_p->h[1] += b;
-    self_p->h[2] += c;
-    self_p->h[3] += d;
-    self_p->h[4] += e;
+    h_p[0] += a;
+    h_p[1] += b;
+    h_p[2] += c;
+    h_p[3] += d;
+    h_p[4] += e;
+}
+
+static void blocks_update_c(uint32_t *h_p,
+                            const uint8_t *b_p,
+                            size_t blocks)
+{
+    while (blocks > 0) {
+        block_update(h_p, b_p);
+        b_p += 64;
+        blocks--;
+    }
+}
+
+#if defined(SHA1_SHANI)
+
+/**
+ * Use the x86 SHA extensions, four rounds per instruction.
+ */
+__attribute__((target("sha,ssse3,sse4.1")))
+static void blocks_update_hardware(uint32_t *h_p,
+                                   const uint8_t *b_p,
+                                   size_t blocks)
+{
+    __m128i abcd, abcd_save, e0, e0_save, e1;
+    __m128i msg0, msg1, msg2, msg3;
+    __m128i mask;
+
+    mask = _mm_set_epi64x(0x0001020304050607ull, 0x08090a0b0c0d0e0full);
+    abcd = _mm_loadu_si128((__m128i *)h_p);
+    abcd = _mm_shuffle_epi32(abcd, 0x1b);
+    e0 = _mm_set_epi32(h_p[4], 0, 0, 0);
+
+    while (blocks > 0) {
+        abcd_save = abcd;
+        e0_save = e0;
+
+        /* Rounds 0-3. */
+        msg0 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)&b_p[0]), mask);
+        e0 = _mm_add_epi32(e0, msg0);
+        e1 = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+        /* Rounds 4-7. */
+        msg1 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)&b_p[16]), mask);
+        e1 = _mm_sha1nexte_epu32(e1, msg1);
+        e0 = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+        msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+
+        /* Rounds 8-11. */
+        msg2 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)&b_p[32]), mask);
+        e0 = _mm_sha1nexte_epu32(e0, msg2);
+        e1 = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+        msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+        msg0 = _mm_xor_si128(msg0, msg2);
+
+        /* Rounds 12-15. */
+        msg3 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)&b_p[48]), mask);
+        e1 = _mm_sha1nexte_epu32(e1, msg3);
+        e0 = abcd;
+        msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+        msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+        msg1 = _mm_xor_si128(msg1, msg3);
+
+        /* Rounds 16-19. */
+        e0 = _mm_sha1nexte_epu32(e0, msg0);
+        e1 = abcd;
+        msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+        msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+        msg2 = _mm_xor_si128(msg2, msg0);
+
+        /* Rounds 20-23. */
+        e1 = _mm_sha1nexte_epu32(e1, msg1);
+        e0 = abcd;
+        msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+        msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+        msg3 = _mm_xor_si128(msg3, msg1);
+
+        /* Rounds 24-27. */
+        e0 = _mm_sha1nexte_epu32(e0, msg2);
+        e1 = abcd;
+        msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+        msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+        msg0 = _mm_xor_si128(msg0, msg2);
+
+        /* Rounds 28-31. */
+        e1 = _mm_sha1nexte_epu32(e1, msg3);
+        e0 = abcd;
+        msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+        msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+        msg1 = _mm_xor_si128(msg1, msg3);
+
+        /* Rounds 32-35. */
+        e0 = _mm_sha1nexte_epu32(e0, msg0);
+        e1 = abcd;
+        msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+        msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+        msg2 = _mm_xor_si128(msg2, msg0);
+
+        /* Rounds 36-39. */
+        e1 = _mm_sha1nexte_epu32(e1, msg1);
+        e0 = abcd;
+        msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+        msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+        msg3 = _mm_xor_si128(msg3, msg1);
+
+        /* Rounds 40-43. */
+        e0 = _mm_sha1nexte_epu32(e0, msg2);
+        e1 = abcd;
+        msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+        msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+        msg0 = _mm_xor_si128(msg0, msg2);
+
+        /* Rounds 44-47. */
+        e1 = _mm_sha1nexte_epu32(e1, msg3);
+        e0 = abcd;
+        msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+        msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+        msg1 = _mm_xor_si128(msg1, msg3);
+
+        /* Rounds 48-51. */
+        e0 = _mm_sha1nexte_epu32(e0, msg0);
+        e1 = abcd;
+        msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+        msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+        msg2 = _mm_xor_si128(msg2, msg0);
+
+        /* Rounds 52-55. */
+        e1 = _mm_sha1nexte_epu32(e1, msg1);
+        e0 = abcd;
+        msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+        msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+        msg3 = _mm_xor_si128(msg3, msg1);
+
+        /* Rounds 56-59. */
+        e0 = _mm_sha1nexte_epu32(e0, msg2);
+        e1 = abcd;
+        msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+        msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+        msg0 = _mm_xor_si128(msg0, msg2);
+
+        /* Rounds 60-63. */
+        e1 = _mm_sha1nexte_epu32(e1, msg3);
+        e0 = abcd;
+        msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+        msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+        msg1 = _mm_xor_si128(msg1, msg3);
+
+        /* Rounds 64-67. */
+        e0 = _mm_sha1nexte_epu32(e0, msg0);
+        e1 = abcd;
+        msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+        msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+        msg2 = _mm_xor_si128(msg2, msg0);
+
+        /* Rounds 68-71. */
+        e1 = _mm_sha1nexte_epu32(e1, msg1);
+        e0 = abcd;
+        msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+        msg3 = _mm_xor_si128(msg3, msg1);
+
+        /* Rounds 72-75. */
+        e0 = _mm_sha1nexte_epu32(e0, msg2);
+        e1 = abcd;
+        msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+
+        /* Rounds 76-79. */
+        e1 = _mm_sha1nexte_epu32(e1, msg3);
+        e0 = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+
+        e0 = _mm_sha1nexte_epu32(e0, e0_save);
+        abcd = _mm_add_epi32(abcd, abcd_save);
+
+        b_p += 64;
+        blocks--;
+    }
+
+    abcd = _mm_shuffle_epi32(abcd, 0x1b);
+    _mm_storeu_si128((__m128i *)h_p, abcd);
+    h_p[4] = _mm_extract_epi32(e0, 3);
+}
+
+static int hardware_available(void)
+{
+    __builtin_cpu_init();
+
+    return (__builtin_cpu_supports("sha")
+            && __builtin_cpu_supports("sse4.1"));
+}
+
+#elif defined(SHA1_ARMV8)
+
+/**
+ * Use the ARMv8 SHA1 instructions, four rounds per instruction. The
+ * message schedule is expanded in C.
+ */
+#if defined(ARCH_LINUX)
+__attribute__((target("+crypto")))
+#endif
+static void blocks_update_hardware(uint32_t *h_p,
+                                   const uint8_t *b_p,
+                                   size_t blocks)
+{
+    static const uint32_t k[4] = {
+        0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xca62c1d6
+    };
+    uint32x4_t abcd;
+    uint32x4_t abcd_save;
+    uint32x4_t wk;
+    uint32_t e;
+    uint32_t e_next;
+    uint32_t e_save;
+    uint32_t w[80];
+    int i;
+
+    abcd = vld1q_u32(h_p);
+    e = h_p[4];
+
+    while (blocks > 0) {
+        abcd_save = abcd;
+        e_save = e;
+
+        for (i = 0; i < 16; i++) {
+            w[i] = load_be32(&b_p[4 * i]);
+        }
+
+        for (i = 16; i < 80; i++) {
+            w[i] = rotateleft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        for (i = 0; i < 80; i += 4) {
+            wk = vaddq_u32(vld1q_u32(&w[i]), vdupq_n_u32(k[i / 20]));
+            e_next = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+
+            if (i < 20) {
+                abcd = vsha1cq_u32(abcd, e, wk);
+            } else if (i < 40) {
+                abcd = vsha1pq_u32(abcd, e, wk);
+            } else if (i < 60) {
+                abcd = vsha1mq_u32(abcd, e, wk);
+            } else {
+                abcd = vsha1pq_u32(abcd, e, wk);
+            }
+
+            e = e_next;
+        }
+
+        abcd = vaddq_u32(abcd, abcd_save);
+        e += e_save;
+        b_p += 64;
+        blocks--;
+    }
+
+    vst1q_u32(h_p, abcd);
+    h_p[4] = e;
+}
+
+static int hardware_available(void)
+{
+#if defined(ARCH_LINUX)
+    return ((getauxval(AT_HWCAP) & HWCAP_SHA1) != 0);
+#else
+    return (1);
+#endif
+}
+
+#endif
+
+static void implementation_init(void)
+{
+#if defined(SHA1_SHANI) || defined(SHA1_ARMV8)
+    if (hardware_available()) {
+        implementation = SHA1_IMPLEMENTATION_HARDWARE;
+        blocks_update = blocks_update_hardware;
+
+        return;
+    }
+#endif
+
+    implementation = SHA1_IMPLEMENTATION_C;
+    blocks_update = blocks_update_c;
+}
+
+static inline lanes_t lanes_rotateleft(lanes_t value, int positions)
+{
+    return ((value << positions) | (value >> (32 - positions)));
+}
+
+/**
+ * One block of SHA1 in each lane.
+ */
+static void lanes_block_update(lanes_t *h_p, lanes_t *w_p)
+{
+    lanes_t a, b, c, d, e, f, t;
+    lanes_t w;
+    int i;
+
+    a = h_p[0];
+    b = h_p[1];
+    c = h_p[2];
+    d = h_p[3];
+    e = h_p[4];
+
+    for (i = 0; i < 80; i++) {
+        if (i < 16) {
+            w = w_p[i];
+        } else {
+            w = lanes_rotateleft(w_p[(i - 3) & 15]
+                                 ^ w_p[(i - 8) & 15]
+                                 ^ w_p[(i - 14) & 15]
+                                 ^ w_p[i & 15],
+                                 1);
+            w_p[i & 15] = w;
+        }
+
+        if (i < 20) {
+            f = ((b & c) ^ (~b & d));
+            f += 0x5a827999;
+        } else if (i < 40) {
+            f = (b ^ c ^ d);
+            f += 0x6ed9eba1;
+        } else if (i < 60) {
+            f = ((b & c) ^ (b & d) ^ (c & d));
+            f += 0x8f1bbcdc;
+        } else {
+            f = (b ^ c ^ d);
+            f += 0xca62c1d6;
+        }
+
+        t = lanes_rotateleft(a, 5) + f + e + w;
+        e = d;
+        d = c;
+        c = lanes_rotateleft(b, 30);
+        b = a;
+        a = t;
+    }
+
+    h_p[0] += a;
+    h_p[1] += b;
+    h_p[2] += c;
+    h_p[3] += d;
+    h_p[4] += e;
+}
+
+/**
+ * Hash up to MULTI_LANES messages, one message per lane. Lanes whose
+ * message has no more blocks keep their state.
+ */
+static void lanes_digest(struct iov_t *messages_p,
+                         uint8_t *hashes_p,
+                         int length)
+{
+    static const uint32_t h_init[5] = {
+        0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0
+    };
+    uint8_t tails[MULTI_LANES][128];
+    size_t full_blocks[MULTI_LANES];
+    size_t blocks[MULTI_LANES];
+    size_t max_blocks;
+    size_t size;
+    size_t j;
+    const uint8_t *block_p;
+    lanes_t h[5];
+    lanes_t h_save[5];
+    lanes_t w[16];
+    lanes_t active;
+    int lane;
+    int i;
+
+    max_blocks = 0;
+
+    for (lane = 0; lane < length; lane++) {
+        size = messages_p[lane].size;
+        full_blocks[lane] = (size / 64);
+        blocks[lane] = ((size + 8) / 64 + 1);
+        size %= 64;
+        memset(&tails[lane][0], 0, sizeof(tails[lane]));
+        memcpy(&tails[lane][0],
+               (uint8_t *)messages_p[lane].buf_p + 64 * full_blocks[lane],
+               size);
+        tails[lane][size] = 0x80;
+        size = 64 * (blocks[lane] - full_blocks[lane]);
+
+        for (i = 0; i < 8; i++) {
+            tails[lane][size - 1 - i] = ((8 * (uint64_t)messages_p[lane].size)
+                                         >> (8 * i));
+        }
+
+        max_blocks = MAX(max_blocks, blocks[lane]);
+    }
+
+    for (i = 0; i < 5; i++) {
+        for (lane = 0; lane < MULTI_LANES; lane++) {
+            h[i][lane] = h_init[i];
+        }
+    }
+
+    for (j = 0; j < max_blocks; j++) {
+        for (lane = 0; lane < MULTI_LANES; lane++) {
+            if ((lane < length) && (j < blocks[lane])) {
+                if (j < full_blocks[lane]) {
+                    block_p = ((uint8_t *)messages_p[lane].buf_p + 64 * j);
+                } else {
+                    block_p = &tails[lane][64 * (j - full_blocks[lane])];
+                }
+
+                for (i = 0; i < 16; i++) {
+                    w[i][lane] = load_be32(&block_p[4 * i]);
+                }
+
+                active[lane] = 0xffffffff;
+            } else {
+                for (i = 0; i < 16; i++) {
+                    w[i][lane] = 0;
+                }
+
+                active[lane] = 0;
+            }
+        }
+
+        memcpy(&h_save[0], &h[0], sizeof(h_save));
+        lanes_block_update(&h[0], &w[0]);
+
+        for (i = 0; i < 5; i++) {
+            h[i] = ((h[i] & active) | (h_save[i] & ~active));
+        }
+    }
+
+    for (lane = 0; lane < length; lane++) {
+        for (i = 0; i < 5; i++) {
+            hashes_p[20 * lane + 4 * i + 0] = (h[i][lane] >> 24);
+            hashes_p[20 * lane + 4 * i + 1] = (h[i][lane] >> 16);
+            hashes_p[20 * lane + 4 * i + 2] = (h[i][lane] >> 8);
+            hashes_p[20 * lane + 4 * i + 3] = h[i][lane];
+        }
+    }
 }
 
 int sha1_init(struct sha1_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
 
+    if (implementation < 0) {
+        implementation_init();
+    }
+
     self_p->block.size = 0;
     self_p->h[0] = 0x67452301;
     self_p->h[1] = 0xefcdab89;
@@ -134,17 +626,16 @@ int sha1_update(struct sha1_t *self_p,
             memcpy(&self_p->block.buf[self_p->block.size], b_p, temp);
             size -= temp;
             b_p += temp;
-            block_update(self_p, self_p->block.buf);
+            blocks_update(self_p->h, self_p->block.buf, 1);
             self_p->block.size = 0;
         }
     }
 
-    /* Main loop. */
-    while (size >= 64) {
-        memcpy(&self_p->block.buf[0], b_p, 64);
-        block_update(self_p, self_p->block.buf);
-        size -= 64;
-        b_p += 64;
+    /* Main loop. All whole blocks straight from the input buffer. */
+    if (size >= 64) {
+        blocks_update(self_p->h, b_p, size / 64);
+        b_p += (size & ~(size_t)63);
+        size %= 64;
     }
 
     /* Epilogue: Save left over block in buffer. */
@@ -180,7 +671,7 @@ int sha1_digest(struct sha1_t *self_p,
             memset(&self_p->block.buf[i], 0, 64 - i);
         }
 
-        block_update(self_p, self_p->block.buf);
+        blocks_update(self_p->h, self_p->block.buf, 1);
         memset(self_p->block.buf, 0, 56);
     }
 
@@ -189,7 +680,7 @@ int sha1_digest(struct sha1_t *self_p,
         self_p->block.buf[56 + i] = ((8 * self_p->size) >> (56 - 8 * i));
     }
 
-    block_update(self_p, self_p->block.buf);
+    blocks_update(self_p->h, self_p->block.buf, 1);
 
     /* Copy the hash to the output buffer. */
     for (i = 0; i < membersof(self_p->h); i++) {
@@ -200,3 +691,84 @@ int sha1_digest(struct sha1_t *self_p,
 
     return (0);
 }
+
+int sha1_digest_multi(struct iov_t *messages_p,
+                      uint8_t *hashes_p,
+                      int length)
+{
+    ASSERTN(messages_p != NULL, EINVAL);
+    ASSERTN(hashes_p != NULL, EINVAL);
+    ASSERTN(length >= 0, EINVAL);
+
+    struct sha1_t sha1;
+    int lanes;
+
+    if (implementation < 0) {
+        implementation_init();
+    }
+
+    /* The SHA instructions hash one message faster than the portable
+       lanes hash four. */
+    if (implementation == SHA1_IMPLEMENTATION_HARDWARE) {
+        while (length > 0) {
+            sha1_init(&sha1);
+            sha1_update(&sha1, messages_p->buf_p, messages_p->size);
+            sha1_digest(&sha1, hashes_p);
+            messages_p++;
+            hashes_p += 20;
+            length--;
+        }
+
+        return (0);
+    }
+
+    while (length > 0) {
+        lanes = MIN(length, MULTI_LANES);
+        lanes_digest(messages_p, hashes_p, lanes);
+        messages_p += lanes;
+        hashes_p += (20 * lanes);
+        length -= lanes;
+    }
+
+    return (0);
+}
+
+int sha1_set_implementation(int value)
+{
+    if (implementation < 0) {
+        implementation_init();
+    }
+
+    switch (value) {
+
+    case SHA1_IMPLEMENTATION_C:
+        blocks_update = blocks_update_c;
+        break;
+
+#if defined(SHA1_SHANI) || defined(SHA1_ARMV8)
+    case SHA1_IMPLEMENTATION_HARDWARE:
+        if (!hardware_available()) {
+            return (-ENOSYS);
+        }
+
+        blocks_update = blocks_update_hardware;
+        break;
+#endif
+
+    default:
+        return (-ENOSYS);
+    }
+
+    implementation = value;
+
+    return (0);
+}
+
+int sha1_get_implementation(void)
+{
+    if (implementation < 0) {
+        implementation_init();
+    }
+
+    return (implementation);
+}
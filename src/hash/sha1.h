@@ -31,6 +31,13 @@
 
 #include "simba.h"
 
+/** Plain C implementation. */
+#define SHA1_IMPLEMENTATION_C                               0
+
+/** CPU instructions; the x86 SHA extensions or the ARMv8 SHA1
+    instructions. */
+#define SHA1_IMPLEMENTATION_HARDWARE                        1
+
 struct sha1_t {
     struct {
         uint8_t buf[64]; 
@@ -77,4 +84,40 @@ int sha1_update(struct sha1_t *self_p,
 int sha1_digest(struct sha1_t *self_p,
                 uint8_t *hash_p);
 
+/**
+ * Calculate the digests of given independent messages. With the C
+ * implementation messages are hashed four at a time in SIMD lanes,
+ * and messages of similar size are hashed most efficiently. With the
+ * hardware implementation messages are hashed one by one, as that is
+ * faster.
+ *
+ * @param[in] messages_p Messages to hash.
+ * @param[out] hashes_p Output buffer of 20 * length bytes. The hash of
+ *                      message i is written at offset 20 * i.
+ * @param[in] length Number of messages.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sha1_digest_multi(struct iov_t *messages_p,
+                      uint8_t *hashes_p,
+                      int length);
+
+/**
+ * Select the implementation used to hash blocks. The fastest
+ * available implementation is used by default.
+ *
+ * @param[in] implementation One of ``SHA1_IMPLEMENTATION_*``.
+ *
+ * @return zero(0) or -ENOSYS if given implementation is not available
+ *         on this CPU or in this configuration.
+ */
+int sha1_set_implementation(int implementation);
+
+/**
+ * Get the implementation used to hash blocks.
+ *
+ * @return One of ``SHA1_IMPLEMENTATION_*``.
+ */
+int sha1_get_implementation(void);
+
 #endif
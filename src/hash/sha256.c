@@ -0,0 +1,565 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#if CONFIG_SHA_HARDWARE == 1
+#    if defined(ARCH_LINUX) && (defined(__x86_64__) || defined(__i386__))
+#        define SHA256_SHANI
+#        include <immintrin.h>
+#    elif defined(ARCH_LINUX) && defined(__aarch64__)
+#        define SHA256_ARMV8
+#        include <arm_neon.h>
+#        include <sys/auxv.h>
+#        include <asm/hwcap.h>
+#    elif defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2)
+#        define SHA256_ARMV8
+#        include <arm_neon.h>
+#    endif
+#endif
+
+typedef void (*blocks_update_t)(uint32_t *h_p,
+                                const uint8_t *b_p,
+                                size_t blocks);
+
+static const uint32_t k[64] __attribute__((aligned(16))) = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static int8_t implementation = -1;
+static blocks_update_t blocks_update;
+
+static inline uint32_t rotateright(uint32_t value, int positions)
+{
+    return ((value >> positions) | (value << (32 - positions)));
+}
+
+static inline uint32_t load_be32(const uint8_t *b_p)
+{
+    return (((uint32_t)b_p[0] << 24)
+            | ((uint32_t)b_p[1] << 16)
+            | ((uint32_t)b_p[2] << 8)
+            | ((uint32_t)b_p[3]));
+}
+
+static void schedule(uint32_t *w_p, const uint8_t *block_p)
+{
+    int i;
+    uint32_t s0;
+    uint32_t s1;
+
+    for (i = 0; i < 16; i++) {
+        w_p[i] = load_be32(&block_p[4 * i]);
+    }
+
+    for (i = 16; i < 64; i++) {
+        s0 = (rotateright(w_p[i - 15], 7)
+              ^ rotateright(w_p[i - 15], 18)
+              ^ (w_p[i - 15] >> 3));
+        s1 = (rotateright(w_p[i - 2], 17)
+              ^ rotateright(w_p[i - 2], 19)
+              ^ (w_p[i - 2] >> 10));
+        w_p[i] = (w_p[i - 16] + s0 + w_p[i - 7] + s1);
+    }
+}
+
+static void blocks_update_c(uint32_t *h_p,
+                            const uint8_t *b_p,
+                            size_t blocks)
+{
+    uint32_t a, b, c, d, e, f, g, h, t1, t2, w[64];
+    int i;
+
+    while (blocks > 0) {
+        schedule(&w[0], b_p);
+
+        a = h_p[0];
+        b = h_p[1];
+        c = h_p[2];
+        d = h_p[3];
+        e = h_p[4];
+        f = h_p[5];
+        g = h_p[6];
+        h = h_p[7];
+
+        for (i = 0; i < 64; i++) {
+            t1 = (h
+                  + (rotateright(e, 6)
+                     ^ rotateright(e, 11)
+                     ^ rotateright(e, 25))
+                  + ((e & f) ^ (~e & g))
+                  + k[i]
+                  + w[i]);
+            t2 = ((rotateright(a, 2) ^ rotateright(a, 13) ^ rotateright(a, 22))
+                  + ((a & b) ^ (a & c) ^ (b & c)));
+            h = g;
+            g = f;
+            f = e;
+            e = (d + t1);
+            d = c;
+            c = b;
+            b = a;
+            a = (t1 + t2);
+        }
+
+        h_p[0] += a;
+        h_p[1] += b;
+        h_p[2] += c;
+        h_p[3] += d;
+        h_p[4] += e;
+        h_p[5] += f;
+        h_p[6] += g;
+        h_p[7] += h;
+
+        b_p += 64;
+        blocks--;
+    }
+}
+
+#if defined(SHA256_SHANI)
+
+/**
+ * Use the x86 SHA extensions, two rounds per instruction.
+ */
+__attribute__((target("sha,ssse3,sse4.1")))
+static void blocks_update_hardware(uint32_t *h_p,
+                                   const uint8_t *b_p,
+                                   size_t blocks)
+{
+    __m128i state0, state1, abef_save, cdgh_save;
+    __m128i msg, tmp, msg0, msg1, msg2, msg3;
+    __m128i mask;
+
+    mask = _mm_set_epi64x(0x0c0d0e0f08090a0bull, 0x0405060700010203ull);
+
+    /* Rearrange the state to ABEF and CDGH. */
+    tmp = _mm_loadu_si128((__m128i *)&h_p[0]);
+    state1 = _mm_loadu_si128((__m128i *)&h_p[4]);
+    tmp = _mm_shuffle_epi32(tmp, 0xb1);
+    state1 = _mm_shuffle_epi32(state1, 0x1b);
+    state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+
+    while (blocks > 0) {
+        abef_save = state0;
+        cdgh_save = state1;
+
+        /* Rounds 0-3. */
+        msg0 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)&b_p[0]), mask);
+        msg = _mm_add_epi32(msg0, _mm_loadu_si128((__m128i *)&k[0]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        msg = _mm_shuffle_epi32(msg, 0x0e);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+        /* Rounds 4-7. */
+        msg1 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)&b_p[16]), mask);
+        msg = _mm_add_epi32(msg1, _mm_loadu_si128((__m128i *)&k[4]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        msg = _mm_shuffle_epi32(msg, 0x0e);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+        msg0 = _mm_sha256msg1_epu32(msg0, msg1);
+
+        /* Rounds 8-11. */
+        msg2 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)&b_p[32]), mask);
+        msg = _mm_add_epi32(msg2, _mm_loadu_si128((__m128i *)&k[8]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        msg = _mm_shuffle_epi32(msg, 0x0e);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+        msg1 = _mm_sha256msg1_epu32(msg1, msg2);
+
+        /* Rounds 12-15. */
+        msg3 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)&b_p[48]), mask);
+        msg = _mm_add_epi32(msg3, _mm_loadu_si128((__m128i *)&k[12]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        tmp = _mm_alignr_epi8(msg3, msg2, 4);
+        msg0 = _mm_add_epi32(msg0, tmp);
+        msg0 = _mm_sha256msg2_epu32(msg0, msg3);
+        msg = _mm_shuffle_epi32(msg, 0x0e);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+        msg2 = _mm_sha256msg1_epu32(msg2, msg3);
+
+        /* Rounds 16-19. */
+        msg = _mm_add_epi32(msg0, _mm_loadu_si128((__m128i *)&k[16]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        tmp = _mm_alignr_epi8(msg0, msg3, 4);
+        msg1 = _mm_add_epi32(msg1, tmp);
+        msg1 = _mm_sha256msg2_epu32(msg1, msg0);
+        msg = _mm_shuffle_epi32(msg, 0x0e);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+        msg3 = _mm_sha256msg1_epu32(msg3, msg0);
+
+        /* Rounds 20-23. */
+        msg = _mm_add_epi32(msg1, _mm_loadu_si128((__m128i *)&k[20]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        tmp = _mm_alignr_epi8(msg1, msg0, 4);
+        msg2 = _mm_add_epi32(msg2, tmp);
+        msg2 = _mm_sha256msg2_epu32(msg2, msg1);
+        msg = _mm_shuffle_epi32(msg, 0x0e);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+        msg0 = _mm_sha256msg1_epu32(msg0, msg1);
+
+        /* Rounds 24-27. */
+        msg = _mm_add_epi32(msg2, _mm_loadu_si128((__m128i *)&k[24]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        tmp = _mm_alignr_epi8(msg2, msg1, 4);
+        msg3 = _mm_add_epi32(msg3, tmp);
+        msg3 = _mm_sha256msg2_epu32(msg3, msg2);
+        msg = _mm_shuffle_epi32(msg, 0x0e);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+        msg1 = _mm_sha256msg1_epu32(msg1, msg2);
+
+        /* Rounds 28-31. */
+        msg = _mm_add_epi32(msg3, _mm_loadu_si128((__m128i *)&k[28]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        tmp = _mm_alignr_epi8(msg3, msg2, 4);
+        msg0 = _mm_add_epi32(msg0, tmp);
+        msg0 = _mm_sha256msg2_epu32(msg0, msg3);
+        msg = _mm_shuffle_epi32(msg, 0x0e);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+        msg2 = _mm_sha256msg1_epu32(msg2, msg3);
+
+        /* Rounds 32-35. */
+        msg = _mm_add_epi32(msg0, _mm_loadu_si128((__m128i *)&k[32]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        tmp = _mm_alignr_epi8(msg0, msg3, 4);
+        msg1 = _mm_add_epi32(msg1, tmp);
+        msg1 = _mm_sha256msg2_epu32(msg1, msg0);
+        msg = _mm_shuffle_epi32(msg, 0x0e);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+        msg3 = _mm_sha256msg1_epu32(msg3, msg0);
+
+        /* Rounds 36-39. */
+        msg = _mm_add_epi32(msg1, _mm_loadu_si128((__m128i *)&k[36]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        tmp = _mm_alignr_epi8(msg1, msg0, 4);
+        msg2 = _mm_add_epi32(msg2, tmp);
+        msg2 = _mm_sha256msg2_epu32(msg2, msg1);
+        msg = _mm_shuffle_epi32(msg, 0x0e);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+        msg0 = _mm_sha256msg1_epu32(msg0, msg1);
+
+        /* Rounds 40-43. */
+        msg = _mm_add_epi32(msg2, _mm_loadu_si128((__m128i *)&k[40]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        tmp = _mm_alignr_epi8(msg2, msg1, 4);
+        msg3 = _mm_add_epi32(msg3, tmp);
+        msg3 = _mm_sha256msg2_epu32(msg3, msg2);
+        msg = _mm_shuffle_epi32(msg, 0x0e);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+        msg1 = _mm_sha256msg1_epu32(msg1, msg2);
+
+        /* Rounds 44-47. */
+        msg = _mm_add_epi32(msg3, _mm_loadu_si128((__m128i *)&k[44]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        tmp = _mm_alignr_epi8(msg3, msg2, 4);
+        msg0 = _mm_add_epi32(msg0, tmp);
+        msg0 = _mm_sha256msg2_epu32(msg0, msg3);
+        msg = _mm_shuffle_epi32(msg, 0x0e);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+        msg2 = _mm_sha256msg1_epu32(msg2, msg3);
+
+        /* Rounds 48-51. */
+        msg = _mm_add_epi32(msg0, _mm_loadu_si128((__m128i *)&k[48]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        tmp = _mm_alignr_epi8(msg0, msg3, 4);
+        msg1 = _mm_add_epi32(msg1, tmp);
+        msg1 = _mm_sha256msg2_epu32(msg1, msg0);
+        msg = _mm_shuffle_epi32(msg, 0x0e);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+        msg3 = _mm_sha256msg1_epu32(msg3, msg0);
+
+        /* Rounds 52-55. */
+        msg = _mm_add_epi32(msg1, _mm_loadu_si128((__m128i *)&k[52]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        tmp = _mm_alignr_epi8(msg1, msg0, 4);
+        msg2 = _mm_add_epi32(msg2, tmp);
+        msg2 = _mm_sha256msg2_epu32(msg2, msg1);
+        msg = _mm_shuffle_epi32(msg, 0x0e);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+        /* Rounds 56-59. */
+        msg = _mm_add_epi32(msg2, _mm_loadu_si128((__m128i *)&k[56]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        tmp = _mm_alignr_epi8(msg2, msg1, 4);
+        msg3 = _mm_add_epi32(msg3, tmp);
+        msg3 = _mm_sha256msg2_epu32(msg3, msg2);
+        msg = _mm_shuffle_epi32(msg, 0x0e);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+        /* Rounds 60-63. */
+        msg = _mm_add_epi32(msg3, _mm_loadu_si128((__m128i *)&k[60]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        msg = _mm_shuffle_epi32(msg, 0x0e);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+
+        b_p += 64;
+        blocks--;
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1b);
+    state1 = _mm_shuffle_epi32(state1, 0xb1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xf0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+    _mm_storeu_si128((__m128i *)&h_p[0], state0);
+    _mm_storeu_si128((__m128i *)&h_p[4], state1);
+}
+
+static int hardware_available(void)
+{
+    __builtin_cpu_init();
+
+    return (__builtin_cpu_supports("sha")
+            && __builtin_cpu_supports("sse4.1"));
+}
+
+#elif defined(SHA256_ARMV8)
+
+/**
+ * Use the ARMv8 SHA256 instructions, four rounds per instruction
+ * pair. The message schedule is expanded in C.
+ */
+#if defined(ARCH_LINUX)
+__attribute__((target("+crypto")))
+#endif
+static void blocks_update_hardware(uint32_t *h_p,
+                                   const uint8_t *b_p,
+                                   size_t blocks)
+{
+    uint32x4_t state0, state1, state0_save, state1_save, abcd, wk;
+    uint32_t w[64];
+    int i;
+
+    state0 = vld1q_u32(&h_p[0]);
+    state1 = vld1q_u32(&h_p[4]);
+
+    while (blocks > 0) {
+        state0_save = state0;
+        state1_save = state1;
+        schedule(&w[0], b_p);
+
+        for (i = 0; i < 64; i += 4) {
+            wk = vaddq_u32(vld1q_u32(&w[i]), vld1q_u32(&k[i]));
+            abcd = state0;
+            state0 = vsha256hq_u32(state0, state1, wk);
+            state1 = vsha256h2q_u32(state1, abcd, wk);
+        }
+
+        state0 = vaddq_u32(state0, state0_save);
+        state1 = vaddq_u32(state1, state1_save);
+        b_p += 64;
+        blocks--;
+    }
+
+    vst1q_u32(&h_p[0], state0);
+    vst1q_u32(&h_p[4], state1);
+}
+
+static int hardware_available(void)
+{
+#if defined(ARCH_LINUX)
+    return ((getauxval(AT_HWCAP) & HWCAP_SHA2) != 0);
+#else
+    return (1);
+#endif
+}
+
+#endif
+
+static void implementation_init(void)
+{
+#if defined(SHA256_SHANI) || defined(SHA256_ARMV8)
+    if (hardware_available()) {
+        implementation = SHA256_IMPLEMENTATION_HARDWARE;
+        blocks_update = blocks_update_hardware;
+
+        return;
+    }
+#endif
+
+    implementation = SHA256_IMPLEMENTATION_C;
+    blocks_update = blocks_update_c;
+}
+
+int sha256_init(struct sha256_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    if (implementation < 0) {
+        implementation_init();
+    }
+
+    self_p->block.size = 0;
+    self_p->h[0] = 0x6a09e667;
+    self_p->h[1] = 0xbb67ae85;
+    self_p->h[2] = 0x3c6ef372;
+    self_p->h[3] = 0xa54ff53a;
+    self_p->h[4] = 0x510e527f;
+    self_p->h[5] = 0x9b05688c;
+    self_p->h[6] = 0x1f83d9ab;
+    self_p->h[7] = 0x5be0cd19;
+    self_p->size = 0;
+
+    return (0);
+}
+
+int sha256_update(struct sha256_t *self_p,
+                  const void *buf_p,
+                  size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    uint32_t temp;
+    const uint8_t *b_p = buf_p;
+
+    self_p->size += size;
+
+    /* Prologue: Fill the buffer. */
+    if (self_p->block.size > 0) {
+        if ((self_p->block.size + size) >= 64) {
+            temp = (64 - self_p->block.size);
+            memcpy(&self_p->block.buf[self_p->block.size], b_p, temp);
+            size -= temp;
+            b_p += temp;
+            blocks_update(self_p->h, self_p->block.buf, 1);
+            self_p->block.size = 0;
+        }
+    }
+
+    /* Main loop. All whole blocks straight from the input buffer. */
+    if (size >= 64) {
+        blocks_update(self_p->h, b_p, size / 64);
+        b_p += (size & ~(size_t)63);
+        size %= 64;
+    }
+
+    /* Epilogue: Save left over block in buffer. */
+    if (size > 0) {
+        memcpy(&self_p->block.buf[self_p->block.size], b_p, size);
+        self_p->block.size += size;
+    }
+
+    return (0);
+}
+
+int sha256_digest(struct sha256_t *self_p,
+                  uint8_t *hash_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(hash_p != NULL, EINVAL);
+
+    int i;
+
+    i = self_p->block.size;
+
+    /* Add the last byte 0x80 and zero-padding. */
+    self_p->block.buf[i++] = 0x80;
+
+    if (i > 56) {
+        memset(&self_p->block.buf[i], 0, 64 - i);
+        blocks_update(self_p->h, self_p->block.buf, 1);
+        i = 0;
+    }
+
+    memset(&self_p->block.buf[i], 0, 56 - i);
+
+    /* Append the message length and do the last block update. */
+    for (i = 0; i < 8; i++) {
+        self_p->block.buf[56 + i] = ((8 * self_p->size) >> (56 - 8 * i));
+    }
+
+    blocks_update(self_p->h, self_p->block.buf, 1);
+
+    /* Copy the hash to the output buffer. */
+    for (i = 0; i < 8; i++) {
+        hash_p[4 * i + 0] = (self_p->h[i] >> 24);
+        hash_p[4 * i + 1] = (self_p->h[i] >> 16);
+        hash_p[4 * i + 2] = (self_p->h[i] >> 8);
+        hash_p[4 * i + 3] = self_p->h[i];
+    }
+
+    return (0);
+}
+
+int sha256_set_implementation(int value)
+{
+    if (implementation < 0) {
+        implementation_init();
+    }
+
+    switch (value) {
+
+    case SHA256_IMPLEMENTATION_C:
+        blocks_update = blocks_update_c;
+        break;
+
+#if defined(SHA256_SHANI) || defined(SHA256_ARMV8)
+    case SHA256_IMPLEMENTATION_HARDWARE:
+        if (!hardware_available()) {
+            return (-ENOSYS);
+        }
+
+        blocks_update = blocks_update_hardware;
+        break;
+#endif
+
+    default:
+        return (-ENOSYS);
+    }
+
+    implementation = value;
+
+    return (0);
+}
+
+int sha256_get_implementation(void)
+{
+    if (implementation < 0) {
+        implementation_init();
+    }
+
+    return (implementation);
+}
@@ -0,0 +1,1034 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#define TYPE_SINGLE_FRAME                          0
+#define TYPE_FIRST_FRAME                           1
+#define TYPE_CONSECUTIVE_FRAME                     2
+#define TYPE_FLOW_CONTROL_FRAME                    3
+
+#define FLOW_STATUS_CONTINUE_TO_SEND               0
+#define FLOW_STATUS_WAIT                           1
+#define FLOW_STATUS_OVERFLOW                       2
+
+#define CLASSIC_DL                                 8
+#define FD_DL                                     64
+
+/* Largest message length encoded in the 12 bits first frame length
+   field. Longer messages uses the 32 bits escape sequence. */
+#define FIRST_FRAME_LENGTH_MAX                  4095
+
+#define PADDING                                 0xcc
+
+#define SESSION_EVENT_RX_TIMEOUT              (1 << 0)
+#define SESSION_EVENT_TX_TIMEOUT              (1 << 1)
+
+#define EVENT_TIMEOUT                         (1 << 0)
+
+enum rx_state_t {
+    rx_state_idle_t = 0,
+    rx_state_receiving_t
+};
+
+enum tx_state_t {
+    tx_state_idle_t = 0,
+    tx_state_ready_t,
+    tx_state_wait_flow_control_t,
+    tx_state_wait_separation_time_t
+};
+
+/* Valid CAN-FD frame data sizes larger than eight bytes. */
+static const uint8_t fd_sizes[] = {
+    12, 16, 20, 24, 32, 48, 64
+};
+
+static int bucket_index(uint32_t id)
+{
+    return ((id ^ (id >> 8)) & (CONFIG_ISOTP_MANAGER_BUCKETS - 1));
+}
+
+static struct isotp_manager_session_t *session_lookup(
+    struct isotp_manager_t *self_p,
+    uint32_t id)
+{
+    struct isotp_manager_session_t *session_p;
+
+    session_p = self_p->buckets[bucket_index(id)];
+
+    while (session_p != NULL) {
+        if (session_p->rx_id == id) {
+            break;
+        }
+
+        session_p = session_p->next_p;
+    }
+
+    return (session_p);
+}
+
+static uint8_t *pool_alloc(struct isotp_manager_t *self_p)
+{
+    uint8_t *buf_p;
+
+    buf_p = self_p->pool.free_p;
+
+    if (buf_p != NULL) {
+        memcpy(&self_p->pool.free_p, buf_p, sizeof(buf_p));
+    }
+
+    return (buf_p);
+}
+
+static void pool_free(struct isotp_manager_t *self_p, uint8_t *buf_p)
+{
+    memcpy(buf_p, &self_p->pool.free_p, sizeof(buf_p));
+    self_p->pool.free_p = buf_p;
+}
+
+/**
+ * Round given frame size up to the nearest valid CAN-FD frame size
+ * and pad the frame.
+ */
+static size_t frame_pad(uint8_t *buf_p, size_t size)
+{
+    size_t padded_size;
+    int i;
+
+    if (size <= CLASSIC_DL) {
+        return (size);
+    }
+
+    padded_size = FD_DL;
+
+    for (i = 0; i < membersof(fd_sizes); i++) {
+        if (size <= fd_sizes[i]) {
+            padded_size = fd_sizes[i];
+            break;
+        }
+    }
+
+    memset(&buf_p[size], PADDING, padded_size - size);
+
+    return (padded_size);
+}
+
+static void st_min_to_time(int st_min, struct time_t *time_p)
+{
+    time_p->seconds = 0;
+
+    if (st_min <= 0x7f) {
+        time_p->nanoseconds = (st_min * 1000000L);
+    } else if ((st_min >= 0xf1) && (st_min <= 0xf9)) {
+        time_p->nanoseconds = ((st_min - 0xf0) * 100000L);
+    } else {
+        /* Reserved values shall be interpreted as the longest
+           separation time. */
+        time_p->nanoseconds = 127000000L;
+    }
+}
+
+/**
+ * Add given session last in the ready list, unless already in it.
+ */
+static void ready_push_isr(struct isotp_manager_session_t *session_p)
+{
+    struct isotp_manager_t *self_p;
+
+    if (session_p->is_ready == 1) {
+        return;
+    }
+
+    self_p = session_p->manager_p;
+    session_p->is_ready = 1;
+    session_p->ready_next_p = NULL;
+
+    if (self_p->ready.tail_p == NULL) {
+        self_p->ready.head_p = session_p;
+    } else {
+        self_p->ready.tail_p->ready_next_p = session_p;
+    }
+
+    self_p->ready.tail_p = session_p;
+}
+
+static void ready_push(struct isotp_manager_session_t *session_p)
+{
+    sys_lock();
+    ready_push_isr(session_p);
+    sys_unlock();
+}
+
+static struct isotp_manager_session_t *ready_pop_isr(
+    struct isotp_manager_t *self_p)
+{
+    struct isotp_manager_session_t *session_p;
+
+    session_p = self_p->ready.head_p;
+
+    if (session_p != NULL) {
+        self_p->ready.head_p = session_p->ready_next_p;
+
+        if (self_p->ready.head_p == NULL) {
+            self_p->ready.tail_p = NULL;
+        }
+
+        session_p->is_ready = 0;
+    }
+
+    return (session_p);
+}
+
+static void ready_remove_isr(struct isotp_manager_session_t *session_p)
+{
+    struct isotp_manager_t *self_p;
+    struct isotp_manager_session_t *prev_p;
+    struct isotp_manager_session_t *curr_p;
+
+    if (session_p->is_ready == 0) {
+        return;
+    }
+
+    self_p = session_p->manager_p;
+    prev_p = NULL;
+    curr_p = self_p->ready.head_p;
+
+    while (curr_p != session_p) {
+        prev_p = curr_p;
+        curr_p = curr_p->ready_next_p;
+    }
+
+    if (prev_p == NULL) {
+        self_p->ready.head_p = session_p->ready_next_p;
+    } else {
+        prev_p->ready_next_p = session_p->ready_next_p;
+    }
+
+    if (self_p->ready.tail_p == session_p) {
+        self_p->ready.tail_p = prev_p;
+    }
+
+    /* The last session to serve in the ongoing process call is
+       removed. Serve up to the one before it instead. */
+    if (self_p->ready.last_p == session_p) {
+        self_p->ready.last_p = prev_p;
+    }
+
+    session_p->is_ready = 0;
+}
+
+/**
+ * Called from interrupt context when a session timer expires.
+ */
+static void on_timeout(struct isotp_manager_session_t *session_p,
+                       int event)
+{
+    uint32_t mask;
+
+    session_p->events |= event;
+    ready_push_isr(session_p);
+    mask = EVENT_TIMEOUT;
+    event_write_isr(&session_p->manager_p->event, &mask, sizeof(mask));
+}
+
+static void on_rx_timeout(void *arg_p)
+{
+    on_timeout(arg_p, SESSION_EVENT_RX_TIMEOUT);
+}
+
+static void on_tx_timeout(void *arg_p)
+{
+    on_timeout(arg_p, SESSION_EVENT_TX_TIMEOUT);
+}
+
+/**
+ * (Re)start given session timer. Any expiry of the previous timeout
+ * not yet processed is discarded.
+ */
+static void timer_restart(struct isotp_manager_session_t *session_p,
+                          struct timer_t *timer_p,
+                          const struct time_t *timeout_p,
+                          timer_callback_t callback,
+                          int event)
+{
+    sys_lock();
+    timer_stop_isr(timer_p);
+    session_p->events &= ~event;
+    timer_init(timer_p, timeout_p, callback, session_p, 0);
+    timer_start_isr(timer_p);
+    sys_unlock();
+}
+
+static void timer_cancel(struct isotp_manager_session_t *session_p,
+                         struct timer_t *timer_p,
+                         int event)
+{
+    sys_lock();
+    timer_stop_isr(timer_p);
+    session_p->events &= ~event;
+    sys_unlock();
+}
+
+static void rx_timer_restart(struct isotp_manager_session_t *session_p)
+{
+    struct time_t timeout;
+
+    timeout.seconds = (CONFIG_ISOTP_MANAGER_TIMEOUT_MS / 1000);
+    timeout.nanoseconds = (CONFIG_ISOTP_MANAGER_TIMEOUT_MS % 1000) * 1000000L;
+
+    timer_restart(session_p,
+                  &session_p->rx.timer,
+                  &timeout,
+                  on_rx_timeout,
+                  SESSION_EVENT_RX_TIMEOUT);
+}
+
+static void tx_timer_restart(struct isotp_manager_session_t *session_p,
+                             const struct time_t *timeout_p)
+{
+    struct time_t timeout;
+
+    if (timeout_p == NULL) {
+        timeout.seconds = (CONFIG_ISOTP_MANAGER_TIMEOUT_MS / 1000);
+        timeout.nanoseconds =
+            (CONFIG_ISOTP_MANAGER_TIMEOUT_MS % 1000) * 1000000L;
+        timeout_p = &timeout;
+    }
+
+    timer_restart(session_p,
+                  &session_p->tx.timer,
+                  timeout_p,
+                  on_tx_timeout,
+                  SESSION_EVENT_TX_TIMEOUT);
+}
+
+static int frame_write(struct isotp_manager_session_t *session_p,
+                       const uint8_t *buf_p,
+                       size_t size)
+{
+    struct isotp_manager_t *self_p;
+    int res;
+
+    self_p = session_p->manager_p;
+    res = self_p->write(self_p->write_arg_p, session_p->tx_id, buf_p, size);
+
+    if (res == 0) {
+        self_p->counters.frames_sent++;
+    }
+
+    return (res);
+}
+
+static void write_flow_control(struct isotp_manager_session_t *session_p,
+                               int flow_status)
+{
+    struct isotp_manager_t *self_p;
+    uint8_t buf[3];
+
+    self_p = session_p->manager_p;
+    buf[0] = ((TYPE_FLOW_CONTROL_FRAME << 4) | flow_status);
+    buf[1] = self_p->flow_control.block_size;
+    buf[2] = self_p->flow_control.st_min;
+    frame_write(session_p, &buf[0], sizeof(buf));
+}
+
+static void rx_abort(struct isotp_manager_session_t *session_p)
+{
+    if (session_p->rx.state != rx_state_receiving_t) {
+        return;
+    }
+
+    timer_cancel(session_p, &session_p->rx.timer, SESSION_EVENT_RX_TIMEOUT);
+    pool_free(session_p->manager_p, session_p->rx.buf_p);
+    session_p->rx.buf_p = NULL;
+    session_p->rx.state = rx_state_idle_t;
+}
+
+static void tx_complete(struct isotp_manager_session_t *session_p,
+                        int res)
+{
+    timer_cancel(session_p, &session_p->tx.timer, SESSION_EVENT_TX_TIMEOUT);
+    session_p->tx.state = tx_state_idle_t;
+    session_p->tx.buf_p = NULL;
+
+    if (res == 0) {
+        session_p->manager_p->counters.messages_sent++;
+    }
+
+    if (session_p->on_complete != NULL) {
+        session_p->on_complete(session_p, res);
+    }
+}
+
+static int input_single_frame(struct isotp_manager_session_t *session_p,
+                              const uint8_t *buf_p,
+                              size_t size)
+{
+    size_t length;
+    size_t offset;
+
+    length = (buf_p[0] & 0x0f);
+    offset = 1;
+
+    if (length == 0) {
+        /* CAN-FD single frame with the length in the second byte. */
+        if (size <= CLASSIC_DL) {
+            return (-EPROTO);
+        }
+
+        length = buf_p[1];
+        offset = 2;
+    } else if (size > CLASSIC_DL) {
+        return (-EPROTO);
+    }
+
+    if ((length == 0) || (length > size - offset)) {
+        return (-EPROTO);
+    }
+
+    /* A single frame terminates any ongoing reception. */
+    rx_abort(session_p);
+    session_p->manager_p->counters.messages_received++;
+    session_p->on_message(session_p, &buf_p[offset], length);
+
+    return (0);
+}
+
+static int input_first_frame(struct isotp_manager_session_t *session_p,
+                             const uint8_t *buf_p,
+                             size_t size)
+{
+    struct isotp_manager_t *self_p;
+    size_t length;
+    size_t offset;
+
+    self_p = session_p->manager_p;
+
+    if (size < CLASSIC_DL) {
+        return (-EPROTO);
+    }
+
+    length = (((buf_p[0] & 0x0f) << 8) | buf_p[1]);
+    offset = 2;
+
+    if (length == 0) {
+        length = (((uint32_t)buf_p[2] << 24)
+                  | ((uint32_t)buf_p[3] << 16)
+                  | ((uint32_t)buf_p[4] << 8)
+                  | buf_p[5]);
+        offset = 6;
+    }
+
+    if (length <= size - offset) {
+        return (-EPROTO);
+    }
+
+    rx_abort(session_p);
+
+    if (length > self_p->pool.buffer_size) {
+        self_p->counters.overflows++;
+        write_flow_control(session_p, FLOW_STATUS_OVERFLOW);
+
+        return (-EMSGSIZE);
+    }
+
+    session_p->rx.buf_p = pool_alloc(self_p);
+
+    if (session_p->rx.buf_p == NULL) {
+        self_p->counters.overflows++;
+        write_flow_control(session_p, FLOW_STATUS_OVERFLOW);
+
+        return (-ENOMEM);
+    }
+
+    memcpy(session_p->rx.buf_p, &buf_p[offset], size - offset);
+    session_p->rx.state = rx_state_receiving_t;
+    session_p->rx.size = length;
+    session_p->rx.offset = (size - offset);
+    session_p->rx.next_index = 1;
+    session_p->rx.block_counter = 0;
+    write_flow_control(session_p, FLOW_STATUS_CONTINUE_TO_SEND);
+    rx_timer_restart(session_p);
+
+    return (0);
+}
+
+static int input_consecutive_frame(struct isotp_manager_session_t *session_p,
+                                   const uint8_t *buf_p,
+                                   size_t size)
+{
+    struct isotp_manager_t *self_p;
+    uint8_t *message_p;
+    size_t length;
+    uint8_t block_size;
+
+    self_p = session_p->manager_p;
+
+    if (session_p->rx.state != rx_state_receiving_t) {
+        return (-EPROTO);
+    }
+
+    if ((buf_p[0] & 0x0f) != session_p->rx.next_index) {
+        rx_abort(session_p);
+
+        return (-EPROTO);
+    }
+
+    length = MIN(size - 1, session_p->rx.size - session_p->rx.offset);
+    memcpy(&session_p->rx.buf_p[session_p->rx.offset], &buf_p[1], length);
+    session_p->rx.offset += length;
+    session_p->rx.next_index++;
+    session_p->rx.next_index %= 16;
+
+    if (session_p->rx.offset == session_p->rx.size) {
+        timer_cancel(session_p,
+                     &session_p->rx.timer,
+                     SESSION_EVENT_RX_TIMEOUT);
+        message_p = session_p->rx.buf_p;
+        session_p->rx.buf_p = NULL;
+        session_p->rx.state = rx_state_idle_t;
+        self_p->counters.messages_received++;
+        session_p->on_message(session_p, message_p, session_p->rx.size);
+        pool_free(self_p, message_p);
+    } else {
+        block_size = self_p->flow_control.block_size;
+
+        if (block_size != 0) {
+            session_p->rx.block_counter++;
+
+            if (session_p->rx.block_counter == block_size) {
+                session_p->rx.block_counter = 0;
+                write_flow_control(session_p, FLOW_STATUS_CONTINUE_TO_SEND);
+            }
+        }
+
+        rx_timer_restart(session_p);
+    }
+
+    return (0);
+}
+
+static int input_flow_control_frame(struct isotp_manager_session_t *session_p,
+                                    const uint8_t *buf_p,
+                                    size_t size)
+{
+    if (session_p->tx.state != tx_state_wait_flow_control_t) {
+        return (-EPROTO);
+    }
+
+    if (size < 3) {
+        return (-EPROTO);
+    }
+
+    switch (buf_p[0] & 0x0f) {
+
+    case FLOW_STATUS_CONTINUE_TO_SEND:
+        timer_cancel(session_p,
+                     &session_p->tx.timer,
+                     SESSION_EVENT_TX_TIMEOUT);
+        session_p->tx.block_size = buf_p[1];
+        session_p->tx.block_counter = 0;
+        st_min_to_time(buf_p[2], &session_p->tx.st_min);
+        session_p->tx.state = tx_state_ready_t;
+        ready_push(session_p);
+        break;
+
+    case FLOW_STATUS_WAIT:
+        tx_timer_restart(session_p, NULL);
+        break;
+
+    case FLOW_STATUS_OVERFLOW:
+        tx_complete(session_p, -EMSGSIZE);
+        break;
+
+    default:
+        tx_complete(session_p, -EPROTO);
+        break;
+    }
+
+    return (0);
+}
+
+/**
+ * Write the next frame of the message being transmitted on given
+ * session.
+ */
+static void tx_output(struct isotp_manager_session_t *session_p)
+{
+    struct isotp_manager_t *self_p;
+    uint8_t buf[FD_DL];
+    size_t size;
+    size_t length;
+    size_t offset;
+    int is_first_frame;
+    int is_ready;
+    int res;
+
+    self_p = session_p->manager_p;
+
+    if (session_p->tx.offset == 0) {
+        /* Single frame or first frame. */
+        if (session_p->tx.size < CLASSIC_DL) {
+            buf[0] = ((TYPE_SINGLE_FRAME << 4) | session_p->tx.size);
+            offset = 1;
+            length = session_p->tx.size;
+        } else if (session_p->tx.size <= self_p->tx_dl - 2) {
+            buf[0] = (TYPE_SINGLE_FRAME << 4);
+            buf[1] = session_p->tx.size;
+            offset = 2;
+            length = session_p->tx.size;
+        } else {
+            if (session_p->tx.size <= FIRST_FRAME_LENGTH_MAX) {
+                buf[0] = ((TYPE_FIRST_FRAME << 4)
+                          | (session_p->tx.size >> 8));
+                buf[1] = session_p->tx.size;
+                offset = 2;
+            } else {
+                buf[0] = (TYPE_FIRST_FRAME << 4);
+                buf[1] = 0;
+                buf[2] = (session_p->tx.size >> 24);
+                buf[3] = (session_p->tx.size >> 16);
+                buf[4] = (session_p->tx.size >> 8);
+                buf[5] = session_p->tx.size;
+                offset = 6;
+            }
+
+            length = (self_p->tx_dl - offset);
+        }
+    } else {
+        buf[0] = ((TYPE_CONSECUTIVE_FRAME << 4) | session_p->tx.next_index);
+        offset = 1;
+        length = MIN(self_p->tx_dl - 1,
+                     session_p->tx.size - session_p->tx.offset);
+        session_p->tx.next_index++;
+        session_p->tx.next_index %= 16;
+    }
+
+    memcpy(&buf[offset],
+           &session_p->tx.buf_p[session_p->tx.offset],
+           length);
+    size = frame_pad(&buf[0], offset + length);
+
+    if (session_p->tx.offset == 0) {
+        session_p->tx.next_index = 1;
+        is_first_frame = 1;
+    } else {
+        session_p->tx.block_counter++;
+        is_first_frame = 0;
+    }
+
+    session_p->tx.offset += length;
+    is_ready = 0;
+
+    /* Enter the next state before writing the frame, as the peer
+       may respond before the write function returns. */
+    if (session_p->tx.offset == session_p->tx.size) {
+        session_p->tx.state = tx_state_idle_t;
+    } else if (is_first_frame
+               || (session_p->tx.block_counter == session_p->tx.block_size)) {
+        session_p->tx.state = tx_state_wait_flow_control_t;
+        tx_timer_restart(session_p, NULL);
+    } else if (session_p->tx.st_min.nanoseconds != 0) {
+        session_p->tx.state = tx_state_wait_separation_time_t;
+        tx_timer_restart(session_p, &session_p->tx.st_min);
+    } else {
+        is_ready = 1;
+    }
+
+    res = frame_write(session_p, &buf[0], size);
+
+    if (res != 0) {
+        tx_complete(session_p, res);
+    } else if (session_p->tx.offset == session_p->tx.size) {
+        tx_complete(session_p, 0);
+    } else if (is_ready == 1) {
+        ready_push(session_p);
+    }
+}
+
+static void session_process(struct isotp_manager_session_t *session_p,
+                            int events)
+{
+    struct isotp_manager_t *self_p;
+
+    self_p = session_p->manager_p;
+
+    if (events & SESSION_EVENT_RX_TIMEOUT) {
+        if (session_p->rx.state == rx_state_receiving_t) {
+            self_p->counters.timeouts++;
+            rx_abort(session_p);
+        }
+    }
+
+    if (events & SESSION_EVENT_TX_TIMEOUT) {
+        switch (session_p->tx.state) {
+
+        case tx_state_wait_flow_control_t:
+            self_p->counters.timeouts++;
+            tx_complete(session_p, -ETIMEDOUT);
+            break;
+
+        case tx_state_wait_separation_time_t:
+            session_p->tx.state = tx_state_ready_t;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if (session_p->tx.state == tx_state_ready_t) {
+        tx_output(session_p);
+    }
+}
+
+int isotp_manager_init(struct isotp_manager_t *self_p,
+                       isotp_manager_write_t write,
+                       void *write_arg_p,
+                       void *pool_p,
+                       size_t pool_size,
+                       size_t buffer_size,
+                       int flags)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(write != NULL, EINVAL);
+    ASSERTN(pool_p != NULL, EINVAL);
+    ASSERTN(buffer_size >= sizeof(void *), EINVAL);
+    ASSERTN(pool_size >= buffer_size, EINVAL);
+
+    size_t i;
+
+    self_p->write = write;
+    self_p->write_arg_p = write_arg_p;
+    self_p->flags = flags;
+
+    if (flags & ISOTP_MANAGER_FLAGS_CAN_FD) {
+        self_p->tx_dl = FD_DL;
+    } else {
+        self_p->tx_dl = CLASSIC_DL;
+    }
+
+    self_p->pool.free_p = NULL;
+    self_p->pool.buffer_size = buffer_size;
+
+    for (i = 0; i < pool_size / buffer_size; i++) {
+        pool_free(self_p, &((uint8_t *)pool_p)[i * buffer_size]);
+    }
+
+    self_p->flow_control.block_size = 0;
+    self_p->flow_control.st_min = 0;
+
+    for (i = 0; i < membersof(self_p->buckets); i++) {
+        self_p->buckets[i] = NULL;
+    }
+
+    self_p->ready.head_p = NULL;
+    self_p->ready.tail_p = NULL;
+    self_p->ready.last_p = NULL;
+    memset(&self_p->counters, 0, sizeof(self_p->counters));
+
+    return (event_init(&self_p->event));
+}
+
+int isotp_manager_set_flow_control(struct isotp_manager_t *self_p,
+                                   int block_size,
+                                   int st_min)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((block_size >= 0) && (block_size <= 255), EINVAL);
+    ASSERTN((st_min >= 0) && (st_min <= 255), EINVAL);
+
+    self_p->flow_control.block_size = block_size;
+    self_p->flow_control.st_min = st_min;
+
+    return (0);
+}
+
+int isotp_manager_session_init(struct isotp_manager_session_t *self_p,
+                               struct isotp_manager_t *manager_p,
+                               uint32_t rx_id,
+                               uint32_t tx_id,
+                               isotp_manager_on_message_t on_message,
+                               isotp_manager_on_complete_t on_complete,
+                               void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(manager_p != NULL, EINVAL);
+    ASSERTN(on_message != NULL, EINVAL);
+
+    int index;
+
+    if (session_lookup(manager_p, rx_id) != NULL) {
+        return (-EEXIST);
+    }
+
+    self_p->manager_p = manager_p;
+    self_p->rx_id = rx_id;
+    self_p->tx_id = tx_id;
+    self_p->on_message = on_message;
+    self_p->on_complete = on_complete;
+    self_p->arg_p = arg_p;
+    self_p->is_ready = 0;
+    self_p->events = 0;
+    self_p->rx.state = rx_state_idle_t;
+    self_p->rx.buf_p = NULL;
+    self_p->tx.state = tx_state_idle_t;
+    self_p->tx.buf_p = NULL;
+    self_p->tx.st_min.seconds = 0;
+    self_p->tx.st_min.nanoseconds = 0;
+    timer_init(&self_p->rx.timer, &self_p->tx.st_min, on_rx_timeout, self_p, 0);
+    timer_init(&self_p->tx.timer, &self_p->tx.st_min, on_tx_timeout, self_p, 0);
+
+    index = bucket_index(rx_id);
+    self_p->next_p = manager_p->buckets[index];
+    manager_p->buckets[index] = self_p;
+
+    return (0);
+}
+
+int isotp_manager_session_destroy(struct isotp_manager_session_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    struct isotp_manager_session_t **session_pp;
+
+    rx_abort(self_p);
+
+    sys_lock();
+    timer_stop_isr(&self_p->tx.timer);
+    ready_remove_isr(self_p);
+    sys_unlock();
+
+    session_pp = &self_p->manager_p->buckets[bucket_index(self_p->rx_id)];
+
+    while (*session_pp != NULL) {
+        if (*session_pp == self_p) {
+            *session_pp = self_p->next_p;
+            break;
+        }
+
+        session_pp = &(*session_pp)->next_p;
+    }
+
+    return (0);
+}
+
+int isotp_manager_session_write(struct isotp_manager_session_t *self_p,
+                                const void *buf_p,
+                                size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    if (self_p->tx.state != tx_state_idle_t) {
+        return (-EBUSY);
+    }
+
+    self_p->tx.buf_p = buf_p;
+    self_p->tx.size = size;
+    self_p->tx.offset = 0;
+    self_p->tx.block_size = 0;
+    self_p->tx.block_counter = 0;
+    self_p->tx.st_min.seconds = 0;
+    self_p->tx.st_min.nanoseconds = 0;
+    self_p->tx.state = tx_state_ready_t;
+    ready_push(self_p);
+
+    return (0);
+}
+
+int isotp_manager_input(struct isotp_manager_t *self_p,
+                        uint32_t id,
+                        const uint8_t *buf_p,
+                        size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    struct isotp_manager_session_t *session_p;
+    int res;
+
+    session_p = session_lookup(self_p, id);
+
+    if (session_p == NULL) {
+        return (-ENOENT);
+    }
+
+    if ((size == 0) || (size > FD_DL)) {
+        return (-EINVAL);
+    }
+
+    self_p->counters.frames_received++;
+
+    switch (buf_p[0] >> 4) {
+
+    case TYPE_SINGLE_FRAME:
+        res = input_single_frame(session_p, buf_p, size);
+        break;
+
+    case TYPE_FIRST_FRAME:
+        res = input_first_frame(session_p, buf_p, size);
+        break;
+
+    case TYPE_CONSECUTIVE_FRAME:
+        res = input_consecutive_frame(session_p, buf_p, size);
+        break;
+
+    case TYPE_FLOW_CONTROL_FRAME:
+        res = input_flow_control_frame(session_p, buf_p, size);
+        break;
+
+    default:
+        res = -EPROTO;
+        break;
+    }
+
+    return (res);
+}
+
+int isotp_manager_process(struct isotp_manager_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    struct isotp_manager_session_t *session_p;
+    int events;
+    int res;
+
+    /* Give each session ready at the start of this call one
+       opportunity to transmit. Sessions that are ready again are
+       added last in the list and served in the next call. Callbacks
+       may destroy queued sessions, which moves the last session
+       forward in the list. */
+    sys_lock();
+    self_p->ready.last_p = self_p->ready.tail_p;
+
+    while (self_p->ready.last_p != NULL) {
+        session_p = ready_pop_isr(self_p);
+
+        if (session_p == self_p->ready.last_p) {
+            self_p->ready.last_p = NULL;
+        }
+
+        events = session_p->events;
+        session_p->events = 0;
+        sys_unlock();
+
+        session_process(session_p, events);
+
+        sys_lock();
+    }
+
+    res = (self_p->ready.head_p != NULL);
+    sys_unlock();
+
+    return (res);
+}
+
+struct event_t *isotp_manager_get_event(struct isotp_manager_t *self_p)
+{
+    ASSERTNRN(self_p != NULL, EINVAL);
+
+    return (&self_p->event);
+}
+
+#if CONFIG_CAN == 1
+
+int isotp_manager_can_write(void *arg_p,
+                            uint32_t id,
+                            const uint8_t *buf_p,
+                            size_t size)
+{
+    struct can_frame_t frame;
+
+    if (size > sizeof(frame.data.u8)) {
+        return (-EMSGSIZE);
+    }
+
+    frame.id = id;
+    frame.extended_frame = (id > 0x7ff);
+    frame.rtr = 0;
+    frame.size = size;
+    memcpy(&frame.data.u8[0], buf_p, size);
+
+    if (can_write(arg_p, &frame, sizeof(frame)) != sizeof(frame)) {
+        return (-EIO);
+    }
+
+    return (0);
+}
+
+int isotp_manager_can_run(struct isotp_manager_t *self_p,
+                          struct can_driver_t *can_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(can_p != NULL, EINVAL);
+
+    struct chan_list_t list;
+    struct chan_list_elem_t elements[2];
+    struct can_frame_t frames[8];
+    struct time_t timeout;
+    void *chan_p;
+    uint32_t mask;
+    ssize_t length;
+    ssize_t i;
+    int ready;
+
+    chan_list_init(&list, &elements[0], membersof(elements));
+    chan_list_add(&list, &can_p->chin);
+    chan_list_add(&list, &self_p->event);
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 0;
+    ready = 0;
+
+    while (1) {
+        /* Only block if no session is ready to transmit. */
+        chan_p = chan_list_poll(&list, (ready == 1 ? &timeout : NULL));
+
+        if (chan_p == &can_p->chin) {
+            length = can_read_frames(can_p, &frames[0], membersof(frames));
+
+            for (i = 0; i < length; i++) {
+                isotp_manager_input(self_p,
+                                    frames[i].id,
+                                    &frames[i].data.u8[0],
+                                    frames[i].size);
+            }
+        } else if (chan_p == &self_p->event) {
+            mask = EVENT_TIMEOUT;
+            event_read(&self_p->event, &mask, sizeof(mask));
+        }
+
+        ready = isotp_manager_process(self_p);
+    }
+
+    return (0);
+}
+
+#endif
@@ -0,0 +1,313 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __INET_ISOTP_MANAGER_H__
+#define __INET_ISOTP_MANAGER_H__
+
+#include "simba.h"
+
+/**
+ * Use CAN-FD frames with up to 64 data bytes instead of classic CAN
+ * frames with up to 8 data bytes.
+ */
+#define ISOTP_MANAGER_FLAGS_CAN_FD                     (1 << 0)
+
+struct isotp_manager_t;
+struct isotp_manager_session_t;
+
+/**
+ * Frame write callback. Transmits a single CAN frame with given id
+ * and data.
+ *
+ * @param[in] arg_p Argument given to `isotp_manager_init()`.
+ * @param[in] id CAN id.
+ * @param[in] buf_p Frame data.
+ * @param[in] size Frame data size in bytes.
+ *
+ * @return zero(0) or negative error code.
+ */
+typedef int (*isotp_manager_write_t)(void *arg_p,
+                                     uint32_t id,
+                                     const uint8_t *buf_p,
+                                     size_t size);
+
+/**
+ * Message received callback. Called from the thread calling
+ * `isotp_manager_input()`. The message buffer is returned to the
+ * buffer pool when the callback returns.
+ *
+ * @param[in] session_p Session the message was received on.
+ * @param[in] buf_p Received message.
+ * @param[in] size Message size in bytes.
+ */
+typedef void (*isotp_manager_on_message_t)(
+    struct isotp_manager_session_t *session_p,
+    const uint8_t *buf_p,
+    size_t size);
+
+/**
+ * Message transmission completed callback. Called from the thread
+ * calling `isotp_manager_process()` or `isotp_manager_input()`.
+ *
+ * @param[in] session_p Session the message was transmitted on.
+ * @param[in] res Zero(0) if the message was transmitted, otherwise
+ *                negative error code.
+ */
+typedef void (*isotp_manager_on_complete_t)(
+    struct isotp_manager_session_t *session_p,
+    int res);
+
+struct isotp_manager_session_t {
+    struct isotp_manager_t *manager_p;
+    struct isotp_manager_session_t *next_p;
+    struct isotp_manager_session_t *ready_next_p;
+    uint32_t rx_id;
+    uint32_t tx_id;
+    isotp_manager_on_message_t on_message;
+    isotp_manager_on_complete_t on_complete;
+    void *arg_p;
+    int is_ready;
+    int events;
+    struct {
+        int state;
+        uint8_t *buf_p;
+        size_t size;
+        size_t offset;
+        int next_index;
+        int block_counter;
+        int flow_status;
+        struct timer_t timer;
+    } rx;
+    struct {
+        int state;
+        const uint8_t *buf_p;
+        size_t size;
+        size_t offset;
+        int next_index;
+        int block_size;
+        int block_counter;
+        struct time_t st_min;
+        struct timer_t timer;
+    } tx;
+};
+
+struct isotp_manager_t {
+    isotp_manager_write_t write;
+    void *write_arg_p;
+    int flags;
+    size_t tx_dl;
+    struct {
+        uint8_t *free_p;
+        size_t buffer_size;
+    } pool;
+    struct {
+        uint8_t block_size;
+        uint8_t st_min;
+    } flow_control;
+    struct isotp_manager_session_t *buckets[CONFIG_ISOTP_MANAGER_BUCKETS];
+    struct {
+        struct isotp_manager_session_t *head_p;
+        struct isotp_manager_session_t *tail_p;
+        struct isotp_manager_session_t *last_p;
+    } ready;
+    struct event_t event;
+    struct {
+        uint32_t frames_sent;
+        uint32_t frames_received;
+        uint32_t messages_sent;
+        uint32_t messages_received;
+        uint32_t timeouts;
+        uint32_t overflows;
+    } counters;
+};
+
+/**
+ * Initialize given ISO-TP session manager. Received multi frame
+ * messages are assembled in buffers taken from given buffer pool, and
+ * a message larger than a pool buffer is rejected with a flow control
+ * overflow.
+ *
+ * @param[in] self_p Manager to initialize.
+ * @param[in] write Frame write callback.
+ * @param[in] write_arg_p Argument passed to the write callback.
+ * @param[in] pool_p Memory to use as buffer pool.
+ * @param[in] pool_size Size of the buffer pool memory in bytes.
+ * @param[in] buffer_size Size of each pool buffer in bytes, and thus
+ *                        the maximum received message size. Must be
+ *                        at least the size of a pointer.
+ * @param[in] flags Configuration flags, ``ISOTP_MANAGER_FLAGS_*``.
+ *
+ * @return zero(0) or negative error code.
+ */
+int isotp_manager_init(struct isotp_manager_t *self_p,
+                       isotp_manager_write_t write,
+                       void *write_arg_p,
+                       void *pool_p,
+                       size_t pool_size,
+                       size_t buffer_size,
+                       int flags);
+
+/**
+ * Set the block size (BS) and separation time (STmin) the manager
+ * requests from peers in transmitted flow control frames. Both
+ * defaults to zero(0), that is, no flow control.
+ *
+ * @param[in] self_p Initialized manager.
+ * @param[in] block_size Number of consecutive frames between flow
+ *                       control frames, or zero(0) for all frames.
+ * @param[in] st_min Minimum separation time, encoded as in the
+ *                   ISO 15765-2 flow control frame.
+ *
+ * @return zero(0) or negative error code.
+ */
+int isotp_manager_set_flow_control(struct isotp_manager_t *self_p,
+                                   int block_size,
+                                   int st_min);
+
+/**
+ * Initialize given session and add it to given manager. Frames with
+ * CAN id `rx_id` are routed to this session, and frames sent by the
+ * session uses CAN id `tx_id`.
+ *
+ * @param[in] self_p Session to initialize.
+ * @param[in] manager_p Manager to add the session to.
+ * @param[in] rx_id CAN id of received frames.
+ * @param[in] tx_id CAN id of transmitted frames.
+ * @param[in] on_message Message received callback.
+ * @param[in] on_complete Message transmitted callback, or NULL.
+ * @param[in] arg_p Application argument, available in the callbacks
+ *                  as `session_p->arg_p`.
+ *
+ * @return zero(0) or negative error code.
+ */
+int isotp_manager_session_init(struct isotp_manager_session_t *self_p,
+                               struct isotp_manager_t *manager_p,
+                               uint32_t rx_id,
+                               uint32_t tx_id,
+                               isotp_manager_on_message_t on_message,
+                               isotp_manager_on_complete_t on_complete,
+                               void *arg_p);
+
+/**
+ * Remove given session from its manager. Any ongoing reception or
+ * transmission is aborted.
+ *
+ * @param[in] self_p Session to remove.
+ *
+ * @return zero(0) or negative error code.
+ */
+int isotp_manager_session_destroy(struct isotp_manager_session_t *self_p);
+
+/**
+ * Start transmission of given message on given session. The message
+ * buffer must be kept valid until the complete callback is called.
+ * Frames are transmitted by `isotp_manager_process()`.
+ *
+ * @param[in] self_p Session to transmit the message on.
+ * @param[in] buf_p Message to transmit.
+ * @param[in] size Message size in bytes.
+ *
+ * @return zero(0), -EBUSY if a message is already being transmitted,
+ *         or other negative error code.
+ */
+int isotp_manager_session_write(struct isotp_manager_session_t *self_p,
+                                const void *buf_p,
+                                size_t size);
+
+/**
+ * Input a received CAN frame into given manager. The frame is routed
+ * to the session with matching receive id.
+ *
+ * @param[in] self_p Initialized manager.
+ * @param[in] id CAN id of the frame.
+ * @param[in] buf_p Frame data.
+ * @param[in] size Frame data size in bytes.
+ *
+ * @return zero(0), -ENOENT if no session has given receive id, or
+ *         other negative error code if the frame was unexpected or
+ *         invalid.
+ */
+int isotp_manager_input(struct isotp_manager_t *self_p,
+                        uint32_t id,
+                        const uint8_t *buf_p,
+                        size_t size);
+
+/**
+ * Transmit pending frames. Every session ready to transmit sends at
+ * most one frame per call, in round robin order, so one long message
+ * does not starve the other sessions. Sessions waiting for flow
+ * control or a separation time are skipped until their timer
+ * expires.
+ *
+ * @param[in] self_p Initialized manager.
+ *
+ * @return one(1) if at least one session is still ready to
+ *         transmit, zero(0) if not, or negative error code. Call
+ *         again immediately if one(1) is returned.
+ */
+int isotp_manager_process(struct isotp_manager_t *self_p);
+
+/**
+ * Get the event channel that is written to when a session timer
+ * expires. Poll it together with the CAN input channel and call
+ * `isotp_manager_process()` when it has data.
+ *
+ * @param[in] self_p Initialized manager.
+ *
+ * @return The event channel.
+ */
+struct event_t *isotp_manager_get_event(struct isotp_manager_t *self_p);
+
+#if CONFIG_CAN == 1
+
+/**
+ * Frame write callback transmitting frames on a CAN driver, given as
+ * `arg_p`. Ids above 0x7ff are sent as extended frames.
+ */
+int isotp_manager_can_write(void *arg_p,
+                            uint32_t id,
+                            const uint8_t *buf_p,
+                            size_t size);
+
+/**
+ * Run given manager on given CAN driver, forever. Reads frames from
+ * the driver, inputs them to the manager and schedules transmission
+ * of pending frames.
+ *
+ * @param[in] self_p Initialized manager, using
+ *                   `isotp_manager_can_write()` as write callback.
+ * @param[in] can_p Started CAN driver.
+ *
+ * @return Never returns.
+ */
+int isotp_manager_can_run(struct isotp_manager_t *self_p,
+                          struct can_driver_t *can_p);
+
+#endif
+
+#endif
@@ -0,0 +1,144 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include <execinfo.h>
+#include <link.h>
+#include <signal.h>
+#include <time.h>
+
+/* Frames of the signal handler and the signal trampoline. */
+#define SIGNAL_FRAMES                                       2
+
+/* Real-time signal instead of SIGPROF, which is used by gprof in
+   -pg builds. */
+#define PROFILER_PORT_SIGNAL                      (SIGRTMIN + 4)
+
+struct profiler_port_t {
+    timer_t timer;
+    uintptr_t load_address;
+};
+
+static struct profiler_port_t profiler_port;
+
+static void profiler_port_signal_handler(int signal)
+{
+    void *frames[CONFIG_PROFILER_DEPTH_MAX + SIGNAL_FRAMES];
+    int depth;
+    pthread_t thrd;
+
+    /* The signal may be delivered to any thread. Forward it to the
+       running thread to sample its stack. */
+    thrd = thrd_self()->port.thrd;
+
+    if (!pthread_equal(pthread_self(), thrd)) {
+        pthread_kill(thrd, signal);
+
+        return;
+    }
+
+    depth = backtrace(&frames[0], membersof(frames));
+
+    if (depth > SIGNAL_FRAMES) {
+        profiler_sample_isr(&frames[SIGNAL_FRAMES], depth - SIGNAL_FRAMES);
+    }
+}
+
+/* ELF header of the executable, provided by the linker. */
+extern const ElfW(Ehdr) __ehdr_start;
+
+static int profiler_port_module_init(void)
+{
+    struct sigaction action;
+    struct sigevent event;
+    void *frames[1];
+
+    /* The first call loads the unwinder, which is not allowed in a
+       signal handler. */
+    backtrace(&frames[0], membersof(frames));
+
+    /* A position independent executable is linked at address zero,
+       so its load address has to be subtracted from the samples. */
+    if (__ehdr_start.e_type == ET_DYN) {
+        profiler_port.load_address = (uintptr_t)&__ehdr_start;
+    } else {
+        profiler_port.load_address = 0;
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = profiler_port_signal_handler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+
+    if (sigaction(PROFILER_PORT_SIGNAL, &action, NULL) != 0) {
+        return (-EIO);
+    }
+
+    /* Expires after consumed process CPU time, and the signal is
+       delivered to the running thread. */
+    memset(&event, 0, sizeof(event));
+    event.sigev_notify = SIGEV_SIGNAL;
+    event.sigev_signo = PROFILER_PORT_SIGNAL;
+
+    if (timer_create(CLOCK_PROCESS_CPUTIME_ID,
+                     &event,
+                     &profiler_port.timer) != 0) {
+        return (-EIO);
+    }
+
+    return (0);
+}
+
+static int profiler_port_set_period(long period)
+{
+    struct itimerspec value;
+
+    value.it_interval.tv_sec = (period / 1000000000L);
+    value.it_interval.tv_nsec = (period % 1000000000L);
+    value.it_value = value.it_interval;
+
+    if (timer_settime(profiler_port.timer, 0, &value, NULL) != 0) {
+        return (-EIO);
+    }
+
+    return (0);
+}
+
+static int profiler_port_start(int frequency)
+{
+    return (profiler_port_set_period(1000000000L / frequency));
+}
+
+static int profiler_port_stop(void)
+{
+    return (profiler_port_set_period(0));
+}
+
+static uintptr_t profiler_port_get_load_address(void)
+{
+    return (profiler_port.load_address);
+}
@@ -44,6 +44,13 @@ struct thrd_port_t {
     pthread_cond_t cond;
     void *(*main)(void *arg);
     void *arg;
+    struct {
+        uint64_t start;
+        struct {
+            uint64_t start;
+            uint64_t time;
+        } period;
+    } cpu;
 };
 
 #endif
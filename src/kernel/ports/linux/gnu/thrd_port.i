@@ -44,6 +44,27 @@ static char *thrd_port_get_main_thrd_stack_top(void)
     return (NULL);
 }
 
+/**
+ * Monotonic time in nanoseconds. The scheduler only runs one thread
+ * at a time, so the wall time a thread is current is its CPU time,
+ * including the idle thread.
+ */
+static uint64_t thrd_port_get_time_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec);
+}
+
+static void thrd_port_cpu_init(struct thrd_port_t *port_p)
+{
+    port_p->cpu.start = thrd_port_get_time_ns();
+    port_p->cpu.period.start = port_p->cpu.start;
+    port_p->cpu.period.time = 0;
+}
+
 static struct thrd_port_idle_t idle = {
     .mutex = PTHREAD_MUTEX_INITIALIZER,
     .cond = PTHREAD_COND_INITIALIZER
@@ -79,10 +100,12 @@ static void thrd_port_swap(struct thrd_t *in_p,
 
 static void thrd_port_init_main(struct thrd_port_t *port_p)
 {
+    port_p->thrd = pthread_self();
     port_p->main = NULL;
     port_p->arg = NULL;
     pthread_mutex_init(&port_p->mutex, NULL);
     pthread_cond_init (&port_p->cond, NULL);
+    thrd_port_cpu_init(port_p);
 }
 
 static int thrd_port_spawn(struct thrd_t *thrd_p,
@@ -99,6 +122,7 @@ static int thrd_port_spawn(struct thrd_t *thrd_p,
     port_p->arg = arg_p;
     pthread_mutex_init(&port_p->mutex, NULL);
     pthread_cond_init (&port_p->cond, NULL);
+    thrd_port_cpu_init(port_p);
     pthread_mutex_lock(&port_p->mutex);
 
     if (pthread_create(&port_p->thrd, NULL, thrd_port_main, port_p)) {
@@ -141,21 +165,48 @@ static void thrd_port_tick(void)
 
 static void thrd_port_cpu_usage_start(struct thrd_t *thrd_p)
 {
+    thrd_p->port.cpu.start = thrd_port_get_time_ns();
 }
 
 static void thrd_port_cpu_usage_stop(struct thrd_t *thrd_p)
 {
+    thrd_p->port.cpu.period.time += (thrd_port_get_time_ns()
+                                     - thrd_p->port.cpu.start);
 }
 
 #if CONFIG_MONITOR_THREAD == 1
 
 static cpu_usage_t thrd_port_cpu_usage_get(struct thrd_t *thrd_p)
 {
-    return (0);
+    uint64_t now;
+    uint64_t time;
+
+    now = thrd_port_get_time_ns();
+    time = thrd_p->port.cpu.period.time;
+
+    /* Include the ongoing time slice of the current thread. */
+    if (thrd_p == thrd_self()) {
+        time += (now - thrd_p->port.cpu.start);
+    }
+
+    if (now == thrd_p->port.cpu.period.start) {
+        return (0);
+    }
+
+    return (((cpu_usage_t)100 * time) / (now - thrd_p->port.cpu.period.start));
 }
 
 static void thrd_port_cpu_usage_reset(struct thrd_t *thrd_p)
 {
+    uint64_t now;
+
+    now = thrd_port_get_time_ns();
+    thrd_p->port.cpu.period.start = now;
+    thrd_p->port.cpu.period.time = 0;
+
+    if (thrd_p == thrd_self()) {
+        thrd_p->port.cpu.start = now;
+    }
 }
 
 #endif
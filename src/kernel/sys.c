@@ -512,6 +512,12 @@ int sys_start(void)
 #if CONFIG_MODULE_INIT_LOG == 1
     log_module_init();
 #endif
+#if (CONFIG_SYNC_CONTENTION == 1) && (CONFIG_MODULE_INIT_CONTENTION == 1)
+    contention_module_init();
+#endif
+#if (CONFIG_PROFILER == 1) && (CONFIG_MODULE_INIT_PROFILER == 1)
+    profiler_module_init();
+#endif
 #if CONFIG_MODULE_INIT_CHAN == 1
     chan_module_init();
 #endif
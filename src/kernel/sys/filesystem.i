@@ -117,7 +117,9 @@ struct filesystem_t {
         struct spiffs_config_t config;
         uint8_t workspace[2 * LOG_PAGE_SIZE];
         uint8_t fdworkspace[192];
-        uint8_t cache[1400];
+        uint8_t cache[SPIFFS_CACHE_BUFFER_SIZE(
+            LOG_PAGE_SIZE,
+            CONFIG_START_FILESYSTEM_SPIFFS_CACHE_PAGES)];
     } spiffs;
     struct {
         struct fs_filesystem_t fs;
@@ -138,7 +140,9 @@ struct filesystem_t {
         struct spiffs_config_t config;
         uint8_t workspace[2 * LOG_PAGE_SIZE];
         uint8_t fdworkspace[160];
-        uint8_t cache[728];
+        uint8_t cache[SPIFFS_CACHE_BUFFER_SIZE(
+            LOG_PAGE_SIZE,
+            CONFIG_START_FILESYSTEM_SPIFFS_CACHE_PAGES)];
     } spiffs;
     struct {
         struct fs_filesystem_t fs;
@@ -192,6 +196,10 @@ static int start_filesystem(void)
         return (-1);
     }
 
+    if (spiffs_module_init() != 0) {
+        return (-1);
+    }
+
     if (flash_init(&fs.flash, &flash_0_dev) != 0) {
         return (-1);
     }
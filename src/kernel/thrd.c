@@ -28,6 +28,10 @@
 
 #include "simba.h"
 
+#if (CONFIG_THRD_SCHEDULING_STATISTICS == 1) && !defined(ARCH_LINUX)
+#    error "CONFIG_THRD_SCHEDULING_STATISTICS is only supported on Linux."
+#endif
+
 /* Thread states. */
 enum thrd_state_t {
     THRD_STATE_CURRENT = 0,
@@ -59,6 +63,9 @@ struct module_t {
     struct fs_command_t cmd_list;
     struct fs_command_t cmd_set_log_mask;
 #endif
+#if CONFIG_THRD_FS_COMMANDS == 1 && CONFIG_THRD_SCHEDULING_STATISTICS == 1
+    struct fs_command_t cmd_scheduling;
+#endif
 #if CONFIG_MONITOR_THREAD == 1
     struct fs_command_t cmd_monitor_set_period_ms;
     struct fs_command_t cmd_monitor_set_print;
@@ -200,6 +207,10 @@ static void on_suspend_timer_expired(void *arg_p)
  */
 static void scheduler_ready_push(struct thrd_t *thrd_p)
 {
+#if CONFIG_THRD_SCHEDULING_STATISTICS == 1
+    thrd_p->statistics.timestamps.ready = thrd_port_get_time_ns();
+#endif
+
     thrd_prio_list_push_isr(&module.scheduler.ready, &thrd_p->scheduler.elem);
 }
 
@@ -213,6 +224,64 @@ static struct thrd_t *scheduler_ready_pop(void)
     return (thrd_prio_list_pop_isr(&module.scheduler.ready)->thrd_p);
 }
 
+#if CONFIG_THRD_SCHEDULING_STATISTICS == 1
+
+/**
+ * Add given duration to given histogram.
+ */
+static void histogram_add(uint32_t *histogram_p, uint64_t nanoseconds)
+{
+    uint32_t microseconds;
+    int i;
+
+    microseconds = MIN(nanoseconds / 1000, 0xffffffffull);
+    i = 0;
+
+    while ((microseconds > 0) && (i < THRD_HISTOGRAM_LENGTH - 1)) {
+        microseconds >>= 1;
+        i++;
+    }
+
+    histogram_p[i]++;
+}
+
+/**
+ * Update the scheduling statistics when swapping from given out
+ * thread to given in thread.
+ */
+static void update_scheduling_statistics(struct thrd_t *in_p,
+                                         struct thrd_t *out_p)
+{
+    uint64_t now;
+
+    now = thrd_port_get_time_ns();
+
+    histogram_add(&out_p->statistics.scheduling.run_length[0],
+                  now - out_p->statistics.timestamps.current);
+
+    if (out_p->state == THRD_STATE_READY) {
+        out_p->statistics.scheduling.involuntary++;
+    } else {
+        out_p->statistics.scheduling.voluntary++;
+    }
+
+    histogram_add(&in_p->statistics.scheduling.latency[0],
+                  now - in_p->statistics.timestamps.ready);
+    in_p->statistics.timestamps.current = now;
+}
+
+static void init_scheduling_statistics(struct thrd_t *thrd_p)
+{
+    memset(&thrd_p->statistics.scheduling,
+           0,
+           sizeof(thrd_p->statistics.scheduling));
+    thrd_p->statistics.timestamps.ready = thrd_port_get_time_ns();
+    thrd_p->statistics.timestamps.current =
+        thrd_p->statistics.timestamps.ready;
+}
+
+#endif
+
 /**
  * Perform a rescheduling to let the currently most important thread
  * to run.
@@ -235,6 +304,9 @@ static void thrd_reschedule(void)
 
     if (in_p != out_p) {
         module.scheduler.current_p = in_p;
+#if CONFIG_THRD_SCHEDULING_STATISTICS == 1
+        update_scheduling_statistics(in_p, out_p);
+#endif
         thrd_port_cpu_usage_stop(out_p);
         thrd_port_cpu_usage_start(in_p);
         thrd_port_swap(in_p, out_p);
@@ -350,6 +422,124 @@ static int cmd_list_cb(int argc,
     return (0);
 }
 
+#if CONFIG_THRD_SCHEDULING_STATISTICS == 1
+
+static void print_histogram_json(void *chout_p,
+                                 const char *name_p,
+                                 const uint32_t *histogram_p)
+{
+    int i;
+
+    std_fprintf(chout_p, OSTR(",\"%s\":["), name_p);
+
+    for (i = 0; i < THRD_HISTOGRAM_LENGTH; i++) {
+        std_fprintf(chout_p,
+                    OSTR("%s%lu"),
+                    (i == 0) ? "" : ",",
+                    (unsigned long)histogram_p[i]);
+    }
+
+    std_fprintf(chout_p, OSTR("]"));
+}
+
+static void print_histogram(void *chout_p,
+                            const char *name_p,
+                            const uint32_t *histogram_p)
+{
+    int i;
+
+    std_fprintf(chout_p, OSTR("%20s %11s"), "", name_p);
+
+    for (i = 0; i < THRD_HISTOGRAM_LENGTH; i++) {
+        std_fprintf(chout_p, OSTR(" %lu"), (unsigned long)histogram_p[i]);
+    }
+
+    std_fprintf(chout_p, OSTR("\r\n"));
+}
+
+static int cmd_scheduling_cb(int argc,
+                             const char *argv[],
+                             void *chout_p,
+                             void *chin_p,
+                             void *arg_p,
+                             void *call_arg_p)
+{
+    struct thrd_t *thrd_p;
+    struct thrd_scheduling_statistics_t statistics;
+    int json;
+    int i;
+
+    if (argc == 1) {
+        json = 0;
+    } else if ((argc == 2) && (strcmp(argv[1], "json") == 0)) {
+        json = 1;
+    } else if ((argc == 2) && (strcmp(argv[1], "reset") == 0)) {
+        return (thrd_reset_scheduling_statistics());
+    } else {
+        std_fprintf(chout_p, OSTR("Usage: scheduling [json|reset]\r\n"));
+
+        return (-EINVAL);
+    }
+
+    /* Upper limits of the histogram buckets. */
+    if (json == 1) {
+        std_fprintf(chout_p, OSTR("{\"histogram-limits-us\":[1"));
+    } else {
+        std_fprintf(chout_p, OSTR("HISTOGRAM-LIMITS-US: 1"));
+    }
+
+    for (i = 1; i < THRD_HISTOGRAM_LENGTH - 1; i++) {
+        std_fprintf(chout_p, OSTR("%c%lu"), (json == 1) ? ',' : ' ', 1ul << i);
+    }
+
+    if (json == 1) {
+        std_fprintf(chout_p, OSTR("],\"threads\":["));
+    } else {
+        std_fprintf(chout_p,
+                    OSTR("\r\n"
+                         "                NAME   VOLUNTARY  INVOLUNTARY\r\n"));
+    }
+
+    thrd_p = module.threads_p;
+
+    while (thrd_p != NULL) {
+        thrd_get_scheduling_statistics(thrd_p, &statistics);
+
+        if (json == 1) {
+            std_fprintf(chout_p,
+                        OSTR("%s{\"name\":\"%s\",\"voluntary\":%lu,"
+                             "\"involuntary\":%lu"),
+                        (thrd_p == module.threads_p) ? "" : ",",
+                        thrd_p->name_p,
+                        (unsigned long)statistics.voluntary,
+                        (unsigned long)statistics.involuntary);
+            print_histogram_json(chout_p, "latency", &statistics.latency[0]);
+            print_histogram_json(chout_p,
+                                 "run-length",
+                                 &statistics.run_length[0]);
+            std_fprintf(chout_p, OSTR("}"));
+        } else {
+            std_fprintf(chout_p,
+                        OSTR("%20s %11lu  %11lu\r\n"),
+                        thrd_p->name_p,
+                        (unsigned long)statistics.voluntary,
+                        (unsigned long)statistics.involuntary);
+            print_histogram(chout_p, "latency", &statistics.latency[0]);
+            print_histogram(chout_p, "run-length", &statistics.run_length[0]);
+        }
+
+        thrd_p = thrd_p->next_p;
+    }
+
+    if (json == 1) {
+        std_fprintf(chout_p, OSTR("]}\r\n"));
+    }
+
+    return (0);
+}
+
+#endif
+
 static int cmd_set_log_mask_cb(int argc,
                                const char *argv[],
                                void *chout_p,
@@ -454,6 +644,10 @@ int thrd_module_init(void)
     thrd_p->statistics.scheduled = 0;
 #endif
 
+#if CONFIG_THRD_SCHEDULING_STATISTICS == 1
+    init_scheduling_statistics(thrd_p);
+#endif
+
 #if CONFIG_THRD_ENV == 1
     thrd_p->env.variables_p = NULL;
     thrd_p->env.number_of_variables = 0;
@@ -495,6 +689,14 @@ int thrd_module_init(void)
                     NULL);
     fs_command_register(&module.cmd_set_log_mask);
 
+#    if CONFIG_THRD_SCHEDULING_STATISTICS == 1
+    fs_command_init(&module.cmd_scheduling,
+                    CSTR("/kernel/thrd/scheduling"),
+                    cmd_scheduling_cb,
+                    NULL);
+    fs_command_register(&module.cmd_scheduling);
+#    endif
+
 #    if CONFIG_MONITOR_THREAD == 1
     fs_command_init(&module.cmd_monitor_set_period_ms,
                     CSTR("/kernel/thrd/monitor/set_period_ms"),
@@ -549,6 +751,10 @@ struct thrd_t *thrd_spawn(void *(*main)(void *),
     thrd_p->statistics.scheduled = 0;
 #endif
 
+#if CONFIG_THRD_SCHEDULING_STATISTICS == 1
+    init_scheduling_statistics(thrd_p);
+#endif
+
 #if CONFIG_THRD_ENV == 1
     thrd_p->env.variables_p = NULL;
     thrd_p->env.number_of_variables = 0;
@@ -721,6 +927,44 @@ int thrd_get_log_mask(void)
     return (module.scheduler.current_p->log_mask);
 }
 
+#if CONFIG_THRD_SCHEDULING_STATISTICS == 1
+
+int thrd_get_scheduling_statistics(
+    struct thrd_t *thrd_p,
+    struct thrd_scheduling_statistics_t *statistics_p)
+{
+    ASSERTN(thrd_p != NULL, EINVAL);
+    ASSERTN(statistics_p != NULL, EINVAL);
+
+    sys_lock();
+    *statistics_p = thrd_p->statistics.scheduling;
+    sys_unlock();
+
+    return (0);
+}
+
+int thrd_reset_scheduling_statistics(void)
+{
+    struct thrd_t *thrd_p;
+
+    sys_lock();
+
+    thrd_p = module.threads_p;
+
+    while (thrd_p != NULL) {
+        memset(&thrd_p->statistics.scheduling,
+               0,
+               sizeof(thrd_p->statistics.scheduling));
+        thrd_p = thrd_p->next_p;
+    }
+
+    sys_unlock();
+
+    return (0);
+}
+
+#endif
+
 int thrd_set_prio(struct thrd_t *thrd_p, int prio)
 {
     ASSERTN(thrd_p != NULL, EINVAL);
@@ -82,6 +82,29 @@ struct thrd_environment_t {
     size_t max_number_of_variables;
 };
 
+/**
+ * Number of buckets in the scheduling histograms. Bucket 0 counts
+ * durations below one microsecond, bucket i durations from 2^(i-1)
+ * up to 2^i microseconds and the last bucket all longer durations.
+ */
+#define THRD_HISTOGRAM_LENGTH                              16
+
+/**
+ * Scheduling statistics of a thread.
+ */
+struct thrd_scheduling_statistics_t {
+    /** Switches from the thread when it was suspended or
+        terminated. */
+    uint32_t voluntary;
+    /** Switches from the thread when it was still ready to run, for
+        example when yielding or preempted. */
+    uint32_t involuntary;
+    /** Time from ready to current. */
+    uint32_t latency[THRD_HISTOGRAM_LENGTH];
+    /** Time from current until switched from. */
+    uint32_t run_length[THRD_HISTOGRAM_LENGTH];
+};
+
 struct thrd_t {
     struct {
         struct thrd_prio_list_elem_t elem;
@@ -109,6 +132,13 @@ struct thrd_t {
 #endif
 #if CONFIG_THRD_SCHEDULED == 1
         uint32_t scheduled;
+#endif
+#if CONFIG_THRD_SCHEDULING_STATISTICS == 1
+        struct {
+            uint64_t ready;
+            uint64_t current;
+        } timestamps;
+        struct thrd_scheduling_statistics_t scheduling;
 #endif
     } statistics;
 #if CONFIG_THRD_ENV == 1
@@ -436,6 +466,29 @@ const void *thrd_get_bottom_of_stack(struct thrd_t *thrd_p);
  */
 const void *thrd_get_top_of_stack(struct thrd_t *thrd_p);
 
+#if CONFIG_THRD_SCHEDULING_STATISTICS == 1
+
+/**
+ * Get the scheduling statistics of given thread.
+ *
+ * @param[in] thrd_p Thread.
+ * @param[out] statistics_p Scheduling statistics.
+ *
+ * @return zero(0) or negative error code.
+ */
+int thrd_get_scheduling_statistics(
+    struct thrd_t *thrd_p,
+    struct thrd_scheduling_statistics_t *statistics_p);
+
+/**
+ * Reset the scheduling statistics of all threads.
+ *
+ * @return zero(0) or negative error code.
+ */
+int thrd_reset_scheduling_statistics(void);
+
+#endif
+
 /**
  * Initialize given prio list.
  */
@@ -305,6 +305,19 @@ static int upgrade_port_binary_upload_begin()
     return (0);
 }
 
+static int upgrade_port_binary_upload_resume(size_t offset)
+{
+    application.partition_p = get_application_partition();
+
+    if (application.partition_p == NULL) {
+        return (-1);
+    }
+
+    application.offset = offset;
+
+    return (0);
+}
+
 static int upgrade_port_binary_upload(const void *buf_p,
                                       size_t size)
 {
@@ -339,7 +352,9 @@ static int upgrade_port_binary_upload_end()
         return (-1);
     }
 
-    if (upgrade_application_is_valid(0) != 1) {
+    /* The data digest was verified during the upload, so a quick
+       validation is enough. */
+    if (upgrade_application_is_valid(1) != 1) {
         return (-1);
     }
 
@@ -350,3 +365,13 @@ static int upgrade_port_binary_upload_end()
 
     return (0);
 }
+
+static int upgrade_port_checkpoint_write(const void *buf_p, size_t size)
+{
+    return (-ENOSYS);
+}
+
+static int upgrade_port_checkpoint_read(void *buf_p, size_t size)
+{
+    return (-ENOSYS);
+}
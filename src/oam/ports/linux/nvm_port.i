@@ -105,5 +105,23 @@ static ssize_t nvm_port_vwrite(struct iov_uintptr_t *dst_p,
                                struct iov_t *src_p,
                                size_t length)
 {
-    return (-ENOSYS);
+    size_t i;
+    ssize_t res;
+    ssize_t size;
+
+    size = 0;
+
+    for (i = 0; i < length; i++) {
+        res = nvm_port_write(dst_p[i].address,
+                             src_p[i].buf_p,
+                             dst_p[i].size);
+
+        if (res != dst_p[i].size) {
+            return (res < 0 ? res : -EIO);
+        }
+
+        size += res;
+    }
+
+    return (size);
 }
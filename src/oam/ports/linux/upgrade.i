@@ -26,12 +26,107 @@
  * This file is part of the Simba project.
  */
 
+/* The application area, its size and SHA-1 digest, and the upload
+   checkpoint are stored in files in the current directory. */
+#define APPLICATION_FILENAME "upgrade_application.bin"
+#define APPLICATION_INFO_FILENAME "upgrade_application_info.bin"
+#define CHECKPOINT_FILENAME "upgrade_checkpoint.bin"
+
+struct application_info_t {
+    uint32_t size;
+    uint8_t sha1[20];
+};
+
 struct module_port_t {
     int stay_in_bootloader;
+    FILE *application_p;
 };
 
 static struct module_port_t module_port;
 
+static int application_sha1(uint8_t *dst_p, size_t size)
+{
+    FILE *file_p;
+    struct sha1_t sha1;
+    uint8_t buf[256];
+    size_t left;
+    size_t chunk_size;
+    int res;
+
+    file_p = fopen(APPLICATION_FILENAME, "rb");
+
+    if (file_p == NULL) {
+        return (-ENOENT);
+    }
+
+    sha1_init(&sha1);
+    left = size;
+    res = 0;
+
+    while (left > 0) {
+        chunk_size = MIN(left, sizeof(buf));
+
+        if (fread(&buf[0], 1, chunk_size, file_p) != chunk_size) {
+            res = -EIO;
+            break;
+        }
+
+        sha1_update(&sha1, &buf[0], chunk_size);
+        left -= chunk_size;
+    }
+
+    fclose(file_p);
+    sha1_digest(&sha1, dst_p);
+
+    return (res);
+}
+
+static int read_file(const char *filename_p, void *buf_p, size_t size)
+{
+    FILE *file_p;
+    int res;
+
+    file_p = fopen(filename_p, "rb");
+
+    if (file_p == NULL) {
+        return (-ENOENT);
+    }
+
+    if (fread(buf_p, 1, size, file_p) == size) {
+        res = 0;
+    } else {
+        res = -EIO;
+    }
+
+    fclose(file_p);
+
+    return (res);
+}
+
+static int write_file(const char *filename_p, const void *buf_p, size_t size)
+{
+    FILE *file_p;
+    int res;
+
+    file_p = fopen(filename_p, "wb");
+
+    if (file_p == NULL) {
+        return (-EIO);
+    }
+
+    if (fwrite(buf_p, 1, size, file_p) == size) {
+        res = 0;
+    } else {
+        res = -EIO;
+    }
+
+    if (fclose(file_p) != 0) {
+        res = -EIO;
+    }
+
+    return (res);
+}
+
 static int upgrade_port_bootloader_enter()
 {
     return (-1);
@@ -63,26 +158,119 @@ static int upgrade_port_application_enter()
 
 static int upgrade_port_application_erase()
 {
+    (void)remove(APPLICATION_INFO_FILENAME);
+    (void)remove(APPLICATION_FILENAME);
+
     return (0);
 }
 
-static int upgrade_port_application_is_valid()
+static int upgrade_port_application_is_valid(int quick)
 {
-    return (0);
+    struct application_info_t info;
+    uint8_t sha1[20];
+
+    if (read_file(APPLICATION_INFO_FILENAME, &info, sizeof(info)) != 0) {
+        return (0);
+    }
+
+    if (quick == 1) {
+        return (1);
+    }
+
+    if (application_sha1(&sha1[0], info.size) != 0) {
+        return (0);
+    }
+
+    return (memcmp(&sha1[0], &info.sha1[0], sizeof(sha1)) == 0);
 }
 
 static int upgrade_port_binary_upload_begin()
 {
+    if (module_port.application_p != NULL) {
+        fclose(module_port.application_p);
+    }
+
+    (void)remove(APPLICATION_INFO_FILENAME);
+    module_port.application_p = fopen(APPLICATION_FILENAME, "w+b");
+
+    if (module_port.application_p == NULL) {
+        return (-EIO);
+    }
+
+    return (0);
+}
+
+static int upgrade_port_binary_upload_resume(size_t offset)
+{
+    if (module_port.application_p == NULL) {
+        module_port.application_p = fopen(APPLICATION_FILENAME, "r+b");
+
+        if (module_port.application_p == NULL) {
+            return (-ENOENT);
+        }
+    }
+
+    if (fseek(module_port.application_p, offset, SEEK_SET) != 0) {
+        return (-EIO);
+    }
+
     return (0);
 }
 
 static int upgrade_port_binary_upload(const void *buf_p,
                                       size_t size)
 {
+    if (module_port.application_p == NULL) {
+        return (-EIO);
+    }
+
+    if (fwrite(buf_p, 1, size, module_port.application_p) != size) {
+        return (-EIO);
+    }
+
     return (0);
 }
 
 static int upgrade_port_binary_upload_end()
 {
-    return (0);
+    struct application_info_t info;
+
+    if (module_port.application_p == NULL) {
+        return (0);
+    }
+
+    if (fclose(module_port.application_p) != 0) {
+        module_port.application_p = NULL;
+
+        return (-EIO);
+    }
+
+    module_port.application_p = NULL;
+
+    /* The header has not been received. */
+    if (module.header_size != 0) {
+        return (0);
+    }
+
+    info.size = module.header.size;
+    memcpy(&info.sha1[0], &module.header.sha1[0], sizeof(info.sha1));
+
+    return (write_file(APPLICATION_INFO_FILENAME, &info, sizeof(info)));
+}
+
+static int upgrade_port_checkpoint_write(const void *buf_p, size_t size)
+{
+    /* Make sure the checkpointed data is in the file first. */
+    if (module_port.application_p != NULL) {
+        if (fflush(module_port.application_p) != 0) {
+            return (-EIO);
+        }
+    }
+
+    return (write_file(CHECKPOINT_FILENAME, buf_p, size));
+}
+
+static int upgrade_port_checkpoint_read(void *buf_p, size_t size)
+{
+    return (read_file(CHECKPOINT_FILENAME, buf_p, size));
 }
@@ -50,10 +50,46 @@ extern const FAR struct setting_t settings[];
 const FAR uint8_t settings_default[CONFIG_SETTINGS_AREA_SIZE]
 __attribute__ ((weak)) = { 0xff, };
 
+/* Settings without a generated hash table are searched linearly. */
+const FAR struct settings_hash_t settings_hash
+__attribute__ ((weak)) = { 0, 0, NULL };
+
+static uint32_t hash_name(uint32_t seed, const char *name_p)
+{
+    uint32_t hash;
+
+    hash = (2166136261UL ^ seed);
+
+    while (*name_p != '\0') {
+        hash ^= (uint8_t)*name_p++;
+        hash *= 16777619UL;
+    }
+
+    return (hash);
+}
+
 static const FAR struct setting_t *get_setting_by_name(
     const char *name_p)
 {
     const FAR struct setting_t *setting_p;
+    int16_t index;
+
+    if (settings_hash.table_p != NULL) {
+        index = settings_hash.table_p[hash_name(settings_hash.seed, name_p)
+                                      & settings_hash.mask];
+
+        if (index < 0) {
+            return (NULL);
+        }
+
+        setting_p = &settings[index];
+
+        if (std_strcmp(name_p, setting_p->name_p) != 0) {
+            return (NULL);
+        }
+
+        return (setting_p);
+    }
 
     setting_p = &settings[0];
 
@@ -382,10 +418,17 @@ static int cmd_write_cb(int argc,
 
 static int reset(size_t address, size_t size)
 {
+    if (size == 0) {
+        return (0);
+    }
+
+#if defined(FAR_SPECIAL_ADDRESS)
     size_t i;
     size_t left;
     uint8_t buf[128];
 
+    /* The defaults are not addressable as RAM. Copy them to a RAM
+       buffer before writing. */
     left = size;
 
     while (left > 0) {
@@ -406,6 +449,13 @@ static int reset(size_t address, size_t size)
         address += size;
         left -= size;
     }
+#else
+    /* Write all defaults at once, which is a single chunk write on
+       software EEPROM. */
+    if (nvm_write(address, &settings_default[address], size) != size) {
+        return (-1);
+    }
+#endif
 
     return (0);
 }
@@ -548,3 +598,95 @@ int settings_reset_all()
 {
     return (reset(0, sizeof(settings_default)));
 }
+
+int settings_transaction_init(struct settings_transaction_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->length = 0;
+    self_p->buf_size = 0;
+
+    return (0);
+}
+
+ssize_t settings_transaction_write(struct settings_transaction_t *self_p,
+                                   size_t dst,
+                                   const void *src_p,
+                                   size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(src_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    size_t i;
+
+    if (self_p->length == CONFIG_SETTINGS_TRANSACTION_WRITES_MAX) {
+        return (-ENOMEM);
+    }
+
+    if (self_p->buf_size + size > sizeof(self_p->buf)) {
+        return (-ENOMEM);
+    }
+
+    /* Keep the writes sorted by address, as required by
+       nvm_vwrite() on some ports. */
+    i = self_p->length;
+
+    while ((i > 0) && (self_p->dst[i - 1].address > dst)) {
+        self_p->dst[i] = self_p->dst[i - 1];
+        self_p->src[i] = self_p->src[i - 1];
+        i--;
+    }
+
+    self_p->dst[i].address = dst;
+    self_p->dst[i].size = size;
+    self_p->src[i].buf_p = &self_p->buf[self_p->buf_size];
+    self_p->src[i].size = size;
+    memcpy(&self_p->buf[self_p->buf_size], src_p, size);
+    self_p->buf_size += size;
+    self_p->length++;
+
+    return (size);
+}
+
+ssize_t settings_transaction_write_by_name(
+    struct settings_transaction_t *self_p,
+    const char *name_p,
+    const void *src_p,
+    size_t size)
+{
+    ASSERTN(name_p != NULL, EINVAL);
+
+    const FAR struct setting_t *setting_p;
+
+    setting_p = get_setting_by_name(name_p);
+
+    if (setting_p == NULL) {
+        return (-EINVAL);
+    }
+
+    if (size > setting_p->size) {
+        return (-EINVAL);
+    }
+
+    return (settings_transaction_write(self_p,
+                                       setting_p->address,
+                                       src_p,
+                                       size));
+}
+
+ssize_t settings_transaction_commit(struct settings_transaction_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    ssize_t res;
+
+    if (self_p->length == 0) {
+        return (0);
+    }
+
+    res = nvm_vwrite(&self_p->dst[0], &self_p->src[0], self_p->length);
+    settings_transaction_init(self_p);
+
+    return (res);
+}
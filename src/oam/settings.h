@@ -49,6 +49,29 @@ struct setting_t {
     size_t size;
 };
 
+/**
+ * Perfect hash of all setting names, generated by simbagen.py. A name
+ * is hashed with FNV-1a, with `seed` mixed into the offset basis, and
+ * masked with `mask` to get its slot in `table_p`. Each slot is an
+ * index into the settings array, or -1 if unused.
+ */
+struct settings_hash_t {
+    uint32_t seed;
+    uint16_t mask;
+    FAR const int16_t *table_p;
+};
+
+/**
+ * Batch of setting writes committed to NVM at once.
+ */
+struct settings_transaction_t {
+    size_t length;
+    size_t buf_size;
+    struct iov_uintptr_t dst[CONFIG_SETTINGS_TRANSACTION_WRITES_MAX];
+    struct iov_t src[CONFIG_SETTINGS_TRANSACTION_WRITES_MAX];
+    uint8_t buf[CONFIG_SETTINGS_TRANSACTION_BUFFER_SIZE];
+};
+
 /**
  * Initialize the settings module. This function must be called before
  * calling any other function in this module.
@@ -136,4 +159,63 @@ int settings_reset_by_name(const char *name_p,
  */
 int settings_reset_all(void);
 
+/**
+ * Initialize given settings transaction. A transaction collects
+ * writes in RAM and writes them all to NVM in a single call to
+ * `nvm_vwrite()` when committed, which is much faster than writing
+ * the settings one by one.
+ *
+ * @param[out] self_p Transaction to initialize.
+ *
+ * @return zero(0) or negative error code.
+ */
+int settings_transaction_init(struct settings_transaction_t *self_p);
+
+/**
+ * Add a write of given value to given setting address to given
+ * transaction. The value is copied into the transaction, so the
+ * source buffer may be reused as soon as this function returns. Writes
+ * in the same transaction must not overlap.
+ *
+ * @param[in] self_p Initialized transaction.
+ * @param[in] dst Destination setting address.
+ * @param[in] src_p Value to write.
+ * @param[in] size Number of bytes to write.
+ *
+ * @return Number of bytes added or negative error code. -ENOMEM is
+ *         returned if the transaction is full.
+ */
+ssize_t settings_transaction_write(struct settings_transaction_t *self_p,
+                                   size_t dst,
+                                   const void *src_p,
+                                   size_t size);
+
+/**
+ * Add a write of given value to given setting by name to given
+ * transaction. See `settings_transaction_write()`.
+ *
+ * @param[in] self_p Initialized transaction.
+ * @param[in] name_p Setting name.
+ * @param[in] src_p Value to write.
+ * @param[in] size Number of bytes to write.
+ *
+ * @return Number of bytes added or negative error code.
+ */
+ssize_t settings_transaction_write_by_name(
+    struct settings_transaction_t *self_p,
+    const char *name_p,
+    const void *src_p,
+    size_t size);
+
+/**
+ * Write all values added to given transaction to NVM. The transaction
+ * is empty after this call and may be used for another batch of
+ * writes.
+ *
+ * @param[in] self_p Initialized transaction.
+ *
+ * @return Number of bytes written or negative error code.
+ */
+ssize_t settings_transaction_commit(struct settings_transaction_t *self_p);
+
 #endif
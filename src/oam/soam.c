@@ -41,49 +41,377 @@
 #define SOAM_TYPE_DATABASE_ID_RESPONSE               (9 << 4)
 #define SOAM_TYPE_DATABASE_REQUEST                  (10 << 4)
 #define SOAM_TYPE_DATABASE_RESPONSE                 (11 << 4)
+#define SOAM_TYPE_BATCH                             (12 << 4)
 #define SOAM_TYPE_INVALID_TYPE                      (15 << 4)
 
+#define SOAM_PACKET_FLAGS_COMPRESSED                 (1 << 2)
 #define SOAM_PACKET_FLAGS_CONSECUTIVE                (1 << 1)
 #define SOAM_PACKET_FLAGS_LAST                       (1 << 0)
 
+#define SOAM_PACKET_HEADER_SIZE                             5
+#define SOAM_PACKET_CRC_SIZE                                2
+#define SOAM_RECORD_HEADER_SIZE                             3
+
+/* The packet size field and the LZ4 match positions are 16 bits. */
+#define SOAM_BATCH_SIZE_MAX                            0xffff
+
 #define BUFFER_SIZE                                        64
 
+/* LZ4 block format limits. */
+#define LZ4_MIN_MATCH                                       4
+#define LZ4_LAST_LITERALS                                   5
+#define LZ4_MATCH_LIMIT                                    12
+#define LZ4_OFFSET_MAX                                  65535
+
 /* The generated SOAM database id. */
 extern char soam_database_id[];
 extern const size_t soam_database_compressed_size;
 extern const uint8_t soam_database_compressed[];
 
 /**
- * Finalize and output current packet to the output channel.
+ * Finalize given packet and write it to the output channel. The
+ * payload ends at given position.
  */
-static ssize_t packet_output(struct soam_t *self_p)
+static ssize_t packet_write(struct soam_t *self_p,
+                            uint8_t *buf_p,
+                            size_t pos)
 {
     ssize_t size;
     size_t payload_crc_size;
     uint16_t crc;
 
-    size = (self_p->tx.pos + 2);
+    size = (pos + SOAM_PACKET_CRC_SIZE);
     payload_crc_size = (size - 5);
 
-    /* Write packet size and crc fields. */
-    self_p->tx.buf_p[2] = self_p->transaction_id;
-    self_p->tx.buf_p[3] = (payload_crc_size >> 8);
-    self_p->tx.buf_p[4] = payload_crc_size;
+    /* Write packet index, size and crc fields. */
+    buf_p[1] = self_p->tx.packet_index++;
+    buf_p[2] = self_p->transaction_id;
+    buf_p[3] = (payload_crc_size >> 8);
+    buf_p[4] = payload_crc_size;
 
-    crc = crc_ccitt(0xffff, &self_p->tx.buf_p[0], size - 2);
+    crc = crc_ccitt(0xffff, &buf_p[0], size - 2);
 
-    self_p->tx.buf_p[size - 2] = (crc >> 8);
-    self_p->tx.buf_p[size - 1] = crc;
+    buf_p[size - 2] = (crc >> 8);
+    buf_p[size - 1] = crc;
 
-    if (chan_write(self_p->tx.chout_p,
-                   &self_p->tx.buf_p[0],
-                   size) != size) {
+    if (chan_write(self_p->tx.chout_p, &buf_p[0], size) != size) {
         return (-1);
     }
 
+    self_p->statistics.packets++;
+    self_p->statistics.output_bytes += size;
+
     return (size - 7);
 }
 
+#if CONFIG_SOAM_BATCH == 1
+
+static uint32_t read_u32(const uint8_t *buf_p)
+{
+    uint32_t value;
+
+    memcpy(&value, buf_p, sizeof(value));
+
+    return (value);
+}
+
+/**
+ * Write given length as an LZ4 length continuation, after the 15 in
+ * the token.
+ */
+static uint8_t *lz4_write_length(uint8_t *dst_p, size_t length)
+{
+    length -= 15;
+
+    while (length >= 255) {
+        *dst_p++ = 255;
+        length -= 255;
+    }
+
+    *dst_p++ = length;
+
+    return (dst_p);
+}
+
+/**
+ * Write a sequence of given literals, optionally followed by a
+ * match. Returns NULL if the destination buffer is too small.
+ */
+static uint8_t *lz4_write_sequence(uint8_t *dst_p,
+                                   uint8_t *dst_end_p,
+                                   const uint8_t *literals_p,
+                                   size_t number_of_literals,
+                                   size_t offset,
+                                   size_t match_length)
+{
+    uint8_t *token_p;
+
+    /* Token, length continuations, literals and offset. */
+    if ((dst_end_p - dst_p) < (number_of_literals
+                               + number_of_literals / 255
+                               + match_length / 255
+                               + 5)) {
+        return (NULL);
+    }
+
+    token_p = dst_p++;
+
+    if (number_of_literals >= 15) {
+        *token_p = (15 << 4);
+        dst_p = lz4_write_length(dst_p, number_of_literals);
+    } else {
+        *token_p = (number_of_literals << 4);
+    }
+
+    memcpy(dst_p, literals_p, number_of_literals);
+    dst_p += number_of_literals;
+
+    if (match_length == 0) {
+        return (dst_p);
+    }
+
+    *dst_p++ = offset;
+    *dst_p++ = (offset >> 8);
+    match_length -= LZ4_MIN_MATCH;
+
+    if (match_length >= 15) {
+        *token_p |= 15;
+        dst_p = lz4_write_length(dst_p, match_length);
+    } else {
+        *token_p |= match_length;
+    }
+
+    return (dst_p);
+}
+
+/**
+ * Compress given data into an LZ4 block. Greedy matching with a
+ * single entry hash table.
+ *
+ * @return Compressed size, or negative error code if the destination
+ *         buffer is too small.
+ */
+static ssize_t lz4_compress(const uint8_t *src_p,
+                            size_t size,
+                            uint8_t *dst_p,
+                            size_t dst_size,
+                            uint16_t *table_p)
+{
+    uint8_t *dst_begin_p;
+    uint8_t *dst_end_p;
+    size_t anchor;
+    size_t pos;
+    size_t candidate;
+    size_t length;
+    size_t match_end;
+    uint32_t value;
+    uint32_t hash;
+
+    dst_begin_p = dst_p;
+    dst_end_p = (dst_p + dst_size);
+    anchor = 0;
+    pos = 0;
+
+    if (size > LZ4_MATCH_LIMIT) {
+        memset(table_p, 0, sizeof(*table_p) * SOAM_COMPRESSION_TABLE_SIZE);
+        match_end = (size - LZ4_LAST_LITERALS);
+
+        while (pos <= size - LZ4_MATCH_LIMIT) {
+            value = read_u32(&src_p[pos]);
+            hash = (uint32_t)(value * 2654435761ul);
+            hash = (((hash >> 24) ^ (hash >> 16)) & 0xff);
+            candidate = table_p[hash];
+            table_p[hash] = pos;
+
+            if ((candidate >= pos)
+                || ((pos - candidate) > LZ4_OFFSET_MAX)
+                || (read_u32(&src_p[candidate]) != value)) {
+                pos++;
+                continue;
+            }
+
+            length = LZ4_MIN_MATCH;
+
+            while (((pos + length) < match_end)
+                   && (src_p[candidate + length] == src_p[pos + length])) {
+                length++;
+            }
+
+            dst_p = lz4_write_sequence(dst_p,
+                                       dst_end_p,
+                                       &src_p[anchor],
+                                       pos - anchor,
+                                       pos - candidate,
+                                       length);
+
+            if (dst_p == NULL) {
+                return (-ENOMEM);
+            }
+
+            pos += length;
+            anchor = pos;
+        }
+    }
+
+    /* Last literals. */
+    dst_p = lz4_write_sequence(dst_p,
+                               dst_end_p,
+                               &src_p[anchor],
+                               size - anchor,
+                               0,
+                               0);
+
+    if (dst_p == NULL) {
+        return (-ENOMEM);
+    }
+
+    return (dst_p - dst_begin_p);
+}
+
+/**
+ * Write current batch packet, if any. The payload is compressed if
+ * it makes the packet smaller.
+ */
+static int batch_output(struct soam_t *self_p)
+{
+    uint8_t *buf_p;
+    size_t pos;
+    size_t size;
+    ssize_t compressed_size;
+
+    if ((self_p->batch.buf_p == NULL)
+        || (self_p->batch.pos == SOAM_PACKET_HEADER_SIZE)) {
+        return (0);
+    }
+
+    buf_p = self_p->batch.buf_p;
+    pos = self_p->batch.pos;
+    buf_p[0] = (SOAM_TYPE_BATCH | SOAM_PACKET_FLAGS_LAST);
+
+    if (self_p->batch.compressed_buf_p != NULL) {
+        size = (pos - SOAM_PACKET_HEADER_SIZE);
+        compressed_size = lz4_compress(&buf_p[SOAM_PACKET_HEADER_SIZE],
+                                       size,
+                                       &self_p->batch.compressed_buf_p[7],
+                                       size - 3,
+                                       &self_p->batch.table[0]);
+
+        if (compressed_size > 0) {
+            buf_p = self_p->batch.compressed_buf_p;
+            buf_p[0] = (SOAM_TYPE_BATCH
+                        | SOAM_PACKET_FLAGS_COMPRESSED
+                        | SOAM_PACKET_FLAGS_LAST);
+            buf_p[5] = (size >> 8);
+            buf_p[6] = size;
+            pos = (7 + compressed_size);
+            self_p->statistics.compressed_packets++;
+        }
+    }
+
+    self_p->batch.pos = SOAM_PACKET_HEADER_SIZE;
+    self_p->batch.last_record_pos = -1;
+
+    if (packet_write(self_p, buf_p, pos) < 0) {
+        return (-1);
+    }
+
+    return (0);
+}
+
+/**
+ * Add given record to the batch packet. Consecutive binary standard
+ * output records are merged.
+ *
+ * @return zero(0) if added, otherwise negative error code.
+ */
+static int batch_add(struct soam_t *self_p,
+                     int type,
+                     const uint8_t *buf_p,
+                     size_t size)
+{
+    uint8_t *record_p;
+    size_t record_size;
+    size_t end;
+
+    end = (self_p->batch.size - SOAM_PACKET_CRC_SIZE);
+
+    /* Append to the previous record if both are binary output. */
+    if ((type == SOAM_TYPE_STDOUT_BINARY)
+        && (self_p->batch.last_record_pos != -1)
+        && ((self_p->batch.pos + size) <= end)) {
+        record_p = &self_p->batch.buf_p[self_p->batch.last_record_pos];
+
+        if (record_p[0] == type) {
+            record_size = (((record_p[1] << 8) | record_p[2]) + size);
+            record_p[1] = (record_size >> 8);
+            record_p[2] = record_size;
+            memcpy(&self_p->batch.buf_p[self_p->batch.pos], buf_p, size);
+            self_p->batch.pos += size;
+
+            return (0);
+        }
+    }
+
+    if ((self_p->batch.pos + SOAM_RECORD_HEADER_SIZE + size) > end) {
+        if (batch_output(self_p) != 0) {
+            return (-1);
+        }
+
+        if ((self_p->batch.pos + SOAM_RECORD_HEADER_SIZE + size) > end) {
+            return (-ENOMEM);
+        }
+    }
+
+    record_p = &self_p->batch.buf_p[self_p->batch.pos];
+    record_p[0] = type;
+    record_p[1] = (size >> 8);
+    record_p[2] = size;
+    memcpy(&record_p[SOAM_RECORD_HEADER_SIZE], buf_p, size);
+    self_p->batch.last_record_pos = self_p->batch.pos;
+    self_p->batch.pos += (SOAM_RECORD_HEADER_SIZE + size);
+
+    return (0);
+}
+
+/**
+ * Returns true(1) if given packet type and flags is a single packet
+ * record that can be batched.
+ */
+static int is_batchable(struct soam_t *self_p, int type_flags)
+{
+    if (self_p->batch.buf_p == NULL) {
+        return (0);
+    }
+
+    switch (type_flags) {
+
+    case SOAM_TYPE_STDOUT_PRINTF:
+    case SOAM_TYPE_STDOUT_BINARY:
+    case SOAM_TYPE_LOG_POINT:
+        return (1);
+
+    default:
+        return (0);
+    }
+}
+
+#endif
+
+/**
+ * Finalize and output current packet to the output channel.
+ */
+static ssize_t packet_output(struct soam_t *self_p)
+{
+#if CONFIG_SOAM_BATCH == 1
+    /* Keep the packet order. */
+    if (batch_output(self_p) != 0) {
+        return (-1);
+    }
+#endif
+
+    return (packet_write(self_p, self_p->tx.buf_p, self_p->tx.pos));
+}
+
 static ssize_t printf_or_binary_write(struct soam_t *self_p,
                                       const void *buf_p,
                                       size_t size,
@@ -303,6 +631,11 @@ int soam_init(struct soam_t *self_p,
 
     mutex_init(&self_p->tx.mutex);
 
+#if CONFIG_SOAM_BATCH == 1
+    self_p->batch.buf_p = NULL;
+#endif
+
+    memset(&self_p->statistics, 0, sizeof(self_p->statistics));
     self_p->is_printf = 0;
     self_p->transaction_id = 0;
 
@@ -392,9 +725,9 @@ ssize_t soam_write_begin(struct soam_t *self_p,
 {
     mutex_lock(&self_p->tx.mutex);
 
-    /* First packet initialization. */
+    /* First packet initialization. The packet index is written when
+       the packet is output. */
     self_p->tx.buf_p[0] = type;
-    self_p->tx.buf_p[1] = self_p->tx.packet_index++;
     self_p->tx.pos = 5;
 
     return (0);
@@ -410,6 +743,7 @@ ssize_t soam_write_chunk(struct soam_t *self_p,
 
     b_p = buf_p;
     left = size;
+    self_p->statistics.record_bytes += size;
 
     while (left > 0) {
         /* Output if the transmission buffer is full. */
@@ -422,7 +756,6 @@ ssize_t soam_write_chunk(struct soam_t *self_p,
 
             /* Next packet initialization. */
             self_p->tx.buf_p[0] |= SOAM_PACKET_FLAGS_CONSECUTIVE;
-            self_p->tx.buf_p[1] = self_p->tx.packet_index++;
             self_p->tx.pos = 5;
         }
 
@@ -448,8 +781,26 @@ ssize_t soam_write_end(struct soam_t *self_p)
 
     /* Output last packet, if any. */
     if (self_p->tx.pos != -1) {
-        self_p->tx.buf_p[0] |= SOAM_PACKET_FLAGS_LAST;
-        size = packet_output(self_p);
+        self_p->statistics.records++;
+        size = -1;
+
+#if CONFIG_SOAM_BATCH == 1
+        if (is_batchable(self_p, self_p->tx.buf_p[0])) {
+            size = (self_p->tx.pos - SOAM_PACKET_HEADER_SIZE);
+
+            if (batch_add(self_p,
+                          self_p->tx.buf_p[0],
+                          &self_p->tx.buf_p[SOAM_PACKET_HEADER_SIZE],
+                          size) != 0) {
+                size = -1;
+            }
+        }
+#endif
+
+        if (size == -1) {
+            self_p->tx.buf_p[0] |= SOAM_PACKET_FLAGS_LAST;
+            size = packet_output(self_p);
+        }
     } else {
         size = -1;
     }
@@ -473,6 +824,95 @@ ssize_t soam_write(struct soam_t *self_p,
     return (soam_write_end(self_p));
 }
 
+int soam_set_batching(struct soam_t *self_p,
+                      void *buf_p,
+                      size_t size,
+                      int compress)
+{
+#if CONFIG_SOAM_BATCH == 1
+    int res;
+#endif
+
+    ASSERTN(self_p != NULL, EINVAL);
+
+#if CONFIG_SOAM_BATCH == 1
+    if (compress == 1) {
+        size /= 2;
+    }
+
+    if ((buf_p != NULL)
+        && ((size < (SOAM_PACKET_HEADER_SIZE
+                     + SOAM_RECORD_HEADER_SIZE
+                     + SOAM_PACKET_CRC_SIZE
+                     + 1))
+            || (size > SOAM_BATCH_SIZE_MAX))) {
+        return (-EINVAL);
+    }
+
+    mutex_lock(&self_p->tx.mutex);
+
+    res = batch_output(self_p);
+
+    self_p->batch.buf_p = buf_p;
+    self_p->batch.size = size;
+    self_p->batch.pos = SOAM_PACKET_HEADER_SIZE;
+    self_p->batch.last_record_pos = -1;
+
+    if ((buf_p != NULL) && (compress == 1)) {
+        self_p->batch.compressed_buf_p = &((uint8_t *)buf_p)[size];
+    } else {
+        self_p->batch.compressed_buf_p = NULL;
+    }
+
+    mutex_unlock(&self_p->tx.mutex);
+
+    return (res);
+#else
+    return (-ENOSYS);
+#endif
+}
+
+int soam_flush(struct soam_t *self_p)
+{
+    int res;
+
+    ASSERTN(self_p != NULL, EINVAL);
+
+    res = 0;
+
+#if CONFIG_SOAM_BATCH == 1
+    mutex_lock(&self_p->tx.mutex);
+    res = batch_output(self_p);
+    mutex_unlock(&self_p->tx.mutex);
+#endif
+
+    return (res);
+}
+
+int soam_get_statistics(struct soam_t *self_p,
+                        struct soam_statistics_t *statistics_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(statistics_p != NULL, EINVAL);
+
+    mutex_lock(&self_p->tx.mutex);
+    *statistics_p = self_p->statistics;
+    mutex_unlock(&self_p->tx.mutex);
+
+    return (0);
+}
+
+int soam_reset_statistics(struct soam_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    mutex_lock(&self_p->tx.mutex);
+    memset(&self_p->statistics, 0, sizeof(self_p->statistics));
+    mutex_unlock(&self_p->tx.mutex);
+
+    return (0);
+}
+
 void *soam_get_log_input_channel(struct soam_t *self_p)
 {
     return (&self_p->log_chan);
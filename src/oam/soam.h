@@ -28,6 +28,24 @@
 
 #include "simba.h"
 
+/** Size of the compression hash table, in entries. */
+#define SOAM_COMPRESSION_TABLE_SIZE                       256
+
+struct soam_statistics_t {
+    /** Number of written log points, standard output writes and
+        command responses. */
+    uint32_t records;
+    /** Number of bytes in written records. */
+    uint32_t record_bytes;
+    /** Number of packets written to the output channel. */
+    uint32_t packets;
+    /** Number of bytes written to the output channel, including
+        packet headers and crcs. */
+    uint32_t output_bytes;
+    /** Number of batch packets written compressed. */
+    uint32_t compressed_packets;
+};
+
 struct soam_t {
     int is_printf;
     uint8_t transaction_id;
@@ -39,6 +57,17 @@ struct soam_t {
         void *chout_p;
         uint8_t packet_index;
     } tx;
+#if CONFIG_SOAM_BATCH == 1
+    struct {
+        uint8_t *buf_p;
+        size_t size;
+        size_t pos;
+        ssize_t last_record_pos;
+        uint8_t *compressed_buf_p;
+        uint16_t table[SOAM_COMPRESSION_TABLE_SIZE];
+    } batch;
+#endif
+    struct soam_statistics_t statistics;
     struct chan_t stdout_chan;
     struct chan_t log_chan;
     struct chan_t command_chan;
@@ -131,6 +160,63 @@ ssize_t soam_write(struct soam_t *self_p,
                    const void *buf_p,
                    size_t size);
 
+/**
+ * Coalesce log points and standard output writes into batch packets
+ * of up to given size, instead of writing one packet per record. Each
+ * record in a batch packet has a three bytes header; type and
+ * size. Other packets, for example command responses, flush the
+ * current batch packet to keep the order.
+ *
+ * Batch packets are written when full, and by `soam_flush()`, which
+ * should be called periodically.
+ *
+ * @param[in] self_p Soam object.
+ * @param[in] buf_p Batch buffer, or NULL to disable batching. If
+ *                  compression is enabled the second half of the
+ *                  buffer holds the compressed packet.
+ * @param[in] size Batch buffer size. The maximum batch packet size is
+ *                 the buffer size, or half of it with compression,
+ *                 and must not exceed 65535 bytes.
+ * @param[in] compress Compress the payload of batch packets using an
+ *                     LZ4 block, if it makes the packet smaller.
+ *
+ * @return zero(0) or negative error code.
+ */
+int soam_set_batching(struct soam_t *self_p,
+                      void *buf_p,
+                      size_t size,
+                      int compress);
+
+/**
+ * Write the current batch packet, if any.
+ *
+ * @param[in] self_p Soam object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int soam_flush(struct soam_t *self_p);
+
+/**
+ * Get the transmission statistics. The effective throughput is the
+ * ratio of record bytes to output bytes.
+ *
+ * @param[in] self_p Soam object.
+ * @param[out] statistics_p Transmission statistics.
+ *
+ * @return zero(0) or negative error code.
+ */
+int soam_get_statistics(struct soam_t *self_p,
+                        struct soam_statistics_t *statistics_p);
+
+/**
+ * Reset the transmission statistics.
+ *
+ * @param[in] self_p Soam object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int soam_reset_statistics(struct soam_t *self_p);
+
 /**
  * Get the log input channel. This channel can be set as output
  * channel of the log module with
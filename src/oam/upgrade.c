@@ -28,18 +28,64 @@
 
 #include "simba.h"
 
+/* Number of data blocks; two when programming is done in parallel
+   with receiving data. */
+#if CONFIG_UPGRADE_PIPELINE == 1
+#    define BLOCKS_MAX                                      2
+#else
+#    define BLOCKS_MAX                                      1
+#endif
+
 struct upgrade_binary_header_t {
+    uint32_t version;
     uint32_t size;
     uint8_t sha1[20];
+    uint8_t sha256[32];
     char description[128];
 };
 
+/* Data verification state, updated as data is received. */
+struct stream_t {
+    uint32_t offset;
+    struct sha1_t sha1;
+    struct sha256_t sha256;
+};
+
+/* Everything needed to continue an interrupted upload. Only valid if
+   the crc matches. */
+struct checkpoint_t {
+    uint32_t header_size;
+    struct upgrade_binary_header_t header;
+    struct stream_t stream;
+    uint32_t crc;
+};
+
+struct block_t {
+    uint8_t buf[CONFIG_UPGRADE_BUFFER_SIZE];
+    size_t size;
+    struct stream_t stream;
+};
+
 struct module_t {
     int8_t initialized;
     uint8_t buf[256];
     ssize_t header_size;
     size_t offset;
     struct upgrade_binary_header_t header;
+    struct stream_t stream;
+    struct checkpoint_t checkpoint;
+    struct {
+        struct block_t blocks[BLOCKS_MAX];
+        struct block_t *block_p;
+        int fill_index;
+        int res;
+#if CONFIG_UPGRADE_PIPELINE == 1
+        int write_index;
+        struct sem_t free;
+        struct sem_t used;
+        struct thrd_t *thrd_p;
+#endif
+    } pipeline;
 #if CONFIG_UPGRADE_FS_COMMAND_BOOTLOADER_ENTER == 1
     struct fs_command_t cmd_bootloader_enter;
 #endif
@@ -62,15 +108,31 @@ static int binary_header_parse(struct upgrade_binary_header_t *header_p,
                                uint8_t *src_p,
                                size_t size)
 {
-    uint32_t version;
     uint32_t crc;
+    size_t description_offset;
+
+    header_p->version = ((src_p[0] << 24)
+                         | (src_p[1] << 16)
+                         | (src_p[2] << 8)
+                         | src_p[3]);
+
+    /* Version 1 headers has a SHA-1 digest of the data, and version 2
+       a SHA-256 digest. */
+    switch (header_p->version) {
+
+    case 1:
+        description_offset = 32;
+        break;
 
-    version = ((src_p[0] << 24)
-               | (src_p[1] << 16)
-               | (src_p[2] << 8)
-               | src_p[3]);
+    case 2:
+        description_offset = 44;
+        break;
 
-    if (version != 1) {
+    default:
+        return (-1);
+    }
+
+    if (size < description_offset + 1 + 4) {
         return (-1);
     }
 
@@ -87,13 +149,371 @@ static int binary_header_parse(struct upgrade_binary_header_t *header_p,
                       | (src_p[9] << 16)
                       | (src_p[10] << 8)
                       | src_p[11]);
-    memcpy(&header_p->sha1[0], &src_p[12], sizeof(header_p->sha1));
 
-    if (strlen((char *)&src_p[32]) >= sizeof(header_p->description)) {
+    if (header_p->version == 1) {
+        memcpy(&header_p->sha1[0], &src_p[12], sizeof(header_p->sha1));
+    } else {
+        memcpy(&header_p->sha256[0], &src_p[12], sizeof(header_p->sha256));
+    }
+
+    if (strnlen((char *)&src_p[description_offset],
+                size - description_offset - 4)
+        >= MIN(size - description_offset - 4,
+               sizeof(header_p->description))) {
         return (-1);
     }
 
-    strcpy(&header_p->description[0], (char *)&src_p[32]);
+    strcpy(&header_p->description[0], (char *)&src_p[description_offset]);
+
+    return (0);
+}
+
+static void stream_init(struct stream_t *self_p)
+{
+    self_p->offset = 0;
+    sha1_init(&self_p->sha1);
+    sha256_init(&self_p->sha256);
+}
+
+/**
+ * Add given data to the digest. Only the digest given in the header
+ * is calculated, and SHA-1 always as some ports store it in the
+ * application area for later validation.
+ */
+static void stream_update(struct stream_t *self_p,
+                          const void *buf_p,
+                          size_t size)
+{
+    self_p->offset += size;
+    sha1_update(&self_p->sha1, (void *)buf_p, size);
+
+    if (module.header.version == 2) {
+        sha256_update(&self_p->sha256, buf_p, size);
+    }
+}
+
+/**
+ * Calculate the digests of all received data and compare to the
+ * expected digest in the header. Fills in the SHA-1 digest in the
+ * header if the header has a SHA-256 digest.
+ *
+ * @return true(1) if the digest matches, otherwise false(0).
+ */
+static int stream_is_valid(struct stream_t *self_p)
+{
+    uint8_t sha1[20];
+    uint8_t sha256[32];
+
+    sha1_digest(&self_p->sha1, &sha1[0]);
+
+    if (module.header.version == 1) {
+        return (memcmp(&sha1[0],
+                       &module.header.sha1[0],
+                       sizeof(sha1)) == 0);
+    }
+
+    sha256_digest(&self_p->sha256, &sha256[0]);
+
+    if (memcmp(&sha256[0],
+               &module.header.sha256[0],
+               sizeof(sha256)) != 0) {
+        return (0);
+    }
+
+    memcpy(&module.header.sha1[0], &sha1[0], sizeof(sha1));
+
+    return (1);
+}
+
+/**
+ * Save given stream state, which all data up to has been written to
+ * the application area.
+ */
+static void checkpoint_save(const struct stream_t *stream_p)
+{
+    module.checkpoint.header = module.header;
+    module.checkpoint.stream = *stream_p;
+    module.checkpoint.crc = crc_32(0,
+                                   &module.checkpoint,
+                                   offsetof(struct checkpoint_t, crc));
+
+    /* Persistent checkpoints are optional. */
+    (void)upgrade_port_checkpoint_write(&module.checkpoint,
+                                        sizeof(module.checkpoint));
+}
+
+static void checkpoint_clear(void)
+{
+    memset(&module.checkpoint, 0, sizeof(module.checkpoint));
+    (void)upgrade_port_checkpoint_write(&module.checkpoint,
+                                        sizeof(module.checkpoint));
+}
+
+static int checkpoint_is_valid(struct checkpoint_t *checkpoint_p)
+{
+    return ((checkpoint_p->header_size != 0)
+            && (crc_32(0,
+                       checkpoint_p,
+                       offsetof(struct checkpoint_t, crc))
+                == checkpoint_p->crc));
+}
+
+/**
+ * Load the latest checkpoint, from memory or from the port if
+ * missing in memory, for example after a reboot.
+ */
+static int checkpoint_load(void)
+{
+    if (checkpoint_is_valid(&module.checkpoint)) {
+        return (0);
+    }
+
+    if (upgrade_port_checkpoint_read(&module.checkpoint,
+                                     sizeof(module.checkpoint)) != 0) {
+        return (-ENOENT);
+    }
+
+    if (!checkpoint_is_valid(&module.checkpoint)) {
+        memset(&module.checkpoint, 0, sizeof(module.checkpoint));
+
+        return (-ENOENT);
+    }
+
+    return (0);
+}
+
+/**
+ * Write given block to the application area and save a checkpoint on
+ * success.
+ */
+static int block_write(struct block_t *block_p)
+{
+    int res;
+
+    res = upgrade_port_binary_upload(&block_p->buf[0], block_p->size);
+
+    if (res == 0) {
+        checkpoint_save(&block_p->stream);
+    }
+
+    return (res);
+}
+
+#if CONFIG_UPGRADE_PIPELINE == 1
+
+static THRD_STACK(writer_stack, CONFIG_UPGRADE_PIPELINE_STACK_SIZE);
+
+/**
+ * Programs filled blocks while the next block is received.
+ */
+static void *writer_main(void *arg_p)
+{
+    struct block_t *block_p;
+    int res;
+
+    thrd_set_name("upgrade_writer");
+
+    while (1) {
+        sem_take(&module.pipeline.used, NULL);
+
+        block_p = &module.pipeline.blocks[module.pipeline.write_index];
+        module.pipeline.write_index ^= 1;
+
+        /* Skip remaining blocks after a failure. */
+        if (module.pipeline.res == 0) {
+            res = block_write(block_p);
+
+            if (res != 0) {
+                module.pipeline.res = res;
+            }
+        }
+
+        sem_give(&module.pipeline.free, 1);
+    }
+
+    return (NULL);
+}
+
+static int pipeline_start(void)
+{
+    if (module.pipeline.thrd_p != NULL) {
+        return (0);
+    }
+
+    sem_init(&module.pipeline.free, BLOCKS_MAX, BLOCKS_MAX);
+    sem_init(&module.pipeline.used, 0, BLOCKS_MAX);
+    module.pipeline.fill_index = 0;
+    module.pipeline.write_index = 0;
+    module.pipeline.thrd_p = thrd_spawn(writer_main,
+                                        NULL,
+                                        0,
+                                        writer_stack,
+                                        sizeof(writer_stack));
+
+    if (module.pipeline.thrd_p == NULL) {
+        return (-ENOMEM);
+    }
+
+    return (0);
+}
+
+static struct block_t *block_get(void)
+{
+    struct block_t *block_p;
+
+    if (module.pipeline.block_p == NULL) {
+        sem_take(&module.pipeline.free, NULL);
+        block_p = &module.pipeline.blocks[module.pipeline.fill_index];
+        block_p->size = 0;
+        module.pipeline.block_p = block_p;
+    }
+
+    return (module.pipeline.block_p);
+}
+
+/**
+ * Hand the filled block over to the writer thread.
+ */
+static int block_submit(void)
+{
+    module.pipeline.block_p->stream = module.stream;
+    module.pipeline.block_p = NULL;
+    module.pipeline.fill_index ^= 1;
+    sem_give(&module.pipeline.used, 1);
+
+    return (module.pipeline.res);
+}
+
+/**
+ * Wait for the writer to finish all submitted blocks.
+ */
+static void pipeline_sync(void)
+{
+    int i;
+    int count;
+
+    count = BLOCKS_MAX;
+
+    if (module.pipeline.block_p != NULL) {
+        count--;
+    }
+
+    for (i = 0; i < count; i++) {
+        sem_take(&module.pipeline.free, NULL);
+    }
+
+    sem_give(&module.pipeline.free, count);
+}
+
+/**
+ * Drop the block being filled, if any, and wait for the writer to
+ * finish all submitted blocks.
+ */
+static void pipeline_wait(void)
+{
+    if (module.pipeline.block_p != NULL) {
+        module.pipeline.block_p = NULL;
+        sem_give(&module.pipeline.free, 1);
+    }
+
+    pipeline_sync();
+}
+
+#else
+
+static int pipeline_start(void)
+{
+    return (0);
+}
+
+static struct block_t *block_get(void)
+{
+    if (module.pipeline.block_p == NULL) {
+        module.pipeline.block_p = &module.pipeline.blocks[0];
+        module.pipeline.block_p->size = 0;
+    }
+
+    return (module.pipeline.block_p);
+}
+
+static int block_submit(void)
+{
+    int res;
+
+    module.pipeline.block_p->stream = module.stream;
+    res = block_write(module.pipeline.block_p);
+    module.pipeline.block_p = NULL;
+
+    if (res != 0) {
+        module.pipeline.res = res;
+    }
+
+    return (res);
+}
+
+static void pipeline_sync(void)
+{
+}
+
+static void pipeline_wait(void)
+{
+    module.pipeline.block_p = NULL;
+}
+
+#endif
+
+/**
+ * Write any buffered data and wait for all data to be written.
+ */
+static int pipeline_flush(void)
+{
+    if (module.pipeline.block_p != NULL) {
+        if (module.pipeline.block_p->size > 0) {
+            (void)block_submit();
+        }
+    }
+
+    pipeline_wait();
+
+    return (module.pipeline.res);
+}
+
+/**
+ * Verify and buffer given data, and write full blocks to the
+ * application area.
+ */
+static int data_write(const uint8_t *buf_p, size_t size)
+{
+    struct block_t *block_p;
+    size_t chunk_size;
+
+    if (module.pipeline.res != 0) {
+        return (module.pipeline.res);
+    }
+
+    if (size > module.header.size - module.stream.offset) {
+        log_object_print(NULL,
+                         LOG_ERROR,
+                         OSTR("upgrade data size exceeds %u\r\n"),
+                         module.header.size);
+        return (-1);
+    }
+
+    while (size > 0) {
+        block_p = block_get();
+        chunk_size = MIN(size, sizeof(block_p->buf) - block_p->size);
+        stream_update(&module.stream, buf_p, chunk_size);
+        memcpy(&block_p->buf[block_p->size], buf_p, chunk_size);
+        block_p->size += chunk_size;
+        buf_p += chunk_size;
+        size -= chunk_size;
+
+        if (block_p->size == sizeof(block_p->buf)) {
+            if (block_submit() != 0) {
+                return (-1);
+            }
+        }
+    }
 
     return (0);
 }
@@ -259,8 +679,19 @@ int upgrade_application_is_valid(int quick)
 
 int upgrade_binary_upload_begin()
 {
+    int res;
+
+    res = pipeline_start();
+
+    if (res != 0) {
+        return (res);
+    }
+
+    pipeline_wait();
+    module.pipeline.res = 0;
     module.header_size = -1;
     module.offset = 0;
+    checkpoint_clear();
 
     return (upgrade_port_binary_upload_begin());
 }
@@ -317,6 +748,10 @@ int upgrade_binary_upload(const void *buf_p,
                          module.header.description,
                          module.header.size);
 
+        stream_init(&module.stream);
+        module.checkpoint.header_size = module.header_size;
+        checkpoint_save(&module.stream);
+
         chunk_size = (module.header_size - (module.offset - chunk_size));
         size -= chunk_size;
         buf_p += chunk_size;
@@ -327,10 +762,101 @@ int upgrade_binary_upload(const void *buf_p,
         }
     }
 
-    return (upgrade_port_binary_upload(buf_p, size));
+    return (data_write(buf_p, size));
 }
 
 int upgrade_binary_upload_end()
 {
+    int res;
+
+    res = pipeline_flush();
+
+    /* Nothing to verify if the header has not been received. */
+    if (module.header_size != 0) {
+        return (upgrade_port_binary_upload_end());
+    }
+
+    if (res != 0) {
+        return (res);
+    }
+
+    /* Keep the checkpoint to allow the upload to be resumed. */
+    if (module.stream.offset != module.header.size) {
+        log_object_print(NULL,
+                         LOG_ERROR,
+                         OSTR("upgrade data incomplete, %u of %u bytes\r\n"),
+                         module.stream.offset,
+                         module.header.size);
+        return (-1);
+    }
+
+    checkpoint_clear();
+
+    if (!stream_is_valid(&module.stream)) {
+        log_object_print(NULL,
+                         LOG_ERROR,
+                         OSTR("upgrade data digest mismatch\r\n"));
+        return (-1);
+    }
+
     return (upgrade_port_binary_upload_end());
 }
+
+ssize_t upgrade_binary_upload_resume()
+{
+    int res;
+
+    res = pipeline_start();
+
+    if (res != 0) {
+        return (res);
+    }
+
+    /* Data received after the checkpoint is received again. */
+    pipeline_wait();
+
+    res = checkpoint_load();
+
+    if (res != 0) {
+        return (res);
+    }
+
+    res = upgrade_port_binary_upload_resume(
+        module.checkpoint.stream.offset);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    module.pipeline.res = 0;
+    module.header_size = 0;
+    module.header = module.checkpoint.header;
+    module.stream = module.checkpoint.stream;
+
+    log_object_print(NULL,
+                     LOG_INFO,
+                     OSTR("resuming upgrade at data offset %u\r\n"),
+                     module.stream.offset);
+
+    return (module.checkpoint.header_size + module.stream.offset);
+}
+
+ssize_t upgrade_binary_upload_get_checkpoint()
+{
+    int res;
+
+    res = pipeline_start();
+
+    if (res != 0) {
+        return (res);
+    }
+
+    pipeline_sync();
+    res = checkpoint_load();
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (module.checkpoint.header_size + module.checkpoint.stream.offset);
+}
@@ -110,7 +110,11 @@ int upgrade_application_is_valid(int quick);
 int upgrade_binary_upload_begin(void);
 
 /**
- * Add data to current upload transaction.
+ * Add data to current upload transaction. The data is verified while
+ * received and written to the application area in blocks of
+ * ``CONFIG_UPGRADE_BUFFER_SIZE`` bytes. A checkpoint is saved after
+ * each written block, which an interrupted upload transaction can be
+ * resumed from with `upgrade_binary_upload_resume()`.
  *
  * @param[in] buf_p Buffer to write.
  * @param[in] size Size of the buffer.
@@ -121,10 +125,30 @@ int upgrade_binary_upload(const void *buf_p,
                           size_t size);
 
 /**
- * End current upload transaction.
+ * End current upload transaction. Fails if not all data given in the
+ * header has been received, or if the data digest does not match the
+ * digest in the header.
  *
  * @return zero(0) or negative error code.
  */
 int upgrade_binary_upload_end(void);
 
+/**
+ * Resume an interrupted upload transaction from its latest
+ * checkpoint. The sender shall continue sending the .ubin file from
+ * the returned offset.
+ *
+ * @return Offset in the .ubin file to continue from, or negative
+ *         error code.
+ */
+ssize_t upgrade_binary_upload_resume(void);
+
+/**
+ * Get the offset in the .ubin file of the latest checkpoint of an
+ * interrupted or ongoing upload transaction.
+ *
+ * @return Checkpoint offset, or negative error code.
+ */
+ssize_t upgrade_binary_upload_get_checkpoint(void);
+
 #endif
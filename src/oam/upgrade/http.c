@@ -47,6 +47,8 @@ static int http_request_application_is_valid(struct http_server_connection_t *co
                                              struct http_server_request_t *request_p);
 static int http_request_upload(struct http_server_connection_t *connection_p,
                                struct http_server_request_t *request_p);
+static int http_request_upload_resume(struct http_server_connection_t *connection_p,
+                                      struct http_server_request_t *request_p);
 static int http_request_bootloader_enter(struct http_server_connection_t *connection_p,
                                          struct http_server_request_t *request_p);
 
@@ -61,6 +63,8 @@ static struct http_server_route_t routes[] = {
       .callback = http_request_application_erase },
     { .path_p = "/oam/upgrade/application/is_valid",
       .callback = http_request_application_is_valid },
+    { .path_p = "/oam/upgrade/upload/resume",
+      .callback = http_request_upload_resume },
     { .path_p = "/oam/upgrade/upload",
       .callback = http_request_upload },
     { .path_p = "/oam/upgrade/bootloader/enter",
@@ -192,54 +196,22 @@ static int http_request_application_is_valid(struct http_server_connection_t *co
 }
 
 /**
- * HTTP server request to upload an upgrade file.
+ * Write the request body to the application area and respond.
  *
  * @return zero(0) or negative error code.
  */
-static int http_request_upload(struct http_server_connection_t *connection_p,
-                               struct http_server_request_t *request_p)
+static int upload_body(struct http_server_connection_t *connection_p,
+                       struct http_server_request_t *request_p,
+                       int res)
 {
     struct http_server_response_t response;
-    int res;
     char buf[512];
     size_t left;
     size_t size;
 
-    /* Only the POST action is supported. */
-    if (request_p->action != http_server_request_action_post_t) {
-        return (-1);
-    }
-
-    /* Only accept application/octet-stream content. */
-    if ((request_p->headers.content_type.present == 0) ||
-        strcmp(&request_p->headers.content_type.value[0],
-               "application/octet-stream") != 0) {
-        return (-1);
-    }
-
-    /* Content length must be present. */
-    if (request_p->headers.content_length.present == 0) {
-        return (-1);
-    }
-
     left = request_p->headers.content_length.value;
 
-    /* Reply with "100 Continue" if expected by the client. */
-    if (request_p->headers.expect.present == 1) {
-        if (strcmp(&request_p->headers.expect.value[0], "100-continue") != 0) {
-            return (-1);
-        }
-
-        if (chan_write(&connection_p->socket,
-                       "HTTP/1.1 100 Continue\r\n\r\n",
-                       29) != 29) {
-            return (-1);
-        }
-    }
-
     /* Write received octet stream to the application area. */
-    res = upgrade_binary_upload_begin();
-
     if (res == 0) {
         while ((res == 0) && (left > 0)) {
             if (left > sizeof(buf)) {
@@ -278,6 +250,107 @@ static int http_request_upload(struct http_server_connection_t *connection_p,
                                        &response));
 }
 
+/**
+ * Check that the request is a POST with an octet stream, and send
+ * "100 Continue" if expected by the client.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int upload_prepare(struct http_server_connection_t *connection_p,
+                          struct http_server_request_t *request_p)
+{
+    /* Only the POST action is supported. */
+    if (request_p->action != http_server_request_action_post_t) {
+        return (-1);
+    }
+
+    /* Only accept application/octet-stream content. */
+    if ((request_p->headers.content_type.present == 0) ||
+        strcmp(&request_p->headers.content_type.value[0],
+               "application/octet-stream") != 0) {
+        return (-1);
+    }
+
+    /* Content length must be present. */
+    if (request_p->headers.content_length.present == 0) {
+        return (-1);
+    }
+
+    /* Reply with "100 Continue" if expected by the client. */
+    if (request_p->headers.expect.present == 1) {
+        if (strcmp(&request_p->headers.expect.value[0], "100-continue") != 0) {
+            return (-1);
+        }
+
+        if (chan_write(&connection_p->socket,
+                       "HTTP/1.1 100 Continue\r\n\r\n",
+                       29) != 29) {
+            return (-1);
+        }
+    }
+
+    return (0);
+}
+
+/**
+ * HTTP server request to upload an upgrade file.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int http_request_upload(struct http_server_connection_t *connection_p,
+                               struct http_server_request_t *request_p)
+{
+    if (upload_prepare(connection_p, request_p) != 0) {
+        return (-1);
+    }
+
+    return (upload_body(connection_p,
+                        request_p,
+                        upgrade_binary_upload_begin()));
+}
+
+/**
+ * HTTP server request to resume an interrupted upload. GET resumes
+ * the upload and responds with the offset in the upgrade file to
+ * continue from. POST writes the rest of the upgrade file, starting
+ * at that offset.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int http_request_upload_resume(struct http_server_connection_t *connection_p,
+                                      struct http_server_request_t *request_p)
+{
+    struct http_server_response_t response;
+    char buf[16];
+    ssize_t offset;
+
+    if (request_p->action == http_server_request_action_get_t) {
+        offset = upgrade_binary_upload_resume();
+
+        if (offset >= 0) {
+            response.code = http_server_response_code_200_ok_t;
+            std_sprintf(&buf[0], FSTR("%ld"), (long)offset);
+            response.content.buf_p = &buf[0];
+        } else {
+            response.code = http_server_response_code_400_bad_request_t;
+            response.content.buf_p = "nothing to resume";
+        }
+
+        response.content.type = http_server_content_type_text_plain_t;
+        response.content.size = strlen(response.content.buf_p);
+
+        return (http_server_response_write(connection_p,
+                                           request_p,
+                                           &response));
+    }
+
+    if (upload_prepare(connection_p, request_p) != 0) {
+        return (-1);
+    }
+
+    return (upload_body(connection_p, request_p, 0));
+}
+
 /**
  * HTTP server request to enter the bootloader.
  *
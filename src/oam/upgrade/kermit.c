@@ -64,6 +64,7 @@ struct upgrade_kermit_t {
 
 static struct upgrade_kermit_t module;
 static struct fs_command_t cmd_application_kermit_load;
+static struct fs_command_t cmd_application_kermit_resume;
 
 /**
  * Encode given binary value to a printable ascii value.
@@ -327,6 +328,47 @@ static int cmd_application_kermit_load_cb(int argc,
     return (upgrade_kermit_load_file());
 }
 
+/**
+ * Shell command that resumes an interrupted file transfer.
+ */
+static int cmd_application_kermit_resume_cb(int argc,
+                                            const char *argv[],
+                                            void *out_p,
+                                            void *in_p,
+                                            void *arg_p,
+                                            void *call_arg_p)
+{
+    return (upgrade_kermit_resume_file());
+}
+
+/**
+ * Receive packets until the file transfer is completed, and end the
+ * upload transaction.
+ */
+static int receive_file(void)
+{
+    int res;
+
+    while (1) {
+        res = handle_packet();
+
+        if (res == 1) {
+            std_printf(FSTR("software download successful\r\n"));
+            res = 0;
+            break;
+        } else if (res < 0) {
+            std_printf(FSTR("error: software download failed\r\n"));
+            break;
+        }
+    }
+
+    if (upgrade_binary_upload_end() != 0) {
+        return (-1);
+    }
+
+    return (res);
+}
+
 int upgrade_kermit_init(void *chin_p,
                         void *chout_p)
 {
@@ -339,13 +381,17 @@ int upgrade_kermit_init(void *chin_p,
                     NULL);
     fs_command_register(&cmd_application_kermit_load);
 
+    fs_command_init(&cmd_application_kermit_resume,
+                    CSTR("/oam/upgrade/kermit/resume"),
+                    cmd_application_kermit_resume_cb,
+                    NULL);
+    fs_command_register(&cmd_application_kermit_resume);
+
     return (0);
 }
 
 int upgrade_kermit_load_file()
 {
-    int res;
-
     std_printf(FSTR("Ready to receive a file over the Kermit file "
                     "transfer protocol.\r\n"
                     "\r\n"
@@ -358,22 +404,27 @@ int upgrade_kermit_load_file()
         return (-1);
     }
 
-    while (1) {
-        res = handle_packet();
+    return (receive_file());
+}
 
-        if (res == 1) {
-            std_printf(FSTR("software download successful\r\n"));
-            res = 0;
-            break;
-        } else if (res < 0) {
-            std_printf(FSTR("error: software download failed\r\n"));
-            break;
-        }
-    }
+int upgrade_kermit_resume_file()
+{
+    ssize_t offset;
 
-    if (upgrade_binary_upload_end() != 0) {
-        return (-1);
+    offset = upgrade_binary_upload_resume();
+
+    if (offset < 0) {
+        std_printf(FSTR("error: no software download to resume\r\n"));
+
+        return (offset);
     }
 
-    return (res);
+    std_printf(FSTR("Ready to resume the file transfer at offset %ld.\r\n"
+                    "\r\n"
+                    "In kermit; press '\\+c' and use the kermit command "
+                    "'send' to send the rest of the file, starting at "
+                    "given offset.\r\n"),
+               (long)offset);
+
+    return (receive_file());
 }
@@ -49,4 +49,13 @@ int upgrade_kermit_init(void *chin_p,
  */
 int upgrade_kermit_load_file(void);
 
+/**
+ * Resume an interrupted file transfer. The rest of the file, starting
+ * at the printed offset, is loaded using the kermit file transfer
+ * protocol.
+ *
+ * @returns zero(0) or negative error code.
+ */
+int upgrade_kermit_resume_file(void);
+
 #endif
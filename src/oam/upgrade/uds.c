@@ -37,6 +37,7 @@
 /* Data IDentifiers (DID). */
 #define DID_VERSION                                      0xf000
 #define DID_SYSTEM_TIME                                  0xf001
+#define DID_UPLOAD_CHECKPOINT                            0xf002
 
 /* Routines. */
 #define ROUTINE_ID_ERASE                                 0xff00
@@ -295,6 +296,35 @@ static int handle_read_data_by_identifier_system_time(struct upgrade_uds_t *self
                                strlen(buf) + 1));
 }
 
+/**
+ * Handle the read upload checkpoint DID request. The checkpoint is
+ * the offset in the upgrade file to resume an interrupted download
+ * from, or zero(0) if there is no download to resume.
+ *
+ * @param[in] self_p UDS object..
+ *
+ * @returns zero(0) or negative error code.
+ */
+static int handle_read_data_by_identifier_upload_checkpoint(struct upgrade_uds_t *self_p)
+{
+    ssize_t offset;
+    uint32_t checkpoint;
+
+    offset = upgrade_binary_upload_get_checkpoint();
+
+    if (offset < 0) {
+        offset = 0;
+    }
+
+    checkpoint = htonl(offset);
+
+    return (write_did_response(self_p->chout_p,
+                               (READ_DATA_BY_IDENTIFIER | POSITIVE_RESPONSE),
+                               DID_UPLOAD_CHECKPOINT,
+                               &checkpoint,
+                               sizeof(checkpoint)));
+}
+
 /**
  * Handle the diagnostic session control request to enter the default
  * session (application).
@@ -458,6 +488,10 @@ static int handle_read_data_by_identifier(struct upgrade_uds_t *self_p,
         res = handle_read_data_by_identifier_system_time(self_p);
         break;
 
+    case DID_UPLOAD_CHECKPOINT:
+        res = handle_read_data_by_identifier_upload_checkpoint(self_p);
+        break;
+
     default:
         ignore_and_write_negative_response(self_p,
                                            length,
@@ -592,6 +626,7 @@ static int handle_request_download(struct upgrade_uds_t *self_p,
     uint8_t buf[5];
     uint32_t address;
     uint32_t size;
+    ssize_t offset;
 
     /* Length check. */
     if (length < 3) {
@@ -633,7 +668,22 @@ static int handle_request_download(struct upgrade_uds_t *self_p,
     /* Save the address and size. */
     self_p->swdl.next_block_sequence_counter = 1;
 
-    if (upgrade_binary_upload_begin() != 0) {
+    /* A non-zero address resumes an interrupted download from given
+       offset, which must be the checkpoint offset. */
+    address = ntohl(address);
+
+    if (address != 0) {
+        offset = upgrade_binary_upload_resume();
+
+        if ((offset < 0) || (offset != address)) {
+            ignore_and_write_negative_response(self_p,
+                                               length,
+                                               REQUEST_DOWNLOAD,
+                                               REQUEST_OUT_OF_RANGE);
+
+            return (-1);
+        }
+    } else if (upgrade_binary_upload_begin() != 0) {
         ignore_and_write_negative_response(self_p,
                                            length,
                                            REQUEST_DOWNLOAD,
@@ -93,6 +93,7 @@ typedef intptr_t longptr_t;
 
 #include "kernel/time.h"
 
+#include "sync/contention.h"
 #include "sync/sem.h"
 
 #include "sync/chan.h"
@@ -122,6 +123,7 @@ typedef intptr_t longptr_t;
 #include "oam/nvm.h"
 
 #include "debug/log.h"
+#include "debug/profiler.h"
 
 #include "text/color.h"
 #include "text/re.h"
@@ -136,6 +138,7 @@ typedef intptr_t longptr_t;
 
 #include "hash/crc.h"
 #include "hash/sha1.h"
+#include "hash/sha256.h"
 
 #include "inet/types.h"
 #include "inet/inet.h"
@@ -280,6 +283,7 @@ typedef intptr_t longptr_t;
 #endif
 
 #include "inet/isotp.h"
+#include "inet/isotp_manager.h"
 
 #include "debug/harness.h"
 
@@ -34,7 +34,7 @@ ifeq ($(TYPE),suite)
 
   ALLOC_SRC += heap.c
   COLLECTIONS_SRC += circular_buffer.c binary_tree.c list.c
-  DEBUG_SRC += log.c harness.c
+  DEBUG_SRC += log.c harness.c profiler.c
   DRIVERS_SRC += storage/flash.c network/uart.c
   ENCODE_SRC +=
   HASH_SRC +=
@@ -45,7 +45,8 @@ ifeq ($(TYPE),suite)
   OAM_SRC += console.c settings.c nvm.c
   FILESYSTEMS_SRC += fs.c
   SPIFFS_SRC +=
-  SYNC_SRC += chan.c queue.c rwlock.c sem.c mutex.c bus.c event.c
+  SYNC_SRC += chan.c queue.c rwlock.c sem.c mutex.c bus.c event.c \
+	      contention.c
   TEXT_SRC += std.c
   SCIENCE_SRC +=
 
@@ -106,7 +107,8 @@ SRC += $(COLLECTIONS_SRC:%=$(SIMBA_ROOT)/src/collections/%)
 
 # Debug package.
 DEBUG_SRC ?= log.c \
-	     harness.c
+	     harness.c \
+	     profiler.c
 
 SRC += $(DEBUG_SRC:%=$(SIMBA_ROOT)/src/debug/%)
 
@@ -182,7 +184,8 @@ SRC += $(ENCODE_SRC:%=$(SIMBA_ROOT)/src/encode/%)
 
 # Hash package.
 HASH_SRC ?= crc.c \
-	    sha1.c
+	    sha1.c \
+	    sha256.c
 
 SRC += $(HASH_SRC:%=$(SIMBA_ROOT)/src/hash/%)
 
@@ -200,6 +203,7 @@ INET_SRC_TMP = \
 	http_websocket_client.c \
 	inet.c \
 	isotp.c \
+	isotp_manager.c \
 	mqtt_client.c \
 	tftp_server.c \
 	network_interface.c \
@@ -407,6 +411,7 @@ SRC += $(SPIFFS_SRC:%=$(SIMBA_ROOT)/%)
 SYNC_SRC ?= bus.c \
 	    chan.c \
 	    cond.c \
+	    contention.c \
 	    event.c \
 	    mutex.c \
 	    queue.c \
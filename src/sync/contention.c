@@ -0,0 +1,288 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+struct module_t {
+    int8_t initialized;
+    struct contention_t *head_p;
+#if CONFIG_SYNC_CONTENTION_FS_COMMANDS == 1
+    struct fs_command_t cmd_contention;
+#endif
+};
+
+static struct module_t module;
+
+#if CONFIG_SYNC_CONTENTION_FS_COMMANDS == 1
+
+static unsigned long time_to_us(struct time_t *time_p)
+{
+    return (1000000ul * time_p->seconds + time_p->nanoseconds / 1000);
+}
+
+/**
+ * Print the waiters of given primitive, most frequent first.
+ */
+static void print_waiters(void *chout_p, struct contention_waiter_t *waiters_p)
+{
+    struct contention_waiter_t waiters[CONFIG_SYNC_CONTENTION_WAITERS_MAX];
+    struct contention_waiter_t waiter;
+    int i;
+    int j;
+
+    memcpy(&waiters[0], waiters_p, sizeof(waiters));
+
+    for (i = 1; i < membersof(waiters); i++) {
+        waiter = waiters[i];
+
+        for (j = i; (j > 0) && (waiters[j - 1].count < waiter.count); j--) {
+            waiters[j] = waiters[j - 1];
+        }
+
+        waiters[j] = waiter;
+    }
+
+    for (i = 0; i < membersof(waiters); i++) {
+        if (waiters[i].thrd_p == NULL) {
+            break;
+        }
+
+        std_fprintf(chout_p,
+                    OSTR(" %s(%lu)"),
+                    waiters[i].thrd_p->name_p,
+                    (unsigned long)waiters[i].count);
+    }
+}
+
+/**
+ * The shell command callback for "/sync/contention".
+ */
+static int cmd_contention_cb(int argc,
+                             const char *argv[],
+                             void *chout_p,
+                             void *chin_p,
+                             void *arg_p,
+                             void *call_arg_p)
+{
+    struct contention_t *contention_p;
+    struct contention_t contention;
+
+    if ((argc == 2) && (strcmp(argv[1], "reset") == 0)) {
+        return (contention_reset());
+    } else if (argc != 1) {
+        std_fprintf(chout_p, OSTR("Usage: contention [reset]\r\n"));
+
+        return (-EINVAL);
+    }
+
+    std_fprintf(chout_p,
+                OSTR("NAME              ACQUISITIONS   CONTENDED  "
+                     "TOTAL-WAIT-US  MAX-WAIT-US  TOP-WAITERS\r\n"));
+
+    contention_p = module.head_p;
+
+    while (contention_p != NULL) {
+        sys_lock();
+        contention = *contention_p;
+        sys_unlock();
+
+        std_fprintf(chout_p,
+                    OSTR("%-16s  %12lu  %10lu  %13lu  %11lu "),
+                    contention.name_p,
+                    (unsigned long)contention.acquisitions,
+                    (unsigned long)contention.contended,
+                    time_to_us(&contention.total_wait),
+                    time_to_us(&contention.max_wait));
+        print_waiters(chout_p, &contention.waiters[0]);
+        std_fprintf(chout_p, OSTR("\r\n"));
+
+        contention_p = contention.next_p;
+    }
+
+    return (0);
+}
+
+#endif
+
+/**
+ * Count a wait of the current thread. The table keeps the most
+ * frequent waiters; a new waiter replaces the least frequent one and
+ * inherits its count.
+ */
+static void add_waiter(struct contention_t *self_p)
+{
+    struct contention_waiter_t *waiter_p;
+    struct contention_waiter_t *min_p;
+    struct thrd_t *thrd_p;
+    int i;
+
+    thrd_p = thrd_self();
+    min_p = &self_p->waiters[0];
+
+    for (i = 0; i < membersof(self_p->waiters); i++) {
+        waiter_p = &self_p->waiters[i];
+
+        if (waiter_p->thrd_p == thrd_p) {
+            waiter_p->count++;
+
+            return;
+        }
+
+        if (waiter_p->count < min_p->count) {
+            min_p = waiter_p;
+        }
+    }
+
+    min_p->thrd_p = thrd_p;
+    min_p->count++;
+}
+
+int contention_module_init(void)
+{
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+    module.head_p = NULL;
+
+#if CONFIG_SYNC_CONTENTION_FS_COMMANDS == 1
+    fs_command_init(&module.cmd_contention,
+                    CSTR("/sync/contention"),
+                    cmd_contention_cb,
+                    NULL);
+    fs_command_register(&module.cmd_contention);
+#endif
+
+    return (0);
+}
+
+int contention_init(struct contention_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    memset(self_p, 0, sizeof(*self_p));
+
+    return (0);
+}
+
+int contention_add(struct contention_t *self_p, const char *name_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(name_p != NULL, EINVAL);
+
+    sys_lock();
+    self_p->name_p = name_p;
+    self_p->next_p = module.head_p;
+    module.head_p = self_p;
+    sys_unlock();
+
+    return (0);
+}
+
+int contention_remove(struct contention_t *self_p)
+{
+    struct contention_t **curr_pp;
+    int res;
+
+    ASSERTN(self_p != NULL, EINVAL);
+
+    res = -ENOENT;
+
+    sys_lock();
+
+    curr_pp = &module.head_p;
+
+    while (*curr_pp != NULL) {
+        if (*curr_pp == self_p) {
+            *curr_pp = self_p->next_p;
+            self_p->next_p = NULL;
+            res = 0;
+            break;
+        }
+
+        curr_pp = &(*curr_pp)->next_p;
+    }
+
+    sys_unlock();
+
+    return (res);
+}
+
+int contention_reset(void)
+{
+    struct contention_t *contention_p;
+
+    sys_lock();
+
+    contention_p = module.head_p;
+
+    while (contention_p != NULL) {
+        contention_p->acquisitions = 0;
+        contention_p->contended = 0;
+        contention_p->total_wait.seconds = 0;
+        contention_p->total_wait.nanoseconds = 0;
+        contention_p->max_wait.seconds = 0;
+        contention_p->max_wait.nanoseconds = 0;
+        memset(&contention_p->waiters[0], 0, sizeof(contention_p->waiters));
+        contention_p = contention_p->next_p;
+    }
+
+    sys_unlock();
+
+    return (0);
+}
+
+void contention_acquired_isr(struct contention_t *self_p)
+{
+    self_p->acquisitions++;
+}
+
+void contention_waited_isr(struct contention_t *self_p,
+                           struct time_t *start_p,
+                           int acquired)
+{
+    struct time_t now;
+    struct time_t wait;
+
+    sys_uptime_isr(&now);
+    time_subtract(&wait, &now, start_p);
+    time_add(&self_p->total_wait, &self_p->total_wait, &wait);
+
+    if (time_compare(&wait, &self_p->max_wait) == time_compare_greater_than_t) {
+        self_p->max_wait = wait;
+    }
+
+    if (acquired == 1) {
+        self_p->acquisitions++;
+    }
+
+    self_p->contended++;
+    add_waiter(self_p);
+}
@@ -0,0 +1,135 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __SYNC_CONTENTION_H__
+#define __SYNC_CONTENTION_H__
+
+#include "simba.h"
+
+/**
+ * A thread that has waited for a synchronization primitive.
+ */
+struct contention_waiter_t {
+    struct thrd_t *thrd_p;
+    /** Number of waits. */
+    uint32_t count;
+};
+
+/**
+ * Contention statistics of a mutex, semaphore or reader-writer
+ * lock. Embedded in the primitive when ``CONFIG_SYNC_CONTENTION`` is
+ * enabled.
+ */
+struct contention_t {
+    const char *name_p;
+    /** Number of times the primitive was acquired. */
+    uint32_t acquisitions;
+    /** Number of times a thread had to wait for the primitive. */
+    uint32_t contended;
+    /** Total and longest wait time. */
+    struct time_t total_wait;
+    struct time_t max_wait;
+    /** The threads that waited most often. */
+    struct contention_waiter_t waiters[CONFIG_SYNC_CONTENTION_WAITERS_MAX];
+    struct contention_t *next_p;
+};
+
+/**
+ * Initialize the contention module. This function must be called
+ * before calling any other function in this module.
+ *
+ * The module will only be initialized once even if this function is
+ * called multiple times.
+ *
+ * @return zero(0) or negative error code
+ */
+int contention_module_init(void);
+
+/**
+ * Initialize given contention statistics. Called by the
+ * initialization function of the primitive.
+ *
+ * @param[out] self_p Contention statistics to initialize.
+ *
+ * @return zero(0) or negative error code.
+ */
+int contention_init(struct contention_t *self_p);
+
+/**
+ * Name given contention statistics and add it to the list reported
+ * by the ``/sync/contention`` file system command, for example
+ * ``contention_add(&foo.contention, "foo")`` for the mutex ``foo``.
+ *
+ * @param[in] self_p Contention statistics to add.
+ * @param[in] name_p Name of the primitive.
+ *
+ * @return zero(0) or negative error code.
+ */
+int contention_add(struct contention_t *self_p, const char *name_p);
+
+/**
+ * Remove given contention statistics from the list. Must be called
+ * before a primitive added with `contention_add()` goes out of scope.
+ *
+ * @param[in] self_p Contention statistics to remove.
+ *
+ * @return zero(0) if removed, otherwise negative error code.
+ */
+int contention_remove(struct contention_t *self_p);
+
+/**
+ * Reset the statistics of all primitives in the list.
+ *
+ * @return zero(0) or negative error code.
+ */
+int contention_reset(void);
+
+/**
+ * Count an acquisition without waiting. Called with the system lock
+ * taken.
+ *
+ * @param[in] self_p Contention statistics.
+ */
+void contention_acquired_isr(struct contention_t *self_p);
+
+/**
+ * Count a wait of the current thread that started at given
+ * uptime. Called with the system lock taken after the thread has
+ * been resumed.
+ *
+ * @param[in] self_p Contention statistics.
+ * @param[in] start_p Uptime when the wait started, as returned by
+ *                    `sys_uptime_isr()`.
+ * @param[in] acquired true(1) if the primitive was acquired, false(0)
+ *                     on timeout.
+ */
+void contention_waited_isr(struct contention_t *self_p,
+                           struct time_t *start_p,
+                           int acquired);
+
+#endif
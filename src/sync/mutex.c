@@ -38,6 +38,10 @@ int mutex_init(struct mutex_t *self_p)
     self_p->is_locked = 0;
     thrd_prio_list_init(&self_p->waiters);
 
+#if CONFIG_SYNC_CONTENTION == 1
+    contention_init(&self_p->contention);
+#endif
+
     return (0);
 }
 
@@ -66,13 +70,25 @@ int mutex_unlock(struct mutex_t *self_p)
 int mutex_lock_isr(struct mutex_t *self_p)
 {
     struct thrd_prio_list_elem_t elem;
+#if CONFIG_SYNC_CONTENTION == 1
+    struct time_t start;
+#endif
 
     if (self_p->is_locked == 1) {
+#if CONFIG_SYNC_CONTENTION == 1
+        sys_uptime_isr(&start);
+#endif
         elem.thrd_p = thrd_self();
         thrd_prio_list_push_isr(&self_p->waiters, &elem);
         thrd_suspend_isr(NULL);
+#if CONFIG_SYNC_CONTENTION == 1
+        contention_waited_isr(&self_p->contention, &start, 1);
+#endif
     } else {
         self_p->is_locked = 1;
+#if CONFIG_SYNC_CONTENTION == 1
+        contention_acquired_isr(&self_p->contention);
+#endif
     }
 
     return (0);
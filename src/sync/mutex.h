@@ -36,6 +36,10 @@ struct mutex_t {
     int8_t is_locked;
     /** Wait list. */
     struct thrd_prio_list_t waiters;
+#if CONFIG_SYNC_CONTENTION == 1
+    /** Contention statistics. */
+    struct contention_t contention;
+#endif
 };
 
 /**
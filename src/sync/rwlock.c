@@ -48,6 +48,10 @@ int rwlock_init(struct rwlock_t *self_p)
     self_p->readers_p = NULL;
     self_p->writers_p = NULL;
 
+#if CONFIG_SYNC_CONTENTION == 1
+    contention_init(&self_p->contention);
+#endif
+
     return (0);
 }
 
@@ -57,6 +61,9 @@ int rwlock_reader_take(struct rwlock_t *self_p)
 
     struct rwlock_elem_t elem;
     int res = 0;
+#if CONFIG_SYNC_CONTENTION == 1
+    struct time_t start;
+#endif
 
     sys_lock();
 
@@ -64,12 +71,20 @@ int rwlock_reader_take(struct rwlock_t *self_p)
 
     /* Wait if the lock is taken by a writer. */
     if (self_p->number_of_writers > 0) {
+#if CONFIG_SYNC_CONTENTION == 1
+        sys_uptime_isr(&start);
+#endif
         elem.thrd_p = thrd_self();
         elem.next_p = self_p->readers_p;
         elem.prev_p = NULL;
         self_p->readers_p = &elem;
 
         thrd_suspend_isr(NULL);
+#if CONFIG_SYNC_CONTENTION == 1
+        contention_waited_isr(&self_p->contention, &start, 1);
+    } else {
+        contention_acquired_isr(&self_p->contention);
+#endif
     }
 
     sys_unlock();
@@ -117,6 +132,9 @@ int rwlock_writer_take(struct rwlock_t *self_p)
 
     struct rwlock_elem_t elem;
     int res = 0;
+#if CONFIG_SYNC_CONTENTION == 1
+    struct time_t start;
+#endif
 
     sys_lock();
 
@@ -125,12 +143,20 @@ int rwlock_writer_take(struct rwlock_t *self_p)
     /* Wait if the lock is taken by a reader or another writer. */
     if ((self_p->number_of_readers > 0)
         || (self_p->number_of_writers > 1)) {
+#if CONFIG_SYNC_CONTENTION == 1
+        sys_uptime_isr(&start);
+#endif
         elem.thrd_p = thrd_self();
         elem.next_p = self_p->writers_p;
         elem.prev_p = NULL;
         self_p->writers_p = &elem;
 
         thrd_suspend_isr(NULL);
+#if CONFIG_SYNC_CONTENTION == 1
+        contention_waited_isr(&self_p->contention, &start, 1);
+    } else {
+        contention_acquired_isr(&self_p->contention);
+#endif
     }
 
     sys_unlock();
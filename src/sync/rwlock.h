@@ -36,6 +36,10 @@ struct rwlock_t {
     int number_of_writers;
     volatile struct rwlock_elem_t *readers_p;
     volatile struct rwlock_elem_t *writers_p;
+#if CONFIG_SYNC_CONTENTION == 1
+    /** Contention statistics. */
+    struct contention_t contention;
+#endif
 };
 
 /**
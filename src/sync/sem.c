@@ -46,6 +46,10 @@ int sem_init(struct sem_t *self_p,
 
     thrd_prio_list_init(&self_p->waiters);
 
+#if CONFIG_SYNC_CONTENTION == 1
+    contention_init(&self_p->contention);
+#endif
+
     return (0);
 }
 
@@ -56,10 +60,16 @@ int sem_take(struct sem_t *self_p,
 
     int err = 0;
     struct thrd_prio_list_elem_t elem;
+#if CONFIG_SYNC_CONTENTION == 1
+    struct time_t start;
+#endif
 
     sys_lock();
 
     if (self_p->count == self_p->count_max) {
+#if CONFIG_SYNC_CONTENTION == 1
+        sys_uptime_isr(&start);
+#endif
         elem.thrd_p = thrd_self();
         thrd_prio_list_push_isr(&self_p->waiters, &elem);
         err = thrd_suspend_isr(timeout_p);
@@ -67,8 +77,15 @@ int sem_take(struct sem_t *self_p,
         if (err == -ETIMEDOUT) {
             thrd_prio_list_remove_isr(&self_p->waiters, &elem);
         }
+
+#if CONFIG_SYNC_CONTENTION == 1
+        contention_waited_isr(&self_p->contention, &start, err == 0);
+#endif
     } else {
         self_p->count++;
+#if CONFIG_SYNC_CONTENTION == 1
+        contention_acquired_isr(&self_p->contention);
+#endif
     }
 
     sys_unlock();
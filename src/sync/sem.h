@@ -53,6 +53,10 @@ struct sem_t {
     int count_max;
     /** Wait list. */
     struct thrd_prio_list_t waiters;
+#if CONFIG_SYNC_CONTENTION == 1
+    /** Contention statistics. */
+    struct contention_t contention;
+#endif
 };
 
 /**
@@ -162,6 +162,27 @@ enum op_code_t {
 
 #define NON_GREEDY_OFFSET                 3
 
+/* Set in the compiled flags byte if the pattern was lowered to an
+   automaton. */
+#define FLAG_AUTOMATON                 0x40
+
+/* Automaton instructions. Targets are offsets from the beginning of
+   the automaton program. */
+enum nfa_op_code_t {
+    NFA_OP_CODE_CHAR = 0,
+    NFA_OP_CODE_ANY,
+    NFA_OP_CODE_WHITESPACE,
+    NFA_OP_CODE_DECIMAL_DIGIT,
+    NFA_OP_CODE_ALPHANUMERIC,
+    NFA_OP_CODE_SET,
+    NFA_OP_CODE_SPLIT,
+    NFA_OP_CODE_JUMP,
+    NFA_OP_CODE_MATCH
+};
+
+/* Size of a set bitmap, one bit per character. */
+#define NFA_SET_SIZE                     32
+
 struct compile_t {
     char *compiled_p;
     const char *pattern_p;
@@ -170,6 +191,17 @@ struct compile_t {
     char *current_repetition_op_code_p;
 };
 
+struct lower_t {
+    char flags;
+    uint8_t *program_p;
+    size_t pos;
+};
+
+struct nfa_list_t {
+    uint8_t *pcs_p;
+    int length;
+};
+
 struct match_t {
     const char *compiled_p;
     char flags;
@@ -914,7 +946,7 @@ static int match_set(struct match_t *self_p)
     self_p->compiled_p += 2;
     compiled_end_p = (self_p->compiled_p + code_size);
 
-    while (*self_p->compiled_p != OP_CODE_RETURN) {
+    while (self_p->compiled_p < compiled_end_p) {
         if (*self_p->compiled_p++ == OP_CODE_SET_SINGLE) {
             switch (*self_p->compiled_p++) {
 
@@ -1060,6 +1092,468 @@ static ssize_t match(struct match_t *self_p)
     }
 }
 
+#if CONFIG_RE_AUTOMATON == 1
+
+/**
+ * Append given bytes to the automaton program.
+ */
+static int lower_emit(struct lower_t *self_p,
+                      const uint8_t *buf_p,
+                      size_t size)
+{
+    if (self_p->pos + size > CONFIG_RE_AUTOMATON_SIZE_MAX) {
+        return (-1);
+    }
+
+    memcpy(&self_p->program_p[self_p->pos], buf_p, size);
+    self_p->pos += size;
+
+    return (0);
+}
+
+/**
+ * Lower a single character operation to an automaton instruction.
+ *
+ * @return Size of the operation in the compiled pattern or negative
+ *         error code.
+ */
+static int lower_atom(struct lower_t *self_p, const char *compiled_p)
+{
+    uint8_t code[1 + NFA_SET_SIZE];
+    struct match_t state;
+    char value;
+    int code_size;
+    int i;
+
+    switch (compiled_p[0]) {
+
+    case OP_CODE_TEXT:
+        code[0] = NFA_OP_CODE_CHAR;
+        code[1] = compiled_p[1];
+
+        if (self_p->flags & RE_IGNORECASE) {
+            code[1] = tolower((int)compiled_p[1]);
+        }
+
+        return (lower_emit(self_p, &code[0], 2) == 0 ? 2 : -1);
+
+    case OP_CODE_DOT:
+        code[0] = NFA_OP_CODE_ANY;
+        break;
+
+    case OP_CODE_WHITESPACE:
+        code[0] = NFA_OP_CODE_WHITESPACE;
+        break;
+
+    case OP_CODE_DECIMAL_DIGIT:
+        code[0] = NFA_OP_CODE_DECIMAL_DIGIT;
+        break;
+
+    case OP_CODE_ALPHANUMERIC:
+        code[0] = NFA_OP_CODE_ALPHANUMERIC;
+        break;
+
+    case OP_CODE_SET:
+        /* Evaluate the set once for every character to create its
+           bitmap. */
+        code_size = ((compiled_p[1] << 8) | compiled_p[2]);
+        code[0] = NFA_OP_CODE_SET;
+        memset(&code[1], 0, NFA_SET_SIZE);
+
+        for (i = 0; i < 256; i++) {
+            value = (char)i;
+            state.compiled_p = &compiled_p[1];
+            state.flags = self_p->flags;
+            state.buf_p = &value;
+            state.buf_left = 1;
+            state.groups_p = NULL;
+            state.number_of_groups_p = NULL;
+
+            if (match_set(&state) == 1) {
+                code[1 + i / 8] |= (1 << (i % 8));
+            }
+        }
+
+        if (lower_emit(self_p, &code[0], sizeof(code)) != 0) {
+            return (-1);
+        }
+
+        return (3 + code_size);
+
+    default:
+        return (-1);
+    }
+
+    return (lower_emit(self_p, &code[0], 1) == 0 ? 1 : -1);
+}
+
+/**
+ * Lower a single character operation or a fixed number of it.
+ *
+ * @return Size of the term in the compiled pattern or negative error
+ *         code.
+ */
+static int lower_term(struct lower_t *self_p,
+                      const char *compiled_p,
+                      int *nullable_p)
+{
+    int code_size;
+    int number_of_members;
+    int size;
+    int i;
+
+    *nullable_p = 0;
+
+    if (compiled_p[0] != OP_CODE_MEMBERS) {
+        return (lower_atom(self_p, compiled_p));
+    }
+
+    code_size = ((compiled_p[1] << 8) | compiled_p[2]);
+    number_of_members = ((compiled_p[3] << 8) | compiled_p[4]);
+    size = 0;
+
+    for (i = 0; i < number_of_members; i++) {
+        size = lower_atom(self_p, &compiled_p[5]);
+
+        if (size < 0) {
+            return (size);
+        }
+    }
+
+    /* The atom must be followed by the return op code. */
+    if ((number_of_members > 0)
+        && ((size + 1 != code_size)
+            || (compiled_p[5 + size] != OP_CODE_RETURN))) {
+        return (-1);
+    }
+
+    *nullable_p = (number_of_members == 0);
+
+    return (5 + code_size);
+}
+
+/**
+ * Lower a repetition operation.
+ *
+ * @return Size of the repetition in the compiled pattern or negative
+ *         error code.
+ */
+static int lower_repetition(struct lower_t *self_p,
+                            const char *compiled_p)
+{
+    uint8_t code[3];
+    int op_code;
+    int code_size;
+    int size;
+    int nullable;
+    size_t begin;
+    size_t split;
+
+    op_code = compiled_p[0];
+    code_size = ((compiled_p[1] << 8) | compiled_p[2]);
+    begin = self_p->pos;
+
+    switch (op_code) {
+
+    case OP_CODE_ZERO_OR_ONE:
+    case OP_CODE_ZERO_OR_ONE_NON_GREEDY:
+    case OP_CODE_ZERO_OR_MORE:
+    case OP_CODE_ZERO_OR_MORE_NON_GREEDY:
+        /* Targets are patched below. */
+        split = self_p->pos;
+        code[0] = NFA_OP_CODE_SPLIT;
+
+        if (lower_emit(self_p, &code[0], 3) != 0) {
+            return (-1);
+        }
+
+        break;
+
+    default:
+        split = 0;
+        break;
+    }
+
+    size = lower_term(self_p, &compiled_p[3], &nullable);
+
+    if (size < 0) {
+        return (size);
+    }
+
+    /* The zero or one body is not followed by the return op code. */
+    if ((op_code == OP_CODE_ZERO_OR_ONE)
+        || (op_code == OP_CODE_ZERO_OR_ONE_NON_GREEDY)) {
+        if (size != code_size) {
+            return (-1);
+        }
+    } else {
+        /* An empty repetition body never terminates in the
+           backtracker. */
+        if (nullable
+            || (size + 1 != code_size)
+            || (compiled_p[3 + size] != OP_CODE_RETURN)) {
+            return (-1);
+        }
+    }
+
+    switch (op_code) {
+
+    case OP_CODE_ZERO_OR_MORE:
+    case OP_CODE_ZERO_OR_MORE_NON_GREEDY:
+        code[0] = NFA_OP_CODE_JUMP;
+        code[1] = begin;
+
+        if (lower_emit(self_p, &code[0], 2) != 0) {
+            return (-1);
+        }
+
+        break;
+
+    case OP_CODE_ONE_OR_MORE:
+    case OP_CODE_ONE_OR_MORE_NON_GREEDY:
+        split = self_p->pos;
+        code[0] = NFA_OP_CODE_SPLIT;
+
+        if (lower_emit(self_p, &code[0], 3) != 0) {
+            return (-1);
+        }
+
+        self_p->program_p[split + 1] = begin;
+        self_p->program_p[split + 2] = self_p->pos;
+
+        break;
+
+    default:
+        break;
+    }
+
+    /* First target is preferred. */
+    switch (op_code) {
+
+    case OP_CODE_ZERO_OR_ONE:
+    case OP_CODE_ZERO_OR_MORE:
+        self_p->program_p[split + 1] = (split + 3);
+        self_p->program_p[split + 2] = self_p->pos;
+        break;
+
+    case OP_CODE_ZERO_OR_ONE_NON_GREEDY:
+    case OP_CODE_ZERO_OR_MORE_NON_GREEDY:
+        self_p->program_p[split + 1] = self_p->pos;
+        self_p->program_p[split + 2] = (split + 3);
+        break;
+
+    case OP_CODE_ONE_OR_MORE_NON_GREEDY:
+        self_p->program_p[split + 1] = self_p->pos;
+        self_p->program_p[split + 2] = begin;
+        break;
+
+    default:
+        break;
+    }
+
+    return (3 + code_size);
+}
+
+/**
+ * Lower given compiled pattern to a non-deterministic automaton
+ * program. Patterns with operations that can not be lowered are left
+ * to the backtracker.
+ *
+ * @return Program size or negative error code.
+ */
+static int lower(struct lower_t *self_p, const char *compiled_p)
+{
+    uint8_t code;
+    int nullable;
+    int size;
+
+    while (*compiled_p != OP_CODE_RETURN) {
+        switch (*compiled_p) {
+
+        case OP_CODE_ZERO_OR_ONE:
+        case OP_CODE_ZERO_OR_MORE:
+        case OP_CODE_ONE_OR_MORE:
+        case OP_CODE_ZERO_OR_ONE_NON_GREEDY:
+        case OP_CODE_ZERO_OR_MORE_NON_GREEDY:
+        case OP_CODE_ONE_OR_MORE_NON_GREEDY:
+            size = lower_repetition(self_p, compiled_p);
+            break;
+
+        default:
+            size = lower_term(self_p, compiled_p, &nullable);
+            break;
+        }
+
+        if (size < 0) {
+            return (size);
+        }
+
+        compiled_p += size;
+    }
+
+    code = NFA_OP_CODE_MATCH;
+
+    if (lower_emit(self_p, &code, 1) != 0) {
+        return (-1);
+    }
+
+    return (self_p->pos);
+}
+
+/**
+ * Add a thread at given program counter to given list, following
+ * jumps and splits in priority order. A program counter is only added
+ * once per input position.
+ */
+static void nfa_add(const uint8_t *program_p,
+                    struct nfa_list_t *list_p,
+                    uint8_t *visited_p,
+                    int pc)
+{
+    if (visited_p[pc / 8] & (1 << (pc % 8))) {
+        return;
+    }
+
+    visited_p[pc / 8] |= (1 << (pc % 8));
+
+    switch (program_p[pc]) {
+
+    case NFA_OP_CODE_JUMP:
+        nfa_add(program_p, list_p, visited_p, program_p[pc + 1]);
+        break;
+
+    case NFA_OP_CODE_SPLIT:
+        nfa_add(program_p, list_p, visited_p, program_p[pc + 1]);
+        nfa_add(program_p, list_p, visited_p, program_p[pc + 2]);
+        break;
+
+    default:
+        list_p->pcs_p[list_p->length++] = pc;
+        break;
+    }
+}
+
+/**
+ * Run the automaton program over given buffer. All threads advance in
+ * lock step, one input character at a time, so the time is linear in
+ * the buffer size. Threads are kept in backtracking priority order,
+ * giving the same match as the backtracker.
+ *
+ * @return Number of matched bytes or negative error code.
+ */
+static ssize_t nfa_match(const uint8_t *program_p,
+                         char flags,
+                         const char *buf_p,
+                         size_t size)
+{
+    uint8_t pcs[2][CONFIG_RE_AUTOMATON_SIZE_MAX];
+    uint8_t visited[DIV_CEIL(CONFIG_RE_AUTOMATON_SIZE_MAX, 8)];
+    struct nfa_list_t lists[2];
+    struct nfa_list_t *current_p;
+    struct nfa_list_t *next_p;
+    struct nfa_list_t *tmp_p;
+    ssize_t matched_size;
+    size_t pos;
+    int pc;
+    int i;
+    int value;
+    int res;
+
+    lists[0].pcs_p = &pcs[0][0];
+    lists[0].length = 0;
+    lists[1].pcs_p = &pcs[1][0];
+    lists[1].length = 0;
+    current_p = &lists[0];
+    next_p = &lists[1];
+    matched_size = -1;
+
+    memset(&visited[0], 0, sizeof(visited));
+    nfa_add(program_p, current_p, &visited[0], 0);
+
+    for (pos = 0; current_p->length > 0; pos++) {
+        next_p->length = 0;
+        memset(&visited[0], 0, sizeof(visited));
+
+        if (pos < size) {
+            value = (int)buf_p[pos];
+        } else {
+            value = 0;
+        }
+
+        for (i = 0; i < current_p->length; i++) {
+            pc = current_p->pcs_p[i];
+
+            if (program_p[pc] == NFA_OP_CODE_MATCH) {
+                /* Lower priority threads are discarded. */
+                matched_size = pos;
+                break;
+            }
+
+            if (pos == size) {
+                continue;
+            }
+
+            switch (program_p[pc]) {
+
+            case NFA_OP_CODE_CHAR:
+                if (flags & RE_IGNORECASE) {
+                    res = (tolower(value) == (int)(char)program_p[pc + 1]);
+                } else {
+                    res = (value == (int)(char)program_p[pc + 1]);
+                }
+
+                pc += 2;
+                break;
+
+            case NFA_OP_CODE_ANY:
+                res = ((flags & RE_DOTALL) || (value != '\n'));
+                pc++;
+                break;
+
+            case NFA_OP_CODE_WHITESPACE:
+                res = isspace(value);
+                pc++;
+                break;
+
+            case NFA_OP_CODE_DECIMAL_DIGIT:
+                res = isdigit(value);
+                pc++;
+                break;
+
+            case NFA_OP_CODE_ALPHANUMERIC:
+                res = (isalnum(value) || (value == '_'));
+                pc++;
+                break;
+
+            case NFA_OP_CODE_SET:
+                res = (program_p[pc + 1 + (uint8_t)value / 8]
+                       & (1 << ((uint8_t)value % 8)));
+                pc += (1 + NFA_SET_SIZE);
+                break;
+
+            default:
+                return (-1);
+            }
+
+            if (res) {
+                nfa_add(program_p, next_p, &visited[0], pc);
+            }
+        }
+
+        if (pos == size) {
+            break;
+        }
+
+        tmp_p = current_p;
+        current_p = next_p;
+        next_p = tmp_p;
+    }
+
+    return (matched_size);
+}
+
+#endif
+
 int re_module_init()
 {
     if (module.initialized == 1) {
@@ -1076,6 +1570,34 @@ int re_module_init()
     return (0);
 }
 
+#if CONFIG_RE_AUTOMATON == 1
+
+/**
+ * Replace the compiled pattern with an automaton program if possible.
+ */
+static void compile_automaton(struct compile_t *self_p, size_t size)
+{
+    uint8_t program[CONFIG_RE_AUTOMATON_SIZE_MAX];
+    struct lower_t state;
+    int res;
+
+    state.flags = self_p->compiled_begin_p[0];
+    state.program_p = &program[0];
+    state.pos = 0;
+
+    res = lower(&state, &self_p->compiled_begin_p[1]);
+
+    if ((res < 0) || ((size_t)res > size - 1)) {
+        DLOG(DEBUG, "Using the backtracker.\r\n", 0);
+        return;
+    }
+
+    self_p->compiled_begin_p[0] |= FLAG_AUTOMATON;
+    memcpy(&self_p->compiled_begin_p[1], &program[0], res);
+}
+
+#endif
+
 char *re_compile(char *compiled_p,
                  const char *pattern_p,
                  char flags,
@@ -1157,6 +1679,9 @@ char *re_compile(char *compiled_p,
 
         case '\0':
             compile_return(&state);
+#if CONFIG_RE_AUTOMATON == 1
+            compile_automaton(&state, size);
+#endif
             return (state.compiled_begin_p);
 
         default:
@@ -1178,6 +1703,15 @@ ssize_t re_match(const char *compiled_p,
 {
     struct match_t state;
 
+#if CONFIG_RE_AUTOMATON == 1
+    if (compiled_p[0] & FLAG_AUTOMATON) {
+        return (nfa_match((const uint8_t *)&compiled_p[1],
+                          compiled_p[0],
+                          buf_p,
+                          size));
+    }
+#endif
+
     /* Initialize the match state. */
     state.compiled_p = &compiled_p[1];
     state.flags = compiled_p[0];
@@ -95,6 +95,11 @@ int re_module_init(void);
  * - ``\\w``   - Alphanumerical characters ``[a-ZA-Z0-9_]``.
  * - ``\\s``   - Whitespace characters ``[ \t\r\n\f\v]``.
  *
+ * Patterns without anchors are lowered to an automaton that is
+ * matched in linear time if it fits in the compiled buffer, see
+ * ``CONFIG_RE_AUTOMATON``. Other patterns are matched by a
+ * backtracker.
+ *
  * @param[out] compiled_p Compiled regular expression pattern.
  * @param[in] pattern_p Regular expression pattern.
  * @param[in] flags A combination of the flags ``RE_IGNORECASE``,
@@ -34,8 +34,12 @@
 /* +7 for floating point decimal point and fraction. */
 #define VALUE_BUF_MAX (3 * sizeof(long) + 7)
 
+/* Format string item specifier of literal text. */
+#define SPECIFIER_LITERAL '\0'
+
 struct buffered_output_t {
     void *chan_p;
+    ssize_t (*write)(void *chan_p, const void *buf_p, size_t size);
     int pos;
     char buffer[CONFIG_STD_OUTPUT_BUFFER_MAX];
     size_t size;
@@ -47,6 +51,27 @@ struct snprintf_output_t {
     size_t size_max;
 };
 
+typedef void (*std_write_t)(const char *buf_p, size_t size, void *arg_p);
+
+/* Two decimal digits per entry. */
+static const char decimal_digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const char hexadecimal_digits[] = "0123456789abcdef";
+
+/* Source of padding characters. */
+static const char spaces[] = "                ";
+static const char zeros[] = "0000000000000000";
+
 /**
  * @return true(1) if the character is part of the string, otherwise
  *         false(0).
@@ -65,121 +90,172 @@ static int char_in_string(char c, const char *str_p)
 }
 
 /**
- * Put characters to buffer.
+ * Write characters to buffer.
  */
-static void sprintf_putc(char c, void *arg_p)
+static void sprintf_write(const char *buf_p, size_t size, void *arg_p)
 {
     char **dst_pp = arg_p;
 
-    *(*dst_pp)++ = c;
+    memcpy(*dst_pp, buf_p, size);
+    *dst_pp += size;
 }
 
 /**
- * Put characters to buffer.
+ * Write characters to buffer, but not beyond its end.
  */
-static void snprintf_putc(char c, void *arg_p)
+static void snprintf_write(const char *buf_p, size_t size, void *arg_p)
 {
     struct snprintf_output_t *output_p;
+    size_t left;
 
     output_p = arg_p;
 
     if (output_p->size < output_p->size_max) {
-        output_p->dst_p[output_p->size] = c;
+        left = (output_p->size_max - output_p->size);
+        memcpy(&output_p->dst_p[output_p->size], buf_p, MIN(size, left));
     }
 
-    output_p->size++;
+    output_p->size += size;
 }
 
 /**
- * Put characters to standard output.
+ * Write characters to the output channel via the output buffer. Spans
+ * bigger than the buffer are written directly to the channel.
  */
-static void fprintf_putc(char c, void *arg_p)
+static void fprintf_write(const char *buf_p, size_t size, void *arg_p)
 {
-    struct buffered_output_t *output_p = arg_p;
+    struct buffered_output_t *output_p;
+    size_t n;
 
-    output_p->buffer[output_p->pos++] = c;
-    output_p->size++;
+    output_p = arg_p;
+    output_p->size += size;
 
-    if (output_p->pos == membersof(output_p->buffer)) {
-        chan_write(output_p->chan_p, output_p->buffer, output_p->pos);
-        output_p->pos = 0;
+    while (size > 0) {
+        if ((output_p->pos == 0) && (size >= sizeof(output_p->buffer))) {
+            output_p->write(output_p->chan_p, buf_p, size);
+            break;
+        }
+
+        n = MIN(size, sizeof(output_p->buffer) - output_p->pos);
+        memcpy(&output_p->buffer[output_p->pos], buf_p, n);
+        output_p->pos += n;
+        buf_p += n;
+        size -= n;
+
+        if (output_p->pos == sizeof(output_p->buffer)) {
+            output_p->write(output_p->chan_p,
+                            output_p->buffer,
+                            output_p->pos);
+            output_p->pos = 0;
+        }
     }
 }
 
+/**
+ * Initialize given buffered output. Use chan_write_isr() from
+ * interrupt context or with the system lock taken.
+ */
+static void output_init(struct buffered_output_t *output_p,
+                        void *chan_p,
+                        ssize_t (*write)(void *chan_p,
+                                         const void *buf_p,
+                                         size_t size))
+{
+    output_p->chan_p = chan_p;
+    output_p->write = write;
+    output_p->pos = 0;
+    output_p->size = 0;
+}
+
 /**
  * Flush output buffer to channel.
  */
 static void output_flush(struct buffered_output_t *output_p)
 {
     if (output_p->pos > 0) {
-        chan_write(output_p->chan_p, output_p->buffer, output_p->pos);
+        output_p->write(output_p->chan_p, output_p->buffer, output_p->pos);
         output_p->pos = 0;
     }
 }
 
 /**
- * Put characters to standard output from interrupt context or with
- * the system lock taken.
+ * Write given far string span.
  */
-static void fprintf_putc_isr(char c, void *arg_p)
+static void write_far(std_write_t std_write,
+                      void *arg_p,
+                      far_string_t str_p,
+                      size_t size)
 {
-    struct buffered_output_t *output_p = arg_p;
+#if defined(FAR_SPECIAL_ADDRESS)
+    char buf[16];
+    size_t i;
+    size_t n;
 
-    output_p->buffer[output_p->pos++] = c;
-    output_p->size++;
+    while (size > 0) {
+        n = MIN(size, sizeof(buf));
 
-    if (output_p->pos == membersof(output_p->buffer)) {
-        chan_write_isr(output_p->chan_p, output_p->buffer, output_p->pos);
-        output_p->pos = 0;
+        for (i = 0; i < n; i++) {
+            buf[i] = *str_p++;
+        }
+
+        std_write(&buf[0], n, arg_p);
+        size -= n;
     }
+#else
+    std_write(str_p, size, arg_p);
+#endif
 }
 
 /**
- * Flush output buffer to channel.
+ * Write given number of padding characters.
  */
-static void output_flush_isr(struct buffered_output_t *output_p)
+static void write_fill(std_write_t std_write,
+                       void *arg_p,
+                       char fill,
+                       int width)
 {
-    if (output_p->pos > 0) {
-        chan_write_isr(output_p->chan_p, output_p->buffer, output_p->pos);
-        output_p->pos = 0;
+    const char *fill_p;
+    int n;
+
+    fill_p = ((fill == '0') ? &zeros[0] : &spaces[0]);
+
+    while (width > 0) {
+        n = MIN(width, (int)(sizeof(spaces) - 1));
+        std_write(fill_p, n, arg_p);
+        width -= n;
     }
 }
 
-static void formats(void (*std_putc)(char c, void *arg_p),
+static void formats(std_write_t std_write,
                     void *arg_p,
                     char *str_p,
                     char flags,
                     int width,
                     char negative_sign)
 {
-    char *s_p = str_p;
+    size_t size;
 
-    while (*s_p++ != '\0') {
-        width--;
-    }
+    size = strlen(str_p);
+    width -= size;
 
     /* Right justification. */
     if (flags != '-') {
         if ((negative_sign == 1) && (flags == '0')) {
-            std_putc(*str_p++, arg_p);
+            std_write(str_p++, 1, arg_p);
+            size--;
         }
 
-        while (width > 0) {
-            std_putc(flags, arg_p);
-            width--;
-        }
+        write_fill(std_write, arg_p, flags, width);
+        width = 0;
     }
 
     /* Number */
-    while (*str_p != '\0') {
-        std_putc(*str_p++, arg_p);
+    if (size > 0) {
+        std_write(str_p, size, arg_p);
     }
 
     /* Left justification. */
-    while (width > 0) {
-        std_putc(' ', arg_p);
-        width--;
-    }
+    write_fill(std_write, arg_p, ' ', width);
 }
 
 static char *formati(char c,
@@ -190,7 +266,6 @@ static char *formati(char c,
                      char *negative_sign_p)
 {
     unsigned long value;
-    char digit;
 
     /* Get argument. */
     if (length == 0) {
@@ -210,15 +285,27 @@ static char *formati(char c,
         value &= UINT_MAX;
     }
 
-    /* Format number into buffer. */
-    do {
-        digit = (char)(value % radix);
-        value /= radix;
-        if (digit > 9) {
-            digit += 39;
+    /* Format number into buffer, two decimal digits or one
+       hexadecimal digit at a time. */
+    if (radix == 10) {
+        while (value >= 100) {
+            str_p -= 2;
+            memcpy(str_p, &decimal_digit_pairs[2 * (value % 100)], 2);
+            value /= 100;
         }
-        *--str_p = ('0' + digit);
-    } while (value > 0);
+
+        if (value >= 10) {
+            str_p -= 2;
+            memcpy(str_p, &decimal_digit_pairs[2 * value], 2);
+        } else {
+            *--str_p = ('0' + value);
+        }
+    } else {
+        do {
+            *--str_p = hexadecimal_digits[value & 0xf];
+            value >>= 4;
+        } while (value > 0);
+    }
 
     if (*negative_sign_p == 1) {
         *--str_p = '-';
@@ -264,9 +351,10 @@ static char *formatf(char c,
     fraction_number = (unsigned long)((value - whole_number) * 1000000.0);
 
     /* Write fraction number to output buffer. */
-    for (i = 0; i < 6; i++) {
-        *--str_p = '0' + (fraction_number % 10);
-        fraction_number /= 10;
+    for (i = 0; i < 3; i++) {
+        str_p -= 2;
+        memcpy(str_p, &decimal_digit_pairs[2 * (fraction_number % 100)], 2);
+        fraction_number /= 100;
     }
 
     /* Write the decimal dot. */
@@ -288,136 +376,374 @@ static char *formatf(char c,
 
 #endif
 
-static void vcprintf(void (*std_putc)(char c, void *arg_p),
-                     void *arg_p,
-                     far_string_t fmt_p,
-                     va_list *ap_p)
+/**
+ * Format one conversion specification.
+ */
+static void format(std_write_t std_write,
+                   void *arg_p,
+                   char c,
+                   char flags,
+                   int width,
+                   char length,
+                   va_list *ap_p)
 {
-    char c, flags, length, negative_sign, buf[VALUE_BUF_MAX], *s_p;
-    int width;
+    char negative_sign, buf[VALUE_BUF_MAX], *s_p;
 
     buf[sizeof(buf) - 1] = '\0';
+    negative_sign = 0;
 
-    while ((c = *fmt_p++) != '\0') {
-        if (c != '%') {
-            std_putc(c, arg_p);
-            continue;
-        }
+    switch (c) {
 
-        /* Prototype: %[flags][width][length]specifier  */
+    case 'S':
+#if defined(FAR_SPECIAL_ADDRESS)
+        {
+            FAR const char *far_string_p;
+            size_t size;
 
-        /* Parse the flags. */
-        flags = ' ';
-        c = *fmt_p++;
+            far_string_p = va_arg(*ap_p, FAR const char*);
 
-        if ((c == '0') || (c == '-')) {
-            flags = c;
-            c = *fmt_p++;
+            if (far_string_p == NULL) {
+                far_string_p = FSTR("(null)");
+            }
+
+            s_p = &buf[sizeof(buf) - 1];
+            size = std_strlen(far_string_p);
+            width -= size;
+
+            /* Right justification. */
+            if (flags != '-') {
+                formats(std_write, arg_p, s_p, flags, width, negative_sign);
+            }
+
+            write_far(std_write, arg_p, far_string_p, size);
+
+            /* Left justification. */
+            if (flags == '-') {
+                formats(std_write, arg_p, s_p, flags, width, negative_sign);
+            }
         }
 
-        /* Parse the width. */
-        width = 0;
+        return;
+#endif
+
+    case 's':
+        s_p = va_arg(*ap_p, char*);
 
-        while ((c >= '0') && (c <= '9')) {
-            width *= 10;
-            width += (c - '0');
-            c = *fmt_p++;
+        if (s_p == NULL) {
+            s_p = "(null)";
         }
 
-        /* Parse the length. */
-        length = 0;
+        break;
+
+    case 'c':
+        buf[sizeof(buf) - 2] = (char)va_arg(*ap_p, int);
+        s_p = &buf[sizeof(buf) - 2];
+        break;
+
+    case 'i':
+    case 'd':
+    case 'u':
+        s_p = formati(c, &buf[sizeof(buf) - 1], 10, ap_p, length, &negative_sign);
+        break;
+
+    case 'x':
+        s_p = formati(c, &buf[sizeof(buf) - 1], 16, ap_p, length, &negative_sign);
+        break;
+
+#if CONFIG_FLOAT == 1
+    case 'f':
+        s_p = formatf(c, &buf[sizeof(buf) - 1], ap_p, length, &negative_sign);
+        break;
+#endif
+
+    default:
+        std_write(&c, 1, arg_p);
+        return;
+    }
+
+    formats(std_write, arg_p, s_p, flags, width, negative_sign);
+}
+
+/**
+ * Parse the conversion specification after a ``%``.
+ *
+ * @return Pointer after the specifier.
+ */
+static far_string_t parse_specification(far_string_t fmt_p,
+                                        char *c_p,
+                                        char *flags_p,
+                                        int *width_p,
+                                        char *length_p)
+{
+    char c;
+
+    /* Prototype: %[flags][width][length]specifier  */
+
+    /* Parse the flags. */
+    *flags_p = ' ';
+    c = *fmt_p++;
+
+    if ((c == '0') || (c == '-')) {
+        *flags_p = c;
+        c = *fmt_p++;
+    }
+
+    /* Parse the width. */
+    *width_p = 0;
+
+    while ((c >= '0') && (c <= '9')) {
+        *width_p *= 10;
+        *width_p += (c - '0');
+        c = *fmt_p++;
+    }
+
+    /* Parse the length. */
+    *length_p = 0;
+
+    if (c == 'l') {
+        *length_p = 1;
+        c = *fmt_p++;
+    }
+
+    *c_p = c;
+
+    return (fmt_p);
+}
+
+static void vcprintf(std_write_t std_write,
+                     void *arg_p,
+                     far_string_t fmt_p,
+                     va_list *ap_p)
+{
+    char c, flags, length;
+    far_string_t begin_p;
+    int width;
+
+    while (1) {
+        /* Literal text is written in one go. */
+        begin_p = fmt_p;
+
+        while (((c = *fmt_p) != '\0') && (c != '%')) {
+            fmt_p++;
+        }
 
-        if (c == 'l') {
-            length = 1;
-            c = *fmt_p++;
+        if (fmt_p != begin_p) {
+            write_far(std_write, arg_p, begin_p, fmt_p - begin_p);
         }
 
         if (c == '\0') {
             break;
         }
 
-        /* Parse the specifier. */
-        negative_sign = 0;
+        fmt_p = parse_specification(fmt_p + 1, &c, &flags, &width, &length);
 
-        switch (c) {
+        if (c == '\0') {
+            break;
+        }
 
-        case 'S':
-#if defined(FAR_SPECIAL_ADDRESS)
-            {
-                FAR const char *far_string_p;
+        format(std_write, arg_p, c, flags, width, length, ap_p);
+    }
+}
 
-                far_string_p = va_arg(*ap_p, FAR const char*);
+/**
+ * Same as vcprintf(), but with a precompiled format string.
+ */
+static void vcprintf_format(std_write_t std_write,
+                            void *arg_p,
+                            const struct std_format_t *format_p,
+                            va_list *ap_p)
+{
+    const struct std_format_item_t *item_p;
+    const struct std_format_item_t *end_p;
+
+    item_p = format_p->items_p;
+    end_p = &item_p[format_p->length];
+
+    while (item_p < end_p) {
+        if (item_p->specifier == SPECIFIER_LITERAL) {
+            write_far(std_write,
+                      arg_p,
+                      &format_p->fmt_p[item_p->offset],
+                      item_p->size);
+        } else {
+            format(std_write,
+                   arg_p,
+                   item_p->specifier,
+                   item_p->flags,
+                   item_p->size,
+                   item_p->length,
+                   ap_p);
+        }
 
-                if (far_string_p == NULL) {
-                    far_string_p = FSTR("(null)");
-                }
+        item_p++;
+    }
+}
 
-                s_p = &buf[sizeof(buf) - 1];
-                width -= std_strlen(far_string_p);
+/**
+ * Format a single value. Used to feed saved arguments to format(),
+ * which reads its value from a variable arguments list.
+ */
+static void format_arg(std_write_t std_write,
+                       void *arg_p,
+                       char c,
+                       char flags,
+                       int width,
+                       char length,
+                       ...)
+{
+    va_list ap;
 
-                /* Right justification. */
-                if (flags != '-') {
-                    formats(std_putc, arg_p, s_p, flags, width, negative_sign);
-                }
+    va_start(ap, length);
+    format(std_write, arg_p, c, flags, width, length, &ap);
+    va_end(ap);
+}
 
-                while (*far_string_p != '\0') {
-                    std_putc(*far_string_p++, arg_p);
-                }
+/**
+ * Same as vcprintf(), but with arguments from an array. Each argument
+ * is passed on with the type its conversion specification expects.
+ */
+static void vcprintf_args(std_write_t std_write,
+                          void *arg_p,
+                          far_string_t fmt_p,
+                          const union std_arg_t *args_p,
+                          int length)
+{
+    const union std_arg_t *end_p;
+    char c, flags, length_modifier;
+    far_string_t begin_p;
+    int width;
 
-                /* Left justification. */
-                if (flags == '-') {
-                    formats(std_putc, arg_p, s_p, flags, width, negative_sign);
-                }
-            }
+    end_p = &args_p[length];
 
-            continue;
-#endif
+    while (1) {
+        begin_p = fmt_p;
 
-        case 's':
-            s_p = va_arg(*ap_p, char*);
+        while (((c = *fmt_p) != '\0') && (c != '%')) {
+            fmt_p++;
+        }
 
-            if (s_p == NULL) {
-                s_p = "(null)";
-            }
+        if (fmt_p != begin_p) {
+            write_far(std_write, arg_p, begin_p, fmt_p - begin_p);
+        }
 
+        if (c == '\0') {
             break;
+        }
 
-        case 'c':
-            buf[sizeof(buf) - 2] = (char)va_arg(*ap_p, int);
-            s_p = &buf[sizeof(buf) - 2];
+        fmt_p = parse_specification(fmt_p + 1,
+                                    &c,
+                                    &flags,
+                                    &width,
+                                    &length_modifier);
+
+        if (c == '\0') {
             break;
+        }
 
+        switch (c) {
+
+        case 'c':
         case 'i':
         case 'd':
         case 'u':
-            s_p = formati(c, &buf[sizeof(buf) - 1], 10, ap_p, length, &negative_sign);
-            break;
-
         case 'x':
-            s_p = formati(c, &buf[sizeof(buf) - 1], 16, ap_p, length, &negative_sign);
+            if (args_p == end_p) {
+                return;
+            }
+
+            if (length_modifier == 1) {
+                format_arg(std_write,
+                           arg_p,
+                           c,
+                           flags,
+                           width,
+                           length_modifier,
+                           args_p->integer);
+            } else {
+                format_arg(std_write,
+                           arg_p,
+                           c,
+                           flags,
+                           width,
+                           length_modifier,
+                           (int)args_p->integer);
+            }
+
+            args_p++;
             break;
 
 #if CONFIG_FLOAT == 1
         case 'f':
-            s_p = formatf(c, &buf[sizeof(buf) - 1], ap_p, length, &negative_sign);
+            if (args_p == end_p) {
+                return;
+            }
+
+            format_arg(std_write,
+                       arg_p,
+                       c,
+                       flags,
+                       width,
+                       length_modifier,
+                       args_p->floating);
+            args_p++;
             break;
 #endif
 
+        case 's':
+            if (args_p == end_p) {
+                return;
+            }
+
+            format_arg(std_write,
+                       arg_p,
+                       c,
+                       flags,
+                       width,
+                       length_modifier,
+                       args_p->string_p);
+            args_p++;
+            break;
+
+        case 'S':
+            if (args_p == end_p) {
+                return;
+            }
+
+            format_arg(std_write,
+                       arg_p,
+                       c,
+                       flags,
+                       width,
+                       length_modifier,
+                       args_p->far_string_p);
+            args_p++;
+            break;
+
         default:
-            std_putc(c, arg_p);
-            continue;
+            format_arg(std_write,
+                       arg_p,
+                       c,
+                       flags,
+                       width,
+                       length_modifier);
+            break;
         }
-
-        formats(std_putc, arg_p, s_p, flags, width, negative_sign);
     }
 }
 
 static void cvcprintf(struct buffered_output_t *output_p,
                       far_string_t fmt_p,
+                      const struct std_format_t *format_p,
                       va_list *ap_p)
 {
     chan_control(output_p->chan_p, CHAN_CONTROL_PRINTF_BEGIN);
-    vcprintf(fprintf_putc, output_p, fmt_p, ap_p);
+
+    if (format_p != NULL) {
+        vcprintf_format(fprintf_write, output_p, format_p, ap_p);
+    } else {
+        vcprintf(fprintf_write, output_p, fmt_p, ap_p);
+    }
+
     output_flush(output_p);
     chan_control(output_p->chan_p, CHAN_CONTROL_PRINTF_END);
 }
@@ -480,8 +806,8 @@ ssize_t std_vsprintf(char *dst_p, far_string_t fmt_p, va_list *ap_p)
 
     char *d_p = dst_p;
 
-    vcprintf(sprintf_putc, &d_p, fmt_p, ap_p);
-    sprintf_putc('\0', &d_p);
+    vcprintf(sprintf_write, &d_p, fmt_p, ap_p);
+    sprintf_write("", 1, &d_p);
 
     return (d_p - dst_p - 1);
 }
@@ -504,8 +830,8 @@ ssize_t std_vsnprintf(char *dst_p,
     output.size = 0;
     output.size_max = size;
 
-    vcprintf(snprintf_putc, &output, fmt_p, ap_p);
-    snprintf_putc('\0', &output);
+    vcprintf(snprintf_write, &output, fmt_p, ap_p);
+    snprintf_write("", 1, &output);
 
     /* Force the string to be NULL terminated. */
     dst_p[size - 1] = '\0';
@@ -524,12 +850,10 @@ ssize_t std_printf(far_string_t fmt_p, ...)
     va_list ap;
     struct buffered_output_t output;
 
-    output.pos = 0;
-    output.size = 0;
-    output.chan_p = sys_get_stdout();
+    output_init(&output, sys_get_stdout(), chan_write);
 
     va_start(ap, fmt_p);
-    cvcprintf(&output, fmt_p, &ap);
+    cvcprintf(&output, fmt_p, NULL, &ap);
     va_end(ap);
 
     return (output.size);
@@ -542,11 +866,9 @@ ssize_t std_vprintf(far_string_t fmt_p, va_list *ap_p)
 
     struct buffered_output_t output;
 
-    output.pos = 0;
-    output.size = 0;
-    output.chan_p = sys_get_stdout();
+    output_init(&output, sys_get_stdout(), chan_write);
 
-    cvcprintf(&output, fmt_p, ap_p);
+    cvcprintf(&output, fmt_p, NULL, ap_p);
 
     return (output.size);
 }
@@ -559,12 +881,10 @@ ssize_t std_fprintf(void *chan_p, far_string_t fmt_p, ...)
     va_list ap;
     struct buffered_output_t output;
 
-    output.pos = 0;
-    output.size = 0;
-    output.chan_p = chan_p;
+    output_init(&output, chan_p, chan_write);
 
     va_start(ap, fmt_p);
-    cvcprintf(&output, fmt_p, &ap);
+    cvcprintf(&output, fmt_p, NULL, &ap);
     va_end(ap);
 
     return (output.size);
@@ -578,11 +898,185 @@ ssize_t std_vfprintf(void *chan_p, far_string_t fmt_p, va_list *ap_p)
 
     struct buffered_output_t output;
 
-    output.pos = 0;
+    output_init(&output, chan_p, chan_write);
+
+    cvcprintf(&output, fmt_p, NULL, ap_p);
+
+    return (output.size);
+}
+
+int std_format_init(struct std_format_t *self_p,
+                    far_string_t fmt_p,
+                    struct std_format_item_t *items_p,
+                    int length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(fmt_p != NULL, EINVAL);
+    ASSERTN((items_p != NULL) || (length == 0), EINVAL);
+
+    struct std_format_item_t *item_p;
+    far_string_t pos_p;
+    far_string_t begin_p;
+    size_t size;
+    char c;
+    char flags;
+    char length_modifier;
+    int width;
+    int i;
+
+    self_p->fmt_p = fmt_p;
+    self_p->items_p = items_p;
+    i = 0;
+    pos_p = fmt_p;
+
+    while (1) {
+        begin_p = pos_p;
+
+        while (((c = *pos_p) != '\0') && (c != '%')) {
+            pos_p++;
+        }
+
+        /* Literal text, split into items of at most 255 characters. */
+        while (begin_p != pos_p) {
+            if (i == length) {
+                return (-ENOMEM);
+            }
+
+            if (begin_p - fmt_p > 0xffff) {
+                return (-EINVAL);
+            }
+
+            size = MIN(pos_p - begin_p, 255);
+            item_p = &items_p[i++];
+            item_p->offset = (begin_p - fmt_p);
+            item_p->size = size;
+            item_p->specifier = SPECIFIER_LITERAL;
+            item_p->flags = 0;
+            item_p->length = 0;
+            begin_p += size;
+        }
+
+        if (c == '\0') {
+            break;
+        }
+
+        pos_p = parse_specification(pos_p + 1,
+                                    &c,
+                                    &flags,
+                                    &width,
+                                    &length_modifier);
+
+        if (c == '\0') {
+            break;
+        }
+
+        if (width > 255) {
+            return (-EINVAL);
+        }
+
+        if (i == length) {
+            return (-ENOMEM);
+        }
+
+        item_p = &items_p[i++];
+        item_p->offset = 0;
+        item_p->size = width;
+        item_p->specifier = c;
+        item_p->flags = flags;
+        item_p->length = length_modifier;
+    }
+
+    self_p->length = i;
+
+    return (0);
+}
+
+ssize_t std_snprintf_format(char *dst_p,
+                            size_t size,
+                            const struct std_format_t *format_p,
+                            ...)
+{
+    ASSERTN(dst_p != NULL, EINVAL);
+    ASSERTN(format_p != NULL, EINVAL);
+
+    va_list ap;
+    struct snprintf_output_t output;
+
+    if (size == 0) {
+        return (-ENOMEM);
+    }
+
+    output.dst_p = dst_p;
     output.size = 0;
-    output.chan_p = chan_p;
+    output.size_max = size;
+
+    va_start(ap, format_p);
+    vcprintf_format(snprintf_write, &output, format_p, &ap);
+    va_end(ap);
+    snprintf_write("", 1, &output);
+
+    /* Force the string to be NULL terminated. */
+    dst_p[size - 1] = '\0';
+
+    if (output.size > size) {
+        return (-ENOMEM);
+    }
 
-    cvcprintf(&output, fmt_p, ap_p);
+    return (output.size - 1);
+}
+
+ssize_t std_fprintf_format(void *chan_p,
+                           const struct std_format_t *format_p,
+                           ...)
+{
+    ASSERTN(chan_p != NULL, EINVAL);
+    ASSERTN(format_p != NULL, EINVAL);
+
+    va_list ap;
+    struct buffered_output_t output;
+
+    output_init(&output, chan_p, chan_write);
+
+    va_start(ap, format_p);
+    cvcprintf(&output, NULL, format_p, &ap);
+    va_end(ap);
+
+    return (output.size);
+}
+
+ssize_t std_vfprintf_format(void *chan_p,
+                            const struct std_format_t *format_p,
+                            va_list *ap_p)
+{
+    ASSERTN(chan_p != NULL, EINVAL);
+    ASSERTN(format_p != NULL, EINVAL);
+    ASSERTN(ap_p != NULL, EINVAL);
+
+    struct buffered_output_t output;
+
+    output_init(&output, chan_p, chan_write);
+    cvcprintf(&output, NULL, format_p, ap_p);
+
+    return (output.size);
+}
+
+ssize_t std_fprintf_args(void *chan_p,
+                         far_string_t fmt_p,
+                         const union std_arg_t *args_p,
+                         int length)
+{
+    ASSERTN(chan_p != NULL, EINVAL);
+    ASSERTN(fmt_p != NULL, EINVAL);
+    ASSERTN((args_p != NULL) || (length == 0), EINVAL);
+
+    struct buffered_output_t output;
+
+    output_init(&output, chan_p, chan_write);
+
+    chan_control(chan_p, CHAN_CONTROL_PRINTF_BEGIN);
+    vcprintf_args(fprintf_write, &output, fmt_p, args_p, length);
+    output_flush(&output);
+    chan_control(chan_p, CHAN_CONTROL_PRINTF_END);
 
     return (output.size);
 }
@@ -592,13 +1086,11 @@ ssize_t std_printf_isr(far_string_t fmt_p, ...)
     va_list ap;
     struct buffered_output_t output;
 
-    output.pos = 0;
-    output.size = 0;
-    output.chan_p = sys_get_stdout();
+    output_init(&output, sys_get_stdout(), chan_write_isr);
 
     va_start(ap, fmt_p);
-    vcprintf(fprintf_putc_isr, &output, fmt_p, &ap);
-    output_flush_isr(&output);
+    vcprintf(fprintf_write, &output, fmt_p, &ap);
+    output_flush(&output);
     va_end(ap);
 
     return (output.size);
@@ -609,13 +1101,11 @@ ssize_t std_fprintf_isr(void *chan_p, far_string_t fmt_p, ...)
     va_list ap;
     struct buffered_output_t output;
 
-    output.pos = 0;
-    output.size = 0;
-    output.chan_p = chan_p;
+    output_init(&output, chan_p, chan_write_isr);
 
     va_start(ap, fmt_p);
-    vcprintf(fprintf_putc_isr, &output, fmt_p, &ap);
-    output_flush_isr(&output);
+    vcprintf(fprintf_write, &output, fmt_p, &ap);
+    output_flush(&output);
     va_end(ap);
 
     return (output.size);
@@ -32,6 +32,41 @@
 #include "simba.h"
 #include <stdarg.h>
 
+/**
+ * A literal text span or a conversion specification in a precompiled
+ * format string.
+ */
+struct std_format_item_t {
+    uint16_t offset;
+    uint8_t size;
+    char specifier;
+    char flags;
+    char length;
+};
+
+/**
+ * A precompiled format string. Initialize with `std_format_init()`.
+ */
+struct std_format_t {
+    far_string_t fmt_p;
+    struct std_format_item_t *items_p;
+    int length;
+};
+
+/**
+ * A saved printf argument. Integer conversions use ``integer``,
+ * ``%f`` uses ``floating`` and ``%s`` and ``%S`` use ``string_p`` and
+ * ``far_string_p`` respectively.
+ */
+union std_arg_t {
+    long integer;
+#if CONFIG_FLOAT == 1
+    double floating;
+#endif
+    const char *string_p;
+    far_string_t far_string_p;
+};
+
 /**
  * Initialize the std module. This function must be called before
  * calling any other function in this module.
@@ -180,6 +215,91 @@ ssize_t std_fprintf(void *chan_p, far_string_t fmt_p, ...);
  */
 ssize_t std_vfprintf(void *chan_p, far_string_t fmt_p, va_list *ap_p);
 
+/**
+ * Precompile given format string for the ``*_format()`` printf
+ * functions. Hot call sites precompile their format strings once to
+ * avoid parsing them on every call. One item is used per literal text
+ * span and per conversion specification.
+ *
+ * See `std_sprintf()` for the the format string specification.
+ *
+ * @param[out] self_p Format to initialize.
+ * @param[in] fmt_p Format string. Must be valid as long as the format
+ *                  is used.
+ * @param[in] items_p Items array.
+ * @param[in] length Length of the items array.
+ *
+ * @return zero(0) or negative error code. -ENOMEM if the items array
+ *         is too short.
+ */
+int std_format_init(struct std_format_t *self_p,
+                    far_string_t fmt_p,
+                    struct std_format_item_t *items_p,
+                    int length);
+
+/**
+ * Same as `std_snprintf()`, but with a precompiled format string.
+ *
+ * @param[out] dst_p Destination buffer.
+ * @param[in] size Size of the destination buffer.
+ * @param[in] format_p Precompiled format string.
+ * @param[in] ... Variable arguments list.
+ *
+ * @return Length of the string written to the destination buffer, not
+ *         including the null termination, or negative error code.
+ */
+ssize_t std_snprintf_format(char *dst_p,
+                            size_t size,
+                            const struct std_format_t *format_p,
+                            ...);
+
+/**
+ * Same as `std_fprintf()`, but with a precompiled format string.
+ *
+ * @param[in] chan_p Output channel.
+ * @param[in] format_p Precompiled format string.
+ * @param[in] ... Variable arguments list.
+ *
+ * @return Number of characters written to given channel, or negative
+ *         error code.
+ */
+ssize_t std_fprintf_format(void *chan_p,
+                           const struct std_format_t *format_p,
+                           ...);
+
+/**
+ * Same as `std_vfprintf()`, but with a precompiled format string.
+ *
+ * @param[in] chan_p Output channel.
+ * @param[in] format_p Precompiled format string.
+ * @param[in] ap_p Variable arguments list.
+ *
+ * @return Number of characters written to given channel, or negative
+ *         error code.
+ */
+ssize_t std_vfprintf_format(void *chan_p,
+                            const struct std_format_t *format_p,
+                            va_list *ap_p);
+
+/**
+ * Same as `std_fprintf()`, but with the arguments read from given
+ * array instead of a variable arguments list. Each conversion
+ * specification, except ``%%``, consumes one element. Formatting
+ * stops when the array is exhausted.
+ *
+ * @param[in] chan_p Output channel.
+ * @param[in] fmt_p Format string.
+ * @param[in] args_p Arguments array.
+ * @param[in] length Number of elements in the arguments array.
+ *
+ * @return Number of characters written to given channel, or negative
+ *         error code.
+ */
+ssize_t std_fprintf_args(void *chan_p,
+                         far_string_t fmt_p,
+                         const union std_arg_t *args_p,
+                         int length);
+
 /**
  * Format and print data to standard output from interrupt context or
  * with the system lock taken. The output is not null terminated.
@@ -27,6 +27,10 @@
  */
 
 #include "simba.h"
+#include <link.h>
+
+/* ELF header of the executable, provided by the linker. */
+extern const ElfW(Ehdr) __ehdr_start;
 
 struct command_t {
     char *command_p;
@@ -227,6 +231,172 @@ int test_fs(void)
     return (0);
 }
 
+int test_binary(void)
+{
+    struct log_object_t foo;
+    struct queue_t queue;
+    char buf[256];
+    char name[8];
+    ssize_t size;
+    uint32_t dropped;
+    int i;
+
+    BTASSERT(log_object_init(&foo, "foo", LOG_UPTO(INFO)) == 0);
+    BTASSERT(queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(log_set_default_handler_output_channel(&queue) == 0);
+    BTASSERT(log_binary_enable(1) == 0);
+
+    /* The string argument is copied when the entry is saved. */
+    strcpy(name, "bar");
+    BTASSERT(log_object_print(&foo,
+                              LOG_INFO,
+                              FSTR("%s %d%% %lu 0x%02x\r\n"),
+                              name,
+                              -5,
+                              123456ul,
+                              10) == 1);
+    strcpy(name, "fie");
+
+    /* Filtered out by the log mask. */
+    BTASSERT(log_object_print(&foo, LOG_DEBUG, FSTR("debug\r\n")) == 0);
+
+    /* Nothing is written until the entries are processed. */
+    BTASSERTI(queue_size(&queue), ==, 0);
+    BTASSERTI(log_binary_process(), ==, 1);
+    BTASSERTI(log_binary_process(), ==, 0);
+
+    size = queue_size(&queue);
+    BTASSERT(size > 0);
+    BTASSERTI(queue_read(&queue, &buf[0], size), ==, size);
+    buf[size] = '\0';
+    std_printf(FSTR("%s"), &buf[0]);
+    BTASSERT(strstr(&buf[0], ":info:main:foo: bar -5% 123456 0x0a\r\n")
+             != NULL);
+
+    /* Entries are dropped when the ring is full. */
+    dropped = log_binary_get_dropped();
+
+    for (i = 0; i < CONFIG_LOG_BINARY_RECORDS_MAX + 2; i++) {
+        BTASSERTI(log_object_print(&foo, LOG_INFO, FSTR("%d"), i),
+                  ==,
+                  (i < CONFIG_LOG_BINARY_RECORDS_MAX));
+    }
+
+    BTASSERTI(log_binary_get_dropped(), ==, dropped + 2);
+    BTASSERT(log_set_default_handler_output_channel(chan_null()) == 0);
+    BTASSERTI(log_binary_process(), ==, CONFIG_LOG_BINARY_RECORDS_MAX);
+
+    BTASSERT(log_set_default_handler_output_channel(sys_get_stdout()) == 0);
+    BTASSERT(log_binary_enable(0) == 0);
+
+    return (0);
+}
+
+int test_binary_dump(void)
+{
+    struct log_object_t foo;
+    struct queue_t queue;
+    uint8_t buf[64];
+    const char *fmt_p;
+    uint64_t address;
+
+    BTASSERT(log_object_init(&foo, "foo", LOG_UPTO(INFO)) == 0);
+    BTASSERT(queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(log_binary_enable(1) == 0);
+
+    fmt_p = FSTR("%s=%d %lx\r\n");
+    BTASSERT(log_object_print(&foo,
+                              LOG_WARNING,
+                              fmt_p,
+                              "x",
+                              258,
+                              0x0102030405060708ul) == 1);
+    BTASSERTI(log_binary_dump(&queue), ==, 41);
+    BTASSERTI(log_binary_dump(&queue), ==, 0);
+    BTASSERTI(queue_read(&queue, &buf[0], 41), ==, 41);
+
+    /* Level and number of arguments. */
+    BTASSERTI(buf[0], ==, LOG_WARNING);
+    BTASSERTI(buf[1], ==, 3);
+
+    /* The format string is identified by its address in the
+       application image. */
+    address = (uintptr_t)fmt_p;
+
+    if (__ehdr_start.e_type == ET_DYN) {
+        address -= (uintptr_t)&__ehdr_start;
+    }
+
+    BTASSERTM(&buf[10], &address, 8);
+
+    /* Thread name, log object name and arguments, with the long
+       argument written at full width. */
+    BTASSERTM(&buf[18],
+              "main\0foo\0x\0\x02\x01\x00\x00"
+              "\x08\x07\x06\x05\x04\x03\x02\x01",
+              23);
+
+    BTASSERT(log_binary_enable(0) == 0);
+
+    return (0);
+}
+
+int test_benchmark(void)
+{
+    struct log_object_t foo;
+    struct time_t start;
+    struct time_t stop;
+    struct time_t elapsed;
+    int binary;
+    int rounds;
+    int i;
+
+    BTASSERT(log_object_init(&foo, "foo", LOG_UPTO(INFO)) == 0);
+    BTASSERT(log_set_default_handler_output_channel(chan_null()) == 0);
+
+    for (binary = 0; binary < 2; binary++) {
+        BTASSERT(log_binary_enable(binary) == 0);
+        rounds = 0;
+        elapsed.seconds = 0;
+        elapsed.nanoseconds = 0;
+
+        while ((elapsed.seconds == 0)
+               && (elapsed.nanoseconds < 200000000)) {
+            time_get(&start);
+
+            for (i = 0; i < CONFIG_LOG_BINARY_RECORDS_MAX; i++) {
+                log_object_print(&foo,
+                                 LOG_INFO,
+                                 FSTR("sensor %s: %d, %lu\r\n"),
+                                 "temp",
+                                 i,
+                                 123456ul);
+            }
+
+            time_get(&stop);
+            time_subtract(&stop, &stop, &start);
+            time_add(&elapsed, &elapsed, &stop);
+            rounds += CONFIG_LOG_BINARY_RECORDS_MAX;
+
+            if (binary == 1) {
+                BTASSERTI(log_binary_process(),
+                          ==,
+                          CONFIG_LOG_BINARY_RECORDS_MAX);
+            }
+        }
+
+        std_printf(FSTR("%s: %d entries in %lu us\r\n"),
+                   (binary == 1) ? "binary" : "formatted",
+                   rounds,
+                   1000000ul * elapsed.seconds + elapsed.nanoseconds / 1000);
+    }
+
+    BTASSERT(log_set_default_handler_output_channel(sys_get_stdout()) == 0);
+    BTASSERT(log_binary_enable(0) == 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -236,6 +406,9 @@ int main()
         { test_handler, "test_handler" },
         { test_log_mask, "test_log_mask" },
         { test_fs, "test_fs" },
+        { test_binary, "test_binary" },
+        { test_binary_dump, "test_binary_dump" },
+        { test_benchmark, "test_benchmark" },
         { NULL, NULL }
     };
 
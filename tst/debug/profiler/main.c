@@ -0,0 +1,249 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static char buf[4096];
+
+static int read_dump(struct queue_t *queue_p)
+{
+    ssize_t size;
+
+    size = queue_size(queue_p);
+
+    if (size >= (ssize_t)sizeof(buf)) {
+        return (-1);
+    }
+
+    queue_read(queue_p, &buf[0], size);
+    buf[size] = '\0';
+
+    return (size);
+}
+
+static int count_char(const char *str_p, char c)
+{
+    int count;
+
+    count = 0;
+
+    while (*str_p != '\0') {
+        if (*str_p == c) {
+            count++;
+        }
+
+        str_p++;
+    }
+
+    return (count);
+}
+
+static void busy_wait(int ms)
+{
+    struct time_t start;
+    struct time_t now;
+    struct time_t elapsed;
+    volatile int counter;
+    int i;
+
+    time_get(&start);
+
+    do {
+        for (i = 0; i < 1000; i++) {
+            counter++;
+        }
+
+        time_get(&now);
+        time_subtract(&elapsed, &now, &start);
+    } while ((1000 * elapsed.seconds + elapsed.nanoseconds / 1000000) < ms);
+}
+
+static int test_init(void)
+{
+    BTASSERT(profiler_module_init() == 0);
+    BTASSERT(profiler_module_init() == 0);
+
+    return (0);
+}
+
+static int test_sample_isr(void)
+{
+    struct profiler_statistics_t statistics;
+    struct queue_t queue;
+    void *frames[CONFIG_PROFILER_DEPTH_MAX + 2];
+    int i;
+
+    BTASSERT(queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(profiler_reset() == 0);
+
+    frames[0] = (void *)0x3000;
+    frames[1] = (void *)0x2000;
+    frames[2] = (void *)0x1000;
+
+    /* Two samples of the same stack and one of a shorter stack. */
+    profiler_sample_isr(&frames[0], 3);
+    profiler_sample_isr(&frames[0], 3);
+    profiler_sample_isr(&frames[1], 2);
+
+    BTASSERT(profiler_get_statistics(&statistics) == 0);
+    BTASSERTI(statistics.samples, ==, 3);
+    BTASSERTI(statistics.dropped, ==, 0);
+    BTASSERTI(statistics.stacks, ==, 2);
+
+    /* Deep stacks are truncated. */
+    for (i = 0; i < membersof(frames); i++) {
+        frames[i] = (void *)(uintptr_t)(0x1000 * (i + 1));
+    }
+
+    profiler_sample_isr(&frames[0], membersof(frames));
+    BTASSERT(profiler_get_statistics(&statistics) == 0);
+    BTASSERTI(statistics.stacks, ==, 3);
+
+    BTASSERTI(profiler_dump(&queue), ==, 3);
+    BTASSERT(read_dump(&queue) > 0);
+    BTASSERT(strncmp(&buf[0], "main;0x", 7) == 0);
+    BTASSERT(strstr(&buf[0], " 2\r\n") != NULL);
+    BTASSERTI(count_char(&buf[0], '\n'), ==, 3);
+    BTASSERTI(count_char(&buf[0], ';'),
+              ==,
+              3 + 2 + CONFIG_PROFILER_DEPTH_MAX);
+
+    return (0);
+}
+
+static int test_table_full(void)
+{
+    struct profiler_statistics_t statistics;
+    void *frames[1];
+    int i;
+
+    BTASSERT(profiler_reset() == 0);
+
+    for (i = 0; i < CONFIG_PROFILER_STACKS_MAX + 2; i++) {
+        frames[0] = (void *)(uintptr_t)(0x1000 + 4 * i);
+        profiler_sample_isr(&frames[0], 1);
+    }
+
+    /* Existing stacks are still counted. */
+    frames[0] = (void *)0x1000;
+    profiler_sample_isr(&frames[0], 1);
+
+    BTASSERT(profiler_get_statistics(&statistics) == 0);
+    BTASSERTI(statistics.samples, ==, CONFIG_PROFILER_STACKS_MAX + 1);
+    BTASSERTI(statistics.dropped, ==, 2);
+    BTASSERTI(statistics.stacks, ==, CONFIG_PROFILER_STACKS_MAX);
+
+    BTASSERT(profiler_reset() == 0);
+    BTASSERT(profiler_get_statistics(&statistics) == 0);
+    BTASSERTI(statistics.samples, ==, 0);
+    BTASSERTI(statistics.dropped, ==, 0);
+    BTASSERTI(statistics.stacks, ==, 0);
+
+    return (0);
+}
+
+static int test_sampling(void)
+{
+    struct profiler_statistics_t statistics;
+    struct queue_t queue;
+
+    BTASSERT(queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(profiler_reset() == 0);
+
+    BTASSERT(profiler_start(1000) == 0);
+    BTASSERT(profiler_start(1000) == -EBUSY);
+    busy_wait(200);
+    BTASSERT(profiler_stop() == 0);
+    BTASSERT(profiler_stop() == 0);
+
+    BTASSERT(profiler_get_statistics(&statistics) == 0);
+    std_printf(OSTR("samples: %lu, dropped: %lu, stacks: %d\r\n"),
+               (unsigned long)statistics.samples,
+               (unsigned long)statistics.dropped,
+               statistics.stacks);
+    BTASSERTI(statistics.samples, >, 10);
+    BTASSERTI(statistics.stacks, >, 0);
+
+    /* No samples when stopped. */
+    busy_wait(50);
+    BTASSERT(profiler_get_statistics(&statistics) == 0);
+    BTASSERTI(profiler_dump(sys_get_stdout()), ==, statistics.stacks);
+
+    return (0);
+}
+
+static int test_fs_commands(void)
+{
+    char command[64];
+
+    strcpy(command, "/debug/profiler/start 500");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+    busy_wait(50);
+    strcpy(command, "/debug/profiler/status");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+    strcpy(command, "/debug/profiler/stop");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+    strcpy(command, "/debug/profiler/dump");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+    strcpy(command, "/debug/profiler/reset");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+
+    /* Default frequency. */
+    strcpy(command, "/debug/profiler/start");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+    strcpy(command, "/debug/profiler/stop");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+
+    /* Bad arguments. */
+    strcpy(command, "/debug/profiler/start 0");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == -EINVAL);
+    strcpy(command, "/debug/profiler/start foo");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == -EINVAL);
+    strcpy(command, "/debug/profiler/start 1 2");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == -EINVAL);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_sample_isr, "test_sample_isr" },
+        { test_table_full, "test_table_full" },
+        { test_sampling, "test_sampling" },
+        { test_fs_commands, "test_fs_commands" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -34,7 +34,14 @@
 #    define FLASH_SIZE                       0x800
 #    define CHUNK_SIZE                       0x100
 
-static uint8_t flash_buf[FLASH_SIZE];
+/* Larger than the EEPROM area to fit the benchmark blocks. */
+static uint8_t flash_buf[0x10000];
+static int number_of_flash_reads;
+
+static const struct eeprom_soft_block_t benchmark_blocks[2] = {
+    { .address = 0x0000, .size = 0x8000 },
+    { .address = 0x8000, .size = 0x8000 }
+};
 
 #elif defined(FAMILY_SPC5)
 #    define DEVICE_INDEX                         1
@@ -261,11 +268,18 @@ static int test_mount_corrupt_header_crc(void)
 static int test_mount_flash_read_fails(void)
 {
     ssize_t res;
+    int i;
 
     BTASSERT(eeprom_soft_format(&eeprom_soft) == 0);
 
+    /* The binary search reads the headers of chunk 2, 1 and 0 in
+       the first block. */
     res = -1;
-    harness_mock_write("flash_read(): return (res)", &res, sizeof(res));
+
+    for (i = 0; i < 3; i++) {
+        harness_mock_write("flash_read(): return (res)", &res, sizeof(res));
+    }
+
     BTASSERT(eeprom_soft_mount(&eeprom_soft) == -1);
 
     return (0);
@@ -289,6 +303,63 @@ static int test_mount_after_write(void)
     return (0);
 }
 
+static int test_mount_benchmark(void)
+{
+    struct eeprom_soft_driver_t eeprom;
+    uint32_t counter;
+    int i;
+    int start;
+    int elapsed;
+    int number_of_chunks;
+
+    /* Small chunks to get many of them in each block. */
+    BTASSERT(eeprom_soft_init(&eeprom,
+                              &flash,
+                              &benchmark_blocks[0],
+                              membersof(benchmark_blocks),
+                              16) == 0);
+    BTASSERT(eeprom_soft_format(&eeprom) == 0);
+    BTASSERT(eeprom_soft_mount(&eeprom) == 0);
+
+    number_of_chunks = (sizeof(flash_buf) / 16);
+
+    /* Fill the first block and most of the second. */
+    for (i = 0; i < number_of_chunks - 10; i++) {
+        counter = i;
+        BTASSERT(eeprom_soft_write(&eeprom,
+                                   0,
+                                   &counter,
+                                   sizeof(counter)) == sizeof(counter));
+    }
+
+    number_of_flash_reads = 0;
+    start = time_micros();
+    BTASSERT(eeprom_soft_mount(&eeprom) == 0);
+    elapsed = time_micros_elapsed(start, time_micros());
+
+    std_printf(OSTR("Mounted %d chunks using %d flash reads in %d us.\r\n"
+                    "Chunk writes: %lu, block erases: %lu.\r\n"),
+               number_of_chunks,
+               number_of_flash_reads,
+               elapsed,
+               (unsigned long)eeprom.statistics.chunk_writes,
+               (unsigned long)eeprom.statistics.block_erases);
+
+    /* Binary search in each block and a CRC of the latest chunk. */
+    BTASSERTI(number_of_flash_reads, <=, 2 * 12 + 2);
+
+    counter = 0;
+    BTASSERT(eeprom_soft_read(&eeprom,
+                              &counter,
+                              0,
+                              sizeof(counter)) == sizeof(counter));
+    BTASSERTI(counter, ==, number_of_chunks - 11);
+    BTASSERTI(eeprom.statistics.chunk_writes, ==, number_of_chunks - 9);
+    BTASSERTI(eeprom.statistics.block_erases, ==, 3);
+
+    return (0);
+}
+
 static int test_write_flash_read_fails_blank_chunk(void)
 {
     uint8_t byte;
@@ -364,7 +435,7 @@ ssize_t __wrap_flash_read(struct flash_driver_t *self_p,
                           size_t size)
 {
     BTASSERT(self_p != NULL);
-    BTASSERTI(src, <, FLASH_SIZE);
+    BTASSERTI(src, <, sizeof(flash_buf));
     BTASSERTI(size, <=, CHUNK_SIZE);
 
     ssize_t res;
@@ -379,6 +450,8 @@ ssize_t __wrap_flash_read(struct flash_driver_t *self_p,
         res = size;
     }
 
+    number_of_flash_reads++;
+
     return (res);
 }
 
@@ -388,7 +461,7 @@ ssize_t __wrap_flash_write(struct flash_driver_t *self_p,
                            size_t size)
 {
     BTASSERT(self_p != NULL);
-    BTASSERT(dst < FLASH_SIZE);
+    BTASSERT(dst < sizeof(flash_buf));
     BTASSERT(size <= CHUNK_SIZE);
 
     memcpy(&flash_buf[dst], src_p, size);
@@ -401,8 +474,8 @@ int __wrap_flash_erase(struct flash_driver_t *self_p,
                        size_t size)
 {
     BTASSERT(self_p != NULL);
-    BTASSERT(addr < FLASH_SIZE);
-    BTASSERT(size <= FLASH_SIZE);
+    BTASSERT(addr < sizeof(flash_buf));
+    BTASSERT(size <= sizeof(flash_buf));
 
     int res;
     int res2;
@@ -435,6 +508,7 @@ int main()
         { test_mount_corrupt_header_crc, "test_mount_corrupt_header_crc" },
         { test_mount_flash_read_fails, "test_mount_flash_read_fails" },
         { test_mount_after_write, "test_mount_after_write" },
+        { test_mount_benchmark, "test_mount_benchmark" },
         {
             test_write_flash_read_fails_blank_chunk,
             "test_write_flash_read_fails_blank_chunk"
@@ -0,0 +1,231 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#define SAMPLING_RATE                                 10000
+#define LENGTH                                          500
+#define FILE_SAMPLES                                    997
+
+static struct adc_driver_t adc;
+static struct adc_stream_t stream;
+static uint16_t samples[2 * LENGTH];
+
+static int create_replay_file(void)
+{
+    FILE *file_p;
+    int i;
+
+    file_p = fopen("adc0.txt", "w");
+
+    if (file_p == NULL) {
+        return (-1);
+    }
+
+    for (i = 0; i < FILE_SAMPLES; i++) {
+        fprintf(file_p, "%d\n", i);
+    }
+
+    fclose(file_p);
+
+    return (0);
+}
+
+static int buffer_is_continuous(struct adc_stream_buffer_t *buffer_p,
+                                int *next_p)
+{
+    size_t i;
+
+    for (i = 0; i < buffer_p->length; i++) {
+        if (buffer_p->samples_p[i] != *next_p) {
+            return (0);
+        }
+
+        *next_p = ((*next_p + 1) % FILE_SAMPLES);
+    }
+
+    return (1);
+}
+
+static int test_init(void)
+{
+    BTASSERT(create_replay_file() == 0);
+    BTASSERT(adc_module_init() == 0);
+    BTASSERT(adc_init(&adc,
+                      &adc_device[0],
+                      &pin_device[0],
+                      ADC_REFERENCE_VCC,
+                      SAMPLING_RATE) == 0);
+    BTASSERT(adc_stream_init(&stream, &adc, &samples[0], LENGTH) == 0);
+
+    return (0);
+}
+
+static int test_stream(void)
+{
+    struct adc_stream_buffer_t buffer;
+    struct time_t start;
+    struct time_t stop;
+    struct time_t elapsed;
+    int next;
+    int i;
+
+    next = 0;
+    time_get(&start);
+
+    BTASSERT(adc_stream_start(&stream) == 0);
+
+    /* Ping-pong between the two buffers without losing samples. */
+    for (i = 0; i < 8; i++) {
+        BTASSERT(adc_stream_read(&stream, &buffer) == 0);
+        BTASSERTI(buffer.sequence, ==, i);
+        BTASSERTI(buffer.length, ==, LENGTH);
+        BTASSERTI(buffer.overruns, ==, 0);
+        BTASSERT(buffer.samples_p == &samples[(i % 2) * LENGTH]);
+        BTASSERT(buffer_is_continuous(&buffer, &next));
+        BTASSERT(adc_stream_release(&stream, &buffer) == 0);
+    }
+
+    BTASSERT(adc_stream_stop(&stream) == 0);
+
+    /* 4000 samples at 10 kHz. */
+    time_get(&stop);
+    time_subtract(&elapsed, &stop, &start);
+    std_printf(FSTR("elapsed: %lu.%09lu s\r\n"),
+               (unsigned long)elapsed.seconds,
+               (unsigned long)elapsed.nanoseconds);
+    BTASSERT(elapsed.seconds == 0);
+    BTASSERT(elapsed.nanoseconds >= 390000000);
+
+    return (0);
+}
+
+static int test_overrun(void)
+{
+    struct adc_stream_buffer_t buffers[2];
+    struct adc_stream_buffer_t buffer;
+    int next;
+
+    next = 0;
+
+    BTASSERT(adc_stream_start(&stream) == 0);
+
+    /* Keep both buffers for a while. */
+    BTASSERT(adc_stream_read(&stream, &buffers[0]) == 0);
+    BTASSERT(adc_stream_read(&stream, &buffers[1]) == 0);
+    BTASSERT(buffer_is_continuous(&buffers[0], &next));
+    BTASSERT(buffer_is_continuous(&buffers[1], &next));
+    thrd_sleep_ms(225);
+    BTASSERT(adc_stream_release(&stream, &buffers[0]) == 0);
+    BTASSERT(adc_stream_release(&stream, &buffers[1]) == 0);
+
+    /* The dropped buffers are counted and the samples are missing
+       from the stream. */
+    BTASSERT(adc_stream_read(&stream, &buffer) == 0);
+    BTASSERTI(buffer.sequence, ==, 2);
+    BTASSERT(buffer.overruns >= 3);
+    next = ((next + buffer.overruns * LENGTH) % FILE_SAMPLES);
+    BTASSERT(buffer_is_continuous(&buffer, &next));
+    BTASSERT(adc_stream_release(&stream, &buffer) == 0);
+
+    BTASSERT(adc_stream_stop(&stream) == 0);
+
+    /* A buffer not belonging to the stream. */
+    buffer.samples_p = &samples[1];
+    BTASSERTI(adc_stream_release(&stream, &buffer), ==, -EINVAL);
+
+    return (0);
+}
+
+static int test_poll(void)
+{
+    struct chan_list_t list;
+    struct chan_list_elem_t elements[2];
+    struct queue_t queue;
+    struct adc_stream_buffer_t buffer;
+    struct time_t timeout;
+    int i;
+
+    BTASSERT(queue_init(&queue, NULL, 0) == 0);
+    BTASSERT(chan_list_init(&list, &elements[0], membersof(elements)) == 0);
+    BTASSERT(chan_list_add(&list, &queue) == 0);
+    BTASSERT(chan_list_add(&list, &stream.chout) == 0);
+
+    BTASSERT(adc_stream_start(&stream) == 0);
+
+    timeout.seconds = 1;
+    timeout.nanoseconds = 0;
+
+    for (i = 0; i < 4; i++) {
+        BTASSERT(chan_list_poll(&list, &timeout) == &stream.chout);
+        BTASSERT(adc_stream_read(&stream, &buffer) == 0);
+        BTASSERTI(buffer.sequence, ==, i);
+        BTASSERT(adc_stream_release(&stream, &buffer) == 0);
+    }
+
+    BTASSERT(adc_stream_stop(&stream) == 0);
+
+    return (0);
+}
+
+static int test_missing_file(void)
+{
+    struct adc_driver_t adc2;
+    struct adc_stream_t stream2;
+
+    BTASSERT(adc_init(&adc2,
+                      &adc_device[1],
+                      &pin_device[1],
+                      ADC_REFERENCE_VCC,
+                      SAMPLING_RATE) == 0);
+    BTASSERT(adc_stream_init(&stream2, &adc2, &samples[0], LENGTH) == 0);
+    BTASSERTI(adc_stream_start(&stream2), ==, -ENOENT);
+    BTASSERT(adc_stream_stop(&stream2) == 0);
+
+    remove("adc0.txt");
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_stream, "test_stream" },
+        { test_overrun, "test_overrun" },
+        { test_poll, "test_poll" },
+        { test_missing_file, "test_missing_file" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,267 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+static struct can_driver_t can;
+static struct can_frame_t rxbuf[64];
+
+/**
+ * Input given frame the same way the port does when a frame is
+ * received.
+ */
+static int input_frame(uint32_t id, int extended_frame)
+{
+    struct can_frame_t frame;
+    int accepted;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.id = id;
+    frame.extended_frame = extended_frame;
+    frame.size = 4;
+    memcpy(&frame.data.u8[0], &id, sizeof(id));
+
+    sys_lock();
+    accepted = can_filter_isr(&can, &frame);
+
+    if (accepted == 1) {
+        queue_write_isr(&can.chin, &frame, sizeof(frame));
+    }
+
+    sys_unlock();
+
+    return (accepted);
+}
+
+static int test_init(void)
+{
+    BTASSERT(can_module_init() == 0);
+    BTASSERT(can_init(&can,
+                      &can_device[0],
+                      CAN_SPEED_500KBPS,
+                      &rxbuf[0],
+                      sizeof(rxbuf)) == 0);
+    BTASSERT(can_start(&can) == 0);
+
+    return (0);
+}
+
+static int test_read_write_frames(void)
+{
+    struct can_frame_t frames[8];
+    int i;
+
+    /* Only the available frames are read. */
+    BTASSERT(input_frame(0x10, 0) == 1);
+    BTASSERT(input_frame(0x11, 0) == 1);
+    BTASSERT(input_frame(0x12, 0) == 1);
+    BTASSERTI(can_read_frames(&can, &frames[0], membersof(frames)), ==, 3);
+
+    for (i = 0; i < 3; i++) {
+        BTASSERTI(frames[i].id, ==, 0x10 + i);
+        BTASSERTI(frames[i].size, ==, 4);
+    }
+
+    /* Not more than given number of frames. */
+    for (i = 0; i < 10; i++) {
+        BTASSERT(input_frame(0x20 + i, 0) == 1);
+    }
+
+    BTASSERTI(can_read_frames(&can, &frames[0], membersof(frames)), ==, 8);
+    BTASSERTI(frames[7].id, ==, 0x27);
+    BTASSERTI(can_read_frames(&can, &frames[0], membersof(frames)), ==, 2);
+    BTASSERTI(frames[0].id, ==, 0x28);
+    BTASSERTI(frames[1].id, ==, 0x29);
+
+    /* No socket device client is connected, so the frames are
+       dropped. */
+    BTASSERTI(can_write_frames(&can, &frames[0], 2), ==, 2);
+
+    return (0);
+}
+
+static int test_filter_table(void)
+{
+    struct can_filter_t filters[3];
+    struct can_frame_t frame;
+
+    /* Standard ids 0x100-0x10f. */
+    filters[0].id = 0x100;
+    filters[0].mask = 0x7f0;
+    filters[0].extended_frame = 0;
+    filters[0].counter = 0;
+
+    /* Extended id 0x18daf110. */
+    filters[1].id = 0x18daf110;
+    filters[1].mask = 0x1fffffff;
+    filters[1].extended_frame = 1;
+    filters[1].counter = 0;
+
+    /* Standard id 0x7df. */
+    filters[2].id = 0x7df;
+    filters[2].mask = 0x7ff;
+    filters[2].extended_frame = 0;
+    filters[2].counter = 0;
+
+    BTASSERT(can_set_filters(&can, &filters[0], membersof(filters)) == 0);
+
+    BTASSERT(input_frame(0x100, 0) == 1);
+    BTASSERT(input_frame(0x10f, 0) == 1);
+    BTASSERT(input_frame(0x110, 0) == 0);
+    BTASSERT(input_frame(0x100, 1) == 0);
+    BTASSERT(input_frame(0x18daf110, 1) == 1);
+    BTASSERT(input_frame(0x18daf111, 1) == 0);
+    BTASSERT(input_frame(0x7df, 0) == 1);
+    BTASSERT(input_frame(0x7de, 0) == 0);
+
+    BTASSERTI(filters[0].counter, ==, 2);
+    BTASSERTI(filters[1].counter, ==, 1);
+    BTASSERTI(filters[2].counter, ==, 1);
+    BTASSERTI(can.filters.rejected, ==, 4);
+
+    /* Only accepted frames are in the input queue. */
+    BTASSERTI(can_read_frames(&can, &frame, 1), ==, 1);
+    BTASSERTI(frame.id, ==, 0x100);
+    BTASSERTI(can_read_frames(&can, &frame, 1), ==, 1);
+    BTASSERTI(frame.id, ==, 0x10f);
+    BTASSERTI(can_read_frames(&can, &frame, 1), ==, 1);
+    BTASSERTI(frame.id, ==, 0x18daf110);
+    BTASSERTI(can_read_frames(&can, &frame, 1), ==, 1);
+    BTASSERTI(frame.id, ==, 0x7df);
+    BTASSERTI(queue_size(&can.chin), ==, 0);
+
+    /* Remove the table to accept all frames again. */
+    BTASSERT(can_set_filters(&can, NULL, 0) == 0);
+    BTASSERT(input_frame(0x110, 0) == 1);
+    BTASSERTI(can_read_frames(&can, &frame, 1), ==, 1);
+
+    return (0);
+}
+
+static int test_filter_bitmap(void)
+{
+    static uint8_t bitmap[CAN_FILTER_BITMAP_SIZE];
+    struct can_filter_t filter;
+    struct can_frame_t frames[4];
+
+    memset(&bitmap[0], 0, sizeof(bitmap));
+    bitmap[0x7e8 / 8] |= (1 << (0x7e8 % 8));
+    bitmap[0x7ef / 8] |= (1 << (0x7ef % 8));
+    BTASSERT(can_set_filter_bitmap(&can, &bitmap[0]) == 0);
+
+    BTASSERT(input_frame(0x7e8, 0) == 1);
+    BTASSERT(input_frame(0x7e9, 0) == 0);
+    BTASSERT(input_frame(0x7ef, 0) == 1);
+    BTASSERT(input_frame(0x7e8, 1) == 0);
+
+    /* The bitmap is combined with the filter table. */
+    filter.id = 0x7e8;
+    filter.mask = 0x1fffffff;
+    filter.extended_frame = 1;
+    filter.counter = 0;
+    BTASSERT(can_set_filters(&can, &filter, 1) == 0);
+    BTASSERT(input_frame(0x7e8, 1) == 1);
+    BTASSERT(input_frame(0x7e9, 0) == 0);
+
+    BTASSERTI(can.filters.bitmap_counter, ==, 2);
+    BTASSERTI(filter.counter, ==, 1);
+    BTASSERTI(can_read_frames(&can, &frames[0], membersof(frames)), ==, 3);
+
+    BTASSERT(can_set_filters(&can, NULL, 0) == 0);
+    BTASSERT(can_set_filter_bitmap(&can, NULL) == 0);
+
+    return (0);
+}
+
+static int test_benchmark(void)
+{
+    static uint8_t bitmap[CAN_FILTER_BITMAP_SIZE];
+    struct can_frame_t frames[16];
+    struct time_t start;
+    struct time_t stop;
+    struct time_t elapsed;
+    unsigned long micros;
+    int i;
+    int j;
+    int rounds;
+
+    /* Accept one id in eight, like a gateway interested in a few
+       ECUs on a busy bus. */
+    memset(&bitmap[0], 0x01, sizeof(bitmap));
+    BTASSERT(can_set_filter_bitmap(&can, &bitmap[0]) == 0);
+
+    rounds = 0;
+    time_get(&start);
+
+    do {
+        for (i = 0; i < 128; i++) {
+            input_frame(i, 0);
+        }
+
+        for (i = 0; i < 16; i += j) {
+            j = can_read_frames(&can, &frames[0], membersof(frames));
+            BTASSERT(j > 0);
+        }
+
+        rounds++;
+        time_get(&stop);
+        time_subtract(&elapsed, &stop, &start);
+    } while ((elapsed.seconds == 0)
+             && (elapsed.nanoseconds < 200000000));
+
+    micros = (elapsed.seconds * 1000000ul + elapsed.nanoseconds / 1000ul);
+
+    std_printf(FSTR("%lu frames received, %lu accepted, in %lu us.\r\n"),
+               (unsigned long)rounds * 128ul,
+               (unsigned long)rounds * 16ul,
+               micros);
+
+    BTASSERTI(can.filters.rejected, ==, 4 + 3 + rounds * 112);
+    BTASSERT(can_set_filter_bitmap(&can, NULL) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_read_write_frames, "test_read_write_frames" },
+        { test_filter_table, "test_filter_table" },
+        { test_filter_bitmap, "test_filter_bitmap" },
+        { test_benchmark, "test_benchmark" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,139 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct i2c_driver_t i2c;
+static struct i2c_queue_t queue;
+static struct event_t event;
+static int completed;
+
+static void on_complete(struct i2c_request_t *request_p, void *arg_p)
+{
+    completed++;
+}
+
+static int test_init(void)
+{
+    BTASSERT(i2c_module_init() == 0);
+    BTASSERT(i2c_init(&i2c, &i2c_device[0], I2C_BAUDRATE_100KBPS, -1) == 0);
+    BTASSERT(i2c_start(&i2c) == 0);
+    BTASSERT(event_init(&event) == 0);
+    BTASSERT(i2c_queue_init(&queue, 1) == 0);
+
+    return (0);
+}
+
+static int test_write(void)
+{
+    struct i2c_request_t request;
+    struct i2c_descriptor_t descriptors[2];
+    uint8_t config[2] = { 0xf4, 0x27 };
+    uint8_t display[16];
+    uint32_t mask;
+
+    memset(&display[0], 0x55, sizeof(display));
+
+    /* Configure a sensor and update a display. */
+    descriptors[0].address = 0x76;
+    descriptors[0].rxbuf_p = NULL;
+    descriptors[0].txbuf_p = &config[0];
+    descriptors[0].size = sizeof(config);
+    descriptors[1].address = 0x3c;
+    descriptors[1].rxbuf_p = NULL;
+    descriptors[1].txbuf_p = &display[0];
+    descriptors[1].size = sizeof(display);
+
+    BTASSERT(i2c_request_init(&request,
+                              &i2c,
+                              &descriptors[0],
+                              membersof(descriptors)) == 0);
+    BTASSERT(i2c_request_set_event(&request, &event, 0x1) == 0);
+    BTASSERT(i2c_request_set_callback(&request, on_complete, NULL) == 0);
+    BTASSERT(i2c_queue_submit(&queue, &request) == 0);
+    BTASSERTI(i2c_request_get_result(&request), ==, -EINPROGRESS);
+
+    mask = 0x1;
+    BTASSERTI(event_read(&event, &mask, sizeof(mask)), ==, sizeof(mask));
+    BTASSERTI(mask, ==, 0x1);
+    BTASSERTI(completed, ==, 1);
+    BTASSERTI(i2c_request_get_result(&request), ==, 18);
+
+    return (0);
+}
+
+static int test_read_failure(void)
+{
+    struct i2c_request_t request;
+    struct i2c_descriptor_t descriptors[2];
+    uint8_t reg = 0xfa;
+    uint8_t buf[3];
+    uint32_t mask;
+
+    /* The Linux port does not support reads. The error is reported
+       as the request result. */
+    descriptors[0].address = 0x76;
+    descriptors[0].rxbuf_p = NULL;
+    descriptors[0].txbuf_p = &reg;
+    descriptors[0].size = sizeof(reg);
+    descriptors[1].address = 0x76;
+    descriptors[1].rxbuf_p = &buf[0];
+    descriptors[1].txbuf_p = NULL;
+    descriptors[1].size = sizeof(buf);
+
+    BTASSERT(i2c_request_init(&request,
+                              &i2c,
+                              &descriptors[0],
+                              membersof(descriptors)) == 0);
+    BTASSERT(i2c_request_set_event(&request, &event, 0x2) == 0);
+    BTASSERT(i2c_request_set_callback(&request, on_complete, NULL) == 0);
+    BTASSERT(i2c_queue_submit(&queue, &request) == 0);
+
+    mask = 0x2;
+    BTASSERTI(event_read(&event, &mask, sizeof(mask)), ==, sizeof(mask));
+    BTASSERTI(completed, ==, 2);
+    BTASSERTI(i2c_request_get_result(&request), ==, -1);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_write, "test_write" },
+        { test_read_failure, "test_read_failure" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,204 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct spi_driver_t sd;
+static struct spi_driver_t radio;
+static struct spi_queue_t queue;
+static struct event_t event;
+
+static int order[16];
+static int order_length;
+
+static void on_complete(struct spi_request_t *request_p, void *arg_p)
+{
+    order[order_length++] = (int)(uintptr_t)arg_p;
+}
+
+static int test_init(void)
+{
+    BTASSERT(spi_module_init() == 0);
+    BTASSERT(spi_init(&sd,
+                      &spi_device[0],
+                      &pin_device[2],
+                      SPI_MODE_MASTER,
+                      SPI_SPEED_1MBPS,
+                      0,
+                      0) == 0);
+    BTASSERT(spi_init(&radio,
+                      &spi_device[0],
+                      &pin_device[3],
+                      SPI_MODE_MASTER,
+                      SPI_SPEED_1MBPS,
+                      0,
+                      0) == 0);
+    BTASSERT(spi_start(&sd) == 0);
+    BTASSERT(spi_start(&radio) == 0);
+    BTASSERT(event_init(&event) == 0);
+    BTASSERT(spi_queue_init(&queue, 1) == 0);
+
+    return (0);
+}
+
+static int test_transfer(void)
+{
+    struct spi_request_t request;
+    struct spi_descriptor_t descriptors[3];
+    uint8_t command[4] = { 0x51, 0x00, 0x00, 0x01 };
+    uint8_t txbuf[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    uint8_t rxbuf[16];
+    uint8_t loopback[8];
+    uint32_t mask;
+
+    memset(&rxbuf[0], 0, sizeof(rxbuf));
+    memset(&loopback[0], 0, sizeof(loopback));
+
+    /* Command, response and data, with the slave selected once. */
+    descriptors[0].rxbuf_p = NULL;
+    descriptors[0].txbuf_p = &command[0];
+    descriptors[0].size = sizeof(command);
+    descriptors[0].flags = SPI_DESCRIPTOR_SELECT;
+    descriptors[1].rxbuf_p = &rxbuf[0];
+    descriptors[1].txbuf_p = NULL;
+    descriptors[1].size = sizeof(rxbuf);
+    descriptors[1].flags = 0;
+    descriptors[2].rxbuf_p = &loopback[0];
+    descriptors[2].txbuf_p = &txbuf[0];
+    descriptors[2].size = sizeof(txbuf);
+    descriptors[2].flags = SPI_DESCRIPTOR_DESELECT;
+
+    BTASSERT(spi_request_init(&request,
+                              &sd,
+                              &descriptors[0],
+                              membersof(descriptors)) == 0);
+    BTASSERT(spi_request_set_event(&request, &event, 0x1) == 0);
+    BTASSERT(spi_queue_submit(&queue, &request) == 0);
+
+    /* The queue thread has lower priority and has not run yet. */
+    BTASSERTI(spi_request_get_result(&request), ==, -EINPROGRESS);
+
+    mask = 0x1;
+    BTASSERTI(event_read(&event, &mask, sizeof(mask)), ==, sizeof(mask));
+    BTASSERTI(mask, ==, 0x1);
+    BTASSERTI(spi_request_get_result(&request), ==, 28);
+
+    /* The Linux port emulates a loopback bus. */
+    BTASSERTM(&rxbuf[0],
+              "\xff\xff\xff\xff\xff\xff\xff\xff"
+              "\xff\xff\xff\xff\xff\xff\xff\xff",
+              sizeof(rxbuf));
+    BTASSERTM(&loopback[0], &txbuf[0], sizeof(txbuf));
+
+    return (0);
+}
+
+static int test_back_to_back(void)
+{
+    struct spi_request_t requests[8];
+    struct spi_descriptor_t descriptors[8];
+    uint8_t buf[8][32];
+    uint32_t mask;
+    int i;
+
+    order_length = 0;
+
+    /* Interleave requests for two slaves sharing the bus. */
+    for (i = 0; i < membersof(requests); i++) {
+        memset(&buf[i][0], i, sizeof(buf[i]));
+        descriptors[i].rxbuf_p = &buf[i][0];
+        descriptors[i].txbuf_p = &buf[i][0];
+        descriptors[i].size = 4 * (i + 1);
+        descriptors[i].flags = (SPI_DESCRIPTOR_SELECT
+                                | SPI_DESCRIPTOR_DESELECT);
+        BTASSERT(spi_request_init(&requests[i],
+                                  (i % 2) == 0 ? &sd : &radio,
+                                  &descriptors[i],
+                                  1) == 0);
+        BTASSERT(spi_request_set_callback(&requests[i],
+                                          on_complete,
+                                          (void *)(uintptr_t)i) == 0);
+        BTASSERT(spi_queue_submit(&queue, &requests[i]) == 0);
+    }
+
+    /* Only the last request signals the event. */
+    BTASSERT(spi_request_set_event(&requests[7], &event, 0x2) == 0);
+
+    mask = 0x2;
+    BTASSERTI(event_read(&event, &mask, sizeof(mask)), ==, sizeof(mask));
+
+    /* Completed in submission order. */
+    BTASSERTI(order_length, ==, 8);
+
+    for (i = 0; i < membersof(requests); i++) {
+        BTASSERTI(order[i], ==, i);
+        BTASSERTI(spi_request_get_result(&requests[i]), ==, 4 * (i + 1));
+    }
+
+    /* A completed request can be submitted again. */
+    BTASSERT(spi_queue_submit(&queue, &requests[7]) == 0);
+    mask = 0x2;
+    BTASSERTI(event_read(&event, &mask, sizeof(mask)), ==, sizeof(mask));
+    BTASSERTI(order_length, ==, 9);
+    BTASSERTI(spi_request_get_result(&requests[7]), ==, 32);
+
+    return (0);
+}
+
+static int test_empty(void)
+{
+    struct spi_request_t request;
+    uint32_t mask;
+
+    BTASSERT(spi_request_init(&request, &radio, NULL, 0) == 0);
+    BTASSERT(spi_request_set_event(&request, &event, 0x4) == 0);
+    BTASSERT(spi_queue_submit(&queue, &request) == 0);
+
+    mask = 0x4;
+    BTASSERTI(event_read(&event, &mask, sizeof(mask)), ==, sizeof(mask));
+    BTASSERTI(spi_request_get_result(&request), ==, 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_transfer, "test_transfer" },
+        { test_back_to_back, "test_back_to_back" },
+        { test_empty, "test_empty" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
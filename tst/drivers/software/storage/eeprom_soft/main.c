@@ -57,6 +57,28 @@ static int write_calculate_chunk_crc_blank(uintptr_t address,
     return (0);
 }
 
+/**
+ * Reads of given EEPROM region when compared to the data to write,
+ * eight bytes at a time.
+ */
+static int write_check_identical(uint8_t *buf_p,
+                                 uintptr_t address,
+                                 size_t size)
+{
+    size_t offset;
+    size_t chunk_size;
+
+    for (offset = 0; offset < size; offset += chunk_size) {
+        chunk_size = MIN(8, size - offset);
+        mock_write_flash_read(&buf_p[offset],
+                              address + offset,
+                              chunk_size,
+                              chunk_size);
+    }
+
+    return (0);
+}
+
 static int write_write_header_blank(uintptr_t address,
                                     uint16_t revision,
                                     uint16_t valid)
@@ -77,6 +99,25 @@ static int write_write_header_blank(uintptr_t address,
     return (0);
 }
 
+static int write_write_header(uintptr_t address,
+                              uint32_t crc,
+                              uint16_t revision,
+                              uint16_t valid)
+{
+    struct header_t header;
+
+    header.crc = crc;
+    header.revision = revision;
+    header.valid = valid;
+
+    mock_write_flash_write(address,
+                           &header,
+                           sizeof(header),
+                           sizeof(header));
+
+    return (0);
+}
+
 static int write_read_header(uintptr_t address,
                              uint32_t crc,
                              uint16_t revision,
@@ -106,17 +147,32 @@ static int write_read_header_blank(uintptr_t address,
                               valid));
 }
 
+/**
+ * Mount binary searches for the last valid chunk in each block.
+ */
 static int write_mount_read_chunks(struct header_t headers[2][4])
 {
     int i;
-    int j;
+    int low;
+    int high;
+    int middle;
 
     for (i = 0; i < membersof(blocks); i++) {
-        for (j = 0; j < membersof(headers[0]); j++) {
-            write_read_header(blocks[i].address + j * 512,
-                              headers[i][j].crc,
-                              headers[i][j].revision,
-                              headers[i][j].valid);
+        low = 0;
+        high = membersof(headers[0]);
+
+        while (low < high) {
+            middle = (low + (high - low) / 2);
+            write_read_header(blocks[i].address + middle * 512,
+                              headers[i][middle].crc,
+                              headers[i][middle].revision,
+                              headers[i][middle].valid);
+
+            if (headers[i][middle].valid == 0xa5c3) {
+                low = (middle + 1);
+            } else {
+                high = middle;
+            }
         }
     }
 
@@ -268,8 +324,9 @@ static int test_mount_flash_read_fail_all_chunks(void)
                               membersof(blocks),
                               512) == 0);
 
+    /* Binary search reads chunk 2, 1 and 0 in each block. */
     for (i = 0; i < membersof(blocks); i++) {
-        for (j = 0; j < 4; j++) {
+        for (j = 2; j >= 0; j--) {
             mock_write_flash_read(&header,
                                   blocks[i].address + j * 512,
                                   sizeof(header),
@@ -320,23 +377,23 @@ static int test_mount_revision_1_later_than_0(void)
     return (0);
 }
 
-static int test_mount_revision_1_later_than_33000(void)
+static int test_mount_revision_1_later_than_65534(void)
 {
     struct eeprom_soft_driver_t eeprom;
     struct header_t headers[2][4] = {
         /* Block 0. */
         {
-            { .crc = 0xa3295e14, .revision = 65000,  .valid = 0xa5c3 },
-            { .crc = 0xa3295e14, .revision = 33000,  .valid = 0xa5c3 },
+            { .crc = 0xa3295e14, .revision = 65535,  .valid = 0xa5c3 },
+            { .crc = 0xa3295e14, .revision = 0x0000, .valid = 0xa5c3 },
             { .crc = 0xa3295e14, .revision = 0x0001, .valid = 0xa5c3 },
-            { .crc = 0xa3295e14, .revision = 48000,  .valid = 0xa5c3 }
+            { .crc = 0xffffffff, .revision = 0xffff, .valid = 0xffff }
         },
         /* Block 1. */
         {
-            { .crc = 0xa3295e14, .revision = 44912,  .valid = 0xa5c3 },
-            { .crc = 0xffffffff, .revision = 0xffff, .valid = 0xffff },
-            { .crc = 0xffffffff, .revision = 0xffff, .valid = 0xffff },
-            { .crc = 0xffffffff, .revision = 0xffff, .valid = 0xffff }
+            { .crc = 0xa3295e14, .revision = 65531,  .valid = 0xa5c3 },
+            { .crc = 0xa3295e14, .revision = 65532,  .valid = 0xa5c3 },
+            { .crc = 0xa3295e14, .revision = 65533,  .valid = 0xa5c3 },
+            { .crc = 0xa3295e14, .revision = 65534,  .valid = 0xa5c3 }
         }
     };
 
@@ -524,6 +581,7 @@ static int test_write(void)
     struct eeprom_soft_driver_t eeprom;
     uint8_t data;
     uint8_t buf[8];
+    uint8_t chunk[504];
 
     BTASSERT(eeprom_soft_init(&eeprom,
                               &flash,
@@ -556,9 +614,14 @@ static int test_write(void)
                                       sizeof(buf),
                                       sizeof(buf),
                                       (512 - 16) / sizeof(buf));
-    write_write_header_blank(blocks[0].address + 512,
-                             1,
-                             0xa5c3);
+
+    /* The CRC is calculated while copying, not read back. */
+    memset(&chunk[0], -1, sizeof(chunk));
+    chunk[0] = data;
+    write_write_header(blocks[0].address + 512,
+                       crc_32(0, &chunk[0], sizeof(chunk)),
+                       1,
+                       0xa5c3);
 
     BTASSERTI(eeprom_soft_write(&eeprom,
                                 0,
@@ -623,11 +686,14 @@ static int test_vwrite(void)
     memcpy(&buf[33],
            &part_1[0],
            strlen(part_1));
-    mock_write_flash_read_seq(&buf[33],
-                              blocks[0].address + 8 + 33,
-                              strlen(part_1) + 1,
-                              1,
-                              strlen(part_1) + 1);
+    mock_write_flash_read(&buf[33],
+                          blocks[0].address + 8 + 33,
+                          strlen(part_1),
+                          strlen(part_1));
+    mock_write_flash_read(&buf[33 + strlen(part_1)],
+                          blocks[0].address + 8 + 33 + strlen(part_1),
+                          8,
+                          8);
     write_get_blank_chunk_block_0_chunk_1_blank();
     mock_write_flash_read_seq(&buf[0],
                               blocks[0].address + 8,
@@ -645,9 +711,10 @@ static int test_vwrite(void)
                                sizeof(buf),
                                8,
                                sizeof(buf) / 8);
-    write_write_header_blank(blocks[0].address + 512,
-                             1,
-                             0xa5c3);
+    write_write_header(blocks[0].address + 512,
+                       crc_32(0, &buf[0], sizeof(buf)),
+                       1,
+                       0xa5c3);
 
     dst[0].address = 33;
     dst[0].size = strlen(part_1);
@@ -691,11 +758,10 @@ static int test_vwrite_holes(void)
 
     /* Write. */
     memset(&buf[0], -1, sizeof(buf));
-    mock_write_flash_read_seq_repeat(&buf[32],
-                                     blocks[0].address + 8 + 32,
-                                     1,
-                                     1,
-                                     1);
+    mock_write_flash_read(&buf[32],
+                          blocks[0].address + 8 + 32,
+                          strlen(part_1),
+                          strlen(part_1));
     write_get_blank_chunk_block_0_chunk_1_blank();
     mock_write_flash_read_seq(&buf[0],
                               blocks[0].address + 8,
@@ -716,9 +782,10 @@ static int test_vwrite_holes(void)
                                sizeof(buf),
                                8,
                                sizeof(buf) / 8);
-    write_write_header_blank(blocks[0].address + 512,
-                             1,
-                             0xa5c3);
+    write_write_header(blocks[0].address + 512,
+                       crc_32(0, &buf[0], sizeof(buf)),
+                       1,
+                       0xa5c3);
 
     dst[0].address = 32;
     dst[0].size = strlen(part_1);
@@ -771,11 +838,16 @@ static int test_vwrite_identical(void)
     memcpy(&buf[33 + strlen(part_1) + strlen(part_2)],
            &part_3[0],
            strlen(part_3));
-    mock_write_flash_read_seq(&buf[33],
-                              blocks[0].address + 8 + 33,
-                              strlen(part_1) + strlen(part_2) + strlen(part_3),
-                              1,
-                              strlen(part_1) + strlen(part_2) + strlen(part_3));
+    write_check_identical(&buf[33],
+                          blocks[0].address + 8 + 33,
+                          strlen(part_1));
+    write_check_identical(&buf[33 + strlen(part_1)],
+                          blocks[0].address + 8 + 33 + strlen(part_1),
+                          strlen(part_2));
+    write_check_identical(&buf[33 + strlen(part_1) + strlen(part_2)],
+                          (blocks[0].address + 8 + 33 + strlen(part_1)
+                           + strlen(part_2)),
+                          strlen(part_3));
 
     dst[0].address = 33;
     dst[0].size = strlen(part_1);
@@ -819,11 +891,10 @@ static int test_vwrite_out_of_order(void)
 
     /* Write. */
     memset(&buf[0], -1, sizeof(buf));
-    mock_write_flash_read_seq(&buf[33 + strlen(part_1)],
-                              blocks[0].address + 8 + 33 + strlen(part_1),
-                              1,
-                              1,
-                              1);
+    mock_write_flash_read(&buf[33 + strlen(part_1)],
+                          blocks[0].address + 8 + 33 + strlen(part_1),
+                          8,
+                          8);
     write_get_blank_chunk_block_0_chunk_1_blank();
     mock_write_flash_read_seq(&buf[0],
                               blocks[0].address + 8,
@@ -844,9 +915,10 @@ static int test_vwrite_out_of_order(void)
                                sizeof(buf),
                                8,
                                sizeof(buf) / 8);
-    write_write_header_blank(blocks[0].address + 512,
-                             1,
-                             0xa5c3);
+    write_write_header(blocks[0].address + 512,
+                       crc_32(0, &buf[0], sizeof(buf)),
+                       1,
+                       0xa5c3);
 
     dst[0].address = (33 + strlen(part_1));
     dst[0].size = strlen(part_2);
@@ -923,8 +995,8 @@ int main()
             "test_mount_revision_1_later_than_0"
         },
         {
-            test_mount_revision_1_later_than_33000,
-            "test_mount_revision_1_later_than_33000"
+            test_mount_revision_1_later_than_65534,
+            "test_mount_revision_1_later_than_65534"
         },
         {
             test_mount_is_valid_chunk_flash_read_fail,
@@ -0,0 +1,433 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+#define CHUNK_SIZE                                           256
+#define EEPROM_SIZE                     (CHUNK_SIZE - 8 - 64)
+#define JOURNAL_ADDRESS                  (CHUNK_SIZE - 64)
+
+static uint8_t flash_buf[0x1000];
+static size_t number_of_bytes_written;
+
+static const struct eeprom_soft_block_t blocks[2] = {
+    { .address = 0x0000, .size = 0x800 },
+    { .address = 0x0800, .size = 0x800 }
+};
+
+static struct flash_driver_t flash;
+static struct eeprom_soft_driver_t eeprom_soft;
+
+static int init_format_mount(void)
+{
+    BTASSERT(eeprom_soft_init(&eeprom_soft,
+                              &flash,
+                              &blocks[0],
+                              membersof(blocks),
+                              CHUNK_SIZE) == 0);
+    BTASSERT(eeprom_soft_format(&eeprom_soft) == 0);
+    BTASSERT(eeprom_soft_mount(&eeprom_soft) == 0);
+
+    return (0);
+}
+
+static int test_format_mount(void)
+{
+    BTASSERT(eeprom_soft_module_init() == 0);
+    BTASSERT(flash_init(&flash, &flash_device[0]) == 0);
+    BTASSERT(init_format_mount() == 0);
+    BTASSERTI(eeprom_soft.eeprom_size, ==, EEPROM_SIZE);
+    BTASSERTI(eeprom_soft.current.journal_offset, ==, 0);
+
+    return (0);
+}
+
+static int test_write_to_journal(void)
+{
+    uint8_t byte;
+    uint32_t value;
+
+    BTASSERT(init_format_mount() == 0);
+
+    /* One byte record. */
+    byte = 0x12;
+    BTASSERT(eeprom_soft_write(&eeprom_soft,
+                               0,
+                               &byte,
+                               sizeof(byte)) == sizeof(byte));
+    BTASSERTI(eeprom_soft.statistics.chunk_writes, ==, 1);
+    BTASSERTI(eeprom_soft.statistics.journal_writes, ==, 1);
+    BTASSERTI(eeprom_soft.current.chunk_address, ==, 0);
+    BTASSERTI(eeprom_soft.current.journal_offset, ==, 16);
+
+    /* Four bytes record. */
+    value = 0x34567890;
+    BTASSERT(eeprom_soft_write(&eeprom_soft,
+                               EEPROM_SIZE - 4,
+                               &value,
+                               sizeof(value)) == sizeof(value));
+    BTASSERTI(eeprom_soft.statistics.journal_writes, ==, 2);
+    BTASSERTI(eeprom_soft.current.journal_offset, ==, 32);
+
+    /* Read back. */
+    byte = 0;
+    BTASSERT(eeprom_soft_read(&eeprom_soft,
+                              &byte,
+                              0,
+                              sizeof(byte)) == sizeof(byte));
+    BTASSERTI(byte, ==, 0x12);
+
+    value = 0;
+    BTASSERT(eeprom_soft_read(&eeprom_soft,
+                              &value,
+                              EEPROM_SIZE - 4,
+                              sizeof(value)) == sizeof(value));
+    BTASSERTI(value, ==, 0x34567890);
+
+    /* Both records are found when mounting again. */
+    BTASSERT(eeprom_soft_mount(&eeprom_soft) == 0);
+    BTASSERTI(eeprom_soft.current.journal_offset, ==, 32);
+
+    value = 0;
+    BTASSERT(eeprom_soft_read(&eeprom_soft,
+                              &value,
+                              EEPROM_SIZE - 4,
+                              sizeof(value)) == sizeof(value));
+    BTASSERTI(value, ==, 0x34567890);
+
+    return (0);
+}
+
+static int test_overlapping_records(void)
+{
+    uint8_t buf[6];
+
+    BTASSERT(init_format_mount() == 0);
+
+    /* Later records take precedence. */
+    BTASSERT(eeprom_soft_write(&eeprom_soft, 10, "abcd", 4) == 4);
+    BTASSERT(eeprom_soft_write(&eeprom_soft, 12, "XY", 2) == 2);
+    BTASSERT(eeprom_soft_write(&eeprom_soft, 9, "1", 1) == 1);
+
+    BTASSERT(eeprom_soft_read(&eeprom_soft,
+                              &buf[0],
+                              9,
+                              sizeof(buf)) == sizeof(buf));
+    BTASSERTM(&buf[0], "1abXY\xff", sizeof(buf));
+
+    /* Identical data is not written. */
+    BTASSERT(eeprom_soft_write(&eeprom_soft, 10, "abXY", 4) == 4);
+    BTASSERTI(eeprom_soft.statistics.journal_writes, ==, 3);
+
+    return (0);
+}
+
+static int test_vwrite_single_record(void)
+{
+    struct iov_uintptr_t dst[2];
+    struct iov_t src[2];
+    uint8_t buf[12];
+
+    BTASSERT(init_format_mount() == 0);
+
+    dst[0].address = 20;
+    dst[0].size = 2;
+    src[0].buf_p = "ab";
+    dst[1].address = 30;
+    dst[1].size = 2;
+    src[1].buf_p = "cd";
+
+    /* A single record spanning both regions. */
+    BTASSERT(eeprom_soft_vwrite(&eeprom_soft,
+                                &dst[0],
+                                &src[0],
+                                membersof(dst)) == 4);
+    BTASSERTI(eeprom_soft.statistics.journal_writes, ==, 1);
+    BTASSERTI(eeprom_soft.current.journal_offset, ==, 8 + 16);
+
+    BTASSERT(eeprom_soft_read(&eeprom_soft,
+                              &buf[0],
+                              20,
+                              sizeof(buf)) == sizeof(buf));
+    BTASSERTM(&buf[0], "ab\xff\xff\xff\xff\xff\xff\xff\xff" "cd", sizeof(buf));
+
+    return (0);
+}
+
+static int test_compaction(void)
+{
+    uint8_t byte;
+    int i;
+
+    BTASSERT(init_format_mount() == 0);
+
+    /* Four one byte records fill the 64 bytes journal. */
+    for (i = 0; i < 4; i++) {
+        byte = i;
+        BTASSERT(eeprom_soft_write(&eeprom_soft,
+                                   i,
+                                   &byte,
+                                   sizeof(byte)) == sizeof(byte));
+    }
+
+    BTASSERTI(eeprom_soft.statistics.chunk_writes, ==, 1);
+    BTASSERTI(eeprom_soft.current.journal_offset, ==, 64);
+
+    /* The fifth write copies the chunk, including the journal, to a
+       new chunk. */
+    byte = 4;
+    BTASSERT(eeprom_soft_write(&eeprom_soft,
+                               4,
+                               &byte,
+                               sizeof(byte)) == sizeof(byte));
+    BTASSERTI(eeprom_soft.statistics.chunk_writes, ==, 2);
+    BTASSERTI(eeprom_soft.statistics.journal_writes, ==, 4);
+    BTASSERTI(eeprom_soft.current.chunk_address, ==, CHUNK_SIZE);
+    BTASSERTI(eeprom_soft.current.journal_offset, ==, 0);
+
+    BTASSERT(eeprom_soft_mount(&eeprom_soft) == 0);
+    BTASSERTI(eeprom_soft.current.chunk_address, ==, CHUNK_SIZE);
+
+    for (i = 0; i < 5; i++) {
+        BTASSERT(eeprom_soft_read(&eeprom_soft,
+                                  &byte,
+                                  i,
+                                  sizeof(byte)) == sizeof(byte));
+        BTASSERTI(byte, ==, i);
+    }
+
+    return (0);
+}
+
+static int test_mount_corrupt_record(void)
+{
+    uint8_t byte;
+
+    BTASSERT(init_format_mount() == 0);
+
+    byte = 1;
+    BTASSERT(eeprom_soft_write(&eeprom_soft,
+                               0,
+                               &byte,
+                               sizeof(byte)) == sizeof(byte));
+    byte = 2;
+    BTASSERT(eeprom_soft_write(&eeprom_soft,
+                               0,
+                               &byte,
+                               sizeof(byte)) == sizeof(byte));
+
+    /* Corrupt the data of the second record, as if power was lost
+       while writing it. */
+    flash_buf[JOURNAL_ADDRESS + 16 + 8] = 0;
+
+    BTASSERT(eeprom_soft_mount(&eeprom_soft) == 0);
+    BTASSERTI(eeprom_soft.current.journal_offset, ==, 16);
+
+    BTASSERT(eeprom_soft_read(&eeprom_soft,
+                              &byte,
+                              0,
+                              sizeof(byte)) == sizeof(byte));
+    BTASSERTI(byte, ==, 1);
+
+    /* Next write goes to a new chunk. */
+    byte = 3;
+    BTASSERT(eeprom_soft_write(&eeprom_soft,
+                               0,
+                               &byte,
+                               sizeof(byte)) == sizeof(byte));
+    BTASSERTI(eeprom_soft.current.chunk_address, ==, CHUNK_SIZE);
+
+    BTASSERT(eeprom_soft_mount(&eeprom_soft) == 0);
+    BTASSERT(eeprom_soft_read(&eeprom_soft,
+                              &byte,
+                              0,
+                              sizeof(byte)) == sizeof(byte));
+    BTASSERTI(byte, ==, 3);
+
+    return (0);
+}
+
+static int test_write_after_partial_record(void)
+{
+    uint8_t byte;
+
+    BTASSERT(init_format_mount() == 0);
+
+    /* Record data written, but not its header. */
+    flash_buf[JOURNAL_ADDRESS + 8] = 0x55;
+
+    BTASSERT(eeprom_soft_mount(&eeprom_soft) == 0);
+    BTASSERTI(eeprom_soft.current.journal_offset, ==, 0);
+
+    byte = 1;
+    BTASSERT(eeprom_soft_write(&eeprom_soft,
+                               0,
+                               &byte,
+                               sizeof(byte)) == sizeof(byte));
+    BTASSERTI(eeprom_soft.current.chunk_address, ==, CHUNK_SIZE);
+    BTASSERTI(eeprom_soft.statistics.journal_writes, ==, 0);
+
+    return (0);
+}
+
+static int test_benchmark(void)
+{
+    uint32_t counter;
+    int i;
+    int start;
+    int elapsed;
+
+    BTASSERT(init_format_mount() == 0);
+
+    number_of_bytes_written = 0;
+    start = time_micros();
+
+    for (counter = 1; counter <= 1000; counter++) {
+        BTASSERT(eeprom_soft_write(&eeprom_soft,
+                                   0,
+                                   &counter,
+                                   sizeof(counter)) == sizeof(counter));
+    }
+
+    elapsed = time_micros_elapsed(start, time_micros());
+
+    std_printf(OSTR("1000 counter writes in %d us: %lu chunk writes, "
+                    "%lu journal writes, %lu block erases and %lu bytes "
+                    "written to flash.\r\n"),
+               elapsed,
+               (unsigned long)eeprom_soft.statistics.chunk_writes,
+               (unsigned long)eeprom_soft.statistics.journal_writes,
+               (unsigned long)eeprom_soft.statistics.block_erases,
+               (unsigned long)number_of_bytes_written);
+
+    /* Four records per chunk. */
+    BTASSERTI(eeprom_soft.statistics.journal_writes, ==, 800);
+    BTASSERTI(eeprom_soft.statistics.chunk_writes, ==, 201);
+
+    for (i = 0; i < 2; i++) {
+        BTASSERT(eeprom_soft_mount(&eeprom_soft) == 0);
+        counter = 0;
+        BTASSERT(eeprom_soft_read(&eeprom_soft,
+                                  &counter,
+                                  0,
+                                  sizeof(counter)) == sizeof(counter));
+        BTASSERTI(counter, ==, 1000);
+    }
+
+    return (0);
+}
+
+int __wrap_flash_module_init(void)
+{
+    return (0);
+}
+
+int __wrap_flash_init(struct flash_driver_t *self_p,
+                      struct flash_device_t *dev_p)
+{
+    BTASSERT(self_p != NULL);
+    BTASSERT(dev_p != NULL);
+
+    memset(&flash_buf[0], 0, sizeof(flash_buf));
+
+    return (0);
+}
+
+ssize_t __wrap_flash_read(struct flash_driver_t *self_p,
+                          void *dst_p,
+                          uintptr_t src,
+                          size_t size)
+{
+    BTASSERT(self_p != NULL);
+    BTASSERT(src + size <= sizeof(flash_buf));
+
+    memcpy(dst_p, &flash_buf[src], size);
+
+    return (size);
+}
+
+ssize_t __wrap_flash_write(struct flash_driver_t *self_p,
+                           uintptr_t dst,
+                           const void *src_p,
+                           size_t size)
+{
+    BTASSERT(self_p != NULL);
+    BTASSERT(dst + size <= sizeof(flash_buf));
+    BTASSERT((dst % 8) == 0);
+
+    const uint8_t *u8_src_p;
+    size_t i;
+
+    /* Flash can only clear bits. */
+    u8_src_p = src_p;
+
+    for (i = 0; i < size; i++) {
+        flash_buf[dst + i] &= u8_src_p[i];
+    }
+
+    number_of_bytes_written += size;
+
+    return (size);
+}
+
+int __wrap_flash_erase(struct flash_driver_t *self_p,
+                       uintptr_t addr,
+                       size_t size)
+{
+    BTASSERT(self_p != NULL);
+    BTASSERT(addr + size <= sizeof(flash_buf));
+
+    memset(&flash_buf[addr], 0xff, size);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_format_mount, "test_format_mount" },
+        { test_write_to_journal, "test_write_to_journal" },
+        { test_overlapping_records, "test_overlapping_records" },
+        { test_vwrite_single_record, "test_vwrite_single_record" },
+        { test_compaction, "test_compaction" },
+        { test_mount_corrupt_record, "test_mount_corrupt_record" },
+        {
+            test_write_after_partial_record,
+            "test_write_after_partial_record"
+        },
+        { test_benchmark, "test_benchmark" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,663 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#define TYPE_UART_DEVICE_REQUEST                          (1)
+#define TYPE_CAN_DEVICE_REQUEST                           (7)
+#define TYPE_VERSION_REQUEST                             (13)
+#define TYPE_VERSION_RESPONSE                            (14)
+
+#define UART_TEXT_SIZE                                16384
+#define UART_BINARY_SIZE                            4194304
+#define CAN_TEXT_FRAMES                                 256
+#define CAN_BINARY_FRAMES                             20000
+
+/**
+ * A simulated hardware device, implemented with a raw pthread as the
+ * socket_device.py tool would do in a separate process.
+ */
+struct host_t {
+    int type;
+    const char *name_p;
+    int version;
+    size_t tx_size;
+    size_t rx_size;
+    int socket;
+    int res;
+    pthread_t thrd;
+};
+
+struct can_wire_frame_t {
+    uint32_t id;
+    uint8_t flags;
+    uint8_t size;
+    uint16_t reserved;
+    uint8_t data[8];
+};
+
+static struct uart_driver_t uart;
+static uint8_t uart_rxbuf[32768];
+static struct can_driver_t can;
+static struct can_frame_t can_rxbuf[256];
+
+static uint8_t pattern(size_t offset)
+{
+    return (offset % 251);
+}
+
+static void make_frame(struct can_frame_t *frame_p, uint32_t id)
+{
+    int i;
+
+    memset(frame_p, 0, sizeof(*frame_p));
+    frame_p->id = id;
+    frame_p->extended_frame = 1;
+    frame_p->size = 8;
+
+    for (i = 0; i < 8; i++) {
+        frame_p->data.u8[i] = (id + i);
+    }
+}
+
+static int frame_is_valid(const struct can_frame_t *frame_p, uint32_t id)
+{
+    struct can_frame_t expected;
+
+    make_frame(&expected, id);
+
+    return ((frame_p->id == expected.id)
+            && (frame_p->extended_frame == 1)
+            && (frame_p->size == 8)
+            && (memcmp(&frame_p->data.u8[0],
+                       &expected.data.u8[0],
+                       8) == 0));
+}
+
+static int write_all(int socket, const void *buf_p, size_t size)
+{
+    ssize_t res;
+    const uint8_t *b_p;
+
+    b_p = buf_p;
+
+    while (size > 0) {
+        res = write(socket, b_p, size);
+
+        if (res <= 0) {
+            return (-1);
+        }
+
+        b_p += res;
+        size -= res;
+    }
+
+    return (0);
+}
+
+static int read_all(int socket, void *buf_p, size_t size)
+{
+    ssize_t res;
+    uint8_t *b_p;
+
+    b_p = buf_p;
+
+    while (size > 0) {
+        res = read(socket, b_p, size);
+
+        if (res <= 0) {
+            return (-1);
+        }
+
+        b_p += res;
+        size -= res;
+    }
+
+    return (0);
+}
+
+static int write_batch(int socket, const void *buf_p, size_t size)
+{
+    uint32_t header;
+
+    header = htonl(size);
+
+    if (write_all(socket, &header, sizeof(header)) != 0) {
+        return (-1);
+    }
+
+    return (write_all(socket, buf_p, size));
+}
+
+static ssize_t read_batch(int socket, void *buf_p, size_t size)
+{
+    uint32_t header;
+
+    if (read_all(socket, &header, sizeof(header)) != 0) {
+        return (-1);
+    }
+
+    header = ntohl(header);
+
+    if (header > size) {
+        return (-1);
+    }
+
+    if (read_all(socket, buf_p, header) != 0) {
+        return (-1);
+    }
+
+    return (header);
+}
+
+/**
+ * Connect to the application, negotiate the protocol version and
+ * request the device. Retries until the listener is up and any
+ * previous client of the device has been disconnected.
+ */
+static int host_connect(struct host_t *self_p)
+{
+    struct sockaddr_in addr;
+    uint32_t buf[3];
+    size_t size;
+    int attempt;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(47000);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    for (attempt = 0; attempt < 200; attempt++) {
+        self_p->socket = socket(AF_INET, SOCK_STREAM, 0);
+
+        if (self_p->socket < 0) {
+            return (-1);
+        }
+
+        if (connect(self_p->socket,
+                    (struct sockaddr *)&addr,
+                    sizeof(addr)) != 0) {
+            goto retry;
+        }
+
+        if (self_p->version > 1) {
+            buf[0] = htonl(TYPE_VERSION_REQUEST);
+            buf[1] = htonl(4);
+            buf[2] = htonl(self_p->version);
+
+            if ((write_all(self_p->socket, &buf[0], 12) != 0)
+                || (read_all(self_p->socket, &buf[0], 12) != 0)
+                || (ntohl(buf[0]) != TYPE_VERSION_RESPONSE)
+                || (ntohl(buf[2]) != self_p->version)) {
+                close(self_p->socket);
+
+                return (-1);
+            }
+        }
+
+        size = strlen(self_p->name_p);
+        buf[0] = htonl(self_p->type);
+        buf[1] = htonl(size);
+
+        if ((write_all(self_p->socket, &buf[0], 8) != 0)
+            || (write_all(self_p->socket, self_p->name_p, size) != 0)
+            || (read_all(self_p->socket, &buf[0], 12) != 0)) {
+            goto retry;
+        }
+
+        if (buf[2] == 0) {
+            return (0);
+        }
+
+    retry:
+        close(self_p->socket);
+        usleep(10000);
+    }
+
+    return (-1);
+}
+
+static void *uart_host_main(void *arg_p)
+{
+    struct host_t *self_p;
+    uint8_t buf[4096];
+    size_t offset;
+    ssize_t size;
+    size_t i;
+
+    self_p = arg_p;
+    self_p->res = -1;
+
+    if (host_connect(self_p) != 0) {
+        return (NULL);
+    }
+
+    /* Simulated hardware to application. */
+    for (offset = 0; offset < self_p->tx_size; offset += size) {
+        size = MIN(self_p->tx_size - offset, sizeof(buf));
+
+        for (i = 0; i < size; i++) {
+            buf[i] = pattern(offset + i);
+        }
+
+        if (self_p->version > 1) {
+            if (write_batch(self_p->socket, &buf[0], size) != 0) {
+                goto out;
+            }
+        } else {
+            if (write_all(self_p->socket, &buf[0], size) != 0) {
+                goto out;
+            }
+        }
+    }
+
+    /* Application to simulated hardware. */
+    for (offset = 0; offset < self_p->rx_size; offset += size) {
+        if (self_p->version > 1) {
+            size = read_batch(self_p->socket, &buf[0], sizeof(buf));
+        } else {
+            size = read(self_p->socket, &buf[0], sizeof(buf));
+        }
+
+        if (size <= 0) {
+            goto out;
+        }
+
+        for (i = 0; i < size; i++) {
+            if (buf[i] != pattern(offset + i)) {
+                goto out;
+            }
+        }
+    }
+
+    self_p->res = 0;
+
+ out:
+    close(self_p->socket);
+
+    return (NULL);
+}
+
+static int can_host_write_text(struct host_t *self_p)
+{
+    char buf[64 * 53 + 1];
+    struct can_frame_t frame;
+    size_t length;
+    uint32_t id;
+    int i;
+
+    length = 0;
+
+    for (id = 0; id < self_p->tx_size; id++) {
+        make_frame(&frame, id);
+        length += sprintf(&buf[length],
+                          "id=%08x,extended=1,size=8,data=",
+                          frame.id);
+
+        for (i = 0; i < 8; i++) {
+            length += sprintf(&buf[length], "%02x", frame.data.u8[i]);
+        }
+
+        length += sprintf(&buf[length], "\r\n");
+
+        if ((length == sizeof(buf) - 1) || (id == self_p->tx_size - 1)) {
+            if (write_all(self_p->socket, &buf[0], length) != 0) {
+                return (-1);
+            }
+
+            length = 0;
+        }
+    }
+
+    return (0);
+}
+
+static int can_host_write_binary(struct host_t *self_p)
+{
+    struct can_wire_frame_t frames[256];
+    struct can_frame_t frame;
+    uint32_t id;
+    size_t n;
+
+    n = 0;
+
+    for (id = 0; id < self_p->tx_size; id++) {
+        make_frame(&frame, id);
+        memset(&frames[n], 0, sizeof(frames[n]));
+        frames[n].id = htonl(frame.id);
+        frames[n].flags = 1;
+        frames[n].size = frame.size;
+        memcpy(&frames[n].data[0], &frame.data.u8[0], 8);
+        n++;
+
+        if ((n == membersof(frames)) || (id == self_p->tx_size - 1)) {
+            if (write_batch(self_p->socket,
+                            &frames[0],
+                            n * sizeof(frames[0])) != 0) {
+                return (-1);
+            }
+
+            n = 0;
+        }
+    }
+
+    return (0);
+}
+
+static int can_host_read_text(struct host_t *self_p)
+{
+    char line[64];
+    struct can_frame_t frame;
+    unsigned int id;
+    unsigned int value;
+    int extended_frame;
+    int size;
+    uint32_t i;
+    int j;
+
+    for (i = 0; i < self_p->rx_size; i++) {
+        if (read_all(self_p->socket, &line[0], 53) != 0) {
+            return (-1);
+        }
+
+        line[53] = '\0';
+
+        if (sscanf(&line[0],
+                   "id=%08x,extended=%d,size=%d,data=",
+                   &id,
+                   &extended_frame,
+                   &size) != 3) {
+            return (-1);
+        }
+
+        memset(&frame, 0, sizeof(frame));
+        frame.id = id;
+        frame.extended_frame = extended_frame;
+        frame.size = size;
+
+        for (j = 0; j < 8; j++) {
+            sscanf(&line[35 + 2 * j], "%2x", &value);
+            frame.data.u8[j] = value;
+        }
+
+        if (!frame_is_valid(&frame, i)) {
+            return (-1);
+        }
+    }
+
+    return (0);
+}
+
+static int can_host_read_binary(struct host_t *self_p)
+{
+    struct can_wire_frame_t frames[256];
+    struct can_frame_t frame;
+    ssize_t size;
+    uint32_t id;
+    int i;
+
+    id = 0;
+
+    while (id < self_p->rx_size) {
+        size = read_batch(self_p->socket, &frames[0], sizeof(frames));
+
+        if ((size <= 0) || ((size % sizeof(frames[0])) != 0)) {
+            return (-1);
+        }
+
+        for (i = 0; i < size / sizeof(frames[0]); i++, id++) {
+            memset(&frame, 0, sizeof(frame));
+            frame.id = ntohl(frames[i].id);
+            frame.extended_frame = (frames[i].flags & 1);
+            frame.size = frames[i].size;
+            memcpy(&frame.data.u8[0], &frames[i].data[0], 8);
+
+            if (!frame_is_valid(&frame, id)) {
+                return (-1);
+            }
+        }
+    }
+
+    return (0);
+}
+
+static void *can_host_main(void *arg_p)
+{
+    struct host_t *self_p;
+
+    self_p = arg_p;
+    self_p->res = -1;
+
+    if (host_connect(self_p) != 0) {
+        return (NULL);
+    }
+
+    if (self_p->version > 1) {
+        if ((can_host_write_binary(self_p) == 0)
+            && (can_host_read_binary(self_p) == 0)) {
+            self_p->res = 0;
+        }
+    } else {
+        if ((can_host_write_text(self_p) == 0)
+            && (can_host_read_text(self_p) == 0)) {
+            self_p->res = 0;
+        }
+    }
+
+    close(self_p->socket);
+
+    return (NULL);
+}
+
+static void print_throughput(const char *name_p,
+                             int version,
+                             size_t size,
+                             const char *unit_p,
+                             struct time_t *start_p)
+{
+    struct time_t stop;
+    struct time_t elapsed;
+    unsigned long micros;
+
+    time_get(&stop);
+    time_subtract(&elapsed, &stop, start_p);
+    micros = (elapsed.seconds * 1000000ul + elapsed.nanoseconds / 1000ul);
+
+    if (micros == 0) {
+        micros = 1;
+    }
+
+    std_printf(FSTR("%s protocol version %d: %lu %s in %lu us "
+                    "(%lu %s/s).\r\n"),
+               name_p,
+               version,
+               (unsigned long)size,
+               unit_p,
+               micros,
+               (unsigned long)((unsigned long long)size * 1000000ull
+                               / micros),
+               unit_p);
+}
+
+static int uart_transfer(int version, size_t size)
+{
+    struct host_t host;
+    struct time_t start;
+    uint8_t buf[1024];
+    size_t offset;
+    size_t n;
+    size_t i;
+
+    host.type = TYPE_UART_DEVICE_REQUEST;
+    host.name_p = "1";
+    host.version = version;
+    host.tx_size = size;
+    host.rx_size = size;
+
+    time_get(&start);
+    BTASSERT(pthread_create(&host.thrd, NULL, uart_host_main, &host) == 0);
+
+    /* Input, verified in the application. */
+    for (offset = 0; offset < size; offset += n) {
+        n = MIN(size - offset, sizeof(buf));
+        BTASSERTI(uart_read(&uart, &buf[0], n), ==, n);
+
+        for (i = 0; i < n; i++) {
+            BTASSERTI(buf[i], ==, pattern(offset + i));
+        }
+    }
+
+    /* Output, verified in the simulated hardware. */
+    for (offset = 0; offset < size; offset += n) {
+        n = MIN(size - offset, sizeof(buf));
+
+        for (i = 0; i < n; i++) {
+            buf[i] = pattern(offset + i);
+        }
+
+        BTASSERTI(uart_write(&uart, &buf[0], n), ==, n);
+    }
+
+    BTASSERT(pthread_join(host.thrd, NULL) == 0);
+    BTASSERTI(host.res, ==, 0);
+    print_throughput("uart", version, 2 * size, "bytes", &start);
+
+    return (0);
+}
+
+static int can_transfer(int version, size_t length)
+{
+    struct host_t host;
+    struct time_t start;
+    struct can_frame_t frames[32];
+    uint32_t id;
+    ssize_t n;
+    ssize_t i;
+
+    host.type = TYPE_CAN_DEVICE_REQUEST;
+    host.name_p = "0";
+    host.version = version;
+    host.tx_size = length;
+    host.rx_size = length;
+
+    time_get(&start);
+    BTASSERT(pthread_create(&host.thrd, NULL, can_host_main, &host) == 0);
+
+    /* Input, verified in the application. */
+    for (id = 0; id < length; id += n) {
+        n = can_read_frames(&can,
+                            &frames[0],
+                            MIN(length - id, membersof(frames)));
+        BTASSERT(n > 0);
+
+        for (i = 0; i < n; i++) {
+            BTASSERT(frame_is_valid(&frames[i], id + i));
+        }
+    }
+
+    /* Output, verified in the simulated hardware. */
+    for (id = 0; id < length; id += n) {
+        n = MIN(length - id, membersof(frames));
+
+        for (i = 0; i < n; i++) {
+            make_frame(&frames[i], id + i);
+        }
+
+        BTASSERTI(can_write_frames(&can, &frames[0], n), ==, n);
+    }
+
+    BTASSERT(pthread_join(host.thrd, NULL) == 0);
+    BTASSERTI(host.res, ==, 0);
+    print_throughput("can", version, 2 * length, "frames", &start);
+
+    return (0);
+}
+
+static int test_init(void)
+{
+    BTASSERT(uart_module_init() == 0);
+    BTASSERT(uart_init(&uart,
+                       &uart_device[1],
+                       115200,
+                       &uart_rxbuf[0],
+                       sizeof(uart_rxbuf)) == 0);
+    BTASSERT(uart_start(&uart) == 0);
+
+    BTASSERT(can_module_init() == 0);
+    BTASSERT(can_init(&can,
+                      &can_device[0],
+                      CAN_SPEED_500KBPS,
+                      &can_rxbuf[0],
+                      sizeof(can_rxbuf)) == 0);
+    BTASSERT(can_start(&can) == 0);
+
+    return (0);
+}
+
+static int test_uart_text(void)
+{
+    return (uart_transfer(1, UART_TEXT_SIZE));
+}
+
+static int test_uart_binary(void)
+{
+    return (uart_transfer(2, UART_BINARY_SIZE));
+}
+
+static int test_can_text(void)
+{
+    return (can_transfer(1, CAN_TEXT_FRAMES));
+}
+
+static int test_can_binary(void)
+{
+    return (can_transfer(2, CAN_BINARY_FRAMES));
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_uart_text, "test_uart_text" },
+        { test_uart_binary, "test_uart_binary" },
+        { test_can_text, "test_can_text" },
+        { test_can_binary, "test_can_binary" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
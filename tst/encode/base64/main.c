@@ -143,11 +143,269 @@ static int test_decode(void)
     return (0);
 }
 
+/* Output channel collecting written data in a buffer. */
+static struct {
+    struct chan_t base;
+    char buf[1024];
+    size_t size;
+} output;
+
+static ssize_t output_write(void *self_p, const void *buf_p, size_t size)
+{
+    if (output.size + size > sizeof(output.buf)) {
+        return (-ENOMEM);
+    }
+
+    memcpy(&output.buf[output.size], buf_p, size);
+    output.size += size;
+
+    return (size);
+}
+
+static void output_init(void)
+{
+    chan_init(&output.base, chan_read_null, output_write, chan_size_null);
+    output.size = 0;
+}
+
+static int test_implementations(void)
+{
+    static uint8_t data[300];
+    static char expected[400];
+    static char encoded[400];
+    static uint8_t decoded[300];
+    int default_implementation;
+    size_t size;
+    size_t encoded_size;
+    size_t i;
+
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = (i * 7 + (i >> 3));
+    }
+
+    default_implementation = base64_get_implementation();
+    std_printf(FSTR("Default implementation: %d\r\n"),
+               default_implementation);
+
+    BTASSERT(base64_set_implementation(-1) == -ENOSYS);
+
+    if (base64_set_implementation(BASE64_IMPLEMENTATION_SIMD) != 0) {
+        std_printf(FSTR("No SIMD implementation available.\r\n"));
+
+        return (0);
+    }
+
+    /* Compare all sizes, exercising the vector loops and the scalar
+       tails. */
+    for (size = 0; size <= sizeof(data); size++) {
+        encoded_size = (4 * DIV_CEIL(size, 3));
+
+        BTASSERT(base64_set_implementation(BASE64_IMPLEMENTATION_TABLE) == 0);
+        BTASSERT(base64_encode(&expected[0], &data[0], size) == 0);
+
+        BTASSERT(base64_set_implementation(BASE64_IMPLEMENTATION_SIMD) == 0);
+        BTASSERT(base64_encode(&encoded[0], &data[0], size) == 0);
+        BTASSERTM(&encoded[0], &expected[0], encoded_size);
+
+        BTASSERT(base64_decode(&decoded[0], &encoded[0], encoded_size) == 0);
+        BTASSERTM(&decoded[0], &data[0], size);
+    }
+
+    /* Invalid characters in the vectorized part. */
+    BTASSERT(base64_encode(&encoded[0], &data[0], 240) == 0);
+    encoded[50] = '*';
+    BTASSERT(base64_decode(&decoded[0], &encoded[0], 320) == -1);
+    encoded[50] = '\x80';
+    BTASSERT(base64_decode(&decoded[0], &encoded[0], 320) == -1);
+
+    BTASSERT(base64_set_implementation(default_implementation) == 0);
+
+    return (0);
+}
+
+static int test_encoder(void)
+{
+    struct base64_encoder_t encoder;
+    static uint8_t data[300];
+    char expected[400];
+    size_t i;
+    size_t offset;
+    size_t size;
+
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = (i * 13);
+    }
+
+    BTASSERT(base64_encode(&expected[0], &data[0], sizeof(data)) == 0);
+
+    /* Write chunks of different sizes. */
+    for (size = 1; size < 200; size += 11) {
+        output_init();
+        BTASSERT(base64_encoder_init(&encoder, &output) == 0);
+
+        for (offset = 0; offset < sizeof(data); offset += size) {
+            i = MIN(size, sizeof(data) - offset);
+            BTASSERT(chan_write(&encoder, &data[offset], i) == i);
+        }
+
+        BTASSERT(base64_encoder_flush(&encoder) == 0);
+        BTASSERT(output.size == 400);
+        BTASSERTM(&output.buf[0], &expected[0], 400);
+    }
+
+    /* Padding. */
+    output_init();
+    BTASSERT(base64_encoder_init(&encoder, &output) == 0);
+    BTASSERT(chan_write(&encoder, "fooba", 5) == 5);
+    BTASSERT(base64_encoder_flush(&encoder) == 0);
+    BTASSERT(chan_write(&encoder, "f", 1) == 1);
+    BTASSERT(base64_encoder_flush(&encoder) == 0);
+    BTASSERT(base64_encoder_flush(&encoder) == 0);
+    BTASSERT(output.size == 12);
+    BTASSERTM(&output.buf[0], "Zm9vYmE=Zg==", 12);
+
+    return (0);
+}
+
+static int test_decoder(void)
+{
+    struct base64_decoder_t decoder;
+    size_t i;
+    size_t offset;
+    size_t size;
+    size_t length;
+
+    length = strlen(encoded_text);
+
+    /* Write chunks of different sizes. */
+    for (size = 1; size < 200; size += 7) {
+        output_init();
+        BTASSERT(base64_decoder_init(&decoder, &output) == 0);
+
+        for (offset = 0; offset < length; offset += size) {
+            i = MIN(size, length - offset);
+            BTASSERT(chan_write(&decoder, &encoded_text[offset], i) == i);
+        }
+
+        BTASSERT(base64_decoder_flush(&decoder) == 0);
+        BTASSERT(output.size == strlen(decoded_text));
+        BTASSERTM(&output.buf[0], &decoded_text[0], output.size);
+    }
+
+    /* Padding. */
+    for (i = 1; i < membersof(encoded); i++) {
+        output_init();
+        BTASSERT(base64_decoder_init(&decoder, &output) == 0);
+        BTASSERT(chan_write(&decoder, encoded[i], strlen(encoded[i]))
+                 == strlen(encoded[i]));
+        BTASSERT(base64_decoder_flush(&decoder) == 0);
+        BTASSERT(output.size == strlen(decoded[i]));
+        BTASSERTM(&output.buf[0], decoded[i], output.size);
+    }
+
+    /* Data after padding. */
+    BTASSERT(base64_decoder_init(&decoder, &output) == 0);
+    BTASSERT(chan_write(&decoder, "Zg==Zg==", 8) == -EINVAL);
+    BTASSERT(base64_decoder_flush(&decoder) == 0);
+    BTASSERT(chan_write(&decoder, "Zg==", 4) == 4);
+    BTASSERT(chan_write(&decoder, "Z", 1) == -EINVAL);
+    BTASSERT(base64_decoder_flush(&decoder) == 0);
+
+    /* Misplaced padding. */
+    BTASSERT(chan_write(&decoder, "Z===", 4) == -EINVAL);
+    BTASSERT(base64_decoder_flush(&decoder) == 0);
+    BTASSERT(chan_write(&decoder, "Zg=g", 4) == -EINVAL);
+    BTASSERT(base64_decoder_flush(&decoder) == 0);
+
+    /* Invalid character and truncated data. */
+    BTASSERT(chan_write(&decoder, "Zm9*", 4) == -EINVAL);
+    BTASSERT(base64_decoder_flush(&decoder) == 0);
+    BTASSERT(chan_write(&decoder, "Zm9vY", 5) == 5);
+    BTASSERT(base64_decoder_flush(&decoder) == -EINVAL);
+
+    return (0);
+}
+
+static int test_benchmark(void)
+{
+    static uint8_t data[3 * 4096];
+    static char encoded[4 * 4096];
+    int implementation;
+    int default_implementation;
+    int rounds;
+    int decode;
+    struct time_t start;
+    struct time_t stop;
+    struct time_t elapsed;
+    unsigned long micros;
+
+    memset(&data[0], 0xa5, sizeof(data));
+    default_implementation = base64_get_implementation();
+
+    for (implementation = BASE64_IMPLEMENTATION_TABLE;
+         implementation <= BASE64_IMPLEMENTATION_SIMD;
+         implementation++) {
+        if (base64_set_implementation(implementation) != 0) {
+            continue;
+        }
+
+        for (decode = 0; decode < 2; decode++) {
+            rounds = 0;
+            time_get(&start);
+
+            /* Run for at least 200 ms as the system tick is coarse. */
+            do {
+                if (decode) {
+                    BTASSERT(base64_decode(&data[0],
+                                           &encoded[0],
+                                           sizeof(encoded)) == 0);
+                } else {
+                    BTASSERT(base64_encode(&encoded[0],
+                                           &data[0],
+                                           sizeof(data)) == 0);
+                }
+
+                rounds++;
+                time_get(&stop);
+                time_subtract(&elapsed, &stop, &start);
+            } while ((elapsed.seconds == 0)
+                     && (elapsed.nanoseconds < 200000000));
+
+            micros = (elapsed.seconds * 1000000ul
+                      + elapsed.nanoseconds / 1000ul);
+
+#if CONFIG_FLOAT == 1
+            std_printf(FSTR("Implementation %d %s: %lu bytes in %lu us "
+                            "(%f MB/s).\r\n"),
+                       implementation,
+                       decode ? "decode" : "encode",
+                       (unsigned long)rounds * sizeof(data),
+                       micros,
+                       (float)rounds * sizeof(data) / micros);
+#else
+            std_printf(FSTR("Implementation %d %s: %lu bytes in %lu us.\r\n"),
+                       implementation,
+                       decode ? "decode" : "encode",
+                       (unsigned long)rounds * sizeof(data),
+                       micros);
+#endif
+        }
+    }
+
+    BTASSERT(base64_set_implementation(default_implementation) == 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_encode, "test_encode" },
         { test_decode, "test_decode" },
+        { test_implementations, "test_implementations" },
+        { test_encoder, "test_encoder" },
+        { test_decoder, "test_decoder" },
+        { test_benchmark, "test_benchmark" },
         { NULL, NULL }
     };
 
@@ -76,6 +76,206 @@ static int test_from_bin(void)
     return (0);
 }
 
+/* Output channel collecting written data in a buffer. */
+static struct {
+    struct chan_t base;
+    char buf[1024];
+    size_t size;
+} output;
+
+static ssize_t output_write(void *self_p, const void *buf_p, size_t size)
+{
+    if (output.size + size > sizeof(output.buf)) {
+        return (-ENOMEM);
+    }
+
+    memcpy(&output.buf[output.size], buf_p, size);
+    output.size += size;
+
+    return (size);
+}
+
+static void output_init(void)
+{
+    chan_init(&output.base, chan_read_null, output_write, chan_size_null);
+    output.size = 0;
+}
+
+static int test_implementations(void)
+{
+    static uint8_t data[200];
+    static char expected[401];
+    static char encoded[401];
+    static uint8_t decoded[200];
+    int default_implementation;
+    size_t size;
+    size_t i;
+
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = (i * 7 + (i >> 3));
+    }
+
+    default_implementation = hex_get_implementation();
+    std_printf(FSTR("Default implementation: %d\r\n"),
+               default_implementation);
+
+    BTASSERT(hex_set_implementation(-1) == -ENOSYS);
+
+    if (hex_set_implementation(HEX_IMPLEMENTATION_SIMD) != 0) {
+        std_printf(FSTR("No SIMD implementation available.\r\n"));
+
+        return (0);
+    }
+
+    for (size = 0; size <= sizeof(data); size++) {
+        BTASSERT(hex_set_implementation(HEX_IMPLEMENTATION_TABLE) == 0);
+        BTASSERT(hex_from_bin(&expected[0], &data[0], size) == 2 * size);
+
+        BTASSERT(hex_set_implementation(HEX_IMPLEMENTATION_SIMD) == 0);
+        BTASSERT(hex_from_bin(&encoded[0], &data[0], size) == 2 * size);
+        BTASSERT(strcmp(&encoded[0], &expected[0]) == 0);
+
+        BTASSERT(hex_to_bin(&decoded[0], &encoded[0], 2 * size) == size);
+        BTASSERTM(&decoded[0], &data[0], size);
+    }
+
+    /* Upper case and invalid characters in the vectorized part. */
+    for (i = 0; i < 64; i++) {
+        encoded[i] = "0123456789ABCDEF"[i % 16];
+    }
+
+    BTASSERT(hex_to_bin(&decoded[0], &encoded[0], 64) == 32);
+    BTASSERTM(&decoded[0],
+              "\x01\x23\x45\x67\x89\xab\xcd\xef\x01\x23\x45\x67\x89\xab\xcd\xef"
+              "\x01\x23\x45\x67\x89\xab\xcd\xef\x01\x23\x45\x67\x89\xab\xcd\xef",
+              32);
+
+    for (i = 0; i < 6; i++) {
+        encoded[40] = "/:`g@G"[i];
+        BTASSERT(hex_to_bin(&decoded[0], &encoded[0], 64) == -EINVAL);
+    }
+
+    BTASSERT(hex_set_implementation(default_implementation) == 0);
+
+    return (0);
+}
+
+static int test_encoder(void)
+{
+    struct hex_encoder_t encoder;
+    static uint8_t data[300];
+    char expected[601];
+
+    memset(&data[0], 0x5a, sizeof(data));
+    BTASSERT(hex_from_bin(&expected[0], &data[0], sizeof(data)) == 600);
+
+    output_init();
+    BTASSERT(hex_encoder_init(&encoder, &output) == 0);
+    BTASSERT(chan_write(&encoder, &data[0], 1) == 1);
+    BTASSERT(chan_write(&encoder, &data[1], sizeof(data) - 1)
+             == sizeof(data) - 1);
+    BTASSERT(output.size == 600);
+    BTASSERTM(&output.buf[0], &expected[0], 600);
+
+    return (0);
+}
+
+static int test_decoder(void)
+{
+    struct hex_decoder_t decoder;
+
+    output_init();
+    BTASSERT(hex_decoder_init(&decoder, &output) == 0);
+    BTASSERT(chan_write(&decoder, "0", 1) == 1);
+    BTASSERT(chan_write(&decoder, "123", 3) == 3);
+    BTASSERT(chan_write(&decoder, "45678", 5) == 5);
+    BTASSERT(chan_write(&decoder, "9abcdef", 7) == 7);
+    BTASSERT(hex_decoder_flush(&decoder) == 0);
+    BTASSERT(output.size == 8);
+    BTASSERTM(&output.buf[0], "\x01\x23\x45\x67\x89\xab\xcd\xef", 8);
+
+    /* Invalid character and odd length. */
+    BTASSERT(chan_write(&decoder, "0g", 2) == -EINVAL);
+    BTASSERT(hex_decoder_flush(&decoder) == 0);
+    BTASSERT(chan_write(&decoder, "012", 3) == 3);
+    BTASSERT(hex_decoder_flush(&decoder) == -EINVAL);
+
+    return (0);
+}
+
+static int test_benchmark(void)
+{
+    static uint8_t data[8192];
+    static char encoded[2 * 8192 + 1];
+    int implementation;
+    int default_implementation;
+    int rounds;
+    int decode;
+    struct time_t start;
+    struct time_t stop;
+    struct time_t elapsed;
+    unsigned long micros;
+
+    memset(&data[0], 0xa5, sizeof(data));
+    BTASSERT(hex_from_bin(&encoded[0], &data[0], sizeof(data))
+             == 2 * sizeof(data));
+    default_implementation = hex_get_implementation();
+
+    for (implementation = HEX_IMPLEMENTATION_TABLE;
+         implementation <= HEX_IMPLEMENTATION_SIMD;
+         implementation++) {
+        if (hex_set_implementation(implementation) != 0) {
+            continue;
+        }
+
+        for (decode = 0; decode < 2; decode++) {
+            rounds = 0;
+            time_get(&start);
+
+            /* Run for at least 200 ms as the system tick is coarse. */
+            do {
+                if (decode) {
+                    BTASSERT(hex_to_bin(&data[0],
+                                        &encoded[0],
+                                        2 * sizeof(data)) == sizeof(data));
+                } else {
+                    BTASSERT(hex_from_bin(&encoded[0],
+                                          &data[0],
+                                          sizeof(data)) == 2 * sizeof(data));
+                }
+
+                rounds++;
+                time_get(&stop);
+                time_subtract(&elapsed, &stop, &start);
+            } while ((elapsed.seconds == 0)
+                     && (elapsed.nanoseconds < 200000000));
+
+            micros = (elapsed.seconds * 1000000ul
+                      + elapsed.nanoseconds / 1000ul);
+
+#if CONFIG_FLOAT == 1
+            std_printf(FSTR("Implementation %d %s: %lu bytes in %lu us "
+                            "(%f MB/s).\r\n"),
+                       implementation,
+                       decode ? "decode" : "encode",
+                       (unsigned long)rounds * sizeof(data),
+                       micros,
+                       (float)rounds * sizeof(data) / micros);
+#else
+            std_printf(FSTR("Implementation %d %s: %lu bytes in %lu us.\r\n"),
+                       implementation,
+                       decode ? "decode" : "encode",
+                       (unsigned long)rounds * sizeof(data),
+                       micros);
+#endif
+        }
+    }
+
+    BTASSERT(hex_set_implementation(default_implementation) == 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -83,6 +283,10 @@ int main()
         { test_to_bin_non_hex_character, "test_to_bin_non_hex_character" },
         { test_to_bin_odd_length, "test_to_bin_odd_length" },
         { test_from_bin, "test_from_bin" },
+        { test_implementations, "test_implementations" },
+        { test_encoder, "test_encoder" },
+        { test_decoder, "test_decoder" },
+        { test_benchmark, "test_benchmark" },
         { NULL, NULL }
     };
 
@@ -775,6 +775,272 @@ static int test_dump(void)
     return (0);
 }
 
+static int test_dumpb(void)
+{
+    struct json_tok_t tokens[16];
+    char js[] = "{\"foo\":[10,{\"fie\":null},\"\"],\"bar\":-1.5e3}";
+    char buf[64];
+    struct json_t json;
+    ssize_t size;
+
+    BTASSERT(json_init(&json, tokens, membersof(tokens)) == 0);
+    BTASSERT(json_parse(&json, js, strlen(js)) == 10);
+    size = json_dump_size(&json, NULL);
+    BTASSERT(size == strlen(js), "%d", size);
+
+    /* Exact fit including termination. */
+    memset(buf, -1, sizeof(buf));
+    BTASSERT(json_dumpb(&json, NULL, buf, size + 1) == size);
+    BTASSERT(strcmp(buf, js) == 0);
+
+    /* Too small buffers. */
+    BTASSERT(json_dumpb(&json, NULL, buf, size) == JSON_ERROR_NOMEM);
+    BTASSERT(json_dumpb(&json, NULL, buf, 1) == JSON_ERROR_NOMEM);
+
+    /* A sub-tree. */
+    BTASSERT(json_dump_size(&json, &tokens[2]) == 20);
+    BTASSERT(json_dumpb(&json, &tokens[2], buf, sizeof(buf)) == 20);
+    BTASSERT(strcmp(buf, "[10,{\"fie\":null},\"\"]") == 0);
+
+    /* Non-printable characters in a string, checked four at a
+       time. */
+    json_token_object(&tokens[0], 1);
+    json_token_string(&tokens[1], "abcdefgh", 8);
+    json_token_string(&tokens[2], "abcdef\ngh", 9);
+    json_init(&json, tokens, 3);
+    BTASSERT(json_dump_size(&json, NULL) == JSON_ERROR_INVAL);
+    json_token_string(&tokens[2], "abcdefg\x7f", 8);
+    BTASSERT(json_dumpb(&json, NULL, buf, sizeof(buf)) == JSON_ERROR_INVAL);
+    json_token_string(&tokens[2], "abcd\xc3\xa5", 6);
+    BTASSERT(json_dump_size(&json, NULL) == JSON_ERROR_INVAL);
+    json_token_string(&tokens[2], "~ !", 3);
+    BTASSERT(json_dump_size(&json, NULL) == 18);
+
+    /* Only objects and arrays at top level. */
+    json_token_true(&tokens[0]);
+    json_init(&json, tokens, 1);
+    BTASSERT(json_dump_size(&json, NULL) == JSON_ERROR_INVAL);
+    BTASSERT(json_dumpb(&json, NULL, buf, sizeof(buf)) == JSON_ERROR_INVAL);
+
+    return (0);
+}
+
+static int test_dumpv(void)
+{
+    struct json_tok_t tokens[16];
+    char js[] = "{\"foo\":[10,true],\"bar\":\"fie\"}";
+    char buf[64];
+    struct iov_t iov[32];
+    struct json_t json;
+    size_t size;
+    int length;
+    int i;
+
+    BTASSERT(json_init(&json, tokens, membersof(tokens)) == 0);
+    BTASSERT(json_parse(&json, js, strlen(js)) == 7);
+
+    length = json_dumpv(&json, NULL, iov, membersof(iov));
+    BTASSERT(length == 19, "%d", length);
+
+    /* The vector refers to the parsed string. */
+    BTASSERT(iov[2].buf_p == &js[2]);
+
+    size = 0;
+
+    for (i = 0; i < length; i++) {
+        memcpy(&buf[size], iov[i].buf_p, iov[i].size);
+        size += iov[i].size;
+    }
+
+    BTASSERT(size == strlen(js));
+    BTASSERT(memcmp(buf, js, size) == 0);
+
+    /* Too short vector. */
+    BTASSERT(json_dumpv(&json, NULL, iov, 18) == JSON_ERROR_NOMEM);
+    BTASSERT(json_dumpv(&json, NULL, iov, 0) == JSON_ERROR_NOMEM);
+
+    return (0);
+}
+
+struct telemetry_t {
+    int32_t temperature;
+    uint32_t uptime;
+    int armed;
+    const char *name_p;
+#if CONFIG_FLOAT == 1
+    float voltage;
+#endif
+};
+
+static const struct json_field_t telemetry_schema[] = {
+    JSON_FIELD_INT32(struct telemetry_t, temperature),
+    JSON_FIELD_UINT32(struct telemetry_t, uptime),
+    JSON_FIELD_BOOL(struct telemetry_t, armed),
+    JSON_FIELD_STRING(struct telemetry_t, name_p),
+#if CONFIG_FLOAT == 1
+    JSON_FIELD_FLOAT(struct telemetry_t, voltage)
+#endif
+};
+
+static int test_schema(void)
+{
+    struct telemetry_t telemetry;
+    struct json_tok_t tokens[16];
+    struct json_t json;
+    char buf[128];
+    ssize_t size;
+    const char *expected_p;
+
+    memset(&telemetry, 0, sizeof(telemetry));
+    telemetry.temperature = -2147483647 - 1;
+    telemetry.uptime = 4294967295u;
+    telemetry.armed = 1;
+    telemetry.name_p = "node";
+
+#if CONFIG_FLOAT == 1
+    telemetry.voltage = 3.5f;
+    expected_p = ("{\"temperature\":-2147483648,\"uptime\":4294967295,"
+                  "\"armed\":true,\"name_p\":\"node\","
+                  "\"voltage\":3.500000}");
+#else
+    expected_p = ("{\"temperature\":-2147483648,\"uptime\":4294967295,"
+                  "\"armed\":true,\"name_p\":\"node\"}");
+#endif
+
+    size = json_schema_dump_size(&telemetry_schema[0],
+                                 membersof(telemetry_schema),
+                                 &telemetry);
+    BTASSERT(size == strlen(expected_p), "%d", size);
+    BTASSERT(json_schema_dumpb(&telemetry_schema[0],
+                               membersof(telemetry_schema),
+                               &telemetry,
+                               &buf[0],
+                               size + 1) == size);
+    BTASSERT(strcmp(buf, expected_p) == 0, "%s", buf);
+    BTASSERT(json_schema_dumpb(&telemetry_schema[0],
+                               membersof(telemetry_schema),
+                               &telemetry,
+                               &buf[0],
+                               size) == JSON_ERROR_NOMEM);
+
+    /* The output is valid JSON. */
+    BTASSERT(json_init(&json, tokens, membersof(tokens)) == 0);
+    BTASSERT(json_parse(&json, buf, size) == 1 + 2 * membersof(telemetry_schema));
+
+    /* Small numbers, false and null. */
+    telemetry.temperature = 7;
+    telemetry.uptime = 42;
+    telemetry.armed = 0;
+    telemetry.name_p = NULL;
+    BTASSERT(json_schema_dumpb(&telemetry_schema[0],
+                               4,
+                               &telemetry,
+                               &buf[0],
+                               sizeof(buf)) == 57);
+    BTASSERT(strcmp(buf,
+                    "{\"temperature\":7,\"uptime\":42,"
+                    "\"armed\":false,\"name_p\":null}") == 0, "%s", buf);
+
+    /* Empty schema. */
+    BTASSERT(json_schema_dumpb(NULL, 0, &telemetry, &buf[0], 3) == 2);
+    BTASSERT(strcmp(buf, "{}") == 0);
+
+    /* Escaped quote, backslash and control characters. */
+    telemetry.name_p = "a\"b\\c";
+    expected_p = ("{\"temperature\":7,\"uptime\":42,"
+                  "\"armed\":false,\"name_p\":\"a\\\"b\\\\c\"}");
+    BTASSERT(json_schema_dump_size(&telemetry_schema[0],
+                                   4,
+                                   &telemetry) == strlen(expected_p));
+    BTASSERT(json_schema_dumpb(&telemetry_schema[0],
+                               4,
+                               &telemetry,
+                               &buf[0],
+                               sizeof(buf)) == strlen(expected_p));
+    BTASSERT(strcmp(buf, expected_p) == 0, "%s", buf);
+    BTASSERT(json_init(&json, tokens, membersof(tokens)) == 0);
+    BTASSERT(json_parse(&json, buf, strlen(buf)) == 9);
+
+    telemetry.name_p = "\t\x1f";
+    BTASSERT(json_schema_dump_size(&telemetry_schema[0],
+                                   4,
+                                   &telemetry) == 67);
+    BTASSERT(json_schema_dumpb(&telemetry_schema[0],
+                               4,
+                               &telemetry,
+                               &buf[0],
+                               sizeof(buf)) == 67);
+    BTASSERT(strcmp(buf,
+                    "{\"temperature\":7,\"uptime\":42,"
+                    "\"armed\":false,"
+                    "\"name_p\":\"\\u0009\\u001f\"}") == 0, "%s", buf);
+
+#if CONFIG_FLOAT == 1
+    /* Floats always have a whole digit. */
+    telemetry.name_p = NULL;
+    telemetry.voltage = 0.5f;
+    BTASSERT(json_schema_dumpb(&telemetry_schema[0],
+                               membersof(telemetry_schema),
+                               &telemetry,
+                               &buf[0],
+                               sizeof(buf)) == 76);
+    BTASSERT(strcmp(buf,
+                    "{\"temperature\":7,\"uptime\":42,"
+                    "\"armed\":false,\"name_p\":null,"
+                    "\"voltage\":0.500000}") == 0, "%s", buf);
+
+    telemetry.voltage = -0.25f;
+    BTASSERT(json_schema_dumpb(&telemetry_schema[0],
+                               membersof(telemetry_schema),
+                               &telemetry,
+                               &buf[0],
+                               sizeof(buf)) == 77);
+    BTASSERT(strcmp(buf,
+                    "{\"temperature\":7,\"uptime\":42,"
+                    "\"armed\":false,\"name_p\":null,"
+                    "\"voltage\":-0.250000}") == 0, "%s", buf);
+
+    telemetry.voltage = -1e9f;
+    BTASSERT(json_schema_dump_size(&telemetry_schema[0],
+                                   membersof(telemetry_schema),
+                                   &telemetry) == 86);
+    BTASSERT(json_schema_dumpb(&telemetry_schema[0],
+                               membersof(telemetry_schema),
+                               &telemetry,
+                               &buf[0],
+                               sizeof(buf)) == 86);
+    BTASSERT(strcmp(buf,
+                    "{\"temperature\":7,\"uptime\":42,"
+                    "\"armed\":false,\"name_p\":null,"
+                    "\"voltage\":-1000000000.000000}") == 0, "%s", buf);
+    BTASSERT(json_init(&json, tokens, membersof(tokens)) == 0);
+    BTASSERT(json_parse(&json, buf, strlen(buf)) == 11);
+
+    telemetry.voltage = 1e9f;
+    BTASSERT(json_schema_dumpb(&telemetry_schema[0],
+                               membersof(telemetry_schema),
+                               &telemetry,
+                               &buf[0],
+                               sizeof(buf)) == 85);
+
+    /* Non-finite and too big values. */
+    telemetry.voltage = NAN;
+    BTASSERT(json_schema_dump_size(&telemetry_schema[0],
+                                   membersof(telemetry_schema),
+                                   &telemetry) == JSON_ERROR_INVAL);
+    telemetry.voltage = -INFINITY;
+    BTASSERT(json_schema_dump_size(&telemetry_schema[0],
+                                   membersof(telemetry_schema),
+                                   &telemetry) == JSON_ERROR_INVAL);
+    telemetry.voltage = 1e10f;
+    BTASSERT(json_schema_dump_size(&telemetry_schema[0],
+                                   membersof(telemetry_schema),
+                                   &telemetry) == JSON_ERROR_INVAL);
+#endif
+
+    return (0);
+}
+
 static int test_get(void)
 {
     struct json_t json;
@@ -831,6 +1097,335 @@ static int test_get(void)
     return (0);
 }
 
+static int test_get_indexed(void)
+{
+    struct json_t json;
+    struct json_tok_t tokens[64];
+    int index[JSON_INDEX_BUFFER_SIZE(13) / sizeof(int)];
+    struct json_tok_t *foo_p, *ten_p, *fie_p, *true_p, *one_p;
+    char js_p[] = "{"
+        "\"foo\":[10, {\"fie\":null}],"
+        "\"true\":null,"
+        "true:null,"
+        "1:null"
+        "}";
+
+    BTASSERT(json_init(&json, tokens, membersof(tokens)) == 0);
+    BTASSERT(json_parse(&json, js_p, strlen(js_p)) == 13);
+
+    /* Too small index buffer. */
+    BTASSERT(json_index(&json, index, sizeof(index) - 1) == JSON_ERROR_NOMEM);
+    BTASSERT(json_index(&json, index, sizeof(index)) == 0);
+
+    /* Same results as without an index. */
+    foo_p = json_object_get(&json, "foo", json_root(&json));
+    BTASSERT(foo_p == &tokens[2]);
+
+    true_p = json_object_get(&json, "true", json_root(&json));
+    BTASSERT(true_p == &tokens[8]);
+
+    true_p = json_object_get_primitive(&json, "true", json_root(&json));
+    BTASSERT(true_p == &tokens[10]);
+
+    one_p = json_object_get_primitive(&json, "1", json_root(&json));
+    BTASSERT(one_p == &tokens[12]);
+
+    BTASSERT(json_object_get(&json, "1", json_root(&json)) == NULL);
+    BTASSERT(json_object_get(&json, "fum", json_root(&json)) == NULL);
+
+    /* Keys are compared exactly. */
+    BTASSERT(json_object_get(&json, "fo", json_root(&json)) == NULL);
+    BTASSERT(json_object_get(&json, "fooo", json_root(&json)) == NULL);
+
+    ten_p = json_array_get(&json, 0, foo_p);
+    BTASSERT(ten_p == &tokens[3]);
+
+    fie_p = json_object_get(&json, "fie", json_array_get(&json, 1, foo_p));
+    BTASSERT(fie_p == &tokens[6]);
+
+    /* The key is only found in its own object. */
+    BTASSERT(json_object_get(&json, "fie", json_root(&json)) == NULL);
+    BTASSERT(json_object_get(&json, "foo", &tokens[4]) == NULL);
+
+    BTASSERT(json_array_get(&json, 2, foo_p) == NULL);
+    BTASSERT(json_array_get(&json, 0, NULL) == NULL);
+    BTASSERT(json_object_get(&json, "foo", NULL) == NULL);
+    BTASSERT(json_object_get(&json, "foo", ten_p) == NULL);
+    BTASSERT(json_array_get(&json, 0, json_root(&json)) == NULL);
+
+    /* A new parse invalidates the index. */
+    BTASSERT(json_init(&json, tokens, membersof(tokens)) == 0);
+    BTASSERT(json_parse(&json, "{\"a\":1}", 7) == 3);
+    BTASSERT(json_object_get(&json, "a", json_root(&json)) == &tokens[2]);
+
+    return (0);
+}
+
+static int test_get_indexed_large(void)
+{
+    struct json_t json;
+    static struct json_tok_t tokens[1 + 2 * 200 + 200];
+    static int index[JSON_INDEX_BUFFER_SIZE(membersof(tokens))
+                     / sizeof(int)];
+    static char js[4096];
+    char key[16];
+    struct json_tok_t *value_p;
+    struct json_tok_t *array_p;
+    struct json_tok_t *expected_p;
+    size_t size;
+    long value;
+    int i;
+    int num_tokens;
+
+    /* An object with 199 keys and a 200 element array last. */
+    size = std_sprintf(&js[0], FSTR("{"));
+
+    for (i = 0; i < 199; i++) {
+        size += std_sprintf(&js[size], FSTR("\"k%d\":%d,"), i, i);
+    }
+
+    size += std_sprintf(&js[size], FSTR("\"array\":["));
+
+    for (i = 0; i < 200; i++) {
+        size += std_sprintf(&js[size], FSTR("%d,"), i);
+    }
+
+    js[size - 1] = ']';
+    js[size++] = '}';
+
+    BTASSERT(json_init(&json, tokens, membersof(tokens)) == 0);
+    num_tokens = json_parse(&json, &js[0], size);
+    BTASSERT(num_tokens == membersof(tokens), "%d", num_tokens);
+
+    array_p = json_object_get(&json, "array", json_root(&json));
+    BTASSERT(array_p != NULL);
+    BTASSERT(json_index(&json, index, sizeof(index)) == 0);
+    BTASSERT(json_object_get(&json, "array", json_root(&json)) == array_p);
+
+    for (i = 0; i < 199; i++) {
+        std_sprintf(&key[0], FSTR("k%d"), i);
+        value_p = json_object_get(&json, &key[0], json_root(&json));
+        BTASSERT(value_p == &tokens[2 * i + 2], "%d", i);
+        BTASSERT(std_strtol(value_p->buf_p, &value) != NULL);
+        BTASSERT(value == i);
+    }
+
+    for (i = 0; i < 200; i++) {
+        value_p = json_array_get(&json, i, array_p);
+        expected_p = &tokens[2 * 199 + 3 + i];
+        BTASSERT(value_p == expected_p, "%d", i);
+    }
+
+    BTASSERT(json_array_get(&json, 200, array_p) == NULL);
+    BTASSERT(json_object_get(&json, "k199", json_root(&json)) == NULL);
+
+    return (0);
+}
+
+/* Events reported by the streaming parser, formatted as text. */
+static struct {
+    char buf[512];
+    size_t size;
+    int stop_at;
+} events;
+
+static int on_event(void *arg_p,
+                    enum json_stream_event_t event,
+                    const char *path_p,
+                    const char *buf_p,
+                    size_t size)
+{
+    static const char names[] = "{}[]sp";
+
+    if (events.stop_at == 0) {
+        return (-EIO);
+    }
+
+    events.stop_at--;
+    events.size += std_sprintf(&events.buf[events.size],
+                               FSTR("%c%s"),
+                               names[event],
+                               path_p);
+
+    if (buf_p != NULL) {
+        events.buf[events.size++] = '=';
+        memcpy(&events.buf[events.size], buf_p, size);
+        events.size += size;
+    }
+
+    events.buf[events.size++] = ' ';
+    events.buf[events.size] = '\0';
+
+    return (0);
+}
+
+static void events_reset(void)
+{
+    events.size = 0;
+    events.buf[0] = '\0';
+    events.stop_at = -1;
+}
+
+static int test_stream(void)
+{
+    struct json_stream_t stream;
+    const char *js_p;
+    size_t length;
+    size_t offset;
+    size_t size;
+    const char *expected_p;
+
+    js_p = "{\"name\": \"pump\", \"on\": true, \"levels\": [1, -2.5e3, null],"
+        "\"nested\": {\"a\": {}, \"b\": [[]]}, \"esc\": \"\\\"\\n\\u00e5\"}";
+    expected_p =
+        "{ s/name=pump p/on=true [/levels p/levels/0=1 p/levels/1=-2.5e3 "
+        "p/levels/2=null ]/levels {/nested {/nested/a }/nested/a "
+        "[/nested/b [/nested/b/0 ]/nested/b/0 ]/nested/b }/nested "
+        "s/esc=\"\n\xc3\xa5 } ";
+    length = strlen(js_p);
+
+    /* Feed the document in chunks of all sizes. */
+    for (size = 1; size <= length; size++) {
+        events_reset();
+        BTASSERT(json_stream_init(&stream, NULL, on_event, NULL) == 0);
+
+        for (offset = 0; offset < length; offset += size) {
+            BTASSERT(json_stream_feed(&stream,
+                                      &js_p[offset],
+                                      MIN(size, length - offset))
+                     == MIN(size, length - offset));
+        }
+
+        BTASSERT(json_stream_finish(&stream) == 0);
+        BTASSERT(strcmp(&events.buf[0], expected_p) == 0);
+    }
+
+    /* Root primitive, terminated by the end of the document. */
+    events_reset();
+    BTASSERT(json_stream_feed(&stream, " 123", 4) == 4);
+    BTASSERT(json_stream_finish(&stream) == 0);
+    BTASSERT(strcmp(&events.buf[0], "p=123 ") == 0);
+
+    /* Root string and array. */
+    events_reset();
+    BTASSERT(json_stream_feed(&stream, "\"foo\"  ", 7) == 7);
+    BTASSERT(json_stream_finish(&stream) == 0);
+    BTASSERT(json_stream_feed(&stream, "[]", 2) == 2);
+    BTASSERT(json_stream_finish(&stream) == 0);
+    BTASSERT(strcmp(&events.buf[0], "s=foo [ ] ") == 0);
+
+    return (0);
+}
+
+static int test_stream_selectors(void)
+{
+    struct json_stream_t stream;
+    const char *selectors[] = {
+        "/id",
+        "/sensors/1",
+        "/config",
+        NULL
+    };
+    const char *js_p;
+
+    js_p = "{\"id\": 7, \"blob\": \"a very long string that does not fit in "
+        "the value buffer and is not selected so it is never buffered\","
+        "\"sensors\": [{\"t\": 1}, {\"t\": 2}, {\"t\": 3}],"
+        "\"config\": {\"rate\": 10, \"modes\": [\"a\", \"b\"]}}";
+
+    events_reset();
+    BTASSERT(json_stream_init(&stream, &selectors[0], on_event, NULL) == 0);
+    BTASSERT(chan_write(&stream, js_p, strlen(js_p)) == strlen(js_p));
+    BTASSERT(json_stream_finish(&stream) == 0);
+    BTASSERT(strcmp(&events.buf[0],
+                    "p/id=7 {/sensors/1 p/sensors/1/t=2 }/sensors/1 "
+                    "{/config p/config/rate=10 [/config/modes "
+                    "s/config/modes/0=a s/config/modes/1=b ]/config/modes "
+                    "}/config ") == 0);
+
+    return (0);
+}
+
+static int test_stream_errors(void)
+{
+    struct json_stream_t stream;
+    int i;
+    struct {
+        const char *js_p;
+        int res;
+    } datas[] = {
+        { "{\"a\" 1}", JSON_ERROR_INVAL },
+        { "{\"a\": 1,}", JSON_ERROR_INVAL },
+        { "[1, 2}", JSON_ERROR_INVAL },
+        { "{\"a\": x}", JSON_ERROR_INVAL },
+        { "{\"a\": \"\\q\"}", JSON_ERROR_INVAL },
+        { "{\"a\": \"\\u12g4\"}", JSON_ERROR_INVAL },
+        { "{\"a\": \"\x01\"}", JSON_ERROR_INVAL },
+        { "{} {}", JSON_ERROR_INVAL },
+        { "[1, 2", JSON_ERROR_PART },
+        { "{\"a\": \"abc", JSON_ERROR_PART },
+        { "[[[[[[[[[]]]]]]]]]", JSON_ERROR_NOMEM },
+        {
+            "\"a string that is a lot longer than the sixty four bytes value "
+            "buffer\"",
+            JSON_ERROR_NOMEM
+        }
+    };
+
+    BTASSERT(json_stream_init(&stream, NULL, on_event, NULL) == 0);
+
+    for (i = 0; i < membersof(datas); i++) {
+        events_reset();
+        (void)json_stream_feed(&stream, datas[i].js_p, strlen(datas[i].js_p));
+        BTASSERTI(json_stream_finish(&stream), ==, datas[i].res);
+    }
+
+    /* Errors are sticky until the document is finished. */
+    BTASSERT(json_stream_feed(&stream, "]", 1) == JSON_ERROR_INVAL);
+    BTASSERT(json_stream_feed(&stream, "1", 1) == JSON_ERROR_INVAL);
+    BTASSERT(json_stream_finish(&stream) == JSON_ERROR_INVAL);
+
+    /* Callback error. */
+    events_reset();
+    events.stop_at = 2;
+    BTASSERT(json_stream_feed(&stream, "[1, 2, 3]", 9) == -EIO);
+    BTASSERT(json_stream_finish(&stream) == -EIO);
+    BTASSERT(strcmp(&events.buf[0], "[ p/0=1 ") == 0);
+
+    return (0);
+}
+
+static int test_stream_read(void)
+{
+    struct json_stream_t stream;
+    struct queue_t queue;
+    char buf[256];
+    const char *selectors[] = {
+        "/payload/value",
+        NULL
+    };
+    int i;
+
+    BTASSERT(queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+
+    /* A document larger than the read chunk size. */
+    BTASSERT(chan_write(&queue, "{\"payload\": {", 13) == 13);
+
+    for (i = 0; i < 10; i++) {
+        BTASSERT(chan_write(&queue, "\"pad\": \"0123456789\", ", 21) == 21);
+    }
+
+    BTASSERT(chan_write(&queue, "\"value\": 42}}", 13) == 13);
+
+    events_reset();
+    BTASSERT(json_stream_init(&stream, &selectors[0], on_event, NULL) == 0);
+    BTASSERT(json_stream_read(&stream, &queue, 13 + 210 + 13) == 0);
+    BTASSERT(json_stream_finish(&stream) == 0);
+    BTASSERT(strcmp(&events.buf[0], "p/payload/value=42 ") == 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -851,7 +1446,16 @@ int main()
         { test_dumps, "test_dumps" },
         { test_dumps_fail, "test_dumps_fail" },
         { test_dump, "test_dump" },
+        { test_dumpb, "test_dumpb" },
+        { test_dumpv, "test_dumpv" },
+        { test_schema, "test_schema" },
         { test_get, "test_get" },
+        { test_get_indexed, "test_get_indexed" },
+        { test_get_indexed_large, "test_get_indexed_large" },
+        { test_stream, "test_stream" },
+        { test_stream_selectors, "test_stream_selectors" },
+        { test_stream_errors, "test_stream_errors" },
+        { test_stream_read, "test_stream_read" },
         { NULL, NULL }
     };
 
@@ -895,6 +895,228 @@ static int test_decode_bad_position(void)
     return (0);
 }
 
+static int test_frame_fields(void)
+{
+    const char sentence[] =
+        "$GPGLL,4916.45,N,12311.12,W,225444,A,*1D\r\n";
+    struct nmea_frame_t frame;
+    struct nmea_field_t field;
+
+    BTASSERTI(nmea_decode_frames(&frame, 1, &sentence[0], strlen(sentence)),
+              ==,
+              1);
+    BTASSERT(frame.buf_p == &sentence[0]);
+    BTASSERTI(frame.size, ==, strlen(sentence));
+    BTASSERTI(frame.number_of_fields, ==, 8);
+    BTASSERTI(nmea_frame_get_type(&frame), ==, nmea_sentence_type_gll_t);
+
+    /* Address field. */
+    BTASSERTI(nmea_frame_get_field(&frame, 0, &field), ==, 0);
+    BTASSERTI(field.size, ==, 5);
+    BTASSERTM(field.buf_p, "GPGLL", 5);
+
+    BTASSERTI(nmea_frame_get_field(&frame, 1, &field), ==, 0);
+    BTASSERTI(field.size, ==, 7);
+    BTASSERTM(field.buf_p, "4916.45", 7);
+
+    BTASSERTI(nmea_frame_get_field(&frame, 6, &field), ==, 0);
+    BTASSERTI(field.size, ==, 1);
+    BTASSERTM(field.buf_p, "A", 1);
+
+    /* Empty last field. */
+    BTASSERTI(nmea_frame_get_field(&frame, 7, &field), ==, 0);
+    BTASSERTI(field.size, ==, 0);
+    BTASSERT(field.buf_p == &sentence[37]);
+
+    BTASSERTI(nmea_frame_get_field(&frame, 8, &field), ==, -EINVAL);
+    BTASSERTI(nmea_frame_get_field(&frame, -1, &field), ==, -EINVAL);
+
+    return (0);
+}
+
+static int test_decode_frames(void)
+{
+    const char sentences[] =
+        "garbage"
+        "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n"
+        /* Bad checksum. */
+        "$GPRMC,,,,,,,,,,,*66\r\n"
+        "$GPFOO,BAR*2c\r\n"
+        /* Restarted sentence. */
+        "$GPVTG,054.7,T"
+        "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n"
+        "$GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45*75\r\n"
+        /* Incomplete. */
+        "$GPGSA,A,3,04,05,,09,12,,,24";
+    struct nmea_frame_t frames[8];
+    struct nmea_field_t field;
+
+    BTASSERTI(nmea_decode_frames(&frames[0],
+                                 membersof(frames),
+                                 &sentences[0],
+                                 strlen(sentences)), ==, 4);
+    BTASSERTI(nmea_frame_get_type(&frames[0]), ==, nmea_sentence_type_gga_t);
+    BTASSERTI(frames[0].number_of_fields, ==, 15);
+    BTASSERTI(nmea_frame_get_type(&frames[1]), ==, nmea_sentence_type_raw_t);
+    BTASSERTI(nmea_frame_get_field(&frames[1], 1, &field), ==, 0);
+    BTASSERTM(field.buf_p, "BAR", 3);
+    BTASSERTI(nmea_frame_get_type(&frames[2]), ==, nmea_sentence_type_vtg_t);
+    BTASSERTI(nmea_frame_get_type(&frames[3]), ==, nmea_sentence_type_gsv_t);
+    BTASSERTI(frames[3].number_of_fields, ==, 20);
+
+    /* Stop when the frames array is full. */
+    BTASSERTI(nmea_decode_frames(&frames[0],
+                                 2,
+                                 &sentences[0],
+                                 strlen(sentences)), ==, 2);
+
+    return (0);
+}
+
+static int test_framer(void)
+{
+    const char stream[] =
+        "$GPGLL,4916.45,N,12311.12,W,225444,A,*1D\r\n"
+        "\r\n"
+        "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n"
+        "$GPRMC,,,,,,,,,,,*66\r\n"
+        "$GPFOO,BAR*2C\r\n";
+    struct nmea_framer_t framer;
+    struct nmea_frame_t frame;
+    struct nmea_field_t field;
+    char too_long[NMEA_SENTENCE_SIZE_MAX + 8];
+    size_t chunk_size;
+    size_t pos;
+    size_t size;
+    ssize_t res;
+    int types[4];
+    int number_of_frames;
+
+    /* Feed the stream in chunks of all sizes. */
+    for (chunk_size = 1; chunk_size <= sizeof(stream); chunk_size++) {
+        BTASSERTI(nmea_framer_init(&framer), ==, 0);
+        number_of_frames = 0;
+        pos = 0;
+
+        while (pos < sizeof(stream) - 1) {
+            size = MIN(chunk_size, sizeof(stream) - 1 - pos);
+
+            while (size > 0) {
+                res = nmea_framer_input(&framer, &stream[pos], size, &frame);
+                BTASSERT(res > 0);
+                pos += res;
+                size -= res;
+
+                if (frame.buf_p != NULL) {
+                    BTASSERT(number_of_frames < membersof(types));
+                    types[number_of_frames++] = nmea_frame_get_type(&frame);
+                    BTASSERTI(nmea_frame_get_field(&frame, 0, &field), ==, 0);
+                    BTASSERTI(field.size, ==, 5);
+                }
+            }
+        }
+
+        BTASSERTI(number_of_frames, ==, 3);
+        BTASSERTI(types[0], ==, nmea_sentence_type_gll_t);
+        BTASSERTI(types[1], ==, nmea_sentence_type_vtg_t);
+        BTASSERTI(types[2], ==, nmea_sentence_type_raw_t);
+        BTASSERTI(framer.number_of_errors, ==, 1);
+    }
+
+    /* A too long sentence is discarded. */
+    BTASSERTI(nmea_framer_init(&framer), ==, 0);
+    memset(&too_long[0], 'A', sizeof(too_long));
+    too_long[0] = '$';
+    res = nmea_framer_input(&framer, &too_long[0], 40, &frame);
+    BTASSERTI(res, ==, 40);
+    BTASSERT(frame.buf_p == NULL);
+    res = nmea_framer_input(&framer,
+                            &too_long[40],
+                            sizeof(too_long) - 40,
+                            &frame);
+    BTASSERTI(res, ==, NMEA_SENTENCE_SIZE_MAX - 40);
+    BTASSERT(frame.buf_p == NULL);
+    BTASSERTI(framer.number_of_errors, ==, 1);
+
+    return (0);
+}
+
+static int test_benchmark(void)
+{
+    static const char sentences[] =
+        "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n"
+        "$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n"
+        "$GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45*75\r\n"
+        "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n"
+        "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n"
+        "$GPGLL,4916.45,N,12311.12,W,225444,A,*1D\r\n";
+    struct nmea_frame_t frames[6];
+    struct nmea_sentence_t decoded;
+    char buf[NMEA_SENTENCE_SIZE_MAX + 1];
+    struct time_t start;
+    struct time_t stop;
+    struct time_t elapsed;
+    const char *begin_p;
+    const char *end_p;
+    unsigned long number_of_sentences;
+    unsigned long microseconds;
+    int i;
+
+    /* Batch decoding. */
+    number_of_sentences = 0;
+    time_get(&start);
+
+    do {
+        for (i = 0; i < 64; i++) {
+            BTASSERTI(nmea_decode_frames(&frames[0],
+                                         membersof(frames),
+                                         &sentences[0],
+                                         sizeof(sentences) - 1), ==, 6);
+        }
+
+        number_of_sentences += (64 * 6);
+        time_get(&stop);
+        time_subtract(&elapsed, &stop, &start);
+    } while ((elapsed.seconds == 0) && (elapsed.nanoseconds < 200000000));
+
+    microseconds = (1000000ul * elapsed.seconds + elapsed.nanoseconds / 1000);
+    std_printf(FSTR("nmea_decode_frames(): %lu sentences/s\r\n"),
+               (unsigned long)((1000000ull * number_of_sentences)
+                               / microseconds));
+
+    /* One sentence at a time, copied as nmea_decode() modifies it. */
+    number_of_sentences = 0;
+    time_get(&start);
+
+    do {
+        begin_p = &sentences[0];
+
+        for (i = 0; i < 64 * 6; i++) {
+            end_p = (strchr(begin_p, '\n') + 1);
+            memcpy(&buf[0], begin_p, end_p - begin_p);
+            buf[end_p - begin_p] = '\0';
+            BTASSERTI(nmea_decode(&decoded, &buf[0], end_p - begin_p), ==, 0);
+
+            if (*end_p == '\0') {
+                end_p = &sentences[0];
+            }
+
+            begin_p = end_p;
+        }
+
+        number_of_sentences += (64 * 6);
+        time_get(&stop);
+        time_subtract(&elapsed, &stop, &start);
+    } while ((elapsed.seconds == 0) && (elapsed.nanoseconds < 200000000));
+
+    microseconds = (1000000ul * elapsed.seconds + elapsed.nanoseconds / 1000);
+    std_printf(FSTR("nmea_decode(): %lu sentences/s\r\n"),
+               (unsigned long)((1000000ull * number_of_sentences)
+                               / microseconds));
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -936,6 +1158,10 @@ int main()
         { test_decode_bad_date, "test_decode_bad_date" },
         { test_decode_position, "test_decode_position" },
         { test_decode_bad_position, "test_decode_bad_position" },
+        { test_frame_fields, "test_frame_fields" },
+        { test_decode_frames, "test_decode_frames" },
+        { test_framer, "test_framer" },
+        { test_benchmark, "test_benchmark" },
         { NULL, NULL }
     };
 
@@ -521,6 +521,8 @@ static int test_filesystem_spiffs(void)
     struct fs_dir_t dir;
     struct fs_dir_entry_t entry;
 
+    BTASSERT(spiffs_module_init() == 0);
+
     /* Initiate the config struct. */
     config.hal_read_f = filesystem_spiffs_read;
     config.hal_write_f = filesystem_spiffs_write;
@@ -650,6 +652,75 @@ static int test_filesystem(void)
 #endif
 }
 
+static int test_dentry_cache(void)
+{
+#if defined(ARCH_LINUX) && (CONFIG_FS_DENTRY_CACHE_SIZE > 0)
+
+    char buf[64];
+    struct fs_file_t file;
+    struct fs_stat_t stat;
+
+    BTASSERT(fs_dentry_cache_invalidate() == 0);
+    strcpy(buf, "filesystems/fs/counters/reset");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == 0);
+
+    /* Negative lookups are cached. */
+    BTASSERT(fs_stat("/fat16fs/cache.txt", &stat) == -1);
+    BTASSERT(fs_stat("/fat16fs/cache.txt", &stat) == -1);
+    BTASSERT(fs_open(&file, "/fat16fs/cache.txt", FS_READ) == -1);
+    BTASSERT(fs_stat("/nofs/cache.txt", &stat) == -1);
+    BTASSERT(fs_stat("/nofs/cache.txt", &stat) == -1);
+
+    /* Creating the file invalidates the negative entry. */
+    BTASSERT(fs_open(&file,
+                     "/fat16fs/cache.txt",
+                     FS_CREAT | FS_WRITE | FS_SYNC) == 0);
+    BTASSERT(fs_write(&file, "abc", 3) == 3);
+    BTASSERT(fs_close(&file) == 0);
+
+    BTASSERT(fs_stat("/fat16fs/cache.txt", &stat) == 0);
+    BTASSERT(stat.size == 3);
+    BTASSERT(fs_stat("/fat16fs/cache.txt", &stat) == 0);
+    BTASSERT(stat.size == 3);
+
+    /* Writing to the file invalidates its size. */
+    BTASSERT(fs_open(&file, "/fat16fs/cache.txt", FS_READ) == 0);
+    BTASSERT(fs_close(&file) == 0);
+    BTASSERT(fs_open(&file,
+                     "/fat16fs/cache.txt",
+                     FS_WRITE | FS_APPEND | FS_SYNC) == 0);
+    BTASSERT(fs_write(&file, "de", 2) == 2);
+    BTASSERT(fs_close(&file) == 0);
+
+    BTASSERT(fs_stat("/fat16fs/cache.txt", &stat) == 0);
+    BTASSERT(stat.size == 5);
+
+    /* FAT16 paths are case insensitive. */
+    BTASSERT(fs_stat("/fat16fs/CACHE2.TXT", &stat) == -1);
+    BTASSERT(fs_open(&file,
+                     "/fat16fs/cache2.txt",
+                     FS_CREAT | FS_WRITE | FS_SYNC) == 0);
+    BTASSERT(fs_close(&file) == 0);
+    BTASSERT(fs_stat("/fat16fs/CACHE2.TXT", &stat) == 0);
+
+    /* Check the hit and miss counters. */
+    strcpy(buf, "filesystems/fs/dentry_cache/hits");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == 0);
+    BTASSERT(harness_expect(&qout, "0000000000000005\r\n", NULL) > 0);
+
+    strcpy(buf, "filesystems/fs/dentry_cache/misses");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == 0);
+    BTASSERT(harness_expect(&qout, "0000000000000006\r\n", NULL) > 0);
+
+    return (0);
+
+#else
+
+    return (1);
+
+#endif
+}
+
 static int test_filesystem_commands(void)
 {
 #if defined(ARCH_LINUX)
@@ -888,6 +959,7 @@ int main()
         { test_filesystem_spiffs, "test_filesystem_spiffs" },
         { test_filesystem_generic, "test_filesystem_generic" },
         { test_filesystem, "test_filesystem" },
+        { test_dentry_cache, "test_dentry_cache" },
         { test_filesystem_commands, "test_filesystem_commands" },
         { test_read_line, "test_read_line" },
         { test_cwd, "test_cwd" },
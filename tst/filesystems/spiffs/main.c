@@ -165,7 +165,7 @@ static int32_t hal_erase(struct spiffs_t *fs_p,
 
 static uint8_t fs_storage[PHY_SIZE];
 static uint8_t fdworkspace[240];
-static uint8_t cache[1408];
+static uint8_t cache[SPIFFS_CACHE_BUFFER_SIZE(LOG_PAGE_SIZE, 5)];
 
 static int hal_init(void)
 {
@@ -179,7 +179,7 @@ static int32_t hal_read(struct spiffs_t *fs_p,
                         uint32_t size,
                         uint8_t *dst_p)
 {
-    BTASSERT(addr + size < sizeof(fs_storage));
+    BTASSERT(addr + size <= sizeof(fs_storage));
 
     memcpy(dst_p, &fs_storage[addr], size);
 
@@ -191,7 +191,7 @@ static int32_t hal_write(struct spiffs_t *fs_p,
                          uint32_t size,
                          uint8_t *src_p)
 {
-    BTASSERT(addr + size < sizeof(fs_storage));
+    BTASSERT(addr + size <= sizeof(fs_storage));
 
     memcpy(&fs_storage[addr], src_p, size);
 
@@ -217,6 +217,8 @@ static uint8_t workspace[2 * LOG_PAGE_SIZE];
 
 static int test_init(void)
 {
+    BTASSERT(spiffs_module_init() == 0);
+    BTASSERT(spiffs_module_init() == 0);
     BTASSERT(hal_init() == 0);
 
     /* Initiate the config struct. */
@@ -371,6 +373,178 @@ static int test_read_write_performance(void)
     return (0);
 }
 
+/**
+ * Rewrite a file a number of times and return the number of garbage
+ * collections run inline by the writes. Optionally reclaim blocks
+ * between the rewrites, as the background garbage collection thread
+ * does when the file system is idle.
+ */
+static int rewrite_file(int rewrites, int gc_when_idle)
+{
+    int res;
+    spiffs_file fd;
+    size_t i;
+    static char buf[CHUNK_SIZE_MAX];
+    int inline_gc_runs;
+    uint32_t gc_runs;
+
+    memset(&buf[0], 0x5a, sizeof(buf));
+    inline_gc_runs = 0;
+
+    while (rewrites-- > 0) {
+        fd = spiffs_open(&fs,
+                         "gc.txt",
+                         SPIFFS_CREAT | SPIFFS_TRUNC | SPIFFS_RDWR,
+                         0);
+        BTASSERT(fd >= 0);
+
+        for (i = 0; i < 8 * CHUNK_SIZE_MAX; i += CHUNK_SIZE_MAX) {
+            gc_runs = fs.stats_gc_runs;
+            res = spiffs_write(&fs, fd, buf, sizeof(buf));
+            BTASSERT(res == sizeof(buf), "res = %d\r\n", res);
+            inline_gc_runs += (fs.stats_gc_runs - gc_runs);
+        }
+
+        BTASSERT(spiffs_close(&fs, fd) == 0);
+
+        if (gc_when_idle) {
+            do {
+                res = spiffs_gc_step(&fs,
+                                     CONFIG_SPIFFS_GC_THRD_FREE_BLOCKS_MIN);
+                BTASSERT(res >= 0, "res = %d\r\n", res);
+            } while (res == 1);
+        }
+    }
+
+    return (inline_gc_runs);
+}
+
+static int test_gc_step(void)
+{
+    spiffs_file fd;
+    uint32_t free_blocks;
+
+    /* Nothing to reclaim on an empty file system. */
+    spiffs_unmount(&fs);
+    BTASSERT(spiffs_format(&fs) == 0);
+    BTASSERT(spiffs_mount(&fs,
+                          &config,
+                          workspace,
+                          fdworkspace,
+                          sizeof(fdworkspace),
+                          cache,
+                          sizeof(cache),
+                          NULL) == 0);
+    BTASSERT(spiffs_gc_step(&fs, 0) == 0);
+    BTASSERT(spiffs_gc_step(&fs, fs.block_count) == 0);
+
+    /* Fill a few blocks and then remove the file. Each step erases
+       one fully deleted block. */
+    BTASSERT(rewrite_file(8, 0) == 0);
+    free_blocks = fs.free_blocks;
+    BTASSERT(spiffs_remove(&fs, "gc.txt") == 0);
+    BTASSERT(spiffs_gc_step(&fs, 0) == 1);
+    BTASSERT(fs.free_blocks == free_blocks + 1);
+
+    /* Partially deleted blocks are only cleaned if there are too few
+       free blocks. */
+    while (spiffs_gc_step(&fs, 0) == 1);
+
+    BTASSERT(fs.stats_p_deleted > 0);
+
+    while (spiffs_gc_step(&fs, fs.block_count) == 1);
+
+    BTASSERT(fs.stats_p_deleted == 0);
+
+    /* The file is gone. */
+    fd = spiffs_open(&fs, "gc.txt", SPIFFS_RDONLY, 0);
+    BTASSERT(fd < 0);
+
+    return (0);
+}
+
+static int test_gc_benchmark(void)
+{
+    int inline_gc_runs;
+    int background_gc_runs;
+    uint32_t write_max;
+
+    /* Writes that have to garbage collect inline. */
+    spiffs_unmount(&fs);
+    BTASSERT(spiffs_format(&fs) == 0);
+    BTASSERT(spiffs_mount(&fs,
+                          &config,
+                          workspace,
+                          fdworkspace,
+                          sizeof(fdworkspace),
+                          cache,
+                          sizeof(cache),
+                          NULL) == 0);
+    spiffs_histograms_reset(&fs);
+    inline_gc_runs = rewrite_file(100, 0);
+    write_max = fs.histograms.write.max;
+    std_printf(FSTR("Inline garbage collection: %d runs in writes.\r\n"),
+               inline_gc_runs);
+    spiffs_histograms_print(&fs, sys_get_stdout());
+
+    /* Garbage collect when idle. */
+    spiffs_unmount(&fs);
+    BTASSERT(spiffs_format(&fs) == 0);
+    BTASSERT(spiffs_mount(&fs,
+                          &config,
+                          workspace,
+                          fdworkspace,
+                          sizeof(fdworkspace),
+                          cache,
+                          sizeof(cache),
+                          NULL) == 0);
+    spiffs_histograms_reset(&fs);
+    background_gc_runs = rewrite_file(100, 1);
+    std_printf(FSTR("Background garbage collection: %d runs in writes, "
+                    "write max %lu us (was %lu us).\r\n"),
+               background_gc_runs,
+               (unsigned long)fs.histograms.write.max,
+               (unsigned long)write_max);
+    spiffs_histograms_print(&fs, sys_get_stdout());
+
+    BTASSERT(inline_gc_runs > 0);
+    BTASSERT(background_gc_runs < inline_gc_runs);
+
+    return (0);
+}
+
+static int test_gc_thrd(void)
+{
+    static struct spiffs_gc_thrd_t gc_thrd;
+    static THRD_STACK(stack, 1024);
+    int i;
+    uint32_t free_blocks;
+
+    BTASSERT(spiffs_gc_thrd_init(&gc_thrd,
+                                 &fs,
+                                 stack,
+                                 sizeof(stack)) == 0);
+    BTASSERT(spiffs_gc_thrd_start(&gc_thrd) == 0);
+
+    /* Create some fully deleted blocks and let the thread erase
+       them. */
+    BTASSERT(rewrite_file(8, 0) == 0);
+    BTASSERT(spiffs_remove(&fs, "gc.txt") == 0);
+    free_blocks = fs.free_blocks;
+
+    for (i = 0; i < 50; i++) {
+        thrd_sleep_ms(CONFIG_SPIFFS_GC_THRD_IDLE_MS);
+
+        if (fs.free_blocks > free_blocks + 1) {
+            break;
+        }
+    }
+
+    BTASSERT(fs.free_blocks > free_blocks + 1);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -378,6 +552,9 @@ int main()
         { test_format, "test_format" },
         { test_read_write, "test_read_write" },
         { test_read_write_performance, "test_read_write_performance" },
+        { test_gc_step, "test_gc_step" },
+        { test_gc_benchmark, "test_gc_benchmark" },
+        { test_gc_thrd, "test_gc_thrd" },
         { NULL, NULL }
     };
 
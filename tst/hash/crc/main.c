@@ -42,9 +42,153 @@ static int test_crc_32(void)
     return (0);
 }
 
+static int test_crc_32_implementations(void)
+{
+    static uint8_t buf[1024];
+    uint32_t expected[8];
+    size_t offsets[8] = { 0, 1, 3, 5, 7, 64, 129, 333 };
+    size_t sizes[8] = { 0, 1, 15, 63, 64, 65, 300, 690 };
+    int implementation;
+    int default_implementation;
+    size_t i;
+
+    for (i = 0; i < membersof(buf); i++) {
+        buf[i] = (i * 7 + (i >> 3));
+    }
+
+    default_implementation = crc_32_get_implementation();
+    BTASSERT(crc_32_set_implementation(CRC_32_IMPLEMENTATION_BYTE) == 0);
+
+    for (i = 0; i < membersof(sizes); i++) {
+        expected[i] = crc_32(0, &buf[offsets[i]], sizes[i]);
+    }
+
+    for (implementation = CRC_32_IMPLEMENTATION_BYTE;
+         implementation <= CRC_32_IMPLEMENTATION_HARDWARE;
+         implementation++) {
+        if (crc_32_set_implementation(implementation) != 0) {
+            std_printf(FSTR("Implementation %d not available.\r\n"),
+                       implementation);
+            continue;
+        }
+
+        BTASSERT(crc_32(0,
+                        "The quick brown fox jumps over the lazy dog",
+                        43) == 0x414fa339);
+
+        for (i = 0; i < membersof(sizes); i++) {
+            BTASSERT(crc_32(0, &buf[offsets[i]], sizes[i]) == expected[i],
+                     "implementation: %d, size: %u\r\n",
+                     implementation,
+                     sizes[i]);
+        }
+    }
+
+    BTASSERT(crc_32_set_implementation(-1) == -ENOSYS);
+    BTASSERT(crc_32_set_implementation(default_implementation) == 0);
+
+    return (0);
+}
+
+static int test_crc_32_combine(void)
+{
+    static uint8_t buf[1000];
+    uint32_t crc;
+    uint32_t crc1;
+    uint32_t crc2;
+    size_t i;
+
+    for (i = 0; i < membersof(buf); i++) {
+        buf[i] = i;
+    }
+
+    crc = crc_32(0, &buf[0], sizeof(buf));
+
+    for (i = 0; i <= sizeof(buf); i += 111) {
+        crc1 = crc_32(0, &buf[0], i);
+        crc2 = crc_32(0, &buf[i], sizeof(buf) - i);
+        BTASSERT(crc_32_combine(crc1, crc2, sizeof(buf) - i) == crc);
+    }
+
+    /* Empty second buffer. */
+    BTASSERT(crc_32_combine(crc, crc_32(0, &buf[0], 0), 0) == crc);
+
+    return (0);
+}
+
+static int test_crc_32_benchmark(void)
+{
+    static uint8_t buf[65536];
+    int implementation;
+    int default_implementation;
+    int i;
+    int rounds;
+    uint32_t crc;
+    struct time_t start;
+    struct time_t stop;
+    struct time_t elapsed;
+    unsigned long micros;
+
+    memset(&buf[0], 0xa5, sizeof(buf));
+    default_implementation = crc_32_get_implementation();
+
+    for (implementation = CRC_32_IMPLEMENTATION_BYTE;
+         implementation <= CRC_32_IMPLEMENTATION_HARDWARE;
+         implementation++) {
+        if (crc_32_set_implementation(implementation) != 0) {
+            continue;
+        }
+
+        crc = 0;
+        rounds = 0;
+        time_get(&start);
+
+        /* Run for at least 200 ms as the system tick is coarse. */
+        do {
+            for (i = 0; i < 16; i++) {
+                crc = crc_32(crc, &buf[0], sizeof(buf));
+            }
+
+            rounds += 16;
+            time_get(&stop);
+            time_subtract(&elapsed, &stop, &start);
+        } while ((elapsed.seconds == 0)
+                 && (elapsed.nanoseconds < 200000000));
+
+        micros = (elapsed.seconds * 1000000ul
+                  + elapsed.nanoseconds / 1000ul);
+
+#if CONFIG_FLOAT == 1
+        std_printf(FSTR("Implementation %d: %lu bytes in %lu us "
+                        "(%f GB/s, crc 0x%08lx).\r\n"),
+                   implementation,
+                   (unsigned long)rounds * sizeof(buf),
+                   micros,
+                   (float)rounds * sizeof(buf) / micros / 1000.0f,
+                   crc);
+#else
+        std_printf(FSTR("Implementation %d: %lu bytes in %lu us "
+                        "(crc 0x%08lx).\r\n"),
+                   implementation,
+                   (unsigned long)rounds * sizeof(buf),
+                   micros,
+                   crc);
+#endif
+    }
+
+    BTASSERT(crc_32_set_implementation(default_implementation) == 0);
+
+    return (0);
+}
+
 static int test_crc_ccitt(void)
 {
     uint16_t crc;
+    uint8_t buf[67];
+    uint16_t expected;
+    int offset;
+    int size;
+    int i;
 
     /* CCITT with 0xffff as initial value. */
     BTASSERT(crc_ccitt(0xffff, "", 0) == 0xffff);
@@ -53,6 +197,24 @@ static int test_crc_ccitt(void)
     crc = crc_ccitt(0xffff, "12345", 5);
     BTASSERT(crc_ccitt(crc, "6789", 4) == 0x29b1);
 
+    /* Compare with byte by byte calculation for all lengths and
+       alignments up to 64 bytes. */
+    for (i = 0; i < membersof(buf); i++) {
+        buf[i] = (37 * i + 11);
+    }
+
+    for (offset = 0; offset < 3; offset++) {
+        for (size = 0; size <= 64; size++) {
+            expected = 0xffff;
+
+            for (i = 0; i < size; i++) {
+                expected = crc_ccitt(expected, &buf[offset + i], 1);
+            }
+
+            BTASSERTI(crc_ccitt(0xffff, &buf[offset], size), ==, expected);
+        }
+    }
+
     return (0);
 }
 
@@ -101,6 +263,9 @@ int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_crc_32, "test_crc_32" },
+        { test_crc_32_implementations, "test_crc_32_implementations" },
+        { test_crc_32_combine, "test_crc_32_combine" },
+        { test_crc_32_benchmark, "test_crc_32_benchmark" },
         { test_crc_ccitt, "test_crc_ccitt" },
         { test_crc_xmodem, "test_crc_xmodem" },
         { test_crc_7, "test_crc_7" },
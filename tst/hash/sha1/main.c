@@ -116,10 +116,221 @@ int test_sha1(void)
     return (0);
 }
 
+int test_implementations(void)
+{
+    static uint8_t buf[1024];
+    struct sha1_t foo;
+    uint8_t expected[20];
+    uint8_t hash[20];
+    int default_implementation;
+    size_t size;
+    size_t i;
+
+    for (i = 0; i < sizeof(buf); i++) {
+        buf[i] = (i * 31 + (i >> 8));
+    }
+
+    default_implementation = sha1_get_implementation();
+    std_printf(FSTR("Default implementation: %d\r\n"),
+               default_implementation);
+
+    BTASSERT(sha1_set_implementation(-1) == -ENOSYS);
+
+    if (sha1_set_implementation(SHA1_IMPLEMENTATION_HARDWARE) != 0) {
+        std_printf(FSTR("No hardware implementation available.\r\n"));
+
+        return (0);
+    }
+
+    /* Compare the hardware implementation to the C implementation
+       for sizes from 0 to 1024 bytes, split in two updates. */
+    for (size = 0; size <= sizeof(buf); size += 7) {
+        BTASSERT(sha1_set_implementation(SHA1_IMPLEMENTATION_C) == 0);
+        BTASSERT(sha1_init(&foo) == 0);
+        BTASSERT(sha1_update(&foo, &buf[0], size) == 0);
+        BTASSERT(sha1_digest(&foo, expected) == 0);
+
+        BTASSERT(sha1_set_implementation(SHA1_IMPLEMENTATION_HARDWARE) == 0);
+        BTASSERT(sha1_init(&foo) == 0);
+        BTASSERT(sha1_update(&foo, &buf[0], size / 3) == 0);
+        BTASSERT(sha1_update(&foo, &buf[size / 3], size - size / 3) == 0);
+        BTASSERT(sha1_digest(&foo, hash) == 0);
+
+        BTASSERTM(hash, expected, 20);
+    }
+
+    BTASSERT(sha1_set_implementation(default_implementation) == 0);
+
+    return (0);
+}
+
+int test_digest_multi(void)
+{
+    static uint8_t buf[9][300];
+    static uint8_t hashes[9][20];
+    struct iov_t messages[9];
+    struct sha1_t foo;
+    uint8_t hash[20];
+    int implementation;
+    int default_implementation;
+    int i;
+    int j;
+
+    default_implementation = sha1_get_implementation();
+
+    /* Messages of different sizes, including empty messages, block
+       aligned messages and messages with two padding blocks. */
+    for (i = 0; i < membersof(messages); i++) {
+        for (j = 0; j < sizeof(buf[i]); j++) {
+            buf[i][j] = (i + j);
+        }
+
+        messages[i].buf_p = &buf[i][0];
+        messages[i].size = ((i * 37) % 300);
+    }
+
+    messages[7].size = 64;
+    messages[8].size = 56;
+
+    /* Zero to nine messages at a time with each implementation. */
+    for (implementation = SHA1_IMPLEMENTATION_C;
+         implementation <= SHA1_IMPLEMENTATION_HARDWARE;
+         implementation++) {
+        if (sha1_set_implementation(implementation) != 0) {
+            continue;
+        }
+
+        for (i = 0; i <= membersof(messages); i++) {
+            memset(&hashes[0][0], 0, sizeof(hashes));
+            BTASSERT(sha1_digest_multi(&messages[0],
+                                       &hashes[0][0],
+                                       i) == 0);
+
+            for (j = 0; j < i; j++) {
+                BTASSERT(sha1_init(&foo) == 0);
+                BTASSERT(sha1_update(&foo,
+                                     messages[j].buf_p,
+                                     messages[j].size) == 0);
+                BTASSERT(sha1_digest(&foo, hash) == 0);
+                BTASSERTM(&hashes[j][0], hash, 20);
+            }
+        }
+    }
+
+    BTASSERT(sha1_set_implementation(default_implementation) == 0);
+
+    return (0);
+}
+
+static void benchmark_print(const char *name_p,
+                            int rounds,
+                            size_t size,
+                            struct time_t *elapsed_p)
+{
+    unsigned long micros;
+
+    micros = (elapsed_p->seconds * 1000000ul
+              + elapsed_p->nanoseconds / 1000ul);
+
+#if CONFIG_FLOAT == 1
+    std_printf(FSTR("%s: %lu bytes in %lu us (%f MB/s).\r\n"),
+               name_p,
+               (unsigned long)rounds * size,
+               micros,
+               (float)rounds * size / micros);
+#else
+    std_printf(FSTR("%s: %lu bytes in %lu us.\r\n"),
+               name_p,
+               (unsigned long)rounds * size,
+               micros);
+#endif
+}
+
+int test_benchmark(void)
+{
+    static uint8_t buf[4][4096];
+    static uint8_t hashes[4][20];
+    struct iov_t messages[4];
+    struct sha1_t foo;
+    int implementation;
+    int default_implementation;
+    int rounds;
+    int i;
+    struct time_t start;
+    struct time_t stop;
+    struct time_t elapsed;
+
+    memset(&buf[0][0], 0xa5, sizeof(buf));
+    default_implementation = sha1_get_implementation();
+
+    for (i = 0; i < membersof(messages); i++) {
+        messages[i].buf_p = &buf[i][0];
+        messages[i].size = sizeof(buf[i]);
+    }
+
+    /* One message at a time with each implementation. */
+    for (implementation = SHA1_IMPLEMENTATION_C;
+         implementation <= SHA1_IMPLEMENTATION_HARDWARE;
+         implementation++) {
+        if (sha1_set_implementation(implementation) != 0) {
+            continue;
+        }
+
+        rounds = 0;
+        time_get(&start);
+
+        /* Run for at least 200 ms as the system tick is coarse. */
+        do {
+            for (i = 0; i < membersof(messages); i++) {
+                BTASSERT(sha1_init(&foo) == 0);
+                BTASSERT(sha1_update(&foo,
+                                     messages[i].buf_p,
+                                     messages[i].size) == 0);
+                BTASSERT(sha1_digest(&foo, &hashes[i][0]) == 0);
+            }
+
+            rounds++;
+            time_get(&stop);
+            time_subtract(&elapsed, &stop, &start);
+        } while ((elapsed.seconds == 0)
+                 && (elapsed.nanoseconds < 200000000));
+
+        benchmark_print(implementation == SHA1_IMPLEMENTATION_C
+                        ? "C" : "Hardware",
+                        rounds,
+                        sizeof(buf),
+                        &elapsed);
+    }
+
+    BTASSERT(sha1_set_implementation(default_implementation) == 0);
+
+    /* Four messages at a time, in SIMD lanes with the C
+       implementation. */
+    rounds = 0;
+    time_get(&start);
+
+    do {
+        BTASSERT(sha1_digest_multi(&messages[0],
+                                   &hashes[0][0],
+                                   membersof(messages)) == 0);
+        rounds++;
+        time_get(&stop);
+        time_subtract(&elapsed, &stop, &start);
+    } while ((elapsed.seconds == 0)
+             && (elapsed.nanoseconds < 200000000));
+
+    benchmark_print("Multi", rounds, sizeof(buf), &elapsed);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_sha1, "test_sha1" },
+        { test_implementations, "test_implementations" },
+        { test_digest_multi, "test_digest_multi" },
+        { test_benchmark, "test_benchmark" },
         { NULL, NULL }
     };
 
@@ -0,0 +1,235 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+#include "simba.h"
+
+static int test_sha256(void)
+{
+    struct sha256_t foo;
+    uint8_t hash[32];
+    int i;
+    struct {
+        char *name_p;
+        char *input_p;
+        char *hash_p;
+    } testdata[] = {
+        {
+            .name_p = "Empty",
+            .input_p = "",
+            .hash_p =
+            "\xe3\xb0\xc4\x42\x98\xfc\x1c\x14\x9a\xfb\xf4\xc8\x99\x6f\xb9\x24"
+            "\x27\xae\x41\xe4\x64\x9b\x93\x4c\xa4\x95\x99\x1b\x78\x52\xb8\x55"
+        },
+        {
+            .name_p = "Abc",
+            .input_p = "abc",
+            .hash_p =
+            "\xba\x78\x16\xbf\x8f\x01\xcf\xea\x41\x41\x40\xde\x5d\xae\x22\x23"
+            "\xb0\x03\x61\xa3\x96\x17\x7a\x9c\xb4\x10\xff\x61\xf2\x00\x15\xad"
+        },
+        {
+            .name_p = "Dog",
+            .input_p = "The quick brown fox jumps over the lazy dog",
+            .hash_p =
+            "\xd7\xa8\xfb\xb3\x07\xd7\x80\x94\x69\xca\x9a\xbc\xb0\x08\x2e\x4f"
+            "\x8d\x56\x51\xe4\x6d\x3c\xdb\x76\x2d\x02\xd0\xbf\x37\xc9\xe5\x92"
+        },
+        {
+            .name_p = "60",
+            .input_p =
+            "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+            .hash_p =
+            "\x11\xee\x39\x12\x11\xc6\x25\x64\x60\xb6\xed\x37\x59\x57\xfa\xdd"
+            "\x80\x61\xca\xfb\xb3\x1d\xaf\x96\x7d\xb8\x75\xae\xbd\x5a\xaa\xd4"
+        },
+        {
+            .name_p = "Long",
+            .input_p =
+            "abcdefghbcdefghicdefghijdefghijkefghijklfgh"
+            "ijklmghijklmnhijklmnoijklmnopjklmnopqklmnop"
+            "qrlmnopqrsmnopqrstnopqrstu",
+            .hash_p =
+            "\xcf\x5b\x16\xa7\x78\xaf\x83\x80\x03\x6c\xe5\x9e\x7b\x04\x92\x37"
+            "\x0b\x24\x9b\x11\xe8\xf0\x7a\x51\xaf\xac\x45\x03\x7a\xfe\xe9\xd1"
+        }
+    };
+
+    /* Test vectors. */
+    for (i = 0; i < membersof(testdata); i++) {
+        std_printf(FSTR("%s\r\n"), testdata[i].name_p);
+
+        BTASSERT(sha256_init(&foo) == 0);
+        BTASSERT(sha256_update(&foo,
+                               testdata[i].input_p,
+                               strlen(testdata[i].input_p)) == 0);
+        BTASSERT(sha256_digest(&foo, hash) == 0);
+
+        BTASSERT(memcmp(hash, testdata[i].hash_p, 32) == 0);
+    }
+
+    /* Multiple updates. */
+    BTASSERT(sha256_init(&foo) == 0);
+
+    for (i = 0; i < 400; i++) {
+        BTASSERT(sha256_update(&foo, "1", 1) == 0);
+    }
+
+    BTASSERT(sha256_digest(&foo, hash) == 0);
+
+    BTASSERT(memcmp(hash,
+                    "\xb1\x25\x47\xda\x74\xee\x44\xf5\xba\x82\x9a\x26\xda\xe1"
+                    "\x03\x55\xc7\x61\xee\x17\xe9\x3f\x0c\xb1\xd3\xfc\x5c\xc0"
+                    "\x84\x03\xec\x58",
+                    32) == 0);
+
+    return (0);
+}
+
+static int test_implementations(void)
+{
+    static uint8_t buf[1024];
+    struct sha256_t foo;
+    uint8_t expected[32];
+    uint8_t hash[32];
+    int default_implementation;
+    size_t size;
+    size_t i;
+
+    for (i = 0; i < sizeof(buf); i++) {
+        buf[i] = (i * 31 + (i >> 8));
+    }
+
+    default_implementation = sha256_get_implementation();
+    std_printf(FSTR("Default implementation: %d\r\n"),
+               default_implementation);
+
+    BTASSERT(sha256_set_implementation(-1) == -ENOSYS);
+
+    if (sha256_set_implementation(SHA256_IMPLEMENTATION_HARDWARE) != 0) {
+        std_printf(FSTR("No hardware implementation available.\r\n"));
+
+        return (0);
+    }
+
+    /* Compare the hardware implementation to the C implementation
+       for all sizes from 0 to 1024 bytes, split in two updates. */
+    for (size = 0; size <= sizeof(buf); size += 7) {
+        BTASSERT(sha256_set_implementation(SHA256_IMPLEMENTATION_C) == 0);
+        BTASSERT(sha256_init(&foo) == 0);
+        BTASSERT(sha256_update(&foo, &buf[0], size) == 0);
+        BTASSERT(sha256_digest(&foo, expected) == 0);
+
+        BTASSERT(sha256_set_implementation(SHA256_IMPLEMENTATION_HARDWARE)
+                 == 0);
+        BTASSERT(sha256_init(&foo) == 0);
+        BTASSERT(sha256_update(&foo, &buf[0], size / 3) == 0);
+        BTASSERT(sha256_update(&foo, &buf[size / 3], size - size / 3) == 0);
+        BTASSERT(sha256_digest(&foo, hash) == 0);
+
+        BTASSERTM(hash, expected, 32);
+    }
+
+    BTASSERT(sha256_set_implementation(default_implementation) == 0);
+
+    return (0);
+}
+
+static int test_benchmark(void)
+{
+    static uint8_t buf[16384];
+    struct sha256_t foo;
+    uint8_t hash[32];
+    int implementation;
+    int default_implementation;
+    int rounds;
+    struct time_t start;
+    struct time_t stop;
+    struct time_t elapsed;
+    unsigned long micros;
+
+    memset(&buf[0], 0xa5, sizeof(buf));
+    default_implementation = sha256_get_implementation();
+
+    for (implementation = SHA256_IMPLEMENTATION_C;
+         implementation <= SHA256_IMPLEMENTATION_HARDWARE;
+         implementation++) {
+        if (sha256_set_implementation(implementation) != 0) {
+            continue;
+        }
+
+        BTASSERT(sha256_init(&foo) == 0);
+        rounds = 0;
+        time_get(&start);
+
+        /* Run for at least 200 ms as the system tick is coarse. */
+        do {
+            BTASSERT(sha256_update(&foo, &buf[0], sizeof(buf)) == 0);
+            rounds++;
+            time_get(&stop);
+            time_subtract(&elapsed, &stop, &start);
+        } while ((elapsed.seconds == 0)
+                 && (elapsed.nanoseconds < 200000000));
+
+        BTASSERT(sha256_digest(&foo, hash) == 0);
+        micros = (elapsed.seconds * 1000000ul
+                  + elapsed.nanoseconds / 1000ul);
+
+#if CONFIG_FLOAT == 1
+        std_printf(FSTR("Implementation %d: %lu bytes in %lu us "
+                        "(%f MB/s).\r\n"),
+                   implementation,
+                   (unsigned long)rounds * sizeof(buf),
+                   micros,
+                   (float)rounds * sizeof(buf) / micros);
+#else
+        std_printf(FSTR("Implementation %d: %lu bytes in %lu us.\r\n"),
+                   implementation,
+                   (unsigned long)rounds * sizeof(buf),
+                   micros);
+#endif
+    }
+
+    BTASSERT(sha256_set_implementation(default_implementation) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_sha256, "test_sha256" },
+        { test_implementations, "test_implementations" },
+        { test_benchmark, "test_benchmark" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
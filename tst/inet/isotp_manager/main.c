@@ -0,0 +1,705 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+#define NUMBER_OF_SESSIONS                                40
+#define FRAMES_MAX                                        64
+
+struct link_t {
+    struct isotp_manager_t *peer_p;
+    int number_of_frames;
+    struct {
+        uint32_t id;
+        size_t size;
+        uint8_t buf[64];
+    } frames[FRAMES_MAX];
+};
+
+struct peer_t {
+    int number_of_messages;
+    uint8_t buf[8192];
+    size_t size;
+    int number_of_completes;
+    int res;
+};
+
+static struct link_t link_a;
+static struct link_t link_b;
+static struct isotp_manager_t manager_a;
+static struct isotp_manager_t manager_b;
+static uint8_t pool_a[NUMBER_OF_SESSIONS * 4096];
+static uint8_t pool_b[NUMBER_OF_SESSIONS * 4096];
+static struct isotp_manager_session_t sessions_a[NUMBER_OF_SESSIONS];
+static struct isotp_manager_session_t sessions_b[NUMBER_OF_SESSIONS];
+static struct peer_t peers_a[NUMBER_OF_SESSIONS];
+static struct peer_t peers_b[NUMBER_OF_SESSIONS];
+static uint8_t message[8192];
+
+/**
+ * Record the first written frames and forward them to the peer manager, if
+ * any.
+ */
+static int link_write(void *arg_p,
+                      uint32_t id,
+                      const uint8_t *buf_p,
+                      size_t size)
+{
+    struct link_t *link_p;
+    int i;
+
+    link_p = arg_p;
+    i = link_p->number_of_frames;
+
+    if (i < FRAMES_MAX) {
+        link_p->frames[i].id = id;
+        link_p->frames[i].size = size;
+        memcpy(&link_p->frames[i].buf[0], buf_p, size);
+    }
+
+    link_p->number_of_frames++;
+
+    if (link_p->peer_p != NULL) {
+        isotp_manager_input(link_p->peer_p, id, buf_p, size);
+    }
+
+    return (0);
+}
+
+static void on_message(struct isotp_manager_session_t *session_p,
+                       const uint8_t *buf_p,
+                       size_t size)
+{
+    struct peer_t *peer_p;
+
+    peer_p = session_p->arg_p;
+
+    if (size <= sizeof(peer_p->buf)) {
+        memcpy(&peer_p->buf[0], buf_p, size);
+    }
+
+    peer_p->size = size;
+    peer_p->number_of_messages++;
+}
+
+static void on_complete(struct isotp_manager_session_t *session_p,
+                        int res)
+{
+    struct peer_t *peer_p;
+
+    peer_p = session_p->arg_p;
+    peer_p->res = res;
+    peer_p->number_of_completes++;
+}
+
+/**
+ * Sessions destroyed by the complete callback below.
+ */
+static struct isotp_manager_session_t *destroy_sessions[2];
+
+static void on_complete_destroy(struct isotp_manager_session_t *session_p,
+                                int res)
+{
+    int i;
+
+    on_complete(session_p, res);
+
+    for (i = 0; i < membersof(destroy_sessions); i++) {
+        if (destroy_sessions[i] != NULL) {
+            isotp_manager_session_destroy(destroy_sessions[i]);
+        }
+    }
+}
+
+/**
+ * Initialize manager a and b with given number of sessions each,
+ * connected back to back if loopback is set.
+ */
+static int setup(int number_of_sessions,
+                 size_t buffer_size,
+                 int flags,
+                 int loopback)
+{
+    int i;
+
+    memset(&link_a, 0, sizeof(link_a));
+    memset(&link_b, 0, sizeof(link_b));
+    memset(&peers_a[0], 0, sizeof(peers_a));
+    memset(&peers_b[0], 0, sizeof(peers_b));
+
+    if (loopback == 1) {
+        link_a.peer_p = &manager_b;
+        link_b.peer_p = &manager_a;
+    }
+
+    BTASSERT(isotp_manager_init(&manager_a,
+                                link_write,
+                                &link_a,
+                                &pool_a[0],
+                                sizeof(pool_a),
+                                buffer_size,
+                                flags) == 0);
+    BTASSERT(isotp_manager_init(&manager_b,
+                                link_write,
+                                &link_b,
+                                &pool_b[0],
+                                sizeof(pool_b),
+                                buffer_size,
+                                flags) == 0);
+
+    for (i = 0; i < number_of_sessions; i++) {
+        BTASSERT(isotp_manager_session_init(&sessions_a[i],
+                                            &manager_a,
+                                            0x700 + i,
+                                            0x600 + i,
+                                            on_message,
+                                            on_complete,
+                                            &peers_a[i]) == 0);
+        BTASSERT(isotp_manager_session_init(&sessions_b[i],
+                                            &manager_b,
+                                            0x600 + i,
+                                            0x700 + i,
+                                            on_message,
+                                            on_complete,
+                                            &peers_b[i]) == 0);
+    }
+
+    for (i = 0; i < sizeof(message); i++) {
+        message[i] = i;
+    }
+
+    return (0);
+}
+
+/**
+ * Process both managers until given counter reaches given value,
+ * waiting for timer events when no session is ready.
+ */
+static int run_until(int *counter_p, int value)
+{
+    struct chan_list_t list;
+    struct chan_list_elem_t elements[2];
+    struct time_t timeout;
+    void *chan_p;
+    uint32_t mask;
+    int ready;
+
+    chan_list_init(&list, &elements[0], membersof(elements));
+    chan_list_add(&list, isotp_manager_get_event(&manager_a));
+    chan_list_add(&list, isotp_manager_get_event(&manager_b));
+    timeout.seconds = 2;
+    timeout.nanoseconds = 0;
+
+    while (*counter_p < value) {
+        ready = isotp_manager_process(&manager_a);
+        ready |= isotp_manager_process(&manager_b);
+
+        if ((ready == 0) && (*counter_p < value)) {
+            chan_p = chan_list_poll(&list, &timeout);
+
+            if (chan_p == NULL) {
+                break;
+            }
+
+            mask = 0xffffffff;
+            event_read(chan_p, &mask, sizeof(mask));
+        }
+    }
+
+    chan_list_destroy(&list);
+
+    return (*counter_p == value ? 0 : -ETIMEDOUT);
+}
+
+static int session_destroy_all(int number_of_sessions)
+{
+    int i;
+
+    for (i = 0; i < number_of_sessions; i++) {
+        BTASSERT(isotp_manager_session_destroy(&sessions_a[i]) == 0);
+        BTASSERT(isotp_manager_session_destroy(&sessions_b[i]) == 0);
+    }
+
+    return (0);
+}
+
+static int test_single_frame(void)
+{
+    uint8_t frame[8];
+
+    BTASSERT(setup(1, 64, 0, 0) == 0);
+
+    /* Output. */
+    BTASSERT(isotp_manager_session_write(&sessions_a[0], "foo", 3) == 0);
+    BTASSERT(isotp_manager_session_write(&sessions_a[0],
+                                         "bar",
+                                         3) == -EBUSY);
+    BTASSERT(isotp_manager_process(&manager_a) == 0);
+    BTASSERTI(link_a.number_of_frames, ==, 1);
+    BTASSERTI(link_a.frames[0].id, ==, 0x600);
+    BTASSERTI(link_a.frames[0].size, ==, 4);
+    BTASSERTM(&link_a.frames[0].buf[0], "\x03" "foo", 4);
+    BTASSERTI(peers_a[0].number_of_completes, ==, 1);
+    BTASSERTI(peers_a[0].res, ==, 0);
+
+    /* Input. */
+    frame[0] = 0x03;
+    frame[1] = 'b';
+    frame[2] = 'a';
+    frame[3] = 'r';
+    BTASSERT(isotp_manager_input(&manager_a, 0x700, &frame[0], 4) == 0);
+    BTASSERTI(peers_a[0].number_of_messages, ==, 1);
+    BTASSERTI(peers_a[0].size, ==, 3);
+    BTASSERTM(&peers_a[0].buf[0], "bar", 3);
+
+    /* Unknown id, bad length and unexpected frames. */
+    BTASSERT(isotp_manager_input(&manager_a, 0x701, &frame[0], 4) == -ENOENT);
+    frame[0] = 0x05;
+    BTASSERT(isotp_manager_input(&manager_a, 0x700, &frame[0], 4) == -EPROTO);
+    frame[0] = 0x21;
+    BTASSERT(isotp_manager_input(&manager_a, 0x700, &frame[0], 4) == -EPROTO);
+    frame[0] = 0x30;
+    BTASSERT(isotp_manager_input(&manager_a, 0x700, &frame[0], 3) == -EPROTO);
+    BTASSERTI(peers_a[0].number_of_messages, ==, 1);
+
+    /* Duplicated receive id. */
+    BTASSERT(isotp_manager_session_init(&sessions_a[1],
+                                        &manager_a,
+                                        0x700,
+                                        0x601,
+                                        on_message,
+                                        NULL,
+                                        NULL) == -EEXIST);
+
+    return (session_destroy_all(1));
+}
+
+static int test_multi_frame(void)
+{
+    BTASSERT(setup(1, 256, 0, 1) == 0);
+
+    BTASSERT(isotp_manager_session_write(&sessions_a[0],
+                                         &message[0],
+                                         100) == 0);
+    BTASSERT(run_until(&peers_b[0].number_of_messages, 1) == 0);
+    BTASSERTI(peers_b[0].size, ==, 100);
+    BTASSERTM(&peers_b[0].buf[0], &message[0], 100);
+    BTASSERTI(peers_a[0].number_of_completes, ==, 1);
+    BTASSERTI(peers_a[0].res, ==, 0);
+
+    /* First frame, 14 consecutive frames and one flow control
+       frame. */
+    BTASSERTI(link_a.number_of_frames, ==, 15);
+    BTASSERTM(&link_a.frames[0].buf[0], "\x10\x64", 2);
+    BTASSERTM(&link_a.frames[1].buf[0], "\x21", 1);
+    BTASSERTM(&link_a.frames[14].buf[0], "\x2e", 1);
+    BTASSERTI(link_a.frames[14].size, ==, 4);
+    BTASSERTI(link_b.number_of_frames, ==, 1);
+    BTASSERTM(&link_b.frames[0].buf[0], "\x30\x00\x00", 3);
+
+    /* And back again. */
+    BTASSERT(isotp_manager_session_write(&sessions_b[0],
+                                         &message[0],
+                                         256) == 0);
+    BTASSERT(run_until(&peers_a[0].number_of_messages, 1) == 0);
+    BTASSERTI(peers_a[0].size, ==, 256);
+    BTASSERTM(&peers_a[0].buf[0], &message[0], 256);
+    BTASSERTI(manager_a.counters.messages_received, ==, 1);
+    BTASSERTI(manager_b.counters.messages_sent, ==, 1);
+
+    return (session_destroy_all(1));
+}
+
+static int test_round_robin(void)
+{
+    int i;
+
+    BTASSERT(setup(3, 256, 0, 1) == 0);
+
+    for (i = 0; i < 3; i++) {
+        BTASSERT(isotp_manager_session_write(&sessions_a[i],
+                                             &message[0],
+                                             20) == 0);
+    }
+
+    BTASSERT(run_until(&peers_b[2].number_of_messages, 1) == 0);
+
+    /* The sessions takes turns transmitting their frames. */
+    BTASSERTI(link_a.number_of_frames, ==, 9);
+
+    for (i = 0; i < 9; i++) {
+        BTASSERTI(link_a.frames[i].id, ==, 0x600 + (i % 3));
+    }
+
+    for (i = 0; i < 3; i++) {
+        BTASSERTI(peers_b[i].number_of_messages, ==, 1);
+        BTASSERTM(&peers_b[i].buf[0], &message[0], 20);
+        BTASSERTI(peers_a[i].res, ==, 0);
+    }
+
+    return (session_destroy_all(3));
+}
+
+static int test_destroy_in_callback(void)
+{
+    int i;
+
+    BTASSERT(setup(3, 64, 0, 0) == 0);
+
+    /* Destroy the last ready session when the first completes. The
+       second session is still served. */
+    sessions_a[0].on_complete = on_complete_destroy;
+    destroy_sessions[0] = &sessions_a[2];
+    destroy_sessions[1] = NULL;
+
+    for (i = 0; i < 3; i++) {
+        BTASSERT(isotp_manager_session_write(&sessions_a[i], "foo", 3) == 0);
+    }
+
+    BTASSERT(isotp_manager_process(&manager_a) == 0);
+    BTASSERTI(link_a.number_of_frames, ==, 2);
+    BTASSERTI(link_a.frames[0].id, ==, 0x600);
+    BTASSERTI(link_a.frames[1].id, ==, 0x601);
+    BTASSERTI(peers_a[1].number_of_completes, ==, 1);
+    BTASSERTI(peers_a[2].number_of_completes, ==, 0);
+
+    BTASSERT(isotp_manager_session_destroy(&sessions_a[0]) == 0);
+    BTASSERT(isotp_manager_session_destroy(&sessions_a[1]) == 0);
+    BTASSERT(isotp_manager_session_destroy(&sessions_b[0]) == 0);
+    BTASSERT(isotp_manager_session_destroy(&sessions_b[1]) == 0);
+    BTASSERT(isotp_manager_session_destroy(&sessions_b[2]) == 0);
+
+    /* Destroy all other ready sessions, emptying the ready list. */
+    BTASSERT(setup(3, 64, 0, 0) == 0);
+    sessions_a[0].on_complete = on_complete_destroy;
+    destroy_sessions[0] = &sessions_a[1];
+    destroy_sessions[1] = &sessions_a[2];
+
+    for (i = 0; i < 3; i++) {
+        BTASSERT(isotp_manager_session_write(&sessions_a[i], "foo", 3) == 0);
+    }
+
+    BTASSERT(isotp_manager_process(&manager_a) == 0);
+    BTASSERTI(link_a.number_of_frames, ==, 1);
+    BTASSERTI(peers_a[0].number_of_completes, ==, 1);
+    BTASSERTI(peers_a[1].number_of_completes, ==, 0);
+    BTASSERTI(peers_a[2].number_of_completes, ==, 0);
+
+    BTASSERT(isotp_manager_session_destroy(&sessions_a[0]) == 0);
+    BTASSERT(isotp_manager_session_destroy(&sessions_b[0]) == 0);
+    BTASSERT(isotp_manager_session_destroy(&sessions_b[1]) == 0);
+    BTASSERT(isotp_manager_session_destroy(&sessions_b[2]) == 0);
+
+    return (0);
+}
+
+static int test_flow_control(void)
+{
+    struct time_t start;
+    struct time_t stop;
+    struct time_t elapsed;
+    int i;
+
+    BTASSERT(setup(1, 256, 0, 1) == 0);
+
+    /* Two consecutive frames per block, at least 20 ms apart. */
+    BTASSERT(isotp_manager_set_flow_control(&manager_b, 2, 20) == 0);
+
+    time_get(&start);
+    BTASSERT(isotp_manager_session_write(&sessions_a[0],
+                                         &message[0],
+                                         40) == 0);
+    BTASSERT(run_until(&peers_b[0].number_of_messages, 1) == 0);
+    time_get(&stop);
+    time_subtract(&elapsed, &stop, &start);
+
+    BTASSERTM(&peers_b[0].buf[0], &message[0], 40);
+
+    /* First frame and five consecutive frames. A flow control frame
+       after the first frame and every second consecutive frame. */
+    BTASSERTI(link_a.number_of_frames, ==, 6);
+    BTASSERTI(link_b.number_of_frames, ==, 3);
+
+    for (i = 0; i < 3; i++) {
+        BTASSERTM(&link_b.frames[i].buf[0], "\x30\x02\x14", 3);
+    }
+
+    /* Separation time between the two frames in the first and
+       second blocks. */
+    BTASSERT((elapsed.seconds > 0) || (elapsed.nanoseconds >= 40000000));
+
+    return (session_destroy_all(1));
+}
+
+static int test_flow_control_wait_and_overflow(void)
+{
+    uint8_t frame[8];
+
+    BTASSERT(setup(1, 32, 0, 0) == 0);
+
+    BTASSERT(isotp_manager_session_write(&sessions_a[0],
+                                         &message[0],
+                                         20) == 0);
+    BTASSERT(isotp_manager_process(&manager_a) == 0);
+    BTASSERTI(link_a.number_of_frames, ==, 1);
+
+    /* Wait. */
+    frame[0] = 0x31;
+    frame[1] = 0;
+    frame[2] = 0;
+    BTASSERT(isotp_manager_input(&manager_a, 0x700, &frame[0], 3) == 0);
+    BTASSERT(isotp_manager_process(&manager_a) == 0);
+    BTASSERTI(link_a.number_of_frames, ==, 1);
+    BTASSERTI(peers_a[0].number_of_completes, ==, 0);
+
+    /* Overflow. */
+    frame[0] = 0x32;
+    BTASSERT(isotp_manager_input(&manager_a, 0x700, &frame[0], 3) == 0);
+    BTASSERTI(peers_a[0].number_of_completes, ==, 1);
+    BTASSERTI(peers_a[0].res, ==, -EMSGSIZE);
+
+    /* A first frame of a message larger than the pool buffers is
+       rejected with an overflow flow control frame. */
+    frame[0] = 0x10;
+    frame[1] = 33;
+    BTASSERT(isotp_manager_input(&manager_a,
+                                 0x700,
+                                 &frame[0],
+                                 8) == -EMSGSIZE);
+    BTASSERTI(link_a.number_of_frames, ==, 2);
+    BTASSERTM(&link_a.frames[1].buf[0], "\x32\x00\x00", 3);
+    BTASSERTI(manager_a.counters.overflows, ==, 1);
+
+    return (session_destroy_all(1));
+}
+
+static int test_pool_exhausted(void)
+{
+    static uint8_t pool[64];
+    uint8_t frame[8];
+
+    BTASSERT(setup(2, 64, 0, 0) == 0);
+    BTASSERT(isotp_manager_init(&manager_a,
+                                link_write,
+                                &link_a,
+                                &pool[0],
+                                sizeof(pool),
+                                64,
+                                0) == 0);
+    BTASSERT(isotp_manager_session_init(&sessions_a[0],
+                                        &manager_a,
+                                        0x700,
+                                        0x600,
+                                        on_message,
+                                        on_complete,
+                                        &peers_a[0]) == 0);
+    BTASSERT(isotp_manager_session_init(&sessions_a[1],
+                                        &manager_a,
+                                        0x701,
+                                        0x601,
+                                        on_message,
+                                        on_complete,
+                                        &peers_a[1]) == 0);
+
+    /* The only buffer is used by the first session. */
+    memset(&frame[0], 0, sizeof(frame));
+    frame[0] = 0x10;
+    frame[1] = 20;
+    BTASSERT(isotp_manager_input(&manager_a, 0x700, &frame[0], 8) == 0);
+    BTASSERT(isotp_manager_input(&manager_a,
+                                 0x701,
+                                 &frame[0],
+                                 8) == -ENOMEM);
+
+    /* Bad sequence number aborts the reception and frees the
+       buffer. */
+    frame[0] = 0x22;
+    BTASSERT(isotp_manager_input(&manager_a, 0x700, &frame[0], 8) == -EPROTO);
+    frame[0] = 0x10;
+    BTASSERT(isotp_manager_input(&manager_a, 0x701, &frame[0], 8) == 0);
+
+    frame[0] = 0x21;
+    BTASSERT(isotp_manager_input(&manager_a, 0x701, &frame[0], 8) == 0);
+    frame[0] = 0x22;
+    BTASSERT(isotp_manager_input(&manager_a, 0x701, &frame[0], 8) == 0);
+    BTASSERTI(peers_a[1].number_of_messages, ==, 1);
+    BTASSERTI(peers_a[1].size, ==, 20);
+
+    /* Freed on completion. */
+    frame[0] = 0x10;
+    BTASSERT(isotp_manager_input(&manager_a, 0x700, &frame[0], 8) == 0);
+
+    BTASSERT(isotp_manager_session_destroy(&sessions_a[0]) == 0);
+    BTASSERT(isotp_manager_session_destroy(&sessions_a[1]) == 0);
+
+    return (0);
+}
+
+static int test_timeouts(void)
+{
+    uint8_t frame[8];
+
+    BTASSERT(setup(1, 64, 0, 0) == 0);
+
+    /* No flow control frame from the peer. */
+    BTASSERT(isotp_manager_session_write(&sessions_a[0],
+                                         &message[0],
+                                         20) == 0);
+    BTASSERT(run_until(&peers_a[0].number_of_completes, 1) == 0);
+    BTASSERTI(peers_a[0].res, ==, -ETIMEDOUT);
+
+    /* No consecutive frame from the peer. */
+    memset(&frame[0], 0, sizeof(frame));
+    frame[0] = 0x10;
+    frame[1] = 20;
+    BTASSERT(isotp_manager_input(&manager_a, 0x700, &frame[0], 8) == 0);
+    BTASSERT(run_until((int *)&manager_a.counters.timeouts, 2) == 0);
+    frame[0] = 0x21;
+    BTASSERT(isotp_manager_input(&manager_a, 0x700, &frame[0], 8) == -EPROTO);
+
+    return (session_destroy_all(1));
+}
+
+static int test_can_fd(void)
+{
+    BTASSERT(setup(1, 8192, ISOTP_MANAGER_FLAGS_CAN_FD, 1) == 0);
+
+    /* Single frame with the length in the second byte, padded to a
+       valid CAN-FD frame size. */
+    BTASSERT(isotp_manager_session_write(&sessions_a[0],
+                                         &message[0],
+                                         30) == 0);
+    BTASSERT(run_until(&peers_b[0].number_of_messages, 1) == 0);
+    BTASSERTI(link_a.number_of_frames, ==, 1);
+    BTASSERTI(link_a.frames[0].size, ==, 32);
+    BTASSERTM(&link_a.frames[0].buf[0], "\x00\x1e", 2);
+    BTASSERTI(peers_b[0].size, ==, 30);
+    BTASSERTM(&peers_b[0].buf[0], &message[0], 30);
+
+    /* First frame and consecutive frames with 64 bytes. */
+    BTASSERT(isotp_manager_session_write(&sessions_a[0],
+                                         &message[0],
+                                         200) == 0);
+    BTASSERT(run_until(&peers_b[0].number_of_messages, 2) == 0);
+    BTASSERTI(link_a.number_of_frames, ==, 5);
+    BTASSERTI(link_a.frames[1].size, ==, 64);
+    BTASSERTI(link_a.frames[2].size, ==, 64);
+    BTASSERTI(link_a.frames[3].size, ==, 64);
+    BTASSERTI(link_a.frames[4].size, ==, 16);
+    BTASSERTI(peers_b[0].size, ==, 200);
+    BTASSERTM(&peers_b[0].buf[0], &message[0], 200);
+
+    /* First frame with the 32 bits length escape sequence. */
+    link_a.number_of_frames = 0;
+    BTASSERT(isotp_manager_session_write(&sessions_a[0],
+                                         &message[0],
+                                         5000) == 0);
+    BTASSERT(run_until(&peers_b[0].number_of_messages, 3) == 0);
+    BTASSERTM(&link_a.frames[0].buf[0], "\x10\x00\x00\x00\x13\x88", 6);
+    BTASSERTI(peers_b[0].size, ==, 5000);
+    BTASSERTM(&peers_b[0].buf[0], &message[0], 5000);
+
+    return (session_destroy_all(1));
+}
+
+static int test_benchmark(void)
+{
+    struct time_t start;
+    struct time_t stop;
+    struct time_t elapsed;
+    unsigned long micros;
+    int i;
+    int rounds;
+    int number_of_messages;
+
+    BTASSERT(setup(NUMBER_OF_SESSIONS, 4096, 0, 1) == 0);
+
+    rounds = 0;
+    number_of_messages = 0;
+    time_get(&start);
+
+    /* All sessions transmits a 4095 bytes message at the same time,
+       for at least 200 ms. */
+    do {
+        for (i = 0; i < NUMBER_OF_SESSIONS; i++) {
+            BTASSERT(isotp_manager_session_write(&sessions_a[i],
+                                                 &message[0],
+                                                 4095) == 0);
+        }
+
+        number_of_messages += NUMBER_OF_SESSIONS;
+        BTASSERT(run_until((int *)&manager_b.counters.messages_received,
+                           number_of_messages) == 0);
+        rounds++;
+        time_get(&stop);
+        time_subtract(&elapsed, &stop, &start);
+    } while ((elapsed.seconds == 0)
+             && (elapsed.nanoseconds < 200000000));
+
+    micros = (elapsed.seconds * 1000000ul + elapsed.nanoseconds / 1000ul);
+
+    for (i = 0; i < NUMBER_OF_SESSIONS; i++) {
+        BTASSERTI(peers_b[i].number_of_messages, ==, rounds);
+        BTASSERTM(&peers_b[i].buf[0], &message[0], 4095);
+    }
+
+    std_printf(FSTR("%d messages (%lu frames, %lu bytes) on %d sessions "
+                    "in %lu us.\r\n"),
+               number_of_messages,
+               (unsigned long)manager_a.counters.frames_sent,
+               (unsigned long)number_of_messages * 4095ul,
+               NUMBER_OF_SESSIONS,
+               micros);
+
+    return (session_destroy_all(NUMBER_OF_SESSIONS));
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_single_frame, "test_single_frame" },
+        { test_multi_frame, "test_multi_frame" },
+        { test_round_robin, "test_round_robin" },
+        { test_destroy_in_callback, "test_destroy_in_callback" },
+        { test_flow_control, "test_flow_control" },
+        { test_flow_control_wait_and_overflow,
+          "test_flow_control_wait_and_overflow" },
+        { test_pool_exhausted, "test_pool_exhausted" },
+        { test_timeouts, "test_timeouts" },
+        { test_can_fd, "test_can_fd" },
+        { test_benchmark, "test_benchmark" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
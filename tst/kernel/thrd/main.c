@@ -365,6 +365,70 @@ int test_monitor_thread(void)
     return (0);
 }
 
+int test_cpu_usage(void)
+{
+    cpu_usage_t usage;
+
+    thrd_sleep_ms(30);
+
+    /* The CPU usage of all threads adds up to about 100%. */
+    usage = (thrd_get_by_name("main")->statistics.cpu.usage
+             + thrd_get_by_name("idle")->statistics.cpu.usage
+             + thrd_get_by_name("monitor")->statistics.cpu.usage);
+
+    BTASSERT(usage > 50);
+    BTASSERT(usage < 150);
+
+    return (0);
+}
+
+int test_scheduling_statistics(void)
+{
+    struct thrd_scheduling_statistics_t statistics;
+    char command[64];
+    uint32_t latencies;
+    uint32_t run_lengths;
+    int i;
+
+    BTASSERT(thrd_reset_scheduling_statistics() == 0);
+
+    for (i = 0; i < 10; i++) {
+        thrd_sleep_us(100);
+    }
+
+    BTASSERT(thrd_get_scheduling_statistics(thrd_self(), &statistics) == 0);
+    BTASSERT(statistics.voluntary >= 10);
+
+    latencies = 0;
+    run_lengths = 0;
+
+    for (i = 0; i < THRD_HISTOGRAM_LENGTH; i++) {
+        latencies += statistics.latency[i];
+        run_lengths += statistics.run_length[i];
+    }
+
+    /* Every switch from the thread is recorded in the run length
+       histogram. */
+    BTASSERTI(run_lengths, ==, statistics.voluntary + statistics.involuntary);
+    BTASSERT(latencies >= 10);
+
+    strcpy(command, "/kernel/thrd/scheduling");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+
+    strcpy(command, "/kernel/thrd/scheduling json");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+
+    strcpy(command, "/kernel/thrd/scheduling reset");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+    BTASSERT(thrd_get_scheduling_statistics(thrd_self(), &statistics) == 0);
+    BTASSERTI(statistics.voluntary, ==, 0);
+
+    strcpy(command, "/kernel/thrd/scheduling foo");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == -EINVAL);
+
+    return (0);
+}
+
 int test_stack_heap(void)
 {
     BTASSERT(thrd_stack_alloc(1) == NULL);
@@ -414,6 +478,12 @@ int main()
         { test_stack_top_bottom, "test_stack_top_bottom" },
 #    if CONFIG_MONITOR_THREAD == 1
         { test_monitor_thread, "test_monitor_thread" },
+#        if CONFIG_THRD_CPU_USAGE == 1 && defined(ARCH_LINUX)
+        { test_cpu_usage, "test_cpu_usage" },
+#        endif
+#    endif
+#    if CONFIG_THRD_SCHEDULING_STATISTICS == 1
+        { test_scheduling_statistics, "test_scheduling_statistics" },
 #    endif
         { test_stack_heap, "test_stack_heap" },
         { test_prio_list, "test_prio_list" },
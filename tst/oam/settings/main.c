@@ -376,6 +376,133 @@ static int test_read_write_by_name(void)
     return (0);
 }
 
+static int test_lookup_by_name(void)
+{
+    const char *names[] = {
+        "int32",
+        "string",
+        "blob",
+        "blob_with_empty_default_data",
+        "max_name_length_40_123456789012345678901",
+        "string_space",
+        "string_escape"
+    };
+    const size_t sizes[] = { 4, 4, 2, 4, 4, 4, 8 };
+    uint8_t buf[8];
+    int i;
+
+    /* All settings are found by the generated hash table. */
+    for (i = 0; i < membersof(names); i++) {
+        BTASSERTI(settings_read_by_name(names[i], &buf[0], sizes[i]),
+                  ==,
+                  sizes[i]);
+    }
+
+    /* Missing settings, including prefixes and extensions of
+       existing names. */
+    BTASSERTI(settings_read_by_name("", &buf[0], 1), ==, -EINVAL);
+    BTASSERTI(settings_read_by_name("int", &buf[0], 1), ==, -EINVAL);
+    BTASSERTI(settings_read_by_name("int32_", &buf[0], 1), ==, -EINVAL);
+    BTASSERTI(settings_read_by_name("strinG", &buf[0], 1), ==, -EINVAL);
+    BTASSERTI(settings_read_by_name("max_name_length_40", &buf[0], 1),
+              ==,
+              -EINVAL);
+
+    return (0);
+}
+
+static int test_transaction(void)
+{
+    struct settings_transaction_t transaction;
+    int32_t int32;
+    char string[8];
+    uint8_t blob[2];
+    int i;
+
+    BTASSERTI(settings_transaction_init(&transaction), ==, 0);
+
+    /* Empty commit. */
+    BTASSERTI(settings_transaction_commit(&transaction), ==, 0);
+
+    /* Add writes in descending address order. */
+    BTASSERTI(settings_transaction_write_by_name(&transaction,
+                                                 "string_escape",
+                                                 "abc",
+                                                 4), ==, 4);
+    blob[0] = 5;
+    blob[1] = 6;
+    BTASSERTI(settings_transaction_write_by_name(&transaction,
+                                                 "blob",
+                                                 &blob[0],
+                                                 sizeof(blob)), ==, 2);
+    int32 = 77;
+    BTASSERTI(settings_transaction_write(&transaction,
+                                         SETTING_INT32_ADDR,
+                                         &int32,
+                                         sizeof(int32)), ==, 4);
+
+    /* The value is copied into the transaction. */
+    int32 = 0;
+
+    /* Bad writes. */
+    BTASSERTI(settings_transaction_write_by_name(&transaction,
+                                                 "int33",
+                                                 &int32,
+                                                 sizeof(int32)), ==, -EINVAL);
+    BTASSERTI(settings_transaction_write_by_name(&transaction,
+                                                 "blob",
+                                                 &int32,
+                                                 sizeof(int32)), ==, -EINVAL);
+
+    /* Nothing is written before commit. */
+    BTASSERTI(setting_int32_read(&int32), ==, 0);
+    BTASSERTI(int32, !=, 77);
+
+    BTASSERTI(settings_transaction_commit(&transaction), ==, 10);
+
+    BTASSERTI(setting_int32_read(&int32), ==, 0);
+    BTASSERTI(int32, ==, 77);
+    BTASSERTI(setting_blob_read(&blob[0]), ==, 0);
+    BTASSERTI(blob[0], ==, 5);
+    BTASSERTI(blob[1], ==, 6);
+    BTASSERTI(settings_read(&string[0],
+                            SETTING_STRING_ESCAPE_ADDR,
+                            4), ==, 4);
+    BTASSERTI(strcmp(&string[0], "abc"), ==, 0);
+
+    /* The transaction is empty after commit. Fill it up. */
+    for (i = 0; i < CONFIG_SETTINGS_TRANSACTION_WRITES_MAX; i++) {
+        int32 = i;
+        BTASSERTI(settings_transaction_write(&transaction,
+                                             SETTING_INT32_ADDR,
+                                             &int32,
+                                             1), ==, 1);
+    }
+
+    BTASSERTI(settings_transaction_write(&transaction,
+                                         SETTING_INT32_ADDR,
+                                         &int32,
+                                         1), ==, -ENOMEM);
+    BTASSERTI(settings_transaction_init(&transaction), ==, 0);
+
+    /* Buffer overflow. */
+    BTASSERTI(settings_transaction_write(
+                  &transaction,
+                  0,
+                  &transaction,
+                  CONFIG_SETTINGS_TRANSACTION_BUFFER_SIZE + 1), ==, -ENOMEM);
+
+    /* Restore the value expected by later tests. */
+    BTASSERTI(settings_reset_by_name("string_escape", 8), ==, 0);
+    int32 = 10;
+    BTASSERTI(setting_int32_write(int32), ==, 0);
+    blob[0] = 1;
+    blob[1] = 2;
+    BTASSERTI(setting_blob_write(&blob[0]), ==, 0);
+
+    return (0);
+}
+
 static int test_cmd_list_after_updates(void)
 {
 #if CONFIG_SETTINGS_FS_COMMAND_LIST == 1
@@ -415,6 +542,8 @@ int main()
         { test_setting_string_read_write, "test_setting_string_read_write" },
         { test_setting_blob_read_write, "test_setting_blob_read_write" },
         { test_read_write_by_name, "test_read_write_by_name" },
+        { test_lookup_by_name, "test_lookup_by_name" },
+        { test_transaction, "test_transaction" },
         { test_cmd_list_after_updates, "test_cmd_list_after_updates" },
         { NULL, NULL }
     };
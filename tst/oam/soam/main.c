@@ -34,6 +34,8 @@ static struct soam_t soam;
 static uint8_t txbuf[TX_BUFFER_SIZE];
 static uint8_t queuebuf[256];
 
+static uint8_t batchbuf[2 * 96];
+
 static struct queue_t chout;
 static struct fs_command_t cmd_foo;
 
@@ -415,6 +417,221 @@ static int test_stdout(void)
     return (0);
 }
 
+/**
+ * Read a packet from the output channel and check its crc. Returns
+ * the payload size.
+ */
+static ssize_t read_packet(uint8_t *buf_p, int type_flags, int index)
+{
+    size_t size;
+    uint16_t crc;
+
+    BTASSERT(chan_read(&chout, &buf_p[0], 5) == 5);
+    BTASSERTI(buf_p[0], ==, type_flags);
+    BTASSERTI(buf_p[1], ==, index);
+    size = ((buf_p[3] << 8) | buf_p[4]);
+    BTASSERT(chan_read(&chout, &buf_p[5], size) == size);
+    crc = ((buf_p[size + 3] << 8) | buf_p[size + 4]);
+    BTASSERTI(crc_ccitt(0xffff, &buf_p[0], size + 3), ==, crc);
+
+    return (size - 2);
+}
+
+/**
+ * Decompress given LZ4 block.
+ */
+static ssize_t lz4_decompress(const uint8_t *src_p,
+                              size_t size,
+                              uint8_t *dst_p)
+{
+    const uint8_t *src_end_p;
+    uint8_t *dst_begin_p;
+    size_t length;
+    size_t offset;
+    int token;
+
+    src_end_p = (src_p + size);
+    dst_begin_p = dst_p;
+
+    while (src_p < src_end_p) {
+        token = *src_p++;
+        length = (token >> 4);
+
+        if (length == 15) {
+            do {
+                length += *src_p;
+            } while (*src_p++ == 255);
+        }
+
+        memcpy(dst_p, src_p, length);
+        dst_p += length;
+        src_p += length;
+
+        if (src_p == src_end_p) {
+            break;
+        }
+
+        offset = (src_p[0] | (src_p[1] << 8));
+        src_p += 2;
+        length = (token & 0xf);
+
+        if (length == 15) {
+            do {
+                length += *src_p;
+            } while (*src_p++ == 255);
+        }
+
+        length += 4;
+
+        while (length > 0) {
+            *dst_p = *(dst_p - offset);
+            dst_p++;
+            length--;
+        }
+    }
+
+    return (dst_p - dst_begin_p);
+}
+
+static int test_batch(void)
+{
+    struct soam_statistics_t statistics;
+    uint8_t buf[128];
+    ssize_t size;
+    void *stdout_p;
+
+    BTASSERT(soam_set_batching(&soam, &batchbuf[0], 8, 0) == -EINVAL);
+
+    /* Packet sizes must fit in 16 bits. */
+    BTASSERT(soam_set_batching(&soam, &batchbuf[0], 65536, 0) == -EINVAL);
+    BTASSERT(soam_set_batching(&soam, &batchbuf[0], 131072, 1) == -EINVAL);
+    BTASSERT(soam_set_batching(&soam, &batchbuf[0], 131071, 1) == 0);
+    BTASSERT(soam_set_batching(&soam, &batchbuf[0], 96, 0) == 0);
+    BTASSERT(soam_reset_statistics(&soam) == 0);
+
+    /* Two log points and two binary writes are batched. */
+    log_object_print(NULL, LOG_ERROR, OSTR("foo\r\n"));
+    log_object_print(NULL, LOG_ERROR, OSTR("foo\r\n"));
+    BTASSERTI(chan_write(soam_get_stdout_input_channel(&soam), "abc", 3),
+              ==,
+              3);
+    BTASSERTI(chan_write(soam_get_stdout_input_channel(&soam), "de", 2),
+              ==,
+              2);
+    BTASSERTI(queue_size(&chout), ==, 0);
+
+    BTASSERT(soam_flush(&soam) == 0);
+    BTASSERT(soam_flush(&soam) == 0);
+
+    size = read_packet(&buf[0], 0xc1, 12);
+    BTASSERT(size > 0);
+
+    /* First log point. */
+    BTASSERTI(buf[5], ==, 0x30);
+    size = ((buf[6] << 8) | buf[7]);
+    BTASSERT(memcmp(&buf[8 + size - 23], ":error:main:default: ", 21) == 0);
+
+    /* Second log point. */
+    BTASSERTI(buf[8 + size], ==, 0x30);
+    size += (3 + ((buf[9 + size] << 8) | buf[10 + size]));
+
+    /* The merged binary writes. */
+    BTASSERTM(&buf[8 + size], "\x20\x00\x05" "abcde", 8);
+
+    /* A printf record is batched, and flushed before a packet that
+       can not be batched. */
+    stdout_p = sys_get_stdout();
+    sys_set_stdout(soam_get_stdout_input_channel(&soam));
+    std_printf(OSTR("hej\r\n"));
+    sys_set_stdout(stdout_p);
+    BTASSERTI(queue_size(&chout), ==, 0);
+    BTASSERTI(soam_write(&soam, 0x70, "\x00\x00\x00\x00", 4), ==, 4);
+
+    size = read_packet(&buf[0], 0xc1, 13);
+    BTASSERTI(size, ==, 5);
+    BTASSERTM(&buf[5], "\x10\x00\x02", 3);
+    size = read_packet(&buf[0], 0x71, 14);
+    BTASSERTI(size, ==, 4);
+
+    /* A record larger than the batch packet is written as is. */
+    memset(&buf[0], 'x', 100);
+    BTASSERT(chan_write(soam_get_stdout_input_channel(&soam),
+                        &buf[0],
+                        100) > 0);
+    BTASSERTI(queue_size(&chout), ==, 100 + 3 * 7);
+    BTASSERT(read_packet(&buf[0], 0x20, 15) == 41);
+    BTASSERT(read_packet(&buf[0], 0x22, 16) == 41);
+    BTASSERT(read_packet(&buf[0], 0x23, 17) == 18);
+
+    /* Statistics. */
+    BTASSERT(soam_get_statistics(&soam, &statistics) == 0);
+    BTASSERTI(statistics.records, ==, 7);
+    BTASSERTI(statistics.packets, ==, 6);
+    BTASSERTI(statistics.compressed_packets, ==, 0);
+    BTASSERT(statistics.record_bytes > 100);
+
+    BTASSERT(soam_set_batching(&soam, NULL, 0, 0) == 0);
+
+    return (0);
+}
+
+static int test_batch_compression(void)
+{
+    struct soam_statistics_t statistics;
+    uint8_t buf[128];
+    uint8_t decompressed[96];
+    ssize_t size;
+    int i;
+
+    BTASSERT(soam_set_batching(&soam,
+                               &batchbuf[0],
+                               sizeof(batchbuf),
+                               1) == 0);
+    BTASSERT(soam_reset_statistics(&soam) == 0);
+
+    /* A repetitive record is compressed. */
+    for (i = 0; i < 40; i++) {
+        buf[i] = ('0' + (i % 10));
+    }
+
+    BTASSERTI(chan_write(soam_get_stdout_input_channel(&soam), &buf[0], 40),
+              ==,
+              40);
+    BTASSERT(soam_flush(&soam) == 0);
+
+    size = read_packet(&buf[0], 0xc5, 18);
+    BTASSERTI(size, <, 30);
+    BTASSERTI(((buf[5] << 8) | buf[6]), ==, 43);
+    BTASSERTI(lz4_decompress(&buf[7], size - 2, &decompressed[0]), ==, 43);
+    BTASSERTM(&decompressed[0], "\x20\x00\x28", 3);
+
+    for (i = 0; i < 40; i++) {
+        BTASSERTI(decompressed[3 + i], ==, '0' + (i % 10));
+    }
+
+    /* Less data is written than given. */
+    BTASSERT(soam_get_statistics(&soam, &statistics) == 0);
+    BTASSERTI(statistics.output_bytes, <, statistics.record_bytes);
+
+    /* A short record is not compressed. */
+    BTASSERTI(chan_write(soam_get_stdout_input_channel(&soam), "abc", 3),
+              ==,
+              3);
+    BTASSERT(soam_flush(&soam) == 0);
+    BTASSERTI(read_packet(&buf[0], 0xc1, 19), ==, 6);
+    BTASSERTM(&buf[5], "\x20\x00\x03" "abc", 6);
+
+    BTASSERT(soam_get_statistics(&soam, &statistics) == 0);
+    BTASSERTI(statistics.records, ==, 2);
+    BTASSERTI(statistics.record_bytes, ==, 43);
+    BTASSERTI(statistics.packets, ==, 2);
+    BTASSERTI(statistics.compressed_packets, ==, 1);
+
+    BTASSERT(soam_set_batching(&soam, NULL, 0, 0) == 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -425,6 +642,8 @@ int main()
         { test_bad_input, "test_bad_input" },
         { test_invalid_type, "test_invalid_type" },
         { test_stdout, "test_stdout" },
+        { test_batch, "test_batch" },
+        { test_batch_compression, "test_batch_compression" },
         { NULL, NULL }
     };
 
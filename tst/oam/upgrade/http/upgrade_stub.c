@@ -99,3 +99,13 @@ int upgrade_binary_upload_end()
 {
     return (-1);
 }
+
+ssize_t upgrade_binary_upload_resume()
+{
+    return (-1);
+}
+
+ssize_t upgrade_binary_upload_get_checkpoint()
+{
+    return (-1);
+}
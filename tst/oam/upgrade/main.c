@@ -28,6 +28,84 @@
 
 #include "simba.h"
 
+/* Defined in upgrade.i. */
+struct test_application_t {
+    uint8_t buf[4096];
+    size_t offset;
+    size_t size;
+    int number_of_writes;
+};
+
+extern struct test_application_t test_application;
+
+static uint8_t image[3000];
+
+/**
+ * Create an upgrade file header of given version for given data.
+ */
+static size_t create_header(uint8_t *buf_p,
+                            uint32_t version,
+                            const uint8_t *data_p,
+                            size_t size)
+{
+    struct sha1_t sha1;
+    struct sha256_t sha256;
+    size_t header_size;
+    uint32_t crc;
+
+    if (version == 1) {
+        header_size = 40;
+        sha1_init(&sha1);
+        sha1_update(&sha1, (void *)data_p, size);
+        sha1_digest(&sha1, &buf_p[12]);
+    } else {
+        header_size = 52;
+        sha256_init(&sha256);
+        sha256_update(&sha256, data_p, size);
+        sha256_digest(&sha256, &buf_p[12]);
+    }
+
+    buf_p[0] = (version >> 24);
+    buf_p[1] = (version >> 16);
+    buf_p[2] = (version >> 8);
+    buf_p[3] = version;
+    buf_p[4] = (header_size >> 24);
+    buf_p[5] = (header_size >> 16);
+    buf_p[6] = (header_size >> 8);
+    buf_p[7] = header_size;
+    buf_p[8] = (size >> 24);
+    buf_p[9] = (size >> 16);
+    buf_p[10] = (size >> 8);
+    buf_p[11] = size;
+    memcpy(&buf_p[header_size - 8], "foo", 4);
+    crc = crc_32(0, buf_p, header_size - 4);
+    buf_p[header_size - 4] = (crc >> 24);
+    buf_p[header_size - 3] = (crc >> 16);
+    buf_p[header_size - 2] = (crc >> 8);
+    buf_p[header_size - 1] = crc;
+
+    return (header_size);
+}
+
+/**
+ * Upload given data in chunks of given size.
+ */
+static int upload(const uint8_t *buf_p, size_t size, size_t chunk_size)
+{
+    while (size > 0) {
+        chunk_size = MIN(chunk_size, size);
+
+        if (upgrade_binary_upload(buf_p, chunk_size) != 0) {
+            return (-1);
+        }
+
+        buf_p += chunk_size;
+        size -= chunk_size;
+    }
+
+    return (0);
+}
+
 static int test_bootloader(void)
 {
     BTASSERT(upgrade_bootloader_enter() == -1);
@@ -42,6 +120,36 @@ static int test_bootloader(void)
 static int test_binary_upload(void)
 {
     uint8_t header_data_size_2[64] = {
+        /* Version. */
+        0, 0, 0, 1,
+        /* Header size. */
+        0, 0, 0, 40,
+        /* Data size. */
+        0, 0, 0, 2,
+        /* Data SHA1. */
+        0xda, 0x23, 0x61, 0x4e, 0x02, 0x46, 0x9a, 0x0d,
+        0x7c, 0x7b, 0xd1, 0xbd, 0xab, 0x5c, 0x9c, 0x47,
+        0x4b, 0x19, 0x04, 0xdc,
+        /* Data description. */
+        'f', 'o', 'o', '\0',
+        /* Header CRC. */
+        0xba, 0x9e, 0x1d, 0x80,
+        /* Data. */
+        'a', 'b'
+    };
+
+    BTASSERT(upgrade_binary_upload_begin() == 0);
+    BTASSERT(upgrade_binary_upload(&header_data_size_2[0], 42) == 0);
+    BTASSERT(upgrade_binary_upload_end() == 0);
+    BTASSERTI(test_application.size, ==, 2);
+    BTASSERTM(&test_application.buf[0], "ab", 2);
+
+    return (0);
+}
+
+static int test_binary_upload_bad_sha1(void)
+{
+    uint8_t buf[42] = {
         /* Version. */
         0, 0, 0, 1,
         /* Header size. */
@@ -61,8 +169,100 @@ static int test_binary_upload(void)
     };
 
     BTASSERT(upgrade_binary_upload_begin() == 0);
-    BTASSERT(upgrade_binary_upload(&header_data_size_2[0], 42) == 0);
+    BTASSERT(upgrade_binary_upload(&buf[0], 42) == 0);
+    BTASSERT(upgrade_binary_upload_end() == -1);
+
+    return (0);
+}
+
+static int test_binary_upload_too_much_data(void)
+{
+    uint8_t buf[52];
+    size_t header_size;
+
+    header_size = create_header(&buf[0], 1, &image[0], 10);
+
+    BTASSERT(upgrade_binary_upload_begin() == 0);
+    BTASSERT(upgrade_binary_upload(&buf[0], header_size) == 0);
+    BTASSERT(upgrade_binary_upload(&image[0], 11) == -1);
+    BTASSERT(upgrade_binary_upload_end() == -1);
+
+    return (0);
+}
+
+static int test_binary_upload_sha256(void)
+{
+    uint8_t buf[52];
+    size_t header_size;
+
+    header_size = create_header(&buf[0], 2, &image[0], sizeof(image));
+    BTASSERTI(header_size, ==, 52);
+
+    BTASSERT(upgrade_binary_upload_begin() == 0);
+    BTASSERT(upgrade_binary_upload(&buf[0], header_size) == 0);
+    BTASSERT(upload(&image[0], sizeof(image), 100) == 0);
     BTASSERT(upgrade_binary_upload_end() == 0);
+    BTASSERTI(test_application.size, ==, sizeof(image));
+    BTASSERTM(&test_application.buf[0], &image[0], sizeof(image));
+    BTASSERTI(test_application.number_of_writes,
+              ==,
+              DIV_CEIL(sizeof(image), CONFIG_UPGRADE_BUFFER_SIZE));
+
+    /* Corrupt data is detected. */
+    BTASSERT(upgrade_binary_upload_begin() == 0);
+    BTASSERT(upgrade_binary_upload(&buf[0], header_size) == 0);
+    BTASSERT(upload(&image[0], sizeof(image) - 1, 100) == 0);
+    BTASSERT(upgrade_binary_upload(&buf[0], 1) == 0);
+    BTASSERT(upgrade_binary_upload_end() == -1);
+
+    return (0);
+}
+
+static int test_binary_upload_resume(void)
+{
+    uint8_t buf[52];
+    ssize_t header_size;
+    ssize_t offset;
+
+    header_size = create_header(&buf[0], 2, &image[0], sizeof(image));
+
+    /* Nothing to resume. */
+    BTASSERT(upgrade_binary_upload_begin() == 0);
+    BTASSERTI(upgrade_binary_upload_get_checkpoint(), ==, -ENOENT);
+    BTASSERTI(upgrade_binary_upload_resume(), ==, -ENOENT);
+
+    /* A checkpoint is saved once the header is received. */
+    BTASSERT(upgrade_binary_upload(&buf[0], header_size) == 0);
+    BTASSERTI(upgrade_binary_upload_get_checkpoint(), ==, header_size);
+
+    /* Interrupted after 1400 bytes. Only written blocks are kept. */
+    BTASSERT(upload(&image[0], 1400, 100) == 0);
+    offset = (header_size
+              + (1400 / CONFIG_UPGRADE_BUFFER_SIZE)
+              * CONFIG_UPGRADE_BUFFER_SIZE);
+    BTASSERTI(upgrade_binary_upload_get_checkpoint(), ==, offset);
+    BTASSERTI(upgrade_binary_upload_resume(), ==, offset);
+    BTASSERTI(test_application.offset, ==, offset - header_size);
+
+    /* Interrupted again, this time ended by the sender. Buffered data
+       is written before ending. */
+    BTASSERT(upload(&image[offset - header_size], 500, 100) == 0);
+    BTASSERT(upgrade_binary_upload_end() == -1);
+    offset += 500;
+    BTASSERTI(upgrade_binary_upload_get_checkpoint(), ==, offset);
+
+    /* Resume and upload the rest. */
+    BTASSERTI(upgrade_binary_upload_resume(), ==, offset);
+    BTASSERT(upload(&image[offset - header_size],
+                    sizeof(image) - (offset - header_size),
+                    100) == 0);
+    BTASSERT(upgrade_binary_upload_end() == 0);
+    BTASSERTI(test_application.size, ==, sizeof(image));
+    BTASSERTM(&test_application.buf[0], &image[0], sizeof(image));
+
+    /* Nothing to resume after a successful upload. */
+    BTASSERTI(upgrade_binary_upload_get_checkpoint(), ==, -ENOENT);
+    BTASSERTI(upgrade_binary_upload_resume(), ==, -ENOENT);
 
     return (0);
 }
@@ -180,6 +380,10 @@ int main()
     struct harness_testcase_t testcases[] = {
         { test_bootloader, "test_bootloader" },
         { test_binary_upload, "test_binary_upload" },
+        { test_binary_upload_bad_sha1, "test_binary_upload_bad_sha1" },
+        { test_binary_upload_too_much_data, "test_binary_upload_too_much_data" },
+        { test_binary_upload_sha256, "test_binary_upload_sha256" },
+        { test_binary_upload_resume, "test_binary_upload_resume" },
         { test_binary_upload_bad_version, "test_binary_upload_bad_version" },
         { test_binary_upload_bad_crc, "test_binary_upload_bad_crc" },
         { test_binary_upload_short_header, "test_binary_upload_short_header" },
@@ -187,6 +391,12 @@ int main()
         { NULL, NULL }
     };
 
+    size_t i;
+
+    for (i = 0; i < sizeof(image); i++) {
+        image[i] = (i * 7);
+    }
+
     sys_start();
 
     harness_run(testcases);
@@ -26,6 +26,16 @@
  * This file is part of the Simba project.
  */
 
+/* The application area. */
+struct test_application_t {
+    uint8_t buf[4096];
+    size_t offset;
+    size_t size;
+    int number_of_writes;
+};
+
+struct test_application_t test_application;
+
 static int upgrade_port_bootloader_enter()
 {
     return (-1);
@@ -89,27 +99,44 @@ static int upgrade_port_application_is_valid()
 
 static int upgrade_port_binary_upload_begin()
 {
+    test_application.offset = 0;
+    test_application.size = 0;
+    test_application.number_of_writes = 0;
+
     return (0);
 }
 
-static int upgrade_port_binary_upload(const void *buf_p,
-                                      size_t size)
+static int upgrade_port_binary_upload_resume(size_t offset)
 {
-    static int counter = 0;
+    test_application.offset = offset;
 
-    counter++;
+    return (0);
+}
 
-    if (counter == 1) {
-        BTASSERT(size == 2);
-        BTASSERT(memcmp(buf_p, "ab", 2) == 0);
+static int upgrade_port_binary_upload(const void *buf_p,
+                                      size_t size)
+{
+    BTASSERT(test_application.offset + size <= sizeof(test_application.buf));
 
-        return (0);
-    }
+    memcpy(&test_application.buf[test_application.offset], buf_p, size);
+    test_application.offset += size;
+    test_application.size = test_application.offset;
+    test_application.number_of_writes++;
 
-    return (-1);
+    return (0);
 }
 
 static int upgrade_port_binary_upload_end()
 {
     return (0);
 }
+
+static int upgrade_port_checkpoint_write(const void *buf_p, size_t size)
+{
+    return (-ENOSYS);
+}
+
+static int upgrade_port_checkpoint_read(void *buf_p, size_t size)
+{
+    return (-ENOSYS);
+}
@@ -82,6 +82,7 @@ static int test_multi_thread(void)
     BTASSERT(mutex_module_init() == 0);
     BTASSERT(mutex_module_init() == 0);
     BTASSERT(mutex_init(&mutex) == 0);
+    BTASSERT(contention_add(&mutex.contention, "mutex") == 0);
 
     thrd_spawn(mutex_main,
                &t0_counter,
@@ -110,10 +111,56 @@ static int test_multi_thread(void)
     return (0);
 }
 
+static int test_contention(void)
+{
+    char command[32];
+    int i;
+    uint32_t count;
+
+    /* Each thread locked the mutex ITERATIONS times, and a sleeping
+       lock owner makes the other thread wait. */
+    BTASSERTI(mutex.contention.acquisitions, ==, 2 * ITERATIONS);
+    BTASSERTI(mutex.contention.contended, >, 0);
+    BTASSERTI(mutex.contention.contended, <=, 2 * ITERATIONS);
+
+    count = 0;
+
+    for (i = 0; i < membersof(mutex.contention.waiters); i++) {
+        count += mutex.contention.waiters[i].count;
+    }
+
+    BTASSERTI(count, ==, mutex.contention.contended);
+
+    strcpy(command, "/sync/contention");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+
+    strcpy(command, "/sync/contention foo");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == -EINVAL);
+
+    /* Reset. */
+    strcpy(command, "/sync/contention reset");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+    BTASSERTI(mutex.contention.acquisitions, ==, 0);
+    BTASSERTI(mutex.contention.contended, ==, 0);
+    BTASSERT(mutex.contention.waiters[0].thrd_p == NULL);
+
+    /* An uncontended lock. */
+    BTASSERT(mutex_lock(&mutex) == 0);
+    BTASSERT(mutex_unlock(&mutex) == 0);
+    BTASSERTI(mutex.contention.acquisitions, ==, 1);
+    BTASSERTI(mutex.contention.contended, ==, 0);
+
+    BTASSERT(contention_remove(&mutex.contention) == 0);
+    BTASSERT(contention_remove(&mutex.contention) == -ENOENT);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_multi_thread, "test_multi_thread" },
+        { test_contention, "test_contention" },
         { NULL, NULL }
     };
 
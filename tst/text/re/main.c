@@ -378,6 +378,108 @@ int test_compile(void)
     return (0);
 }
 
+int test_linear(void)
+{
+#if CONFIG_RE_AUTOMATON == 1
+    char re[64];
+    char buf[256];
+    struct time_t start;
+    struct time_t stop;
+    struct time_t elapsed;
+
+    memset(&buf[0], 'a', sizeof(buf));
+
+    /* Exponential in the backtracker, linear in the automaton. */
+    time_get(&start);
+    BTASSERT(re_compile(re, "a*a*a*a*a*a*a*a*b", 0, sizeof(re)) != NULL);
+    BTASSERT(re_match(re, &buf[0], sizeof(buf), NULL, NULL) == -1);
+    BTASSERT(re_compile(re, "a*?a*?a*?a*?a*?a*?a*?c", 0, sizeof(re)) != NULL);
+    BTASSERT(re_match(re, &buf[0], sizeof(buf), NULL, NULL) == -1);
+    BTASSERT(re_compile(re, ".*.*.*.*.*.*=", 0, sizeof(re)) != NULL);
+    BTASSERT(re_match(re, &buf[0], sizeof(buf), NULL, NULL) == -1);
+    buf[sizeof(buf) - 1] = '=';
+    BTASSERT(re_match(re, &buf[0], sizeof(buf), NULL, NULL) == sizeof(buf));
+    time_get(&stop);
+    time_subtract(&elapsed, &stop, &start);
+    BTASSERT(elapsed.seconds == 0);
+
+    /* Same priority as the backtracker. */
+    BTASSERT(re_compile(re, "a*?a+", 0, sizeof(re)) != NULL);
+    BTASSERT(re_match(re, "aaa", 3, NULL, NULL) == 3);
+    BTASSERT(re_compile(re, "a??a?b?", 0, sizeof(re)) != NULL);
+    BTASSERT(re_match(re, "aab", 3, NULL, NULL) == 1);
+    BTASSERT(re_compile(re, "[a-c]{2}d*", RE_IGNORECASE, sizeof(re)) != NULL);
+    BTASSERT(re_match(re, "BcDdX", 5, NULL, NULL) == 4);
+
+    return (0);
+#else
+    return (1);
+#endif
+}
+
+int test_benchmark(void)
+{
+#if CONFIG_RE_AUTOMATON == 1
+    static const char *patterns[] = {
+        "\\d+-\\d+-\\d+ \\d+:\\d+:\\d+ [A-Z]+ ",
+        ".*error",
+        "[a-z]+/[a-z/]+ +\\w*",
+        "\\w+=\\d+;.*?\\d"
+    };
+    static const char *inputs[] = {
+        "2026-10-19 12:00:01 INFO sys: Started application.",
+        "kernel/sys/info verbose",
+        "a=1; b=2; c=3; temperature too high, error 5"
+    };
+    char re[128];
+    int pattern;
+    int input;
+    int rounds;
+    size_t size;
+    struct time_t start;
+    struct time_t stop;
+    struct time_t elapsed;
+    unsigned long micros;
+
+    for (pattern = 0; pattern < membersof(patterns); pattern++) {
+        BTASSERT(re_compile(re,
+                            patterns[pattern],
+                            0,
+                            sizeof(re)) != NULL);
+
+        for (input = 0; input < membersof(inputs); input++) {
+            size = strlen(inputs[input]);
+            rounds = 0;
+            time_get(&start);
+
+            /* Run for at least 200 ms as the system tick is coarse. */
+            do {
+                re_match(re, inputs[input], size, NULL, NULL);
+                rounds++;
+                time_get(&stop);
+                time_subtract(&elapsed, &stop, &start);
+            } while ((elapsed.seconds == 0)
+                     && (elapsed.nanoseconds < 200000000));
+
+            micros = (elapsed.seconds * 1000000ul
+                      + elapsed.nanoseconds / 1000ul);
+
+            std_printf(FSTR("Pattern %d, input %d (%d): %d matches in "
+                            "%lu us.\r\n"),
+                       pattern,
+                       input,
+                       (int)re_match(re, inputs[input], size, NULL, NULL),
+                       rounds,
+                       micros);
+        }
+    }
+
+    return (0);
+#else
+    return (1);
+#endif
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -393,6 +495,8 @@ int main()
         { test_greed, "test_greed" },
         { test_complex, "test_complex" },
         { test_compile, "test_compile" },
+        { test_linear, "test_linear" },
+        { test_benchmark, "test_benchmark" },
         { NULL, NULL }
     };
 
@@ -730,6 +730,169 @@ static int test_printf_isr(void)
     return (0);
 }
 
+static int test_format(void)
+{
+    struct std_format_t format;
+    struct std_format_item_t items[17];
+    char buf[384];
+    char expected[384];
+    char literal[300];
+    ssize_t size;
+    struct queue_t queue;
+    uint8_t queue_buf[64];
+
+    /* Same output as the interpreted format string. */
+    BTASSERT(std_format_init(&format,
+                             FSTR("'%c' '%-6d' '%06d' '%lu' '%8s' '%x' %% '%lx'"),
+                             &items[0],
+                             membersof(items)) == 0);
+    size = std_snprintf_format(&buf[0],
+                               sizeof(buf),
+                               &format,
+                               'b', -43, -43, 0xffffffffUL, "foo", 0xbeef,
+                               0x12345678L);
+    BTASSERT(std_sprintf(&expected[0],
+                         FSTR("'%c' '%-6d' '%06d' '%lu' '%8s' '%x' %% '%lx'"),
+                         'b', -43, -43, 0xffffffffUL, "foo", 0xbeef,
+                         0x12345678L) == size);
+    BTASSERTM(&buf[0], &expected[0], size + 1);
+    BTASSERTM(&buf[0],
+              "'b' '-43   ' '-00043' '4294967295' '     foo' 'beef' % "
+              "'12345678'",
+              size + 1);
+
+    /* Too few items. */
+    BTASSERT(std_format_init(&format,
+                             FSTR("%d %d %d %d %d %d %d %d %d %d"),
+                             &items[0],
+                             membersof(items)) == -ENOMEM);
+
+    /* Literal spans longer than an item are split. */
+    memset(&literal[0], 'a', sizeof(literal) - 1);
+    literal[sizeof(literal) - 1] = '\0';
+    literal[sizeof(literal) - 3] = '%';
+    literal[sizeof(literal) - 2] = 'd';
+    BTASSERT(std_format_init(&format,
+                             &literal[0],
+                             &items[0],
+                             membersof(items)) == 0);
+    BTASSERT(format.length == 3);
+    size = std_snprintf_format(&buf[0], sizeof(buf), &format, 5);
+    BTASSERT(size == 298);
+    BTASSERT(buf[296] == 'a');
+    BTASSERT(buf[297] == '5');
+
+    /* Destination buffer too small. */
+    BTASSERT(std_format_init(&format,
+                             FSTR("foo%s"),
+                             &items[0],
+                             membersof(items)) == 0);
+    memset(&buf[0], -1, sizeof(buf));
+    BTASSERT(std_snprintf_format(&buf[0], 5, &format, "bar") == -ENOMEM);
+    BTASSERTM(&buf[0], "foob", 5);
+
+    /* To a channel. */
+    queue_init(&queue, &queue_buf[0], sizeof(queue_buf));
+    BTASSERT(std_fprintf_format(&queue, &format, "bar") == 6);
+    BTASSERT(queue_read(&queue, &buf[0], 6) == 6);
+    BTASSERTM(&buf[0], "foobar", 6);
+
+    return (0);
+}
+
+/* Format with either the interpreted or the precompiled format. */
+#define BENCHMARK_FORMAT(...)                                           \
+    do {                                                                \
+        if (compiled) {                                                 \
+            std_snprintf_format(&buf[0], sizeof(buf), &format, __VA_ARGS__); \
+        } else {                                                        \
+            std_snprintf(&buf[0], sizeof(buf), fmts[fmt], __VA_ARGS__); \
+        }                                                               \
+    } while (0)
+
+static int test_benchmark(void)
+{
+    static const char *fmts[] = {
+        "%d %d %d %d",
+        "%s: %s",
+        "0x%08x 0x%lx",
+        "A long literal span without any conversion specifications, "
+        "as found in many shell responses and log messages. %d",
+#if CONFIG_FLOAT == 1
+        "%f %f"
+#endif
+    };
+    struct std_format_t format;
+    struct std_format_item_t items[8];
+    char buf[256];
+    int fmt;
+    int compiled;
+    int rounds;
+    struct time_t start;
+    struct time_t stop;
+    struct time_t elapsed;
+    unsigned long micros;
+
+    for (fmt = 0; fmt < (int)membersof(fmts); fmt++) {
+        BTASSERT(std_format_init(&format,
+                                 fmts[fmt],
+                                 &items[0],
+                                 membersof(items)) == 0);
+
+        for (compiled = 0; compiled < 2; compiled++) {
+            rounds = 0;
+            time_get(&start);
+
+            /* Run for at least 200 ms as the system tick is coarse. */
+            do {
+                switch (fmt) {
+
+                case 0:
+                    BENCHMARK_FORMAT(7, -1234, 56789, 2147483647);
+                    break;
+
+                case 1:
+                    BENCHMARK_FORMAT("main", "application started");
+                    break;
+
+                case 2:
+                    BENCHMARK_FORMAT(0xbeef, 0x12345678L);
+                    break;
+
+                case 3:
+                    BENCHMARK_FORMAT(42);
+                    break;
+
+#if CONFIG_FLOAT == 1
+                case 4:
+                    BENCHMARK_FORMAT(3.14159, -2.5);
+                    break;
+#endif
+
+                default:
+                    break;
+                }
+
+                rounds++;
+                time_get(&stop);
+                time_subtract(&elapsed, &stop, &start);
+            } while ((elapsed.seconds == 0)
+                     && (elapsed.nanoseconds < 200000000));
+
+            micros = (elapsed.seconds * 1000000ul
+                      + elapsed.nanoseconds / 1000ul);
+
+            std_printf(FSTR("Format %d, %s: %d calls in %lu us.\r\n"),
+                       fmt,
+                       compiled ? "precompiled" : "interpreted",
+                       rounds,
+                       micros);
+        }
+    }
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -750,6 +913,8 @@ int main()
         { test_strtodfp, "test_strtodfp" },
         { test_hexdump, "test_hexdump" },
         { test_printf_isr, "test_printf_isr" },
+        { test_format, "test_format" },
+        { test_benchmark, "test_benchmark" },
         { NULL, NULL }
     };
 